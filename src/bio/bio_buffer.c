@@ -257,6 +257,13 @@ dma_buffer_create(unsigned int init_cnt, int tgt_id)
 	return buf;
 }
 
+void
+bio_iod_wait_time(struct bio_desc *biod, uint64_t *dma_wait, uint64_t *nvme_wait)
+{
+	*dma_wait = biod->bd_dma_wait;
+	*nvme_wait = biod->bd_nvme_wait;
+}
+
 struct bio_sglist *
 bio_iod_sgl(struct bio_desc *biod, unsigned int idx)
 {
@@ -309,19 +316,25 @@ void
 iod_dma_wait(struct bio_desc *biod)
 {
 	struct bio_xs_context	*xs_ctxt = biod->bd_ctxt->bic_xs_ctxt;
+	uint64_t		 start;
 	int			 rc;
 
 	D_ASSERT(xs_ctxt != NULL);
+	if (biod->bd_inflights == 0)
+		return;
+
+	start = daos_get_ntime();
 	if (xs_ctxt->bxc_self_polling) {
 		D_DEBUG(DB_IO, "Self poll completion\n");
 		rc = xs_poll_completion(xs_ctxt, &biod->bd_inflights, 0);
 		if (rc)
 			D_ERROR("Self poll completion failed. "DF_RC"\n", DP_RC(rc));
-	} else if (biod->bd_inflights != 0) {
+	} else {
 		rc = ABT_eventual_wait(biod->bd_dma_done, NULL);
 		if (rc != ABT_SUCCESS)
 			D_ERROR("ABT eventual wait failed. %d\n", rc);
 	}
+	biod->bd_nvme_wait += daos_get_ntime() - start;
 }
 
 void
@@ -1255,6 +1268,8 @@ iod_should_retry(struct bio_desc *biod, struct bio_dma_buffer *bdb)
 static inline void
 iod_fifo_wait(struct bio_desc *biod, struct bio_dma_buffer *bdb)
 {
+	uint64_t	start = daos_get_ntime();
+
 	if (!biod->bd_in_fifo) {
 		biod->bd_in_fifo = 1;
 		D_ASSERT(bdb->bdb_queued_iods == 0);
@@ -1267,11 +1282,15 @@ iod_fifo_wait(struct bio_desc *biod, struct bio_dma_buffer *bdb)
 	ABT_mutex_lock(bdb->bdb_mutex);
 	ABT_cond_wait(bdb->bdb_wait_iod, bdb->bdb_mutex);
 	ABT_mutex_unlock(bdb->bdb_mutex);
+
+	biod->bd_dma_wait += daos_get_ntime() - start;
 }
 
 static void
 iod_fifo_in(struct bio_desc *biod, struct bio_dma_buffer *bdb)
 {
+	uint64_t	start;
+
 	/* No prior waiters */
 	if (!bdb || bdb->bdb_queued_iods == 0)
 		return;
@@ -1282,6 +1301,7 @@ iod_fifo_in(struct bio_desc *biod, struct bio_dma_buffer *bdb)
 	if (biod->bd_non_blocking)
 		return;
 
+	start = daos_get_ntime();
 	biod->bd_in_fifo = 1;
 	bdb->bdb_queued_iods++;
 	if (bdb->bdb_stats.bds_queued_iods)
@@ -1291,6 +1311,8 @@ iod_fifo_in(struct bio_desc *biod, struct bio_dma_buffer *bdb)
 	ABT_mutex_lock(bdb->bdb_mutex);
 	ABT_cond_wait(bdb->bdb_fifo, bdb->bdb_mutex);
 	ABT_mutex_unlock(bdb->bdb_mutex);
+
+	biod->bd_dma_wait += daos_get_ntime() - start;
 }
 
 static void
@@ -449,6 +449,9 @@ struct bio_desc {
 	unsigned int		 bd_type;
 	/* Total bytes landed to data blob */
 	unsigned int		 bd_nvme_bytes;
+	/* Time (nsecs) spent on waiting for DMA buffer and NVMe completion */
+	uint64_t		 bd_dma_wait;
+	uint64_t		 bd_nvme_wait;
 	/* Flags */
 	unsigned int		 bd_buffer_prep:1,
 				 bd_dma_issued:1,
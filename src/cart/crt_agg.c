@@ -0,0 +1,604 @@
+/*
+ * (C) Copyright 2023 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+/**
+ * This file is part of CaRT. It implements the aggregation of the small RPCs
+ * to the same target endpoint context.
+ *
+ * On the server side, the requests of the opcodes registered with
+ * CRT_RPC_FEAT_AGGREGATE are packed into a per-target batch instead of being
+ * forwarded by their own HG handle. The batch is sent as the input of one
+ * envelope RPC (CRT_OPC_AGG) once it is CRT_AGG_WINDOW us old or it is full
+ * (CRT_AGG_SIZE bytes or CRT_AGG_MSG_MAX requests). The target unpacks each
+ * request and dispatches it to its own handler, the replies are packed into
+ * the reply of the envelope in the same order.
+ *
+ * The packed RPCs keep their own credit, timeout and completion callback,
+ * only the transport is shared. Each message in the envelope is:
+ *
+ *   struct crt_agg_msg_hdr | packed header and body | padding to 8 bytes
+ */
+#define D_LOGFAC	DD_FAC(rpc)
+
+#include "crt_internal.h"
+
+struct crt_agg_msg_hdr {
+	/* length of the packed message */
+	uint32_t	amh_len;
+	/* failure of the message, nothing is packed if not zero */
+	int32_t		amh_rc;
+};
+
+#define CRT_AGG_MSG_SIZE(len)	D_ALIGNUP(sizeof(struct crt_agg_msg_hdr) + (len), 8)
+
+/* the requests packed on the origin side */
+struct crt_agg_batch {
+	/* link to crt_context::cc_agg_list */
+	d_list_t		 ab_link;
+	crt_endpoint_t		 ab_ep;
+	/* time stamp (us) to send the batch */
+	uint64_t		 ab_flush_ts;
+	/* max timeout of the packed requests */
+	uint32_t		 ab_timeout;
+	uint32_t		 ab_nr;
+	uint32_t		 ab_size;
+	struct crt_rpc_priv	*ab_rpcs[CRT_AGG_MSG_MAX];
+	char			 ab_buf[0];
+};
+
+struct crt_agg_slot {
+	void			*as_buf;
+	uint32_t		 as_len;
+	int32_t			 as_rc;
+	bool			 as_filled;
+};
+
+/* the replies collected on the target side */
+struct crt_agg_reply {
+	struct crt_rpc_priv	*ar_env;
+	pthread_mutex_t		 ar_mutex;
+	/* replies not filled yet, plus one held by the envelope handler */
+	uint32_t		 ar_pending;
+	uint32_t		 ar_nr;
+	/* the packed replies, i.e. ao_msgs of the envelope */
+	void			*ar_buf;
+	struct crt_agg_slot	 ar_slots[0];
+};
+
+static inline bool
+crt_agg_eligible(struct crt_rpc_priv *rpc_priv)
+{
+	return crt_gdata.cg_agg_window != 0 && rpc_priv->crp_opc_info->coi_aggregate &&
+	       !rpc_priv->crp_coll && !rpc_priv->crp_opc_info->coi_no_reply &&
+	       crt_is_service();
+}
+
+static inline bool
+crt_agg_ep_equal(crt_endpoint_t *a, crt_endpoint_t *b)
+{
+	return a->ep_grp == b->ep_grp && a->ep_rank == b->ep_rank && a->ep_tag == b->ep_tag;
+}
+
+/* Get the next message from @buf at @off, return the failure of the message */
+static int
+crt_agg_msg_next(char *buf, size_t len, size_t *off, void **data, uint32_t *data_len)
+{
+	struct crt_agg_msg_hdr	hdr;
+
+	if (*off + sizeof(hdr) > len)
+		return -DER_PROTO;
+
+	memcpy(&hdr, buf + *off, sizeof(hdr));
+	if (*off + sizeof(hdr) + hdr.amh_len > len)
+		return -DER_PROTO;
+
+	*data = buf + *off + sizeof(hdr);
+	*data_len = hdr.amh_len;
+	*off += CRT_AGG_MSG_SIZE(hdr.amh_len);
+
+	return hdr.amh_rc;
+}
+
+/* Complete the packed requests by the reply of the envelope */
+static void
+crt_agg_batch_complete(struct crt_agg_batch *batch, d_iov_t *msgs, int rc)
+{
+	struct crt_rpc_priv	*rpc_priv;
+	void			*data = NULL;
+	uint32_t		 data_len = 0;
+	size_t			 off = 0;
+	uint32_t		 i;
+	int			 msg_rc;
+
+	for (i = 0; i < batch->ab_nr; i++) {
+		rpc_priv = batch->ab_rpcs[i];
+		msg_rc = rc;
+		if (msg_rc == 0)
+			msg_rc = crt_agg_msg_next(msgs->iov_buf, msgs->iov_len, &off, &data,
+						  &data_len);
+
+		crt_rpc_lock(rpc_priv);
+		if (rpc_priv->crp_completed) {
+			/* timed out or aborted while in flight */
+			crt_rpc_unlock(rpc_priv);
+		} else {
+			if (msg_rc == 0)
+				msg_rc = crt_proc_agg_unpack_reply(rpc_priv, data, data_len);
+			crt_context_req_untrack(rpc_priv);
+			crt_rpc_complete_and_unlock(rpc_priv, msg_rc);
+		}
+
+		/* corresponding to the ref taken in crt_agg_req_add */
+		RPC_DECREF(rpc_priv);
+	}
+
+	D_FREE(batch);
+}
+
+static void
+crt_agg_reply_cb(const struct crt_cb_info *cb_info)
+{
+	struct crt_agg_batch	*batch = cb_info->cci_arg;
+	struct crt_agg_out	*out = crt_reply_get(cb_info->cci_rpc);
+
+	if (cb_info->cci_rc != 0)
+		D_DEBUG(DB_NET, "envelope of %u RPCs to rank %u tag %u failed, " DF_RC "\n",
+			batch->ab_nr, batch->ab_ep.ep_rank, batch->ab_ep.ep_tag,
+			DP_RC(cb_info->cci_rc));
+
+	crt_agg_batch_complete(batch, &out->ao_msgs, cb_info->cci_rc);
+}
+
+static void
+crt_agg_batch_send(struct crt_context *ctx, struct crt_agg_batch *batch)
+{
+	crt_rpc_t		*env;
+	struct crt_agg_in	*in;
+	int			 rc;
+
+	rc = crt_req_create(ctx, &batch->ab_ep, CRT_OPC_AGG, &env);
+	if (rc != 0) {
+		D_ERROR("failed to create envelope RPC, " DF_RC "\n", DP_RC(rc));
+		crt_agg_batch_complete(batch, NULL, rc);
+		return;
+	}
+
+	in = crt_req_get(env);
+	d_iov_set(&in->ai_msgs, batch->ab_buf, batch->ab_size);
+	crt_req_set_timeout(env, batch->ab_timeout);
+
+	D_DEBUG(DB_TRACE, "sending %u RPCs (%u bytes) to rank %u tag %u\n", batch->ab_nr,
+		batch->ab_size, batch->ab_ep.ep_rank, batch->ab_ep.ep_tag);
+
+	/* the packed requests are completed by crt_agg_reply_cb even on failure */
+	rc = crt_req_send(env, crt_agg_reply_cb, batch);
+	if (rc != 0)
+		D_ERROR("failed to send envelope RPC, " DF_RC "\n", DP_RC(rc));
+}
+
+/* Pack @rpc_priv into @batch, -DER_OVERFLOW if the batch is full */
+static int
+crt_agg_batch_pack(struct crt_agg_batch *batch, struct crt_rpc_priv *rpc_priv)
+{
+	struct crt_agg_msg_hdr	 hdr = { 0 };
+	size_t			 hdr_size = sizeof(hdr);
+	size_t			 size;
+	int			 rc;
+
+	if (batch->ab_nr == CRT_AGG_MSG_MAX ||
+	    batch->ab_size + hdr_size >= crt_gdata.cg_agg_size)
+		return -DER_OVERFLOW;
+
+	rc = crt_proc_agg_pack(rpc_priv, false, batch->ab_buf + batch->ab_size + hdr_size,
+			       crt_gdata.cg_agg_size - batch->ab_size - hdr_size, &size);
+	if (rc != 0)
+		return rc;
+
+	hdr.amh_len = size;
+	memcpy(batch->ab_buf + batch->ab_size, &hdr, hdr_size);
+	batch->ab_size = min(batch->ab_size + CRT_AGG_MSG_SIZE(size), crt_gdata.cg_agg_size);
+	batch->ab_rpcs[batch->ab_nr++] = rpc_priv;
+	batch->ab_timeout = max(batch->ab_timeout, rpc_priv->crp_timeout_sec);
+	if (batch->ab_nr == CRT_AGG_MSG_MAX)
+		batch->ab_flush_ts = 0;
+
+	return 0;
+}
+
+/*
+ * Try to pack the request into the batch to its target, instead of sending it
+ * by its own HG handle. Return false if it is not eligible or too large.
+ */
+bool
+crt_agg_req_add(struct crt_rpc_priv *rpc_priv)
+{
+	struct crt_context	*ctx = rpc_priv->crp_pub.cr_ctx;
+	crt_endpoint_t		*ep = &rpc_priv->crp_pub.cr_ep;
+	struct crt_agg_batch	*batch = NULL;
+	struct crt_agg_batch	*tmp;
+	struct crt_agg_batch	*full = NULL;
+	int			 rc = -DER_OVERFLOW;
+
+	if (!crt_agg_eligible(rpc_priv))
+		return false;
+
+	D_MUTEX_LOCK(&ctx->cc_agg_mutex);
+	d_list_for_each_entry(tmp, &ctx->cc_agg_list, ab_link) {
+		if (crt_agg_ep_equal(&tmp->ab_ep, ep)) {
+			batch = tmp;
+			break;
+		}
+	}
+
+	if (batch != NULL) {
+		rc = crt_agg_batch_pack(batch, rpc_priv);
+		if (rc == -DER_OVERFLOW) {
+			/* send it after unlock, never with a packed request locked */
+			d_list_del(&batch->ab_link);
+			full = batch;
+		}
+	}
+
+	if (rc == -DER_OVERFLOW) {
+		D_ALLOC(batch, sizeof(*batch) + crt_gdata.cg_agg_size);
+		if (batch == NULL)
+			D_GOTO(out, rc = -DER_NOMEM);
+
+		batch->ab_ep = *ep;
+		batch->ab_flush_ts = d_timeus_secdiff(0) + crt_gdata.cg_agg_window;
+		rc = crt_agg_batch_pack(batch, rpc_priv);
+		if (rc != 0) {
+			D_FREE(batch);
+			D_GOTO(out, rc);
+		}
+		d_list_add_tail(&batch->ab_link, &ctx->cc_agg_list);
+	}
+
+out:
+	if (rc == 0) {
+		/* dropped in crt_agg_batch_complete */
+		RPC_ADDREF(rpc_priv);
+		rpc_priv->crp_agg = 1;
+		rpc_priv->crp_state = RPC_STATE_REQ_SENT;
+	}
+	D_MUTEX_UNLOCK(&ctx->cc_agg_mutex);
+
+	if (full != NULL)
+		crt_agg_batch_send(ctx, full);
+
+	if (rc != 0 && rc != -DER_OVERFLOW)
+		RPC_TRACE(DB_NET, rpc_priv, "not aggregated, " DF_RC "\n", DP_RC(rc));
+
+	return rc == 0;
+}
+
+/*
+ * Send the batches whose window expired, return the progress timeout clamped
+ * to the window of the pending batches.
+ */
+int64_t
+crt_agg_progress(struct crt_context *ctx, int64_t timeout)
+{
+	struct crt_agg_batch	*batch;
+	struct crt_agg_batch	*tmp;
+	d_list_t		 flush_list;
+	uint64_t		 now;
+
+	if (crt_gdata.cg_agg_window == 0)
+		return timeout;
+
+	D_INIT_LIST_HEAD(&flush_list);
+	now = d_timeus_secdiff(0);
+
+	D_MUTEX_LOCK(&ctx->cc_agg_mutex);
+	d_list_for_each_entry_safe(batch, tmp, &ctx->cc_agg_list, ab_link) {
+		if (batch->ab_flush_ts <= now)
+			d_list_move_tail(&batch->ab_link, &flush_list);
+		else if (timeout < 0 || batch->ab_flush_ts - now < timeout)
+			timeout = batch->ab_flush_ts - now;
+	}
+	D_MUTEX_UNLOCK(&ctx->cc_agg_mutex);
+
+	d_list_for_each_entry_safe(batch, tmp, &flush_list, ab_link) {
+		d_list_del(&batch->ab_link);
+		crt_agg_batch_send(ctx, batch);
+	}
+
+	return timeout;
+}
+
+void
+crt_agg_ctx_fini(struct crt_context *ctx)
+{
+	struct crt_agg_batch	*batch;
+	d_list_t		 fini_list;
+
+	D_INIT_LIST_HEAD(&fini_list);
+
+	D_MUTEX_LOCK(&ctx->cc_agg_mutex);
+	d_list_splice_init(&ctx->cc_agg_list, &fini_list);
+	D_MUTEX_UNLOCK(&ctx->cc_agg_mutex);
+
+	while ((batch = d_list_pop_entry(&fini_list, struct crt_agg_batch, ab_link)))
+		crt_agg_batch_complete(batch, NULL, -DER_CANCELED);
+}
+
+/* All replies are collected, pack them into the reply of the envelope */
+static void
+crt_agg_reply_flush(struct crt_agg_reply *ar)
+{
+	struct crt_rpc_priv	*env = ar->ar_env;
+	struct crt_agg_out	*out = crt_reply_get(&env->crp_pub);
+	struct crt_agg_msg_hdr	 hdr;
+	struct crt_agg_slot	*slot;
+	size_t			 size = 0;
+	size_t			 off = 0;
+	uint32_t		 i;
+	int			 rc;
+
+	for (i = 0; i < ar->ar_nr; i++)
+		size += CRT_AGG_MSG_SIZE(ar->ar_slots[i].as_len);
+
+	D_ALLOC(ar->ar_buf, size);
+	if (ar->ar_buf == NULL) {
+		env->crp_reply_hdr.cch_rc = -DER_NOMEM;
+		goto send;
+	}
+
+	for (i = 0; i < ar->ar_nr; i++) {
+		slot = &ar->ar_slots[i];
+		hdr.amh_len = slot->as_len;
+		hdr.amh_rc = slot->as_rc;
+		memcpy((char *)ar->ar_buf + off, &hdr, sizeof(hdr));
+		if (slot->as_len > 0)
+			memcpy((char *)ar->ar_buf + off + sizeof(hdr), slot->as_buf,
+			       slot->as_len);
+		off += CRT_AGG_MSG_SIZE(slot->as_len);
+		D_FREE(slot->as_buf);
+	}
+	d_iov_set(&out->ao_msgs, ar->ar_buf, size);
+
+send:
+	rc = crt_reply_send(&env->crp_pub);
+	if (rc != 0)
+		RPC_ERROR(env, "failed to reply %u RPCs, " DF_RC "\n", ar->ar_nr, DP_RC(rc));
+}
+
+static void
+crt_agg_reply_put(struct crt_agg_reply *ar)
+{
+	bool	done;
+
+	D_MUTEX_LOCK(&ar->ar_mutex);
+	D_ASSERT(ar->ar_pending > 0);
+	done = (--ar->ar_pending == 0);
+	D_MUTEX_UNLOCK(&ar->ar_mutex);
+
+	if (done)
+		crt_agg_reply_flush(ar);
+}
+
+static void
+crt_agg_reply_fill(struct crt_agg_reply *ar, uint32_t idx, void *buf, uint32_t len, int rc)
+{
+	struct crt_agg_slot	*slot = &ar->ar_slots[idx];
+
+	D_MUTEX_LOCK(&ar->ar_mutex);
+	if (slot->as_filled) {
+		D_MUTEX_UNLOCK(&ar->ar_mutex);
+		D_ERROR("duplicated reply of message %u\n", idx);
+		D_FREE(buf);
+		return;
+	}
+	slot->as_filled = true;
+	slot->as_buf = buf;
+	slot->as_len = len;
+	slot->as_rc = rc;
+	D_MUTEX_UNLOCK(&ar->ar_mutex);
+
+	crt_agg_reply_put(ar);
+}
+
+/* Pack the reply of the request unpacked from an envelope RPC */
+int
+crt_agg_reply_send(struct crt_rpc_priv *rpc_priv)
+{
+	struct crt_agg_reply	*ar = rpc_priv->crp_agg_env->crp_agg_reply;
+	size_t			 buf_size = crt_gdata.cg_agg_size;
+	size_t			 size;
+	void			*buf;
+	int			 rc;
+
+	D_ASSERT(rpc_priv->crp_srv);
+
+again:
+	D_ALLOC(buf, buf_size);
+	if (buf == NULL)
+		D_GOTO(out, rc = -DER_NOMEM);
+
+	rc = crt_proc_agg_pack(rpc_priv, true, buf, buf_size, &size);
+	if (rc == -DER_OVERFLOW && size > buf_size) {
+		D_FREE(buf);
+		buf_size = size;
+		goto again;
+	}
+
+out:
+	if (rc != 0) {
+		RPC_ERROR(rpc_priv, "failed to pack reply, " DF_RC "\n", DP_RC(rc));
+		D_FREE(buf);
+		size = 0;
+	}
+
+	crt_agg_reply_fill(ar, rpc_priv->crp_agg_idx, buf, size, rc);
+	return rc;
+}
+
+/* Unpack one request from the envelope and dispatch it to its handler */
+static int
+crt_agg_req_dispatch(struct crt_rpc_priv *env, uint32_t idx, void *buf, uint32_t len)
+{
+	struct crt_context	*crt_ctx = env->crp_pub.cr_ctx;
+	struct crt_rpc_priv	 rpc_tmp = {0};
+	struct crt_rpc_priv	*rpc_priv;
+	crt_rpc_t		*rpc_pub;
+	crt_proc_t		 proc = NULL;
+	int			 rc;
+
+	rpc_tmp.crp_hg_addr = env->crp_hg_addr;
+	rpc_tmp.crp_hg_hdl = env->crp_hg_hdl;
+	rpc_tmp.crp_pub.cr_ctx = crt_ctx;
+
+	rc = crt_proc_agg_unpack_header(buf, len, &rpc_tmp, &proc);
+	if (rc != 0)
+		return rc;
+
+	if (rpc_tmp.crp_flags & CRT_RPC_FLAG_COLL) {
+		crt_hg_unpack_cleanup(proc);
+		return -DER_PROTO;
+	}
+
+	rc = crt_rpc_priv_alloc(rpc_tmp.crp_req_hdr.cch_opc, &rpc_priv, false /* forward */);
+	if (rc != 0) {
+		crt_hg_unpack_cleanup(proc);
+		return rc;
+	}
+
+	rpc_pub = &rpc_priv->crp_pub;
+	crt_hg_header_copy(&rpc_tmp, rpc_priv);
+	rpc_priv->crp_fail_hlc = rpc_tmp.crp_fail_hlc;
+	rpc_pub->cr_ep.ep_rank = rpc_priv->crp_req_hdr.cch_dst_rank;
+	rpc_pub->cr_ep.ep_tag = rpc_priv->crp_req_hdr.cch_dst_tag;
+
+	crt_rpc_priv_init(rpc_priv, crt_ctx, true /* srv_flag */);
+
+	/* the HG handle and address are borrowed from the envelope */
+	rpc_priv->crp_agg = 1;
+	rpc_priv->crp_agg_idx = idx;
+	rpc_priv->crp_agg_env = env;
+	RPC_ADDREF(env);
+
+	RPC_TRACE(DB_ALL, rpc_priv, "unpacked from envelope %p, index %u.\n", env, idx);
+
+	/* From now on the failure is replied by crt_hg_reply_error_send */
+	if (rpc_pub->cr_input_size > 0) {
+		rc = crt_hg_unpack_body(rpc_priv, proc);
+		if (rc != 0) {
+			DHL_ERROR(rpc_priv, rc, "_unpack_body failed, opc: %#x", rpc_pub->cr_opc);
+			crt_hg_reply_error_send(rpc_priv, -DER_MISC);
+			D_GOTO(decref, rc);
+		}
+		rpc_priv->crp_input_got = 1;
+		rpc_pub->cr_ep.ep_grp = NULL;
+	} else {
+		crt_hg_unpack_cleanup(proc);
+	}
+
+	if (unlikely(rpc_priv->crp_opc_info->coi_rpc_cb == NULL)) {
+		crt_hg_reply_error_send(rpc_priv, -DER_UNREG);
+		D_GOTO(decref, rc = -DER_UNREG);
+	}
+
+	if (unlikely(rpc_priv->crp_fail_hlc)) {
+		crt_hg_reply_error_send(rpc_priv, -DER_HLC_SYNC);
+		D_GOTO(decref, rc = -DER_HLC_SYNC);
+	}
+
+	rc = crt_rpc_common_hdlr(rpc_priv);
+	if (unlikely(rc != 0)) {
+		RPC_ERROR(rpc_priv, "failed to invoke RPC handler, rc: " DF_RC "\n", DP_RC(rc));
+		crt_hg_reply_error_send(rpc_priv, rc);
+		D_GOTO(decref, rc);
+	}
+
+	return 0;
+
+decref:
+	RPC_DECREF(rpc_priv);
+	return 0;
+}
+
+void
+crt_hdlr_agg(crt_rpc_t *rpc_req)
+{
+	struct crt_rpc_priv	*env = container_of(rpc_req, struct crt_rpc_priv, crp_pub);
+	struct crt_agg_in	*in = crt_req_get(rpc_req);
+	struct crt_agg_reply	*ar;
+	void			*data;
+	uint32_t		 data_len;
+	uint32_t		 nr = 0;
+	uint32_t		 i;
+	size_t			 off = 0;
+	int			 rc;
+
+	while (off < in->ai_msgs.iov_len) {
+		rc = crt_agg_msg_next(in->ai_msgs.iov_buf, in->ai_msgs.iov_len, &off, &data,
+				      &data_len);
+		if (rc != 0 || ++nr > CRT_AGG_MSG_MAX) {
+			RPC_ERROR(env, "invalid message %u, " DF_RC "\n", nr, DP_RC(rc));
+			D_GOTO(failed, rc = -DER_PROTO);
+		}
+	}
+
+	if (nr == 0) {
+		RPC_ERROR(env, "empty envelope\n");
+		D_GOTO(failed, rc = -DER_PROTO);
+	}
+
+	D_ALLOC(ar, sizeof(*ar) + nr * sizeof(ar->ar_slots[0]));
+	if (ar == NULL)
+		D_GOTO(failed, rc = -DER_NOMEM);
+
+	rc = D_MUTEX_INIT(&ar->ar_mutex, NULL);
+	if (rc != 0) {
+		D_FREE(ar);
+		D_GOTO(failed, rc);
+	}
+
+	ar->ar_env = env;
+	ar->ar_nr = nr;
+	ar->ar_pending = nr + 1;
+	env->crp_agg_reply = ar;
+
+	for (i = 0, off = 0; i < nr; i++) {
+		crt_agg_msg_next(in->ai_msgs.iov_buf, in->ai_msgs.iov_len, &off, &data,
+				 &data_len);
+		rc = crt_agg_req_dispatch(env, i, data, data_len);
+		if (rc != 0)
+			crt_agg_reply_fill(ar, i, NULL, 0, rc);
+	}
+
+	crt_agg_reply_put(ar);
+	return;
+
+failed:
+	env->crp_reply_hdr.cch_rc = rc;
+	rc = crt_reply_send(rpc_req);
+	if (rc != 0)
+		RPC_ERROR(env, "crt_reply_send failed, " DF_RC "\n", DP_RC(rc));
+}
+
+/* Release the aggregation resources of the request or the envelope */
+void
+crt_agg_req_fini(struct crt_rpc_priv *rpc_priv)
+{
+	struct crt_agg_reply	*ar = rpc_priv->crp_agg_reply;
+	uint32_t		 i;
+
+	if (rpc_priv->crp_agg_env != NULL) {
+		RPC_DECREF(rpc_priv->crp_agg_env);
+		rpc_priv->crp_agg_env = NULL;
+	}
+
+	if (ar == NULL)
+		return;
+
+	for (i = 0; i < ar->ar_nr; i++)
+		D_FREE(ar->ar_slots[i].as_buf);
+	D_FREE(ar->ar_buf);
+	D_MUTEX_DESTROY(&ar->ar_mutex);
+	D_FREE(ar);
+	rpc_priv->crp_agg_reply = NULL;
+}
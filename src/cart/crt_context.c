@@ -141,7 +141,18 @@ crt_context_init(crt_context_t crt_ctx)
 	if (rc != 0)
 		D_GOTO(out, rc);
 
+	rc = D_MUTEX_INIT(&ctx->cc_agg_mutex, NULL);
+	if (rc != 0)
+		D_GOTO(out_mutex_destroy, rc);
+
 	D_INIT_LIST_HEAD(&ctx->cc_link);
+	D_INIT_LIST_HEAD(&ctx->cc_agg_list);
+	D_INIT_LIST_HEAD(&ctx->cc_corpc_poll_list);
+
+	/* start in blocking mode until the completions show up */
+	ctx->cc_prog.pa_gap = crt_gdata.cg_prog_block_gap;
+	ctx->cc_prog.pa_mode = CRT_PROG_BLOCK;
+	ctx->cc_prog.pa_last = d_timeus_secdiff(0);
 
 	/* create timeout binheap */
 	bh_node_cnt = CRT_DEFAULT_CREDITS_PER_EP_CTX * 64;
@@ -150,7 +161,7 @@ crt_context_init(crt_context_t crt_ctx)
 				      &ctx->cc_bh_timeout);
 	if (rc != 0) {
 		D_ERROR("d_binheap_create() failed, " DF_RC "\n", DP_RC(rc));
-		D_GOTO(out_mutex_destroy, rc);
+		D_GOTO(out_agg_mutex_destroy, rc);
 	}
 
 	/* create epi table, use external lock */
@@ -166,6 +177,8 @@ crt_context_init(crt_context_t crt_ctx)
 
 out_binheap_destroy:
 	d_binheap_destroy_inplace(&ctx->cc_bh_timeout);
+out_agg_mutex_destroy:
+	D_MUTEX_DESTROY(&ctx->cc_agg_mutex);
 out_mutex_destroy:
 	D_MUTEX_DESTROY(&ctx->cc_mutex);
 out:
@@ -308,6 +321,33 @@ crt_context_provider_create(crt_context_t *crt_ctx, crt_provider_t provider, boo
 		if (ret)
 			D_WARN("Failed to create failed addr counter: "DF_RC
 			       "\n", DP_RC(ret));
+
+		ret = d_tm_add_metric(&ctx->cc_prog_cpu, D_TM_COUNTER,
+				      "Total CPU time spent in network progress",
+				      "us", "net/%s/progress/cpu_time/ctx_%u",
+				      prov, ctx->cc_idx);
+		if (ret)
+			D_WARN("Failed to create progress CPU time counter: "
+			       DF_RC"\n", DP_RC(ret));
+
+		ret = d_tm_add_metric(&ctx->cc_prog_overshoot, D_TM_STATS_GAUGE,
+				      "Time a timed out blocking network progress "
+				      "returns past the sleep it asked for", "us",
+				      "net/%s/progress/sleep_overshoot/ctx_%u",
+				      prov, ctx->cc_idx);
+		if (ret)
+			D_WARN("Failed to create progress sleep overshoot: "
+			       DF_RC"\n", DP_RC(ret));
+
+		ret = d_tm_add_metric(&ctx->cc_prog_mode, D_TM_GAUGE,
+				      "Adaptive progress mode (0 spin, 1 spin "
+				      "then sleep, 2 sleep)", "mode",
+				      "net/%s/progress/mode/ctx_%u",
+				      prov, ctx->cc_idx);
+		if (ret)
+			D_WARN("Failed to create progress mode gauge: "DF_RC
+			       "\n", DP_RC(ret));
+		d_tm_set_gauge(ctx->cc_prog_mode, ctx->cc_prog.pa_mode);
 	}
 
 	if (crt_is_service() &&
@@ -692,6 +732,11 @@ crt_context_destroy(crt_context_t crt_ctx, int force)
 			D_GOTO(out, rc);
 	}
 
+	/* fail the RPCs not packed into an envelope RPC yet */
+	crt_agg_ctx_fini(ctx);
+	/* stop the pipelined corpc bulk pulls waiting to poll the parent */
+	crt_corpc_pipe_ctx_fini(ctx);
+
 	timeout_sec = crt_swim_rpc_timeout();
 	for (i = 0; i < CRT_SWIM_FLUSH_ATTEMPTS; i++) {
 		rc = crt_context_abort(ctx, force);
@@ -751,6 +796,7 @@ crt_context_destroy(crt_context_t crt_ctx, int force)
 	D_RWLOCK_UNLOCK(&crt_gdata.cg_rwlock);
 
 	D_MUTEX_DESTROY(&ctx->cc_mutex);
+	D_MUTEX_DESTROY(&ctx->cc_agg_mutex);
 	D_DEBUG(DB_TRACE, "destroyed context (idx %d, force %d)\n", ctx->cc_idx, force);
 	D_FREE(ctx);
 
@@ -1088,6 +1134,12 @@ crt_req_timeout_hdlr(struct crt_rpc_priv *rpc_priv)
 		 */
 		RPC_ERROR(rpc_priv, "aborting in-flight to group %s, rank %d, tgt_uri %s\n",
 			  grp_priv->gp_pub.cg_grpid, tgt_ep->ep_rank, rpc_priv->crp_tgt_uri);
+		if (rpc_priv->crp_agg) {
+			/* no HG handle to cancel, its envelope ignores it once completed */
+			crt_context_req_untrack(rpc_priv);
+			crt_rpc_complete_and_unlock(rpc_priv, -DER_TIMEDOUT);
+			break;
+		}
 		rc = crt_hg_req_cancel(rpc_priv);
 		if (rc != 0) {
 			RPC_ERROR(rpc_priv, "crt_hg_req_cancel failed, rc: %d, "
@@ -1228,7 +1280,11 @@ crt_context_req_track(struct crt_rpc_priv *rpc_priv)
 	rpc_priv->crp_epi = epi;
 	RPC_ADDREF(rpc_priv);
 
-	if (crt_gdata.cg_credit_ep_ctx != 0 &&
+	/*
+	 * The envelope of the aggregated RPCs is not throttled, the packed
+	 * RPCs already took their credits.
+	 */
+	if (crt_gdata.cg_credit_ep_ctx != 0 && rpc_priv->crp_pub.cr_opc != CRT_OPC_AGG &&
 	    (epi->epi_req_num - epi->epi_reply_num) >= crt_gdata.cg_credit_ep_ctx) {
 		if (rpc_priv->crp_opc_info->coi_queue_front) {
 			d_list_add(&rpc_priv->crp_epi_link,
@@ -1625,6 +1681,112 @@ crt_exec_progress_cb(struct crt_context *ctx, int64_t timeout)
 	return timeout;
 }
 
+/* Observe the completions for the adaptive mode, see crt_prog_gap_update() */
+static inline void
+crt_prog_observe(struct crt_context *ctx, uint64_t now)
+{
+	crt_prog_gap_update(&ctx->cc_prog, ctx->cc_hg_ctx.chc_completed, now,
+			    (uint64_t)crt_gdata.cg_prog_block_gap * 4);
+}
+
+/*
+ * Progress the network once, observe the completions for the adaptive mode and
+ * account the CPU time and the sleep overshoot if the sensors are enabled.
+ */
+static int
+crt_ctx_hg_progress(struct crt_context *ctx, int64_t timeout)
+{
+	struct timespec	cpu_start;
+	struct timespec	cpu_end;
+	uint64_t	start;
+	uint64_t	slept;
+	uint64_t	now;
+	int		rc;
+
+	if (!crt_gdata.cg_use_sensors && !crt_gdata.cg_prog_adaptive)
+		return crt_hg_progress(&ctx->cc_hg_ctx, timeout);
+
+	start = d_timeus_secdiff(0);
+	if (crt_gdata.cg_use_sensors && timeout != 0)
+		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_start);
+
+	rc = crt_hg_progress(&ctx->cc_hg_ctx, timeout);
+
+	now = d_timeus_secdiff(0);
+	crt_prog_observe(ctx, now);
+
+	if (!crt_gdata.cg_use_sensors)
+		return rc;
+
+	if (timeout == 0) {
+		/** non-blocking progress is on CPU all the time */
+		d_tm_inc_counter(ctx->cc_prog_cpu, now - start);
+		return rc;
+	}
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_end);
+	d_tm_inc_counter(ctx->cc_prog_cpu, d_timediff_ns(&cpu_start, &cpu_end) / 1000);
+
+	/**
+	 * mercury sleeps in milliseconds, a timed out wait returns that late past
+	 * the sleep it was asked for.
+	 */
+	slept = timeout > 0 ? timeout / 1000 * 1000 : 0;
+	if (rc == -DER_TIMEDOUT && slept > 0 && now - start > slept)
+		d_tm_set_gauge(ctx->cc_prog_overshoot, now - start - slept);
+
+	return rc;
+}
+
+/*
+ * Blocking progress with @timeout in microseconds, negative means infinite.
+ * In adaptive mode it picks the mode from the recent completion inter-arrival
+ * time: spin while the completions keep arriving quickly, spin shortly then
+ * sleep for a moderate rate, otherwise sleep directly to save the CPU. The
+ * spinning returns as soon as any completion is triggered.
+ */
+static int
+crt_prog_spin_cb(void *arg)
+{
+	return crt_ctx_hg_progress(arg, 0);
+}
+
+static int
+crt_progress_wait(struct crt_context *ctx, int64_t timeout)
+{
+	struct crt_prog_adapt	*pa = &ctx->cc_prog;
+	enum crt_prog_mode	 mode;
+	uint64_t		 spin;
+	int			 rc;
+
+	if (!crt_gdata.cg_prog_adaptive || timeout == 0)
+		return crt_ctx_hg_progress(ctx, timeout);
+
+	mode = crt_prog_mode_select(pa->pa_gap, crt_gdata.cg_prog_spin_gap,
+				    crt_gdata.cg_prog_block_gap);
+
+	if (mode != pa->pa_mode) {
+		D_DEBUG(DB_TRACE, "ctx %d progress mode %d -> %d, gap "DF_U64" us\n",
+			ctx->cc_idx, pa->pa_mode, mode, pa->pa_gap);
+		pa->pa_mode = mode;
+		if (crt_gdata.cg_use_sensors)
+			d_tm_set_gauge(ctx->cc_prog_mode, mode);
+	}
+
+	if (mode == CRT_PROG_BLOCK)
+		return crt_ctx_hg_progress(ctx, timeout);
+
+	spin = mode == CRT_PROG_SPIN ? crt_gdata.cg_prog_block_gap :
+				       crt_gdata.cg_prog_spin_gap;
+
+	/** spin until being idle for the spin period since the last completion */
+	rc = crt_prog_spin(pa, spin, &timeout, crt_prog_spin_cb, ctx);
+	if (rc <= 0)
+		return rc;
+
+	return crt_ctx_hg_progress(ctx, timeout);
+}
+
 int
 crt_progress_cond(crt_context_t crt_ctx, int64_t timeout,
 		  crt_progress_cond_cb_t cond_cb, void *arg)
@@ -1665,7 +1827,7 @@ crt_progress_cond(crt_context_t crt_ctx, int64_t timeout,
 	 * Call progress once before processing timeouts in case
 	 * any replies are pending in the queue
 	 */
-	rc = crt_hg_progress(&ctx->cc_hg_ctx, 0);
+	rc = crt_ctx_hg_progress(ctx, 0);
 	if (unlikely(rc && rc != -DER_TIMEDOUT)) {
 		D_ERROR("crt_hg_progress failed with %d\n", rc);
 		return rc;
@@ -1674,6 +1836,7 @@ crt_progress_cond(crt_context_t crt_ctx, int64_t timeout,
 	/** loop until callback returns non-null value */
 	while ((rc = cond_cb(arg)) == 0) {
 		crt_context_timeout_check(ctx);
+		timeout = crt_corpc_pipe_progress(ctx, timeout);
 		timeout = crt_exec_progress_cb(ctx, timeout);
 
 		if (timeout < 0) {
@@ -1693,7 +1856,7 @@ crt_progress_cond(crt_context_t crt_ctx, int64_t timeout,
 				hg_timeout = timeout;
 		}
 
-		rc = crt_hg_progress(&ctx->cc_hg_ctx, hg_timeout);
+		rc = crt_progress_wait(ctx, hg_timeout);
 		if (unlikely(rc && rc != -DER_TIMEDOUT)) {
 			D_ERROR("crt_hg_progress failed with %d\n", rc);
 			return rc;
@@ -1737,7 +1900,7 @@ crt_progress(crt_context_t crt_ctx, int64_t timeout)
 	 * call progress once w/o any timeout before processing timed out
 	 * requests in case any replies are pending in the queue
 	 */
-	rc = crt_hg_progress(&ctx->cc_hg_ctx, 0);
+	rc = crt_ctx_hg_progress(ctx, 0);
 	if (unlikely(rc && rc != -DER_TIMEDOUT))
 		D_ERROR("crt_hg_progress failed, rc: %d.\n", rc);
 
@@ -1746,11 +1909,13 @@ crt_progress(crt_context_t crt_ctx, int64_t timeout)
 	 * progress
 	 */
 	crt_context_timeout_check(ctx);
+	timeout = crt_agg_progress(ctx, timeout);
+	timeout = crt_corpc_pipe_progress(ctx, timeout);
 	timeout = crt_exec_progress_cb(ctx, timeout);
 
 	if (timeout != 0 && (rc == 0 || rc == -DER_TIMEDOUT)) {
 		/** call progress once again with the real timeout */
-		rc = crt_hg_progress(&ctx->cc_hg_ctx, timeout);
+		rc = crt_progress_wait(ctx, timeout);
 		if (unlikely(rc && rc != -DER_TIMEDOUT))
 			D_ERROR("crt_hg_progress failed, rc: %d.\n", rc);
 	}
@@ -255,6 +255,468 @@ out:
 	return rc;
 }
 
+/*
+ * Pipelined pull of a large chained bulk.
+ *
+ * The payload is pulled from the parent in chunks, with a few chunks in flight,
+ * into a buffer that starts with a 64-bit progress word, i.e. the length of the
+ * payload received so far. Unless the opcode has a pre-forward callback, which
+ * might look into the bulk, the RPC is forwarded to the children before the
+ * pull with CRT_CORPC_FLAG_PIPE and the bulk of the whole buffer, so that the
+ * children pull the chunks received already and poll the progress word for
+ * more, and the local RPC handler is invoked once the pull is done. So a large
+ * payload costs about one transfer time plus one chunk time per tree level,
+ * rather than one transfer time per tree level.
+ *
+ * The children do not read the progress word of parent back to back, the polls
+ * are scheduled on the context (cc_corpc_poll_list) and issued by its progress
+ * after an interval, which is reset once the parent made progress and doubled
+ * up to CRT_CORPC_POLL_MAX otherwise, so a parent waiting for its own parent
+ * is not flooded by RDMA reads.
+ *
+ * All the callbacks are called by the progress of the RPC context, so the pipe
+ * is not protected by lock.
+ */
+struct crt_corpc_pipe {
+	struct crt_rpc_priv	*cp_rpc_priv;
+	/* link to crt_context::cc_corpc_poll_list while a poll is scheduled */
+	d_list_t		 cp_poll_link;
+	/* when to issue the scheduled poll and the current interval, in us */
+	uint64_t		 cp_poll_ts;
+	uint32_t		 cp_poll_intv;
+	/* bulk of parent, freed once the pull is done */
+	crt_bulk_t		 cp_remote_hdl;
+	/* bulk of the progress word of parent, only for CRT_CORPC_FLAG_PIPE */
+	crt_bulk_t		 cp_poll_hdl;
+	/* bulk of the payload for the local RPC handler */
+	crt_bulk_t		 cp_local_hdl;
+	/* bulk of the whole buffer for children, only if forwarded early */
+	crt_bulk_t		 cp_fwd_hdl;
+	/* the progress word followed by the payload */
+	void			*cp_buf;
+	ATOMIC uint64_t		*cp_progress;
+	uint64_t		 cp_poll_val;
+	/* payload offset within cp_remote_hdl */
+	uint64_t		 cp_remote_off;
+	uint64_t		 cp_len;
+	uint64_t		 cp_chunk;
+	/* payload ready at parent, being pulled, and received contiguously */
+	uint64_t		 cp_ready;
+	uint64_t		 cp_issued;
+	uint64_t		 cp_done;
+	uint8_t			*cp_chunk_done;
+	uint32_t		 cp_inflight;
+	int			 cp_rc;
+	/* a poll is scheduled or in flight */
+	uint32_t		 cp_polling:1,
+				 cp_forwarded:1,
+				 cp_finished:1;
+};
+
+/* progress word of the failed pull, to stop the children */
+#define CRT_CORPC_PIPE_FAILED	UINT64_MAX
+
+static int crt_corpc_local_hdlr(struct crt_rpc_priv *rpc_priv);
+static void crt_corpc_local_fail(struct crt_rpc_priv *rpc_priv, int rc);
+static void crt_corpc_pipe_pump(struct crt_rpc_priv *rpc_priv);
+
+void
+crt_corpc_pipe_free(struct crt_rpc_priv *rpc_priv)
+{
+	struct crt_corpc_pipe	*pipe = rpc_priv->crp_corpc_pipe;
+
+	if (pipe == NULL)
+		return;
+
+	D_ASSERT(pipe->cp_inflight == 0 && !pipe->cp_polling);
+	if (rpc_priv->crp_coreq_hdr.coh_bulk_hdl == pipe->cp_local_hdl)
+		rpc_priv->crp_coreq_hdr.coh_bulk_hdl = CRT_BULK_NULL;
+	if (pipe->cp_remote_hdl != CRT_BULK_NULL)
+		crt_bulk_free(pipe->cp_remote_hdl);
+	if (pipe->cp_poll_hdl != CRT_BULK_NULL)
+		crt_bulk_free(pipe->cp_poll_hdl);
+	if (pipe->cp_local_hdl != CRT_BULK_NULL)
+		crt_bulk_free(pipe->cp_local_hdl);
+	if (pipe->cp_fwd_hdl != CRT_BULK_NULL)
+		crt_bulk_free(pipe->cp_fwd_hdl);
+	D_FREE(pipe->cp_chunk_done);
+	D_FREE(pipe->cp_buf);
+	D_FREE(pipe);
+	rpc_priv->crp_corpc_pipe = NULL;
+}
+
+static void
+crt_corpc_pipe_finish(struct crt_rpc_priv *rpc_priv)
+{
+	struct crt_corpc_pipe	*pipe = rpc_priv->crp_corpc_pipe;
+	int			 rc = pipe->cp_rc;
+
+	D_ASSERT(!pipe->cp_finished);
+	pipe->cp_finished = 1;
+
+	crt_bulk_free(pipe->cp_remote_hdl);
+	pipe->cp_remote_hdl = CRT_BULK_NULL;
+	if (pipe->cp_poll_hdl != CRT_BULK_NULL) {
+		crt_bulk_free(pipe->cp_poll_hdl);
+		pipe->cp_poll_hdl = CRT_BULK_NULL;
+	}
+
+	if (rc != 0) {
+		RPC_ERROR(rpc_priv, "pipelined bulk pull failed: "DF_RC"\n",
+			  DP_RC(rc));
+		atomic_store_release(pipe->cp_progress, CRT_CORPC_PIPE_FAILED);
+	}
+
+	if (pipe->cp_forwarded) {
+		if (rc == 0)
+			crt_corpc_local_hdlr(rpc_priv);
+		else
+			crt_corpc_local_fail(rpc_priv, rc);
+		return;
+	}
+
+	if (rc == 0) {
+		rpc_priv->crp_pub.cr_co_bulk_hdl = pipe->cp_local_hdl;
+		rc = crt_corpc_initiate(rpc_priv);
+		if (rc != 0)
+			RPC_ERROR(rpc_priv, "crt_corpc_initiate failed: "DF_RC"\n",
+				  DP_RC(rc));
+	}
+
+	if (rc != 0) {
+		rpc_priv->crp_coreq_hdr.coh_bulk_hdl = CRT_BULK_NULL;
+		crt_hg_reply_error_send(rpc_priv, rc);
+	}
+}
+
+static int
+crt_corpc_pipe_chunk_cb(const struct crt_bulk_cb_info *cb_info)
+{
+	struct crt_bulk_desc	*bulk_desc = cb_info->bci_bulk_desc;
+	struct crt_rpc_priv	*rpc_priv;
+	struct crt_corpc_pipe	*pipe;
+
+	rpc_priv = container_of(bulk_desc->bd_rpc, struct crt_rpc_priv, crp_pub);
+	pipe = rpc_priv->crp_corpc_pipe;
+	D_ASSERT(pipe != NULL && pipe->cp_inflight > 0);
+	pipe->cp_inflight--;
+
+	if (cb_info->bci_rc != 0) {
+		RPC_ERROR(rpc_priv, "chunk at "DF_U64" failed: "DF_RC"\n",
+			  bulk_desc->bd_local_off, DP_RC(cb_info->bci_rc));
+		if (pipe->cp_rc == 0)
+			pipe->cp_rc = cb_info->bci_rc;
+	} else {
+		pipe->cp_chunk_done[bulk_desc->bd_local_off / pipe->cp_chunk] = 1;
+		while (pipe->cp_done < pipe->cp_len &&
+		       pipe->cp_chunk_done[pipe->cp_done / pipe->cp_chunk])
+			pipe->cp_done = min(pipe->cp_done + pipe->cp_chunk, pipe->cp_len);
+		/* the payload must be in place before the children see it */
+		if (pipe->cp_rc == 0)
+			atomic_store_release(pipe->cp_progress, pipe->cp_done);
+	}
+
+	crt_corpc_pipe_pump(rpc_priv);
+	RPC_DECREF(rpc_priv);
+	return 0;
+}
+
+static int
+crt_corpc_pipe_poll_cb(const struct crt_bulk_cb_info *cb_info)
+{
+	struct crt_rpc_priv	*rpc_priv;
+	struct crt_corpc_pipe	*pipe;
+	int			 rc = cb_info->bci_rc;
+
+	rpc_priv = container_of(cb_info->bci_bulk_desc->bd_rpc,
+				struct crt_rpc_priv, crp_pub);
+	pipe = rpc_priv->crp_corpc_pipe;
+	D_ASSERT(pipe != NULL && pipe->cp_polling);
+	pipe->cp_polling = 0;
+
+	if (rc == 0 && pipe->cp_poll_val == CRT_CORPC_PIPE_FAILED) {
+		RPC_ERROR(rpc_priv, "parent failed to pull the bulk\n");
+		rc = -DER_IO;
+	} else if (rc == 0 && pipe->cp_poll_val > pipe->cp_len) {
+		RPC_ERROR(rpc_priv, "bad progress "DF_U64"/"DF_U64"\n",
+			  pipe->cp_poll_val, pipe->cp_len);
+		rc = -DER_PROTO;
+	}
+
+	if (rc != 0) {
+		if (pipe->cp_rc == 0)
+			pipe->cp_rc = rc;
+	} else if (pipe->cp_poll_val > pipe->cp_ready) {
+		pipe->cp_ready = pipe->cp_poll_val;
+		pipe->cp_poll_intv = CRT_CORPC_POLL_MIN;
+	} else {
+		pipe->cp_poll_intv = min(pipe->cp_poll_intv * 2, CRT_CORPC_POLL_MAX);
+	}
+
+	crt_corpc_pipe_pump(rpc_priv);
+	RPC_DECREF(rpc_priv);
+	return 0;
+}
+
+static int
+crt_corpc_pipe_get(struct crt_rpc_priv *rpc_priv, crt_bulk_t local_hdl,
+		   uint64_t local_off, uint64_t remote_off, uint64_t len,
+		   crt_bulk_cb_t complete_cb)
+{
+	struct crt_bulk_desc	bulk_desc;
+	int			rc;
+
+	bulk_desc.bd_rpc = &rpc_priv->crp_pub;
+	bulk_desc.bd_bulk_op = CRT_BULK_GET;
+	bulk_desc.bd_remote_hdl = rpc_priv->crp_corpc_pipe->cp_remote_hdl;
+	bulk_desc.bd_remote_off = remote_off;
+	bulk_desc.bd_local_hdl = local_hdl;
+	bulk_desc.bd_local_off = local_off;
+	bulk_desc.bd_len = len;
+
+	RPC_ADDREF(rpc_priv);
+	rc = crt_bulk_transfer(&bulk_desc, complete_cb, NULL, NULL);
+	if (rc != 0) {
+		RPC_ERROR(rpc_priv, "crt_bulk_transfer failed: "DF_RC"\n",
+			  DP_RC(rc));
+		RPC_DECREF(rpc_priv);
+	}
+
+	return rc;
+}
+
+/* Schedule a poll of the progress word of parent after the current interval. */
+static void
+crt_corpc_pipe_poll_sched(struct crt_rpc_priv *rpc_priv)
+{
+	struct crt_context	*ctx = rpc_priv->crp_pub.cr_ctx;
+	struct crt_corpc_pipe	*pipe = rpc_priv->crp_corpc_pipe;
+
+	pipe->cp_polling = 1;
+	pipe->cp_poll_ts = d_timeus_secdiff(0) + pipe->cp_poll_intv;
+
+	/* released once the poll is issued */
+	RPC_ADDREF(rpc_priv);
+	D_MUTEX_LOCK(&ctx->cc_mutex);
+	d_list_add_tail(&pipe->cp_poll_link, &ctx->cc_corpc_poll_list);
+	D_MUTEX_UNLOCK(&ctx->cc_mutex);
+}
+
+/*
+ * Issue the polls that are due, called by the progress of the context. Return
+ * the timeout shortened to the next scheduled poll.
+ */
+int64_t
+crt_corpc_pipe_progress(struct crt_context *ctx, int64_t timeout)
+{
+	struct crt_corpc_pipe	*pipe;
+	struct crt_corpc_pipe	*tmp;
+	struct crt_rpc_priv	*rpc_priv;
+	d_list_t		 poll_list;
+	uint64_t		 now;
+	int			 rc;
+
+	D_INIT_LIST_HEAD(&poll_list);
+	now = d_timeus_secdiff(0);
+
+	D_MUTEX_LOCK(&ctx->cc_mutex);
+	d_list_for_each_entry_safe(pipe, tmp, &ctx->cc_corpc_poll_list, cp_poll_link) {
+		if (pipe->cp_poll_ts <= now)
+			d_list_move_tail(&pipe->cp_poll_link, &poll_list);
+		else if (timeout < 0 || pipe->cp_poll_ts - now < timeout)
+			timeout = pipe->cp_poll_ts - now;
+	}
+	D_MUTEX_UNLOCK(&ctx->cc_mutex);
+
+	while ((pipe = d_list_pop_entry(&poll_list, struct crt_corpc_pipe, cp_poll_link))) {
+		rpc_priv = pipe->cp_rpc_priv;
+		rc = crt_corpc_pipe_get(rpc_priv, pipe->cp_poll_hdl, 0, 0,
+					sizeof(pipe->cp_poll_val),
+					crt_corpc_pipe_poll_cb);
+		if (rc != 0) {
+			pipe->cp_polling = 0;
+			if (pipe->cp_rc == 0)
+				pipe->cp_rc = rc;
+			crt_corpc_pipe_pump(rpc_priv);
+		}
+		RPC_DECREF(rpc_priv);
+	}
+
+	return timeout;
+}
+
+/* Cancel the scheduled polls of the context being destroyed. */
+void
+crt_corpc_pipe_ctx_fini(struct crt_context *ctx)
+{
+	struct crt_corpc_pipe	*pipe;
+	d_list_t		 poll_list;
+
+	D_INIT_LIST_HEAD(&poll_list);
+
+	D_MUTEX_LOCK(&ctx->cc_mutex);
+	d_list_splice_init(&ctx->cc_corpc_poll_list, &poll_list);
+	D_MUTEX_UNLOCK(&ctx->cc_mutex);
+
+	while ((pipe = d_list_pop_entry(&poll_list, struct crt_corpc_pipe, cp_poll_link))) {
+		pipe->cp_polling = 0;
+		if (pipe->cp_rc == 0)
+			pipe->cp_rc = -DER_CANCELED;
+		crt_corpc_pipe_pump(pipe->cp_rpc_priv);
+		RPC_DECREF(pipe->cp_rpc_priv);
+	}
+}
+
+/*
+ * Pull the chunks ready at parent, or poll the progress word of parent if the
+ * next chunk is not ready yet, and finish once nothing is in flight and either
+ * the whole payload is received or the pull failed.
+ */
+static void
+crt_corpc_pipe_pump(struct crt_rpc_priv *rpc_priv)
+{
+	struct crt_corpc_pipe	*pipe = rpc_priv->crp_corpc_pipe;
+	uint64_t		 len;
+	int			 rc;
+
+	while (pipe->cp_rc == 0 && pipe->cp_issued < pipe->cp_len &&
+	       pipe->cp_inflight < CRT_CORPC_BULK_WINDOW) {
+		len = min(pipe->cp_chunk, pipe->cp_len - pipe->cp_issued);
+		if (pipe->cp_issued + len > pipe->cp_ready)
+			break;
+
+		rc = crt_corpc_pipe_get(rpc_priv, pipe->cp_local_hdl,
+					pipe->cp_issued,
+					pipe->cp_remote_off + pipe->cp_issued,
+					len, crt_corpc_pipe_chunk_cb);
+		if (rc != 0) {
+			pipe->cp_rc = rc;
+			break;
+		}
+		pipe->cp_issued += len;
+		pipe->cp_inflight++;
+	}
+
+	/* window is not full, the next chunk is not ready at parent */
+	if (pipe->cp_rc == 0 && pipe->cp_issued < pipe->cp_len &&
+	    pipe->cp_inflight < CRT_CORPC_BULK_WINDOW && !pipe->cp_polling)
+		crt_corpc_pipe_poll_sched(rpc_priv);
+
+	if (pipe->cp_inflight == 0 && !pipe->cp_polling &&
+	    (pipe->cp_rc != 0 || pipe->cp_done == pipe->cp_len))
+		crt_corpc_pipe_finish(rpc_priv);
+}
+
+static int
+crt_corpc_pipe_bulk_create(struct crt_rpc_priv *rpc_priv, void *buf,
+			   size_t len, crt_bulk_perm_t perm, crt_bulk_t *hdl)
+{
+	d_sg_list_t	sgl;
+	d_iov_t		iov;
+	int		rc;
+
+	d_iov_set(&iov, buf, len);
+	sgl.sg_nr = 1;
+	sgl.sg_nr_out = 0;
+	sgl.sg_iovs = &iov;
+
+	rc = crt_bulk_create(rpc_priv->crp_pub.cr_ctx, &sgl, perm, hdl);
+	if (rc != 0)
+		RPC_ERROR(rpc_priv, "crt_bulk_create failed: "DF_RC"\n",
+			  DP_RC(rc));
+
+	return rc;
+}
+
+static int
+crt_corpc_pipe_start(struct crt_rpc_priv *rpc_priv, size_t bulk_len)
+{
+	struct crt_corpc_hdr	*co_hdr = &rpc_priv->crp_coreq_hdr;
+	struct crt_corpc_ops	*co_ops = rpc_priv->crp_opc_info->coi_co_ops;
+	struct crt_corpc_pipe	*pipe;
+	uint64_t		 chunk_nr;
+	int			 rc;
+
+	D_ALLOC_PTR(pipe);
+	if (pipe == NULL)
+		return -DER_NOMEM;
+
+	rpc_priv->crp_corpc_pipe = pipe;
+	pipe->cp_rpc_priv = rpc_priv;
+	pipe->cp_poll_intv = CRT_CORPC_POLL_MIN;
+	D_INIT_LIST_HEAD(&pipe->cp_poll_link);
+	pipe->cp_remote_hdl = co_hdr->coh_bulk_hdl;
+	co_hdr->coh_bulk_hdl = CRT_BULK_NULL;
+	pipe->cp_chunk = crt_gdata.cg_corpc_chunk != 0 ?
+			 crt_gdata.cg_corpc_chunk : CRT_CORPC_BULK_CHUNK_DEF;
+
+	if (co_hdr->coh_flags & CRT_CORPC_FLAG_PIPE) {
+		if (bulk_len <= sizeof(*pipe->cp_progress)) {
+			RPC_ERROR(rpc_priv, "bad pipelined bulk len %zu\n",
+				  bulk_len);
+			return -DER_PROTO;
+		}
+		pipe->cp_remote_off = sizeof(*pipe->cp_progress);
+		pipe->cp_len = bulk_len - pipe->cp_remote_off;
+	} else {
+		pipe->cp_len = bulk_len;
+		pipe->cp_ready = bulk_len;
+	}
+
+	chunk_nr = (pipe->cp_len + pipe->cp_chunk - 1) / pipe->cp_chunk;
+	D_ALLOC_ARRAY(pipe->cp_chunk_done, chunk_nr);
+	if (pipe->cp_chunk_done == NULL)
+		return -DER_NOMEM;
+
+	D_ALLOC(pipe->cp_buf, sizeof(*pipe->cp_progress) + pipe->cp_len);
+	if (pipe->cp_buf == NULL)
+		return -DER_NOMEM;
+	pipe->cp_progress = pipe->cp_buf;
+
+	rc = crt_corpc_pipe_bulk_create(rpc_priv, (char *)pipe->cp_buf +
+					sizeof(*pipe->cp_progress),
+					pipe->cp_len, CRT_BULK_RW,
+					&pipe->cp_local_hdl);
+	if (rc != 0)
+		return rc;
+
+	if (pipe->cp_remote_off != 0) {
+		rc = crt_corpc_pipe_bulk_create(rpc_priv, &pipe->cp_poll_val,
+						sizeof(pipe->cp_poll_val),
+						CRT_BULK_RW, &pipe->cp_poll_hdl);
+		if (rc != 0)
+			return rc;
+	}
+
+	if (crt_gdata.cg_corpc_chunk != 0 &&
+	    pipe->cp_len > crt_gdata.cg_corpc_chunk &&
+	    (co_ops == NULL || co_ops->co_pre_forward == NULL)) {
+		rc = crt_corpc_pipe_bulk_create(rpc_priv, pipe->cp_buf,
+						sizeof(*pipe->cp_progress) +
+						pipe->cp_len, CRT_BULK_RO,
+						&pipe->cp_fwd_hdl);
+		if (rc != 0)
+			return rc;
+
+		pipe->cp_forwarded = 1;
+		rpc_priv->crp_pub.cr_co_bulk_hdl = pipe->cp_local_hdl;
+		rc = crt_corpc_initiate(rpc_priv);
+		if (rc != 0) {
+			RPC_ERROR(rpc_priv, "crt_corpc_initiate failed: "
+				  DF_RC"\n", DP_RC(rc));
+			co_hdr->coh_bulk_hdl = CRT_BULK_NULL;
+			return rc;
+		}
+	}
+
+	RPC_TRACE(DB_NET, rpc_priv, "pull bulk of "DF_U64" bytes in chunks of "
+		  DF_U64", forwarded %d\n", pipe->cp_len, pipe->cp_chunk,
+		  pipe->cp_forwarded);
+
+	crt_corpc_pipe_pump(rpc_priv);
+	return 0;
+}
+
 /* only be called in crt_rpc_handler_common after RPC header unpacked */
 int
 crt_corpc_common_hdlr(struct crt_rpc_priv *rpc_priv)
@@ -289,6 +751,14 @@ crt_corpc_common_hdlr(struct crt_rpc_priv *rpc_priv)
 			D_GOTO(out, rc);
 		}
 
+		/* pipeline the large bulk or the one being pulled by parent */
+		if ((co_hdr->coh_flags & CRT_CORPC_FLAG_PIPE) ||
+		    (crt_gdata.cg_corpc_chunk != 0 &&
+		     bulk_len > crt_gdata.cg_corpc_chunk)) {
+			rc = crt_corpc_pipe_start(rpc_priv, bulk_len);
+			D_GOTO(out, rc);
+		}
+
 		D_ALLOC(bulk_iov.iov_buf, bulk_len);
 		if (bulk_iov.iov_buf == NULL)
 			D_GOTO(out, rc = -DER_NOMEM);
@@ -460,6 +930,7 @@ corpc_add_child_rpc(struct crt_rpc_priv *parent_rpc_priv,
 	crt_rpc_t		*child_rpc;
 	struct crt_corpc_info	*co_info;
 	struct crt_corpc_hdr	*parent_co_hdr, *child_co_hdr;
+	struct crt_corpc_pipe	*pipe;
 
 	D_ASSERT(parent_rpc_priv != NULL);
 	D_ASSERT(child_rpc_priv != NULL);
@@ -485,14 +956,23 @@ corpc_add_child_rpc(struct crt_rpc_priv *parent_rpc_priv,
 	parent_co_hdr = &parent_rpc_priv->crp_coreq_hdr;
 	child_co_hdr = &child_rpc_priv->crp_coreq_hdr;
 	child_co_hdr->coh_grpid = parent_co_hdr->coh_grpid;
-	/* child's coh_bulk_hdl is different with parent_co_hdr */
-	child_co_hdr->coh_bulk_hdl = parent_rpc_priv->crp_pub.cr_co_bulk_hdl;
+	/*
+	 * child's coh_bulk_hdl is different with parent_co_hdr, it is the whole
+	 * buffer with the progress word if the RPC is forwarded while pulling.
+	 */
+	pipe = parent_rpc_priv->crp_corpc_pipe;
+	if (pipe != NULL && pipe->cp_forwarded) {
+		child_co_hdr->coh_bulk_hdl = pipe->cp_fwd_hdl;
+		child_co_hdr->coh_flags = parent_co_hdr->coh_flags | CRT_CORPC_FLAG_PIPE;
+	} else {
+		child_co_hdr->coh_bulk_hdl = parent_rpc_priv->crp_pub.cr_co_bulk_hdl;
+		child_co_hdr->coh_flags = parent_co_hdr->coh_flags & ~CRT_CORPC_FLAG_PIPE;
+	}
 	child_co_hdr->coh_filter_ranks = parent_co_hdr->coh_filter_ranks;
 	child_co_hdr->coh_inline_ranks = parent_co_hdr->coh_inline_ranks;
 	child_co_hdr->coh_grp_ver = parent_co_hdr->coh_grp_ver;
 	child_co_hdr->coh_tree_topo = parent_co_hdr->coh_tree_topo;
 	child_co_hdr->coh_root = parent_co_hdr->coh_root;
-	child_co_hdr->coh_padding = parent_co_hdr->coh_padding;
 
 	co_info = parent_rpc_priv->crp_corpc_info;
 
@@ -558,12 +1038,16 @@ crt_corpc_complete(struct crt_rpc_priv *rpc_priv)
 		 * on root node, don't need to free chained bulk handle as it is
 		 * created and passed in by user.
 		 */
-		rc = crt_corpc_free_chained_bulk(
-			rpc_priv->crp_coreq_hdr.coh_bulk_hdl);
-		if (rc != 0)
-			RPC_ERROR(rpc_priv,
-				  "crt_corpc_free_chainded_bulk failed: "
-				  DF_RC"\n", DP_RC(rc));
+		if (rpc_priv->crp_corpc_pipe != NULL) {
+			crt_corpc_pipe_free(rpc_priv);
+		} else {
+			rc = crt_corpc_free_chained_bulk(
+				rpc_priv->crp_coreq_hdr.coh_bulk_hdl);
+			if (rc != 0)
+				RPC_ERROR(rpc_priv,
+					  "crt_corpc_free_chainded_bulk failed: "
+					  DF_RC"\n", DP_RC(rc));
+		}
 		/*
 		 * reset it to NULL to avoid crt_proc_corpc_hdr->
 		 * crt_proc_crt_bulk_t free the bulk handle again.
@@ -918,26 +1402,12 @@ forward_done:
 		D_GOTO(out, rc);
 	}
 
-	/* invoke RPC handler on local node */
-	rc = crt_rpc_common_hdlr(rpc_priv);
-	if (rc != 0) {
-		RPC_ERROR(rpc_priv, "crt_rpc_common_hdlr failed: "DF_RC"\n",
-			  DP_RC(rc));
-		crt_corpc_fail_child_rpc(rpc_priv, 1, rc);
+	/* the local RPC handler is invoked once the pipelined pull is done */
+	if (rpc_priv->crp_corpc_pipe != NULL &&
+	    !rpc_priv->crp_corpc_pipe->cp_finished)
+		D_GOTO(out, rc = 0);
 
-		D_SPIN_LOCK(&rpc_priv->crp_lock);
-		co_info->co_local_done = 1;
-		rpc_priv->crp_reply_pending = 0;
-		D_SPIN_UNLOCK(&rpc_priv->crp_lock);
-
-		/* Handle ref count difference between call on root vs
-		 * call on intermediate nodes
-		 */
-		if (co_info->co_root != co_info->co_grp_priv->gp_self)
-			RPC_DECREF(rpc_priv);
-
-		rc = 0;
-	}
+	rc = crt_corpc_local_hdlr(rpc_priv);
 
 out:
 	if (children_rank_list != NULL)
@@ -945,3 +1415,38 @@ out:
 
 	return rc;
 }
+
+static void
+crt_corpc_local_fail(struct crt_rpc_priv *rpc_priv, int rc)
+{
+	struct crt_corpc_info	*co_info = rpc_priv->crp_corpc_info;
+
+	crt_corpc_fail_child_rpc(rpc_priv, 1, rc);
+
+	D_SPIN_LOCK(&rpc_priv->crp_lock);
+	co_info->co_local_done = 1;
+	rpc_priv->crp_reply_pending = 0;
+	D_SPIN_UNLOCK(&rpc_priv->crp_lock);
+
+	/* Handle ref count difference between call on root vs
+	 * call on intermediate nodes
+	 */
+	if (co_info->co_root != co_info->co_grp_priv->gp_self)
+		RPC_DECREF(rpc_priv);
+}
+
+/* invoke RPC handler on local node */
+static int
+crt_corpc_local_hdlr(struct crt_rpc_priv *rpc_priv)
+{
+	int	rc;
+
+	rc = crt_rpc_common_hdlr(rpc_priv);
+	if (rc != 0) {
+		RPC_ERROR(rpc_priv, "crt_rpc_common_hdlr failed: "DF_RC"\n",
+			  DP_RC(rc));
+		crt_corpc_local_fail(rpc_priv, rc);
+	}
+
+	return 0;
+}
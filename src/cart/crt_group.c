@@ -1088,9 +1088,15 @@ crt_grp_priv_create(struct crt_grp_priv **grp_priv_created,
 	if (rc)
 		D_GOTO(out_swim_lock, rc);
 
+	rc = D_MUTEX_INIT(&grp_priv->gp_dom_mutex, NULL);
+	if (rc)
+		D_GOTO(out_rwlock, rc);
+
 	*grp_priv_created = grp_priv;
 	return rc;
 
+out_rwlock:
+	D_RWLOCK_DESTROY(&grp_priv->gp_rwlock);
 out_swim_lock:
 	D_SPIN_DESTROY(&csm->csm_lock);
 out_grpid:
@@ -1172,9 +1178,15 @@ crt_grp_priv_destroy(struct crt_grp_priv *grp_priv)
 		d_hash_table_destroy_inplace(&grp_priv->gp_s2p_table, true);
 	}
 
+	crt_dom_cache_free(grp_priv->gp_dom_cache);
+	d_rank_list_free(grp_priv->gp_dom_ranks);
+	D_FREE(grp_priv->gp_dom_ids);
+	d_rank_list_free(grp_priv->gp_dom_next_ranks);
+	D_FREE(grp_priv->gp_dom_next_ids);
 	D_FREE(grp_priv->gp_psr_phy_addr);
 	D_FREE(grp_priv->gp_pub.cg_grpid);
 
+	D_MUTEX_DESTROY(&grp_priv->gp_dom_mutex);
 	D_RWLOCK_DESTROY(&grp_priv->gp_rwlock);
 	D_FREE(grp_priv);
 }
@@ -1427,6 +1439,29 @@ out:
 	return rc;
 }
 
+/*
+ * Install the domains staged for the new membership version, if any. Called
+ * with gp_rwlock write locked after gp_membs_ver has been changed.
+ */
+static void
+crt_grp_dom_next_apply(struct crt_grp_priv *grp_priv)
+{
+	if (!grp_priv->gp_dom_next_set || grp_priv->gp_dom_next_ver != grp_priv->gp_membs_ver)
+		return;
+
+	d_rank_list_free(grp_priv->gp_dom_ranks);
+	D_FREE(grp_priv->gp_dom_ids);
+	crt_dom_cache_free(grp_priv->gp_dom_cache);
+	grp_priv->gp_dom_cache = NULL;
+	grp_priv->gp_dom_ranks = grp_priv->gp_dom_next_ranks;
+	grp_priv->gp_dom_ids = grp_priv->gp_dom_next_ids;
+	grp_priv->gp_dom_lvls = grp_priv->gp_dom_next_lvls;
+	grp_priv->gp_dom_ver = grp_priv->gp_dom_next_ver;
+	grp_priv->gp_dom_next_ranks = NULL;
+	grp_priv->gp_dom_next_ids = NULL;
+	grp_priv->gp_dom_next_set = false;
+}
+
 int
 crt_group_version_set(crt_group_t *grp, uint32_t version)
 {
@@ -1446,6 +1481,83 @@ crt_group_version_set(crt_group_t *grp, uint32_t version)
 
 	D_RWLOCK_WRLOCK(&grp_priv->gp_rwlock);
 	grp_priv->gp_membs_ver = version;
+	crt_grp_dom_next_apply(grp_priv);
+	D_RWLOCK_UNLOCK(&grp_priv->gp_rwlock);
+
+out:
+	return rc;
+}
+
+int
+crt_group_domains_set(crt_group_t *grp, d_rank_list_t *ranks, uint32_t *domains,
+		      uint32_t levels, uint32_t version)
+{
+	struct crt_grp_priv	*grp_priv;
+	d_rank_list_t		*dom_ranks = NULL;
+	uint32_t		*dom_ids = NULL;
+	uint32_t		 i;
+	int			 idx;
+	int			 rc = 0;
+
+	if (!crt_initialized()) {
+		D_ERROR("CRT not initialized.\n");
+		D_GOTO(out, rc = -DER_UNINIT);
+	}
+
+	grp_priv = crt_grp_pub2priv(grp);
+	if (!grp_priv) {
+		D_ERROR("Invalid group\n");
+		D_GOTO(out, rc = -DER_INVAL);
+	}
+
+	if (levels > 0) {
+		if (ranks == NULL || ranks->rl_nr == 0 || domains == NULL) {
+			D_ERROR("Invalid domain parameters\n");
+			D_GOTO(out, rc = -DER_INVAL);
+		}
+
+		rc = d_rank_list_dup_sort_uniq(&dom_ranks, ranks);
+		if (rc != 0)
+			D_GOTO(out, rc);
+
+		D_ALLOC_ARRAY(dom_ids, dom_ranks->rl_nr * levels);
+		if (dom_ids == NULL) {
+			d_rank_list_free(dom_ranks);
+			D_GOTO(out, rc = -DER_NOMEM);
+		}
+
+		for (i = 0; i < ranks->rl_nr; i++) {
+			idx = grp_dom_rank_idx(dom_ranks, ranks->rl_ranks[i]);
+			D_ASSERT(idx >= 0);
+			memcpy(&dom_ids[idx * levels], &domains[i * levels],
+			       sizeof(*dom_ids) * levels);
+		}
+	}
+
+	D_RWLOCK_WRLOCK(&grp_priv->gp_rwlock);
+	if (version > grp_priv->gp_membs_ver) {
+		/*
+		 * Keep the domains of the current version in use until the group
+		 * reaches the new version, so that all the members keep building
+		 * the same tree for the current version.
+		 */
+		d_rank_list_free(grp_priv->gp_dom_next_ranks);
+		D_FREE(grp_priv->gp_dom_next_ids);
+		grp_priv->gp_dom_next_ranks = dom_ranks;
+		grp_priv->gp_dom_next_ids = dom_ids;
+		grp_priv->gp_dom_next_lvls = levels;
+		grp_priv->gp_dom_next_ver = version;
+		grp_priv->gp_dom_next_set = true;
+	} else {
+		d_rank_list_free(grp_priv->gp_dom_ranks);
+		D_FREE(grp_priv->gp_dom_ids);
+		crt_dom_cache_free(grp_priv->gp_dom_cache);
+		grp_priv->gp_dom_cache = NULL;
+		grp_priv->gp_dom_ranks = dom_ranks;
+		grp_priv->gp_dom_ids = dom_ids;
+		grp_priv->gp_dom_lvls = levels;
+		grp_priv->gp_dom_ver = version;
+	}
 	D_RWLOCK_UNLOCK(&grp_priv->gp_rwlock);
 
 out:
@@ -3522,6 +3634,7 @@ crt_group_primary_modify(crt_group_t *grp, crt_context_t *ctxs, int num_ctxs, d_
 	d_rank_list_free(to_remove);
 
 	grp_priv->gp_membs_ver = version;
+	crt_grp_dom_next_apply(grp_priv);
 unlock:
 	D_RWLOCK_UNLOCK(&grp_priv->gp_rwlock);
 
@@ -3627,6 +3740,7 @@ crt_group_secondary_modify(crt_group_t *grp, d_rank_list_t *sec_ranks,
 	d_rank_list_free(to_remove);
 
 	grp_priv->gp_membs_ver = version;
+	crt_grp_dom_next_apply(grp_priv);
 unlock:
 	D_RWLOCK_UNLOCK(&grp_priv->gp_rwlock);
 
@@ -107,6 +107,28 @@ struct crt_grp_priv {
 	/* Secondary to primary rank mapping table */
 	struct d_hash_table	 gp_s2p_table;
 
+	/*
+	 * Fault domains of the members for CRT_TREE_DOMAIN, gp_dom_ranks is
+	 * sorted, gp_dom_ids holds gp_dom_lvls IDs for each of them. They are
+	 * only used when gp_dom_ver matches gp_membs_ver.
+	 */
+	d_rank_list_t		*gp_dom_ranks;
+	uint32_t		*gp_dom_ids;
+	uint32_t		 gp_dom_lvls;
+	uint32_t		 gp_dom_ver;
+	/*
+	 * Domains set for a future membership version, they replace the above
+	 * ones when the group reaches gp_dom_next_ver.
+	 */
+	d_rank_list_t		*gp_dom_next_ranks;
+	uint32_t		*gp_dom_next_ids;
+	uint32_t		 gp_dom_next_lvls;
+	uint32_t		 gp_dom_next_ver;
+	bool			 gp_dom_next_set;
+	/* cached domain tree, protected by gp_dom_mutex */
+	struct crt_dom_cache	*gp_dom_cache;
+	pthread_mutex_t		 gp_dom_mutex;
+
 	/* set of variables only valid in primary service groups */
 	uint32_t		 gp_primary:1, /* flag of primary group */
 				 gp_view:1, /* flag to indicate it is a view */
@@ -119,6 +141,31 @@ struct crt_grp_priv {
 	pthread_rwlock_t	 gp_rwlock; /* protect all fields above */
 };
 
+/* Locate @rank in the sorted rank list, return its index or -1. */
+static inline int
+grp_dom_rank_idx(d_rank_list_t *ranks, d_rank_t rank)
+{
+	int		 lo = 0;
+	int		 hi;
+	int		 mid;
+
+	if (ranks == NULL)
+		return -1;
+
+	hi = ranks->rl_nr - 1;
+	while (lo <= hi) {
+		mid = (lo + hi) / 2;
+		if (ranks->rl_ranks[mid] == rank)
+			return mid;
+		if (ranks->rl_ranks[mid] < rank)
+			lo = mid + 1;
+		else
+			hi = mid - 1;
+	}
+
+	return -1;
+}
+
 static inline d_rank_list_t*
 grp_priv_get_membs(struct crt_grp_priv *priv)
 {
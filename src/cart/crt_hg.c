@@ -1232,6 +1232,13 @@ crt_hg_req_destroy(struct crt_rpc_priv *rpc_priv)
 	hg_return_t hg_ret;
 
 	D_ASSERT(rpc_priv != NULL);
+	if (rpc_priv->crp_agg) {
+		/* no HG handle of its own, see crt_agg.c */
+		crt_proc_agg_free(rpc_priv);
+		crt_rpc_priv_fini(rpc_priv);
+		D_GOTO(mem_free, 0);
+	}
+
 	if (rpc_priv->crp_output_got != 0) {
 		hg_ret = HG_Free_output(rpc_priv->crp_hg_hdl,
 					&rpc_priv->crp_pub.cr_output);
@@ -1480,6 +1487,9 @@ crt_hg_reply_send(struct crt_rpc_priv *rpc_priv)
 
 	D_ASSERT(rpc_priv != NULL);
 
+	if (rpc_priv->crp_agg)
+		return crt_agg_reply_send(rpc_priv);
+
 	RPC_ADDREF(rpc_priv);
 	hg_ret = HG_Respond(rpc_priv->crp_hg_hdl, crt_hg_reply_send_cb,
 			    rpc_priv, &rpc_priv->crp_pub.cr_output);
@@ -1505,6 +1515,12 @@ crt_hg_reply_error_send(struct crt_rpc_priv *rpc_priv, int error_code)
 
 	hg_out_struct = &rpc_priv->crp_pub.cr_output;
 	rpc_priv->crp_reply_hdr.cch_rc = error_code;
+	if (rpc_priv->crp_agg) {
+		crt_agg_reply_send(rpc_priv);
+		rpc_priv->crp_reply_pending = 0;
+		return;
+	}
+
 	hg_ret = HG_Respond(rpc_priv->crp_hg_hdl, NULL, NULL, hg_out_struct);
 	if (hg_ret != HG_SUCCESS) {
 		RPC_ERROR(rpc_priv,
@@ -1561,6 +1577,7 @@ crt_hg_progress(struct crt_hg_context *hg_ctx, int64_t timeout)
 			return crt_hgret_2_der(hg_ret);
 		}
 
+		hg_ctx->chc_completed += count;
 		if (count == 0 || rc)
 			/** nothing to trigger */
 			return rc;
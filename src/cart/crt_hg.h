@@ -123,6 +123,7 @@ struct crt_hg_context {
 	hg_context_t		*chc_bulkctx; /* bulk context */
 	struct crt_hg_pool	 chc_hg_pool; /* HG handle pool */
 	int			 chc_provider; /* provider */
+	uint64_t		 chc_completed; /* #triggered callbacks */
 };
 
 /* crt_hg.c */
@@ -153,6 +154,12 @@ void crt_hg_unpack_cleanup(crt_proc_t proc);
 int crt_hg_unpack_body(struct crt_rpc_priv *rpc_priv, crt_proc_t proc);
 int crt_proc_in_common(crt_proc_t proc, crt_rpc_input_t *data);
 int crt_proc_out_common(crt_proc_t proc, crt_rpc_output_t *data);
+int crt_proc_agg_pack(struct crt_rpc_priv *rpc_priv, bool reply, void *buf,
+		      size_t buf_size, size_t *size);
+int crt_proc_agg_unpack_header(void *buf, size_t buf_size, struct crt_rpc_priv *rpc_priv,
+			       crt_proc_t *proc);
+int crt_proc_agg_unpack_reply(struct crt_rpc_priv *rpc_priv, void *buf, size_t buf_size);
+void crt_proc_agg_free(struct crt_rpc_priv *rpc_priv);
 
 bool crt_provider_is_contig_ep(int provider);
 bool crt_provider_is_port_based(int provider);
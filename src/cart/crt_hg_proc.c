@@ -292,12 +292,12 @@ crt_proc_corpc_hdr(crt_proc_t proc, struct crt_corpc_hdr *hdr)
 		buf[0] = hdr->coh_grp_ver;
 		buf[1] = hdr->coh_tree_topo;
 		buf[2] = hdr->coh_root;
-		buf[3] = hdr->coh_padding;
+		buf[3] = hdr->coh_flags;
 	} else { /* DECODING(proc_op) */
 		hdr->coh_grp_ver   = buf[0];
 		hdr->coh_tree_topo = buf[1];
 		hdr->coh_root      = buf[2];
-		hdr->coh_padding   = buf[3];
+		hdr->coh_flags     = buf[3];
 	}
 
 out:
@@ -351,6 +351,54 @@ do {									\
 	}								\
 } while (0)
 
+/* Decode the common header (and the corpc header if any) of the request */
+static int
+crt_proc_req_hdr_decode(hg_proc_t hg_proc, struct crt_rpc_priv *rpc_priv)
+{
+	struct crt_context	*ctx = rpc_priv->crp_pub.cr_ctx;
+	uint64_t		 clock_offset;
+	int			 rc;
+
+	/* Decode header */
+	rc = crt_proc_common_hdr(hg_proc, &rpc_priv->crp_req_hdr);
+	if (rc != 0) {
+		RPC_ERROR(rpc_priv, "crt_proc_common_hdr failed: " DF_RC "\n", DP_RC(rc));
+		D_GOTO(out, rc);
+	}
+
+	/* Sync the HLC. Clients never decode requests. */
+	D_ASSERT(crt_is_service());
+	rc = d_hlc_get_msg(rpc_priv->crp_req_hdr.cch_hlc,
+			     &ctx->cc_last_unpack_hlc, &clock_offset);
+	if (rc != 0) {
+		REPORT_HLC_SYNC_ERR("failed to sync HLC for request: opc=%x ts="
+				    DF_U64" offset="DF_U64" from=%u\n",
+				    rpc_priv->crp_req_hdr.cch_opc,
+				    rpc_priv->crp_req_hdr.cch_hlc,
+				    clock_offset,
+				    rpc_priv->crp_req_hdr.cch_src_rank);
+
+		/* Fail all but SWIM requests. */
+		if (!crt_opc_is_swim(rpc_priv->crp_req_hdr.cch_opc))
+			rpc_priv->crp_fail_hlc = 1;
+
+		rc = 0;
+	}
+
+	rpc_priv->crp_flags = rpc_priv->crp_req_hdr.cch_flags;
+	if (rpc_priv->crp_flags & CRT_RPC_FLAG_COLL) {
+		rc = crt_proc_corpc_hdr(hg_proc, &rpc_priv->crp_coreq_hdr);
+		if (rc != 0) {
+			RPC_ERROR(rpc_priv, "crt_proc_corpc_hdr failed: "
+				  DF_RC"\n", DP_RC(rc));
+			D_GOTO(out, rc);
+		}
+	}
+
+out:
+	return rc;
+}
+
 /* For unpacking only the common header to know about the CRT opc */
 int
 crt_hg_unpack_header(hg_handle_t handle, struct crt_rpc_priv *rpc_priv,
@@ -369,7 +417,6 @@ crt_hg_unpack_header(hg_handle_t handle, struct crt_rpc_priv *rpc_priv,
 	hg_class_t		*hg_class;
 	struct crt_context	*ctx;
 	struct crt_hg_context	*hg_ctx;
-	uint64_t		 clock_offset;
 	hg_proc_t		 hg_proc = HG_PROC_NULL;
 	hg_return_t		 hg_ret = HG_SUCCESS;
 	int			 rc;
@@ -400,41 +447,9 @@ crt_hg_unpack_header(hg_handle_t handle, struct crt_rpc_priv *rpc_priv,
 		D_GOTO(out, rc = crt_hgret_2_der(hg_ret));
 	}
 
-	/* Decode header */
-	rc = crt_proc_common_hdr(hg_proc, &rpc_priv->crp_req_hdr);
-	if (rc != 0) {
-		RPC_ERROR(rpc_priv, "crt_proc_common_hdr failed: " DF_RC "\n", DP_RC(rc));
+	rc = crt_proc_req_hdr_decode(hg_proc, rpc_priv);
+	if (rc != 0)
 		D_GOTO(out, rc);
-	}
-
-	/* Sync the HLC. Clients never decode requests. */
-	D_ASSERT(crt_is_service());
-	rc = d_hlc_get_msg(rpc_priv->crp_req_hdr.cch_hlc,
-			     &ctx->cc_last_unpack_hlc, &clock_offset);
-	if (rc != 0) {
-		REPORT_HLC_SYNC_ERR("failed to sync HLC for request: opc=%x ts="
-				    DF_U64" offset="DF_U64" from=%u\n",
-				    rpc_priv->crp_req_hdr.cch_opc,
-				    rpc_priv->crp_req_hdr.cch_hlc,
-				    clock_offset,
-				    rpc_priv->crp_req_hdr.cch_src_rank);
-
-		/* Fail all but SWIM requests. */
-		if (!crt_opc_is_swim(rpc_priv->crp_req_hdr.cch_opc))
-			rpc_priv->crp_fail_hlc = 1;
-
-		rc = 0;
-	}
-
-	rpc_priv->crp_flags = rpc_priv->crp_req_hdr.cch_flags;
-	if (rpc_priv->crp_flags & CRT_RPC_FLAG_COLL) {
-		rc = crt_proc_corpc_hdr(hg_proc, &rpc_priv->crp_coreq_hdr);
-		if (rc != 0) {
-			RPC_ERROR(rpc_priv, "crt_proc_corpc_hdr failed: "
-				  DF_RC"\n", DP_RC(rc));
-			D_GOTO(out, rc);
-		}
-	}
 
 	*proc = hg_proc;
 
@@ -768,3 +783,118 @@ crp_proc_get_size_used(crt_proc_t proc)
 
 	return (size_t)hg_size;
 }
+
+/*
+ * Pack the request (or the reply if \a reply is true) of \a rpc_priv into
+ * \a buf for aggregation. The packed size is returned in \a size, if it does
+ * not fit into \a buf_size then -DER_OVERFLOW is returned and \a size is the
+ * required size.
+ */
+int
+crt_proc_agg_pack(struct crt_rpc_priv *rpc_priv, bool reply, void *buf,
+		  size_t buf_size, size_t *size)
+{
+	crt_proc_t	hg_proc;
+	hg_return_t	hg_ret;
+	int		rc;
+
+	rc = crt_proc_create(rpc_priv->crp_pub.cr_ctx, buf, buf_size,
+			     CRT_PROC_ENCODE, &hg_proc);
+	if (rc != 0)
+		return rc;
+
+	if (reply)
+		hg_ret = crt_proc_out_common(hg_proc, &rpc_priv->crp_pub.cr_output);
+	else
+		hg_ret = crt_proc_in_common(hg_proc, &rpc_priv->crp_pub.cr_input);
+	if (hg_ret != HG_SUCCESS) {
+		RPC_ERROR(rpc_priv, "failed to pack, hg_ret: " DF_HG_RC "\n",
+			  DP_HG_RC(hg_ret));
+		D_GOTO(out, rc = crt_hgret_2_der(hg_ret));
+	}
+
+	*size = hg_proc_get_size_used(hg_proc);
+	/* mercury grows into the extra buffer on overflow */
+	if (hg_proc_get_extra_buf(hg_proc) != NULL || *size > buf_size)
+		rc = -DER_OVERFLOW;
+
+out:
+	crt_proc_destroy(hg_proc);
+	return rc;
+}
+
+/* Unpack the header of an aggregated request, the body is unpacked by crt_hg_unpack_body */
+int
+crt_proc_agg_unpack_header(void *buf, size_t buf_size, struct crt_rpc_priv *rpc_priv,
+			   crt_proc_t *proc)
+{
+	crt_proc_t	hg_proc;
+	int		rc;
+
+	rc = crt_proc_create(rpc_priv->crp_pub.cr_ctx, buf, buf_size, CRT_PROC_DECODE,
+			     &hg_proc);
+	if (rc != 0)
+		return rc;
+
+	rc = crt_proc_req_hdr_decode(hg_proc, rpc_priv);
+	if (rc != 0) {
+		crt_proc_destroy(hg_proc);
+		return rc;
+	}
+
+	*proc = hg_proc;
+	return 0;
+}
+
+/* Unpack the reply of an aggregated request, return the RPC level error */
+int
+crt_proc_agg_unpack_reply(struct crt_rpc_priv *rpc_priv, void *buf, size_t buf_size)
+{
+	crt_proc_t	hg_proc;
+	hg_return_t	hg_ret;
+	int		rc;
+
+	rc = crt_proc_create(rpc_priv->crp_pub.cr_ctx, buf, buf_size, CRT_PROC_DECODE,
+			     &hg_proc);
+	if (rc != 0)
+		return rc;
+
+	hg_ret = crt_proc_out_common(hg_proc, &rpc_priv->crp_pub.cr_output);
+	crt_proc_destroy(hg_proc);
+	if (hg_ret != HG_SUCCESS) {
+		RPC_ERROR(rpc_priv, "failed to unpack reply, hg_ret: " DF_HG_RC "\n",
+			  DP_HG_RC(hg_ret));
+		return crt_hgret_2_der(hg_ret);
+	}
+
+	/* freed by crt_proc_agg_free */
+	rpc_priv->crp_output_got = 1;
+	if (rpc_priv->crp_fail_hlc)
+		return -DER_HLC_SYNC;
+
+	return rpc_priv->crp_reply_hdr.cch_rc;
+}
+
+/* Counterpart of HG_Free_input/HG_Free_output for the aggregated RPC */
+void
+crt_proc_agg_free(struct crt_rpc_priv *rpc_priv)
+{
+	crt_proc_t	hg_proc;
+	int		rc;
+
+	if (rpc_priv->crp_input_got == 0 && rpc_priv->crp_output_got == 0)
+		return;
+
+	rc = crt_proc_create(rpc_priv->crp_pub.cr_ctx, NULL, 0, CRT_PROC_FREE, &hg_proc);
+	if (rc != 0) {
+		RPC_ERROR(rpc_priv, "failed to free, " DF_RC "\n", DP_RC(rc));
+		return;
+	}
+
+	if (rpc_priv->crp_input_got != 0)
+		crt_proc_in_common(hg_proc, &rpc_priv->crp_pub.cr_input);
+	if (rpc_priv->crp_output_got != 0)
+		crt_proc_out_common(hg_proc, &rpc_priv->crp_pub.cr_output);
+
+	crt_proc_destroy(hg_proc);
+}
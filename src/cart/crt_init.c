@@ -72,7 +72,9 @@ dump_envariables(void)
 		"FI_UNIVERSE_SIZE", "CRT_ENABLE_MEM_PIN",
 		"FI_OFI_RXM_USE_SRX", "D_LOG_FLUSH", "CRT_MRC_ENABLE",
 		"CRT_SECONDARY_PROVIDER", "D_PROVIDER_AUTH_KEY", "D_PORT_AUTO_ADJUST",
-		"D_POLL_TIMEOUT"};
+		"D_POLL_TIMEOUT", "CRT_CORPC_BULK_CHUNK", "CRT_AGG_WINDOW",
+		"CRT_AGG_SIZE", "CRT_PROGRESS_ADAPTIVE", "CRT_PROGRESS_SPIN_GAP",
+		"CRT_PROGRESS_BLOCK_GAP"};
 
 	D_INFO("-- ENVARS: --\n");
 	for (i = 0; i < ARRAY_SIZE(envars); i++) {
@@ -236,6 +238,12 @@ static int data_init(int server, crt_init_options_t *opt)
 {
 	uint32_t	timeout;
 	uint32_t	credits;
+	uint32_t	chunk;
+	uint32_t	agg_window;
+	uint32_t	agg_size;
+	bool		prog_adaptive = false;
+	uint32_t	spin_gap;
+	uint32_t	block_gap;
 	uint32_t	fi_univ_size = 0;
 	uint32_t	mem_pin_enable = 0;
 	uint32_t	is_secondary;
@@ -327,6 +335,50 @@ static int data_init(int server, crt_init_options_t *opt)
 	crt_gdata.cg_credit_ep_ctx = credits;
 	D_ASSERT(crt_gdata.cg_credit_ep_ctx <= CRT_MAX_CREDITS_PER_EP_CTX);
 
+	chunk = CRT_CORPC_BULK_CHUNK_DEF;
+	d_getenv_int("CRT_CORPC_BULK_CHUNK", &chunk);
+	if (chunk != 0 && chunk < CRT_CORPC_BULK_CHUNK_MIN) {
+		D_DEBUG(DB_ALL, "ENV CRT_CORPC_BULK_CHUNK's value %u is below min "
+			"allowed value, use %u.\n", chunk, CRT_CORPC_BULK_CHUNK_MIN);
+		chunk = CRT_CORPC_BULK_CHUNK_MIN;
+	}
+	crt_gdata.cg_corpc_chunk = chunk;
+
+	agg_window = 0;
+	d_getenv_int("CRT_AGG_WINDOW", &agg_window);
+	agg_size = CRT_AGG_SIZE_DEF;
+	d_getenv_int("CRT_AGG_SIZE", &agg_size);
+	if (agg_size < CRT_AGG_SIZE_MIN || agg_size > CRT_AGG_SIZE_MAX) {
+		D_DEBUG(DB_ALL, "ENV CRT_AGG_SIZE's value %u is out of range [%u, %u], "
+			"use %u.\n", agg_size, CRT_AGG_SIZE_MIN, CRT_AGG_SIZE_MAX,
+			CRT_AGG_SIZE_DEF);
+		agg_size = CRT_AGG_SIZE_DEF;
+	}
+	if (agg_window != 0)
+		D_DEBUG(DB_ALL, "RPC aggregation enabled, window %u us, size %u.\n",
+			agg_window, agg_size);
+	crt_gdata.cg_agg_window = agg_window;
+	crt_gdata.cg_agg_size = agg_size;
+
+	d_getenv_bool("CRT_PROGRESS_ADAPTIVE", &prog_adaptive);
+	spin_gap = CRT_PROG_SPIN_GAP_DEF;
+	d_getenv_int("CRT_PROGRESS_SPIN_GAP", &spin_gap);
+	block_gap = CRT_PROG_BLOCK_GAP_DEF;
+	d_getenv_int("CRT_PROGRESS_BLOCK_GAP", &block_gap);
+	if (spin_gap >= block_gap) {
+		D_DEBUG(DB_ALL, "ENV CRT_PROGRESS_SPIN_GAP %u should be less than "
+			"CRT_PROGRESS_BLOCK_GAP %u, use %u and %u.\n", spin_gap, block_gap,
+			CRT_PROG_SPIN_GAP_DEF, CRT_PROG_BLOCK_GAP_DEF);
+		spin_gap = CRT_PROG_SPIN_GAP_DEF;
+		block_gap = CRT_PROG_BLOCK_GAP_DEF;
+	}
+	if (prog_adaptive)
+		D_DEBUG(DB_ALL, "Adaptive progress enabled, spin gap %u us, block gap "
+			"%u us.\n", spin_gap, block_gap);
+	crt_gdata.cg_prog_adaptive = prog_adaptive;
+	crt_gdata.cg_prog_spin_gap = spin_gap;
+	crt_gdata.cg_prog_block_gap = block_gap;
+
 	/** Enable statistics only for the server side and if requested */
 	if (opt && opt->cio_use_sensors && server) {
 		int	ret;
@@ -334,20 +386,44 @@ static int data_init(int server, crt_init_options_t *opt)
 		/** enable sensors */
 		crt_gdata.cg_use_sensors = true;
 
-		/** set up the global sensors */
-		ret = d_tm_add_metric(&crt_gdata.cg_uri_self, D_TM_COUNTER,
+		/**
+		 * set up the global sensors, they are bumped by the contexts of
+		 * all xstreams so each one updates its own slot
+		 */
+		ret = d_tm_add_metric(&crt_gdata.cg_uri_self, D_TM_COUNTER | D_TM_SHARDED,
 				      "total number of URI requests for self",
 				      "", "net/uri/lookup_self");
 		if (ret)
 			D_WARN("Failed to create uri self sensor: "DF_RC"\n",
 			       DP_RC(ret));
 
-		ret = d_tm_add_metric(&crt_gdata.cg_uri_other, D_TM_COUNTER,
+		ret = d_tm_add_metric(&crt_gdata.cg_uri_other, D_TM_COUNTER | D_TM_SHARDED,
 				      "total number of URI requests for other "
 				      "ranks", "", "net/uri/lookup_other");
 		if (ret)
 			D_WARN("Failed to create uri other sensor: "DF_RC"\n",
 			       DP_RC(ret));
+
+		ret = d_tm_add_metric(&crt_gdata.cg_iv_lease_hit, D_TM_COUNTER | D_TM_SHARDED,
+				      "total number of IV fetches served from "
+				      "leased values", "", "net/iv/lease_hit");
+		if (ret)
+			D_WARN("Failed to create iv lease hit sensor: "DF_RC"\n",
+			       DP_RC(ret));
+
+		ret = d_tm_add_metric(&crt_gdata.cg_iv_lease_miss, D_TM_COUNTER | D_TM_SHARDED,
+				      "total number of IV fetches on non-root "
+				      "without valid lease", "", "net/iv/lease_miss");
+		if (ret)
+			D_WARN("Failed to create iv lease miss sensor: "DF_RC"\n",
+			       DP_RC(ret));
+
+		ret = d_tm_add_metric(&crt_gdata.cg_iv_root_fetch, D_TM_COUNTER | D_TM_SHARDED,
+				      "total number of IV fetch requests served "
+				      "as root", "", "net/iv/root_fetch");
+		if (ret)
+			D_WARN("Failed to create iv root fetch sensor: "DF_RC"\n",
+			       DP_RC(ret));
 	}
 
 	gdata_init_flag = 1;
@@ -57,6 +57,78 @@ crt_bulk_desc_dup(struct crt_bulk_desc *bulk_desc_new,
 	*bulk_desc_new = *bulk_desc;
 }
 
+/*
+ * Account the completions triggered since the last observation, @completed in
+ * total at @now (us), into the moving average of the inter-arrival time. The
+ * gap before the first completion after an idle period is capped to @gap_max
+ * so that the average recovers quickly once the traffic resumes.
+ */
+static inline void
+crt_prog_gap_update(struct crt_prog_adapt *pa, uint64_t completed, uint64_t now,
+		    uint64_t gap_max)
+{
+	uint64_t	cnt;
+	uint64_t	gap;
+
+	cnt = completed - pa->pa_completed;
+	if (cnt == 0)
+		return;
+
+	gap = min((now - pa->pa_last) / cnt, gap_max);
+	pa->pa_gap = pa->pa_gap - (pa->pa_gap >> CRT_PROG_EWMA_SHIFT) +
+		     (gap >> CRT_PROG_EWMA_SHIFT);
+	pa->pa_completed = completed;
+	pa->pa_last = now;
+}
+
+/* Pick the progress mode from the average completion inter-arrival time (us) */
+static inline enum crt_prog_mode
+crt_prog_mode_select(uint64_t gap, uint32_t spin_gap, uint32_t block_gap)
+{
+	if (gap < spin_gap)
+		return CRT_PROG_SPIN;
+	if (gap < block_gap)
+		return CRT_PROG_SPIN_SLEEP;
+	return CRT_PROG_BLOCK;
+}
+
+/*
+ * Call @progress, a non-blocking progress observing the completions into @pa,
+ * until a completion is triggered, @timeout (us, negative means infinite)
+ * expires, or no completion was observed for @spin (us).
+ *
+ * eturn	0 on completion, -DER_TIMEDOUT on timeout, 1 once idle for
+ *		@spin, @timeout is then reduced by the time spun, otherwise
+ *		the error of @progress.
+ */
+static inline int
+crt_prog_spin(struct crt_prog_adapt *pa, uint64_t spin, int64_t *timeout,
+	      int (*progress)(void *arg), void *arg)
+{
+	uint64_t	completed = pa->pa_completed;
+	uint64_t	start;
+	uint64_t	now;
+	int		rc;
+
+	start = d_timeus_secdiff(0);
+	do {
+		rc = progress(arg);
+		if (unlikely(rc && rc != -DER_TIMEDOUT))
+			return rc;
+
+		if (pa->pa_completed != completed)
+			return 0;
+
+		now = d_timeus_secdiff(0);
+		if (*timeout > 0 && (int64_t)(now - start) >= *timeout)
+			return -DER_TIMEDOUT;
+	} while (now - pa->pa_last < spin);
+
+	if (*timeout > 0)
+		*timeout -= now - start;
+	return 1;
+}
+
 void
 crt_hdlr_proto_query(crt_rpc_t *rpc_req);
 
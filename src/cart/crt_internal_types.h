@@ -100,6 +100,29 @@ struct crt_gdata {
 	/** credits limitation for #in-flight RPCs per target EP CTX */
 	uint32_t		cg_credit_ep_ctx;
 
+	/**
+	 * chunk size of the pipelined collective RPC bulk, the bulk larger than
+	 * it is forwarded to children while being pulled, 0 means disabled.
+	 */
+	uint32_t		cg_corpc_chunk;
+
+	/**
+	 * window (us) to aggregate the small RPCs to the same target endpoint
+	 * context into one envelope RPC, 0 means disabled.
+	 */
+	uint32_t		cg_agg_window;
+	/** max packed size of the RPCs aggregated into one envelope RPC */
+	uint32_t		cg_agg_size;
+
+	/**
+	 * adaptive progress, the blocking progress spins, spins shortly then
+	 * sleeps or sleeps directly according to the completion inter-arrival
+	 * time (us) against the two thresholds, see crt_progress_wait().
+	 */
+	bool			cg_prog_adaptive;
+	uint32_t		cg_prog_spin_gap;
+	uint32_t		cg_prog_block_gap;
+
 	/** the global opcode map */
 	struct crt_opc_map	*cg_opc_map;
 	/** HG level global data */
@@ -138,6 +161,12 @@ struct crt_gdata {
 	 * others, of type counter
 	 */
 	struct d_tm_node_t	*cg_uri_other;
+	/** Total number of IV fetches served from the leased values */
+	struct d_tm_node_t	*cg_iv_lease_hit;
+	/** Total number of IV fetches on non-root nodes without valid lease */
+	struct d_tm_node_t	*cg_iv_lease_miss;
+	/** Total number of IV fetch requests served by this node as root */
+	struct d_tm_node_t	*cg_iv_root_fetch;
 	/** Number of cores on a system */
 	long			 cg_num_cores;
 };
@@ -184,6 +213,48 @@ extern struct crt_plugin_gdata		crt_plugin_gdata;
 #define CRT_DEFAULT_CREDITS_PER_EP_CTX	(32)
 #define CRT_MAX_CREDITS_PER_EP_CTX	(256)
 
+/* chunk size of the pipelined collective RPC bulk */
+#define CRT_CORPC_BULK_CHUNK_DEF	(1U << 20)
+#define CRT_CORPC_BULK_CHUNK_MIN	(4U << 10)
+/* max in-flight chunk transfers of a collective RPC bulk */
+#define CRT_CORPC_BULK_WINDOW		(4)
+/* interval range (us) of polling the progress of the parent's bulk pull */
+#define CRT_CORPC_POLL_MIN		(8)
+#define CRT_CORPC_POLL_MAX		(1000)
+
+/* aggregation of the small RPCs to the same target endpoint context */
+#define CRT_AGG_SIZE_DEF		(4U << 10)
+#define CRT_AGG_SIZE_MIN		(512)
+#define CRT_AGG_SIZE_MAX		(64U << 10)
+/* max RPCs aggregated into one envelope RPC */
+#define CRT_AGG_MSG_MAX			(64)
+
+/* default completion inter-arrival thresholds (us) of the adaptive progress */
+#define CRT_PROG_SPIN_GAP_DEF		(50)
+#define CRT_PROG_BLOCK_GAP_DEF		(2000)
+/* weight (1 / 2^shift) of the latest inter-arrival time in the average */
+#define CRT_PROG_EWMA_SHIFT		(3)
+
+enum crt_prog_mode {
+	/* spin until the completions stop for cg_prog_block_gap */
+	CRT_PROG_SPIN		= 0,
+	/* spin for cg_prog_spin_gap, then sleep */
+	CRT_PROG_SPIN_SLEEP	= 1,
+	/* sleep with the caller's timeout */
+	CRT_PROG_BLOCK		= 2,
+};
+
+/* per-context state of the adaptive progress */
+struct crt_prog_adapt {
+	/* completions seen by the last observation */
+	uint64_t		pa_completed;
+	/* time (us) of the last observed completion */
+	uint64_t		pa_last;
+	/* moving average of the completion inter-arrival time (us) */
+	uint64_t		pa_gap;
+	enum crt_prog_mode	pa_mode;
+};
+
 /* crt_context */
 struct crt_context {
 	d_list_t		 cc_link;	/** link to gdata.cg_ctx_list */
@@ -207,6 +278,14 @@ struct crt_context {
 	 */
 	pthread_mutex_t		 cc_mutex;
 
+	/** batches of the RPCs to be aggregated, see crt_agg.c */
+	d_list_t		 cc_agg_list;
+	/** mutex to protect cc_agg_list, innermost except cg_rwlock */
+	pthread_mutex_t		 cc_agg_mutex;
+
+	/** scheduled polls of the pipelined corpc bulk, protected by cc_mutex */
+	d_list_t		 cc_corpc_poll_list;
+
 	/** timeout per-context */
 	uint32_t		 cc_timeout_sec;
 	/** HLC time of last received RPC */
@@ -219,6 +298,15 @@ struct crt_context {
 	struct d_tm_node_t	*cc_timedout_uri;
 	/** Total number of failed address resolution, of type counter */
 	struct d_tm_node_t	*cc_failed_addr;
+	/** Time (us) of CPU spent in network progress, of type counter */
+	struct d_tm_node_t	*cc_prog_cpu;
+	/** Overshoot (us) of the timed out blocking progress, of type stats gauge */
+	struct d_tm_node_t	*cc_prog_overshoot;
+	/** Current adaptive progress mode, of type gauge */
+	struct d_tm_node_t	*cc_prog_mode;
+
+	/** adaptive progress state, only accessed by the progressing thread */
+	struct crt_prog_adapt	 cc_prog;
 
 	/** Stores self uri for the current context */
 	char			 cc_self_uri[CRT_ADDR_STR_MAX_LEN];
@@ -271,7 +359,8 @@ struct crt_opc_info {
 				 coi_coops_init:1,
 				 coi_no_reply:1, /* flag of one-way RPC */
 				 coi_queue_front:1, /* add to front of queue */
-				 coi_reset_timer:1; /* reset timer on timeout */
+				 coi_reset_timer:1, /* reset timer on timeout */
+				 coi_aggregate:1; /* packed into envelope RPC */
 
 	crt_rpc_cb_t		 coi_rpc_cb;
 	struct crt_corpc_ops	*coi_co_ops;
@@ -311,6 +400,16 @@ struct crt_opc_map {
 	struct crt_opc_map_L2	*com_map;
 };
 
+/* IV values leased by the root and cached on this node, see crt_iv_lease.c */
+struct crt_iv_lease_cache {
+	pthread_mutex_t		ilc_lock;
+	/* leased values, in the order of installation */
+	d_list_t		ilc_list;
+	uint32_t		ilc_nr;
+	/* bumped when any lease is broken, see crt_iv_lease_install() */
+	uint64_t		ilc_ver;
+};
+
 void
 crt_na_config_fini(bool primary, crt_provider_t provider);
 
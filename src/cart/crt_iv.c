@@ -74,6 +74,9 @@ struct iv_fetch_cb_info {
 
 	/* User private data */
 	void				*ifc_user_priv;
+
+	/* Lease version when the fetch RPC was issued */
+	uint64_t			 ifc_lease_ver;
 };
 
 /* Structure for storing of pending iv fetch operations */
@@ -119,6 +122,9 @@ struct crt_ivns_internal {
 	/* Lock for modification of pending list */
 	pthread_mutex_t			 cii_lock;
 
+	/* Values leased by the root, see crt_iv_lease.c */
+	struct crt_iv_lease_cache	 cii_lease;
+
 	/* Link to ns_list */
 	d_list_t			 cii_link;
 
@@ -167,6 +173,7 @@ ivns_destroy(struct crt_ivns_internal *ivns_internal)
 	/* addref in crt_grp_lookup_int_grpid or crt_iv_namespace_create */
 	crt_grp_priv_decref(ivns_internal->cii_grp_priv);
 
+	crt_iv_lease_cache_fini(&ivns_internal->cii_lease);
 	D_MUTEX_DESTROY(&ivns_internal->cii_lock);
 	D_SPIN_DESTROY(&ivns_internal->cii_ref_lock);
 
@@ -336,6 +343,57 @@ crt_ivf_key_in_progress_unset(struct crt_ivns_internal *ivns,
 	return false;
 }
 
+/*
+ * Get the value of the key from its leased copy on the non-root node. Return 0
+ * with @iv_value got from ivo_on_get() and filled by the copy, or -DER_NONEXIST
+ * if there is no valid lease.
+ */
+static int
+crt_iv_lease_get(struct crt_ivns_internal *ivns, struct crt_iv_ops *ops,
+		 uint32_t class_id, crt_iv_key_t *key, d_sg_list_t *iv_value,
+		 void **user_priv)
+{
+	int	rc;
+
+	if (crt_iv_lease_remain(&ivns->cii_lease, ivns, ops, class_id, key) == 0)
+		D_GOTO(out, rc = -DER_NONEXIST);
+
+	rc = ops->ivo_on_get(ivns, key, 0, CRT_IV_PERM_WRITE, iv_value,
+			     user_priv);
+	if (rc != 0) {
+		D_ERROR("ivo_on_get(): "DF_RC"\n", DP_RC(rc));
+		return rc;
+	}
+
+	rc = crt_iv_lease_copy(&ivns->cii_lease, ivns, ops, class_id, key,
+			       iv_value);
+	if (rc != 0) {
+		ops->ivo_on_put(ivns, iv_value, *user_priv);
+		memset(iv_value, 0, sizeof(*iv_value));
+	}
+out:
+	if (crt_gdata.cg_use_sensors)
+		d_tm_inc_counter(rc == 0 ? crt_gdata.cg_iv_lease_hit :
+				 crt_gdata.cg_iv_lease_miss, 1);
+	return rc;
+}
+
+/* Lease to grant along with the value of the key served by this node. */
+static uint32_t
+crt_iv_lease_grant(struct crt_ivns_internal *ivns, struct crt_iv_ops *ops,
+		   uint32_t class_id, crt_iv_key_t *key, d_rank_t root,
+		   void *user_priv)
+{
+	if (ivns->cii_grp_priv->gp_self != root)
+		return crt_iv_lease_remain(&ivns->cii_lease, ivns, ops,
+					   class_id, key);
+
+	if (ops->ivo_on_lease == NULL)
+		return 0;
+
+	return ops->ivo_on_lease(ivns, key, user_priv);
+}
+
 /* Add key to the list of pending requests */
 static int
 crt_ivf_pending_request_add(struct crt_ivns_internal *ivns_internal,
@@ -382,6 +440,15 @@ crt_ivf_finalize(struct iv_fetch_cb_info *iv_info, crt_iv_key_t *iv_key,
 	if (rpc) {
 		/* If there is child to respond to - bulk transfer to it */
 		if (output_rc == 0) {
+			struct crt_iv_fetch_out *output;
+
+			/* Pass on the lease granted by the parent */
+			output = crt_reply_get(rpc);
+			output->ifo_lease =
+				crt_iv_lease_remain(&iv_info->ifc_ivns_internal->cii_lease,
+						    iv_info->ifc_ivns_internal, iv_ops,
+						    iv_info->ifc_class_id, iv_key);
+
 			/* Note: function will increment ref count on 'rpc' */
 			rc = crt_ivf_bulk_transfer(iv_info->ifc_ivns_internal,
 						   iv_info->ifc_class_id,
@@ -500,6 +567,12 @@ crt_ivf_pending_reqs_process(struct crt_ivns_internal *ivns_internal,
 			}
 
 			if (rc == 0) {
+				output = crt_reply_get(iv_info->ifc_child_rpc);
+				output->ifo_lease =
+					crt_iv_lease_remain(&ivns_internal->cii_lease,
+							    ivns_internal, iv_ops, class_id,
+							    &iv_info->ifc_iv_key);
+
 				/* Function will do IVNS_ADDREF if needed */
 				rc = crt_ivf_bulk_transfer(ivns_internal,
 							class_id,
@@ -673,10 +746,19 @@ crt_ivns_internal_create(crt_context_t crt_ctx, struct crt_grp_priv *grp_priv,
 		D_GOTO(exit, ivns_internal = NULL);
 	}
 
+	rc = crt_iv_lease_cache_init(&ivns_internal->cii_lease);
+	if (rc != 0) {
+		D_SPIN_DESTROY(&ivns_internal->cii_ref_lock);
+		D_MUTEX_DESTROY(&ivns_internal->cii_lock);
+		D_FREE(ivns_internal);
+		D_GOTO(exit, ivns_internal = NULL);
+	}
+
 	ivns_internal->cii_ref_count = 1;
 
 	D_ALLOC_ARRAY(ivns_internal->cii_iv_classes, num_class);
 	if (ivns_internal->cii_iv_classes == NULL) {
+		crt_iv_lease_cache_fini(&ivns_internal->cii_lease);
 		D_MUTEX_DESTROY(&ivns_internal->cii_lock);
 		D_SPIN_DESTROY(&ivns_internal->cii_ref_lock);
 		D_FREE(ivns_internal);
@@ -1072,6 +1154,11 @@ handle_ivfetch_response(const struct crt_cb_info *cb_info)
 				rc == 0 ? &iv_info->ifc_iv_value : NULL,
 				false, rc, iv_info->ifc_user_priv);
 
+	if (rc == 0 && output->ifo_lease != 0)
+		crt_iv_lease_install(&ivns->cii_lease, ivns, iv_ops, class_id,
+				     &input->ifi_key, &iv_info->ifc_iv_value,
+				     output->ifo_lease, iv_info->ifc_lease_ver);
+
 	if (iv_info->ifc_bulk_hdl)
 		crt_bulk_free(iv_info->ifc_bulk_hdl);
 
@@ -1162,6 +1249,7 @@ crt_ivf_rpc_issue(d_rank_t dest_node, crt_iv_key_t *iv_key,
 	/* RPC is in progress */
 	entry->kip_rpc_in_progress = true;
 	entry->kip_refcnt++;
+	cb_info->ifc_lease_ver = crt_iv_lease_ver(&ivns_internal->cii_lease);
 
 	IV_DBG(iv_key, "kip_entry=%p refcnt=%d\n", entry, entry->kip_refcnt);
 
@@ -1356,18 +1444,40 @@ crt_hdlr_iv_fetch_aux(void *arg)
 	}
 
 	IV_DBG(&input->ifi_key, "fetch handler entered\n");
-	rc = iv_ops->ivo_on_get(ivns_internal, &input->ifi_key,
-				0, CRT_IV_PERM_READ, &iv_value, &user_priv);
-	if (rc != 0) {
-		D_ERROR("ivo_on_get(): "DF_RC"\n", DP_RC(rc));
-		D_GOTO(send_error, rc);
+	if (ivns_internal->cii_grp_priv->gp_self == input->ifi_root_node) {
+		if (crt_gdata.cg_use_sensors)
+			d_tm_inc_counter(crt_gdata.cg_iv_root_fetch, 1);
+		rc = -DER_NONEXIST;
+	} else {
+		rc = crt_iv_lease_get(ivns_internal, iv_ops, input->ifi_class_id,
+				      &input->ifi_key, &iv_value, &user_priv);
+		if (rc != 0 && rc != -DER_NONEXIST)
+			D_GOTO(send_error, rc);
 	}
 
-	put_needed = true;
+	if (rc == -DER_NONEXIST) {
+		rc = iv_ops->ivo_on_get(ivns_internal, &input->ifi_key,
+					0, CRT_IV_PERM_READ, &iv_value, &user_priv);
+		if (rc != 0) {
+			D_ERROR("ivo_on_get(): "DF_RC"\n", DP_RC(rc));
+			D_GOTO(send_error, rc);
+		}
+
+		put_needed = true;
+
+		rc = iv_ops->ivo_on_fetch(ivns_internal, &input->ifi_key, 0,
+					  0x0, &iv_value, user_priv);
+	} else {
+		put_needed = true;
+	}
 
-	rc = iv_ops->ivo_on_fetch(ivns_internal, &input->ifi_key, 0,
-				  0x0, &iv_value, user_priv);
 	if (rc == 0) {
+		output->ifo_lease = crt_iv_lease_grant(ivns_internal, iv_ops,
+						       input->ifi_class_id,
+						       &input->ifi_key,
+						       input->ifi_root_node,
+						       user_priv);
+
 		/* Note: This increments ref count on 'rpc_req' and ivns */
 		rc = crt_ivf_bulk_transfer(ivns_internal,
 					   input->ifi_class_id,
@@ -1659,16 +1769,28 @@ crt_iv_fetch(crt_iv_namespace_t ivns, uint32_t class_id,
 	if (iv_value == NULL)
 		D_GOTO(exit, rc = -DER_NOMEM);
 
-	rc = iv_ops->ivo_on_get(ivns_internal, iv_key, 0, CRT_IV_PERM_READ,
-				iv_value, &user_priv);
-	if (rc != 0) {
-		D_ERROR("ivo_on_get(): "DF_RC"\n", DP_RC(rc));
-		D_GOTO(exit, rc);
+	rc = -DER_NONEXIST;
+	if (root_rank != ivns_internal->cii_grp_priv->gp_self) {
+		rc = crt_iv_lease_get(ivns_internal, iv_ops, class_id, iv_key,
+				      iv_value, &user_priv);
+		if (rc != 0 && rc != -DER_NONEXIST)
+			D_GOTO(exit, rc);
 	}
-	put_needed = true;
 
-	rc = iv_ops->ivo_on_fetch(ivns_internal, iv_key, 0,
-				  0, iv_value, user_priv);
+	if (rc == -DER_NONEXIST) {
+		rc = iv_ops->ivo_on_get(ivns_internal, iv_key, 0, CRT_IV_PERM_READ,
+					iv_value, &user_priv);
+		if (rc != 0) {
+			D_ERROR("ivo_on_get(): "DF_RC"\n", DP_RC(rc));
+			D_GOTO(exit, rc);
+		}
+		put_needed = true;
+
+		rc = iv_ops->ivo_on_fetch(ivns_internal, iv_key, 0,
+					  0, iv_value, user_priv);
+	} else {
+		put_needed = true;
+	}
 
 	/* The fetch info is contained on current server.  */
 	if (rc == 0) {
@@ -1837,6 +1959,9 @@ crt_hdlr_iv_sync_aux(void *arg)
 	iv_ops = crt_iv_ops_get(ivns_internal, input->ivs_class_id);
 	D_ASSERT(iv_ops != NULL);
 
+	crt_iv_lease_break(&ivns_internal->cii_lease, ivns_internal, iv_ops,
+			   input->ivs_class_id, &input->ivs_key);
+
 	/* If bulk is not set, we issue invalidate call */
 	if (rpc_req->cr_co_bulk_hdl == CRT_BULK_NULL) {
 		rc = iv_ops->ivo_on_refresh(ivns_internal, &input->ivs_key,
@@ -3053,6 +3178,9 @@ crt_hdlr_iv_update(crt_rpc_t *rpc_req)
 		D_GOTO(send_error, rc = -DER_INVAL);
 	}
 
+	crt_iv_lease_break(&ivns_internal->cii_lease, ivns_internal, iv_ops,
+			   input->ivu_class_id, &input->ivu_key);
+
 	if (input->ivu_iv_value_bulk == CRT_BULK_NULL) {
 		rc = iv_ops->ivo_on_refresh(ivns_internal, &input->ivu_key,
 					    0, NULL, true, 0, NULL);
@@ -3266,6 +3394,9 @@ crt_iv_update_internal(crt_iv_namespace_t ivns, uint32_t class_id,
 		D_GOTO(exit, rc = -DER_INVAL);
 	}
 
+	crt_iv_lease_break(&ivns_internal->cii_lease, ivns_internal, iv_ops,
+			   class_id, iv_key);
+
 	/* Need to get a version number associated with root_rank. */
 	D_RWLOCK_RDLOCK(&ivns_internal->cii_grp_priv->gp_rwlock);
 	grp_ver =  ivns_internal->cii_grp_priv->gp_membs_ver;
@@ -0,0 +1,267 @@
+/*
+ * (C) Copyright 2023 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+/**
+ * This file is part of CaRT. It implements the cache of the IV values leased
+ * by the root.
+ *
+ * The root grants a lease (see crt_iv_ops::ivo_on_lease) along with the value
+ * it serves. Each node on the way back to the fetching node keeps a copy of the
+ * value, and serves the fetches of the key from the copy without calling into
+ * the user callbacks or forwarding to the parent until the lease expires. The
+ * update and invalidation of the key break the leases on the nodes they pass.
+ * The lease version guards against installing the value of an in-flight fetch
+ * that raced with a break.
+ */
+#define D_LOGFAC	DD_FAC(iv)
+
+#include "crt_internal.h"
+#include "cart/iv.h"
+
+/* Max leased values cached per namespace and max size of each value */
+#define CRT_IV_LEASE_MAX	(4096)
+#define CRT_IV_LEASE_VAL_MAX	(64U << 10)
+
+#define IV_DBG(key, msg, ...) \
+	D_DEBUG(DB_TRACE, "[key=%p] " msg, (key)->iov_buf, ##__VA_ARGS__)
+
+/* Value of a key leased by the root, cached on the nodes on the fetch path */
+struct crt_iv_lease {
+	/* Link to crt_iv_lease_cache::ilc_list */
+	d_list_t	il_link;
+	uint32_t	il_class_id;
+	/* Expiration time in microseconds */
+	uint64_t	il_expire;
+	crt_iv_key_t	il_key;
+	/* Number of iovs of the value and the size of each one */
+	uint32_t	il_nr;
+	size_t		*il_sizes;
+	char		*il_data;
+
+	/* Payload for il_sizes, il_key.iov_buf and il_data */
+	uintptr_t	il_payload[0];
+};
+
+int
+crt_iv_lease_cache_init(struct crt_iv_lease_cache *cache)
+{
+	int	rc;
+
+	rc = D_MUTEX_INIT(&cache->ilc_lock, NULL);
+	if (rc != 0)
+		return rc;
+
+	D_INIT_LIST_HEAD(&cache->ilc_list);
+	cache->ilc_nr = 0;
+	cache->ilc_ver = 0;
+
+	return 0;
+}
+
+void
+crt_iv_lease_cache_fini(struct crt_iv_lease_cache *cache)
+{
+	struct crt_iv_lease	*lease;
+
+	while ((lease = d_list_pop_entry(&cache->ilc_list,
+					 struct crt_iv_lease, il_link)))
+		D_FREE(lease);
+	cache->ilc_nr = 0;
+
+	D_MUTEX_DESTROY(&cache->ilc_lock);
+}
+
+static bool
+crt_iv_lease_key_match(crt_iv_namespace_t ivns, struct crt_iv_ops *ops,
+		       crt_iv_key_t *key1, crt_iv_key_t *key2)
+{
+	if (ops->ivo_keys_match)
+		return ops->ivo_keys_match(ivns, key1, key2);
+
+	return key1->iov_len == key2->iov_len &&
+	       memcmp(key1->iov_buf, key2->iov_buf, key1->iov_len) == 0;
+}
+
+static struct crt_iv_lease *
+crt_iv_lease_find(struct crt_iv_lease_cache *cache, crt_iv_namespace_t ivns,
+		  struct crt_iv_ops *ops, uint32_t class_id, crt_iv_key_t *key)
+{
+	struct crt_iv_lease	*lease;
+
+	d_list_for_each_entry(lease, &cache->ilc_list, il_link) {
+		if (lease->il_class_id != class_id)
+			continue;
+
+		if (crt_iv_lease_key_match(ivns, ops, &lease->il_key, key))
+			return lease;
+	}
+
+	return NULL;
+}
+
+static void
+crt_iv_lease_free(struct crt_iv_lease_cache *cache, struct crt_iv_lease *lease)
+{
+	d_list_del(&lease->il_link);
+	cache->ilc_nr--;
+	D_FREE(lease);
+}
+
+uint64_t
+crt_iv_lease_ver(struct crt_iv_lease_cache *cache)
+{
+	uint64_t	ver;
+
+	D_MUTEX_LOCK(&cache->ilc_lock);
+	ver = cache->ilc_ver;
+	D_MUTEX_UNLOCK(&cache->ilc_lock);
+
+	return ver;
+}
+
+/* Remaining lease of the key in milliseconds, 0 if there is no valid lease. */
+uint32_t
+crt_iv_lease_remain(struct crt_iv_lease_cache *cache, crt_iv_namespace_t ivns,
+		    struct crt_iv_ops *ops, uint32_t class_id, crt_iv_key_t *key)
+{
+	struct crt_iv_lease	*lease;
+	uint64_t		 now;
+	uint32_t		 remain = 0;
+
+	D_MUTEX_LOCK(&cache->ilc_lock);
+	if (d_list_empty(&cache->ilc_list))
+		goto out;
+
+	lease = crt_iv_lease_find(cache, ivns, ops, class_id, key);
+	if (lease == NULL)
+		goto out;
+
+	now = d_timeus_secdiff(0);
+	if (lease->il_expire <= now)
+		crt_iv_lease_free(cache, lease);
+	else
+		remain = (lease->il_expire - now + 999) / 1000;
+out:
+	D_MUTEX_UNLOCK(&cache->ilc_lock);
+	return remain;
+}
+
+/*
+ * Cache the fetched value of the key with the lease granted by the parent.
+ * @lease_ver is crt_iv_lease_ver() when the fetch was issued, the value is
+ * dropped if any lease was broken since then.
+ */
+void
+crt_iv_lease_install(struct crt_iv_lease_cache *cache, crt_iv_namespace_t ivns,
+		     struct crt_iv_ops *ops, uint32_t class_id, crt_iv_key_t *key,
+		     d_sg_list_t *value, uint32_t lease_ms, uint64_t lease_ver)
+{
+	struct crt_iv_lease	*lease;
+	size_t			 size = 0;
+	char			*ptr;
+	int			 i;
+
+	for (i = 0; i < value->sg_nr; i++)
+		size += value->sg_iovs[i].iov_buf_len;
+	if (size > CRT_IV_LEASE_VAL_MAX) {
+		IV_DBG(key, "value size %zu is too large to lease\n", size);
+		return;
+	}
+
+	D_MUTEX_LOCK(&cache->ilc_lock);
+	/* broken by update or invalidation while fetching */
+	if (lease_ver != cache->ilc_ver)
+		goto out;
+
+	lease = crt_iv_lease_find(cache, ivns, ops, class_id, key);
+	if (lease != NULL)
+		crt_iv_lease_free(cache, lease);
+
+	if (cache->ilc_nr >= CRT_IV_LEASE_MAX)
+		crt_iv_lease_free(cache, d_list_entry(cache->ilc_list.next,
+						      struct crt_iv_lease, il_link));
+
+	D_ALLOC(lease, sizeof(*lease) + value->sg_nr * sizeof(*lease->il_sizes) +
+		key->iov_buf_len + size);
+	if (lease == NULL)
+		goto out;
+
+	lease->il_class_id = class_id;
+	lease->il_expire = d_timeus_secdiff(0) + (uint64_t)lease_ms * 1000;
+	lease->il_nr = value->sg_nr;
+	lease->il_sizes = (size_t *)lease->il_payload;
+
+	ptr = (char *)(lease->il_sizes + lease->il_nr);
+	memcpy(ptr, key->iov_buf, key->iov_buf_len);
+	d_iov_set(&lease->il_key, ptr, key->iov_buf_len);
+	lease->il_key.iov_len = key->iov_len;
+
+	lease->il_data = ptr + key->iov_buf_len;
+	for (i = 0, ptr = lease->il_data; i < value->sg_nr; i++) {
+		lease->il_sizes[i] = value->sg_iovs[i].iov_buf_len;
+		memcpy(ptr, value->sg_iovs[i].iov_buf, lease->il_sizes[i]);
+		ptr += lease->il_sizes[i];
+	}
+
+	d_list_add_tail(&lease->il_link, &cache->ilc_list);
+	cache->ilc_nr++;
+	IV_DBG(key, "leased for %u ms\n", lease_ms);
+out:
+	D_MUTEX_UNLOCK(&cache->ilc_lock);
+}
+
+/* Break the lease of the key, and the in-flight fetches of any key. */
+void
+crt_iv_lease_break(struct crt_iv_lease_cache *cache, crt_iv_namespace_t ivns,
+		   struct crt_iv_ops *ops, uint32_t class_id, crt_iv_key_t *key)
+{
+	struct crt_iv_lease	*lease;
+
+	D_MUTEX_LOCK(&cache->ilc_lock);
+	cache->ilc_ver++;
+	lease = crt_iv_lease_find(cache, ivns, ops, class_id, key);
+	if (lease != NULL) {
+		IV_DBG(key, "lease broken\n");
+		crt_iv_lease_free(cache, lease);
+	}
+	D_MUTEX_UNLOCK(&cache->ilc_lock);
+}
+
+/*
+ * Copy the leased value of the key into @value, which should be large enough.
+ * Return -DER_NONEXIST if there is no valid lease or @value does not fit.
+ */
+int
+crt_iv_lease_copy(struct crt_iv_lease_cache *cache, crt_iv_namespace_t ivns,
+		  struct crt_iv_ops *ops, uint32_t class_id, crt_iv_key_t *key,
+		  d_sg_list_t *value)
+{
+	struct crt_iv_lease	*lease;
+	char			*ptr;
+	int			 i;
+	int			 rc = 0;
+
+	D_MUTEX_LOCK(&cache->ilc_lock);
+	lease = crt_iv_lease_find(cache, ivns, ops, class_id, key);
+	if (lease == NULL || lease->il_expire <= d_timeus_secdiff(0))
+		D_GOTO(out, rc = -DER_NONEXIST);
+
+	if (lease->il_nr != value->sg_nr)
+		D_GOTO(out, rc = -DER_NONEXIST);
+
+	for (i = 0; i < lease->il_nr; i++) {
+		if (value->sg_iovs[i].iov_buf_len < lease->il_sizes[i])
+			D_GOTO(out, rc = -DER_NONEXIST);
+	}
+
+	for (i = 0, ptr = lease->il_data; i < lease->il_nr; i++) {
+		memcpy(value->sg_iovs[i].iov_buf, ptr, lease->il_sizes[i]);
+		value->sg_iovs[i].iov_len = lease->il_sizes[i];
+		ptr += lease->il_sizes[i];
+	}
+out:
+	D_MUTEX_UNLOCK(&cache->ilc_lock);
+	return rc;
+}
@@ -107,6 +107,8 @@ crt_hdlr_ctl_fi_attr_set(crt_rpc_t *rpc_req)
 /* CRT internal RPC format definitions uri lookup */
 CRT_RPC_DEFINE(crt_uri_lookup, CRT_ISEQ_URI_LOOKUP, CRT_OSEQ_URI_LOOKUP)
 
+CRT_RPC_DEFINE(crt_agg, CRT_ISEQ_AGG, CRT_OSEQ_AGG)
+
 /* for self-test service */
 CRT_RPC_DEFINE(crt_st_send_id_reply_iov,
 	       CRT_ISEQ_ST_SEND_ID, CRT_OSEQ_ST_REPLY_IOV)
@@ -477,6 +479,9 @@ crt_rpc_priv_free(struct crt_rpc_priv *rpc_priv)
 	if (rpc_priv->crp_coll && rpc_priv->crp_corpc_info)
 		crt_corpc_info_fini(rpc_priv);
 
+	crt_corpc_pipe_free(rpc_priv);
+	crt_agg_req_fini(rpc_priv);
+
 	if (rpc_priv->crp_uri_free != 0)
 		D_FREE(rpc_priv->crp_tgt_uri);
 
@@ -1255,6 +1260,10 @@ crt_req_send_immediately(struct crt_rpc_priv *rpc_priv)
 	D_ASSERT(rpc_priv != NULL);
 	D_ASSERT(rpc_priv->crp_hg_addr != NULL);
 
+	/* packed into the envelope RPC to the same target */
+	if (crt_agg_req_add(rpc_priv))
+		D_GOTO(out, rc = 0);
+
 	req = &rpc_priv->crp_pub;
 	ctx = req->cr_ctx;
 	rc = crt_hg_req_create(&ctx->cc_hg_ctx, rpc_priv);
@@ -1732,6 +1741,12 @@ crt_rpc_common_hdlr(struct crt_rpc_priv *rpc_priv)
 
 	if (crt_rpc_cb_customized(crt_ctx, &rpc_priv->crp_pub) &&
 	    !crt_opc_is_swim(rpc_priv->crp_req_hdr.cch_opc)) {
+		struct timespec	now;
+
+		/* The customized callback may queue the request for a while */
+		if (d_gettime(&now) == 0)
+			rpc_priv->crp_arrive_ts = now.tv_sec * NSEC_PER_SEC + now.tv_nsec;
+
 		/* Corresponding decref in crt_handle_rpc() */
 		RPC_ADDREF(rpc_priv);
 		rc = crt_ctx->cc_rpc_cb((crt_context_t)crt_ctx,
@@ -1897,6 +1912,24 @@ out:
 	return rc;
 }
 
+int
+crt_req_arrive_time_get(crt_rpc_t *rpc, uint64_t *ts)
+{
+	struct crt_rpc_priv	*rpc_priv;
+
+	if (rpc == NULL || ts == NULL) {
+		D_ERROR("NULL rpc or ts passed\n");
+		return -DER_INVAL;
+	}
+
+	rpc_priv = container_of(rpc, struct crt_rpc_priv, crp_pub);
+	if (rpc_priv->crp_arrive_ts == 0)
+		return -DER_NONEXIST;
+
+	*ts = rpc_priv->crp_arrive_ts;
+	return 0;
+}
+
 int
 crt_register_hlc_error_cb(crt_hlc_error_cb event_handler, void *arg)
 {
@@ -35,6 +35,18 @@ enum crt_rpc_flags_internal {
 	CRT_RPC_FLAG_PRIMARY_GRP	= (1U << 17),
 };
 
+/*
+ * collective RPC header flags (crt_corpc_hdr::coh_flags), the field was padding
+ * before CRT_PROTO_INTERNAL_VERSION 5
+ */
+enum crt_corpc_flags {
+	/*
+	 * coh_bulk_hdl is being pulled by the parent as well, it starts with
+	 * a 64-bit progress word (see struct crt_corpc_pipe).
+	 */
+	CRT_CORPC_FLAG_PIPE		= (1U << 0),
+};
+
 struct crt_corpc_hdr {
 	/* internal group ID name */
 	d_string_t		 coh_grpid;
@@ -49,7 +61,8 @@ struct crt_corpc_hdr {
 	uint32_t		 coh_tree_topo;
 	/* root rank of the tree, it is the logical rank within the group */
 	uint32_t		 coh_root;
-	uint32_t		 coh_padding;
+	/* see enum crt_corpc_flags */
+	uint32_t		 coh_flags;
 };
 
 /* CaRT layer common header */
@@ -138,6 +151,8 @@ struct crt_rpc_priv {
 	uint32_t		crp_timeout_sec;
 	/* time stamp to be timeout, the key of timeout binheap */
 	uint64_t		crp_timeout_ts;
+	/* time stamp (nsecs) when the request was handed to cc_rpc_cb */
+	uint64_t		crp_arrive_ts;
 	crt_cb_t		crp_complete_cb;
 	void			*crp_arg; /* argument for crp_complete_cb */
 	struct crt_ep_inflight	*crp_epi; /* point back to in-flight ep */
@@ -182,11 +197,22 @@ struct crt_rpc_priv {
 				/* RPC completed flag */
 				crp_completed:1,
 				/* RPC originated from a primary provider */
-				crp_src_is_primary:1;
+				crp_src_is_primary:1,
+				/* RPC is packed into an envelope RPC */
+				crp_agg:1;
 
 	struct crt_opc_info	*crp_opc_info;
 	/* corpc info, only valid when (crp_coll == 1) */
 	struct crt_corpc_info	*crp_corpc_info;
+	/* pipelined pull of the chained bulk, only valid on non-root node */
+	struct crt_corpc_pipe	*crp_corpc_pipe;
+	/*
+	 * aggregation, the envelope RPC that the request is unpacked from and
+	 * the index in it, or the replies collected by the envelope RPC.
+	 */
+	struct crt_rpc_priv	*crp_agg_env;
+	uint32_t		crp_agg_idx;
+	struct crt_agg_reply	*crp_agg_reply;
 	pthread_spinlock_t	crp_lock;
 	/*
 	 * Prevent data races on most crt_rpc_priv fields from crt_req_send,
@@ -216,11 +242,16 @@ crt_rpc_unlock(struct crt_rpc_priv *rpc_priv)
 	D_MUTEX_UNLOCK(&rpc_priv->crp_mutex);
 }
 
-#define CRT_PROTO_INTERNAL_VERSION 4
+/*
+ * Version 5: collective RPC header flags (CRT_CORPC_FLAG_PIPE)
+ * Version 6: RPC aggregation envelope (CRT_OPC_AGG)
+ */
+#define CRT_PROTO_INTERNAL_VERSION 6
 #define CRT_PROTO_FI_VERSION 3
 #define CRT_PROTO_ST_VERSION 1
 #define CRT_PROTO_CTL_VERSION 1
-#define CRT_PROTO_IV_VERSION 1
+/* Version 2: lease granted along with the fetched value (ifo_lease) */
+#define CRT_PROTO_IV_VERSION 2
 
 /* LIST of internal RPCS in form of:
  * OPCODE, flags, FMT, handler, corpc_hdlr,
@@ -238,6 +269,9 @@ crt_rpc_unlock(struct crt_rpc_priv *rpc_priv)
 	X(CRT_OPC_CTL_LS,						\
 		0, &CQF_crt_ctl_ep_ls,					\
 		crt_hdlr_ctl_ls, NULL)					\
+	X(CRT_OPC_AGG,							\
+		0, &CQF_crt_agg,					\
+		crt_hdlr_agg, NULL)					\
 
 #define CRT_FI_RPCS_LIST						\
 	X(CRT_OPC_CTL_FI_TOGGLE,					\
@@ -301,10 +335,10 @@ crt_rpc_unlock(struct crt_rpc_priv *rpc_priv)
 
 #define CRT_IV_RPCS_LIST						\
 	X(CRT_OPC_IV_FETCH,						\
-		0, &CQF_crt_iv_fetch,					\
+		CRT_RPC_FEAT_AGGREGATE, &CQF_crt_iv_fetch,		\
 		crt_hdlr_iv_fetch, NULL)				\
 	X(CRT_OPC_IV_UPDATE,						\
-		0, &CQF_crt_iv_update,					\
+		CRT_RPC_FEAT_AGGREGATE, &CQF_crt_iv_update,		\
 		crt_hdlr_iv_update, NULL)				\
 	X(CRT_OPC_IV_SYNC,						\
 		0, &CQF_crt_iv_sync,					\
@@ -382,6 +416,15 @@ CRT_GEN_STRUCT(crt_grp_cache, CRT_SEQ_GRP_CACHE)
 
 CRT_RPC_DECLARE(crt_uri_lookup, CRT_ISEQ_URI_LOOKUP, CRT_OSEQ_URI_LOOKUP)
 
+/* the packed requests and replies of the aggregated RPCs */
+#define CRT_ISEQ_AGG		/* input fields */		 \
+	((d_iov_t)		(ai_msgs)		CRT_VAR)
+
+#define CRT_OSEQ_AGG		/* output fields */		 \
+	((d_iov_t)		(ao_msgs)		CRT_VAR)
+
+CRT_RPC_DECLARE(crt_agg, CRT_ISEQ_AGG, CRT_OSEQ_AGG)
+
 #define CRT_ISEQ_ST_SEND_ID	/* input fields */		 \
 	((uint64_t)		(unused1)		CRT_VAR)
 
@@ -476,7 +519,9 @@ CRT_RPC_DECLARE(crt_st_status_req,
 	((d_rank_t)		(ifi_root_node)		CRT_VAR)
 
 #define CRT_OSEQ_IV_FETCH	/* output fields */		 \
-	((int32_t)		(ifo_rc)		CRT_VAR)
+	((int32_t)		(ifo_rc)		CRT_VAR) \
+	/* Lease (ms) of the value granted by the root */	 \
+	((uint32_t)		(ifo_lease)		CRT_VAR)
 
 CRT_RPC_DECLARE(crt_iv_fetch, CRT_ISEQ_IV_FETCH, CRT_OSEQ_IV_FETCH)
 
@@ -694,6 +739,17 @@ int crt_corpc_req_hdlr(struct crt_rpc_priv *rpc_priv);
 void crt_corpc_reply_hdlr(const struct crt_cb_info *cb_info);
 int crt_corpc_common_hdlr(struct crt_rpc_priv *rpc_priv);
 void crt_corpc_info_fini(struct crt_rpc_priv *rpc_priv);
+void crt_corpc_pipe_free(struct crt_rpc_priv *rpc_priv);
+int64_t crt_corpc_pipe_progress(struct crt_context *ctx, int64_t timeout);
+void crt_corpc_pipe_ctx_fini(struct crt_context *ctx);
+
+/* crt_agg.c */
+void crt_hdlr_agg(crt_rpc_t *rpc_req);
+bool crt_agg_req_add(struct crt_rpc_priv *rpc_priv);
+int crt_agg_reply_send(struct crt_rpc_priv *rpc_priv);
+void crt_agg_req_fini(struct crt_rpc_priv *rpc_priv);
+int64_t crt_agg_progress(struct crt_context *ctx, int64_t timeout);
+void crt_agg_ctx_fini(struct crt_context *ctx);
 
 /* crt_iv.c */
 void crt_hdlr_iv_fetch(crt_rpc_t *rpc_req);
@@ -703,6 +759,24 @@ int crt_iv_sync_corpc_aggregate(crt_rpc_t *source, crt_rpc_t *result,
 				void *arg);
 int crt_iv_sync_corpc_pre_forward(crt_rpc_t *rpc, void *arg);
 
+/* crt_iv_lease.c */
+int crt_iv_lease_cache_init(struct crt_iv_lease_cache *cache);
+void crt_iv_lease_cache_fini(struct crt_iv_lease_cache *cache);
+uint64_t crt_iv_lease_ver(struct crt_iv_lease_cache *cache);
+uint32_t crt_iv_lease_remain(struct crt_iv_lease_cache *cache,
+			     crt_iv_namespace_t ivns, struct crt_iv_ops *ops,
+			     uint32_t class_id, crt_iv_key_t *key);
+void crt_iv_lease_install(struct crt_iv_lease_cache *cache,
+			  crt_iv_namespace_t ivns, struct crt_iv_ops *ops,
+			  uint32_t class_id, crt_iv_key_t *key, d_sg_list_t *value,
+			  uint32_t lease_ms, uint64_t lease_ver);
+void crt_iv_lease_break(struct crt_iv_lease_cache *cache,
+			crt_iv_namespace_t ivns, struct crt_iv_ops *ops,
+			uint32_t class_id, crt_iv_key_t *key);
+int crt_iv_lease_copy(struct crt_iv_lease_cache *cache,
+		      crt_iv_namespace_t ivns, struct crt_iv_ops *ops,
+		      uint32_t class_id, crt_iv_key_t *key, d_sg_list_t *value);
+
 /* crt_register.c */
 int
 crt_proto_register_internal(struct crt_proto_format *crf);
@@ -13,10 +13,10 @@
 #include "crt_internal.h"
 #include "crt_internal_fns.h"
 
-#define CRT_OPC_SWIM_VERSION	2
+#define CRT_OPC_SWIM_VERSION	3
 #define CRT_SWIM_FAIL_BASE	((CRT_OPC_SWIM_BASE >> 16) | \
 				 (CRT_OPC_SWIM_VERSION << 4))
-#define CRT_SWIM_FAIL_DROP_RPC	(CRT_SWIM_FAIL_BASE | 0x1)	/* id: 65057 */
+#define CRT_SWIM_FAIL_DROP_RPC	(CRT_SWIM_FAIL_BASE | 0x1)	/* id: 65073 */
 
 /**
  * use this macro to determine if a fault should be injected at
@@ -28,9 +28,15 @@
 
 #define crt_proc_swim_id_t	crt_proc_uint64_t
 
+/* Same layout as the CRT_ARRAY fields, but sent in the packed format */
+struct crt_swim_upds {
+	uint64_t			 ca_count;
+	struct swim_member_update	*ca_arrays;
+};
+
 #define CRT_ISEQ_RPC_SWIM	/* input fields */		 \
 	((swim_id_t)		     (swim_id)		CRT_VAR) \
-	((struct swim_member_update) (upds)		CRT_ARRAY)
+	((struct crt_swim_upds)	     (upds)		CRT_VAR)
 
 /*
  * The excl_grp_ver field belongs to an exclusion detection protocol being
@@ -55,13 +61,79 @@
 #define CRT_OSEQ_RPC_SWIM	/* output fields */		 \
 	((int32_t)		     (rc)		CRT_VAR) \
 	((uint32_t)		     (excl_grp_ver)	CRT_VAR) \
-	((struct swim_member_update) (upds)		CRT_ARRAY)
+	((struct crt_swim_upds)	     (upds)		CRT_VAR)
 
-static inline int
-crt_proc_struct_swim_member_update(crt_proc_t proc, crt_proc_op_t proc_op,
-				   struct swim_member_update *data)
+static int
+crt_proc_struct_crt_swim_upds(crt_proc_t proc, crt_proc_op_t proc_op,
+			      struct crt_swim_upds *data)
 {
-	return crt_proc_memcpy(proc, proc_op, data, sizeof(*data));
+	struct swim_member_update	*upds = NULL;
+	void				*buf = NULL;
+	uint32_t			 count;
+	uint32_t			 size = 0;
+	size_t				 len;
+	int				 rc;
+
+	if (FREEING(proc_op)) {
+		D_FREE(data->ca_arrays);
+		data->ca_count = 0;
+		return 0;
+	}
+
+	if (ENCODING(proc_op)) {
+		count = data->ca_count;
+		if (count > 0) {
+			len = count * SWIM_UPDATE_PACKED_MAX;
+			D_ALLOC(buf, len);
+			if (buf == NULL)
+				return -DER_NOMEM;
+			rc = swim_updates_pack(data->ca_arrays, count, buf, &len);
+			if (rc)
+				D_GOTO(out, rc);
+			size = len;
+		}
+	}
+
+	rc = crt_proc_uint32_t(proc, proc_op, &count);
+	if (unlikely(rc))
+		D_GOTO(out, rc);
+	rc = crt_proc_uint32_t(proc, proc_op, &size);
+	if (unlikely(rc))
+		D_GOTO(out, rc);
+
+	if (DECODING(proc_op)) {
+		data->ca_arrays = NULL;
+		data->ca_count = 0;
+		if (count == 0)
+			D_GOTO(out, rc = 0);
+		/* bound the allocations by what the sender could have packed */
+		if (size > (uint64_t)count * SWIM_UPDATE_PACKED_MAX ||
+		    count > size / SWIM_UPDATE_PACKED_MIN)
+			D_GOTO(out, rc = -DER_PROTO);
+		D_ALLOC(buf, size);
+		D_ALLOC_ARRAY(upds, count);
+		if (buf == NULL || upds == NULL)
+			D_GOTO(out, rc = -DER_NOMEM);
+	}
+
+	if (size > 0) {
+		rc = crt_proc_memcpy(proc, proc_op, buf, size);
+		if (unlikely(rc))
+			D_GOTO(out, rc);
+	}
+
+	if (DECODING(proc_op)) {
+		rc = swim_updates_unpack(buf, size, upds, count);
+		if (rc)
+			D_GOTO(out, rc);
+		data->ca_arrays = upds;
+		data->ca_count = count;
+		upds = NULL;
+	}
+out:
+	D_FREE(upds);
+	D_FREE(buf);
+	return rc;
 }
 
 CRT_RPC_DECLARE(crt_rpc_swim, CRT_ISEQ_RPC_SWIM, CRT_OSEQ_RPC_SWIM)
@@ -147,8 +147,12 @@ crt_tree_get_nchildren(struct crt_grp_priv *grp_priv, uint32_t grp_ver,
 	}
 
 	tops = crt_tops[tree_type];
-	rc = tops->to_get_children_cnt(grp_size, tree_ratio, grp_root, grp_self,
-				       nchildren);
+	if (tree_type == CRT_TREE_DOMAIN)
+		rc = crt_domain_get_children(grp_priv, grp_rank_list, tree_ratio,
+					     grp_root, grp_self, NULL, nchildren);
+	else
+		rc = tops->to_get_children_cnt(grp_size, tree_ratio, grp_root,
+					       grp_self, nchildren);
 	if (rc != 0)
 		D_ERROR("to_get_children_cnt (group %s, root %d, self %d) "
 			"failed, rc: %d.\n", grp_priv->gp_pub.cg_grpid,
@@ -227,8 +231,12 @@ crt_tree_get_children(struct crt_grp_priv *grp_priv, uint32_t grp_ver,
 
 	tops = crt_tops[tree_type];
 
-	rc = tops->to_get_children_cnt(grp_size, tree_ratio, grp_root, grp_self,
-				       &nchildren);
+	if (tree_type == CRT_TREE_DOMAIN)
+		rc = crt_domain_get_children(grp_priv, grp_rank_list, tree_ratio,
+					     grp_root, grp_self, NULL, &nchildren);
+	else
+		rc = tops->to_get_children_cnt(grp_size, tree_ratio, grp_root,
+					       grp_self, &nchildren);
 	if (rc != 0) {
 		D_ERROR("to_get_children_cnt (group %s, root %d, self %d) "
 			"failed, rc: %d.\n", grp_priv->gp_pub.cg_grpid,
@@ -248,8 +256,13 @@ crt_tree_get_children(struct crt_grp_priv *grp_priv, uint32_t grp_ver,
 		d_rank_list_free(result_rank_list);
 		D_GOTO(out, rc = -DER_NOMEM);
 	}
-	rc = tops->to_get_children(grp_size, tree_ratio, grp_root, grp_self,
-				   tree_children);
+	if (tree_type == CRT_TREE_DOMAIN)
+		rc = crt_domain_get_children(grp_priv, grp_rank_list, tree_ratio,
+					     grp_root, grp_self, tree_children,
+					     &nchildren);
+	else
+		rc = tops->to_get_children(grp_size, tree_ratio, grp_root,
+					   grp_self, tree_children);
 	if (rc != 0) {
 		D_ERROR("to_get_children (group %s, root %d, self %d) "
 			"failed, rc: %d.\n", grp_priv->gp_pub.cg_grpid,
@@ -316,8 +329,12 @@ crt_tree_get_parent(struct crt_grp_priv *grp_priv, uint32_t grp_ver,
 	}
 
 	tops = crt_tops[tree_type];
-	rc = tops->to_get_parent(grp_size, tree_ratio, grp_root, grp_self,
-				 &tree_parent);
+	if (tree_type == CRT_TREE_DOMAIN)
+		rc = crt_domain_get_parent(grp_priv, grp_rank_list, tree_ratio,
+					   grp_root, grp_self, &tree_parent);
+	else
+		rc = tops->to_get_parent(grp_size, tree_ratio, grp_root,
+					 grp_self, &tree_parent);
 	if (rc != 0) {
 		D_ERROR("to_get_parent (group %s, root %d, self %d) failed, "
 			"rc: %d.\n", grp_priv->gp_pub.cg_grpid, root, self, rc);
@@ -337,4 +354,5 @@ struct crt_topo_ops *crt_tops[] = {
 	&crt_flat_ops,		/* CRT_TREE_FLAT */
 	&crt_kary_ops,		/* CRT_TREE_KARY */
 	&crt_knomial_ops,	/* CRT_TREE_KNOMIAL */
+	&crt_knomial_ops,	/* CRT_TREE_DOMAIN, without domain information */
 };
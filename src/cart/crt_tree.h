@@ -69,6 +69,58 @@ extern struct crt_topo_ops	 crt_knomial_ops;
 
 extern struct crt_topo_ops	*crt_tops[];
 
+/*
+ * Fault domain aware tree (CRT_TREE_DOMAIN), it is built on the group rank
+ * list and the domain IDs of the members, see crt_tree_domain.c.
+ */
+struct crt_dom_tree {
+	uint32_t		 dt_size;
+	uint32_t		 dt_lvls;
+	uint32_t		 dt_ratio;
+	/* dt_size * dt_lvls domain IDs, indexed by group rank */
+	const uint32_t		*dt_doms;
+	/* group ranks sorted by the domain IDs */
+	uint32_t		*dt_order;
+	/* index in dt_order for each group rank */
+	uint32_t		*dt_rev;
+	/*
+	 * dt_lvls * dt_size, the range [lo, hi) in dt_order of the level
+	 * (l + 1) domain of each position in dt_order
+	 */
+	uint32_t		*dt_lo;
+	uint32_t		*dt_hi;
+	/* scratch buffers */
+	uint32_t		*dt_sibs;
+	uint32_t		*dt_kids;
+};
+
+/* The domain tree cached in the group, see crt_domain_get_children. */
+struct crt_dom_cache {
+	struct crt_dom_tree	 dc_tree;
+	/* group rank list and membership version the tree is built for */
+	d_rank_list_t		*dc_ranks;
+	uint32_t		 dc_ver;
+	uint32_t		*dc_doms;
+};
+
+int crt_dom_tree_init(struct crt_dom_tree *dt, uint32_t grp_size,
+		      uint32_t levels, const uint32_t *doms, uint32_t ratio);
+void crt_dom_tree_fini(struct crt_dom_tree *dt);
+int crt_dom_tree_children(struct crt_dom_tree *dt, uint32_t grp_root,
+			  uint32_t grp_self, uint32_t *children,
+			  uint32_t *nchildren);
+int crt_dom_tree_parent(struct crt_dom_tree *dt, uint32_t grp_root,
+			uint32_t grp_self, uint32_t *parent);
+void crt_dom_cache_free(struct crt_dom_cache *dc);
+int crt_domain_get_children(struct crt_grp_priv *grp_priv,
+			    d_rank_list_t *grp_rank_list, uint32_t tree_ratio,
+			    uint32_t grp_root, uint32_t grp_self,
+			    uint32_t *children, uint32_t *nchildren);
+int crt_domain_get_parent(struct crt_grp_priv *grp_priv,
+			  d_rank_list_t *grp_rank_list, uint32_t tree_ratio,
+			  uint32_t grp_root, uint32_t grp_self,
+			  uint32_t *parent);
+
 /* some simple helpers */
 static inline int
 crt_tree_type(int tree_topo)
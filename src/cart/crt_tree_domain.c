@@ -0,0 +1,441 @@
+/*
+ * (C) Copyright 2023 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+/**
+ * This file is part of CaRT. It gives out the fault domain aware tree topo
+ * related function implementation.
+ *
+ * Every member has a domain ID on each level, from the top level (e.g. rack)
+ * to the last level (e.g. node), the members themselves are regarded as the
+ * domains of one more (the deepest) level. Each domain is represented by its
+ * leader, which is the root if the root is within the domain, otherwise the
+ * lowest group rank in the domain. Within a domain, the leaders of its child
+ * domains form a k-nomial tree rooted at the leader of the domain.
+ *
+ * So the collective RPC crosses the top level domains only on the first levels
+ * of the tree, and the last hops stay within a node.
+ */
+#define D_LOGFAC	DD_FAC(grp)
+
+#include "crt_internal.h"
+
+struct dom_sort_ent {
+	const uint32_t	*dse_doms;
+	uint32_t	 dse_lvls;
+	uint32_t	 dse_pos;
+};
+
+static int
+dom_sort_cmp(const void *a, const void *b)
+{
+	const struct dom_sort_ent	*ea = a;
+	const struct dom_sort_ent	*eb = b;
+	uint32_t			 i;
+
+	for (i = 0; i < ea->dse_lvls; i++) {
+		if (ea->dse_doms[i] < eb->dse_doms[i])
+			return -1;
+		if (ea->dse_doms[i] > eb->dse_doms[i])
+			return 1;
+	}
+
+	if (ea->dse_pos < eb->dse_pos)
+		return -1;
+
+	return ea->dse_pos > eb->dse_pos ? 1 : 0;
+}
+
+/* Whether the members @a and @b share the first @lvl domain IDs. */
+static inline bool
+dom_prefix_same(struct crt_dom_tree *dt, uint32_t a, uint32_t b, uint32_t lvl)
+{
+	return memcmp(&dt->dt_doms[a * dt->dt_lvls], &dt->dt_doms[b * dt->dt_lvls],
+		      sizeof(*dt->dt_doms) * lvl) == 0;
+}
+
+/* Get the range [lo, hi) in dt_order of the level @lvl domain of @idx. */
+static inline void
+dom_range(struct crt_dom_tree *dt, uint32_t idx, uint32_t lvl, uint32_t *lo,
+	  uint32_t *hi)
+{
+	if (lvl == 0) {
+		*lo = 0;
+		*hi = dt->dt_size;
+	} else if (lvl > dt->dt_lvls) {
+		*lo = idx;
+		*hi = idx + 1;
+	} else {
+		*lo = dt->dt_lo[(lvl - 1) * dt->dt_size + idx];
+		*hi = dt->dt_hi[(lvl - 1) * dt->dt_size + idx];
+	}
+}
+
+static inline uint32_t
+dom_leader(struct crt_dom_tree *dt, uint32_t root, uint32_t lo, uint32_t hi)
+{
+	if (dt->dt_rev[root] >= lo && dt->dt_rev[root] < hi)
+		return root;
+
+	return dt->dt_order[lo];
+}
+
+/*
+ * Collect the leaders of the level (@lvl + 1) domains within the level @lvl
+ * domain that contains @self into dt_sibs, the leader of the level @lvl domain
+ * is always the first one. Return the count and the index of @self in @idx.
+ */
+static uint32_t
+dom_siblings(struct crt_dom_tree *dt, uint32_t root, uint32_t self, uint32_t lvl,
+	     int *idx)
+{
+	uint32_t	lo, hi, sub_lo, sub_hi;
+	uint32_t	leader, sub_leader;
+	uint32_t	nr = 1;
+
+	dom_range(dt, dt->dt_rev[self], lvl, &lo, &hi);
+	leader = dom_leader(dt, root, lo, hi);
+	dt->dt_sibs[0] = leader;
+	*idx = (leader == self) ? 0 : -1;
+
+	for (sub_lo = lo; sub_lo < hi; sub_lo = sub_hi) {
+		dom_range(dt, sub_lo, lvl + 1, &sub_lo, &sub_hi);
+		sub_leader = dom_leader(dt, root, sub_lo, sub_hi);
+		if (sub_leader == leader)
+			continue;
+
+		if (sub_leader == self)
+			*idx = nr;
+		dt->dt_sibs[nr++] = sub_leader;
+	}
+
+	return nr;
+}
+
+/* Whether @self is the leader of its level @lvl domain. */
+static inline bool
+dom_is_leader(struct crt_dom_tree *dt, uint32_t root, uint32_t self, uint32_t lvl)
+{
+	uint32_t	lo, hi;
+
+	if (lvl > dt->dt_lvls)
+		return true;
+
+	dom_range(dt, dt->dt_rev[self], lvl, &lo, &hi);
+	return dom_leader(dt, root, lo, hi) == self;
+}
+
+/*
+ * Sort the members by their domain IDs, then the members of each domain are
+ * contiguous in dt_order, remember the range of each member's domain on every
+ * level, so the queries never scan or sort the members.
+ */
+int
+crt_dom_tree_init(struct crt_dom_tree *dt, uint32_t grp_size, uint32_t levels,
+		  const uint32_t *doms, uint32_t ratio)
+{
+	struct dom_sort_ent	*ents;
+	uint32_t		 start;
+	uint32_t		 lvl;
+	uint32_t		 i, j;
+
+	D_ASSERT(grp_size > 0);
+	D_ASSERT(ratio >= CRT_TREE_MIN_RATIO && ratio <= CRT_TREE_MAX_RATIO);
+
+	memset(dt, 0, sizeof(*dt));
+	dt->dt_size = grp_size;
+	dt->dt_lvls = levels;
+	dt->dt_ratio = ratio;
+	dt->dt_doms = doms;
+
+	D_ALLOC_ARRAY(dt->dt_order, grp_size);
+	D_ALLOC_ARRAY(dt->dt_rev, grp_size);
+	D_ALLOC_ARRAY(dt->dt_sibs, grp_size);
+	D_ALLOC_ARRAY(dt->dt_kids, grp_size);
+	if (levels > 0) {
+		D_ALLOC_ARRAY(dt->dt_lo, grp_size * levels);
+		D_ALLOC_ARRAY(dt->dt_hi, grp_size * levels);
+	}
+	D_ALLOC_ARRAY(ents, grp_size);
+	if (dt->dt_order == NULL || dt->dt_rev == NULL || dt->dt_sibs == NULL ||
+	    dt->dt_kids == NULL || ents == NULL ||
+	    (levels > 0 && (dt->dt_lo == NULL || dt->dt_hi == NULL))) {
+		D_FREE(ents);
+		crt_dom_tree_fini(dt);
+		return -DER_NOMEM;
+	}
+
+	for (i = 0; i < grp_size; i++) {
+		ents[i].dse_doms = &doms[i * levels];
+		ents[i].dse_lvls = levels;
+		ents[i].dse_pos = i;
+	}
+
+	qsort(ents, grp_size, sizeof(*ents), dom_sort_cmp);
+
+	for (i = 0; i < grp_size; i++) {
+		dt->dt_order[i] = ents[i].dse_pos;
+		dt->dt_rev[ents[i].dse_pos] = i;
+	}
+	D_FREE(ents);
+
+	for (lvl = 1; lvl <= levels; lvl++) {
+		uint32_t	*lo = &dt->dt_lo[(lvl - 1) * grp_size];
+		uint32_t	*hi = &dt->dt_hi[(lvl - 1) * grp_size];
+
+		for (start = 0, i = 1; i <= grp_size; i++) {
+			if (i < grp_size &&
+			    dom_prefix_same(dt, dt->dt_order[start], dt->dt_order[i], lvl))
+				continue;
+
+			for (j = start; j < i; j++) {
+				lo[j] = start;
+				hi[j] = i;
+			}
+			start = i;
+		}
+	}
+
+	return 0;
+}
+
+void
+crt_dom_tree_fini(struct crt_dom_tree *dt)
+{
+	D_FREE(dt->dt_order);
+	D_FREE(dt->dt_rev);
+	D_FREE(dt->dt_lo);
+	D_FREE(dt->dt_hi);
+	D_FREE(dt->dt_sibs);
+	D_FREE(dt->dt_kids);
+}
+
+/*
+ * Get the children of @grp_self in the tree rooted at @grp_root, the children
+ * in the upper (wider) domains come first since their sub-trees are deeper.
+ * @children can be NULL to only query the count.
+ */
+int
+crt_dom_tree_children(struct crt_dom_tree *dt, uint32_t grp_root, uint32_t grp_self,
+		      uint32_t *children, uint32_t *nchildren)
+{
+	struct crt_topo_ops	*tops = &crt_knomial_ops;
+	uint32_t		 total = 0;
+	uint32_t		 nsibs;
+	uint32_t		 cnt;
+	uint32_t		 lvl;
+	uint32_t		 i;
+	int			 idx;
+	int			 rc;
+
+	D_ASSERT(grp_root < dt->dt_size);
+	D_ASSERT(grp_self < dt->dt_size);
+
+	for (lvl = 0; lvl <= dt->dt_lvls; lvl++) {
+		if (!dom_is_leader(dt, grp_root, grp_self, lvl + 1))
+			continue;
+
+		nsibs = dom_siblings(dt, grp_root, grp_self, lvl, &idx);
+		D_ASSERT(idx >= 0);
+
+		rc = tops->to_get_children_cnt(nsibs, dt->dt_ratio, 0, idx, &cnt);
+		if (rc != 0)
+			return rc;
+
+		if (cnt == 0)
+			continue;
+
+		if (children != NULL) {
+			rc = tops->to_get_children(nsibs, dt->dt_ratio, 0, idx,
+						   dt->dt_kids);
+			if (rc != 0)
+				return rc;
+
+			for (i = 0; i < cnt; i++)
+				children[total + i] = dt->dt_sibs[dt->dt_kids[i]];
+		}
+		total += cnt;
+	}
+
+	*nchildren = total;
+	return 0;
+}
+
+int
+crt_dom_tree_parent(struct crt_dom_tree *dt, uint32_t grp_root, uint32_t grp_self,
+		    uint32_t *parent)
+{
+	uint32_t	nsibs;
+	uint32_t	sib_parent;
+	uint32_t	lvl;
+	int		idx;
+	int		rc;
+
+	D_ASSERT(grp_root < dt->dt_size);
+	D_ASSERT(grp_self < dt->dt_size);
+
+	if (grp_self == grp_root)
+		return -DER_INVAL;
+
+	/* The deepest domain that @grp_self is not the leader of. */
+	for (lvl = dt->dt_lvls; dom_is_leader(dt, grp_root, grp_self, lvl); lvl--)
+		D_ASSERT(lvl > 0);
+
+	nsibs = dom_siblings(dt, grp_root, grp_self, lvl, &idx);
+	D_ASSERT(idx > 0);
+
+	rc = crt_knomial_ops.to_get_parent(nsibs, dt->dt_ratio, 0, idx,
+					   &sib_parent);
+	if (rc != 0)
+		return rc;
+
+	*parent = dt->dt_sibs[sib_parent];
+	return 0;
+}
+
+void
+crt_dom_cache_free(struct crt_dom_cache *dc)
+{
+	if (dc == NULL)
+		return;
+
+	crt_dom_tree_fini(&dc->dc_tree);
+	d_rank_list_free(dc->dc_ranks);
+	D_FREE(dc->dc_doms);
+	D_FREE(dc);
+}
+
+static inline bool
+dom_cache_match(struct crt_dom_cache *dc, uint32_t grp_ver, d_rank_list_t *grp_rank_list,
+		uint32_t tree_ratio)
+{
+	/* The order of the ranks matters, the tree is indexed by it. */
+	return dc != NULL && dc->dc_ver == grp_ver && dc->dc_tree.dt_ratio == tree_ratio &&
+	       dc->dc_ranks->rl_nr == grp_rank_list->rl_nr &&
+	       memcmp(dc->dc_ranks->rl_ranks, grp_rank_list->rl_ranks,
+		      sizeof(d_rank_t) * grp_rank_list->rl_nr) == 0;
+}
+
+/*
+ * Get the domain tree of the group rank list, the tree only depends on the
+ * membership and the domain information, so it is cached for the current
+ * membership version and rebuilt only if the version or the (filtered) rank
+ * list changes. The members without domain information are regarded as in
+ * the same (unknown) domain.
+ *
+ * Called with gp_rwlock read locked and gp_dom_mutex held.
+ */
+static int
+crt_domain_tree_get(struct crt_grp_priv *grp_priv, d_rank_list_t *grp_rank_list,
+		    uint32_t tree_ratio, struct crt_dom_tree **dt)
+{
+	struct crt_dom_cache	*dc = grp_priv->gp_dom_cache;
+	uint32_t		 lvls = grp_priv->gp_dom_lvls;
+	uint32_t		 size = grp_rank_list->rl_nr;
+	uint32_t		 i, j;
+	int			 idx;
+	int			 rc;
+
+	if (dom_cache_match(dc, grp_priv->gp_membs_ver, grp_rank_list, tree_ratio)) {
+		*dt = &dc->dc_tree;
+		return 0;
+	}
+
+	crt_dom_cache_free(dc);
+	grp_priv->gp_dom_cache = NULL;
+
+	D_ALLOC_PTR(dc);
+	if (dc == NULL)
+		return -DER_NOMEM;
+
+	rc = d_rank_list_dup(&dc->dc_ranks, grp_rank_list);
+	if (rc != 0)
+		goto err;
+
+	D_ALLOC_ARRAY(dc->dc_doms, size * lvls);
+	if (dc->dc_doms == NULL)
+		D_GOTO(err, rc = -DER_NOMEM);
+
+	for (i = 0; i < size; i++) {
+		idx = grp_dom_rank_idx(grp_priv->gp_dom_ranks,
+				       grp_rank_list->rl_ranks[i]);
+		for (j = 0; j < lvls; j++)
+			dc->dc_doms[i * lvls + j] = idx < 0 ? UINT32_MAX :
+						    grp_priv->gp_dom_ids[idx * lvls + j];
+	}
+
+	rc = crt_dom_tree_init(&dc->dc_tree, size, lvls, dc->dc_doms, tree_ratio);
+	if (rc != 0)
+		goto err;
+
+	dc->dc_ver = grp_priv->gp_membs_ver;
+	grp_priv->gp_dom_cache = dc;
+	*dt = &dc->dc_tree;
+	return 0;
+
+err:
+	d_rank_list_free(dc->dc_ranks);
+	D_FREE(dc->dc_doms);
+	D_FREE(dc);
+	return rc;
+}
+
+/*
+ * The domain information is only used with the membership version it was set
+ * for, otherwise the members may build different trees during the membership
+ * change, fall back to the k-nomial tree then.
+ */
+static inline bool
+crt_domain_valid(struct crt_grp_priv *grp_priv)
+{
+	return grp_priv->gp_dom_lvls > 0 && grp_priv->gp_dom_ver == grp_priv->gp_membs_ver;
+}
+
+int
+crt_domain_get_children(struct crt_grp_priv *grp_priv,
+			d_rank_list_t *grp_rank_list, uint32_t tree_ratio,
+			uint32_t grp_root, uint32_t grp_self,
+			uint32_t *children, uint32_t *nchildren)
+{
+	struct crt_dom_tree	*dt;
+	int			 rc;
+
+	if (!crt_domain_valid(grp_priv)) {
+		if (children == NULL)
+			return crt_knomial_ops.to_get_children_cnt(grp_rank_list->rl_nr,
+								   tree_ratio, grp_root,
+								   grp_self, nchildren);
+		return crt_knomial_ops.to_get_children(grp_rank_list->rl_nr, tree_ratio,
+						       grp_root, grp_self, children);
+	}
+
+	D_MUTEX_LOCK(&grp_priv->gp_dom_mutex);
+	rc = crt_domain_tree_get(grp_priv, grp_rank_list, tree_ratio, &dt);
+	if (rc == 0)
+		rc = crt_dom_tree_children(dt, grp_root, grp_self, children, nchildren);
+	D_MUTEX_UNLOCK(&grp_priv->gp_dom_mutex);
+
+	return rc;
+}
+
+int
+crt_domain_get_parent(struct crt_grp_priv *grp_priv,
+		      d_rank_list_t *grp_rank_list, uint32_t tree_ratio,
+		      uint32_t grp_root, uint32_t grp_self, uint32_t *parent)
+{
+	struct crt_dom_tree	*dt;
+	int			 rc;
+
+	if (!crt_domain_valid(grp_priv))
+		return crt_knomial_ops.to_get_parent(grp_rank_list->rl_nr, tree_ratio,
+						     grp_root, grp_self, parent);
+
+	D_MUTEX_LOCK(&grp_priv->gp_dom_mutex);
+	rc = crt_domain_tree_get(grp_priv, grp_rank_list, tree_ratio, &dt);
+	if (rc == 0)
+		rc = crt_dom_tree_parent(dt, grp_root, grp_self, parent);
+	D_MUTEX_UNLOCK(&grp_priv->gp_dom_mutex);
+
+	return rc;
+}
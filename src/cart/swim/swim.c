@@ -122,8 +122,9 @@ int
 swim_updates_prepare(struct swim_context *ctx, swim_id_t id, swim_id_t to,
 		     struct swim_member_update **pupds, size_t *pnupds)
 {
-	struct swim_member_update	*upds;
-	struct swim_item		*next, *item;
+	TAILQ_HEAD(, swim_item)		 sent;
+	struct swim_member_update	*upds = NULL;
+	struct swim_item		*pos, *item;
 	swim_id_t			 self_id = swim_self_get(ctx);
 	size_t				 nupds, n = 0;
 	int				 rc = 0;
@@ -133,7 +134,13 @@ swim_updates_prepare(struct swim_context *ctx, swim_id_t id, swim_id_t to,
 		D_GOTO(out, rc = -DER_INVAL);
 	}
 
-	nupds = SWIM_PIGGYBACK_ENTRIES + 1 /* id */;
+	TAILQ_INIT(&sent);
+	swim_ctx_lock(ctx);
+
+	/* piggyback more entries when there is a backlog of updates */
+	nupds = max(ctx->sc_updates_nr, (uint64_t)SWIM_PIGGYBACK_ENTRIES);
+	nupds = min(nupds, ctx->sc_piggyback_max);
+	nupds += 1 /* id */;
 	if (id != self_id)
 		nupds++; /* self_id */
 	if (id != to)
@@ -141,9 +148,7 @@ swim_updates_prepare(struct swim_context *ctx, swim_id_t id, swim_id_t to,
 
 	D_ALLOC_ARRAY(upds, nupds);
 	if (upds == NULL)
-		D_GOTO(out, rc = -DER_NOMEM);
-
-	swim_ctx_lock(ctx);
+		D_GOTO(out_unlock, rc = -DER_NOMEM);
 
 	rc = ctx->sc_ops->get_member_state(ctx, id, &upds[n].smu_state);
 	if (rc) {
@@ -178,17 +183,12 @@ swim_updates_prepare(struct swim_context *ctx, swim_id_t id, swim_id_t to,
 		upds[n++].smu_id = to;
 	}
 
-	item = TAILQ_FIRST(&ctx->sc_updates);
-	while (item != NULL) {
-		next = TAILQ_NEXT(item, si_link);
-
-		/* delete entries that are too many */
-		if (n >= nupds) {
-			TAILQ_REMOVE(&ctx->sc_updates, item, si_link);
-			D_FREE(item);
-			item = next;
-			continue;
-		}
+	/*
+	 * The list is sorted by the transfer count, so the updates which were
+	 * sent the least times are taken first.
+	 */
+	while (n < nupds && (item = TAILQ_FIRST(&ctx->sc_updates)) != NULL) {
+		TAILQ_REMOVE(&ctx->sc_updates, item, si_link);
 
 		/* update with recent updates */
 		if (item->si_id != id &&
@@ -199,27 +199,39 @@ swim_updates_prepare(struct swim_context *ctx, swim_id_t id, swim_id_t to,
 			if (rc) {
 				if (rc == -DER_NONEXIST) {
 					/* this member was removed already */
-					TAILQ_REMOVE(&ctx->sc_updates, item, si_link);
+					ctx->sc_updates_nr--;
 					D_FREE(item);
-					item = next;
 					continue;
 				}
 				SWIM_ERROR("get_member_state(%lu): "DF_RC"\n",
 					   item->si_id, DP_RC(rc));
-				D_GOTO(out_unlock, rc);
+				TAILQ_INSERT_HEAD(&ctx->sc_updates, item, si_link);
+				D_GOTO(out_requeue, rc);
 			}
 			upds[n++].smu_id = item->si_id;
 		}
 
 		if (++item->u.si_count > ctx->sc_piggyback_tx_max) {
-			TAILQ_REMOVE(&ctx->sc_updates, item, si_link);
+			ctx->sc_updates_nr--;
 			D_FREE(item);
+		} else {
+			TAILQ_INSERT_TAIL(&sent, item, si_link);
 		}
-
-		item = next;
 	}
 	rc = 0;
 
+out_requeue:
+	/* merge the sent updates back behind the ones with the same count */
+	pos = TAILQ_FIRST(&ctx->sc_updates);
+	while ((item = TAILQ_FIRST(&sent)) != NULL) {
+		TAILQ_REMOVE(&sent, item, si_link);
+		while (pos != NULL && pos->u.si_count <= item->u.si_count)
+			pos = TAILQ_NEXT(pos, si_link);
+		if (pos != NULL)
+			TAILQ_INSERT_BEFORE(pos, item, si_link);
+		else
+			TAILQ_INSERT_TAIL(&ctx->sc_updates, item, si_link);
+	}
 out_unlock:
 	swim_ctx_unlock(ctx);
 
@@ -252,6 +264,21 @@ out:
 	return rc;
 }
 
+/* Insert @item ahead of the updates which were sent as many times or more. */
+static void
+swim_updates_insert(struct swim_context *ctx, struct swim_item *item)
+{
+	struct swim_item *pos;
+
+	TAILQ_FOREACH(pos, &ctx->sc_updates, si_link) {
+		if (pos->u.si_count >= item->u.si_count) {
+			TAILQ_INSERT_BEFORE(pos, item, si_link);
+			return;
+		}
+	}
+	TAILQ_INSERT_TAIL(&ctx->sc_updates, item, si_link);
+}
+
 static int
 swim_updates_notify(struct swim_context *ctx, swim_id_t from, swim_id_t id,
 		    struct swim_member_state *id_state, uint64_t count)
@@ -261,8 +288,10 @@ swim_updates_notify(struct swim_context *ctx, swim_id_t from, swim_id_t id,
 	/* determine if this member already have an update */
 	TAILQ_FOREACH(item, &ctx->sc_updates, si_link) {
 		if (item->si_id == id) {
+			TAILQ_REMOVE(&ctx->sc_updates, item, si_link);
 			item->si_from = from;
 			item->u.si_count = count;
+			swim_updates_insert(ctx, item);
 			D_GOTO(update, 0);
 		}
 	}
@@ -275,7 +304,8 @@ swim_updates_notify(struct swim_context *ctx, swim_id_t from, swim_id_t id,
 		item->si_id   = id;
 		item->si_from = from;
 		item->u.si_count = count;
-		TAILQ_INSERT_HEAD(&ctx->sc_updates, item, si_link);
+		swim_updates_insert(ctx, item);
+		ctx->sc_updates_nr++;
 	}
 update:
 	return ctx->sc_ops->set_member_state(ctx, id, id_state);
@@ -728,6 +758,7 @@ swim_init(swim_id_t self_id, struct swim_ops *swim_ops, void *data)
 
 	/* this can be tuned according members count */
 	ctx->sc_piggyback_tx_max = SWIM_PIGGYBACK_TX_COUNT;
+	ctx->sc_piggyback_max = SWIM_PIGGYBACK_ENTRIES_MAX;
 	/* force to choose next target first */
 	ctx->sc_target = SWIM_ID_INVALID;
 
@@ -1259,3 +1290,136 @@ swim_member_del(struct swim_context *ctx, swim_id_t id)
 	}
 	swim_ctx_unlock(ctx);
 }
+
+/*
+ * Packed updates: every update starts with a flags byte, followed by varints
+ * of the zigzag encoded ID delta to the previous update, the zigzag encoded
+ * incarnation delta to the previous update (omitted if they are the same)
+ * and the delay (omitted if zero). The incarnations are HLC timestamps, so
+ * the members that started around the same time have close incarnations.
+ */
+#define SWIM_PACK_STATUS_MASK	0x03
+#define SWIM_PACK_SAME_INC	0x04
+#define SWIM_PACK_DELAY		0x08
+
+static inline uint8_t *
+swim_pack_varint(uint8_t *p, uint64_t v)
+{
+	while (v >= 0x80) {
+		*p++ = (uint8_t)v | 0x80;
+		v >>= 7;
+	}
+	*p++ = (uint8_t)v;
+	return p;
+}
+
+static inline const uint8_t *
+swim_unpack_varint(const uint8_t *p, const uint8_t *end, uint64_t *v)
+{
+	unsigned int	shift = 0;
+
+	*v = 0;
+	while (p < end && shift < 64) {
+		*v |= (uint64_t)(*p & 0x7f) << shift;
+		if ((*p++ & 0x80) == 0)
+			return p;
+		shift += 7;
+	}
+	return NULL;
+}
+
+static inline uint64_t
+swim_zigzag(uint64_t cur, uint64_t prev)
+{
+	int64_t	d = (int64_t)(cur - prev);
+
+	return ((uint64_t)d << 1) ^ (uint64_t)(d >> 63);
+}
+
+static inline uint64_t
+swim_unzigzag(uint64_t v, uint64_t prev)
+{
+	return prev + ((v >> 1) ^ -(v & 1));
+}
+
+int
+swim_updates_pack(struct swim_member_update *upds, size_t nupds, void *buf, size_t *size)
+{
+	uint8_t		*p = buf;
+	uint64_t	 prev_id = 0;
+	uint64_t	 prev_inc = 0;
+	size_t		 i;
+
+	if (*size < nupds * SWIM_UPDATE_PACKED_MAX)
+		return -DER_OVERFLOW;
+
+	for (i = 0; i < nupds; i++) {
+		struct swim_member_state	*state = &upds[i].smu_state;
+		uint8_t				*flags = p++;
+
+		*flags = state->sms_status & SWIM_PACK_STATUS_MASK;
+		p = swim_pack_varint(p, swim_zigzag(upds[i].smu_id, prev_id));
+		if (i > 0 && state->sms_incarnation == prev_inc)
+			*flags |= SWIM_PACK_SAME_INC;
+		else
+			p = swim_pack_varint(p, swim_zigzag(state->sms_incarnation, prev_inc));
+		if (state->sms_delay != 0) {
+			*flags |= SWIM_PACK_DELAY;
+			p = swim_pack_varint(p, state->sms_delay);
+		}
+
+		prev_id = upds[i].smu_id;
+		prev_inc = state->sms_incarnation;
+	}
+
+	*size = p - (uint8_t *)buf;
+	return 0;
+}
+
+int
+swim_updates_unpack(const void *buf, size_t size, struct swim_member_update *upds, size_t nupds)
+{
+	const uint8_t	*p = buf;
+	const uint8_t	*end = p + size;
+	uint64_t	 prev_id = 0;
+	uint64_t	 prev_inc = 0;
+	uint64_t	 v;
+	size_t		 i;
+
+	for (i = 0; i < nupds; i++) {
+		struct swim_member_state	*state = &upds[i].smu_state;
+		uint8_t				 flags;
+
+		if (p >= end)
+			return -DER_PROTO;
+		flags = *p++;
+		state->sms_status = flags & SWIM_PACK_STATUS_MASK;
+
+		p = swim_unpack_varint(p, end, &v);
+		if (p == NULL)
+			return -DER_PROTO;
+		upds[i].smu_id = swim_unzigzag(v, prev_id);
+
+		if (flags & SWIM_PACK_SAME_INC) {
+			state->sms_incarnation = prev_inc;
+		} else {
+			p = swim_unpack_varint(p, end, &v);
+			if (p == NULL)
+				return -DER_PROTO;
+			state->sms_incarnation = swim_unzigzag(v, prev_inc);
+		}
+
+		state->sms_delay = 0;
+		if (flags & SWIM_PACK_DELAY) {
+			p = swim_unpack_varint(p, end, &v);
+			if (p == NULL || v > UINT32_MAX)
+				return -DER_PROTO;
+			state->sms_delay = v;
+		}
+
+		prev_id = upds[i].smu_id;
+		prev_inc = state->sms_incarnation;
+	}
+
+	return p == end ? 0 : -DER_PROTO;
+}
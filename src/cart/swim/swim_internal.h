@@ -53,6 +53,10 @@ extern "C" {
 #define SWIM_PING_TIMEOUT	900	/* milliseconds */
 #define SWIM_SUBGROUP_SIZE	2
 #define SWIM_PIGGYBACK_ENTRIES	8	/**< count of piggybacked entries */
+#define SWIM_PIGGYBACK_ENTRIES_MAX 64	/**< count of piggybacked entries when
+					 * there is a backlog of updates, e.g.
+					 * after a correlated failure.
+					 */
 #define SWIM_PIGGYBACK_TX_COUNT	50	/**< count of transfers each entry
 					 * until it be removed from the list of
 					 * updates.
@@ -95,7 +99,7 @@ struct swim_context {
 
 	TAILQ_HEAD(, swim_item)	 sc_subgroup;
 	TAILQ_HEAD(, swim_item)	 sc_suspects;
-	TAILQ_HEAD(, swim_item)	 sc_updates;
+	TAILQ_HEAD(, swim_item)	 sc_updates;	/**< sorted by si_count */
 	TAILQ_HEAD(, swim_item)	 sc_ipings;
 
 	enum swim_context_state	 sc_state;
@@ -109,6 +113,8 @@ struct swim_context {
 	uint64_t		 sc_deadline;
 
 	uint64_t		 sc_piggyback_tx_max;
+	uint64_t		 sc_piggyback_max;
+	uint64_t		 sc_updates_nr;
 
 	unsigned int		 sc_glitch:1;
 };
@@ -202,6 +202,45 @@ daos_obj_list_dkey(daos_handle_t oh, daos_handle_t th, uint32_t *nr,
 	return dc_task_schedule(task, true);
 }
 
+int
+daos_obj_list_dkey_par_open(daos_handle_t oh, daos_handle_t th, uint32_t nr, daos_handle_t *eh)
+{
+	struct dc_obj_enum_par	*ep;
+	int			 rc;
+
+	if (eh == NULL)
+		return -DER_INVAL;
+
+	rc = dc_obj_list_dkey_par_open(oh, th, nr, &ep);
+	if (rc)
+		return rc;
+
+	eh->cookie = (uint64_t)ep;
+	return 0;
+}
+
+int
+daos_obj_list_dkey_par_next(daos_handle_t eh, uint32_t *nr, daos_key_desc_t *kds,
+			    d_sg_list_t *sgl, bool *eof)
+{
+	if (daos_handle_is_inval(eh))
+		return -DER_NO_HDL;
+	if (nr == NULL || kds == NULL || eof == NULL)
+		return -DER_INVAL;
+
+	return dc_obj_list_dkey_par_next((struct dc_obj_enum_par *)eh.cookie, nr, kds, sgl, eof);
+}
+
+int
+daos_obj_list_dkey_par_close(daos_handle_t eh)
+{
+	if (daos_handle_is_inval(eh))
+		return -DER_NO_HDL;
+
+	dc_obj_list_dkey_par_close((struct dc_obj_enum_par *)eh.cookie);
+	return 0;
+}
+
 int
 daos_obj_list_akey(daos_handle_t oh, daos_handle_t th, daos_key_t *dkey,
 		   uint32_t *nr, daos_key_desc_t *kds, d_sg_list_t *sgl,
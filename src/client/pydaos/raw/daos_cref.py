@@ -51,7 +51,7 @@ class RebuildStatus(ctypes.Structure):
                 ("rs_seconds", ctypes.c_uint32),
                 ("rs_errno", ctypes.c_uint32),
                 ("rs_state", ctypes.c_uint32),
-                ("rs_padding32", ctypes.c_uint32),
+                ("rs_throttle", ctypes.c_uint32),
                 ("rs_fail_rank", ctypes.c_uint32),
                 ("rs_toberb_obj_nr", ctypes.c_uint64),
                 ("rs_obj_nr", ctypes.c_uint64),
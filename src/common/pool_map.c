@@ -680,6 +680,328 @@ pool_buf_extract(struct pool_map *map, struct pool_buf **buf_pp)
 	return rc;
 }
 
+/** One entry of struct pool_map_hist */
+struct pool_map_delta {
+	d_list_t		 pmd_link;
+	/** map version after applying this delta */
+	uint32_t		 pmd_version;
+	/** changed components, pb_delta_base is the version before this delta */
+	struct pool_buf		*pmd_buf;
+};
+
+/** component record tagged with its age, used for merging deltas */
+struct pool_comp_rec {
+	struct pool_component	pcr_comp;
+	/** 0 for the newest delta */
+	uint32_t		pcr_seq;
+};
+
+/** same order as pool_buf_attach() requires: high level domains first */
+static int
+pool_comp_key_cmp(const void *a, const void *b)
+{
+	const struct pool_component *ca = a;
+	const struct pool_component *cb = b;
+
+	if (ca->co_type != cb->co_type)
+		return ca->co_type > cb->co_type ? -1 : 1;
+	if (ca->co_id != cb->co_id)
+		return ca->co_id < cb->co_id ? -1 : 1;
+	return 0;
+}
+
+static int
+pool_comp_rec_cmp(const void *a, const void *b)
+{
+	const struct pool_comp_rec	*ra = a;
+	const struct pool_comp_rec	*rb = b;
+	int				 rc;
+
+	rc = pool_comp_key_cmp(&ra->pcr_comp, &rb->pcr_comp);
+	if (rc != 0)
+		return rc;
+	if (ra->pcr_seq != rb->pcr_seq)
+		return ra->pcr_seq < rb->pcr_seq ? -1 : 1;
+	return 0;
+}
+
+static void
+pool_map_delta_free(struct pool_map_delta *delta)
+{
+	d_list_del(&delta->pmd_link);
+	pool_buf_free(delta->pmd_buf);
+	D_FREE(delta);
+}
+
+void
+pool_map_hist_init(struct pool_map_hist *hist)
+{
+	D_INIT_LIST_HEAD(&hist->pmh_list);
+	hist->pmh_nr = 0;
+}
+
+void
+pool_map_hist_fini(struct pool_map_hist *hist)
+{
+	struct pool_map_delta	*delta;
+	struct pool_map_delta	*tmp;
+
+	d_list_for_each_entry_safe(delta, tmp, &hist->pmh_list, pmd_link)
+		pool_map_delta_free(delta);
+	hist->pmh_nr = 0;
+}
+
+/**
+ * Record the difference between two consecutive pool maps in the history.
+ * Only the component changes (status, versions, flags etc) are recorded,
+ * the history is reset if the structure of the map has changed (extending),
+ * if \a old_map is not the newest map of the history, or if the delta is not
+ * much smaller than the full map. The history always keeps a chain of
+ * contiguous deltas ending at the version of \a new_map.
+ *
+ * \param hist		[IN]	The pool map history.
+ * \param old_map	[IN]	The pool map being replaced.
+ * \param new_map	[IN]	The new pool map.
+ *
+ * \return		0 if the delta is recorded or the history is reset,
+ *			negative error code if failed to record the delta, the
+ *			history is reset as well in this case.
+ */
+int
+pool_map_hist_add(struct pool_map_hist *hist, struct pool_map *old_map,
+		  struct pool_map *new_map)
+{
+	struct pool_map_delta	*delta;
+	struct pool_buf		*old_buf = NULL;
+	struct pool_buf		*new_buf = NULL;
+	uint32_t		 old_ver = pool_map_get_version(old_map);
+	uint32_t		 new_ver = pool_map_get_version(new_map);
+	unsigned int		 nr = 0;
+	unsigned int		 i;
+	int			 rc;
+
+	if (old_ver == 0 || new_ver <= old_ver)
+		D_GOTO(reset, rc = 0);
+
+	if (!d_list_empty(&hist->pmh_list)) {
+		delta = d_list_entry(hist->pmh_list.prev, struct pool_map_delta, pmd_link);
+		if (delta->pmd_version != old_ver)
+			pool_map_hist_fini(hist);
+	}
+
+	rc = pool_buf_extract(old_map, &old_buf);
+	if (rc != 0)
+		D_GOTO(reset, rc);
+
+	rc = pool_buf_extract(new_map, &new_buf);
+	if (rc != 0)
+		D_GOTO(reset, rc);
+
+	if (old_buf->pb_nr != new_buf->pb_nr)
+		D_GOTO(reset, rc = 0);
+
+	for (i = 0; i < new_buf->pb_nr; i++) {
+		if (pool_comp_key_cmp(&old_buf->pb_comps[i], &new_buf->pb_comps[i]) != 0)
+			D_GOTO(reset, rc = 0);
+		if (memcmp(&old_buf->pb_comps[i], &new_buf->pb_comps[i],
+			   sizeof(new_buf->pb_comps[i])) != 0)
+			nr++;
+	}
+
+	if (nr > new_buf->pb_nr / 2)
+		D_GOTO(reset, rc = 0);
+
+	D_ALLOC_PTR(delta);
+	if (delta == NULL)
+		D_GOTO(reset, rc = -DER_NOMEM);
+
+	delta->pmd_buf = pool_buf_alloc(nr);
+	if (delta->pmd_buf == NULL) {
+		D_FREE(delta);
+		D_GOTO(reset, rc = -DER_NOMEM);
+	}
+
+	for (i = 0; i < new_buf->pb_nr; i++) {
+		if (memcmp(&old_buf->pb_comps[i], &new_buf->pb_comps[i],
+			   sizeof(new_buf->pb_comps[i])) == 0)
+			continue;
+		rc = pool_buf_attach(delta->pmd_buf, &new_buf->pb_comps[i], 1);
+		D_ASSERT(rc == 0);
+	}
+	delta->pmd_buf->pb_delta_base = old_ver;
+	delta->pmd_version = new_ver;
+
+	d_list_add_tail(&delta->pmd_link, &hist->pmh_list);
+	if (++hist->pmh_nr > POOL_MAP_HIST_MAX) {
+		pool_map_delta_free(d_list_entry(hist->pmh_list.next, struct pool_map_delta,
+						 pmd_link));
+		hist->pmh_nr--;
+	}
+
+	D_DEBUG(DB_TRACE, "pool map delta %u->%u: %u of %u components\n",
+		old_ver, new_ver, nr, new_buf->pb_nr);
+	goto out;
+reset:
+	pool_map_hist_fini(hist);
+out:
+	if (old_buf != NULL)
+		pool_buf_free(old_buf);
+	if (new_buf != NULL)
+		pool_buf_free(new_buf);
+	return rc;
+}
+
+/**
+ * Merge the deltas from version \a base to the version of \a map, the newest
+ * record wins if a component has been changed more than once.
+ *
+ * \param hist		[IN]	The pool map history.
+ * \param map		[IN]	The current pool map.
+ * \param base		[IN]	The version of the pool map cached by the peer.
+ * \param buf_pp	[OUT]	The returned delta with pb_delta_base set to
+ *				\a base, should be freed by pool_buf_free.
+ *
+ * \return		0 on success, -DER_NONEXIST if the history does not
+ *			cover \a base or if the merged delta is not much
+ *			smaller than the full map, the caller should send the
+ *			full map then.
+ */
+int
+pool_map_hist_extract(struct pool_map_hist *hist, struct pool_map *map, uint32_t base,
+		      struct pool_buf **buf_pp)
+{
+	struct pool_map_delta	*delta;
+	struct pool_comp_rec	*recs;
+	struct pool_buf		*buf;
+	unsigned int		 total = 0;
+	unsigned int		 seq = 0;
+	unsigned int		 nr = 0;
+	unsigned int		 i;
+	bool			 found = false;
+	int			 rc = 0;
+
+	if (base == 0 || d_list_empty(&hist->pmh_list))
+		return -DER_NONEXIST;
+
+	delta = d_list_entry(hist->pmh_list.prev, struct pool_map_delta, pmd_link);
+	if (delta->pmd_version != pool_map_get_version(map))
+		return -DER_NONEXIST;
+
+	d_list_for_each_entry(delta, &hist->pmh_list, pmd_link) {
+		if (delta->pmd_buf->pb_delta_base == base)
+			found = true;
+		if (found)
+			total += delta->pmd_buf->pb_nr;
+	}
+	if (!found)
+		return -DER_NONEXIST;
+
+	D_ALLOC_ARRAY(recs, total + 1);
+	if (recs == NULL)
+		return -DER_NOMEM;
+
+	d_list_for_each_entry_reverse(delta, &hist->pmh_list, pmd_link) {
+		for (i = 0; i < delta->pmd_buf->pb_nr; i++, nr++) {
+			recs[nr].pcr_comp = delta->pmd_buf->pb_comps[i];
+			recs[nr].pcr_seq = seq;
+		}
+		if (delta->pmd_buf->pb_delta_base == base)
+			break;
+		seq++;
+	}
+	D_ASSERT(nr == total);
+
+	/* keep the newest record of each component */
+	qsort(recs, total, sizeof(*recs), pool_comp_rec_cmp);
+	for (i = nr = 0; i < total; i++) {
+		if (nr > 0 && pool_comp_key_cmp(&recs[nr - 1].pcr_comp, &recs[i].pcr_comp) == 0)
+			continue;
+		recs[nr++] = recs[i];
+	}
+
+	if (nr > pool_map_comp_cnt(map) / 2)
+		D_GOTO(out, rc = -DER_NONEXIST);
+
+	buf = pool_buf_alloc(nr);
+	if (buf == NULL)
+		D_GOTO(out, rc = -DER_NOMEM);
+
+	for (i = 0; i < nr; i++) {
+		rc = pool_buf_attach(buf, &recs[i].pcr_comp, 1);
+		D_ASSERT(rc == 0);
+	}
+	buf->pb_delta_base = base;
+	*buf_pp = buf;
+out:
+	D_FREE(recs);
+	return rc;
+}
+
+/**
+ * Create a new pool map by applying a delta to the cached pool map.
+ *
+ * \param map		[IN]	The cached pool map, its version must be the
+ *				pb_delta_base of \a delta.
+ * \param delta		[IN]	The delta returned by pool_map_hist_extract.
+ * \param version	[IN]	Version of the new pool map.
+ * \param mapp		[OUT]	The returned pool map.
+ *
+ * \return		0 on success, -DER_MISMATCH if \a delta is not
+ *			based on \a map, -DER_INVAL if \a delta does not
+ *			match the components of \a map.
+ */
+int
+pool_map_delta_apply(struct pool_map *map, struct pool_buf *delta, uint32_t version,
+		     struct pool_map **mapp)
+{
+	struct pool_component	*comps = NULL;
+	struct pool_component	*comp;
+	struct pool_buf		*buf;
+	unsigned int		 hit = 0;
+	unsigned int		 i;
+	int			 rc;
+
+	if (delta->pb_delta_base != pool_map_get_version(map) ||
+	    version <= delta->pb_delta_base) {
+		D_DEBUG(DB_MGMT, "delta %u->%u does not apply to version %u\n",
+			delta->pb_delta_base, version, pool_map_get_version(map));
+		return -DER_MISMATCH;
+	}
+
+	rc = pool_buf_extract(map, &buf);
+	if (rc != 0)
+		return rc;
+
+	if (delta->pb_nr > 0) {
+		D_ALLOC_ARRAY(comps, delta->pb_nr);
+		if (comps == NULL)
+			D_GOTO(out, rc = -DER_NOMEM);
+
+		memcpy(comps, delta->pb_comps, delta->pb_nr * sizeof(*comps));
+		qsort(comps, delta->pb_nr, sizeof(*comps), pool_comp_key_cmp);
+		for (i = 0; i < buf->pb_nr; i++) {
+			comp = bsearch(&buf->pb_comps[i], comps, delta->pb_nr, sizeof(*comps),
+				       pool_comp_key_cmp);
+			if (comp == NULL)
+				continue;
+			buf->pb_comps[i] = *comp;
+			hit++;
+		}
+	}
+
+	if (hit != delta->pb_nr) {
+		D_ERROR("only %u of %u delta components are found in version %u\n",
+			hit, delta->pb_nr, delta->pb_delta_base);
+		D_GOTO(out, rc = -DER_INVAL);
+	}
+
+	rc = pool_map_create(buf, version, mapp);
+out:
+	D_FREE(comps);
+	pool_buf_free(buf);
+	return rc;
+}
+
 /**
  * Count number of domains, targets, and layers of domains etc in the
  * component tree.
@@ -0,0 +1,360 @@
+/*
+ * (C) Copyright 2023 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+
+/**
+ * Unit tests for the pool map history and deltas
+ */
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <daos/common.h>
+#include <daos/pool_map.h>
+#include <daos/tests_lib.h>
+
+#define NODE_NR		2
+#define RANK_NR		8
+#define TGT_NR		4
+#define COMP_NR(ranks)	(NODE_NR + (ranks) + (ranks) * TGT_NR)
+#define COMP_MAX	COMP_NR(RANK_NR + 2)
+
+/* Components of the map being built, nodes first and then ranks and targets */
+static struct pool_component	test_comps[COMP_MAX];
+static unsigned int		test_rank_nr;
+
+static void
+comps_init(unsigned int rank_nr)
+{
+	struct pool_component	*comp = &test_comps[0];
+	unsigned int		 i;
+
+	memset(test_comps, 0, sizeof(test_comps));
+	test_rank_nr = rank_nr;
+
+	for (i = 0; i < NODE_NR; i++, comp++) {
+		comp->co_type	= PO_COMP_TP_NODE;
+		comp->co_status	= PO_COMP_ST_UPIN;
+		comp->co_id	= i;
+		comp->co_rank	= i;
+		comp->co_ver	= 1;
+		comp->co_nr	= rank_nr / NODE_NR;
+	}
+
+	for (i = 0; i < rank_nr; i++, comp++) {
+		comp->co_type	= PO_COMP_TP_RANK;
+		comp->co_status	= PO_COMP_ST_UPIN;
+		comp->co_id	= i;
+		comp->co_rank	= i;
+		comp->co_ver	= 1;
+		comp->co_nr	= TGT_NR;
+	}
+
+	for (i = 0; i < rank_nr * TGT_NR; i++, comp++) {
+		comp->co_type	= PO_COMP_TP_TARGET;
+		comp->co_status	= PO_COMP_ST_UPIN;
+		comp->co_id	= i;
+		comp->co_rank	= i / TGT_NR;
+		comp->co_index	= i % TGT_NR;
+		comp->co_ver	= 1;
+		comp->co_nr	= 1;
+	}
+}
+
+static void
+tgt_set(unsigned int id, uint8_t status, uint32_t ver)
+{
+	struct pool_component	*comp = &test_comps[NODE_NR + test_rank_nr + id];
+
+	assert_int_equal(comp->co_id, id);
+	comp->co_status = status;
+	comp->co_ver = ver;
+	if (status == PO_COMP_ST_DOWN)
+		comp->co_fseq = ver;
+}
+
+static struct pool_map *
+map_create(uint32_t version)
+{
+	struct pool_buf	*buf;
+	struct pool_map	*map;
+	unsigned int	 nr = COMP_NR(test_rank_nr);
+
+	buf = pool_buf_alloc(nr);
+	assert_non_null(buf);
+	assert_rc_equal(pool_buf_attach(buf, test_comps, nr), 0);
+	assert_rc_equal(pool_map_create(buf, version, &map), 0);
+	pool_buf_free(buf);
+	return map;
+}
+
+/* Both maps have the same version and components */
+static void
+map_equal(struct pool_map *map, struct pool_map *expected)
+{
+	struct pool_buf	*buf;
+	struct pool_buf	*exp_buf;
+
+	assert_int_equal(pool_map_get_version(map), pool_map_get_version(expected));
+	assert_rc_equal(pool_buf_extract(map, &buf), 0);
+	assert_rc_equal(pool_buf_extract(expected, &exp_buf), 0);
+	assert_int_equal(buf->pb_nr, exp_buf->pb_nr);
+	assert_memory_equal(buf->pb_comps, exp_buf->pb_comps,
+			    exp_buf->pb_nr * sizeof(exp_buf->pb_comps[0]));
+	pool_buf_free(buf);
+	pool_buf_free(exp_buf);
+}
+
+/* Extract the delta from @base and apply it on @base_map, check it gives @map */
+static void
+delta_check(struct pool_map_hist *hist, struct pool_map *base_map, struct pool_map *map,
+	    unsigned int comp_nr)
+{
+	struct pool_buf	*delta;
+	struct pool_map	*new_map;
+	uint32_t	 base = pool_map_get_version(base_map);
+
+	assert_rc_equal(pool_map_hist_extract(hist, map, base, &delta), 0);
+	assert_int_equal(delta->pb_delta_base, base);
+	assert_int_equal(delta->pb_nr, comp_nr);
+
+	assert_rc_equal(pool_map_delta_apply(base_map, delta, pool_map_get_version(map),
+					     &new_map), 0);
+	map_equal(new_map, map);
+	pool_map_decref(new_map);
+	pool_buf_free(delta);
+}
+
+static void
+maps_put(struct pool_map **maps, int nr)
+{
+	int	i;
+
+	for (i = 0; i < nr; i++) {
+		if (maps[i] != NULL)
+			pool_map_decref(maps[i]);
+	}
+}
+
+/* A single delta applied on the base map gives the new map */
+static void
+test_delta_round_trip(void **state)
+{
+	struct pool_map_hist	 hist;
+	struct pool_map		*maps[3] = { NULL };
+	struct pool_buf		*delta;
+	struct pool_map		*new_map;
+
+	pool_map_hist_init(&hist);
+	comps_init(RANK_NR);
+	maps[1] = map_create(1);
+
+	tgt_set(3, PO_COMP_ST_DOWN, 2);
+	tgt_set(17, PO_COMP_ST_DOWN, 2);
+	maps[2] = map_create(2);
+
+	assert_rc_equal(pool_map_hist_add(&hist, maps[1], maps[2]), 0);
+	assert_int_equal(hist.pmh_nr, 1);
+	delta_check(&hist, maps[1], maps[2], 2);
+
+	/* Up to date or unknown base */
+	assert_rc_equal(pool_map_hist_extract(&hist, maps[2], 2, &delta), -DER_NONEXIST);
+	assert_rc_equal(pool_map_hist_extract(&hist, maps[2], 0, &delta), -DER_NONEXIST);
+
+	/* The delta only applies to its base version */
+	assert_rc_equal(pool_map_hist_extract(&hist, maps[2], 1, &delta), 0);
+	assert_rc_equal(pool_map_delta_apply(maps[2], delta, 3, &new_map), -DER_MISMATCH);
+	assert_rc_equal(pool_map_delta_apply(maps[1], delta, 1, &new_map), -DER_MISMATCH);
+	pool_buf_free(delta);
+
+	/* Nothing is recorded for a stale or the same version */
+	assert_rc_equal(pool_map_hist_add(&hist, maps[2], maps[1]), 0);
+	assert_int_equal(hist.pmh_nr, 0);
+
+	pool_map_hist_fini(&hist);
+	maps_put(maps, 3);
+}
+
+/* The history is a contiguous chain ending at the newest version */
+static void
+test_delta_gap(void **state)
+{
+	struct pool_map_hist	 hist;
+	struct pool_map		*maps[POOL_MAP_HIST_MAX + 5] = { NULL };
+	struct pool_buf		*delta;
+	int			 i;
+
+	pool_map_hist_init(&hist);
+	comps_init(RANK_NR);
+	maps[1] = map_create(1);
+	tgt_set(0, PO_COMP_ST_DOWN, 2);
+	maps[2] = map_create(2);
+	tgt_set(1, PO_COMP_ST_DOWN, 3);
+	maps[3] = map_create(3);
+	tgt_set(2, PO_COMP_ST_DOWN, 4);
+	maps[4] = map_create(4);
+
+	assert_rc_equal(pool_map_hist_add(&hist, maps[1], maps[2]), 0);
+	/* 2->3 is missed, the history restarts from 3 */
+	assert_rc_equal(pool_map_hist_add(&hist, maps[3], maps[4]), 0);
+	assert_int_equal(hist.pmh_nr, 1);
+	assert_rc_equal(pool_map_hist_extract(&hist, maps[4], 1, &delta), -DER_NONEXIST);
+	assert_rc_equal(pool_map_hist_extract(&hist, maps[4], 2, &delta), -DER_NONEXIST);
+	delta_check(&hist, maps[3], maps[4], 1);
+
+	/* The history doesn't end at the current map */
+	assert_rc_equal(pool_map_hist_extract(&hist, maps[3], 3, &delta), -DER_NONEXIST);
+
+	/* The oldest deltas are dropped beyond POOL_MAP_HIST_MAX */
+	for (i = 5; i < ARRAY_SIZE(maps); i++) {
+		tgt_set(i - 2, PO_COMP_ST_DOWN, i);
+		maps[i] = map_create(i);
+		assert_rc_equal(pool_map_hist_add(&hist, maps[i - 1], maps[i]), 0);
+	}
+	i = ARRAY_SIZE(maps) - 1;
+	assert_int_equal(hist.pmh_nr, POOL_MAP_HIST_MAX);
+	assert_rc_equal(pool_map_hist_extract(&hist, maps[i], 3, &delta), -DER_NONEXIST);
+	delta_check(&hist, maps[i - POOL_MAP_HIST_MAX], maps[i], POOL_MAP_HIST_MAX);
+	delta_check(&hist, maps[i - 1], maps[i], 1);
+
+	pool_map_hist_fini(&hist);
+	assert_int_equal(hist.pmh_nr, 0);
+	maps_put(maps, ARRAY_SIZE(maps));
+}
+
+/* Extending the map or changing most of it resets the history */
+static void
+test_delta_structure(void **state)
+{
+	struct pool_map_hist	 hist;
+	struct pool_map		*maps[6] = { NULL };
+	struct pool_buf		*delta;
+	struct pool_map		*new_map;
+	unsigned int		 i;
+
+	pool_map_hist_init(&hist);
+	comps_init(RANK_NR);
+	maps[1] = map_create(1);
+	tgt_set(5, PO_COMP_ST_DOWN, 2);
+	maps[2] = map_create(2);
+	assert_rc_equal(pool_map_hist_add(&hist, maps[1], maps[2]), 0);
+	assert_int_equal(hist.pmh_nr, 1);
+
+	comps_init(RANK_NR + 2);
+	tgt_set(5, PO_COMP_ST_DOWN, 2);
+	maps[3] = map_create(3);
+	assert_rc_equal(pool_map_hist_add(&hist, maps[2], maps[3]), 0);
+	assert_int_equal(hist.pmh_nr, 0);
+	assert_rc_equal(pool_map_hist_extract(&hist, maps[3], 1, &delta), -DER_NONEXIST);
+	assert_rc_equal(pool_map_hist_extract(&hist, maps[3], 2, &delta), -DER_NONEXIST);
+
+	/* A delta with components unknown to the base map is rejected */
+	delta = pool_buf_alloc(1);
+	assert_non_null(delta);
+	assert_rc_equal(pool_buf_attach(delta, &test_comps[COMP_NR(RANK_NR + 2) - 1], 1), 0);
+	delta->pb_delta_base = 2;
+	assert_rc_equal(pool_map_delta_apply(maps[2], delta, 3, &new_map), -DER_INVAL);
+	pool_buf_free(delta);
+
+	/* The history restarts on the extended map */
+	tgt_set(38, PO_COMP_ST_DOWN, 4);
+	maps[4] = map_create(4);
+	assert_rc_equal(pool_map_hist_add(&hist, maps[3], maps[4]), 0);
+	assert_int_equal(hist.pmh_nr, 1);
+	delta_check(&hist, maps[3], maps[4], 1);
+
+	/* Most of the components changed, the full map is cheaper */
+	for (i = 0; i < (RANK_NR + 2) * TGT_NR; i++)
+		tgt_set(i, PO_COMP_ST_DOWN, 5);
+	maps[5] = map_create(5);
+	assert_rc_equal(pool_map_hist_add(&hist, maps[4], maps[5]), 0);
+	assert_int_equal(hist.pmh_nr, 0);
+	assert_rc_equal(pool_map_hist_extract(&hist, maps[5], 4, &delta), -DER_NONEXIST);
+
+	pool_map_hist_fini(&hist);
+	maps_put(maps, ARRAY_SIZE(maps));
+}
+
+/* A component changed by several deltas is only sent once, in its newest state */
+static void
+test_delta_merge(void **state)
+{
+	struct pool_map_hist	 hist;
+	struct pool_map		*maps[5] = { NULL };
+	struct pool_buf		*delta;
+	unsigned int		 i;
+
+	pool_map_hist_init(&hist);
+	comps_init(RANK_NR);
+	maps[1] = map_create(1);
+	tgt_set(6, PO_COMP_ST_DOWN, 2);
+	tgt_set(7, PO_COMP_ST_DOWN, 2);
+	maps[2] = map_create(2);
+	tgt_set(6, PO_COMP_ST_DOWNOUT, 3);
+	maps[3] = map_create(3);
+	tgt_set(7, PO_COMP_ST_DOWNOUT, 4);
+	tgt_set(9, PO_COMP_ST_DOWN, 4);
+	maps[4] = map_create(4);
+
+	for (i = 2; i < ARRAY_SIZE(maps); i++)
+		assert_rc_equal(pool_map_hist_add(&hist, maps[i - 1], maps[i]), 0);
+	assert_int_equal(hist.pmh_nr, 3);
+
+	assert_rc_equal(pool_map_hist_extract(&hist, maps[4], 1, &delta), 0);
+	assert_int_equal(delta->pb_nr, 3);
+	for (i = 0; i < delta->pb_nr; i++) {
+		switch (delta->pb_comps[i].co_id) {
+		case 6:
+			assert_int_equal(delta->pb_comps[i].co_status, PO_COMP_ST_DOWNOUT);
+			assert_int_equal(delta->pb_comps[i].co_ver, 3);
+			break;
+		case 7:
+			assert_int_equal(delta->pb_comps[i].co_status, PO_COMP_ST_DOWNOUT);
+			assert_int_equal(delta->pb_comps[i].co_ver, 4);
+			break;
+		case 9:
+			assert_int_equal(delta->pb_comps[i].co_status, PO_COMP_ST_DOWN);
+			break;
+		default:
+			fail_msg("unexpected component %u\n", delta->pb_comps[i].co_id);
+		}
+	}
+	pool_buf_free(delta);
+
+	delta_check(&hist, maps[1], maps[4], 3);
+	delta_check(&hist, maps[2], maps[4], 3);
+	delta_check(&hist, maps[3], maps[4], 2);
+
+	pool_map_hist_fini(&hist);
+	maps_put(maps, ARRAY_SIZE(maps));
+}
+
+static int
+init_tests(void **state)
+{
+	return d_log_init();
+}
+
+static int
+fini_tests(void **state)
+{
+	d_log_fini();
+	return 0;
+}
+
+int
+main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_delta_round_trip),
+		cmocka_unit_test(test_delta_gap),
+		cmocka_unit_test(test_delta_structure),
+		cmocka_unit_test(test_delta_merge),
+	};
+
+	return cmocka_run_group_tests_name("common_pool_map", tests, init_tests, fini_tests);
+}
@@ -722,6 +722,31 @@ cont_iv_ent_valid(struct ds_iv_entry *entry, struct ds_iv_key *key)
 	return true;
 }
 
+/* Lease the properties, snapshots and handle capabilities fetched from root */
+static uint32_t
+cont_iv_ent_lease(struct ds_iv_entry *entry, struct ds_iv_key *key)
+{
+	switch (key->class_id) {
+	case IV_CONT_PROP:
+	case IV_CONT_SNAP:
+	case IV_CONT_CAPA:
+		return DS_IV_LEASE_DEF;
+	default:
+		return 0;
+	}
+}
+
+/* The entry size differs between fetch, update and invalidate of the same key */
+static bool
+cont_iv_key_match(struct ds_iv_key *key1, struct ds_iv_key *key2)
+{
+	struct cont_iv_key	*civ_key1 = key2priv(key1);
+	struct cont_iv_key	*civ_key2 = key2priv(key2);
+
+	return civ_key1->class_id == civ_key2->class_id &&
+	       uuid_compare(civ_key1->cont_uuid, civ_key2->cont_uuid) == 0;
+}
+
 struct ds_iv_class_ops cont_iv_ops = {
 	.ivc_ent_init	= cont_iv_ent_init,
 	.ivc_ent_get	= cont_iv_ent_get,
@@ -732,6 +757,8 @@ struct ds_iv_class_ops cont_iv_ops = {
 	.ivc_ent_refresh = cont_iv_ent_refresh,
 	.ivc_value_alloc = cont_iv_value_alloc,
 	.ivc_ent_valid	= cont_iv_ent_valid,
+	.ivc_ent_lease	= cont_iv_ent_lease,
+	.ivc_key_match	= cont_iv_key_match,
 };
 
 static int
@@ -1142,6 +1169,23 @@ cont_iv_entry_delete(void *ns, uuid_t pool_uuid, uuid_t cont_uuid)
 	return 0;
 }
 
+/*
+ * Break the leases of the snapshots and properties of the container on all
+ * engines (see cont_iv_ent_lease()), cont_iv_entry_delete() only drops the
+ * local entries of each engine.
+ */
+int
+cont_iv_lease_break(void *ns, uuid_t cont_uuid)
+{
+	int	rc;
+
+	rc = cont_iv_invalidate(ns, IV_CONT_SNAP, cont_uuid, CRT_IV_SYNC_EAGER);
+	if (rc != 0)
+		return rc;
+
+	return cont_iv_invalidate(ns, IV_CONT_PROP, cont_uuid, CRT_IV_SYNC_EAGER);
+}
+
 int
 cont_iv_capability_invalidate(void *ns, uuid_t cont_hdl_uuid, int mode)
 {
@@ -1554,6 +1554,12 @@ cont_destroy(struct rdb_tx *tx, struct ds_pool_hdl *pool_hdl,
 	if (rc != 0)
 		goto out_prop;
 
+	/* Synchronously, the leased values would be served for a while otherwise */
+	rc = cont_iv_lease_break(pool_hdl->sph_pool->sp_iv_ns, cont->c_uuid);
+	if (rc != 0)
+		D_WARN(DF_CONT": failed to break IV leases: "DF_RC"\n",
+		       DP_CONT(pool_hdl->sph_pool->sp_uuid, cont->c_uuid), DP_RC(rc));
+
 	rc = cont_destroy_bcast(rpc->cr_ctx, cont->c_svc, cont->c_uuid);
 	if (rc != 0)
 		goto out_prop;
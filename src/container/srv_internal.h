@@ -287,6 +287,7 @@ int cont_iv_snapshots_update(void *ns, uuid_t cont_uuid,
 int cont_iv_ec_agg_eph_update(void *ns, uuid_t cont_uuid, daos_epoch_t eph);
 int cont_iv_ec_agg_eph_refresh(void *ns, uuid_t cont_uuid, daos_epoch_t eph);
 int cont_iv_entry_delete(void *ns, uuid_t pool_uuid, uuid_t cont_uuid);
+int cont_iv_lease_break(void *ns, uuid_t cont_uuid);
 
 /* srv_metrics.c*/
 void *ds_cont_metrics_alloc(const char *path, int tgt_id);
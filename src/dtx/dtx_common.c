@@ -53,7 +53,9 @@ struct dtx_batched_cont_args {
 	uint32_t			 dbca_deregister:1,
 					 dbca_cleanup_done:1,
 					 dbca_commit_done:1,
-					 dbca_agg_done:1;
+					 dbca_agg_done:1,
+					 /* Committed together with other container. */
+					 dbca_coalescing:1;
 };
 
 struct dtx_partial_cmt_item {
@@ -576,6 +578,100 @@ dtx_aggregation_main(void *arg)
 	dmi->dmi_dtx_agg_req = NULL;
 }
 
+static inline bool
+dtx_cont_commit_thd(struct ds_cont_child *cont, uint32_t *cnt_thd, uint32_t *age_thd,
+		    uint32_t *batch)
+{
+	return dtx_batched_commit_thd(cont->sc_dtx_refresh_cnt, cont->sc_dtx_eager_rounds,
+				      dss_rpc_cntr_get(DSS_RC_OBJ)->rc_active,
+				      cnt_thd, age_thd, batch);
+}
+
+/*
+ * Commit the DTXs fetched from the container of @dbca together with the committable
+ * DTXs of other containers of the same pool on current target, up to @batch entries
+ * in total. Then the DTXs of these containers for the same rank/tag are sent to the
+ * remote target via single DTX_COMMIT RPC.
+ */
+static int
+dtx_batched_commit_coalesce(struct dtx_batched_cont_args *dbca, struct dtx_entry **dtes,
+			    struct dtx_cos_key *dcks, int cnt, uint32_t batch)
+{
+	struct dtx_batched_cont_args	 *dbcas[DTX_COALESCE_CONT_MAX];
+	struct ds_cont_child		 *conts[DTX_COALESCE_CONT_MAX];
+	struct dtx_entry		**c_dtes[DTX_COALESCE_CONT_MAX];
+	struct dtx_cos_key		 *c_dcks[DTX_COALESCE_CONT_MAX];
+	uint32_t			  cnts[DTX_COALESCE_CONT_MAX];
+	struct dtx_batched_cont_args	 *tmp;
+	struct dtx_entry		**all_dtes = NULL;
+	struct dtx_cos_key		 *all_dcks = NULL;
+	uint32_t			  total = cnt;
+	uint32_t			  off;
+	int				  nr = 1;
+	int				  rc;
+	int				  i;
+
+	d_list_for_each_entry(tmp, &dbca->dbca_pool->dbpa_cont_list, dbca_pool_link) {
+		if (nr >= DTX_COALESCE_CONT_MAX || total >= batch)
+			break;
+
+		/* Skip the container that is being committed by its own ULT or others. */
+		if (tmp == dbca || tmp->dbca_deregister || tmp->dbca_commit_req != NULL ||
+		    tmp->dbca_coalescing || !dtx_cont_opened(tmp->dbca_cont) ||
+		    tmp->dbca_cont->sc_dtx_committable_count == 0)
+			continue;
+
+		rc = dtx_fetch_committable(tmp->dbca_cont, batch - total, NULL, DAOS_EPOCH_MAX,
+					   &c_dtes[nr], &c_dcks[nr]);
+		if (rc <= 0)
+			continue;
+
+		dtx_get_dbca(tmp);
+		tmp->dbca_coalescing = 1;
+		dbcas[nr] = tmp;
+		conts[nr] = tmp->dbca_cont;
+		cnts[nr] = rc;
+		total += rc;
+		nr++;
+	}
+
+	if (nr == 1) {
+		rc = dtx_commit(dbca->dbca_cont, dtes, dcks, cnt);
+		goto out;
+	}
+
+	D_ALLOC_ARRAY(all_dtes, total);
+	D_ALLOC_ARRAY(all_dcks, total);
+	if (all_dtes == NULL || all_dcks == NULL)
+		D_GOTO(out, rc = -DER_NOMEM);
+
+	conts[0] = dbca->dbca_cont;
+	cnts[0] = cnt;
+	c_dtes[0] = dtes;
+	c_dcks[0] = dcks;
+	for (i = 0, off = 0; i < nr; off += cnts[i++]) {
+		memcpy(all_dtes + off, c_dtes[i], sizeof(*all_dtes) * cnts[i]);
+		memcpy(all_dcks + off, c_dcks[i], sizeof(*all_dcks) * cnts[i]);
+	}
+
+	rc = dtx_commit_coalesced(conts, cnts, nr, all_dtes, all_dcks);
+
+out:
+	if (rc == 0)
+		d_tm_set_gauge(dtx_tls_get()->dt_batched_size, total);
+
+	for (i = 1; i < nr; i++) {
+		dtx_free_committable(c_dtes[i], c_dcks[i], cnts[i]);
+		dbcas[i]->dbca_coalescing = 0;
+		dtx_put_dbca(dbcas[i]);
+	}
+
+	D_FREE(all_dtes);
+	D_FREE(all_dcks);
+
+	return rc;
+}
+
 static void
 dtx_batched_commit_one(void *arg)
 {
@@ -595,11 +691,18 @@ dtx_batched_commit_one(void *arg)
 		struct dtx_entry	**dtes = NULL;
 		struct dtx_cos_key	 *dcks = NULL;
 		struct dtx_stat		  stat = { 0 };
+		uint32_t		  cnt_thd;
+		uint32_t		  age_thd;
+		uint32_t		  batch;
+		bool			  eager;
 		int			  cnt;
 		int			  rc;
 
-		cnt = dtx_fetch_committable(cont, DTX_THRESHOLD_COUNT, NULL,
-					    DAOS_EPOCH_MAX, &dtes, &dcks);
+		eager = dtx_cont_commit_thd(cont, &cnt_thd, &age_thd, &batch);
+		cont->sc_dtx_refresh_cnt = 0;
+		cont->sc_dtx_eager_rounds = eager ? cont->sc_dtx_eager_rounds + 1 : 0;
+
+		cnt = dtx_fetch_committable(cont, batch, NULL, DAOS_EPOCH_MAX, &dtes, &dcks);
 		if (cnt == 0)
 			break;
 
@@ -609,7 +712,7 @@ dtx_batched_commit_one(void *arg)
 			break;
 		}
 
-		rc = dtx_commit(cont, dtes, dcks, cnt);
+		rc = dtx_batched_commit_coalesce(dbca, dtes, dcks, cnt, batch);
 		dtx_free_committable(dtes, dcks, cnt);
 		if (rc != 0) {
 			D_WARN("Fail to batched commit %d entries for "DF_UUID": "DF_RC"\n",
@@ -623,10 +726,8 @@ dtx_batched_commit_one(void *arg)
 		    dbca->dbca_pool->dbpa_aggregating == 0)
 			sched_req_wakeup(dmi->dmi_dtx_agg_req);
 
-		if ((stat.dtx_committable_count <= DTX_THRESHOLD_COUNT) &&
-		    (stat.dtx_oldest_committable_time == 0 ||
-		     d_hlc_age2sec(stat.dtx_oldest_committable_time) <
-		     DTX_COMMIT_THRESHOLD_AGE))
+		dtx_cont_commit_thd(cont, &cnt_thd, &age_thd, &batch);
+		if (!dtx_batched_commit_needed(&stat, cnt_thd, age_thd))
 			break;
 	}
 
@@ -661,6 +762,9 @@ dtx_batched_commit(void *arg)
 	while (1) {
 		struct ds_cont_child	*cont;
 		struct dtx_stat		 stat = { 0 };
+		uint32_t		 cnt_thd;
+		uint32_t		 age_thd;
+		uint32_t		 batch;
 		int			 sleep_time = 50; /* ms */
 
 		if (d_list_empty(&dmi->dmi_dtx_batched_cont_open_list))
@@ -686,14 +790,16 @@ dtx_batched_commit(void *arg)
 			dbca->dbca_commit_done = 0;
 		}
 
+		dtx_cont_commit_thd(cont, &cnt_thd, &age_thd, &batch);
 		if (dtx_cont_opened(cont) && dbca->dbca_commit_req == NULL &&
+		    !dbca->dbca_coalescing &&
 		    (dtx_batched_ult_max != 0 && tls->dt_batched_ult_cnt < dtx_batched_ult_max) &&
-		    ((stat.dtx_committable_count > DTX_THRESHOLD_COUNT) ||
-		     (stat.dtx_oldest_committable_time != 0 &&
-		      d_hlc_age2sec(stat.dtx_oldest_committable_time) >=
-		      DTX_COMMIT_THRESHOLD_AGE))) {
+		    dtx_batched_commit_needed(&stat, cnt_thd, age_thd)) {
 			D_ASSERT(!dbca->dbca_commit_done);
 			sleep_time = 0;
+			if (stat.dtx_oldest_committable_time != 0)
+				d_tm_set_gauge(tls->dt_committable_age,
+					       d_hlc_age2sec(stat.dtx_oldest_committable_time));
 			dtx_get_dbca(dbca);
 
 			D_ASSERT(dbca->dbca_cont);
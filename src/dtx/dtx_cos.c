@@ -37,7 +37,7 @@ struct dtx_cos_rec {
 	 * commit RPC instead of piggyback via dispatched update/punch RPC.
 	 */
 	d_list_t		 dcr_expcmt_list;
-	/* The number of the PUNCH DTXs in the dcr_reg_list. */
+	/* The number of the DTXs in the dcr_reg_list. */
 	int			 dcr_reg_count;
 	/* The number of the DTXs in the dcr_prio_list. */
 	int			 dcr_prio_count;
@@ -343,8 +343,6 @@ dtx_list_cos(struct ds_cont_child *cont, daos_unit_oid_t *oid,
 		return rc == -DER_NONEXIST ? 0 : rc;
 
 	dcr = (struct dtx_cos_rec *)riov.iov_buf;
-	if (dcr->dcr_prio_count == 0)
-		return 0;
 
 	/* There are too many priority DTXs to be committed, as to cannot be
 	 * piggybacked via normal dispatched RPC. Return the specified @max
@@ -356,14 +354,30 @@ dtx_list_cos(struct ds_cont_child *cont, daos_unit_oid_t *oid,
 	else
 		count = dcr->dcr_prio_count;
 
+	/* The regular DTXs only touch the single redundancy group that is the
+	 * same as current modification, piggyback some of them to the shards
+	 * then the explicit DTX commit RPC is only needed when the dkey is idle.
+	 */
+	if (count < max)
+		count += min(max - count, min(dcr->dcr_reg_count, DTX_PIGGYBACK_REG_MAX));
+
+	if (count == 0)
+		return 0;
+
 	D_ALLOC_ARRAY(dti, count);
 	if (dti == NULL)
 		return -DER_NOMEM;
 
 	d_list_for_each_entry(dcrc, &dcr->dcr_prio_list, dcrc_lo_link) {
-		dti[i] = dcrc->dcrc_dte->dte_xid;
-		if (++i >= count)
+		if (i >= count)
+			break;
+		dti[i++] = dcrc->dcrc_dte->dte_xid;
+	}
+
+	d_list_for_each_entry(dcrc, &dcr->dcr_reg_list, dcrc_lo_link) {
+		if (i >= count)
 			break;
+		dti[i++] = dcrc->dcrc_dte->dte_xid;
 	}
 
 	D_ASSERTF(i == count, "Invalid count %d/%d\n", i, count);
@@ -22,16 +22,20 @@
  * These are for daos_rpc::dr_opc and DAOS_RPC_OPCODE(opc, ...) rather than
  * crt_req_create(..., opc, ...). See src/include/daos/rpc.h.
  */
-#define DAOS_DTX_VERSION	3
+#define DAOS_DTX_VERSION	4
 
 /* LIST of internal RPCS in form of:
  * OPCODE, flags, FMT, handler, corpc_hdlr,
  */
 #define DTX_PROTO_SRV_RPC_LIST						\
-	X(DTX_COMMIT, 0, &CQF_dtx, dtx_handler, NULL, "dtx_commit")	\
-	X(DTX_ABORT, 0, &CQF_dtx, dtx_handler, NULL, "dtx_abort")	\
-	X(DTX_CHECK, 0, &CQF_dtx, dtx_handler, NULL, "dtx_check")	\
-	X(DTX_REFRESH, 0, &CQF_dtx, dtx_handler, NULL, "dtx_refresh")
+	X(DTX_COMMIT, CRT_RPC_FEAT_AGGREGATE, &CQF_dtx, dtx_handler,	\
+	  NULL, "dtx_commit")						\
+	X(DTX_ABORT, CRT_RPC_FEAT_AGGREGATE, &CQF_dtx, dtx_handler,	\
+	  NULL, "dtx_abort")						\
+	X(DTX_CHECK, CRT_RPC_FEAT_AGGREGATE, &CQF_dtx, dtx_handler,	\
+	  NULL, "dtx_check")						\
+	X(DTX_REFRESH, CRT_RPC_FEAT_AGGREGATE, &CQF_dtx, dtx_handler,	\
+	  NULL, "dtx_refresh")
 
 #define X(a, b, c, d, e, f) a,
 enum dtx_operation {
@@ -40,13 +44,21 @@ enum dtx_operation {
 };
 #undef X
 
-/* DTX RPC input fields */
+/* DTX RPC input fields
+ *
+ * For DTX_COMMIT coalesced across containers of the same pool, the DTXs in
+ * di_dtx_array are grouped by container: the first di_co_cnts[0] entries
+ * belong to di_co_uuids[0], the next di_co_cnts[1] ones to di_co_uuids[1],
+ * and so on. If di_co_cnts is empty, all of them belong to di_co_uuid.
+ */
 #define DAOS_ISEQ_DTX							\
 	((uuid_t)		(di_po_uuid)		CRT_VAR)	\
 	((uuid_t)		(di_co_uuid)		CRT_VAR)	\
 	((uint64_t)		(di_epoch)		CRT_VAR)	\
 	((struct dtx_id)	(di_dtx_array)		CRT_ARRAY)	\
-	((uint32_t)		(di_flags)		CRT_ARRAY)
+	((uint32_t)		(di_flags)		CRT_ARRAY)	\
+	((uuid_t)		(di_co_uuids)		CRT_ARRAY)	\
+	((uint32_t)		(di_co_cnts)		CRT_ARRAY)
 
 /* DTX RPC output fields */
 #define DAOS_OSEQ_DTX							\
@@ -110,6 +122,11 @@ extern uint32_t dtx_agg_thd_cnt_lo;
  */
 #define DTX_AGG_AGE_PRESERVE	3
 
+/* The max count of the regular committable DTXs that can be piggybacked via
+ * one dispatched modification RPC.
+ */
+#define DTX_PIGGYBACK_REG_MAX	32
+
 /* The threshold for yield CPU when handle DTX RPC. */
 #define DTX_RPC_YIELD_THD	32
 
@@ -128,6 +145,36 @@ extern uint32_t dtx_agg_thd_age_up;
  */
 extern uint32_t dtx_agg_thd_age_lo;
 
+/* The max count of DTX entries to be committed via one batched commit round
+ * when the target is saturated.
+ */
+#define DTX_THRESHOLD_COUNT_MAX	(DTX_THRESHOLD_COUNT << 2)
+
+/* If the count of active object RPCs on the target exceeds such threshold,
+ * then the target is regarded as saturated, DTX batched commit will batch
+ * more entries per round to reduce the DTX commit RPCs that compete with
+ * the foreground I/O.
+ */
+#define DTX_BATCHED_BUSY_THD	64
+
+/* The time threshold (in second) for triggering DTX batched commit when the
+ * target is idle. Commit them sooner to avoid subsequent readers being blocked
+ * by the prepared DTXs and trigger DTX refresh.
+ */
+#define DTX_COMMIT_THRESHOLD_AGE_IDLE	1
+
+/* The max count of consecutive batched commit rounds that commit the committable
+ * DTXs eagerly because of DTX refresh. After that, one regular round is required
+ * before the next eager one, so that the readers cannot make the batched commit
+ * degenerate into per-DTX commit RPCs.
+ */
+#define DTX_REFRESH_EAGER_MAX	8
+
+/* The max count of containers (of the same pool) whose committable DTXs can be
+ * coalesced into one batched commit round.
+ */
+#define DTX_COALESCE_CONT_MAX	16
+
 /* The default count of DTX batched commit ULTs. */
 #define DTX_BATCHED_ULT_DEF	32
 
@@ -162,6 +209,10 @@ struct dtx_tls {
 	struct d_tm_node_t	*dt_committable;
 	struct d_tm_node_t	*dt_dtx_leader_total;
 	struct d_tm_node_t	*dt_dtx_entry_total;
+	/* Histogram of the DTX entries count per batched commit round. */
+	struct d_tm_node_t	*dt_batched_size;
+	/* Histogram of the oldest committable DTX age when batched commit. */
+	struct d_tm_node_t	*dt_committable_age;
 	uint64_t		 dt_agg_gen;
 	uint32_t		 dt_batched_ult_cnt;
 };
@@ -190,6 +241,83 @@ extern struct crt_proto_format dtx_proto_fmt;
 extern btr_ops_t dbtree_dtx_cf_ops;
 extern btr_ops_t dtx_btr_cos_ops;
 
+/*
+ * Adjust the DTX batched commit thresholds according to the target load:
+ *
+ * 1. If some readers have been blocked by committable DTXs (DTX refresh), then
+ *    commit them as soon as possible, but not for more than DTX_REFRESH_EAGER_MAX
+ *    consecutive rounds.
+ * 2. If the target is saturated, batch more DTX entries per round to reduce the
+ *    count of DTX commit RPCs that compete with the foreground I/O.
+ * 3. If the target is idle, commit sooner to avoid subsequent readers blocked.
+ *
+ * \param[in] refresh_cnt	Readers blocked by committable DTXs since last round.
+ * \param[in] eager_rounds	Consecutive eager rounds before this one.
+ * \param[in] active		Active object RPCs on the target.
+ *
+ * \return			True if this round is an eager one.
+ */
+static inline bool
+dtx_batched_commit_thd(uint32_t refresh_cnt, uint32_t eager_rounds, uint64_t active,
+		       uint32_t *cnt_thd, uint32_t *age_thd, uint32_t *batch)
+{
+	*cnt_thd = DTX_THRESHOLD_COUNT;
+	*age_thd = DTX_COMMIT_THRESHOLD_AGE;
+	*batch = DTX_THRESHOLD_COUNT;
+
+	if (refresh_cnt > 0 && eager_rounds < DTX_REFRESH_EAGER_MAX) {
+		*cnt_thd = 0;
+		*age_thd = 0;
+		return true;
+	}
+
+	if (active >= DTX_BATCHED_BUSY_THD) {
+		*cnt_thd = DTX_THRESHOLD_COUNT << 1;
+		*batch = DTX_THRESHOLD_COUNT_MAX;
+	} else if (active == 0) {
+		*age_thd = DTX_COMMIT_THRESHOLD_AGE_IDLE;
+	}
+
+	return false;
+}
+
+static inline bool
+dtx_batched_commit_needed(struct dtx_stat *stat, uint32_t cnt_thd, uint32_t age_thd)
+{
+	if (stat->dtx_committable_count > cnt_thd)
+		return true;
+
+	return stat->dtx_oldest_committable_time != 0 &&
+	       d_hlc_age2sec(stat->dtx_oldest_committable_time) >= age_thd;
+}
+
+/*
+ * Split the DTXs (classified for one rank/tag) into per-container segments for
+ * the coalesced DTX_COMMIT RPC. @co_idx[i] is the container index of the i-th
+ * DTX. Adjacent DTXs of the same container are merged into one segment.
+ *
+ * \param[out] seg_idx	Container index of each segment, at least @count slots.
+ * \param[out] seg_cnt	DTXs count of each segment, at least @count slots.
+ *
+ * \return		The count of segments.
+ */
+static inline int
+dtx_coalesce_segs(const uint32_t *co_idx, int count, uint32_t *seg_idx, uint32_t *seg_cnt)
+{
+	int	nr = 0;
+	int	i;
+
+	for (i = 0; i < count; i++) {
+		if (i == 0 || co_idx[i] != co_idx[i - 1]) {
+			seg_idx[nr] = co_idx[i];
+			seg_cnt[nr++] = 0;
+		}
+		seg_cnt[nr - 1]++;
+	}
+
+	return nr;
+}
+
 /* dtx_common.c */
 int dtx_handle_reinit(struct dtx_handle *dth);
 void dtx_batched_commit(void *arg);
@@ -211,6 +339,8 @@ uint64_t dtx_cos_oldest(struct ds_cont_child *cont);
 /* dtx_rpc.c */
 int dtx_commit(struct ds_cont_child *cont, struct dtx_entry **dtes,
 	       struct dtx_cos_key *dcks, int count);
+int dtx_commit_coalesced(struct ds_cont_child **conts, uint32_t *cnts, int cont_nr,
+			 struct dtx_entry **dtes, struct dtx_cos_key *dcks);
 int dtx_check(struct ds_cont_child *cont, struct dtx_entry *dte,
 	      daos_epoch_t epoch);
 
@@ -54,6 +54,8 @@ struct dtx_req_args {
 	uuid_t				 dra_po_uuid;
 	/* container UUID */
 	uuid_t				 dra_co_uuid;
+	/* The containers for DTX_COMMIT coalesced across containers, or NULL. */
+	struct ds_cont_child		**dra_conts;
 	/* The count of sub requests. */
 	int				 dra_length;
 	/* The collective RPC result. */
@@ -83,6 +85,11 @@ struct dtx_req_rec {
 	struct dtx_id			*drr_dti; /* The DTX array */
 	uint32_t			*drr_flags;
 	struct dtx_share_peer		**drr_cb_args; /* Used by dtx_req_cb. */
+	/* The container index (in dra_conts) for each DTX, coalesced commit only. */
+	uint32_t			*drr_co_idx;
+	/* The per-container segments sent via the coalesced DTX_COMMIT RPC. */
+	uuid_t				*drr_co_uuids;
+	uint32_t			*drr_co_cnts;
 };
 
 struct dtx_cf_rec_bundle {
@@ -103,6 +110,8 @@ struct dtx_cf_rec_bundle {
 	 * the dtx_req_rec::drr_dti array size when allocating it.
 	 */
 	int				 dcrb_count;
+	/* The container index of current DTX, -1 if not coalesced. */
+	int				 dcrb_co_idx;
 };
 
 /* Make sure that the "dcrb_key" is consisted of "dcrb_rank" + "dcrb_tag". */
@@ -124,6 +133,9 @@ dtx_drr_cleanup(struct dtx_req_rec *drr)
 	}
 	D_FREE(drr->drr_dti);
 	D_FREE(drr->drr_flags);
+	D_FREE(drr->drr_co_idx);
+	D_FREE(drr->drr_co_uuids);
+	D_FREE(drr->drr_co_cnts);
 	D_FREE(drr);
 }
 
@@ -220,6 +232,48 @@ out:
 		din != NULL ? din->di_epoch : 0, drr->drr_result);
 }
 
+/* Group the DTXs in @drr by container for the coalesced DTX_COMMIT RPC. */
+static int
+dtx_req_co_segs(struct dtx_req_rec *drr, struct dtx_in *din)
+{
+	struct ds_cont_child	**conts = drr->drr_parent->dra_conts;
+	uint32_t		 *seg_idx;
+	int			  nr;
+	int			  i;
+
+	D_ALLOC_ARRAY(seg_idx, drr->drr_count);
+	D_ALLOC_ARRAY(drr->drr_co_cnts, drr->drr_count);
+	if (seg_idx == NULL || drr->drr_co_cnts == NULL) {
+		D_FREE(seg_idx);
+		return -DER_NOMEM;
+	}
+
+	nr = dtx_coalesce_segs(drr->drr_co_idx, drr->drr_count, seg_idx, drr->drr_co_cnts);
+	uuid_copy(din->di_co_uuid, conts[seg_idx[0]]->sc_uuid);
+
+	/* All the DTXs belong to the same container, send it as the regular one. */
+	if (nr == 1)
+		goto out;
+
+	D_ALLOC_ARRAY(drr->drr_co_uuids, nr);
+	if (drr->drr_co_uuids == NULL) {
+		D_FREE(seg_idx);
+		return -DER_NOMEM;
+	}
+
+	for (i = 0; i < nr; i++)
+		uuid_copy(drr->drr_co_uuids[i], conts[seg_idx[i]]->sc_uuid);
+
+	din->di_co_uuids.ca_count = nr;
+	din->di_co_uuids.ca_arrays = drr->drr_co_uuids;
+	din->di_co_cnts.ca_count = nr;
+	din->di_co_cnts.ca_arrays = drr->drr_co_cnts;
+
+out:
+	D_FREE(seg_idx);
+	return 0;
+}
+
 static int
 dtx_req_send(struct dtx_req_rec *drr, daos_epoch_t epoch)
 {
@@ -251,6 +305,19 @@ dtx_req_send(struct dtx_req_rec *drr, daos_epoch_t epoch)
 			din->di_flags.ca_arrays = NULL;
 		}
 
+		din->di_co_uuids.ca_count = 0;
+		din->di_co_uuids.ca_arrays = NULL;
+		din->di_co_cnts.ca_count = 0;
+		din->di_co_cnts.ca_arrays = NULL;
+		if (drr->drr_co_idx != NULL) {
+			rc = dtx_req_co_segs(drr, din);
+			if (rc != 0) {
+				crt_req_decref(req);
+				din = NULL;
+				goto out;
+			}
+		}
+
 		if (dra->dra_opc == DTX_REFRESH) {
 			if (DAOS_FAIL_CHECK(DAOS_DTX_RESYNC_DELAY))
 				rc = crt_req_set_timeout(req, 3);
@@ -267,6 +334,7 @@ dtx_req_send(struct dtx_req_rec *drr, daos_epoch_t epoch)
 		rc = crt_req_send(req, dtx_req_cb, drr);
 	}
 
+out:
 	D_DEBUG(DB_TRACE, "DTX req for opc %x to %d/%d (req %p future %p) sent "
 		"epoch "DF_X64" : rc %d.\n", dra->dra_opc, drr->drr_rank,
 		drr->drr_tag, req, dra->dra_future,
@@ -373,6 +441,9 @@ struct dtx_common_args {
 	d_rank_t		  dca_rank;
 	uint32_t		  dca_tgtid;
 	struct ds_cont_child	 *dca_cont;
+	/* The DTXs count of each container for the coalesced DTX_COMMIT. */
+	uint32_t		 *dca_cnts;
+	int			  dca_cont_nr;
 	ABT_thread		  dca_helper;
 	struct dtx_id		  dca_dti_inline;
 	struct dtx_id		 *dca_dtis;
@@ -446,6 +517,15 @@ dtx_cf_rec_alloc(struct btr_instance *tins, d_iov_t *key_iov,
 		return -DER_NOMEM;
 	}
 
+	if (dcrb->dcrb_co_idx >= 0) {
+		D_ALLOC_ARRAY(drr->drr_co_idx, dcrb->dcrb_count);
+		if (drr->drr_co_idx == NULL) {
+			dtx_drr_cleanup(drr);
+			return -DER_NOMEM;
+		}
+		drr->drr_co_idx[0] = dcrb->dcrb_co_idx;
+	}
+
 	drr->drr_rank = dcrb->dcrb_rank;
 	drr->drr_tag = dcrb->dcrb_tag;
 	drr->drr_count = 1;
@@ -495,6 +575,8 @@ dtx_cf_rec_update(struct btr_instance *tins, struct btr_record *rec,
 			    dcrb->dcrb_dti)) {
 		D_ASSERT(drr->drr_count < dcrb->dcrb_count);
 
+		if (drr->drr_co_idx != NULL)
+			drr->drr_co_idx[drr->drr_count] = dcrb->dcrb_co_idx;
 		drr->drr_dti[drr->drr_count++] = *dcrb->dcrb_dti;
 	}
 
@@ -512,7 +594,7 @@ btr_ops_t dbtree_dtx_cf_ops = {
 
 static int
 dtx_classify_one(struct ds_pool *pool, daos_handle_t tree, d_list_t *head, int *length,
-		 struct dtx_entry *dte, int count, d_rank_t my_rank, uint32_t my_tgtid)
+		 struct dtx_entry *dte, int count, int co_idx, d_rank_t my_rank, uint32_t my_tgtid)
 {
 	struct dtx_memberships		*mbs = dte->dte_mbs;
 	struct pool_target		*target;
@@ -528,6 +610,10 @@ dtx_classify_one(struct ds_pool *pool, daos_handle_t tree, d_list_t *head, int *
 		dcrb.dcrb_dti = &dte->dte_xid;
 		dcrb.dcrb_head = head;
 		dcrb.dcrb_length = length;
+		dcrb.dcrb_co_idx = co_idx;
+	} else {
+		/* The coalesced commit always has more than one DTX. */
+		D_ASSERT(co_idx < 0);
 	}
 
 	if (mbs->dm_flags & DMF_CONTAIN_LEADER)
@@ -604,6 +690,8 @@ dtx_rpc_internal(struct dtx_common_args *dca)
 {
 	struct ds_pool		*pool = dca->dca_cont->sc_pool->spc_pool;
 	struct umem_attr	 uma = { 0 };
+	uint32_t		 end = 0;
+	int			 co_idx = -1;
 	int			 length = 0;
 	int			 rc;
 	int			 i;
@@ -621,8 +709,12 @@ dtx_rpc_internal(struct dtx_common_args *dca)
 
 		ABT_rwlock_rdlock(pool->sp_lock);
 		for (i = 0; i < dca->dca_count; i++) {
+			/* The DTXs are ordered by container for the coalesced commit. */
+			while (dca->dca_cont_nr > 1 && i >= end)
+				end += dca->dca_cnts[++co_idx];
+
 			rc = dtx_classify_one(pool, dca->dca_tree_hdl, &dca->dca_head, &length,
-					      dca->dca_dtes[i], dca->dca_count,
+					      dca->dca_dtes[i], dca->dca_count, co_idx,
 					      dca->dca_rank, dca->dca_tgtid);
 			if (rc < 0) {
 				ABT_rwlock_unlock(pool->sp_lock);
@@ -662,11 +754,18 @@ dtx_rpc_helper(void *arg)
 		 "DTX helper ULT for %u exit: %d\n", dca->dca_dra.dra_opc, rc);
 }
 
+/*
+ * Prepare and send the DTX RPCs. For DTX_COMMIT, the DTXs may belong to @cont_nr
+ * containers of the same pool: the first @cnts[0] DTXs in @dtes belong to @conts[0],
+ * and so on. Then the DTXs for the same rank/tag are sent via single RPC.
+ */
 static int
-dtx_rpc_prep(struct ds_cont_child *cont,d_list_t *dti_list,  struct dtx_entry **dtes,
-	     uint32_t count, int opc, daos_epoch_t epoch, d_list_t *cmt_list,
-	     d_list_t *abt_list, d_list_t *act_list, struct dtx_common_args *dca)
+dtx_rpc_prep_coalesced(struct ds_cont_child **conts, uint32_t *cnts, int cont_nr,
+		       d_list_t *dti_list, struct dtx_entry **dtes, uint32_t count, int opc,
+		       daos_epoch_t epoch, d_list_t *cmt_list, d_list_t *abt_list,
+		       d_list_t *act_list, struct dtx_common_args *dca)
 {
+	struct ds_cont_child	*cont = conts[0];
 	struct dtx_req_args	*dra;
 	int			 rc = 0;
 
@@ -691,6 +790,14 @@ dtx_rpc_prep(struct ds_cont_child *cont,d_list_t *dti_list,  struct dtx_entry **
 	uuid_copy(dra->dra_po_uuid, cont->sc_pool->spc_pool->sp_uuid);
 	uuid_copy(dra->dra_co_uuid, cont->sc_uuid);
 
+	if (cont_nr > 1) {
+		D_ASSERT(opc == DTX_COMMIT);
+
+		dca->dca_cnts = cnts;
+		dca->dca_cont_nr = cont_nr;
+		dra->dra_conts = conts;
+	}
+
 	if (dti_list != NULL) {
 		d_list_splice(dti_list, &dca->dca_head);
 		D_INIT_LIST_HEAD(dti_list);
@@ -715,6 +822,15 @@ out:
 	return rc;
 }
 
+static int
+dtx_rpc_prep(struct ds_cont_child *cont,d_list_t *dti_list,  struct dtx_entry **dtes,
+	     uint32_t count, int opc, daos_epoch_t epoch, d_list_t *cmt_list,
+	     d_list_t *abt_list, d_list_t *act_list, struct dtx_common_args *dca)
+{
+	return dtx_rpc_prep_coalesced(&cont, NULL, 1, dti_list, dtes, count, opc, epoch,
+				      cmt_list, abt_list, act_list, dca);
+}
+
 static int
 dtx_rpc_post(struct dtx_common_args *dca, int ret, bool keep_head)
 {
@@ -746,6 +862,11 @@ dtx_rpc_post(struct dtx_common_args *dca, int ret, bool keep_head)
  * then they can be sent to remote server via single DTX_COMMIT RPC and then
  * be committed by remote server via single PMDK transaction.
  *
+ * The DTXs may belong to @cont_nr containers of the same pool, the first
+ * @cnts[0] entries in @dtes (and @dcks) belong to @conts[0], and so on. The
+ * DTXs of different containers for the same server are coalesced into single
+ * DTX_COMMIT RPC.
+ *
  * After the DTX classification, send DTX_COMMIT RPC to related servers, and
  * then call DTX commit locally. For a DTX, it is possible that some targets
  * have committed successfully, but others failed. That is no matter. As long
@@ -753,18 +874,28 @@ dtx_rpc_post(struct dtx_common_args *dca, int ret, bool keep_head)
  * targets when dtx_resync() is triggered next time.
  */
 int
-dtx_commit(struct ds_cont_child *cont, struct dtx_entry **dtes,
-	   struct dtx_cos_key *dcks, int count)
+dtx_commit_coalesced(struct ds_cont_child **conts, uint32_t *cnts, int cont_nr,
+		     struct dtx_entry **dtes, struct dtx_cos_key *dcks)
 {
 	struct dtx_common_args	 dca;
 	struct dtx_req_args	*dra = &dca.dca_dra;
+	struct ds_cont_child	*cont;
+	struct dtx_id		*dtis;
 	bool			*rm_cos = NULL;
 	bool			 cos = false;
+	uint32_t		 count = 0;
+	uint32_t		 off;
 	int			 rc;
 	int			 rc1 = 0;
+	int			 rc2;
 	int			 i;
+	int			 j;
 
-	rc = dtx_rpc_prep(cont, NULL, dtes, count, DTX_COMMIT, 0, NULL, NULL, NULL, &dca);
+	for (i = 0; i < cont_nr; i++)
+		count += cnts[i];
+
+	rc = dtx_rpc_prep_coalesced(conts, cnts, cont_nr, NULL, dtes, count, DTX_COMMIT, 0,
+				    NULL, NULL, NULL, &dca);
 
 	/*
 	 * NOTE: Before committing the DTX on remote participants, we cannot remove the active
@@ -781,64 +912,90 @@ dtx_commit(struct ds_cont_child *cont, struct dtx_entry **dtes,
 	if (rc > 0 || rc == -DER_NONEXIST || rc == -DER_EXCLUDED)
 		rc = 0;
 
-	if (rc != 0) {
-		/*
-		 * Some DTX entries may have been committed on some participants. Then mark all
-		 * the DTX entries (in the dtis) as "PARTIAL_COMMITTED" and re-commit them later.
-		 * It is harmless to re-commit the DTX that has ever been committed.
-		 */
-		if (dra->dra_committed > 0)
-			rc1 = vos_dtx_set_flags(cont->sc_hdl, dca.dca_dtis, count,
-						DTE_PARTIAL_COMMITTED);
-	} else {
-		if (dcks != NULL) {
-			if (count > 1) {
-				D_ALLOC_ARRAY(rm_cos, count);
-				if (rm_cos == NULL)
-					D_GOTO(out, rc1 = -DER_NOMEM);
-			} else {
-				rm_cos = &cos;
+	if (rc == 0 && dcks != NULL) {
+		if (count > 1) {
+			D_ALLOC_ARRAY(rm_cos, count);
+			if (rm_cos == NULL)
+				D_GOTO(out, rc1 = -DER_NOMEM);
+		} else {
+			rm_cos = &cos;
+		}
+	}
+
+	for (i = 0, off = 0; i < cont_nr; off += cnts[i++]) {
+		if (cnts[i] == 0)
+			continue;
+
+		cont = conts[i];
+		dtis = dca.dca_dtis + off;
+
+		if (rc != 0) {
+			/*
+			 * Some DTX entries may have been committed on some participants. Then
+			 * mark all the DTX entries (in the dtis) as "PARTIAL_COMMITTED" and
+			 * re-commit them later. It is harmless to re-commit the DTX that has
+			 * ever been committed.
+			 */
+			if (dra->dra_committed > 0) {
+				rc2 = vos_dtx_set_flags(cont->sc_hdl, dtis, cnts[i],
+							DTE_PARTIAL_COMMITTED);
+				if (rc1 == 0)
+					rc1 = rc2;
 			}
+			continue;
 		}
 
-		rc1 = vos_dtx_commit(cont->sc_hdl, dca.dca_dtis, count, rm_cos);
-		if (rc1 > 0) {
-			dra->dra_committed += rc1;
-			rc1 = 0;
-		} else if (rc1 == -DER_NONEXIST) {
+		rc2 = vos_dtx_commit(cont->sc_hdl, dtis, cnts[i],
+				     rm_cos != NULL ? rm_cos + off : NULL);
+		if (rc2 > 0) {
+			dra->dra_committed += rc2;
+			rc2 = 0;
+		} else if (rc2 == -DER_NONEXIST) {
 			/* -DER_NONEXIST may be caused by race or repeated commit, ignore it. */
-			rc1 = 0;
+			rc2 = 0;
 		}
 
-		if (rc1 == 0 && rm_cos != NULL) {
-			for (i = 0; i < count; i++) {
-				if (rm_cos[i]) {
-					D_ASSERT(!daos_oid_is_null(dcks[i].oid.id_pub));
-					dtx_del_cos(cont, &dca.dca_dtis[i], &dcks[i].oid,
-						    dcks[i].dkey_hash);
+		if (rc2 == 0 && rm_cos != NULL) {
+			for (j = off; j < off + cnts[i]; j++) {
+				if (rm_cos[j]) {
+					D_ASSERT(!daos_oid_is_null(dcks[j].oid.id_pub));
+					dtx_del_cos(cont, &dca.dca_dtis[j], &dcks[j].oid,
+						    dcks[j].dkey_hash);
 				}
 			}
 		}
 
-		if (rm_cos != &cos)
-			D_FREE(rm_cos);
+		if (rc1 == 0)
+			rc1 = rc2;
 	}
 
+	if (rm_cos != &cos)
+		D_FREE(rm_cos);
+
 out:
 	if (dca.dca_dtis != &dca.dca_dti_inline)
 		D_FREE(dca.dca_dtis);
 
 	if (rc != 0 || rc1 != 0)
-		D_ERROR("Failed to commit DTX entries "DF_DTI", count %d, %s committed: %d %d\n",
-			DP_DTI(&dtes[0]->dte_xid), count,
+		D_ERROR("Failed to commit DTX entries "DF_DTI", count %u, containers %d, "
+			"%s committed: %d %d\n", DP_DTI(&dtes[0]->dte_xid), count, cont_nr,
 			dra->dra_committed > 0 ? "partial" : "nothing", rc, rc1);
 	else
-		D_DEBUG(DB_IO, "Commit DTXs " DF_DTI", count %d\n",
-			DP_DTI(&dtes[0]->dte_xid), count);
+		D_DEBUG(DB_IO, "Commit DTXs " DF_DTI", count %u, containers %d\n",
+			DP_DTI(&dtes[0]->dte_xid), count, cont_nr);
 
 	return rc != 0 ? rc : rc1;
 }
 
+int
+dtx_commit(struct ds_cont_child *cont, struct dtx_entry **dtes,
+	   struct dtx_cos_key *dcks, int count)
+{
+	uint32_t	cnt = count;
+
+	return dtx_commit_coalesced(&cont, &cnt, 1, dtes, dcks);
+}
+
 
 int
 dtx_abort(struct ds_cont_child *cont, struct dtx_entry *dte, daos_epoch_t epoch)
@@ -1170,6 +1327,11 @@ next2:
 			struct dtx_entry	*pdte = &dte;
 			struct dtx_cos_key	 dck;
 
+			/* The reader is blocked by the committable DTX whose leader is current
+			 * target, it is resolved without DTX_REFRESH RPC, count it here.
+			 */
+			cont->sc_dtx_refresh_cnt++;
+
 			dck.oid = dsp->dsp_oid;
 			dck.dkey_hash = dsp->dsp_dkey_hash;
 			rc = dtx_commit(cont, &pdte, &dck, 1);
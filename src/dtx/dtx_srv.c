@@ -21,6 +21,7 @@ static void *
 dtx_tls_init(int tags, int xs_id, int tgt_id)
 {
 	struct dtx_tls  *tls;
+	char             path[D_TM_MAX_NAME_LEN];
 	int              rc;
 
 	D_ALLOC_PTR(tls);
@@ -55,6 +56,25 @@ dtx_tls_init(int tags, int xs_id, int tgt_id)
 		D_WARN("Failed to create DTX entry metric: " DF_RC"\n",
 		       DP_RC(rc));
 
+	snprintf(path, sizeof(path), "io/dtx/batched_size/tgt_%u", tgt_id);
+	rc = d_tm_add_metric(&tls->dt_batched_size, D_TM_STATS_GAUGE,
+			     "DTX entries count per batched commit", "entries", "%s", path);
+	if (rc == DER_SUCCESS)
+		rc = d_tm_init_histogram(tls->dt_batched_size, path, 10, 4, 2);
+	if (rc != DER_SUCCESS)
+		D_WARN("Failed to create DTX batched size metric: " DF_RC"\n",
+		       DP_RC(rc));
+
+	snprintf(path, sizeof(path), "io/dtx/committable_age/tgt_%u", tgt_id);
+	rc = d_tm_add_metric(&tls->dt_committable_age, D_TM_STATS_GAUGE,
+			     "age of the oldest committable DTX on batched commit", "s",
+			     "%s", path);
+	if (rc == DER_SUCCESS)
+		rc = d_tm_init_histogram(tls->dt_committable_age, path, 6, 1, 2);
+	if (rc != DER_SUCCESS)
+		D_WARN("Failed to create DTX committable age metric: " DF_RC"\n",
+		       DP_RC(rc));
+
 	return tls;
 }
 
@@ -143,6 +163,78 @@ struct dss_module_metrics dtx_metrics = {
 	.dmm_nr_metrics = dtx_metrics_count,
 };
 
+static int
+dtx_commit_local(struct ds_cont_child *cont, struct dtx_id *dtis, int total,
+		 uint32_t *committed)
+{
+	int	count = DTX_YIELD_CYCLE;
+	int	i = 0;
+	int	rc = 0;
+	int	rc1;
+
+	while (i < total) {
+		if (i + count > total)
+			count = total - i;
+
+		rc1 = vos_dtx_commit(cont->sc_hdl, dtis + i, count, NULL);
+		if (rc1 > 0)
+			*committed += rc1;
+		else if (rc == 0 && rc1 < 0)
+			rc = rc1;
+
+		i += count;
+	}
+
+	return rc;
+}
+
+/* Commit the DTXs coalesced from multiple containers, see DAOS_ISEQ_DTX. */
+static int
+dtx_commit_coalesced_local(struct dtx_in *din, struct ds_cont_child *cont, uint32_t *committed)
+{
+	struct ds_cont_child	*tmp;
+	struct dtx_id		*dtis = din->di_dtx_array.ca_arrays;
+	uuid_t			*uuids = din->di_co_uuids.ca_arrays;
+	uint32_t		*cnts = din->di_co_cnts.ca_arrays;
+	uint64_t		 total = 0;
+	int			 rc = 0;
+	int			 rc1;
+	int			 i;
+
+	if (din->di_co_uuids.ca_count != din->di_co_cnts.ca_count)
+		return -DER_PROTO;
+
+	for (i = 0; i < din->di_co_cnts.ca_count; i++)
+		total += cnts[i];
+	if (total != din->di_dtx_array.ca_count)
+		return -DER_PROTO;
+
+	for (i = 0; i < din->di_co_cnts.ca_count; dtis += cnts[i++]) {
+		if (uuid_compare(uuids[i], cont->sc_uuid) == 0) {
+			tmp = cont;
+		} else {
+			rc1 = ds_cont_child_lookup(din->di_po_uuid, uuids[i], &tmp);
+			if (rc1 != 0) {
+				D_ERROR("Failed to locate pool="DF_UUID" cont="DF_UUID
+					" for coalesced DTX commit: "DF_RC"\n",
+					DP_UUID(din->di_po_uuid), DP_UUID(uuids[i]), DP_RC(rc1));
+				if (rc == 0)
+					rc = rc1;
+				continue;
+			}
+		}
+
+		rc1 = dtx_commit_local(tmp, dtis, cnts[i], committed);
+		if (rc == 0 && rc1 < 0)
+			rc = rc1;
+
+		if (tmp != cont)
+			ds_cont_child_put(tmp);
+	}
+
+	return rc;
+}
+
 static void
 dtx_handler(crt_rpc_t *rpc)
 {
@@ -158,7 +250,7 @@ dtx_handler(crt_rpc_t *rpc)
 	uint32_t		 committed = 0;
 	uint32_t		*flags;
 	int			*ptr;
-	int			 count = DTX_YIELD_CYCLE;
+	int			 count = 0;
 	int			 i = 0;
 	int			 rc1 = 0;
 	int			 rc;
@@ -185,19 +277,11 @@ dtx_handler(crt_rpc_t *rpc)
 		if (unlikely(din->di_epoch == 1))
 			D_GOTO(out, rc = -DER_IO);
 
-		while (i < din->di_dtx_array.ca_count) {
-			if (i + count > din->di_dtx_array.ca_count)
-				count = din->di_dtx_array.ca_count - i;
-
-			dtis = (struct dtx_id *)din->di_dtx_array.ca_arrays + i;
-			rc1 = vos_dtx_commit(cont->sc_hdl, dtis, count, NULL);
-			if (rc1 > 0)
-				committed += rc1;
-			else if (rc == 0 && rc1 < 0)
-				rc = rc1;
-
-			i += count;
-		}
+		if (din->di_co_cnts.ca_count == 0)
+			rc = dtx_commit_local(cont, din->di_dtx_array.ca_arrays,
+					      din->di_dtx_array.ca_count, &committed);
+		else
+			rc = dtx_commit_coalesced_local(din, cont, &committed);
 
 		d_tm_inc_counter(dpm->dpm_batched_total,
 				 din->di_dtx_array.ca_count);
@@ -306,6 +390,13 @@ dtx_handler(crt_rpc_t *rpc)
 				*ptr = DTX_ST_PREPARED;
 			}
 
+			/* Someone is blocked by the committable DTX, hint the batched
+			 * commit to commit it sooner. The prepared one cannot be sped
+			 * up by the batched commit, do not count it.
+			 */
+			if (*ptr == DTX_ST_COMMITTABLE)
+				cont->sc_dtx_refresh_cnt++;
+
 			if (mbs[i] != NULL)
 				rc1++;
 		}
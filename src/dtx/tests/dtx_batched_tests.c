@@ -0,0 +1,175 @@
+/**
+ * (C) Copyright 2023 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+/**
+ * Unit tests for the DTX batched commit: the load adaptive thresholds and the
+ * per-container segments of the DTX_COMMIT RPC coalesced across containers.
+ *
+ * dtx/tests/dtx_batched_tests.c
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <daos/tests_lib.h>
+#include <daos_srv/container.h>
+#include <daos_srv/dtx_srv.h>
+#include "../dtx_internal.h"
+
+/* Regular thresholds when the target is neither idle nor saturated. */
+static void
+batched_thd_regular(void **state)
+{
+	uint32_t	cnt_thd;
+	uint32_t	age_thd;
+	uint32_t	batch;
+
+	assert_false(dtx_batched_commit_thd(0, 0, 1, &cnt_thd, &age_thd, &batch));
+	assert_int_equal(cnt_thd, DTX_THRESHOLD_COUNT);
+	assert_int_equal(age_thd, DTX_COMMIT_THRESHOLD_AGE);
+	assert_int_equal(batch, DTX_THRESHOLD_COUNT);
+
+	assert_false(dtx_batched_commit_thd(0, 0, DTX_BATCHED_BUSY_THD - 1,
+					    &cnt_thd, &age_thd, &batch));
+	assert_int_equal(cnt_thd, DTX_THRESHOLD_COUNT);
+	assert_int_equal(batch, DTX_THRESHOLD_COUNT);
+}
+
+/* Idle target commits the old committable DTXs sooner. */
+static void
+batched_thd_idle(void **state)
+{
+	uint32_t	cnt_thd;
+	uint32_t	age_thd;
+	uint32_t	batch;
+
+	assert_false(dtx_batched_commit_thd(0, 0, 0, &cnt_thd, &age_thd, &batch));
+	assert_int_equal(cnt_thd, DTX_THRESHOLD_COUNT);
+	assert_int_equal(age_thd, DTX_COMMIT_THRESHOLD_AGE_IDLE);
+	assert_int_equal(batch, DTX_THRESHOLD_COUNT);
+}
+
+/* Saturated target batches more DTXs per round. */
+static void
+batched_thd_busy(void **state)
+{
+	uint32_t	cnt_thd;
+	uint32_t	age_thd;
+	uint32_t	batch;
+
+	assert_false(dtx_batched_commit_thd(0, 0, DTX_BATCHED_BUSY_THD,
+					    &cnt_thd, &age_thd, &batch));
+	assert_int_equal(cnt_thd, DTX_THRESHOLD_COUNT << 1);
+	assert_int_equal(age_thd, DTX_COMMIT_THRESHOLD_AGE);
+	assert_int_equal(batch, DTX_THRESHOLD_COUNT_MAX);
+}
+
+/* Readers blocked by committable DTXs trigger eager commit, at most
+ * DTX_REFRESH_EAGER_MAX consecutive rounds, even if the target is busy.
+ */
+static void
+batched_thd_refresh(void **state)
+{
+	uint32_t	cnt_thd;
+	uint32_t	age_thd;
+	uint32_t	batch;
+	uint32_t	rounds = 0;
+	int		i;
+
+	for (i = 0; i < DTX_REFRESH_EAGER_MAX; i++) {
+		assert_true(dtx_batched_commit_thd(1, rounds, DTX_BATCHED_BUSY_THD,
+						   &cnt_thd, &age_thd, &batch));
+		assert_int_equal(cnt_thd, 0);
+		assert_int_equal(age_thd, 0);
+		assert_int_equal(batch, DTX_THRESHOLD_COUNT);
+		rounds++;
+	}
+
+	/* Capped, fall back to the busy thresholds. */
+	assert_false(dtx_batched_commit_thd(1, rounds, DTX_BATCHED_BUSY_THD,
+					    &cnt_thd, &age_thd, &batch));
+	assert_int_equal(cnt_thd, DTX_THRESHOLD_COUNT << 1);
+	assert_int_equal(batch, DTX_THRESHOLD_COUNT_MAX);
+
+	/* The caller resets the rounds after a regular one. */
+	assert_true(dtx_batched_commit_thd(1, 0, 0, &cnt_thd, &age_thd, &batch));
+}
+
+static void
+batched_needed(void **state)
+{
+	struct dtx_stat	stat = { 0 };
+	uint32_t	cnt_thd;
+	uint32_t	age_thd;
+	uint32_t	batch;
+
+	/* Nothing committable. */
+	dtx_batched_commit_thd(0, 0, 0, &cnt_thd, &age_thd, &batch);
+	assert_false(dtx_batched_commit_needed(&stat, cnt_thd, age_thd));
+
+	/* Too many committable DTXs. */
+	stat.dtx_committable_count = DTX_THRESHOLD_COUNT + 1;
+	stat.dtx_oldest_committable_time = d_hlc_get();
+	assert_true(dtx_batched_commit_needed(&stat, cnt_thd, age_thd));
+
+	/* Few and young committable DTXs. */
+	stat.dtx_committable_count = 1;
+	assert_false(dtx_batched_commit_needed(&stat, cnt_thd, age_thd));
+
+	/* Old enough for the idle target, but not for the regular one. */
+	stat.dtx_oldest_committable_time = d_hlc_get() -
+					   d_sec2hlc(DTX_COMMIT_THRESHOLD_AGE_IDLE + 1);
+	assert_true(dtx_batched_commit_needed(&stat, cnt_thd, age_thd));
+	dtx_batched_commit_thd(0, 0, 1, &cnt_thd, &age_thd, &batch);
+	assert_false(dtx_batched_commit_needed(&stat, cnt_thd, age_thd));
+
+	/* Eager round commits any committable DTX. */
+	stat.dtx_oldest_committable_time = d_hlc_get();
+	dtx_batched_commit_thd(1, 0, 1, &cnt_thd, &age_thd, &batch);
+	assert_true(dtx_batched_commit_needed(&stat, cnt_thd, age_thd));
+}
+
+static void
+coalesce_segs(void **state)
+{
+	uint32_t	single[] = { 2, 2, 2 };
+	uint32_t	multi[] = { 0, 0, 1, 3, 3, 3, 5 };
+	uint32_t	seg_idx[ARRAY_SIZE(multi)];
+	uint32_t	seg_cnt[ARRAY_SIZE(multi)];
+	int		nr;
+
+	nr = dtx_coalesce_segs(single, ARRAY_SIZE(single), seg_idx, seg_cnt);
+	assert_int_equal(nr, 1);
+	assert_int_equal(seg_idx[0], 2);
+	assert_int_equal(seg_cnt[0], 3);
+
+	nr = dtx_coalesce_segs(multi, ARRAY_SIZE(multi), seg_idx, seg_cnt);
+	assert_int_equal(nr, 4);
+	assert_int_equal(seg_idx[0], 0);
+	assert_int_equal(seg_cnt[0], 2);
+	assert_int_equal(seg_idx[1], 1);
+	assert_int_equal(seg_cnt[1], 1);
+	assert_int_equal(seg_idx[2], 3);
+	assert_int_equal(seg_cnt[2], 3);
+	assert_int_equal(seg_idx[3], 5);
+	assert_int_equal(seg_cnt[3], 1);
+}
+
+static const struct CMUnitTest dtx_batched_tests[] = {
+	cmocka_unit_test(batched_thd_regular),
+	cmocka_unit_test(batched_thd_idle),
+	cmocka_unit_test(batched_thd_busy),
+	cmocka_unit_test(batched_thd_refresh),
+	cmocka_unit_test(batched_needed),
+	cmocka_unit_test(coalesce_segs),
+};
+
+int
+main(int argc, char **argv)
+{
+	return cmocka_run_group_tests_name("DTX batched commit tests", dtx_batched_tests,
+					   NULL, NULL);
+}
@@ -0,0 +1,316 @@
+/**
+ * (C) Copyright 2023 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+/**
+ * Unit tests for the DTX CoS cache: piggyback of committable DTXs on the
+ * dispatched modification RPC and the fallback to explicit DTX commit.
+ *
+ * dtx/tests/dtx_cos_tests.c
+ */
+#define D_LOGFAC	DD_FAC(tests)
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <daos/btree_class.h>
+#include <daos/tests_lib.h>
+#include <daos_srv/container.h>
+#include <daos_srv/dtx_srv.h>
+#include "../dtx_internal.h"
+
+#define DCT_BTREE_ORDER	23
+
+/*
+ * Mocks for the engine TLS that dtx_tls_get() relies on.
+ */
+pthread_key_t			 dss_tls_key;
+struct dss_module_key		*dss_module_keys[DAOS_MODULE_KEYS_NR];
+struct dss_module_key		 dtx_module_key = {
+	.dmk_tags	= DAOS_SERVER_TAG,
+	.dmk_index	= 0,
+};
+
+static struct dtx_tls			 dct_tls;
+static void				*dct_tls_values[DAOS_MODULE_KEYS_NR];
+static struct dss_thread_local_storage	 dct_dtls = {
+	.dtls_values	= dct_tls_values,
+};
+
+void
+dtx_entry_put(struct dtx_entry *dte)
+{
+	if (--(dte->dte_refs) == 0)
+		D_FREE(dte);
+}
+
+/*
+ * Test helpers
+ */
+struct dct_arg {
+	struct ds_cont_child	 da_cont;
+	daos_unit_oid_t		 da_oid;
+	uint64_t		 da_dkey_hash;
+	uint64_t		 da_epoch;
+};
+
+static struct dtx_entry *
+dct_dte_alloc(uint64_t seq)
+{
+	struct dtx_entry	*dte;
+
+	D_ALLOC(dte, sizeof(*dte) + sizeof(struct dtx_memberships));
+	assert_non_null(dte);
+
+	dte->dte_xid.dti_hlc = seq;
+	dte->dte_refs = 1;
+	dte->dte_mbs = (struct dtx_memberships *)(dte + 1);
+
+	return dte;
+}
+
+/* Add @count DTXs with @flags to the CoS, return the first DTX sequence. */
+static uint64_t
+dct_add(struct dct_arg *arg, int count, uint32_t flags)
+{
+	struct dtx_entry	*dte;
+	uint64_t		 first = arg->da_epoch + 1;
+	int			 rc;
+	int			 i;
+
+	for (i = 0; i < count; i++) {
+		dte = dct_dte_alloc(++arg->da_epoch);
+		rc = dtx_add_cos(&arg->da_cont, dte, &arg->da_oid,
+				 arg->da_dkey_hash, arg->da_epoch, flags);
+		assert_rc_equal(rc, 0);
+		/* The CoS holds its own reference. */
+		dtx_entry_put(dte);
+	}
+
+	return first;
+}
+
+static void
+dct_del(struct dct_arg *arg, struct dtx_id *dtis, int count)
+{
+	int	rc;
+	int	i;
+
+	for (i = 0; i < count; i++) {
+		rc = dtx_del_cos(&arg->da_cont, &dtis[i], &arg->da_oid,
+				 arg->da_dkey_hash);
+		assert_rc_equal(rc, 0);
+	}
+}
+
+/*
+ * Tests
+ */
+
+/* Priority DTXs are piggybacked first, regular ones up to the cap. */
+static void
+cos_piggyback_order(void **state)
+{
+	struct dct_arg	*arg = *state;
+	struct dtx_id	*dtis = NULL;
+	uint64_t	 prio;
+	uint64_t	 reg;
+	int		 rc;
+	int		 i;
+
+	reg = dct_add(arg, 4, 0);
+	prio = dct_add(arg, 3, DCF_SHARED);
+	/* Explicit-commit DTXs are never piggybacked. */
+	dct_add(arg, 2, DCF_EXP_CMT);
+
+	rc = dtx_list_cos(&arg->da_cont, &arg->da_oid, arg->da_dkey_hash,
+			  DTX_THRESHOLD_COUNT, &dtis);
+	assert_int_equal(rc, 7);
+
+	for (i = 0; i < 3; i++)
+		assert_int_equal(dtis[i].dti_hlc, prio + i);
+	for (i = 0; i < 4; i++)
+		assert_int_equal(dtis[3 + i].dti_hlc, reg + i);
+
+	D_FREE(dtis);
+}
+
+/* Never more than DTX_PIGGYBACK_REG_MAX regular DTXs per modification. */
+static void
+cos_piggyback_reg_cap(void **state)
+{
+	struct dct_arg	*arg = *state;
+	struct dtx_id	*dtis = NULL;
+	uint64_t	 reg;
+	int		 rc;
+	int		 i;
+
+	reg = dct_add(arg, DTX_PIGGYBACK_REG_MAX * 2 + 5, 0);
+
+	rc = dtx_list_cos(&arg->da_cont, &arg->da_oid, arg->da_dkey_hash,
+			  DTX_THRESHOLD_COUNT, &dtis);
+	assert_int_equal(rc, DTX_PIGGYBACK_REG_MAX);
+	for (i = 0; i < rc; i++)
+		assert_int_equal(dtis[i].dti_hlc, reg + i);
+	D_FREE(dtis);
+
+	/* The caller's @max wins over the cap. */
+	rc = dtx_list_cos(&arg->da_cont, &arg->da_oid, arg->da_dkey_hash,
+			  DTX_PIGGYBACK_REG_MAX / 4, &dtis);
+	assert_int_equal(rc, DTX_PIGGYBACK_REG_MAX / 4);
+	D_FREE(dtis);
+
+	/* Priority DTXs consume the @max budget before the regular ones. */
+	dct_add(arg, DTX_THRESHOLD_COUNT - 2, DCF_SHARED);
+	rc = dtx_list_cos(&arg->da_cont, &arg->da_oid, arg->da_dkey_hash,
+			  DTX_THRESHOLD_COUNT, &dtis);
+	assert_int_equal(rc, DTX_THRESHOLD_COUNT);
+	assert_int_equal(dtis[rc - 1].dti_hlc, reg + 1);
+	D_FREE(dtis);
+}
+
+/*
+ * The regular DTXs beyond the cap stay in the CoS and are committed by the
+ * explicit (batched) DTX commit path instead.
+ */
+static void
+cos_piggyback_fallback(void **state)
+{
+	struct dct_arg		 *arg = *state;
+	struct dtx_id		 *dtis = NULL;
+	struct dtx_entry	**dtes = NULL;
+	struct dtx_cos_key	 *dcks = NULL;
+	int			  total = DTX_PIGGYBACK_REG_MAX + 7;
+	uint64_t		  reg;
+	int			  rc;
+	int			  i;
+
+	reg = dct_add(arg, total, 0);
+	assert_int_equal(arg->da_cont.sc_dtx_committable_count, total);
+
+	/* Simulate the piggybacked DTXs being committed on the shards. */
+	rc = dtx_list_cos(&arg->da_cont, &arg->da_oid, arg->da_dkey_hash,
+			  DTX_THRESHOLD_COUNT, &dtis);
+	assert_int_equal(rc, DTX_PIGGYBACK_REG_MAX);
+	dct_del(arg, dtis, rc);
+	D_FREE(dtis);
+
+	assert_int_equal(arg->da_cont.sc_dtx_committable_count,
+			 total - DTX_PIGGYBACK_REG_MAX);
+
+	rc = dtx_fetch_committable(&arg->da_cont, DTX_THRESHOLD_COUNT, NULL,
+				   DAOS_EPOCH_MAX, &dtes, &dcks);
+	assert_int_equal(rc, total - DTX_PIGGYBACK_REG_MAX);
+	for (i = 0; i < rc; i++) {
+		assert_int_equal(dtes[i]->dte_xid.dti_hlc,
+				 reg + DTX_PIGGYBACK_REG_MAX + i);
+		assert_int_equal(dcks[i].dkey_hash, arg->da_dkey_hash);
+		dtx_entry_put(dtes[i]);
+	}
+	D_FREE(dtes);
+	D_FREE(dcks);
+
+	/* The left ones are piggybacked by the next modification as well. */
+	rc = dtx_list_cos(&arg->da_cont, &arg->da_oid, arg->da_dkey_hash,
+			  DTX_THRESHOLD_COUNT, &dtis);
+	assert_int_equal(rc, total - DTX_PIGGYBACK_REG_MAX);
+	dct_del(arg, dtis, rc);
+	D_FREE(dtis);
+
+	assert_int_equal(arg->da_cont.sc_dtx_committable_count, 0);
+	rc = dtx_list_cos(&arg->da_cont, &arg->da_oid, arg->da_dkey_hash,
+			  DTX_THRESHOLD_COUNT, &dtis);
+	assert_int_equal(rc, 0);
+}
+
+static int
+dct_setup(void **state)
+{
+	struct dct_arg	*arg;
+	struct umem_attr uma = { 0 };
+	int		 rc;
+
+	D_ALLOC_PTR(arg);
+	if (arg == NULL)
+		return -1;
+
+	arg->da_cont.sc_open = 1;
+	D_INIT_LIST_HEAD(&arg->da_cont.sc_dtx_cos_list);
+
+	uma.uma_id = UMEM_CLASS_VMEM;
+	rc = dbtree_create_inplace_ex(DBTREE_CLASS_DTX_COS, 0, DCT_BTREE_ORDER,
+				      &uma, &arg->da_cont.sc_dtx_cos_btr,
+				      DAOS_HDL_INVAL, &arg->da_cont,
+				      &arg->da_cont.sc_dtx_cos_hdl);
+	if (rc != 0) {
+		D_FREE(arg);
+		return -1;
+	}
+
+	arg->da_oid.id_pub.lo = 1;
+	arg->da_dkey_hash = 0x1234;
+	*state = arg;
+
+	return 0;
+}
+
+static int
+dct_teardown(void **state)
+{
+	struct dct_arg	*arg = *state;
+
+	dbtree_destroy(arg->da_cont.sc_dtx_cos_hdl, NULL);
+	D_FREE(arg);
+
+	return 0;
+}
+
+static int
+dct_init(void **state)
+{
+	int	rc;
+
+	rc = daos_debug_init(DAOS_LOG_DEFAULT);
+	if (rc != 0)
+		return rc;
+
+	rc = dbtree_class_register(DBTREE_CLASS_DTX_COS, 0, &dtx_btr_cos_ops);
+	if (rc != 0)
+		return rc;
+
+	rc = pthread_key_create(&dss_tls_key, NULL);
+	if (rc != 0)
+		return rc;
+
+	dss_module_keys[dtx_module_key.dmk_index] = &dtx_module_key;
+	dct_tls_values[dtx_module_key.dmk_index] = &dct_tls;
+
+	return pthread_setspecific(dss_tls_key, &dct_dtls);
+}
+
+static int
+dct_fini(void **state)
+{
+	pthread_key_delete(dss_tls_key);
+	daos_debug_fini();
+
+	return 0;
+}
+
+static const struct CMUnitTest dtx_cos_tests[] = {
+	cmocka_unit_test_setup_teardown(cos_piggyback_order,
+					dct_setup, dct_teardown),
+	cmocka_unit_test_setup_teardown(cos_piggyback_reg_cap,
+					dct_setup, dct_teardown),
+	cmocka_unit_test_setup_teardown(cos_piggyback_fallback,
+					dct_setup, dct_teardown),
+};
+
+int
+main(int argc, char **argv)
+{
+	return cmocka_run_group_tests_name("DTX CoS tests", dtx_cos_tests,
+					   dct_init, dct_fini);
+}
@@ -638,8 +638,10 @@ metrics_region_size(int num_tgts)
 {
 	const uint64_t	est_std_metrics = 1024; /* high estimate to allow for pool links */
 	const uint64_t	est_tgt_metrics = 128; /* high estimate */
+	const uint64_t	est_tgt_hdrs = 9; /* object I/O latency histograms */
 
-	return (est_std_metrics + est_tgt_metrics * num_tgts) * D_TM_METRIC_SIZE;
+	return (est_std_metrics + est_tgt_metrics * num_tgts) * D_TM_METRIC_SIZE +
+	       est_tgt_hdrs * num_tgts * D_TM_HDR_METRIC_SIZE;
 }
 
 static int
@@ -671,6 +673,8 @@ server_init(int argc, char *argv[])
 	rc = d_tm_init(dss_instance_idx, metrics_region_size(dss_tgt_nr), D_TM_SERVER_PROCESS);
 	if (rc != 0)
 		goto exit_debug_init;
+	/* One slot of the sharded metrics per xstream, see dss_srv_handler() */
+	d_tm_set_shards(DSS_XS_NR_TOTAL);
 
 	rc = dss_engine_metrics_init();
 	if (rc != 0)
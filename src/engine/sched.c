@@ -138,11 +138,16 @@ struct sched_pool_info {
 	int			spi_ref;
 	uint32_t		spi_req_cnt;
 	struct stats_window	spi_stats_window;
+	/* Per QoS class IO requests, NULL when QoS isn't enabled */
+	struct sched_qos_info	*spi_qos;
+	/* Virtual time of the last kicked IO request in WFQ */
+	uint64_t		spi_qos_vtime;
 };
 
 struct sched_request {
 	/*
-	 * IO request links to 'sched_info->si_fifo_list', other types of
+	 * IO request links to 'sched_info->si_fifo_list' (or the QoS class list
+	 * 'sched_qos_info->sqi_req_list'), other types of
 	 * request link to each 'sched_req_info->sri_req_list' respectively.
 	 * When request is not used, it's in 'sched_info->si_idle_list'.
 	 */
@@ -156,9 +161,13 @@ struct sched_request {
 	uint64_t		 sr_wakeup_time;
 	/* When the request is enqueued, in msecs */
 	uint64_t		 sr_enqueue_ts;
+	/* QoS class of the IO request */
+	uint32_t		 sr_qos_class;
 	unsigned int		 sr_abort:1,
 				 /* sr_ult is sched_request-owned */
-				 sr_owned:1;
+				 sr_owned:1,
+				 /* Held by the QoS token buckets */
+				 sr_qos_held:1;
 };
 
 bool		sched_prio_disabled;
@@ -166,6 +175,7 @@ unsigned int	sched_relax_intvl = SCHED_RELAX_INTVL_DEFAULT;
 unsigned int	sched_relax_mode;
 unsigned int	sched_unit_runtime_max = 32; /* ms */
 bool		sched_watchdog_all;
+bool		sched_offload_steal;
 
 enum {
 	/* All requests for various pools are processed in FIFO */
@@ -180,11 +190,73 @@ enum {
 	 * Container ID, JobID, UID, etc.)
 	 */
 	SCHED_POLICY_ID_PRIO,
+	/*
+	 * IO requests are classified into QoS classes by container, the classes
+	 * are rate limited by token buckets and share the CPU by WFQ.
+	 */
+	SCHED_POLICY_QOS,
 	SCHED_POLICY_MAX
 };
 
 static int	sched_policy;
 
+/* Max IO requests kicked off for a pool in a cycle, shared by the QoS classes */
+#define SCHED_QOS_KICK_MAX	64
+
+struct sched_qos_info {
+	d_list_t		sqi_req_list;
+	uint32_t		sqi_req_cnt;
+	/* Virtual finish time of the class in WFQ */
+	uint64_t		sqi_vtime;
+	/* Available tokens, in 1/1000 request or byte */
+	int64_t			sqi_iops_tokens;
+	int64_t			sqi_bw_tokens;
+	/* When the tokens were refilled, in msecs */
+	uint64_t		sqi_refill_ts;
+};
+
+/**
+ * Enable the QoS policy with the classes in \a conf, see sched_qos_conf_init().
+ * The per-class metrics of all targets are in their own region, so that the
+ * engine metrics region doesn't depend on the number of classes.
+ */
+static bool	qos_metrics_dir;
+
+int
+sched_qos_init(const char *conf)
+{
+	size_t	size;
+	int	rc;
+
+	rc = sched_qos_conf_init(conf);
+	if (rc)
+		return rc;
+
+	sched_policy = SCHED_POLICY_QOS;
+
+	/* The class and the metric directories, and the per-target metrics */
+	size = (sched_qos_class_nr * (SCHED_QOS_METRIC_NR * (dss_tgt_nr + 1) + 1) + 1) *
+	       D_TM_METRIC_SIZE;
+	rc = d_tm_add_ephemeral_dir(NULL, D_ALIGNUP(size, 8), "sched/qos");
+	if (rc)
+		D_WARN("Failed to create QoS metrics dir: "DF_RC"\n", DP_RC(rc));
+	else
+		qos_metrics_dir = true;
+
+	return 0;
+}
+
+void
+sched_qos_fini(void)
+{
+	if (qos_metrics_dir) {
+		d_tm_del_ephemeral_dir("sched/qos");
+		qos_metrics_dir = false;
+	}
+	sched_policy = SCHED_POLICY_FIFO;
+	sched_qos_conf_fini();
+}
+
 /*
  * Time threshold for giving IO up throttling. If space pressure stays in the
  * highest level for enough long time, we assume that no more space can be
@@ -346,6 +418,14 @@ spi_rec_free(struct d_hash_table *htable, d_list_t *rlink)
 		D_ASSERT(d_list_empty(pool2req_list(spi, type)));
 	}
 
+	if (spi->spi_qos != NULL) {
+		for (type = 0; type < sched_qos_class_nr; type++) {
+			D_ASSERT(spi->spi_qos[type].sqi_req_cnt == 0);
+			D_ASSERT(d_list_empty(&spi->spi_qos[type].sqi_req_list));
+		}
+		D_FREE(spi->spi_qos);
+	}
+
 	D_FREE(spi);
 }
 
@@ -463,6 +543,9 @@ sched_info_fini(struct dss_xstream *dx)
 		d_list_del_init(&req->sr_link);
 		D_FREE(req);
 	}
+
+	sched_offload_queue_fini(&info->si_offload);
+	D_FREE(info->si_qos_stats);
 }
 
 static int
@@ -487,11 +570,19 @@ prealloc_requests(struct sched_info *info, int cnt)
 #define SCHED_PREALLOC_INIT_CNT  8192
 #define SCHED_PREALLOC_BATCH_CNT 1024
 
+/* Helper xstream which may receive offloaded work, see sched_steal_init() */
+static inline bool
+sched_offload_helper(struct dss_xstream *dx)
+{
+	return sched_offload_steal && dx->dx_xs_id >= dss_sys_xs_nr && !dx->dx_main_xs;
+}
+
 static void
 sched_metrics_init(struct dss_xstream *dx)
 {
 	struct sched_info	*info = &dx->dx_sched_info;
 	struct sched_stats	*stats = &info->si_stats;
+	unsigned int		 i;
 	int			 rc;
 
 	stats->ss_busy_ts = info->si_cur_ts;
@@ -527,6 +618,73 @@ sched_metrics_init(struct dss_xstream *dx)
 			     "ULT", "sched/cycle_size/xs_%u", dx->dx_xs_id);
 	if (rc)
 		D_WARN("Failed to create cycle_size telemetry: "DF_RC"\n", DP_RC(rc));
+
+	if (sched_offload_helper(dx)) {
+		rc = d_tm_add_metric(&stats->ss_offload_depth, D_TM_GAUGE,
+				     "Offload queue depth", "ULT",
+				     "sched/offload/depth/xs_%u", dx->dx_xs_id);
+		if (rc)
+			D_WARN("Failed to create offload depth telemetry: "DF_RC"\n", DP_RC(rc));
+
+		rc = d_tm_add_metric(&stats->ss_offload_steals, D_TM_COUNTER,
+				     "Offloaded work stolen by the xstream", "ULT",
+				     "sched/offload/steals/xs_%u", dx->dx_xs_id);
+		if (rc)
+			D_WARN("Failed to create offload steals telemetry: "DF_RC"\n", DP_RC(rc));
+
+		rc = d_tm_add_metric(&stats->ss_offload_stolen, D_TM_COUNTER,
+				     "Offloaded work stolen from the xstream", "ULT",
+				     "sched/offload/stolen/xs_%u", dx->dx_xs_id);
+		if (rc)
+			D_WARN("Failed to create offload stolen telemetry: "DF_RC"\n", DP_RC(rc));
+	}
+
+	/* IO requests are only queued on VOS xstreams */
+	if (sched_qos_class_nr == 0 || !dx->dx_main_xs)
+		return;
+
+	D_ALLOC_ARRAY(info->si_qos_stats, sched_qos_class_nr);
+	if (info->si_qos_stats == NULL) {
+		D_WARN("Failed to allocate QoS stats\n");
+		return;
+	}
+
+	for (i = 0; i < sched_qos_class_nr; i++) {
+		struct sched_qos_stats	*sqs = &info->si_qos_stats[i];
+		const char		*label = sched_qos_confs[i].sqc_label;
+
+		rc = d_tm_add_metric(&sqs->sqs_kicked, D_TM_COUNTER, "Kicked IO requests", "req",
+				     "sched/qos/%s/kicked/xs_%u", label, dx->dx_xs_id);
+		if (rc)
+			D_WARN("Failed to create qos kicked telemetry: "DF_RC"\n", DP_RC(rc));
+
+		rc = d_tm_add_metric(&sqs->sqs_bytes, D_TM_COUNTER, "Kicked IO bytes", "bytes",
+				     "sched/qos/%s/bytes/xs_%u", label, dx->dx_xs_id);
+		if (rc)
+			D_WARN("Failed to create qos bytes telemetry: "DF_RC"\n", DP_RC(rc));
+
+		rc = d_tm_add_metric(&sqs->sqs_throttled, D_TM_COUNTER,
+				     "IO requests delayed by rate limits", "req",
+				     "sched/qos/%s/throttled/xs_%u", label, dx->dx_xs_id);
+		if (rc)
+			D_WARN("Failed to create qos throttled telemetry: "DF_RC"\n", DP_RC(rc));
+
+		rc = d_tm_add_metric(&sqs->sqs_queued, D_TM_GAUGE, "Queued IO requests", "req",
+				     "sched/qos/%s/queued/xs_%u", label, dx->dx_xs_id);
+		if (rc)
+			D_WARN("Failed to create qos queued telemetry: "DF_RC"\n", DP_RC(rc));
+
+		rc = d_tm_add_metric(&sqs->sqs_wait, D_TM_STATS_GAUGE, "IO request queue wait",
+				     "ms", "sched/qos/%s/queue_wait/xs_%u", label, dx->dx_xs_id);
+		if (rc)
+			D_WARN("Failed to create qos queue_wait telemetry: "DF_RC"\n", DP_RC(rc));
+
+		rc = d_tm_add_metric(&sqs->sqs_lat_miss, D_TM_COUNTER,
+				     "IO requests missed the latency target", "req",
+				     "sched/qos/%s/lat_miss/xs_%u", label, dx->dx_xs_id);
+		if (rc)
+			D_WARN("Failed to create qos lat_miss telemetry: "DF_RC"\n", DP_RC(rc));
+	}
 }
 
 static int
@@ -548,11 +706,19 @@ sched_info_init(struct dss_xstream *dx)
 	info->si_stop = 0;
 	sched_metrics_init(dx);
 
+	rc = sched_offload_queue_init(&info->si_offload);
+	if (rc) {
+		D_FREE(info->si_qos_stats);
+		return rc;
+	}
+
 	rc = d_hash_table_create(D_HASH_FT_NOLOCK, 4,
 				 NULL, &sched_pool_hash_ops,
 				 &info->si_pool_hash);
 	if (rc) {
 		D_ERROR("Create sched pool hash failed. " DF_RC "\n", DP_RC(rc));
+		sched_offload_queue_fini(&info->si_offload);
+		D_FREE(info->si_qos_stats);
 		return rc;
 	}
 
@@ -596,6 +762,26 @@ cur_pool_info(struct sched_info *info, uuid_t pool_uuid)
 		D_INIT_LIST_HEAD(list);
 	}
 
+	if (sched_qos_class_nr != 0) {
+		D_ALLOC_ARRAY(spi->spi_qos, sched_qos_class_nr);
+		if (spi->spi_qos == NULL) {
+			D_FREE(spi);
+			return NULL;
+		}
+
+		/* Start with full token buckets */
+		for (type = 0; type < sched_qos_class_nr; type++) {
+			struct sched_qos_info	*sqi = &spi->spi_qos[type];
+			struct sched_qos_conf	*sqc;
+
+			D_INIT_LIST_HEAD(&sqi->sqi_req_list);
+			sqc = &sched_qos_confs[type];
+			sqi->sqi_iops_tokens = sqc->sqc_iops * SCHED_QOS_BURST_MSECS;
+			sqi->sqi_bw_tokens = sqc->sqc_bw * SCHED_QOS_BURST_MSECS;
+			sqi->sqi_refill_ts = info->si_cur_ts;
+		}
+	}
+
 	rc = d_hash_rec_insert(info->si_pool_hash, pool_uuid, sizeof(uuid_t),
 			       &spi->spi_hash_link, false);
 	if (rc)
@@ -1098,6 +1284,208 @@ policy_fifo_process(struct dss_xstream *dx)
 	process_req_list(dx, &info->si_fifo_list, false);
 }
 
+static void
+policy_qos_enqueue(struct dss_xstream *dx, struct sched_request *req,
+		   void *prio_data)
+{
+	struct sched_info	*info = &dx->dx_sched_info;
+	struct sched_pool_info	*spi = req->sr_pool_info;
+	struct sched_qos_info	*sqi;
+	unsigned int		 cls;
+
+	D_ASSERT(spi->spi_qos != NULL);
+	cls = sched_qos_cont2class(req->sr_attr.sra_cont_id);
+	sqi = &spi->spi_qos[cls];
+
+	/* Class turning backlogged doesn't get credits for the time it was idle */
+	if (sqi->sqi_req_cnt == 0 && sqi->sqi_vtime < spi->spi_qos_vtime)
+		sqi->sqi_vtime = spi->spi_qos_vtime;
+
+	req->sr_qos_class = cls;
+	req->sr_qos_held = 0;
+	d_list_add_tail(&req->sr_link, &sqi->sqi_req_list);
+	sqi->sqi_req_cnt++;
+
+	if (info->si_qos_stats != NULL)
+		d_tm_inc_gauge(info->si_qos_stats[cls].sqs_queued, 1);
+}
+
+static void
+qos_refill(struct sched_info *info, struct sched_qos_info *sqi,
+	   struct sched_qos_conf *sqc)
+{
+	uint64_t	elapsed;
+
+	D_ASSERT(info->si_cur_ts >= sqi->sqi_refill_ts);
+	elapsed = info->si_cur_ts - sqi->sqi_refill_ts;
+	if (elapsed == 0)
+		return;
+
+	sqi->sqi_refill_ts = info->si_cur_ts;
+	if (sqc->sqc_iops != 0)
+		sqi->sqi_iops_tokens = sched_qos_refill_tokens(sqi->sqi_iops_tokens,
+							       sqc->sqc_iops, elapsed);
+	if (sqc->sqc_bw != 0)
+		sqi->sqi_bw_tokens = sched_qos_refill_tokens(sqi->sqi_bw_tokens,
+							     sqc->sqc_bw, elapsed);
+}
+
+/*
+ * Pick the next class to be served, the class whose oldest request is running out
+ * of half of the latency target goes first, otherwise, the class with the smallest
+ * virtual time is picked. Return -1 when no class can be served.
+ */
+static int
+qos_pick_class(struct sched_info *info, struct sched_pool_info *spi, uint64_t held)
+{
+	struct sched_qos_info	*sqi;
+	struct sched_request	*req;
+	uint64_t		 urgent_ts = UINT64_MAX;
+	uint64_t		 vtime = UINT64_MAX;
+	int			 urgent = -1, fair = -1;
+	unsigned int		 i, lat;
+
+	for (i = 0; i < sched_qos_class_nr; i++) {
+		sqi = &spi->spi_qos[i];
+		if (sqi->sqi_req_cnt == 0 || (held & (1ULL << i)))
+			continue;
+
+		lat = sched_qos_confs[i].sqc_lat_target;
+		req = d_list_entry(sqi->sqi_req_list.next, struct sched_request, sr_link);
+		if (lat != 0 && (info->si_cur_ts - req->sr_enqueue_ts) * 2 >= lat &&
+		    req->sr_enqueue_ts < urgent_ts) {
+			urgent = i;
+			urgent_ts = req->sr_enqueue_ts;
+		}
+
+		if (sqi->sqi_vtime < vtime) {
+			fair = i;
+			vtime = sqi->sqi_vtime;
+		}
+	}
+
+	return urgent >= 0 ? urgent : fair;
+}
+
+static int
+qos_process_req(struct dss_xstream *dx, struct sched_pool_info *spi,
+		struct sched_request *req)
+{
+	struct sched_info	*info = &dx->dx_sched_info;
+	struct sched_qos_info	*sqi = &spi->spi_qos[req->sr_qos_class];
+	struct sched_qos_conf	*sqc = &sched_qos_confs[req->sr_qos_class];
+	struct sched_qos_stats	*sqs = NULL;
+	unsigned int		 req_type = req->sr_attr.sra_type;
+	uint64_t		 size = req->sr_attr.sra_size;
+	uint64_t		 wait;
+	bool			 no_tokens;
+
+	if (info->si_qos_stats != NULL)
+		sqs = &info->si_qos_stats[req->sr_qos_class];
+
+	D_ASSERT(info->si_cur_ts >= req->sr_enqueue_ts);
+	wait = info->si_cur_ts - req->sr_enqueue_ts;
+
+	/*
+	 * Tokens are allowed to be overdrawn by the request, so that large request can't
+	 * be starved, the class will be held until the debt is paid off. The request
+	 * won't be held longer than the max delay, to avoid RPC timeout on client.
+	 */
+	no_tokens = (sqc->sqc_iops != 0 && sqi->sqi_iops_tokens <= 0) ||
+		    (sqc->sqc_bw != 0 && sqi->sqi_bw_tokens <= 0);
+	if (no_tokens && !info->si_stop && wait <= max_delay_msecs[req_type] &&
+	    !(req->sr_attr.sra_flags & SCHED_REQ_FL_NO_DELAY)) {
+		if (!req->sr_qos_held && sqs != NULL)
+			d_tm_inc_counter(sqs->sqs_throttled, 1);
+		req->sr_qos_held = 1;
+		return 1;
+	}
+
+	/* Throttled by space pressure, the request can't be touched once kicked off */
+	if (process_req(dx, req) != 0)
+		return 1;
+
+	D_ASSERT(sqi->sqi_req_cnt > 0);
+	sqi->sqi_req_cnt--;
+
+	if (sqc->sqc_iops != 0)
+		sqi->sqi_iops_tokens -= 1000;
+	if (sqc->sqc_bw != 0)
+		sqi->sqi_bw_tokens -= size * 1000;
+
+	spi->spi_qos_vtime = sqi->sqi_vtime;
+	sqi->sqi_vtime += (req_weights[req_type] + (size >> SCHED_QOS_COST_SHIFT)) *
+			  SCHED_QOS_WEIGHT_MAX / sqc->sqc_weight;
+
+	if (sqs != NULL) {
+		d_tm_inc_counter(sqs->sqs_kicked, 1);
+		d_tm_inc_counter(sqs->sqs_bytes, size);
+		d_tm_dec_gauge(sqs->sqs_queued, 1);
+		d_tm_set_gauge(sqs->sqs_wait, wait);
+		if (sqc->sqc_lat_target != 0 && wait > sqc->sqc_lat_target)
+			d_tm_inc_counter(sqs->sqs_lat_miss, 1);
+	}
+
+	return 0;
+}
+
+static int
+qos_process_pool_cb(d_list_t *rlink, void *arg)
+{
+	struct dss_xstream	*dx = (struct dss_xstream *)arg;
+	struct sched_info	*info = &dx->dx_sched_info;
+	struct sched_pool_info	*spi = sched_rlink2spi(rlink);
+	struct sched_qos_info	*sqi;
+	struct sched_request	*req;
+	unsigned int		 quota[SCHED_QOS_CLASS_MAX + 1];
+	uint64_t		 held = 0;
+	uint32_t		 tot_weight = 0;
+	unsigned int		 i;
+	int			 cls;
+
+	if (spi->spi_qos == NULL || spi->spi_req_cnt == 0)
+		return 0;
+
+	for (i = 0; i < sched_qos_class_nr; i++) {
+		qos_refill(info, &spi->spi_qos[i], &sched_qos_confs[i]);
+		if (spi->spi_qos[i].sqi_req_cnt != 0)
+			tot_weight += sched_qos_confs[i].sqc_weight;
+	}
+
+	/*
+	 * Don't kick off the whole backlog in one cycle, the kicked ULTs would run
+	 * in FIFO regardless of the class. The budget is split by weight among the
+	 * backlogged classes, what's left is kicked off in the following cycles,
+	 * or all at once on sched_stop().
+	 */
+	for (i = 0; i < sched_qos_class_nr; i++)
+		quota[i] = spi->spi_qos[i].sqi_req_cnt == 0 ? 0 :
+			   sched_qos_quota(SCHED_QOS_KICK_MAX, sched_qos_confs[i].sqc_weight,
+					   tot_weight);
+
+	/* The class is held in current cycle once its request isn't kicked off */
+	while ((cls = qos_pick_class(info, spi, held)) >= 0) {
+		sqi = &spi->spi_qos[cls];
+		req = d_list_entry(sqi->sqi_req_list.next, struct sched_request, sr_link);
+		if (qos_process_req(dx, spi, req) != 0 ||
+		    (!info->si_stop && --quota[cls] == 0))
+			held |= (1ULL << cls);
+	}
+
+	return 0;
+}
+
+static void
+policy_qos_process(struct dss_xstream *dx)
+{
+	struct sched_info	*info = &dx->dx_sched_info;
+	int			 rc;
+
+	rc = d_hash_table_traverse(info->si_pool_hash, qos_process_pool_cb, dx);
+	if (rc)
+		D_ERROR("Traverse pool hash error. "DF_RC"\n", DP_RC(rc));
+}
+
 struct sched_policy_ops {
 	void (*enqueue_io)(struct dss_xstream *dx, struct sched_request *req,
 			   void *prio_data);
@@ -1116,6 +1504,10 @@ static struct sched_policy_ops	policy_ops[SCHED_POLICY_MAX] = {
 	{	/* SCHED_POLICY_ID_PRIO */
 		.enqueue_io = NULL,
 		.process_io = NULL,
+	},
+	{	/* SCHED_POLICY_QOS */
+		.enqueue_io = policy_qos_enqueue,
+		.process_io = policy_qos_process,
 	}
 };
 
@@ -1437,6 +1829,8 @@ sched_stop(struct dss_xstream *dx)
 	struct sched_info	*info = &dx->dx_sched_info;
 
 	info->si_stop = 1;
+	/* The queued offloaded work is drained by the scheduler before stopping */
+	sched_offload_queue_stop(&info->si_offload);
 	wakeup_all(dx);
 	process_all(dx);
 }
@@ -1718,6 +2112,166 @@ sched_pop_one(struct sched_data *data, ABT_pool pool, int pool_idx)
 	return unit;
 }
 
+/* Helper xstreams receiving offloaded work, see sched_steal_init() */
+static struct dss_xstream		**steal_xs;
+static struct sched_offload_queue	**steal_queues;
+static int				 *steal_numa_ids;
+static int				  steal_xs_nr;
+
+/* Max offloaded work converted into ULTs by a helper in each cycle */
+#define SCHED_OFFLOAD_BATCH	16
+
+int
+sched_offload_push(struct dss_xstream *dx, void (*func)(void *), void *arg)
+{
+	struct sched_info	*info = &dx->dx_sched_info;
+	int			 rc;
+
+	rc = sched_offload_queue_push(&info->si_offload, func, arg);
+	if (rc)
+		return rc;
+
+	/* Atomic integer assignment from different xstream */
+	info->si_stats.ss_busy_ts = info->si_cur_ts;
+	return 0;
+}
+
+static int
+steal_xs_idx(struct dss_xstream *dx)
+{
+	int	nr = __atomic_load_n(&steal_xs_nr, __ATOMIC_ACQUIRE);
+	int	i;
+
+	for (i = 0; i < nr; i++) {
+		if (steal_xs[i] == dx)
+			return i;
+	}
+	return -1;
+}
+
+/*
+ * Steal a batch from the most backlogged helper, the helpers on other NUMA
+ * nodes are only considered when no local helper has queued work.
+ */
+static int
+offload_steal(struct dss_xstream *dx, d_list_t *items)
+{
+	struct dss_xstream	*victim;
+	int			 self, idx, nr;
+
+	self = steal_xs_idx(dx);
+	if (self < 0)
+		return 0;
+
+	idx = sched_offload_victim(steal_queues, steal_numa_ids, steal_xs_nr, self);
+	if (idx < 0)
+		return 0;
+
+	victim = steal_xs[idx];
+	nr = sched_offload_queue_pop(&victim->dx_sched_info.si_offload, items,
+				     SCHED_OFFLOAD_BATCH, true);
+	if (nr > 0) {
+		d_tm_inc_counter(dx->dx_sched_info.si_stats.ss_offload_steals, nr);
+		d_tm_inc_counter(victim->dx_sched_info.si_stats.ss_offload_stolen, nr);
+	}
+
+	return nr;
+}
+
+/*
+ * Convert a batch of the queued offloaded work into ULTs in each cycle, the
+ * work of other helpers is stolen only when nothing else is runnable. Return
+ * the number of created ULTs.
+ */
+static int
+sched_offload_run(struct dss_xstream *dx, size_t runnable)
+{
+	struct sched_info		*info = &dx->dx_sched_info;
+	struct sched_offload_item	*item, *tmp;
+	d_list_t			 items;
+	int				 nr, created = 0;
+	int				 rc;
+
+	D_INIT_LIST_HEAD(&items);
+	nr = sched_offload_queue_pop(&info->si_offload, &items, SCHED_OFFLOAD_BATCH, false);
+	/* Don't steal on shutdown */
+	if (nr == 0 && runnable == 0 && !info->si_stop)
+		nr = offload_steal(dx, &items);
+
+	d_list_for_each_entry_safe(item, tmp, &items, soi_link) {
+		/* Bypass the stopping check, the queued work has to be executed anyway */
+		rc = daos_abt_thread_create(dx->dx_sp, dss_free_stack_cb,
+					    dx->dx_pools[DSS_POOL_GENERIC], item->soi_func,
+					    item->soi_arg, ABT_THREAD_ATTR_NULL, NULL);
+		if (rc != ABT_SUCCESS) {
+			D_ERROR("Failed to create offload ULT: %d\n", rc);
+			break;
+		}
+		d_list_del(&item->soi_link);
+		D_FREE(item);
+		created++;
+	}
+
+	/* Retry the rest in next cycle, the stolen ones are requeued locally */
+	sched_offload_queue_requeue(&info->si_offload, &items, nr - created);
+	return created;
+}
+
+/**
+ * Build the helper group for offload work stealing, it's called when all
+ * xstreams are started.
+ */
+int
+sched_steal_init(void)
+{
+	struct dss_xstream	*dx;
+	int			 tgt, xs_id, i, nr = 0;
+
+	if (!sched_offload_steal)
+		return 0;
+
+	D_ALLOC_ARRAY(steal_xs, dss_tgt_nr);
+	D_ALLOC_ARRAY(steal_queues, dss_tgt_nr);
+	D_ALLOC_ARRAY(steal_numa_ids, dss_tgt_nr);
+	if (steal_xs == NULL || steal_queues == NULL || steal_numa_ids == NULL) {
+		sched_steal_fini();
+		return -DER_NOMEM;
+	}
+
+	for (tgt = 0; tgt < dss_tgt_nr; tgt++) {
+		xs_id = sched_ult2xs(DSS_XS_OFFLOAD, tgt);
+		dx = dss_get_xstream(xs_id);
+		D_ASSERT(dx != NULL);
+
+		for (i = 0; i < nr; i++) {
+			if (steal_xs[i] == dx)
+				break;
+		}
+		if (i < nr)
+			continue;
+
+		steal_xs[nr] = dx;
+		steal_queues[nr] = &dx->dx_sched_info.si_offload;
+		steal_numa_ids[nr] = dx->dx_numa_id;
+		nr++;
+	}
+
+	/* The helpers are already running, publish the group once it's built */
+	__atomic_store_n(&steal_xs_nr, nr, __ATOMIC_RELEASE);
+	D_INFO("Offload work stealing is enabled on %d helper xstreams.\n", nr);
+	return 0;
+}
+
+/* Called when all xstreams are stopped */
+void
+sched_steal_fini(void)
+{
+	steal_xs_nr = 0;
+	D_FREE(steal_xs);
+	D_FREE(steal_queues);
+	D_FREE(steal_numa_ids);
+}
+
 #define SCHED_IDLE_THRESH	8000UL	/* msecs */
 
 /*
@@ -1736,6 +2290,7 @@ sched_try_relax(struct dss_xstream *dx, ABT_pool *pools, uint32_t running)
 	struct sched_info	*info = &dx->dx_sched_info;
 	unsigned int		 sleep_time = sched_relax_intvl;
 	size_t			 blocked;
+	int			 self = -1;
 	int			 ret;
 
 	dx->dx_timeout = 0;
@@ -1805,10 +2360,22 @@ sched_try_relax(struct dss_xstream *dx, ABT_pool *pools, uint32_t running)
 	D_ASSERT(sleep_time > 0 && sleep_time <= SCHED_RELAX_INTVL_MAX);
 
 	/*
+	 * The helper receiving offloaded work waits on its queue, so that it can
+	 * be woken up by sched_offload_push(). Network requests on the helper with
+	 * Cart context are delayed by the relax interval, like in sleep mode.
+	 *
 	 * Wait on external network request if the xstream has Cart context,
 	 * otherwise, sleep for a while.
 	 */
-	if (sched_relax_mode != SCHED_RELAX_MODE_SLEEP && dx->dx_progress_started) {
+	if (sched_offload_helper(dx))
+		self = steal_xs_idx(dx);
+
+	if (self >= 0) {
+		/* Other helper is backlogged, don't relax */
+		if (sched_offload_victim(steal_queues, steal_numa_ids, steal_xs_nr, self) >= 0)
+			return;
+		sched_offload_queue_relax(&info->si_offload, sleep_time);
+	} else if (sched_relax_mode != SCHED_RELAX_MODE_SLEEP && dx->dx_progress_started) {
 		/* convert to micro-seconds */
 		dx->dx_timeout = sleep_time * 1000;
 	} else {
@@ -1859,6 +2426,10 @@ sched_start_cycle(struct sched_data *data, ABT_pool *pools)
 			DSS_POOL_GENERIC, ret);
 		cnt = 0;
 	}
+	/* Run a batch of queued offloaded work, steal when nothing is runnable */
+	if (sched_offload_steal)
+		cnt += sched_offload_run(dx, cnt);
+
 	cycle->sc_ults_cnt[DSS_POOL_GENERIC] = cnt;
 	cycle->sc_ults_tot += cycle->sc_ults_cnt[DSS_POOL_GENERIC];
 
@@ -1868,6 +2439,7 @@ sched_start_cycle(struct sched_data *data, ABT_pool *pools)
 	d_tm_inc_counter(info->si_stats.ss_total_time, duration);
 	d_tm_set_gauge(info->si_stats.ss_wq_len, info->si_req_cnt);
 	d_tm_set_gauge(info->si_stats.ss_sq_len, info->si_sleep_cnt);
+	d_tm_set_gauge(info->si_stats.ss_offload_depth, info->si_offload.soq_cnt);
 	if (cycle->sc_ults_tot) {
 		d_tm_set_gauge(info->si_stats.ss_cycle_duration, duration);
 		d_tm_set_gauge(info->si_stats.ss_cycle_size, cycle->sc_ults_tot);
@@ -2050,7 +2622,8 @@ check_event:
 			ABT_bool stop;
 
 			ABT_sched_has_to_stop(sched, &stop);
-			if (stop == ABT_TRUE) {
+			/* Drain the queued offloaded work before stopping */
+			if (stop == ABT_TRUE && dx->dx_sched_info.si_offload.soq_cnt == 0) {
 				D_DEBUG(DB_TRACE, "Stop scheduler\n");
 				break;
 			}
@@ -0,0 +1,233 @@
+/**
+ * (C) Copyright 2023 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+/**
+ * Queue of the offloaded work on helper xstreams, see DAOS_SCHED_OFFLOAD_STEAL
+ * in sched.c: the helper runs the oldest items, the idle helpers steal the
+ * newest ones from the most backlogged helper.
+ */
+#define D_LOGFAC       DD_FAC(server)
+
+#include <daos/common.h>
+#include <daos_errno.h>
+#include "srv_internal.h"
+
+/* Only steal from helper on other NUMA node when it's backlogged enough */
+#define SCHED_STEAL_REMOTE_MIN	4
+
+int
+sched_offload_queue_init(struct sched_offload_queue *soq)
+{
+	pthread_condattr_t	attr;
+	int			rc;
+
+	D_INIT_LIST_HEAD(&soq->soq_list);
+	soq->soq_cnt = 0;
+	soq->soq_stopping = 0;
+	soq->soq_relaxing = 0;
+
+	rc = D_SPIN_INIT(&soq->soq_lock, PTHREAD_PROCESS_PRIVATE);
+	if (rc)
+		return rc;
+
+	rc = D_MUTEX_INIT(&soq->soq_relax_lock, NULL);
+	if (rc)
+		goto out_spin;
+
+	rc = pthread_condattr_init(&attr);
+	if (rc)
+		D_GOTO(out_mutex, rc = daos_errno2der(rc));
+
+	/* The relax timeout shouldn't be affected by the wall clock change */
+	rc = pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	if (rc == 0)
+		rc = pthread_cond_init(&soq->soq_relax_cond, &attr);
+	pthread_condattr_destroy(&attr);
+	if (rc)
+		D_GOTO(out_mutex, rc = daos_errno2der(rc));
+
+	return 0;
+out_mutex:
+	D_MUTEX_DESTROY(&soq->soq_relax_lock);
+out_spin:
+	D_SPIN_DESTROY(&soq->soq_lock);
+	return rc;
+}
+
+void
+sched_offload_queue_fini(struct sched_offload_queue *soq)
+{
+	D_ASSERT(d_list_empty(&soq->soq_list));
+	D_ASSERT(soq->soq_cnt == 0);
+
+	pthread_cond_destroy(&soq->soq_relax_cond);
+	D_MUTEX_DESTROY(&soq->soq_relax_lock);
+	D_SPIN_DESTROY(&soq->soq_lock);
+}
+
+/*
+ * Queue the work on the helper, it can be called from any xstream or thread.
+ * Return -DER_SHUTDOWN once the helper is stopping, since nothing would run
+ * the queued work anymore.
+ */
+int
+sched_offload_queue_push(struct sched_offload_queue *soq, void (*func)(void *), void *arg)
+{
+	struct sched_offload_item	*item;
+
+	D_ALLOC_PTR(item);
+	if (item == NULL)
+		return -DER_NOMEM;
+
+	item->soi_func = func;
+	item->soi_arg = arg;
+
+	D_SPIN_LOCK(&soq->soq_lock);
+	if (soq->soq_stopping) {
+		D_SPIN_UNLOCK(&soq->soq_lock);
+		D_FREE(item);
+		return -DER_SHUTDOWN;
+	}
+	d_list_add_tail(&item->soi_link, &soq->soq_list);
+	__atomic_store_n(&soq->soq_cnt, soq->soq_cnt + 1, __ATOMIC_SEQ_CST);
+	D_SPIN_UNLOCK(&soq->soq_lock);
+
+	/*
+	 * Pairs with sched_offload_queue_relax(): either the relaxing helper
+	 * sees the new item before waiting, or it's seen relaxing here.
+	 */
+	if (__atomic_load_n(&soq->soq_relaxing, __ATOMIC_SEQ_CST)) {
+		D_MUTEX_LOCK(&soq->soq_relax_lock);
+		pthread_cond_signal(&soq->soq_relax_cond);
+		D_MUTEX_UNLOCK(&soq->soq_relax_lock);
+	}
+
+	return 0;
+}
+
+/*
+ * Move up to @max items to the tail of @items in queued order, the oldest ones
+ * for the owner. A thief takes the newest ones, and half of the queue at most
+ * to leave the rest to the owner. Return the number of moved items.
+ */
+int
+sched_offload_queue_pop(struct sched_offload_queue *soq, d_list_t *items, int max, bool steal)
+{
+	struct sched_offload_item	*item;
+	d_list_t			 stolen;
+	int				 nr;
+
+	/* Racy check without lock, it's fine to miss an item just queued */
+	if (__atomic_load_n(&soq->soq_cnt, __ATOMIC_RELAXED) == 0)
+		return 0;
+
+	D_INIT_LIST_HEAD(&stolen);
+	D_SPIN_LOCK(&soq->soq_lock);
+	nr = steal ? (soq->soq_cnt + 1) / 2 : soq->soq_cnt;
+	nr = min(nr, max);
+	for (max = 0; max < nr; max++) {
+		if (steal) {
+			item = d_list_entry(soq->soq_list.prev, struct sched_offload_item,
+					    soi_link);
+			d_list_move(&item->soi_link, &stolen);
+		} else {
+			item = d_list_entry(soq->soq_list.next, struct sched_offload_item,
+					    soi_link);
+			d_list_move_tail(&item->soi_link, items);
+		}
+	}
+	D_ASSERT(soq->soq_cnt >= nr);
+	__atomic_store_n(&soq->soq_cnt, soq->soq_cnt - nr, __ATOMIC_RELAXED);
+	D_SPIN_UNLOCK(&soq->soq_lock);
+
+	if (steal)
+		d_list_splice(&stolen, items->prev);
+
+	return nr;
+}
+
+/* Put the popped but not executed items back to the head of the queue */
+void
+sched_offload_queue_requeue(struct sched_offload_queue *soq, d_list_t *items, int nr)
+{
+	if (nr == 0)
+		return;
+
+	D_SPIN_LOCK(&soq->soq_lock);
+	d_list_splice_init(items, &soq->soq_list);
+	__atomic_store_n(&soq->soq_cnt, soq->soq_cnt + nr, __ATOMIC_RELAXED);
+	D_SPIN_UNLOCK(&soq->soq_lock);
+}
+
+/* Reject new items, the queued ones are still drained by the helper */
+void
+sched_offload_queue_stop(struct sched_offload_queue *soq)
+{
+	D_SPIN_LOCK(&soq->soq_lock);
+	soq->soq_stopping = 1;
+	D_SPIN_UNLOCK(&soq->soq_lock);
+}
+
+/* Relax the helper for @msecs, or until any item is queued */
+void
+sched_offload_queue_relax(struct sched_offload_queue *soq, unsigned int msecs)
+{
+	struct timespec	ts;
+	int		rc;
+
+	rc = clock_gettime(CLOCK_MONOTONIC, &ts);
+	D_ASSERT(rc == 0);
+	ts.tv_sec += msecs / 1000;
+	ts.tv_nsec += (msecs % 1000) * NSEC_PER_MSEC;
+	if (ts.tv_nsec >= NSEC_PER_SEC) {
+		ts.tv_sec++;
+		ts.tv_nsec -= NSEC_PER_SEC;
+	}
+
+	D_MUTEX_LOCK(&soq->soq_relax_lock);
+	__atomic_store_n(&soq->soq_relaxing, 1, __ATOMIC_SEQ_CST);
+	while (__atomic_load_n(&soq->soq_cnt, __ATOMIC_SEQ_CST) == 0) {
+		rc = pthread_cond_timedwait(&soq->soq_relax_cond, &soq->soq_relax_lock, &ts);
+		if (rc == ETIMEDOUT)
+			break;
+		D_ASSERTF(rc == 0, "%d\n", rc);
+	}
+	__atomic_store_n(&soq->soq_relaxing, 0, __ATOMIC_RELAXED);
+	D_MUTEX_UNLOCK(&soq->soq_relax_lock);
+}
+
+/*
+ * Pick the most backlogged helper on the same NUMA node as @self, the helpers
+ * on other NUMA nodes are only considered when no local helper has queued work
+ * and they have SCHED_STEAL_REMOTE_MIN items at least. Return the index of the
+ * victim in @queues, or -1 if there is nothing to steal.
+ */
+int
+sched_offload_victim(struct sched_offload_queue **queues, const int *numa_ids, int nr, int self)
+{
+	uint32_t	local_cnt = 0;
+	uint32_t	remote_cnt = SCHED_STEAL_REMOTE_MIN - 1;
+	uint32_t	cnt;
+	int		local = -1, remote = -1;
+	int		i;
+
+	for (i = 0; i < nr; i++) {
+		if (i == self)
+			continue;
+
+		cnt = __atomic_load_n(&queues[i]->soq_cnt, __ATOMIC_RELAXED);
+		if (numa_ids[i] == numa_ids[self]) {
+			if (cnt > local_cnt) {
+				local = i;
+				local_cnt = cnt;
+			}
+		} else if (cnt > remote_cnt) {
+			remote = i;
+			remote_cnt = cnt;
+		}
+	}
+
+	return local != -1 ? local : remote;
+}
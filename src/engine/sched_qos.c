@@ -0,0 +1,307 @@
+/**
+ * (C) Copyright 2023 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+/**
+ * I/O QoS classes of the scheduler, see SCHED_POLICY_QOS in sched.c: parsing
+ * of DAOS_SCHED_QOS, container classification and the token bucket math.
+ */
+#define D_LOGFAC       DD_FAC(server)
+
+#include <ctype.h>
+#include <daos/common.h>
+#include <daos_errno.h>
+#include "srv_internal.h"
+
+struct sched_qos_cont {
+	/* Link to 'qos_cont_hash' */
+	d_list_t		sqt_link;
+	uuid_t			sqt_cont_id;
+	uint32_t		sqt_class;
+};
+
+/*
+ * QoS classes parsed from DAOS_SCHED_QOS, they are read-only once the engine
+ * is started. Class 0 is the default class for all unlisted containers.
+ */
+struct sched_qos_conf		sched_qos_confs[SCHED_QOS_CLASS_MAX + 1];
+/* Number of QoS classes including the default one, 0 means QoS is disabled */
+unsigned int			sched_qos_class_nr;
+
+/*
+ * Containers of the QoS classes, the hash is looked up by all main xstreams
+ * without lock, it's never changed after sched_qos_conf_init().
+ */
+static struct sched_qos_cont	qos_conts[SCHED_QOS_CONT_MAX];
+static unsigned int		qos_cont_nr;
+static struct d_hash_table	*qos_cont_hash;
+
+static inline struct sched_qos_cont *
+qos_rlink2cont(d_list_t *rlink)
+{
+	return container_of(rlink, struct sched_qos_cont, sqt_link);
+}
+
+static bool
+qos_cont_key_cmp(struct d_hash_table *htable, d_list_t *rlink,
+		 const void *key, unsigned int len)
+{
+	D_ASSERT(len == sizeof(uuid_t));
+	return uuid_compare(*(uuid_t *)key, qos_rlink2cont(rlink)->sqt_cont_id) == 0;
+}
+
+static uint32_t
+qos_cont_key_hash(struct d_hash_table *htable, const void *key, unsigned int len)
+{
+	D_ASSERT(len == sizeof(uuid_t));
+	return *((const uint32_t *)key);
+}
+
+/* Records are in 'qos_conts', the hash is ephemeral and frees nothing */
+static d_hash_table_ops_t qos_cont_hash_ops = {
+	.hop_key_cmp	= qos_cont_key_cmp,
+	.hop_key_hash	= qos_cont_key_hash,
+};
+
+unsigned int
+sched_qos_cont2class(uuid_t cont_id)
+{
+	d_list_t	*rlink;
+
+	if (qos_cont_hash == NULL || uuid_is_null(cont_id))
+		return 0;
+
+	rlink = d_hash_rec_find(qos_cont_hash, cont_id, sizeof(uuid_t));
+	if (rlink == NULL)
+		return 0;
+
+	return qos_rlink2cont(rlink)->sqt_class;
+}
+
+static bool
+qos_label_valid(const char *label, unsigned int nr)
+{
+	const char	*c;
+	unsigned int	 i;
+
+	if (*label == '\0' || strlen(label) >= SCHED_QOS_LABEL_LEN)
+		return false;
+
+	for (i = 0; i < nr; i++) {
+		if (strcmp(label, sched_qos_confs[i].sqc_label) == 0)
+			return false;
+	}
+
+	/* The label is used in telemetry path */
+	for (c = label; *c != '\0'; c++) {
+		if (!isalnum(*c) && *c != '_' && *c != '-')
+			return false;
+	}
+
+	return true;
+}
+
+static int
+qos_parse_conts(unsigned int cls, char *conts)
+{
+	struct sched_qos_cont	*sqt;
+	char			*cont, *save = NULL;
+	uuid_t			 cont_id;
+	int			 rc;
+
+	for (cont = strtok_r(conts, "+", &save); cont != NULL;
+	     cont = strtok_r(NULL, "+", &save)) {
+		if (uuid_parse(cont, cont_id) != 0) {
+			D_ERROR("Invalid container %s for QoS class %s\n", cont,
+				sched_qos_confs[cls].sqc_label);
+			return -DER_INVAL;
+		}
+
+		if (qos_cont_nr == SCHED_QOS_CONT_MAX) {
+			D_ERROR("Too many QoS containers, max %u\n", SCHED_QOS_CONT_MAX);
+			return -DER_INVAL;
+		}
+
+		sqt = &qos_conts[qos_cont_nr];
+		uuid_copy(sqt->sqt_cont_id, cont_id);
+		sqt->sqt_class = cls;
+		rc = d_hash_rec_insert(qos_cont_hash, sqt->sqt_cont_id, sizeof(uuid_t),
+				       &sqt->sqt_link, true);
+		if (rc == -DER_EXIST) {
+			D_ERROR("Container "DF_UUID" is listed more than once\n",
+				DP_UUID(cont_id));
+			return -DER_INVAL;
+		}
+		D_ASSERT(rc == 0);
+		qos_cont_nr++;
+	}
+
+	return 0;
+}
+
+static int
+qos_parse_field(struct sched_qos_conf *sqc, char *field)
+{
+	char		*val, *end;
+	unsigned long	 num;
+
+	val = strchr(field, '=');
+	if (val == NULL)
+		goto invalid;
+
+	*val++ = '\0';
+	errno = 0;
+	num = strtoul(val, &end, 10);
+	if (*val == '\0' || *end != '\0' || errno != 0)
+		goto invalid;
+
+	if (strcmp(field, "weight") == 0 && num > 0 && num <= SCHED_QOS_WEIGHT_MAX)
+		sqc->sqc_weight = num;
+	else if (strcmp(field, "iops") == 0)
+		sqc->sqc_iops = num;
+	else if (strcmp(field, "bw") == 0 && num < (1UL << 24))
+		sqc->sqc_bw = (uint64_t)num << 20;
+	else if (strcmp(field, "lat") == 0 && num < UINT32_MAX)
+		sqc->sqc_lat_target = num;
+	else
+		goto invalid;
+
+	return 0;
+invalid:
+	D_ERROR("Invalid field %s for QoS class %s\n", field, sqc->sqc_label);
+	return -DER_INVAL;
+}
+
+/**
+ * Parse the QoS classes, which are separated by ';', each class is in format of:
+ *
+ * <label>:<cont_uuid>[+<cont_uuid>...][:weight=N][:iops=N][:bw=MiB/s][:lat=msecs]
+ *
+ * A tenant is represented by a class containing all its containers. IOPS and
+ * bandwidth limits are applied on each target, containers not listed in any
+ * class belong to the "default" class with weight 1 and no limit.
+ */
+int
+sched_qos_conf_init(const char *conf)
+{
+	struct sched_qos_conf	*sqc;
+	char			*buf, *cls, *field;
+	char			*cls_save = NULL, *field_save = NULL;
+	unsigned int		 nr = 1;
+	int			 rc = 0;
+
+	D_ASSERT(qos_cont_hash == NULL);
+	D_STRNDUP(buf, conf, strlen(conf));
+	if (buf == NULL)
+		return -DER_NOMEM;
+
+	rc = d_hash_table_create(D_HASH_FT_NOLOCK | D_HASH_FT_EPHEMERAL, 8, NULL,
+				 &qos_cont_hash_ops, &qos_cont_hash);
+	if (rc)
+		goto out;
+
+	memset(sched_qos_confs, 0, sizeof(sched_qos_confs));
+	strcpy(sched_qos_confs[0].sqc_label, "default");
+	sched_qos_confs[0].sqc_weight = 1;
+	qos_cont_nr = 0;
+
+	for (cls = strtok_r(buf, ";", &cls_save); cls != NULL;
+	     cls = strtok_r(NULL, ";", &cls_save)) {
+		if (nr > SCHED_QOS_CLASS_MAX) {
+			D_ERROR("Too many QoS classes, max %u\n", SCHED_QOS_CLASS_MAX);
+			D_GOTO(out, rc = -DER_INVAL);
+		}
+
+		sqc = &sched_qos_confs[nr];
+		sqc->sqc_weight = 1;
+
+		field = strtok_r(cls, ":", &field_save);
+		if (field == NULL || !qos_label_valid(field, nr)) {
+			D_ERROR("Invalid QoS class label in %s\n", conf);
+			D_GOTO(out, rc = -DER_INVAL);
+		}
+		strcpy(sqc->sqc_label, field);
+
+		field = strtok_r(NULL, ":", &field_save);
+		if (field == NULL) {
+			D_ERROR("No container for QoS class %s\n", sqc->sqc_label);
+			D_GOTO(out, rc = -DER_INVAL);
+		}
+
+		rc = qos_parse_conts(nr, field);
+		if (rc)
+			goto out;
+
+		while ((field = strtok_r(NULL, ":", &field_save)) != NULL) {
+			rc = qos_parse_field(sqc, field);
+			if (rc)
+				goto out;
+		}
+
+		D_INFO("QoS class %s: weight %u, iops "DF_U64", bw "DF_U64" bytes/s, lat %u ms\n",
+		       sqc->sqc_label, sqc->sqc_weight, sqc->sqc_iops, sqc->sqc_bw,
+		       sqc->sqc_lat_target);
+		nr++;
+	}
+
+	if (nr == 1) {
+		D_ERROR("No QoS class in %s\n", conf);
+		D_GOTO(out, rc = -DER_INVAL);
+	}
+
+	sched_qos_class_nr = nr;
+out:
+	if (rc)
+		sched_qos_conf_fini();
+	D_FREE(buf);
+	return rc;
+}
+
+void
+sched_qos_conf_fini(void)
+{
+	if (qos_cont_hash != NULL) {
+		d_hash_table_destroy(qos_cont_hash, true);
+		qos_cont_hash = NULL;
+	}
+	qos_cont_nr = 0;
+	sched_qos_class_nr = 0;
+}
+
+/*
+ * Refill the token bucket of 'rate' per second for 'elapsed' msecs, tokens are
+ * in 1/1000 request or byte. The bucket is capped to SCHED_QOS_BURST_MSECS worth
+ * of the rate, a negative bucket (overdrawn) is paid off first.
+ */
+int64_t
+sched_qos_refill_tokens(int64_t tokens, uint64_t rate, uint64_t elapsed)
+{
+	int64_t	burst = rate * SCHED_QOS_BURST_MSECS;
+
+	if (tokens >= burst)
+		return burst;
+
+	if (elapsed > (burst - tokens) / rate)
+		return burst;
+
+	return tokens + rate * elapsed;
+}
+
+/*
+ * Share of the class in the per-cycle kick budget, in proportion to its weight
+ * among the backlogged classes. Every backlogged class kicks at least one request
+ * per cycle, so the sum of the shares can exceed the budget by the class count.
+ */
+unsigned int
+sched_qos_quota(unsigned int budget, uint32_t weight, uint32_t tot_weight)
+{
+	unsigned int	quota;
+
+	if (tot_weight == 0)
+		return 0;
+
+	D_ASSERT(weight <= tot_weight);
+	quota = (uint64_t)budget * weight / tot_weight;
+	return quota == 0 ? 1 : quota;
+}
@@ -707,6 +707,53 @@ output:
 	return rc;
 }
 
+static uint32_t
+ivc_on_lease(crt_iv_namespace_t ivns, crt_iv_key_t *iv_key, void *arg)
+{
+	struct iv_priv_entry	*priv_entry = arg;
+	struct ds_iv_entry	*entry;
+	struct ds_iv_key	key;
+
+	if (priv_entry == NULL || priv_entry->entry == NULL)
+		return 0;
+
+	entry = priv_entry->entry;
+	if (entry->iv_class->iv_class_ops == NULL ||
+	    entry->iv_class->iv_class_ops->ivc_ent_lease == NULL)
+		return 0;
+
+	iv_key_unpack(&key, iv_key);
+	return entry->iv_class->iv_class_ops->ivc_ent_lease(entry, &key);
+}
+
+/*
+ * Only the classes providing ivc_key_match get a relaxed match, the others keep
+ * the exact key comparison CaRT does without ivo_keys_match, so that neither
+ * the coalescing of their fetches nor their leases are changed.
+ */
+static bool
+ivc_keys_match(crt_iv_namespace_t ivns, crt_iv_key_t *key1, crt_iv_key_t *key2)
+{
+	struct ds_iv_class	*class;
+	struct ds_iv_key	*tmp_key = key1->iov_buf;
+	struct ds_iv_key	k1;
+	struct ds_iv_key	k2;
+
+	/* class_id is always in the 1st place of ds_iv_key, see iv_key_unpack */
+	class = iv_class_lookup(tmp_key->class_id);
+	if (class == NULL || class->iv_class_ops == NULL ||
+	    class->iv_class_ops->ivc_key_match == NULL)
+		return key1->iov_len == key2->iov_len &&
+		       memcmp(key1->iov_buf, key2->iov_buf, key1->iov_len) == 0;
+
+	iv_key_unpack(&k1, key1);
+	iv_key_unpack(&k2, key2);
+	if (k1.rank != k2.rank || k1.class_id != k2.class_id)
+		return false;
+
+	return class->iv_class_ops->ivc_key_match(&k1, &k2);
+}
+
 struct crt_iv_ops iv_cache_ops = {
 	.ivo_pre_fetch		= ivc_pre_cb,
 	.ivo_on_fetch		= ivc_on_fetch,
@@ -717,7 +764,9 @@ struct crt_iv_ops iv_cache_ops = {
 	.ivo_on_hash		= ivc_on_hash,
 	.ivo_on_get		= ivc_on_get,
 	.ivo_on_put		= ivc_on_put,
-	.ivo_pre_sync		= ivc_pre_sync
+	.ivo_keys_match		= ivc_keys_match,
+	.ivo_pre_sync		= ivc_pre_sync,
+	.ivo_on_lease		= ivc_on_lease,
 };
 
 static void
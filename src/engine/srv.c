@@ -333,8 +333,10 @@ wait_all_exited(struct dss_xstream *dx, struct dss_module_info *dmi)
 		}
 		/*
 		 * Current running srv handler ULT is popped, so it's not
-		 * counted in pool size by argobots.
+		 * counted in pool size by argobots. The queued offloaded work
+		 * is converted into ULTs by the scheduler.
 		 */
+		total_size += dx->dx_sched_info.si_offload.soq_cnt;
 		if (total_size == 0)
 			break;
 
@@ -391,6 +393,7 @@ dss_srv_handler(void *arg)
 	D_ASSERT(dmi != NULL);
 	dmi->dmi_xs_id	= dx->dx_xs_id;
 	dmi->dmi_tgt_id	= dx->dx_tgt_id;
+	d_tm_bind_shard(dx->dx_xs_id);
 	dmi->dmi_ctx_id	= -1;
 	D_INIT_LIST_HEAD(&dmi->dmi_dtx_batched_cont_open_list);
 	D_INIT_LIST_HEAD(&dmi->dmi_dtx_batched_cont_close_list);
@@ -578,6 +581,7 @@ static inline struct dss_xstream *
 dss_xstream_alloc(hwloc_cpuset_t cpus)
 {
 	struct dss_xstream	*dx;
+	hwloc_obj_t		obj;
 	int			i;
 	int			rc = 0;
 
@@ -617,6 +621,9 @@ dss_xstream_alloc(hwloc_cpuset_t cpus)
 		D_GOTO(err_future, rc = -DER_NOMEM);
 	}
 
+	obj = hwloc_get_next_obj_covering_cpuset_by_type(dss_topo, cpus, HWLOC_OBJ_NUMANODE, NULL);
+	dx->dx_numa_id = (obj != NULL) ? obj->logical_index : -1;
+
 	for (i = 0; i < DSS_POOL_CNT; i++)
 		dx->dx_pools[i] = ABT_POOL_NULL;
 
@@ -892,6 +899,7 @@ dss_xstreams_fini(bool force)
 		ABT_xstream_join(dx->dx_xstream);
 		ABT_xstream_free(&dx->dx_xstream);
 	}
+	sched_steal_fini();
 
 	/** housekeeping ... */
 	for (i = 0; i < xstream_data.xd_xs_nr; i++) {
@@ -902,6 +910,7 @@ dss_xstreams_fini(bool force)
 		dss_xstream_free(dx);
 		xstream_data.xd_xs_ptrs[i] = NULL;
 	}
+	sched_qos_fini();
 
 	/* All other xstreams have terminated. */
 	xstream_data.xd_xs_nr = 0;
@@ -1043,6 +1052,22 @@ dss_xstreams_init(void)
 
 	d_getenv_int("DAOS_SCHED_UNIT_RUNTIME_MAX", &sched_unit_runtime_max);
 	d_getenv_bool("DAOS_SCHED_WATCHDOG_ALL", &sched_watchdog_all);
+	d_getenv_bool("DAOS_SCHED_OFFLOAD_STEAL", &sched_offload_steal);
+	if (sched_offload_steal && dss_tgt_offload_xs_nr == 0) {
+		D_INFO("No helper xstream, offload work stealing is disabled.\n");
+		sched_offload_steal = false;
+	}
+
+	env = getenv("DAOS_SCHED_QOS");
+	if (env != NULL) {
+		rc = sched_qos_init(env);
+		if (rc != 0) {
+			D_WARN("Invalid DAOS_SCHED_QOS, QoS is disabled. "DF_RC"\n", DP_RC(rc));
+			rc = 0;
+		} else {
+			D_INFO("I/O QoS is enabled with %u classes\n", sched_qos_class_nr);
+		}
+	}
 
 	/* start the execution streams */
 	D_DEBUG(DB_TRACE,
@@ -1101,9 +1126,16 @@ dss_xstreams_init(void)
 		}
 	}
 
+	rc = sched_steal_init();
+	if (rc)
+		D_GOTO(out, rc);
+
 	D_DEBUG(DB_TRACE, "%d execution streams successfully started "
 		"(first core %d)\n", dss_tgt_nr, dss_core_offset);
 out:
+	/* Otherwise it's done by dss_xstreams_fini() */
+	if (rc != 0 && dss_xstreams_empty())
+		sched_qos_fini();
 	return rc;
 }
 
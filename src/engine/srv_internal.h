@@ -32,22 +32,81 @@ struct sched_stats {
 	struct d_tm_node_t	*ss_sq_len;		/* Sleep queue length */
 	struct d_tm_node_t	*ss_cycle_duration;	/* Cycle duration (ms) */
 	struct d_tm_node_t	*ss_cycle_size;		/* Total ULTs in a cycle */
+	struct d_tm_node_t	*ss_offload_depth;	/* Offload queue depth */
+	struct d_tm_node_t	*ss_offload_steals;	/* Items stolen by this XS */
+	struct d_tm_node_t	*ss_offload_stolen;	/* Items stolen from this XS */
 	uint64_t		 ss_busy_ts;		/* Last busy timestamp (ms) */
 	uint64_t		 ss_watchdog_ts;	/* Last watchdog print ts (ms) */
 	void			*ss_last_unit;		/* Last executed unit */
 };
 
+#define SCHED_QOS_CLASS_MAX	16
+#define SCHED_QOS_CONT_MAX	256
+#define SCHED_QOS_LABEL_LEN	32
+#define SCHED_QOS_WEIGHT_MAX	100
+/* Token buckets can accumulate up to 100 msecs worth of the configured rate */
+#define SCHED_QOS_BURST_MSECS	100
+/* On WFQ, every 64KB transferred costs the same as a weight unit of CPU */
+#define SCHED_QOS_COST_SHIFT	16
+/* Metrics of each QoS class on each target, see struct sched_qos_stats */
+#define SCHED_QOS_METRIC_NR	6
+
+/* QoS class parsed from DAOS_SCHED_QOS, see sched_qos_conf_init() */
+struct sched_qos_conf {
+	char			sqc_label[SCHED_QOS_LABEL_LEN];
+	uint32_t		sqc_weight;
+	/* Latency target in msecs, 0 means no target */
+	uint32_t		sqc_lat_target;
+	/* IOPS limit, 0 means no limit */
+	uint64_t		sqc_iops;
+	/* Bandwidth limit in bytes/sec, 0 means no limit */
+	uint64_t		sqc_bw;
+};
+
+/* Per QoS class stats, see sched_qos_init() */
+struct sched_qos_stats {
+	struct d_tm_node_t	*sqs_kicked;		/* Kicked IO requests */
+	struct d_tm_node_t	*sqs_bytes;		/* Kicked IO bytes */
+	struct d_tm_node_t	*sqs_throttled;		/* Held by token buckets */
+	struct d_tm_node_t	*sqs_queued;		/* Queued IO requests */
+	struct d_tm_node_t	*sqs_wait;		/* Queue wait time (ms) */
+	struct d_tm_node_t	*sqs_lat_miss;		/* Latency target missed */
+};
+
+/*
+ * Offloaded work queued on a helper xstream, see sched_offload.c. The helper
+ * runs the oldest items, and the other idle helpers steal the newest ones.
+ */
+struct sched_offload_queue {
+	pthread_spinlock_t	 soq_lock;	/* Protect soq_list */
+	d_list_t		 soq_list;	/* Queued sched_offload_item */
+	uint32_t		 soq_cnt;	/* Items in soq_list */
+	uint32_t		 soq_stopping:1;/* Reject new items */
+	/* Woken up by sched_offload_queue_push() while the helper relaxes */
+	pthread_mutex_t		 soq_relax_lock;
+	pthread_cond_t		 soq_relax_cond;
+	uint32_t		 soq_relaxing;
+};
+
+struct sched_offload_item {
+	d_list_t		 soi_link;
+	void			(*soi_func)(void *);
+	void			*soi_arg;
+};
+
 struct sched_info {
 	uint64_t		 si_cur_ts;	/* Current timestamp (ms) */
 	uint64_t		 si_cur_seq;	/* Current schedule sequence */
 	uint64_t		 si_ult_start;	/* Start time of last executed unit */
 	void			*si_ult_func;	/* Function addr of last executed unit */
 	struct sched_stats	 si_stats;	/* Sched stats */
+	struct sched_qos_stats	*si_qos_stats;	/* Per QoS class stats */
 	d_list_t		 si_idle_list;	/* All unused requests */
 	d_list_t		 si_sleep_list;	/* All sleeping requests */
 	d_list_t		 si_fifo_list;	/* All IO requests in FIFO */
 	d_list_t		 si_purge_list;	/* Stale sched_pool_info */
 	struct d_hash_table	*si_pool_hash;	/* All sched_pool_info */
+	struct sched_offload_queue si_offload;	/* Offloaded work to be stolen */
 	uint32_t		 si_req_cnt;	/* Total inuse request count */
 	int			 si_sleep_cnt;	/* Sleeping request count */
 	int			 si_wait_cnt;	/* Long wait request count */
@@ -93,6 +152,7 @@ struct dss_xstream {
 #endif
 	bool			dx_progress_started;	/* Network poll started */
 	int                     dx_tag;                 /** tag for xstream */
+	int			dx_numa_id;		/* NUMA node, -1 if unknown */
 };
 
 /** Engine module's metrics */
@@ -210,6 +270,37 @@ extern unsigned int sched_relax_intvl;
 extern unsigned int sched_relax_mode;
 extern unsigned int sched_unit_runtime_max;
 extern bool sched_watchdog_all;
+extern bool sched_offload_steal;
+
+int sched_qos_init(const char *conf);
+void sched_qos_fini(void);
+int sched_steal_init(void);
+void sched_steal_fini(void);
+int sched_offload_push(struct dss_xstream *dx, void (*func)(void *), void *arg);
+
+/* sched_qos.c */
+extern struct sched_qos_conf sched_qos_confs[];
+extern unsigned int sched_qos_class_nr;
+int sched_qos_conf_init(const char *conf);
+void sched_qos_conf_fini(void);
+unsigned int sched_qos_cont2class(uuid_t cont_id);
+int64_t sched_qos_refill_tokens(int64_t tokens, uint64_t rate, uint64_t elapsed);
+unsigned int sched_qos_quota(unsigned int budget, uint32_t weight, uint32_t tot_weight);
+
+/* sched_offload.c */
+int sched_offload_queue_init(struct sched_offload_queue *soq);
+void sched_offload_queue_fini(struct sched_offload_queue *soq);
+int sched_offload_queue_push(struct sched_offload_queue *soq, void (*func)(void *), void *arg);
+int sched_offload_queue_pop(struct sched_offload_queue *soq, d_list_t *items, int max,
+			    bool steal);
+void sched_offload_queue_requeue(struct sched_offload_queue *soq, d_list_t *items, int nr);
+void sched_offload_queue_stop(struct sched_offload_queue *soq);
+void sched_offload_queue_relax(struct sched_offload_queue *soq, unsigned int msecs);
+int sched_offload_victim(struct sched_offload_queue **queues, const int *numa_ids, int nr,
+			 int self);
+
+/* ult.c */
+int sched_ult2xs(int xs_type, int tgt_id);
 
 void dss_sched_fini(struct dss_xstream *dx);
 int dss_sched_init(struct dss_xstream *dx);
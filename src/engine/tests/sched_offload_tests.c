@@ -0,0 +1,278 @@
+/*
+ * (C) Copyright 2023 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+
+/*
+ * Unit tests for the queue of the offloaded work on helper xstreams
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <daos/tests_lib.h>
+#include <abt.h>
+#include "../srv_internal.h"
+
+#define QUEUE_NR	4
+
+static struct sched_offload_queue	 queues[QUEUE_NR];
+static struct sched_offload_queue	*queue_ptrs[QUEUE_NR];
+
+static void
+work_func(void *arg)
+{
+}
+
+static void
+queue_push(struct sched_offload_queue *soq, int nr, int base)
+{
+	int	i;
+
+	for (i = 0; i < nr; i++)
+		assert_rc_equal(sched_offload_queue_push(soq, work_func,
+							 (void *)(uintptr_t)(base + i)), 0);
+}
+
+/* Check the items are in @first, @first + 1, ... order and free them */
+static void
+items_check(d_list_t *items, int nr, int first)
+{
+	struct sched_offload_item	*item;
+	int				 i = 0;
+
+	while ((item = d_list_pop_entry(items, struct sched_offload_item, soi_link)) != NULL) {
+		assert_ptr_equal(item->soi_func, work_func);
+		assert_int_equal((uintptr_t)item->soi_arg, first + i);
+		D_FREE(item);
+		i++;
+	}
+	assert_int_equal(i, nr);
+}
+
+static void
+queue_drain(struct sched_offload_queue *soq)
+{
+	struct sched_offload_item	*item;
+	d_list_t			 items;
+
+	D_INIT_LIST_HEAD(&items);
+	sched_offload_queue_pop(soq, &items, INT32_MAX, false);
+	while ((item = d_list_pop_entry(&items, struct sched_offload_item, soi_link)) != NULL)
+		D_FREE(item);
+	assert_int_equal(soq->soq_cnt, 0);
+}
+
+/* The owner takes the oldest items in a bounded batch */
+static void
+test_offload_pop(void **state)
+{
+	struct sched_offload_queue	*soq = &queues[0];
+	d_list_t			 items;
+
+	D_INIT_LIST_HEAD(&items);
+	assert_int_equal(sched_offload_queue_pop(soq, &items, 16, false), 0);
+	assert_true(d_list_empty(&items));
+
+	queue_push(soq, 20, 0);
+	assert_int_equal(soq->soq_cnt, 20);
+
+	assert_int_equal(sched_offload_queue_pop(soq, &items, 16, false), 16);
+	assert_int_equal(soq->soq_cnt, 4);
+	items_check(&items, 16, 0);
+
+	assert_int_equal(sched_offload_queue_pop(soq, &items, 16, false), 4);
+	assert_int_equal(soq->soq_cnt, 0);
+	items_check(&items, 4, 16);
+}
+
+/* A thief takes the newest half of the queue at most */
+static void
+test_offload_steal(void **state)
+{
+	struct sched_offload_queue	*soq = &queues[0];
+	d_list_t			 items;
+
+	D_INIT_LIST_HEAD(&items);
+	queue_push(soq, 10, 0);
+	assert_int_equal(sched_offload_queue_pop(soq, &items, 16, true), 5);
+	assert_int_equal(soq->soq_cnt, 5);
+	items_check(&items, 5, 5);
+
+	assert_int_equal(sched_offload_queue_pop(soq, &items, 2, true), 2);
+	items_check(&items, 2, 3);
+
+	/* The last item can be stolen */
+	assert_int_equal(sched_offload_queue_pop(soq, &items, 16, true), 2);
+	items_check(&items, 2, 1);
+	assert_int_equal(sched_offload_queue_pop(soq, &items, 16, true), 1);
+	items_check(&items, 1, 0);
+	assert_int_equal(soq->soq_cnt, 0);
+}
+
+/* The items not executed are put back to the head of the queue */
+static void
+test_offload_requeue(void **state)
+{
+	struct sched_offload_queue	*soq = &queues[0];
+	d_list_t			 items;
+
+	D_INIT_LIST_HEAD(&items);
+	queue_push(soq, 4, 0);
+	assert_int_equal(sched_offload_queue_pop(soq, &items, 2, false), 2);
+	sched_offload_queue_requeue(soq, &items, 2);
+	assert_true(d_list_empty(&items));
+	assert_int_equal(soq->soq_cnt, 4);
+
+	/* Stolen items requeued on the thief */
+	assert_int_equal(sched_offload_queue_pop(soq, &items, 16, true), 2);
+	queue_push(&queues[1], 2, 10);
+	sched_offload_queue_requeue(&queues[1], &items, 2);
+	assert_int_equal(queues[1].soq_cnt, 4);
+	assert_int_equal(sched_offload_queue_pop(&queues[1], &items, 2, false), 2);
+	items_check(&items, 2, 2);
+	queue_drain(&queues[1]);
+
+	queue_drain(soq);
+}
+
+/* The stopping queue rejects new items, the queued ones can still be drained */
+static void
+test_offload_stop(void **state)
+{
+	struct sched_offload_queue	*soq = &queues[0];
+	d_list_t			 items;
+
+	D_INIT_LIST_HEAD(&items);
+	queue_push(soq, 3, 0);
+	sched_offload_queue_stop(soq);
+	assert_rc_equal(sched_offload_queue_push(soq, work_func, NULL), -DER_SHUTDOWN);
+	assert_int_equal(soq->soq_cnt, 3);
+
+	assert_int_equal(sched_offload_queue_pop(soq, &items, 16, false), 3);
+	items_check(&items, 3, 0);
+	soq->soq_stopping = 0;
+}
+
+static void *
+push_thread(void *arg)
+{
+	usleep(20000);
+	queue_push(arg, 1, 0);
+	return NULL;
+}
+
+/* The relaxing helper is woken up by the push */
+static void
+test_offload_relax(void **state)
+{
+	struct sched_offload_queue	*soq = &queues[0];
+	pthread_t			 thread;
+	uint64_t			 start;
+
+	/* Queued item, don't wait */
+	queue_push(soq, 1, 0);
+	start = daos_getmtime_coarse();
+	sched_offload_queue_relax(soq, 10000);
+	assert_true(daos_getmtime_coarse() - start < 1000);
+	queue_drain(soq);
+
+	/* Timed out */
+	start = daos_getmtime_coarse();
+	sched_offload_queue_relax(soq, 50);
+	assert_true(daos_getmtime_coarse() - start >= 40);
+	assert_int_equal(soq->soq_relaxing, 0);
+
+	/* Woken up by push from other thread */
+	assert_int_equal(pthread_create(&thread, NULL, push_thread, soq), 0);
+	start = daos_getmtime_coarse();
+	sched_offload_queue_relax(soq, 10000);
+	assert_true(daos_getmtime_coarse() - start < 5000);
+	assert_int_equal(soq->soq_cnt, 1);
+	pthread_join(thread, NULL);
+	queue_drain(soq);
+}
+
+/* Victim is the most backlogged local helper, or a backlogged enough remote one */
+static void
+test_offload_victim(void **state)
+{
+	int	numa_ids[QUEUE_NR] = { 0, 0, 1, 1 };
+
+	assert_int_equal(sched_offload_victim(queue_ptrs, numa_ids, QUEUE_NR, 0), -1);
+
+	/* Never steal from itself */
+	queue_push(&queues[0], 8, 0);
+	assert_int_equal(sched_offload_victim(queue_ptrs, numa_ids, QUEUE_NR, 0), -1);
+	assert_int_equal(sched_offload_victim(queue_ptrs, numa_ids, QUEUE_NR, 1), 0);
+
+	/* Local helper is preferred even with less queued work */
+	queue_push(&queues[1], 1, 0);
+	queue_push(&queues[2], 3, 0);
+	assert_int_equal(sched_offload_victim(queue_ptrs, numa_ids, QUEUE_NR, 0), 1);
+	assert_int_equal(sched_offload_victim(queue_ptrs, numa_ids, QUEUE_NR, 1), 0);
+	assert_int_equal(sched_offload_victim(queue_ptrs, numa_ids, QUEUE_NR, 3), 2);
+
+	/* Remote helper isn't backlogged enough */
+	queue_drain(&queues[1]);
+	assert_int_equal(sched_offload_victim(queue_ptrs, numa_ids, QUEUE_NR, 0), -1);
+
+	/* The most backlogged remote helper */
+	queue_push(&queues[3], 4, 0);
+	assert_int_equal(sched_offload_victim(queue_ptrs, numa_ids, QUEUE_NR, 0), 3);
+	assert_int_equal(sched_offload_victim(queue_ptrs, numa_ids, QUEUE_NR, 1), 0);
+	queue_push(&queues[2], 2, 3);
+	assert_int_equal(sched_offload_victim(queue_ptrs, numa_ids, QUEUE_NR, 1), 0);
+	queue_drain(&queues[0]);
+	assert_int_equal(sched_offload_victim(queue_ptrs, numa_ids, QUEUE_NR, 1), 2);
+
+	queue_drain(&queues[2]);
+	queue_drain(&queues[3]);
+}
+
+static int
+setup_offload_tests(void **state)
+{
+	int	i, rc;
+
+	rc = d_log_init();
+	if (rc)
+		return rc;
+
+	for (i = 0; i < QUEUE_NR; i++) {
+		rc = sched_offload_queue_init(&queues[i]);
+		if (rc)
+			return rc;
+		queue_ptrs[i] = &queues[i];
+	}
+	return 0;
+}
+
+static int
+teardown_offload_tests(void **state)
+{
+	int	i;
+
+	for (i = 0; i < QUEUE_NR; i++)
+		sched_offload_queue_fini(&queues[i]);
+	d_log_fini();
+	return 0;
+}
+
+int
+main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_offload_pop),
+		cmocka_unit_test(test_offload_steal),
+		cmocka_unit_test(test_offload_requeue),
+		cmocka_unit_test(test_offload_stop),
+		cmocka_unit_test(test_offload_relax),
+		cmocka_unit_test(test_offload_victim),
+	};
+
+	return cmocka_run_group_tests_name("engine_sched_offload", tests, setup_offload_tests,
+					   teardown_offload_tests);
+}
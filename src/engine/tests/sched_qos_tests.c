@@ -0,0 +1,199 @@
+/*
+ * (C) Copyright 2023 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+
+/*
+ * Unit tests for the I/O QoS classes of the scheduler
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <daos/tests_lib.h>
+#include <abt.h>
+#include "../srv_internal.h"
+
+#define CONT_A	"11111111-1111-1111-1111-111111111111"
+#define CONT_B	"22222222-2222-2222-2222-222222222222"
+#define CONT_C	"33333333-3333-3333-3333-333333333333"
+#define CONT_D	"44444444-4444-4444-4444-444444444444"
+
+static unsigned int
+cont2class(const char *str)
+{
+	uuid_t	cont_id;
+
+	assert_int_equal(uuid_parse(str, cont_id), 0);
+	return sched_qos_cont2class(cont_id);
+}
+
+static void
+test_qos_conf_parse(void **state)
+{
+	struct sched_qos_conf	*sqc;
+	uuid_t			 null_id;
+	int			 rc;
+
+	rc = sched_qos_conf_init("gold:"CONT_A"+"CONT_B":weight=8:lat=5;"
+				 "batch:"CONT_C":iops=2000:bw=500");
+	assert_rc_equal(rc, 0);
+	assert_int_equal(sched_qos_class_nr, 3);
+
+	sqc = &sched_qos_confs[0];
+	assert_string_equal(sqc->sqc_label, "default");
+	assert_int_equal(sqc->sqc_weight, 1);
+	assert_int_equal(sqc->sqc_iops, 0);
+	assert_int_equal(sqc->sqc_bw, 0);
+
+	sqc = &sched_qos_confs[1];
+	assert_string_equal(sqc->sqc_label, "gold");
+	assert_int_equal(sqc->sqc_weight, 8);
+	assert_int_equal(sqc->sqc_lat_target, 5);
+	assert_int_equal(sqc->sqc_iops, 0);
+
+	sqc = &sched_qos_confs[2];
+	assert_string_equal(sqc->sqc_label, "batch");
+	assert_int_equal(sqc->sqc_weight, 1);
+	assert_int_equal(sqc->sqc_iops, 2000);
+	assert_int_equal(sqc->sqc_bw, 500ULL << 20);
+
+	assert_int_equal(cont2class(CONT_A), 1);
+	assert_int_equal(cont2class(CONT_B), 1);
+	assert_int_equal(cont2class(CONT_C), 2);
+	assert_int_equal(cont2class(CONT_D), 0);
+	uuid_clear(null_id);
+	assert_int_equal(sched_qos_cont2class(null_id), 0);
+
+	sched_qos_conf_fini();
+	assert_int_equal(sched_qos_class_nr, 0);
+	assert_int_equal(cont2class(CONT_A), 0);
+}
+
+static void
+test_qos_conf_invalid(void **state)
+{
+	const char	*confs[] = {
+		"",
+		";",
+		"gold",
+		"gold:",
+		"gold:not-a-uuid",
+		"gold/1:"CONT_A,
+		"gold:"CONT_A";gold:"CONT_B,
+		"gold:"CONT_A";batch:"CONT_A,
+		"gold:"CONT_A"+"CONT_A,
+		"gold:"CONT_A":weight=0",
+		"gold:"CONT_A":weight=101",
+		"gold:"CONT_A":weight=",
+		"gold:"CONT_A":weight=1x",
+		"gold:"CONT_A":bw=16777216",
+		"gold:"CONT_A":prio=1",
+		"gold:"CONT_A":iops",
+	};
+	char		 buf[2048];
+	int		 len = 0;
+	int		 i;
+
+	for (i = 0; i < ARRAY_SIZE(confs); i++) {
+		print_message("%s\n", confs[i]);
+		assert_rc_equal(sched_qos_conf_init(confs[i]), -DER_INVAL);
+		assert_int_equal(sched_qos_class_nr, 0);
+		assert_int_equal(cont2class(CONT_A), 0);
+	}
+
+	/* One class beyond the max */
+	for (i = 0; i <= SCHED_QOS_CLASS_MAX; i++)
+		len += snprintf(buf + len, sizeof(buf) - len, "c%d:%08x-1111-1111-1111-111111111111;",
+				i, i);
+	assert_rc_equal(sched_qos_conf_init(buf), -DER_INVAL);
+	assert_int_equal(sched_qos_class_nr, 0);
+
+	/* Remove the last one */
+	buf[len - 1] = '\0';
+	*strrchr(buf, ';') = '\0';
+	assert_rc_equal(sched_qos_conf_init(buf), 0);
+	assert_int_equal(sched_qos_class_nr, SCHED_QOS_CLASS_MAX + 1);
+	sched_qos_conf_fini();
+}
+
+static void
+test_qos_refill_tokens(void **state)
+{
+	uint64_t	rate = 2000;	/* per second */
+	int64_t		burst = rate * SCHED_QOS_BURST_MSECS;
+	int64_t		tokens;
+
+	/* 1 msec of 2000/s is 2 requests, tokens are in 1/1000 */
+	assert_int_equal(sched_qos_refill_tokens(0, rate, 1), 2000);
+	assert_int_equal(sched_qos_refill_tokens(0, rate, 10), 20000);
+
+	/* Capped to the burst */
+	assert_int_equal(sched_qos_refill_tokens(0, rate, SCHED_QOS_BURST_MSECS), burst);
+	assert_int_equal(sched_qos_refill_tokens(0, rate, SCHED_QOS_BURST_MSECS + 1), burst);
+	assert_int_equal(sched_qos_refill_tokens(burst - 1, rate, 1), burst);
+	assert_int_equal(sched_qos_refill_tokens(burst, rate, 0), burst);
+	assert_int_equal(sched_qos_refill_tokens(burst * 2, rate, 0), burst);
+
+	/* No overflow after a long idle period */
+	assert_int_equal(sched_qos_refill_tokens(0, rate, UINT64_MAX / 2), burst);
+
+	/* An overdrawn bucket pays off the debt first */
+	tokens = -(int64_t)(rate * 1000);
+	tokens = sched_qos_refill_tokens(tokens, rate, 400);
+	assert_int_equal(tokens, -(int64_t)(rate * 600));
+	tokens = sched_qos_refill_tokens(tokens, rate, 600);
+	assert_int_equal(tokens, 0);
+	tokens = sched_qos_refill_tokens(tokens, rate, 1000);
+	assert_int_equal(tokens, burst);
+
+	/* Large bandwidth, 16TiB/s */
+	rate = (1ULL << 24) << 20;
+	burst = rate * SCHED_QOS_BURST_MSECS;
+	assert_int_equal(sched_qos_refill_tokens(-burst, rate, 50), -burst / 2);
+}
+
+static void
+test_qos_quota(void **state)
+{
+	/* Split by weight */
+	assert_int_equal(sched_qos_quota(64, 8, 10), 51);
+	assert_int_equal(sched_qos_quota(64, 1, 10), 6);
+	assert_int_equal(sched_qos_quota(64, 1, 1), 64);
+
+	/* At least one request per backlogged class */
+	assert_int_equal(sched_qos_quota(64, 1, 100), 1);
+	assert_int_equal(sched_qos_quota(64, 1, 1000), 1);
+
+	/* No backlogged class */
+	assert_int_equal(sched_qos_quota(64, 0, 0), 0);
+}
+
+static int
+setup_qos_tests(void **state)
+{
+	return d_log_init();
+}
+
+static int
+teardown_qos_tests(void **state)
+{
+	d_log_fini();
+	return 0;
+}
+
+int
+main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_qos_conf_parse),
+		cmocka_unit_test(test_qos_conf_invalid),
+		cmocka_unit_test(test_qos_refill_tokens),
+		cmocka_unit_test(test_qos_quota),
+	};
+
+	return cmocka_run_group_tests_name("engine_sched_qos", tests, setup_qos_tests,
+					   teardown_qos_tests);
+}
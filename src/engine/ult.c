@@ -324,7 +324,7 @@ dss_thread_collective(int (*func)(void *), void *arg, unsigned int flags)
 
 /* ============== ULT create functions =================================== */
 
-static inline int
+int
 sched_ult2xs(int xs_type, int tgt_id)
 {
 	uint32_t	xs_id;
@@ -423,6 +423,11 @@ ult_create_internal(void (*func)(void *), void *arg, int xs_type, int tgt_idx,
 	if (dx == NULL)
 		return -DER_NONEXIST;
 
+	/* Queue the offloaded work on the helper, so that it can be stolen by idle helpers */
+	if (xs_type == DSS_XS_OFFLOAD && sched_offload_steal && ult == NULL &&
+	    stack_size == 0 && flags == 0)
+		return sched_offload_push(dx, func, arg);
+
 	if (stack_size > 0) {
 		rc = ABT_thread_attr_create(&attr);
 		if (rc != ABT_SUCCESS)
@@ -60,8 +60,25 @@ struct d_tm_context {
 	 * Head of a linked list of struct shmem_list.
 	 */
 	d_list_t		 open_shmem;
+	/** Percentiles printed for the HDR histograms, see d_tm_set_hdr_view() */
+	double			*hdr_pcts;
+	int			 hdr_pct_nr;
+	/** Print the HDR histograms over the interval since the previous print */
+	bool			 hdr_interval;
+	/** Previous snapshots of the HDR histograms, list of struct hdr_prev */
+	d_list_t		 hdr_prev;
 };
 
+/** Snapshot of a HDR histogram taken by the previous print */
+struct hdr_prev {
+	d_list_t		 hp_link;
+	struct d_tm_node_t	*hp_node;
+	struct d_tm_hdr_snap_t	 hp_snap;
+};
+
+/** Percentiles printed for the HDR histograms by default */
+static double hdr_pcts_def[] = {50, 90, 99, 99.9};
+
 /**
  * Internal tracking data for shared memory for this process.
  */
@@ -72,8 +89,19 @@ static struct d_tm_shmem {
 	bool			 sync_access; /** whether to sync access */
 	bool			 retain; /** retain shmem region on exit */
 	int			 id; /** Instance ID */
+	unsigned int		 shard_nr; /** slots of each sharded metric */
+	bool			 shard_bound; /** slots bound by d_tm_bind_shard() */
 } tm_shmem;
 
+/** Default number of per-thread slots of a sharded metric */
+#define D_TM_SHARD_NR_DEF	16
+/** Max retries of a reader racing with the owner of a slot */
+#define D_TM_SHARD_READ_RETRY	1024
+
+/** Index of the calling thread in the slots of the sharded metrics */
+static __thread int	tm_shard_idx = -1;
+static int		tm_shard_next;
+
 /* Internal helper functions */
 static int allocate_shared_memory(int srv_idx, size_t mem_size,
 				  struct d_tm_shmem_hdr **shmem);
@@ -679,6 +707,7 @@ alloc_ctx(struct d_tm_context **ctx, struct d_tm_shmem_hdr *shmem, int shmid)
 	new_ctx->shmem_root = shmem;
 	new_ctx->shmid_root = shmid;
 	D_INIT_LIST_HEAD(&new_ctx->open_shmem);
+	D_INIT_LIST_HEAD(&new_ctx->hdr_prev);
 
 	*ctx = new_ctx;
 	return 0;
@@ -796,6 +825,9 @@ d_tm_init(int id, uint64_t mem_size, int flags)
 		D_INFO("Retaining shared memory for id %d\n", id);
 	}
 
+	tm_shmem.shard_nr = D_TM_SHARD_NR_DEF;
+	d_getenv_int("D_TM_SHARDS", &tm_shmem.shard_nr);
+
 	tm_shmem.id = id;
 	snprintf(tmp, sizeof(tmp), "ID: %d", id);
 	key = d_tm_get_srv_key(id);
@@ -831,6 +863,39 @@ failure:
 	return rc;
 }
 
+/**
+ * Size the per-thread slots of the sharded metrics created afterwards to
+ * \a nr, typically the number of xstreams of the engine. Only the threads
+ * bound to a slot by d_tm_bind_shard() then use the slots, the other ones
+ * update the sharded metrics as regular ones. Otherwise the threads take the
+ * D_TM_SHARDS slots in the order of their first update.
+ *
+ * Must be called after d_tm_init() and before any sharded metric is added.
+ * Sharding disabled by D_TM_SHARDS=0 stays disabled.
+ *
+ * \param[in]	nr	Number of slots
+ */
+void
+d_tm_set_shards(unsigned int nr)
+{
+	if (tm_shmem.shard_nr > 0)
+		tm_shmem.shard_nr = nr;
+	tm_shmem.shard_bound = true;
+}
+
+/**
+ * Bind the calling thread to the slot \a idx of the sharded metrics, see
+ * d_tm_set_shards(). A thread bound beyond the slots updates the sharded
+ * metrics as regular ones.
+ *
+ * \param[in]	idx	Slot of the calling thread, e.g. its xstream index
+ */
+void
+d_tm_bind_shard(int idx)
+{
+	tm_shard_idx = idx;
+}
+
 /**
  * Releases resources claimed by init
  */
@@ -1138,6 +1203,68 @@ d_tm_print_gauge(uint64_t val, struct d_tm_stats_t *stats, char *name,
 		d_tm_print_stats(stream, stats, format);
 }
 
+/**
+ * Prints the percentiles and statistics of the HDR histogram \a snap with
+ * \a name to the \a stream provided
+ *
+ * \param[in]	snap		Histogram snapshot
+ * \param[in]	pcts		Percentiles to print (0 - 100), NULL for the
+ *				default p50, p90, p99 and p99.9
+ * \param[in]	pct_nr		Number of \a pcts
+ * \param[in]	name		Histogram name
+ * \param[in]	format		Output format.
+ *				Choose D_TM_STANDARD for standard output.
+ *				Choose D_TM_CSV for comma separated values.
+ * \param[in]	units		The units expressed as a string
+ * \param[in]	opt_fields	A bitmask.  Set to D_TM_INCLUDE_TYPE to display
+ *				metric type.
+ * \param[in]	stream		Output stream (stdout, stderr)
+ */
+void
+d_tm_print_hdr(struct d_tm_hdr_snap_t *snap, double *pcts, int pct_nr,
+	       char *name, int format, char *units, int opt_fields,
+	       FILE *stream)
+{
+	double	mean = 0;
+	int	i;
+
+	if ((snap == NULL) || (name == NULL) || (stream == NULL))
+		return;
+
+	if (pcts == NULL) {
+		pcts = hdr_pcts_def;
+		pct_nr = ARRAY_SIZE(hdr_pcts_def);
+	}
+
+	if (snap->dhs_count > 0)
+		mean = (double)snap->dhs_sum / snap->dhs_count;
+
+	if (format == D_TM_CSV) {
+		fprintf(stream, "%s", name);
+		if (opt_fields & D_TM_INCLUDE_TYPE)
+			fprintf(stream, ",histogram");
+		/** All the percentiles in the value field */
+		fprintf(stream, ",");
+		for (i = 0; i < pct_nr; i++)
+			fprintf(stream, "%sp%g:%lu", i == 0 ? "" : " ", pcts[i],
+				d_tm_hdr_percentile(snap, pcts[i]));
+		fprintf(stream, ",%lu,%lu,%lf,%lu,", snap->dhs_min,
+			snap->dhs_max, mean, snap->dhs_count);
+		return;
+	}
+
+	if (opt_fields & D_TM_INCLUDE_TYPE)
+		fprintf(stream, "type: histogram, ");
+	fprintf(stream, "%s:", name);
+	for (i = 0; i < pct_nr; i++)
+		fprintf(stream, "%s p%g: %lu", i == 0 ? "" : ",", pcts[i],
+			d_tm_hdr_percentile(snap, pcts[i]));
+	if (units != NULL)
+		fprintf(stream, " %s", units);
+	fprintf(stream, " [min: %lu, max: %lu, avg: %.0lf, samples: %lu]",
+		snap->dhs_min, snap->dhs_max, mean, snap->dhs_count);
+}
+
 /**
  * Client function to print the metadata strings \a desc and \a units
  * to the \a stream provided
@@ -1172,6 +1299,65 @@ d_tm_print_metadata(char *desc, char *units, int format, FILE *stream)
 static int
 d_tm_get_meminfo(struct d_tm_context *ctx, struct d_tm_meminfo_t *meminfo,
 		 struct d_tm_node_t *node);
+
+static void
+hdr_prev_free(struct d_tm_context *ctx)
+{
+	struct hdr_prev	*prev;
+	struct hdr_prev	*next;
+
+	d_list_for_each_entry_safe(prev, next, &ctx->hdr_prev, hp_link) {
+		d_list_del(&prev->hp_link);
+		d_tm_hdr_snap_fini(&prev->hp_snap);
+		D_FREE(prev);
+	}
+}
+
+/**
+ * Keep a copy of \a snap of the HDR histogram \a node for the next print,
+ * and replace \a snap by the samples recorded since the previous print.
+ */
+static int
+hdr_interval(struct d_tm_context *ctx, struct d_tm_node_t *node,
+	     struct d_tm_hdr_snap_t *snap)
+{
+	struct d_tm_hdr_snap_t	 copy = {0};
+	struct hdr_prev		*prev;
+	bool			 found = false;
+	int			 rc;
+
+	d_list_for_each_entry(prev, &ctx->hdr_prev, hp_link) {
+		if (prev->hp_node == node) {
+			found = true;
+			break;
+		}
+	}
+
+	if (!found) {
+		D_ALLOC_PTR(prev);
+		if (prev == NULL)
+			return -DER_NOMEM;
+		prev->hp_node = node;
+		d_list_add_tail(&prev->hp_link, &ctx->hdr_prev);
+	}
+
+	rc = d_tm_hdr_merge(&copy, snap);
+	if (rc != 0)
+		return rc;
+
+	if (found) {
+		rc = d_tm_hdr_diff(snap, &prev->hp_snap);
+		if (rc != 0) {
+			d_tm_hdr_snap_fini(&copy);
+			return rc;
+		}
+	}
+
+	d_tm_hdr_snap_fini(&prev->hp_snap);
+	prev->hp_snap = copy;
+	return 0;
+}
+
 /**
  * Prints a single \a node.
  * Used as a convenience function to demonstrate usage for the client
@@ -1205,6 +1391,7 @@ d_tm_print_node(struct d_tm_context *ctx, struct d_tm_node_t *node, int level,
 	char               *desc           = NULL;
 	char               *units          = NULL;
 	struct d_tm_meminfo_t	meminfo;
+	struct d_tm_hdr_snap_t	hdr = {0};
 	bool                stats_printed  = false;
 	bool                show_timestamp = false;
 	bool                show_meta      = false;
@@ -1320,6 +1507,20 @@ d_tm_print_node(struct d_tm_context *ctx, struct d_tm_node_t *node, int level,
 		if (stats.sample_size > 0)
 			stats_printed = true;
 		break;
+	case D_TM_HDR_HISTOGRAM:
+		rc = d_tm_get_hdr(ctx, &hdr, node);
+		if (rc == DER_SUCCESS && ctx->hdr_interval)
+			rc = hdr_interval(ctx, node, &hdr);
+		if (rc != DER_SUCCESS) {
+			fprintf(stream, "Error on histogram read: %d\n", rc);
+			d_tm_hdr_snap_fini(&hdr);
+			break;
+		}
+		d_tm_print_hdr(&hdr, ctx->hdr_pcts, ctx->hdr_pct_nr, name,
+			       format, units, opt_fields, stream);
+		d_tm_hdr_snap_fini(&hdr);
+		stats_printed = true;
+		break;
 	default:
 		fprintf(stream, "Item: %s has unknown type: 0x%x\n", name,
 			node->dtn_type);
@@ -1436,6 +1637,29 @@ _reset_node(struct d_tm_context *ctx, struct d_tm_node_t *node)
 	memset(&metric_data->dtm_data, 0, sizeof(metric_data->dtm_data));
 	if (dtm_stats != NULL)
 		memset(dtm_stats, 0, sizeof(*dtm_stats));
+	if (metric_data->dtm_shards != NULL) {
+		struct d_tm_shard_t	*shards;
+
+		shards = conv_ptr(shmem, metric_data->dtm_shards);
+		if (shards != NULL)
+			memset(shards, 0, metric_data->dtm_shard_nr * sizeof(*shards));
+	}
+
+	if (metric_data->dtm_hdr != NULL) {
+		struct d_tm_hdr_t	*hdr;
+		uint64_t		*buckets = NULL;
+
+		hdr = conv_ptr(shmem, metric_data->dtm_hdr);
+		if (hdr != NULL)
+			buckets = conv_ptr(shmem, hdr->dth_buckets);
+		if (buckets != NULL) {
+			memset(buckets, 0, hdr->dth_nr * sizeof(*buckets));
+			hdr->dth_count = 0;
+			hdr->dth_sum = 0;
+			hdr->dth_min = UINT64_MAX;
+			hdr->dth_max = 0;
+		}
+	}
 
 	if (dtm_histogram != NULL) {
 		int i;
@@ -1483,6 +1707,7 @@ reset_node(struct d_tm_context *ctx, struct d_tm_node_t *node, int level,
 	case (D_TM_DURATION | D_TM_CLOCK_THREAD_CPUTIME):
 	case D_TM_GAUGE:
 	case D_TM_STATS_GAUGE:
+	case D_TM_HDR_HISTOGRAM:
 		_reset_node(ctx, node);
 		break;
 	default:
@@ -1682,6 +1907,228 @@ d_tm_compute_stats(struct d_tm_node_t *node, uint64_t value)
 		dtm_stats->dtm_min = value;
 }
 
+/**
+ * Returns the slot of the calling thread if \a metric is sharded, or NULL if
+ * the metric is not sharded or if the thread is beyond the slots, in which
+ * case the thread updates the data of the node as for a regular metric.
+ */
+static inline struct d_tm_shard_t *
+shard_get(struct d_tm_node_t *metric)
+{
+	struct d_tm_metric_t	*data = metric->dtn_metric;
+
+	if (likely(data->dtm_shards == NULL))
+		return NULL;
+
+	if (unlikely(tm_shard_idx < 0)) {
+		/* Only the threads bound by d_tm_bind_shard() own a slot */
+		if (tm_shmem.shard_bound)
+			return NULL;
+		tm_shard_idx = __atomic_fetch_add(&tm_shard_next, 1, __ATOMIC_RELAXED);
+	}
+
+	if (tm_shard_idx >= data->dtm_shard_nr)
+		return NULL;
+
+	return &data->dtm_shards[tm_shard_idx];
+}
+
+static inline void
+shard_write_begin(struct d_tm_shard_t *shard)
+{
+	__atomic_store_n(&shard->dts_seq, shard->dts_seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void
+shard_write_end(struct d_tm_shard_t *shard)
+{
+	__atomic_store_n(&shard->dts_seq, shard->dts_seq + 1, __ATOMIC_RELEASE);
+}
+
+/** Add \a value to the statistics of the slot with Welford's method */
+static void
+shard_compute_stats(struct d_tm_shard_t *shard, uint64_t value)
+{
+	double	delta;
+
+	shard->dts_count++;
+	shard->dts_sum += value;
+
+	if (value > shard->dts_max)
+		shard->dts_max = value;
+
+	if (shard->dts_count == 1 || value < shard->dts_min)
+		shard->dts_min = value;
+
+	delta = (double)value - shard->dts_mean;
+	shard->dts_mean += delta / shard->dts_count;
+	shard->dts_m2 += delta * ((double)value - shard->dts_mean);
+}
+
+/** Take a consistent copy of the slot, see shard_write_begin() */
+static void
+shard_read(struct d_tm_shard_t *shard, struct d_tm_shard_t *copy)
+{
+	uint64_t	seq;
+	int		i;
+
+	/* Don't spin forever on the slot of a dead producer */
+	for (i = 0; i < D_TM_SHARD_READ_RETRY; i++) {
+		seq = __atomic_load_n(&shard->dts_seq, __ATOMIC_ACQUIRE);
+		*copy = *shard;
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (!(seq & 1) && seq == __atomic_load_n(&shard->dts_seq, __ATOMIC_RELAXED))
+			break;
+	}
+}
+
+/**
+ * Add the slots of a sharded counter to \a val, which already holds the value
+ * of the node itself. Each slot only grows, so a reader racing with the owners
+ * gets a slightly stale sum but never a torn one.
+ */
+static void
+shards_merge(struct d_tm_shard_t *shards, int nr, uint64_t *val)
+{
+	int	i;
+
+	for (i = 0; i < nr; i++)
+		*val += __atomic_load_n(&shards[i].dts_value, __ATOMIC_RELAXED);
+}
+
+/**
+ * Merge the statistics of the slots of a sharded gauge into \a stats, which
+ * already holds the statistics of the node itself, with the pairwise variant
+ * of Welford's method.
+ */
+static void
+shards_merge_stats(struct d_tm_shard_t *shards, int nr, struct d_tm_stats_t *stats)
+{
+	struct d_tm_shard_t	copy;
+	uint64_t		n = stats->sample_size;
+	double			mean = 0;
+	double			m2 = 0;
+	double			delta;
+	int			i;
+
+	if (n > 0) {
+		mean = stats->mean;
+		m2 = max(stats->sum_of_squares - n * mean * mean, 0.0);
+	}
+
+	for (i = 0; i < nr; i++) {
+		shard_read(&shards[i], &copy);
+		if (copy.dts_count == 0)
+			continue;
+
+		if (n == 0 || copy.dts_min < stats->dtm_min)
+			stats->dtm_min = copy.dts_min;
+		if (copy.dts_max > stats->dtm_max)
+			stats->dtm_max = copy.dts_max;
+		stats->dtm_sum += copy.dts_sum;
+
+		delta = copy.dts_mean - mean;
+		mean += delta * copy.dts_count / (n + copy.dts_count);
+		m2 += copy.dts_m2 + delta * delta * n * copy.dts_count / (n + copy.dts_count);
+		n += copy.dts_count;
+	}
+
+	stats->sample_size = n;
+	stats->mean = mean;
+	stats->sum_of_squares = m2 + n * mean * mean;
+	stats->std_dev = n < 2 ? 0 : sqrtl(m2 / (n - 1));
+}
+
+/**
+ * Bucket of \a value in a HDR histogram, see D_TM_HDR_SUB_BITS: the bucket
+ * index is made of the position of the most significant bit of the value and
+ * the \a sub_bits following bits.
+ */
+static inline uint32_t
+hdr_index(uint32_t sub_bits, uint32_t nr, uint64_t value)
+{
+	uint64_t	idx;
+	int		shift;
+
+	if (value < (1ULL << sub_bits))
+		return value;
+
+	shift = 63 - __builtin_clzll(value) - sub_bits;
+	idx = ((uint64_t)shift << sub_bits) + (value >> shift);
+
+	return idx < nr ? idx : nr - 1;
+}
+
+/** Lowest value of the HDR histogram bucket \a idx */
+static inline uint64_t
+hdr_lowest(uint32_t sub_bits, uint32_t idx)
+{
+	uint32_t	shift = idx >> sub_bits;
+
+	if (shift <= 1)
+		return idx;
+
+	shift--;
+	return (uint64_t)(idx - (shift << sub_bits)) << shift;
+}
+
+/** Highest value of the HDR histogram bucket \a idx */
+static inline uint64_t
+hdr_highest(uint32_t sub_bits, uint32_t idx)
+{
+	uint32_t	shift = idx >> sub_bits;
+
+	if (shift <= 1)
+		return idx;
+
+	shift--;
+	return ((uint64_t)(idx - (shift << sub_bits) + 1) << shift) - 1;
+}
+
+/**
+ * Record the \a value into the HDR histogram. It takes constant time and no
+ * lock, so the histogram can be updated by several threads.
+ *
+ * \param[in,out]	metric	Pointer to the metric
+ * \param[in]		value	The value to record
+ */
+void
+d_tm_record_hdr(struct d_tm_node_t *metric, uint64_t value)
+{
+	struct d_tm_hdr_t	*hdr;
+	uint64_t		 cur;
+	uint32_t		 idx;
+
+	if (metric == NULL)
+		return;
+
+	if (metric->dtn_type != D_TM_HDR_HISTOGRAM) {
+		D_ERROR("Failed to record value on item %s not a histogram.  "
+			"Operation mismatch: " DF_RC "\n",
+			metric->dtn_name, DP_RC(-DER_OP_NOT_PERMITTED));
+		return;
+	}
+
+	hdr = metric->dtn_metric->dtm_hdr;
+	idx = hdr_index(hdr->dth_sub_bits, hdr->dth_nr, value);
+	__atomic_fetch_add(&hdr->dth_buckets[idx], 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&hdr->dth_count, 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&hdr->dth_sum, value, __ATOMIC_RELAXED);
+
+	cur = __atomic_load_n(&hdr->dth_min, __ATOMIC_RELAXED);
+	while (value < cur &&
+	       !__atomic_compare_exchange_n(&hdr->dth_min, &cur, value, true,
+					    __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+		;
+
+	cur = __atomic_load_n(&hdr->dth_max, __ATOMIC_RELAXED);
+	while (value > cur &&
+	       !__atomic_compare_exchange_n(&hdr->dth_max, &cur, value, true,
+					    __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+		;
+}
+
 /**
  * Computes the histogram for this metric by finding the bucket that corresponds
  * to the \a value given, and increments the counter for that bucket.
@@ -1728,6 +2175,13 @@ d_tm_set_counter(struct d_tm_node_t *metric, uint64_t value)
 		return;
 	}
 
+	/* The other threads keep adding to their slots of a sharded counter */
+	if (unlikely(metric->dtn_metric->dtm_shards != NULL)) {
+		D_ERROR("Failed to set sharded counter [%s]: " DF_RC "\n",
+			metric->dtn_name, DP_RC(-DER_OP_NOT_PERMITTED));
+		return;
+	}
+
 	d_tm_node_lock(metric);
 	metric->dtn_metric->dtm_data.value = value;
 	d_tm_node_unlock(metric);
@@ -1742,6 +2196,8 @@ d_tm_set_counter(struct d_tm_node_t *metric, uint64_t value)
 void
 d_tm_inc_counter(struct d_tm_node_t *metric, uint64_t value)
 {
+	struct d_tm_shard_t	*shard;
+
 	if (unlikely(metric == NULL))
 		return;
 
@@ -1751,6 +2207,13 @@ d_tm_inc_counter(struct d_tm_node_t *metric, uint64_t value)
 		return;
 	}
 
+	shard = shard_get(metric);
+	if (shard != NULL) {
+		__atomic_store_n(&shard->dts_value, shard->dts_value + value,
+				 __ATOMIC_RELAXED);
+		return;
+	}
+
 	d_tm_node_lock(metric);
 	metric->dtn_metric->dtm_data.value += value;
 	d_tm_node_unlock(metric);
@@ -1925,12 +2388,17 @@ has_stats(struct d_tm_node_t *metric)
 /**
  * Set an arbitrary \a value for the gauge.
  *
+ * The value of a sharded gauge is the last one set by any thread, while the
+ * statistics of the samples are kept in the slot of the calling thread.
+ *
  * \param[in,out]	metric	Pointer to the metric
  * \param[in]		value	Set the gauge to this value
  */
 void
 d_tm_set_gauge(struct d_tm_node_t *metric, uint64_t value)
 {
+	struct d_tm_shard_t	*shard;
+
 	if (metric == NULL)
 		return;
 
@@ -1941,6 +2409,16 @@ d_tm_set_gauge(struct d_tm_node_t *metric, uint64_t value)
 		return;
 	}
 
+	shard = shard_get(metric);
+	if (shard != NULL) {
+		__atomic_store_n(&metric->dtn_metric->dtm_data.value, value, __ATOMIC_RELAXED);
+		shard_write_begin(shard);
+		shard_compute_stats(shard, value);
+		shard_write_end(shard);
+		d_tm_compute_histogram(metric, value);
+		return;
+	}
+
 	d_tm_node_lock(metric);
 	metric->dtn_metric->dtm_data.value = value;
 	if (has_stats(metric)) {
@@ -2117,9 +2595,23 @@ add_metric(struct d_tm_context *ctx, struct d_tm_node_t **node, int metric_type,
 	char			*token;
 	char			*rest;
 	char			*unit_string;
+	bool			sharded;
 	int			buff_len;
 	int			rc = 0;
 
+	sharded = metric_type & D_TM_SHARDED;
+	metric_type &= ~D_TM_SHARDED;
+	/**
+	 * The value of a plain gauge goes up and down on any thread, it cannot be
+	 * split in per-thread slots. A stats gauge only shards the statistics of
+	 * its samples, see d_tm_set_gauge().
+	 */
+	if (sharded && metric_type != D_TM_COUNTER && metric_type != D_TM_STATS_GAUGE) {
+		D_ERROR("Only counters and stats gauges can be sharded\n");
+		rc = -DER_INVAL;
+		goto out;
+	}
+
 	rest = path;
 	parent_node = d_tm_get_root(ctx);
 	token = strtok_r(rest, "/", &rest);
@@ -2165,6 +2657,44 @@ add_metric(struct d_tm_context *ctx, struct d_tm_node_t **node, int metric_type,
 		}
 	}
 
+	temp->dtn_metric->dtm_shards = NULL;
+	temp->dtn_metric->dtm_shard_nr = 0;
+	if (sharded && tm_shmem.shard_nr > 0) {
+		size_t	align = __alignof__(struct d_tm_shard_t);
+		void	*shards;
+
+		/** Each slot is on its own cache line */
+		shards = shmalloc(shmem, tm_shmem.shard_nr * sizeof(struct d_tm_shard_t) +
+				  align);
+		if (shards == NULL) {
+			rc = -DER_NO_SHMEM;
+			goto out;
+		}
+		temp->dtn_metric->dtm_shards = (void *)(((uintptr_t)shards + align - 1) &
+							~(uintptr_t)(align - 1));
+		temp->dtn_metric->dtm_shard_nr = tm_shmem.shard_nr;
+	}
+
+	temp->dtn_metric->dtm_hdr = NULL;
+	if (metric_type == D_TM_HDR_HISTOGRAM) {
+		struct d_tm_hdr_t	*hdr;
+
+		hdr = shmalloc(shmem, sizeof(struct d_tm_hdr_t));
+		if (hdr == NULL) {
+			rc = -DER_NO_SHMEM;
+			goto out;
+		}
+		hdr->dth_buckets = shmalloc(shmem, D_TM_HDR_BUCKETS * sizeof(uint64_t));
+		if (hdr->dth_buckets == NULL) {
+			rc = -DER_NO_SHMEM;
+			goto out;
+		}
+		hdr->dth_sub_bits = D_TM_HDR_SUB_BITS;
+		hdr->dth_nr = D_TM_HDR_BUCKETS;
+		hdr->dth_min = UINT64_MAX;
+		temp->dtn_metric->dtm_hdr = hdr;
+	}
+
 	buff_len = 0;
 	if (desc != NULL)
 		buff_len = strnlen(desc, D_TM_MAX_DESC_LEN);
@@ -2268,8 +2798,24 @@ out:
  * time in order to avoid the overhead of creating the metric at a more
  * critical time.
  *
+ * A counter or a stats gauge that is updated by many threads can be created
+ * with the D_TM_SHARDED flag in \a metric_type: each thread then updates its
+ * own cache line aligned slot without locking, and the slots are merged when
+ * the metric is read. The value of a sharded counter is the sum of the slots
+ * and it cannot be set. The value of a sharded stats gauge is the last one set
+ * while its statistics cover the samples of all threads, d_tm_inc_gauge() and
+ * d_tm_dec_gauge() update it under its lock. Other metric types cannot be
+ * sharded. The number of slots is set by d_tm_set_shards() or the D_TM_SHARDS
+ * environment variable (16 by default), further threads update the metric as a
+ * regular one.
+ *
+ * A D_TM_HDR_HISTOGRAM keeps the distribution of the recorded values in
+ * log-linear buckets (see D_TM_HDR_SUB_BITS), its percentiles are computed
+ * by the readers with a bounded relative error.
+ *
  * \param[out]	node		Points to the new metric if supplied
- * \param[in]	metric_type	One of the corresponding d_tm_metric_types
+ * \param[in]	metric_type	One of the corresponding d_tm_metric_types,
+ *				optionally with D_TM_SHARDED
  * \param[in]	desc		A description of the metric containing
  *				D_TM_MAX_DESC_LEN - 1 characters maximum
  * \param[in]	units		A string defining the units of the metric
@@ -2810,7 +3356,9 @@ d_tm_init_histogram(struct d_tm_node_t *node, char *path, int num_buckets,
 		dth_buckets[i].dtb_min = min;
 		dth_buckets[i].dtb_max = max;
 
-		rc = d_tm_add_metric(&dth_buckets[i].dtb_bucket, D_TM_COUNTER,
+		/** The buckets of a sharded metric are sharded as well */
+		rc = d_tm_add_metric(&dth_buckets[i].dtb_bucket,
+				     D_TM_COUNTER | (metric->dtm_shards ? D_TM_SHARDED : 0),
 				     meta_data, "elements", fullpath);
 		D_FREE(fullpath);
 		D_FREE(meta_data);
@@ -3002,6 +3550,16 @@ d_tm_get_counter(struct d_tm_context *ctx, uint64_t *val,
 	d_tm_node_lock(node);
 	*val = metric_data->dtm_data.value;
 	d_tm_node_unlock(node);
+
+	if (metric_data->dtm_shards != NULL) {
+		struct d_tm_shard_t	*shards = metric_data->dtm_shards;
+
+		if (ctx != NULL)
+			shards = conv_ptr(shmem, shards);
+		if (shards == NULL)
+			return -DER_METRIC_NOT_FOUND;
+		shards_merge(shards, metric_data->dtm_shard_nr, val);
+	}
 	return DER_SUCCESS;
 }
 
@@ -3075,6 +3633,297 @@ d_tm_get_meminfo(struct d_tm_context *ctx, struct d_tm_meminfo_t *meminfo,
 	return DER_SUCCESS;
 }
 
+/** Set the layout of \a snap and clear it, the buckets are reused if possible */
+static int
+hdr_snap_init(struct d_tm_hdr_snap_t *snap, uint32_t sub_bits, uint32_t nr)
+{
+	if (snap->dhs_buckets != NULL && snap->dhs_nr == nr) {
+		memset(snap->dhs_buckets, 0, nr * sizeof(*snap->dhs_buckets));
+	} else {
+		D_FREE(snap->dhs_buckets);
+		D_ALLOC_ARRAY(snap->dhs_buckets, nr);
+		if (snap->dhs_buckets == NULL)
+			return -DER_NOMEM;
+	}
+
+	snap->dhs_sub_bits = sub_bits;
+	snap->dhs_nr = nr;
+	snap->dhs_count = 0;
+	snap->dhs_sum = 0;
+	snap->dhs_min = 0;
+	snap->dhs_max = 0;
+	return 0;
+}
+
+/**
+ * Bound the min and max of \a snap by its lowest and highest non-empty
+ * buckets, they are unknown for the samples between two snapshots.
+ */
+static void
+hdr_snap_bound(struct d_tm_hdr_snap_t *snap)
+{
+	uint32_t	lo;
+	uint32_t	hi;
+
+	if (snap->dhs_count == 0) {
+		snap->dhs_min = 0;
+		snap->dhs_max = 0;
+		return;
+	}
+
+	for (lo = 0; lo < snap->dhs_nr - 1 && snap->dhs_buckets[lo] == 0; lo++)
+		;
+	for (hi = snap->dhs_nr - 1; hi > lo && snap->dhs_buckets[hi] == 0; hi--)
+		;
+
+	snap->dhs_min = max(snap->dhs_min, hdr_lowest(snap->dhs_sub_bits, lo));
+	/** The last bucket has no upper bound */
+	if (hi < snap->dhs_nr - 1)
+		snap->dhs_max = min(snap->dhs_max, hdr_highest(snap->dhs_sub_bits, hi));
+}
+
+/** Copy the histogram \a hdr with the buckets \a buckets into \a snap */
+static int
+hdr_snap_load(struct d_tm_hdr_snap_t *snap, struct d_tm_hdr_t *hdr, uint64_t *buckets)
+{
+	uint32_t	i;
+	int		rc;
+
+	rc = hdr_snap_init(snap, hdr->dth_sub_bits, hdr->dth_nr);
+	if (rc != 0)
+		return rc;
+
+	/** The count is the sum of the buckets, for consistent percentiles */
+	for (i = 0; i < snap->dhs_nr; i++) {
+		snap->dhs_buckets[i] = __atomic_load_n(&buckets[i], __ATOMIC_RELAXED);
+		snap->dhs_count += snap->dhs_buckets[i];
+	}
+	snap->dhs_sum = __atomic_load_n(&hdr->dth_sum, __ATOMIC_RELAXED);
+	snap->dhs_min = __atomic_load_n(&hdr->dth_min, __ATOMIC_RELAXED);
+	snap->dhs_max = __atomic_load_n(&hdr->dth_max, __ATOMIC_RELAXED);
+	/** Racing with the writers */
+	if (snap->dhs_min > snap->dhs_max)
+		snap->dhs_min = 0;
+	hdr_snap_bound(snap);
+
+	return DER_SUCCESS;
+}
+
+/**
+ * Client function to take a snapshot of the HDR histogram. The buckets of
+ * \a snap are allocated by the first call and reused by the next ones, they
+ * must be released by d_tm_hdr_snap_fini(). \a snap must be zeroed before
+ * the first call.
+ *
+ * \param[in]	ctx	Client context
+ * \param[out]	snap	The snapshot of the histogram
+ * \param[in]	node	Pointer to the stored metric node
+ *
+ * \return	DER_SUCCESS		Success
+ *		-DER_INVAL		Invalid input
+ *		-DER_NOMEM		Out of memory
+ *		-DER_METRIC_NOT_FOUND	Metric not found
+ *		-DER_OP_NOT_PERMITTED	Metric was not a HDR histogram
+ */
+int
+d_tm_get_hdr(struct d_tm_context *ctx, struct d_tm_hdr_snap_t *snap,
+	     struct d_tm_node_t *node)
+{
+	struct d_tm_metric_t	*metric_data = NULL;
+	struct d_tm_shmem_hdr	*shmem = NULL;
+	struct d_tm_hdr_t	*hdr = NULL;
+	uint64_t		*buckets = NULL;
+	int			 rc;
+
+	if (ctx == NULL || snap == NULL || node == NULL)
+		return -DER_INVAL;
+
+	rc = validate_node_ptr(ctx, node, &shmem);
+	if (rc != 0)
+		return rc;
+
+	if (node->dtn_type != D_TM_HDR_HISTOGRAM)
+		return -DER_OP_NOT_PERMITTED;
+
+	metric_data = conv_ptr(shmem, node->dtn_metric);
+	if (metric_data != NULL)
+		hdr = conv_ptr(shmem, metric_data->dtm_hdr);
+	if (hdr != NULL)
+		buckets = conv_ptr(shmem, hdr->dth_buckets);
+	if (buckets == NULL)
+		return -DER_METRIC_NOT_FOUND;
+
+	return hdr_snap_load(snap, hdr, buckets);
+}
+
+/**
+ * Server function to take a snapshot of one of its own HDR histograms, e.g.
+ * to adjust a feedback controller on the recorded latencies. See
+ * d_tm_get_hdr() for the usage of \a snap.
+ *
+ * \param[in]	metric	Pointer to the metric
+ * \param[out]	snap	The snapshot of the histogram
+ *
+ * \return	DER_SUCCESS		Success
+ *		-DER_INVAL		Invalid input
+ *		-DER_NOMEM		Out of memory
+ *		-DER_OP_NOT_PERMITTED	Metric was not a HDR histogram
+ */
+int
+d_tm_snap_hdr(struct d_tm_node_t *metric, struct d_tm_hdr_snap_t *snap)
+{
+	struct d_tm_hdr_t	*hdr;
+
+	if (metric == NULL || snap == NULL)
+		return -DER_INVAL;
+
+	if (metric->dtn_type != D_TM_HDR_HISTOGRAM)
+		return -DER_OP_NOT_PERMITTED;
+
+	hdr = metric->dtn_metric->dtm_hdr;
+	return hdr_snap_load(snap, hdr, hdr->dth_buckets);
+}
+
+/**
+ * Release the buckets of a snapshot taken by d_tm_get_hdr().
+ *
+ * \param[in]	snap	The snapshot of the histogram
+ */
+void
+d_tm_hdr_snap_fini(struct d_tm_hdr_snap_t *snap)
+{
+	if (snap == NULL)
+		return;
+
+	D_FREE(snap->dhs_buckets);
+	memset(snap, 0, sizeof(*snap));
+}
+
+/**
+ * Add the samples of \a src into \a dst, e.g. to aggregate the histograms of
+ * several targets. \a dst gets the layout of \a src if it is empty (zeroed).
+ *
+ * \param[in,out]	dst	The merged snapshot
+ * \param[in]		src	The snapshot to merge
+ *
+ * \return		DER_SUCCESS		Success
+ *			-DER_INVAL		Invalid input, or the layouts
+ *						of the histograms differ
+ *			-DER_NOMEM		Out of memory
+ */
+int
+d_tm_hdr_merge(struct d_tm_hdr_snap_t *dst, struct d_tm_hdr_snap_t *src)
+{
+	uint32_t	i;
+	int		rc;
+
+	if (dst == NULL || src == NULL || src->dhs_buckets == NULL)
+		return -DER_INVAL;
+
+	if (dst->dhs_buckets == NULL) {
+		rc = hdr_snap_init(dst, src->dhs_sub_bits, src->dhs_nr);
+		if (rc != 0)
+			return rc;
+	} else if (dst->dhs_sub_bits != src->dhs_sub_bits ||
+		   dst->dhs_nr != src->dhs_nr) {
+		return -DER_INVAL;
+	}
+
+	if (src->dhs_count == 0)
+		return DER_SUCCESS;
+
+	for (i = 0; i < dst->dhs_nr; i++)
+		dst->dhs_buckets[i] += src->dhs_buckets[i];
+
+	if (dst->dhs_count == 0 || src->dhs_min < dst->dhs_min)
+		dst->dhs_min = src->dhs_min;
+	if (src->dhs_max > dst->dhs_max)
+		dst->dhs_max = src->dhs_max;
+	dst->dhs_sum += src->dhs_sum;
+	dst->dhs_count += src->dhs_count;
+
+	return DER_SUCCESS;
+}
+
+/**
+ * Remove the samples of the older snapshot \a prev from \a snap, so it only
+ * has the samples recorded between the two snapshots. \a snap is unchanged
+ * if the histogram was reset in between.
+ *
+ * \param[in,out]	snap	The newer snapshot
+ * \param[in]		prev	The older snapshot of the same histogram
+ *
+ * \return		DER_SUCCESS		Success
+ *			-DER_INVAL		Invalid input, or the layouts
+ *						of the histograms differ
+ */
+int
+d_tm_hdr_diff(struct d_tm_hdr_snap_t *snap, struct d_tm_hdr_snap_t *prev)
+{
+	uint32_t	i;
+
+	if (snap == NULL || prev == NULL || snap->dhs_buckets == NULL ||
+	    prev->dhs_buckets == NULL)
+		return -DER_INVAL;
+
+	if (snap->dhs_sub_bits != prev->dhs_sub_bits || snap->dhs_nr != prev->dhs_nr)
+		return -DER_INVAL;
+
+	if (snap->dhs_sum < prev->dhs_sum)
+		return DER_SUCCESS;
+	for (i = 0; i < snap->dhs_nr; i++) {
+		if (snap->dhs_buckets[i] < prev->dhs_buckets[i])
+			return DER_SUCCESS;
+	}
+
+	snap->dhs_count = 0;
+	for (i = 0; i < snap->dhs_nr; i++) {
+		snap->dhs_buckets[i] -= prev->dhs_buckets[i];
+		snap->dhs_count += snap->dhs_buckets[i];
+	}
+	snap->dhs_sum -= prev->dhs_sum;
+	hdr_snap_bound(snap);
+
+	return DER_SUCCESS;
+}
+
+/**
+ * Compute the percentile \a pct of the samples of \a snap. The result is the
+ * highest value of the bucket of the percentile, hence its relative error is
+ * bounded by the layout of the histogram, see D_TM_HDR_SUB_BITS.
+ *
+ * \param[in]	snap	The snapshot of the histogram
+ * \param[in]	pct	The percentile (0 - 100)
+ *
+ * \return		The value of the percentile, 0 if there is no sample
+ */
+uint64_t
+d_tm_hdr_percentile(struct d_tm_hdr_snap_t *snap, double pct)
+{
+	uint64_t	rank;
+	uint64_t	cnt = 0;
+	uint64_t	val;
+	uint32_t	i;
+
+	if (snap == NULL || snap->dhs_count == 0)
+		return 0;
+
+	pct = min(max(pct, 0.0), 100.0);
+	rank = max((uint64_t)ceil(pct * snap->dhs_count / 100), 1);
+
+	for (i = 0; i < snap->dhs_nr - 1; i++) {
+		cnt += snap->dhs_buckets[i];
+		if (cnt >= rank)
+			break;
+	}
+
+	val = hdr_highest(snap->dhs_sub_bits, i);
+	if (i == snap->dhs_nr - 1 || val > snap->dhs_max)
+		val = snap->dhs_max;
+
+	return max(val, snap->dhs_min);
+}
+
 
 /**
  * Client function to read the specified high resolution timer.
@@ -3246,6 +4095,16 @@ d_tm_get_gauge(struct d_tm_context *ctx, uint64_t *val,
 	} else {
 		return -DER_METRIC_NOT_FOUND;
 	}
+
+	if (metric_data->dtm_shards != NULL && has_stats(node) && stats != NULL &&
+	    dtm_stats != NULL) {
+		struct d_tm_shard_t	*shards;
+
+		shards = conv_ptr(shmem, metric_data->dtm_shards);
+		if (shards == NULL)
+			return -DER_METRIC_NOT_FOUND;
+		shards_merge_stats(shards, metric_data->dtm_shard_nr, stats);
+	}
 	return DER_SUCCESS;
 }
 
@@ -3608,9 +4467,51 @@ d_tm_close(struct d_tm_context **ctx)
 		return;
 
 	close_all_shmem(*ctx, false);
+	hdr_prev_free(*ctx);
+	D_FREE((*ctx)->hdr_pcts);
 	D_FREE(*ctx);
 }
 
+/**
+ * Set how d_tm_print_node() shows the HDR histograms with this context.
+ *
+ * \param[in]	ctx		Client context
+ * \param[in]	pcts		The percentiles to show (0 - 100), NULL for the
+ *				default p50, p90, p99 and p99.9
+ * \param[in]	pct_nr		Number of \a pcts
+ * \param[in]	interval	Show the samples recorded since the previous
+ *				print of the histogram instead of all of them
+ *
+ * \return	DER_SUCCESS		Success
+ *		-DER_INVAL		Invalid input
+ *		-DER_NOMEM		Out of memory
+ */
+int
+d_tm_set_hdr_view(struct d_tm_context *ctx, double *pcts, int pct_nr,
+		  bool interval)
+{
+	double	*copy = NULL;
+
+	if (ctx == NULL || (pcts != NULL && pct_nr <= 0))
+		return -DER_INVAL;
+
+	if (pcts != NULL) {
+		D_ALLOC_ARRAY(copy, pct_nr);
+		if (copy == NULL)
+			return -DER_NOMEM;
+		memcpy(copy, pcts, pct_nr * sizeof(*pcts));
+	}
+
+	D_FREE(ctx->hdr_pcts);
+	ctx->hdr_pcts = copy;
+	ctx->hdr_pct_nr = pct_nr;
+	ctx->hdr_interval = interval;
+	if (!interval)
+		hdr_prev_free(ctx);
+
+	return DER_SUCCESS;
+}
+
 /**
  * Releases deleted resources cached by the context.
  *
@@ -1,5 +1,5 @@
 /*
- * (C) Copyright 2020-2022 Intel Corporation.
+ * (C) Copyright 2020-2023 Intel Corporation.
  *
  * SPDX-License-Identifier: BSD-2-Clause-Patent
  */
@@ -11,6 +11,7 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <pthread.h>
+#include <math.h>
 #include <sys/ipc.h>
 #include <sys/shm.h>
 #include <daos/tests_lib.h>
@@ -271,6 +272,198 @@ test_gauge_stats(void **state)
 	assert_int_equal(stats.std_dev, 0);
 }
 
+#define SHARD_THREADS	8
+#define SHARD_LOOPS	1000
+
+struct shard_arg {
+	struct d_tm_node_t	*counter;
+	struct d_tm_node_t	*gauge;
+	int			 id;
+};
+
+static void *
+shard_thread(void *data)
+{
+	struct shard_arg	*arg = data;
+	int			 i;
+
+	for (i = 0; i < SHARD_LOOPS; i++) {
+		d_tm_inc_counter(arg->counter, 1);
+		d_tm_set_gauge(arg->gauge, arg->id * 100 + i % 50);
+	}
+
+	return NULL;
+}
+
+static void
+test_sharded_metrics(void **state)
+{
+	struct shard_arg	args[SHARD_THREADS];
+	pthread_t		threads[SHARD_THREADS];
+	struct d_tm_node_t	*counter;
+	struct d_tm_node_t	*gauge;
+	struct d_tm_node_t	*node;
+	struct d_tm_stats_t	stats = { 0 };
+	double			mean = 0;
+	double			sq = 0;
+	uint64_t		val;
+	int			rc;
+	int			i;
+	int			j;
+
+	rc = d_tm_add_metric(&counter, D_TM_COUNTER | D_TM_SHARDED, NULL, NULL,
+			     "gurt/tests/telem/sharded-counter");
+	assert_rc_equal(rc, 0);
+
+	rc = d_tm_add_metric(&gauge, D_TM_STATS_GAUGE | D_TM_SHARDED, NULL, NULL,
+			     "gurt/tests/telem/sharded-stats-gauge");
+	assert_rc_equal(rc, 0);
+
+	/* The value of a plain gauge cannot be split in slots */
+	rc = d_tm_add_metric(&node, D_TM_GAUGE | D_TM_SHARDED, NULL, NULL,
+			     "gurt/tests/telem/sharded-gauge");
+	assert_rc_equal(rc, -DER_INVAL);
+
+	rc = d_tm_add_metric(&node, D_TM_DURATION | D_TM_SHARDED, NULL, NULL,
+			     "gurt/tests/telem/sharded-duration");
+	assert_rc_equal(rc, -DER_INVAL);
+
+	for (i = 0; i < SHARD_THREADS; i++) {
+		args[i].counter = counter;
+		args[i].gauge = gauge;
+		args[i].id = i;
+		rc = pthread_create(&threads[i], NULL, shard_thread, &args[i]);
+		assert_int_equal(rc, 0);
+	}
+
+	/* The main thread has a slot of its own as well */
+	d_tm_inc_counter(counter, 1);
+
+	for (i = 0; i < SHARD_THREADS; i++)
+		pthread_join(threads[i], NULL);
+
+	/* A sharded counter cannot be set, the slots of the threads are kept */
+	d_tm_set_counter(counter, 0);
+
+	rc = d_tm_get_counter(cli_ctx, &val, srv_to_cli_node(counter));
+	assert_rc_equal(rc, DER_SUCCESS);
+	assert_int_equal(val, SHARD_THREADS * SHARD_LOOPS + 1);
+
+	rc = d_tm_get_gauge(cli_ctx, &val, &stats, srv_to_cli_node(gauge));
+	assert_rc_equal(rc, DER_SUCCESS);
+
+	/* The value is the last one set by any thread */
+	assert_int_equal(val % 100, (SHARD_LOOPS - 1) % 50);
+	assert_true(val / 100 < SHARD_THREADS);
+
+	for (i = 0; i < SHARD_THREADS; i++)
+		for (j = 0; j < SHARD_LOOPS; j++)
+			mean += i * 100 + j % 50;
+	mean /= SHARD_THREADS * SHARD_LOOPS;
+	for (i = 0; i < SHARD_THREADS; i++)
+		for (j = 0; j < SHARD_LOOPS; j++)
+			sq += (i * 100 + j % 50 - mean) * (i * 100 + j % 50 - mean);
+
+	/* The statistics cover the samples of all threads */
+	assert_int_equal(stats.sample_size, SHARD_THREADS * SHARD_LOOPS);
+	assert_int_equal(stats.dtm_min, 0);
+	assert_int_equal(stats.dtm_max, (SHARD_THREADS - 1) * 100 + 49);
+	assert_true(fabs(stats.mean - mean) < STATS_EPSILON);
+	assert_true(fabs(stats.std_dev - sqrt(sq / (SHARD_THREADS * SHARD_LOOPS - 1))) <
+		    STATS_EPSILON);
+
+	/* The samples of the locked path are merged with the slots */
+	d_tm_inc_gauge(gauge, 1);
+	rc = d_tm_get_gauge(cli_ctx, &val, &stats, srv_to_cli_node(gauge));
+	assert_rc_equal(rc, DER_SUCCESS);
+	assert_int_equal(stats.sample_size, SHARD_THREADS * SHARD_LOOPS + 1);
+}
+
+/* The percentiles are the highest value of their bucket */
+#define assert_hdr_pct(val, exp)						\
+	do {									\
+		assert_true((val) >= (exp));					\
+		assert_true((val) <= (exp) + ((exp) >> D_TM_HDR_SUB_BITS));	\
+	} while (0)
+
+static void
+test_hdr_histogram(void **state)
+{
+	struct d_tm_hdr_snap_t	snap = {0};
+	struct d_tm_hdr_snap_t	prev = {0};
+	struct d_tm_hdr_snap_t	merged = {0};
+	struct d_tm_node_t	*hdr;
+	uint64_t		i;
+	int			rc;
+
+	rc = d_tm_add_metric(&hdr, D_TM_HDR_HISTOGRAM, "HDR histogram", "us",
+			     "gurt/tests/telem/hdr-histogram");
+	assert_rc_equal(rc, 0);
+
+	for (i = 1; i <= 10000; i++)
+		d_tm_record_hdr(hdr, i);
+
+	rc = d_tm_get_hdr(cli_ctx, &prev, srv_to_cli_node(hdr));
+	assert_rc_equal(rc, DER_SUCCESS);
+	assert_int_equal(prev.dhs_count, 10000);
+	assert_int_equal(prev.dhs_sum, 50005000);
+	assert_int_equal(prev.dhs_min, 1);
+	assert_int_equal(prev.dhs_max, 10000);
+
+	/* Small values are exact */
+	assert_int_equal(d_tm_hdr_percentile(&prev, 0), 1);
+	assert_int_equal(d_tm_hdr_percentile(&prev, 0.1), 10);
+	assert_hdr_pct(d_tm_hdr_percentile(&prev, 50), 5000);
+	assert_hdr_pct(d_tm_hdr_percentile(&prev, 90), 9000);
+	assert_hdr_pct(d_tm_hdr_percentile(&prev, 99), 9900);
+	assert_int_equal(d_tm_hdr_percentile(&prev, 100), 10000);
+
+	/* Beyond the range of the buckets */
+	for (i = 0; i < 1000; i++)
+		d_tm_record_hdr(hdr, 100000);
+	d_tm_record_hdr(hdr, 1ULL << 40);
+
+	rc = d_tm_get_hdr(cli_ctx, &snap, srv_to_cli_node(hdr));
+	assert_rc_equal(rc, DER_SUCCESS);
+	assert_int_equal(snap.dhs_count, 11001);
+	assert_int_equal(d_tm_hdr_percentile(&snap, 100), 1ULL << 40);
+
+	/* Only the samples since the previous snapshot */
+	rc = d_tm_hdr_diff(&snap, &prev);
+	assert_rc_equal(rc, DER_SUCCESS);
+	assert_int_equal(snap.dhs_count, 1001);
+	assert_int_equal(snap.dhs_max, 1ULL << 40);
+	assert_true(snap.dhs_min <= 100000);
+	assert_true(snap.dhs_min >= 100000 - (100000 >> D_TM_HDR_SUB_BITS));
+	assert_hdr_pct(d_tm_hdr_percentile(&snap, 50), 100000);
+
+	rc = d_tm_hdr_merge(&merged, &prev);
+	assert_rc_equal(rc, DER_SUCCESS);
+	rc = d_tm_hdr_merge(&merged, &snap);
+	assert_rc_equal(rc, DER_SUCCESS);
+	assert_int_equal(merged.dhs_count, 11001);
+	assert_int_equal(merged.dhs_min, 1);
+	assert_int_equal(merged.dhs_max, 1ULL << 40);
+	assert_hdr_pct(d_tm_hdr_percentile(&merged, 50), 5500);
+
+	d_tm_print_hdr(&merged, NULL, 0, "hdr-histogram", D_TM_STANDARD, "us",
+		       D_TM_INCLUDE_TYPE, stdout);
+	printf("\n");
+
+	rc = d_tm_get_hdr(cli_ctx, &snap, d_tm_find_metric(cli_ctx, "gurt/tests/telem"));
+	assert_rc_equal(rc, -DER_OP_NOT_PERMITTED);
+
+	/* The producer reads its own histogram */
+	rc = d_tm_snap_hdr(hdr, &snap);
+	assert_rc_equal(rc, DER_SUCCESS);
+	assert_int_equal(snap.dhs_count, 11001);
+	assert_int_equal(d_tm_hdr_percentile(&snap, 100), 1ULL << 40);
+
+	d_tm_hdr_snap_fini(&snap);
+	d_tm_hdr_snap_fini(&prev);
+	d_tm_hdr_snap_fini(&merged);
+}
+
 static void
 test_duration_stats(void **state)
 {
@@ -1187,12 +1380,13 @@ test_verify_object_count(void **state)
 {
 	struct d_tm_node_t	*node;
 	int			num;
-	int			exp_num_ctr = 20;
+	int			exp_num_ctr = 21;
 	int			exp_num_gauge = 3;
-	int			exp_num_gauge_stats = 3;
+	int			exp_num_gauge_stats = 4;
 	int			exp_num_dur = 2;
 	int			exp_num_timestamp = 2;
 	int			exp_num_snap = 2;
+	int			exp_num_hdr = 1;
 	int			exp_total;
 
 	exp_total = exp_num_ctr + exp_num_gauge + exp_num_dur +
@@ -1220,6 +1414,9 @@ test_verify_object_count(void **state)
 	num = d_tm_count_metrics(cli_ctx, node, D_TM_TIMER_SNAPSHOT);
 	assert_int_equal(num, exp_num_snap);
 
+	num = d_tm_count_metrics(cli_ctx, node, D_TM_HDR_HISTOGRAM);
+	assert_int_equal(num, exp_num_hdr);
+
 	num = d_tm_count_metrics(cli_ctx, node,
 				 D_TM_COUNTER | D_TM_GAUGE | D_TM_DURATION |
 				 D_TM_TIMESTAMP | D_TM_TIMER_SNAPSHOT);
@@ -1352,6 +1549,8 @@ main(int argc, char **argv)
 		cmocka_unit_test(test_record_timestamp),
 		cmocka_unit_test(test_interval_timer),
 		cmocka_unit_test(test_gauge_stats),
+		cmocka_unit_test(test_sharded_metrics),
+		cmocka_unit_test(test_hdr_histogram),
 		cmocka_unit_test(test_duration_stats),
 		cmocka_unit_test(test_gauge_with_histogram_multiplier_1),
 		cmocka_unit_test(test_gauge_with_histogram_multiplier_2),
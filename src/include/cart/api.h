@@ -460,6 +460,22 @@ crt_req_dst_tag_get(crt_rpc_t *req, uint32_t *tag);
 int
 crt_req_src_timeout_get(crt_rpc_t *rpc, uint16_t *timeout);
 
+/**
+ * Return the time when the request was handed to the customized RPC
+ * callback (see crt_context_register_rpc_task()), which is the start of the
+ * queueing time before the RPC handler runs.
+ *
+ * \param[in] rpc              Pointer to RPC request
+ * \param[out] ts              Returned time stamp in nanoseconds, in the
+ *                             clock of d_gettime()
+ *
+ * \return                     DER_SUCCESS on success, -DER_NONEXIST if the
+ *                             request was not queued by the callback, or
+ *                             other error on failure
+ */
+int
+crt_req_arrive_time_get(crt_rpc_t *rpc, uint64_t *ts);
+
 /**
  * Return reply buffer
  *
@@ -1061,7 +1077,14 @@ enum crt_tree_type {
 	CRT_TREE_FLAT		= 1,
 	CRT_TREE_KARY		= 2,
 	CRT_TREE_KNOMIAL	= 3,
-	CRT_TREE_MAX		= 3,
+	/*
+	 * Fault domain aware tree, ranks in the same domain (set via
+	 * crt_group_domains_set) form the inner levels, a k-nomial tree is
+	 * used among the sibling domains at each level. Same as k-nomial tree
+	 * if the group has no fault domain information.
+	 */
+	CRT_TREE_DOMAIN		= 4,
+	CRT_TREE_MAX		= 4,
 };
 
 #define CRT_TREE_TYPE_SHIFT	(16U)
@@ -1073,7 +1096,7 @@ enum crt_tree_type {
  *
  * \param[in] tree_type        tree type
  * \param[in] branch_ratio     branch ratio, be ignored for CRT_TREE_FLAT.
- *                             for KNOMIAL tree or KARY tree, the valid value
+ *                             for KNOMIAL, KARY or DOMAIN tree, the valid value
  *                             should within the range of
  *                             [CRT_TREE_MIN_RATIO, CRT_TREE_MAX_RATIO], or
  *                             will be treated as invalid parameter.
@@ -1383,6 +1406,33 @@ crt_group_version(crt_group_t *grp, uint32_t *version);
 int
 crt_group_version_set(crt_group_t *grp, uint32_t version);
 
+/**
+ * Set the fault domains of the group members, used by CRT_TREE_DOMAIN tree.
+ * Replaces any domain information set before.
+ *
+ * \param[in] grp              CRT group handle, NULL means the local
+ *                             primary/global group
+ * \param[in] ranks            member ranks
+ * \param[in] domains          domain IDs of the ranks, ranks->rl_nr * \a levels
+ *                             entries, the IDs of \a ranks->rl_ranks[i] are
+ *                             domains[i * levels] (the top level, e.g. rack)
+ *                             to domains[i * levels + levels - 1] (the last
+ *                             level, e.g. node)
+ * \param[in] levels           number of domain levels, zero to clear the
+ *                             domain information
+ * \param[in] version          group membership version the domains are for,
+ *                             they are ignored (k-nomial tree is used) while
+ *                             the group version differs. Domains set for a
+ *                             newer version than the current one are staged,
+ *                             the current domains stay in use until the group
+ *                             reaches that version
+ *
+ * \return                     DER_SUCCESS on success, negative value on error
+ */
+int
+crt_group_domains_set(crt_group_t *grp, d_rank_list_t *ranks, uint32_t *domains,
+		      uint32_t levels, uint32_t version);
+
 /**
  * Query number of group members.
  *
@@ -325,6 +325,22 @@ typedef int (*crt_iv_pre_sync_cb_t)(crt_iv_namespace_t ivns,
 				    crt_iv_key_t *iv_key, crt_iv_ver_t iv_ver,
 				    d_sg_list_t *iv_value, void *arg);
 
+/**
+ * If provided, this callback will be called on the root node when it serves a
+ * fetch of the key, to get the lease granted along with the value. The nodes on
+ * the way back to the fetching node keep a copy of the value and serve the
+ * fetches of the key locally until the lease expires, or the key is updated or
+ * invalidated through them.
+ *
+ * \param[in] ivns		the local handle of the IV namespace
+ * \param[in] iv_key		key of the IV
+ * \param[in] arg		private user data
+ *
+ * \return			lease in milliseconds, 0 for no lease
+ */
+typedef uint32_t (*crt_iv_on_lease_cb_t)(crt_iv_namespace_t ivns,
+					 crt_iv_key_t *iv_key, void *arg);
+
 struct crt_iv_ops {
 	crt_iv_pre_fetch_cb_t	ivo_pre_fetch;
 	crt_iv_on_fetch_cb_t	ivo_on_fetch;
@@ -337,6 +353,7 @@ struct crt_iv_ops {
 	crt_iv_on_put_cb_t	ivo_on_put;
 	crt_iv_keys_match_cb_t	ivo_keys_match;
 	crt_iv_pre_sync_cb_t	ivo_pre_sync;
+	crt_iv_on_lease_cb_t	ivo_on_lease;
 };
 
 /**
@@ -233,6 +233,37 @@ int swim_updates_short(struct swim_context *ctx, swim_id_t self_id, uint64_t sel
 		       swim_id_t from_id, swim_id_t id, struct swim_member_update *upds_in,
 		       size_t nupds_in, struct swim_member_update **upds_out, size_t *nupds_out);
 
+/** Upper bound of the packed size of one SWIM update, in bytes */
+#define SWIM_UPDATE_PACKED_MAX	26
+/** Lower bound of the packed size of one SWIM update: flags and ID delta */
+#define SWIM_UPDATE_PACKED_MIN	2
+
+/**
+ * Pack SWIM updates into a compact wire format. The IDs and incarnations are
+ * delta encoded against the previous update, so the size depends on the order
+ * of the updates.
+ *
+ * @param[in]  upds	SWIM updates to pack
+ * @param[in]  nupds	the count of SWIM updates
+ * @param[out] buf	buffer for the packed updates
+ * @param[in,out] size	size of \a buf, which should be at least
+ *			\a nupds * SWIM_UPDATE_PACKED_MAX, returns the packed size
+ * @returns		0 on success, negative error ID otherwise
+ */
+int swim_updates_pack(struct swim_member_update *upds, size_t nupds, void *buf, size_t *size);
+
+/**
+ * Unpack SWIM updates packed by swim_updates_pack().
+ *
+ * @param[in]  buf	packed updates
+ * @param[in]  size	size of \a buf
+ * @param[out] upds	array for the unpacked updates
+ * @param[in]  nupds	the count of SWIM updates in \a buf
+ * @returns		0 on success, -DER_PROTO if \a buf is malformed
+ */
+int swim_updates_unpack(const void *buf, size_t size, struct swim_member_update *upds,
+			size_t nupds);
+
 /**
  * Send a SWIM message for other group member.
  *
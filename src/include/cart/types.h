@@ -312,6 +312,13 @@ typedef enum {
  */
 #define CRT_RPC_FEAT_QUEUE_FRONT	(1U << 3)
 
+/**
+ * Allow the small requests to the same target endpoint context to be packed
+ * into one envelope RPC, see CRT_AGG_WINDOW and CRT_AGG_SIZE. Only takes
+ * effect on the server side and not for the collective RPCs.
+ */
+#define CRT_RPC_FEAT_AGGREGATE		(1U << 4)
+
 typedef void *crt_bulk_opid_t;
 
 /** Bulk transfer permissions */
@@ -504,6 +504,15 @@ int dc_obj_fetch_md(daos_obj_id_t oid, struct daos_obj_md *md);
 int dc_obj_layout_get(daos_handle_t oh, struct daos_obj_layout **p_layout);
 int dc_obj_layout_refresh(daos_handle_t oh);
 int dc_obj_verify(daos_handle_t oh, daos_epoch_t *epochs, unsigned int nr);
+
+/** Parallel dkey enumeration over all of the redundancy groups, see cli_enum.c */
+struct dc_obj_enum_par;
+int dc_obj_list_dkey_par_open(daos_handle_t oh, daos_handle_t th, uint32_t nr,
+			      struct dc_obj_enum_par **epp);
+int dc_obj_list_dkey_par_next(struct dc_obj_enum_par *ep, uint32_t *nr, daos_key_desc_t *kds,
+			      d_sg_list_t *sgl, bool *eof);
+void dc_obj_list_dkey_par_close(struct dc_obj_enum_par *ep);
+
 daos_handle_t dc_obj_hdl2cont_hdl(daos_handle_t oh);
 int dc_obj_hdl2obj_md(daos_handle_t oh, struct daos_obj_md *md);
 int dc_obj_get_grp_size(daos_handle_t oh, int *grp_size);
@@ -93,6 +93,8 @@ struct pl_map {
 	struct pool_map		*pl_poolmap;
 	/** placement map operations */
 	struct pl_map_ops       *pl_ops;
+	/** cache of the computed object layouts, see pl_obj_place_cached() */
+	struct pl_cache		*pl_cache;
 };
 
 /** attributes of the placement map */
@@ -103,6 +105,15 @@ struct pl_map_attr {
 	int		pa_target_nr;
 };
 
+/** statistics of the object layout cache of a placement map */
+struct pl_cache_stats {
+	uint64_t	pcs_hits;
+	uint64_t	pcs_misses;
+	uint64_t	pcs_evictions;
+	uint64_t	pcs_entries;
+	uint64_t	pcs_bytes;
+};
+
 int pl_init(void);
 void pl_fini(void);
 
@@ -119,6 +130,7 @@ int pl_map_query(uuid_t po_uuid, struct pl_map_attr *attr);
 void pl_map_addref(struct pl_map *map);
 void pl_map_decref(struct pl_map *map);
 uint32_t pl_map_version(struct pl_map *map);
+void pl_map_cache_query(struct pl_map *map, struct pl_cache_stats *stats);
 
 void pl_obj_layout_free(struct pl_obj_layout *layout);
 int  pl_obj_layout_alloc(unsigned int grp_size, unsigned int grp_nr,
@@ -130,12 +142,20 @@ bool pl_obj_layout_contains(struct pool_map *map, struct pl_obj_layout *layout,
 int pl_obj_place(struct pl_map *map, uint16_t gl_layout_ver, struct daos_obj_md *md,
 		 unsigned int mode, struct daos_obj_shard_md *shard_md,
 		 struct pl_obj_layout **layout_pp);
+int pl_obj_place_batch(struct pl_map *map, uint16_t gl_layout_ver, struct daos_obj_md *mds,
+		       unsigned int nr, unsigned int mode, struct pl_obj_layout **layouts);
+int pl_obj_place_cached(struct pl_map *map, uint16_t gl_layout_ver, struct daos_obj_md *md,
+			unsigned int mode, struct pl_obj_layout **layout_pp);
 
 int pl_obj_find_rebuild(struct pl_map *map, uint32_t gl_layout_ver,
 			struct daos_obj_md *md,
 			struct daos_obj_shard_md *shard_md,
 			uint32_t rebuild_ver, uint32_t *tgt_rank,
 			uint32_t *shard_id, unsigned int array_size);
+int pl_obj_find_rebuild_batch(struct pl_map *map, uint32_t gl_layout_ver,
+			      struct daos_obj_md *mds, unsigned int nr,
+			      uint32_t rebuild_ver, uint32_t *tgt_rank,
+			      uint32_t *shard_id, unsigned int array_size, int *nrs);
 
 int pl_obj_find_drain(struct pl_map *map, uint32_t gl_layout_ver,
 		      struct daos_obj_md *md,
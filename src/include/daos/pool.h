@@ -69,8 +69,9 @@
  * Version 1 corresponds to 2.2 (aggregation optimizations)
  * Version 2 corresponds to 2.4 (dynamic evtree, checksum scrubbing)
  * Version 3 corresponds to 2.6 (root embedded values)
+ * Version 4 corresponds to 2.8 (persistent dedup index)
  */
-#define DAOS_POOL_GLOBAL_VERSION 3
+#define DAOS_POOL_GLOBAL_VERSION 4
 
 int dc_pool_init(void);
 void dc_pool_fini(void);
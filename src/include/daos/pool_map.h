@@ -191,8 +191,8 @@ pool_target_id_list_free(struct pool_target_id_list *id_list);
 struct pool_buf {
 	/** format version */
 	uint32_t		pb_version;
-	/** reserved, for alignment now */
-	uint32_t		pb_reserved;
+	/** base map version if this is a delta, zero for a full map */
+	uint32_t		pb_delta_base;
 	/** checksum of components */
 	uint32_t	pb_csum;
 	/** summary of domain_nr, node_nr, target_nr, buffer size */
@@ -230,6 +230,24 @@ int gen_pool_buf(struct pool_map *map, struct pool_buf **map_buf_out, int map_ve
 
 int pool_map_comp_cnt(struct pool_map *map);
 
+/** Max number of deltas kept by struct pool_map_hist */
+#define POOL_MAP_HIST_MAX	16
+
+/** Bounded history of the pool map deltas, oldest first */
+struct pool_map_hist {
+	d_list_t	pmh_list;
+	uint32_t	pmh_nr;
+};
+
+void pool_map_hist_init(struct pool_map_hist *hist);
+void pool_map_hist_fini(struct pool_map_hist *hist);
+int  pool_map_hist_add(struct pool_map_hist *hist, struct pool_map *old_map,
+		       struct pool_map *new_map);
+int  pool_map_hist_extract(struct pool_map_hist *hist, struct pool_map *map, uint32_t base,
+			   struct pool_buf **buf_pp);
+int  pool_map_delta_apply(struct pool_map *map, struct pool_buf *delta, uint32_t version,
+			  struct pool_map **mapp);
+
 int  pool_map_create(struct pool_buf *buf, uint32_t version,
 		     struct pool_map **mapp);
 void pool_map_addref(struct pool_map *map);
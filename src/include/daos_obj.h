@@ -876,6 +876,77 @@ daos_obj_list_dkey(daos_handle_t oh, daos_handle_t th, uint32_t *nr,
 		   daos_key_desc_t *kds, d_sg_list_t *sgl,
 		   daos_anchor_t *anchor, daos_event_t *ev);
 
+/**
+ * Open a parallel distribution key enumeration. Unlike daos_obj_list_dkey()
+ * that walks the redundancy groups of the object one after another, all of the
+ * groups are listed concurrently, and the next batch of a group is prefetched
+ * as soon as its keys have been returned. It is intended to list all of the
+ * dkeys of large objects (for example large directories or KV objects), the
+ * keys are returned in no specific order and the enumeration cannot be resumed
+ * from an anchor.
+ *
+ * \param[in]	oh	Object open handle.
+ *
+ * \param[in]	th	Optional transaction handle to enumerate with.
+ *			Use DAOS_TX_NONE for an independent transaction.
+ *
+ * \param[in]	nr	Number of keys of the first batch of each group, 0 for
+ *			the default. The later batches are sized by the replies.
+ *
+ * \param[out]	eh	Returned enumeration handle.
+ *
+ * eturn		0		Success
+ *			-DER_NO_HDL	Invalid object open handle
+ *			-DER_INVAL	Invalid parameter
+ *			-DER_NOMEM	Out of memory
+ */
+int
+daos_obj_list_dkey_par_open(daos_handle_t oh, daos_handle_t th, uint32_t nr,
+			    daos_handle_t *eh);
+
+/**
+ * Return the next distribution keys of a parallel enumeration, see
+ * daos_obj_list_dkey_par_open(). The call only blocks if no key is available
+ * from any of the redundancy groups yet.
+ *
+ * \param[in]	eh	Enumeration handle.
+ *
+ * \param[in,out]
+ *		nr	[in]: number of key descriptors in \a kds. [out]: number
+ *			of returned key descriptors.
+ *
+ * \param[in,out]
+ *		kds	[in]: preallocated array of \nr key descriptors. [out]:
+ *			size of each individual key in \a sgl.
+ *
+ * \param[in]	sgl	Scatter/gather list to store the dkey list, only its
+ *			first iov is used.
+ *
+ * \param[out]	eof	Set once all of the dkeys have been returned.
+ *
+ * eturn		0		Success
+ *			-DER_NO_HDL	Invalid enumeration handle
+ *			-DER_INVAL	Invalid parameter
+ *			-DER_KEY2BIG	The next key can't fit into \a sgl, the
+ *					required length is returned by
+ *					\a kds[0].kd_key_len.
+ */
+int
+daos_obj_list_dkey_par_next(daos_handle_t eh, uint32_t *nr, daos_key_desc_t *kds,
+			    d_sg_list_t *sgl, bool *eof);
+
+/**
+ * Close a parallel distribution key enumeration, it waits for the requests
+ * still in flight.
+ *
+ * \param[in]	eh	Enumeration handle.
+ *
+ * eturn		0		Success
+ *			-DER_NO_HDL	Invalid enumeration handle
+ */
+int
+daos_obj_list_dkey_par_close(daos_handle_t eh);
+
 /**
  * Attribute key enumeration.
  *
@@ -116,8 +116,11 @@ struct daos_rebuild_status {
 		int32_t		rs_state;
 		int32_t		rs_done;
 	};
-	/** padding of rebuild status */
-	int32_t			rs_padding32;
+	/**
+	 * percent of the full rebuild speed allowed by the foreground latency
+	 * throttle, the lowest of all targets, 0 if unknown
+	 */
+	uint32_t		rs_throttle;
 
 	/** Failure on which rank */
 	int32_t			rs_fail_rank;
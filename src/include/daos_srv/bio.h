@@ -699,6 +699,15 @@ void bio_iod_flush(struct bio_desc *biod);
  */
 struct bio_sglist *bio_iod_sgl(struct bio_desc *biod, unsigned int idx);
 
+/*
+ * Helper function to get the time an io descriptor has waited so far
+ *
+ * \param biod       [IN]	io descriptor
+ * \param dma_wait   [OUT]	Time (nsecs) waited for DMA buffer
+ * \param nvme_wait  [OUT]	Time (nsecs) waited for NVMe completion
+ */
+void bio_iod_wait_time(struct bio_desc *biod, uint64_t *dma_wait, uint64_t *nvme_wait);
+
 /*
  * Helper function to get the specified bulk for an io descriptor
  *
@@ -98,6 +98,12 @@ struct ds_cont_child {
 	uint32_t		 sc_open;
 
 	uint64_t		 sc_dtx_committable_count;
+	/* How many times the readers were blocked by the committable DTXs
+	 * on this (leader) target since the last batched commit round.
+	 */
+	uint32_t		 sc_dtx_refresh_cnt;
+	/* Consecutive batched commit rounds triggered eagerly by DTX refresh. */
+	uint32_t		 sc_dtx_eager_rounds;
 
 	/* The global minimum EC aggregation epoch, which will be upper
 	 * limit for VOS aggregation, i.e. EC object VOS aggregation can
@@ -233,6 +233,9 @@ enum {
 
 struct sched_req_attr {
 	uuid_t		sra_pool_id;
+	/* Container and IO size of the request, used by the QoS policy */
+	uuid_t		sra_cont_id;
+	uint64_t	sra_size;
 	uint32_t	sra_type;
 	uint32_t	sra_flags;
 };
@@ -243,7 +246,9 @@ sched_req_attr_init(struct sched_req_attr *attr, unsigned int type,
 {
 	attr->sra_type = type;
 	attr->sra_flags = 0;
+	attr->sra_size = 0;
 	uuid_copy(attr->sra_pool_id, *pool_id);
+	uuid_clear(attr->sra_cont_id);
 }
 
 struct sched_request;	/* Opaque schedule request */
@@ -757,6 +762,7 @@ struct ds_migrate_status {
 	uint64_t dm_obj_count;	/* migrated object count */
 	uint64_t dm_total_size;	/* migrated total size */
 	int	 dm_status;	/* migrate status */
+	uint32_t dm_throttle;	/* lowest percent of full speed of the targets */
 	uint32_t dm_migrating:1; /* if it is migrating */
 };
 
@@ -768,12 +774,13 @@ ds_object_migrate_send(struct ds_pool *pool, uuid_t pool_hdl_uuid, uuid_t cont_u
 		       uuid_t cont_hdl_uuid, int tgt_id, uint32_t version, unsigned int generation,
 		       uint64_t max_eph, daos_unit_oid_t *oids, daos_epoch_t *ephs,
 		       daos_epoch_t *punched_ephs, unsigned int *shards, int cnt,
-		       uint32_t new_gl_ver, unsigned int migrate_opc);
+		       uint32_t new_gl_ver, unsigned int migrate_opc, unsigned int prio);
 int
 ds_migrate_object(struct ds_pool *pool, uuid_t po_hdl, uuid_t co_hdl, uuid_t co_uuid,
 		  uint32_t version, uint32_t generation, uint64_t max_eph, uint32_t opc,
 		  daos_unit_oid_t *oids, daos_epoch_t *epochs, daos_epoch_t *punched_epochs,
-		  unsigned int *shards, uint32_t count, unsigned int tgt_idx, uint32_t new_gl_ver);
+		  unsigned int *shards, uint32_t count, unsigned int tgt_idx, uint32_t new_gl_ver,
+		  unsigned int prio);
 void
 ds_migrate_stop(struct ds_pool *pool, uint32_t ver, unsigned int generation);
 
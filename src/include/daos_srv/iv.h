@@ -247,6 +247,36 @@ typedef bool (*ds_iv_ent_valid_t)(struct ds_iv_entry *ent,
 typedef int (*ds_iv_pre_sync_t)(struct ds_iv_entry *entry,
 				struct ds_iv_key *key, d_sg_list_t *value);
 
+/* Default lease (ms) of the IV values granted by the root, see ivc_ent_lease */
+#define DS_IV_LEASE_DEF		5000
+
+/**
+ * Get the lease granted along with the entry value fetched from the root, the
+ * nodes on the fetch path serve the value from their leased copy until the
+ * lease expires or the entry is updated or invalidated through them.
+ *
+ * \param ent [IN]	entry being fetched
+ * \param key [IN]	key of the IV call.
+ *
+ * \return		lease in milliseconds, 0 for no lease.
+ */
+typedef uint32_t (*ds_iv_ent_lease_t)(struct ds_iv_entry *ent,
+				      struct ds_iv_key *key);
+
+/**
+ * Check whether the two keys refer to the same value, the fields only
+ * meaningful for the specific operation (e.g. buffer size) are ignored. It is
+ * used to coalesce the fetches and to break the leases, the packed keys are
+ * compared byte by byte if it is not provided.
+ *
+ * \param key1 [IN]	key1 to compare.
+ * \param key2 [IN]	key2 to compare.
+ *
+ * \return		true if match, false otherwise.
+ */
+typedef bool (*ds_iv_key_match_t)(struct ds_iv_key *key1,
+				  struct ds_iv_key *key2);
+
 struct ds_iv_class_ops {
 	ds_iv_key_pack_t	ivc_key_pack;
 	ds_iv_key_unpack_t	ivc_key_unpack;
@@ -261,6 +291,8 @@ struct ds_iv_class_ops {
 	ds_iv_value_alloc_t	ivc_value_alloc;
 	ds_iv_ent_valid_t	ivc_ent_valid;
 	ds_iv_pre_sync_t	ivc_pre_sync;
+	ds_iv_ent_lease_t	ivc_ent_lease;
+	ds_iv_key_match_t	ivc_key_match;
 };
 
 extern struct crt_iv_ops iv_cache_ops;
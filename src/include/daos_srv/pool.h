@@ -41,6 +41,8 @@ struct ds_pool {
 	ABT_rwlock		sp_lock;
 	struct pool_map		*sp_map;
 	uint32_t		sp_map_version;	/* temporary */
+	/* recent deltas of sp_map for incremental map refreshes, under sp_lock */
+	struct pool_map_hist	sp_map_hist;
 	uint32_t		sp_ec_cell_sz;
 	uint64_t		sp_reclaim;
 	uint64_t		sp_redun_fac;
@@ -41,6 +41,21 @@ typedef enum {
 			  (rb_op) == RB_OP_NONE ? "None" : \
 			  "Unknown")
 
+/**
+ * Rebuild priority of an object, by the redundancy left in its group under
+ * the current pool map. Objects of a lower value are sent first by the scanner
+ * and migrated first by the destination.
+ */
+enum rebuild_prio {
+	/* no more failure can be tolerated */
+	REBUILD_PRIO_CRITICAL,
+	/* only one more failure can be tolerated */
+	REBUILD_PRIO_DEGRADED,
+	/* more redundancy left, or nothing lost (reintegration, drain etc) */
+	REBUILD_PRIO_NORMAL,
+	REBUILD_PRIO_NR,
+};
+
 int ds_rebuild_schedule(struct ds_pool *pool, uint32_t map_ver,
 			daos_epoch_t stable_eph, uint32_t layout_version,
 			struct pool_target_id_list *tgts,
@@ -20,6 +20,7 @@
 #define VOS_POOL_DF_2_2 24
 #define VOS_POOL_DF_2_4 25
 #define VOS_POOL_DF_2_6 26
+#define VOS_POOL_DF_2_8 27
 
 struct dtx_rsrvd_uint {
 	void			*dru_scm;
@@ -290,6 +291,8 @@ enum {
 	VOS_POOL_FEAT_DYN_ROOT = (1ULL << 2),
 	/** Embedded value in tree root supported */
 	VOS_POOL_FEAT_EMB_VALUE = (1ULL << 3),
+	/** Persistent, reference counted dedup index supported */
+	VOS_POOL_FEAT_DEDUP = (1ULL << 4),
 };
 
 /** Mask for any conditionals passed to to the fetch */
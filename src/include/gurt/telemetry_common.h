@@ -140,6 +140,13 @@ enum {
 	D_TM_CLOCK_THREAD_CPUTIME	= 0x200,
 	D_TM_LINK			= 0x400,
 	D_TM_MEMINFO			= 0x800,
+	/**
+	 * Flag for d_tm_add_metric() rather than a node type: the counter or
+	 * the statistics of the stats gauge are updated in per-thread slots
+	 * and merged on read.
+	 */
+	D_TM_SHARDED			= 0x1000,
+	D_TM_HDR_HISTOGRAM		= 0x2000,
 	D_TM_ALL_NODES			= (D_TM_DIRECTORY | \
 					   D_TM_COUNTER | \
 					   D_TM_TIMESTAMP | \
@@ -148,7 +155,8 @@ enum {
 					   D_TM_GAUGE | \
 					   D_TM_STATS_GAUGE | \
 					   D_TM_LINK | \
-					   D_TM_MEMINFO)
+					   D_TM_MEMINFO | \
+					   D_TM_HDR_HISTOGRAM)
 };
 
 enum {
@@ -192,6 +200,26 @@ struct d_tm_stats_t {
 	uint64_t	sample_size;
 };
 
+/**
+ * @brief Per-thread slot of a sharded metric, see D_TM_SHARDED
+ *
+ * Each slot is only updated by its owner thread, on its own cache line. The
+ * value of a sharded counter only grows and is read with a relaxed load. The
+ * statistics of a sharded stats gauge are kept with Welford's method, readers
+ * merge the slots with the pairwise variant. dts_seq is odd while the owner is
+ * updating the statistics.
+ */
+struct d_tm_shard_t {
+	uint64_t	dts_seq;
+	uint64_t	dts_value;
+	uint64_t	dts_min;
+	uint64_t	dts_max;
+	uint64_t	dts_sum;
+	uint64_t	dts_count;
+	double		dts_mean;
+	double		dts_m2;
+} __attribute__((aligned(64)));
+
 struct d_tm_bucket_t {
 	uint64_t		dtb_min;
 	uint64_t		dtb_max;
@@ -205,6 +233,49 @@ struct d_tm_histogram_t {
 	int			dth_value_multiplier;
 };
 
+/**
+ * Layout of the HDR histograms: the values below 2^D_TM_HDR_SUB_BITS have their
+ * own bucket, each power of two range above is split into 2^D_TM_HDR_SUB_BITS
+ * linear buckets, so the relative error of a bucket is at most 2^-5 (3.1%).
+ * The values from 2^D_TM_HDR_MAX_BITS go to the last bucket.
+ */
+#define D_TM_HDR_SUB_BITS		5
+#define D_TM_HDR_MAX_BITS		32
+#define D_TM_HDR_BUCKETS		((D_TM_HDR_MAX_BITS - D_TM_HDR_SUB_BITS + 1) << \
+					 D_TM_HDR_SUB_BITS)
+
+/**
+ * @brief Log-linear (HDR) histogram, see D_TM_HDR_HISTOGRAM
+ *
+ * All the fields are updated with atomic operations, dth_min is UINT64_MAX
+ * until the first value is recorded.
+ */
+struct d_tm_hdr_t {
+	uint64_t	dth_count;
+	uint64_t	dth_sum;
+	uint64_t	dth_min;
+	uint64_t	dth_max;
+	uint64_t	*dth_buckets;
+	uint32_t	dth_sub_bits;
+	uint32_t	dth_nr;
+};
+
+/**
+ * @brief Private copy of a HDR histogram, see d_tm_get_hdr()
+ *
+ * The snapshots of the same layout can be merged (e.g. the histograms of all
+ * targets) or subtracted (the samples recorded between two snapshots).
+ */
+struct d_tm_hdr_snap_t {
+	uint64_t	dhs_count;
+	uint64_t	dhs_sum;
+	uint64_t	dhs_min;
+	uint64_t	dhs_max;
+	uint64_t	*dhs_buckets;
+	uint32_t	dhs_sub_bits;
+	uint32_t	dhs_nr;
+};
+
 struct d_tm_meminfo_t {
 	uint64_t arena;
 	uint64_t ordblks;
@@ -220,8 +291,13 @@ struct d_tm_metric_t {
 	}			dtm_data;
 	struct d_tm_stats_t	*dtm_stats;
 	struct d_tm_histogram_t	*dtm_histogram;
+	/** buckets of a D_TM_HDR_HISTOGRAM, NULL otherwise */
+	struct d_tm_hdr_t	*dtm_hdr;
 	char			*dtm_desc;
 	char			*dtm_units;
+	/** per-thread slots of a sharded metric, NULL otherwise */
+	struct d_tm_shard_t	*dtm_shards;
+	int			dtm_shard_nr;
 };
 
 struct d_tm_node_t {
@@ -248,6 +324,10 @@ struct d_tm_nodeList_t {
 			  D_TM_MAX_DESC_LEN + D_TM_MAX_NAME_LEN + D_TM_MAX_UNIT_LEN + \
 			  sizeof(struct d_tm_stats_t))
 
+/* Size of a D_TM_HDR_HISTOGRAM metric */
+#define D_TM_HDR_METRIC_SIZE (D_TM_METRIC_SIZE + sizeof(struct d_tm_hdr_t) + \
+			      D_TM_HDR_BUCKETS * sizeof(uint64_t))
+
 /** Context for a telemetry instance */
 struct d_tm_context;
 
@@ -1,5 +1,5 @@
 /**
- * (C) Copyright 2020-2021 Intel Corporation.
+ * (C) Copyright 2020-2023 Intel Corporation.
  *
  * SPDX-License-Identifier: BSD-2-Clause-Patent
  */
@@ -28,6 +28,12 @@ int d_tm_get_num_buckets(struct d_tm_context *ctx,
 int d_tm_get_bucket_range(struct d_tm_context *ctx,
 			  struct d_tm_bucket_t *bucket, int bucket_id,
 			  struct d_tm_node_t *node);
+int d_tm_get_hdr(struct d_tm_context *ctx, struct d_tm_hdr_snap_t *snap,
+		 struct d_tm_node_t *node);
+void d_tm_hdr_snap_fini(struct d_tm_hdr_snap_t *snap);
+int d_tm_hdr_merge(struct d_tm_hdr_snap_t *dst, struct d_tm_hdr_snap_t *src);
+int d_tm_hdr_diff(struct d_tm_hdr_snap_t *snap, struct d_tm_hdr_snap_t *prev);
+uint64_t d_tm_hdr_percentile(struct d_tm_hdr_snap_t *snap, double pct);
 
 /* Developer facing client API to discover topology and manage results */
 struct d_tm_context *d_tm_open(int id);
@@ -67,7 +73,12 @@ void d_tm_print_duration(struct timespec *tms, struct d_tm_stats_t *stats,
 			 FILE *stream);
 void d_tm_print_gauge(uint64_t val, struct d_tm_stats_t *stats, char *name,
 		      int format, char *units, int opt_fields, FILE *stream);
+void d_tm_print_hdr(struct d_tm_hdr_snap_t *snap, double *pcts, int pct_nr,
+		    char *name, int format, char *units, int opt_fields,
+		    FILE *stream);
 void d_tm_print_metadata(char *desc, char *units, int format, FILE *stream);
+int d_tm_set_hdr_view(struct d_tm_context *ctx, double *pcts, int pct_nr,
+		      bool interval);
 int d_tm_clock_id(int clk_id);
 char *d_tm_clock_string(int clk_id);
 
@@ -19,9 +19,13 @@ void d_tm_mark_duration_end(struct d_tm_node_t *metric);
 void d_tm_set_gauge(struct d_tm_node_t *metric, uint64_t value);
 void d_tm_inc_gauge(struct d_tm_node_t *metric, uint64_t value);
 void d_tm_dec_gauge(struct d_tm_node_t *metric, uint64_t value);
+void d_tm_record_hdr(struct d_tm_node_t *metric, uint64_t value);
+int d_tm_snap_hdr(struct d_tm_node_t *metric, struct d_tm_hdr_snap_t *snap);
 
 /* Other server functions */
 int d_tm_init(int id, uint64_t mem_size, int flags);
+void d_tm_set_shards(unsigned int nr);
+void d_tm_bind_shard(int idx);
 int d_tm_init_histogram(struct d_tm_node_t *node, char *path, int num_buckets,
 			int initial_width, int multiplier);
 int d_tm_add_metric(struct d_tm_node_t **node, int metric_type, char *desc,
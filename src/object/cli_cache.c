@@ -0,0 +1,678 @@
+/**
+ * (C) Copyright 2023 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+/**
+ * object client: read cache for immutable data.
+ *
+ * Data fetched from a snapshot (read-only TX opened by daos_tx_open_snap())
+ * never changes, so it can be cached on the client side without any coherence
+ * protocol. Optionally, fetches against containers opened with DAOS_COO_RO can
+ * be cached as well, that is for the case of read-only datasets (for example
+ * the training data that is re-read at every training epoch), the user has to
+ * guarantee that nobody modifies the container while it is opened. Such entries
+ * are keyed by the container open handle instead of the container, so they are
+ * never served to another open of the container, and they only stay in the
+ * DRAM tier of the process.
+ *
+ * The cache has two tiers:
+ * - per-process DRAM tier, bounded by DAOS_OBJ_CACHE_SIZE (MiB) and evicted
+ *   in LRU order;
+ * - optional node-local file tier under DAOS_OBJ_CACHE_DIR (for example some
+ *   directory on /dev/shm), that is shared by all processes on the node. Each
+ *   process bounds the bytes it populated by DAOS_OBJ_CACHE_DIR_SIZE (MiB),
+ *   removes its oldest files when the limit is exceeded and removes all its
+ *   files on finalization. Only snapshot entries are stored in this tier. The
+ *   directory must be owned by the user and not writable by the group or others,
+ *   otherwise the tier is disabled, so the files are only shared by the
+ *   processes of the same user, and cannot be replaced or planted by others.
+ *
+ * Each entry caches one IOD of a fetch, it is keyed by (container or container
+ * handle, object, epoch, dkey, akey, iod type, recxs). A fetch is served from the cache only
+ * if all its IODs hit, otherwise it is sent to the engines as usual and the
+ * results are inserted into the cache on completion.
+ */
+#define D_LOGFAC	DD_FAC(object)
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <daos/common.h>
+#include <daos/container.h>
+#include <daos_task.h>
+#include "obj_internal.h"
+
+#define OBJ_CACHE_SIZE_ENV	"DAOS_OBJ_CACHE_SIZE"
+#define OBJ_CACHE_RO_ENV	"DAOS_OBJ_CACHE_RO"
+#define OBJ_CACHE_DIR_ENV	"DAOS_OBJ_CACHE_DIR"
+#define OBJ_CACHE_DIR_SIZE_ENV	"DAOS_OBJ_CACHE_DIR_SIZE"
+
+/* power2(bits) buckets for the DRAM tier */
+#define OBJ_CACHE_HASH_BITS	16
+/* The entry larger than (capacity >> OBJ_CACHE_ENTRY_SHIFT) will not be cached. */
+#define OBJ_CACHE_ENTRY_SHIFT	3
+#define OBJ_CACHE_FILE_MAGIC	0xdac4ca5eU
+
+/** DRAM tier entry. */
+struct obj_cache_entry {
+	/* link into obj_cache::oc_htable */
+	d_list_t		 oce_link;
+	/* link into obj_cache::oc_lru, the head is the most recently used */
+	d_list_t		 oce_lru;
+	uint64_t		 oce_hash;
+	/* record size of the IOD */
+	daos_size_t		 oce_rsize;
+	/* valid bytes in oce_data */
+	daos_size_t		 oce_data_len;
+	uint32_t		 oce_key_len;
+	char			*oce_key;
+	char			*oce_data;
+};
+
+/** File tier header, followed by the key and the data. */
+struct obj_cache_file_hdr {
+	uint32_t		 och_magic;
+	uint32_t		 och_key_len;
+	uint64_t		 och_rsize;
+	uint64_t		 och_data_len;
+};
+
+/** The file populated by this process, for bounding the file tier. */
+struct obj_cache_file {
+	d_list_t		 ocf_link;
+	uint64_t		 ocf_hash;
+	daos_size_t		 ocf_size;
+};
+
+struct obj_cache {
+	pthread_mutex_t		 oc_lock;
+	struct d_hash_table	 oc_htable;
+	d_list_t		 oc_lru;
+	d_list_t		 oc_files;
+	daos_size_t		 oc_size;
+	daos_size_t		 oc_capacity;
+	daos_size_t		 oc_file_size;
+	daos_size_t		 oc_file_capacity;
+	char			*oc_dir;
+	uint64_t		 oc_hits;
+	uint64_t		 oc_file_hits;
+	uint64_t		 oc_misses;
+	uint64_t		 oc_evictions;
+	uint32_t		 oc_enabled:1,
+				 oc_ro_cont:1;
+};
+
+static struct obj_cache	obj_cache;
+
+static inline struct obj_cache_entry *
+oce_link2ptr(d_list_t *link)
+{
+	return container_of(link, struct obj_cache_entry, oce_link);
+}
+
+static uint32_t
+oce_hop_key_hash(struct d_hash_table *htab, const void *key, unsigned int ksize)
+{
+	return (uint32_t)d_hash_murmur64(key, ksize, 5731);
+}
+
+static uint32_t
+oce_hop_rec_hash(struct d_hash_table *htab, d_list_t *link)
+{
+	return (uint32_t)oce_link2ptr(link)->oce_hash;
+}
+
+/* The hash table holds the only reference, the entry is freed once deleted. */
+static bool
+oce_hop_rec_decref(struct d_hash_table *htab, d_list_t *link)
+{
+	return true;
+}
+
+static bool
+oce_hop_key_cmp(struct d_hash_table *htab, d_list_t *link, const void *key, unsigned int ksize)
+{
+	struct obj_cache_entry	*oce = oce_link2ptr(link);
+
+	return oce->oce_key_len == ksize && memcmp(oce->oce_key, key, ksize) == 0;
+}
+
+static void
+oce_free(struct obj_cache_entry *oce)
+{
+	D_FREE(oce->oce_key);
+	D_FREE(oce->oce_data);
+	D_FREE(oce);
+}
+
+static void
+oce_hop_rec_free(struct d_hash_table *htab, d_list_t *link)
+{
+	struct obj_cache_entry	*oce = oce_link2ptr(link);
+
+	d_list_del(&oce->oce_lru);
+	obj_cache.oc_size -= oce->oce_data_len + oce->oce_key_len;
+	oce_free(oce);
+}
+
+static d_hash_table_ops_t obj_cache_hops = {
+	.hop_key_hash	= oce_hop_key_hash,
+	.hop_rec_hash	= oce_hop_rec_hash,
+	.hop_key_cmp	= oce_hop_key_cmp,
+	.hop_rec_decref	= oce_hop_rec_decref,
+	.hop_rec_free	= oce_hop_rec_free,
+};
+
+/**
+ * Serialize the cache key of \a iod, the caller should free \a key_p. The key
+ * of read-only container entry (\a ro) carries the container open handle.
+ */
+static int
+obj_cache_key_build(struct dc_object *obj, daos_epoch_t epoch, bool ro, daos_key_t *dkey,
+		    daos_iod_t *iod, char **key_p, uint32_t *len_p)
+{
+	daos_size_t	 len;
+	uint32_t	 recx_nr;
+	char		*key;
+	char		*ptr;
+
+	recx_nr = iod->iod_type == DAOS_IOD_ARRAY ? iod->iod_nr : 0;
+	len = sizeof(uuid_t) + sizeof(daos_obj_id_t) + sizeof(epoch) + sizeof(iod->iod_type) +
+	      sizeof(uint32_t) * 3 + dkey->iov_len + iod->iod_name.iov_len +
+	      recx_nr * sizeof(daos_recx_t);
+
+	D_ALLOC(key, len);
+	if (key == NULL)
+		return -DER_NOMEM;
+
+	ptr = key;
+#define OC_KEY_PUT(buf, size)	do { memcpy(ptr, buf, size); ptr += size; } while (0)
+	OC_KEY_PUT(ro ? obj->cob_co->dc_cont_hdl : obj->cob_co->dc_uuid, sizeof(uuid_t));
+	OC_KEY_PUT(&obj->cob_md.omd_id, sizeof(daos_obj_id_t));
+	OC_KEY_PUT(&epoch, sizeof(epoch));
+	OC_KEY_PUT(&iod->iod_type, sizeof(iod->iod_type));
+	OC_KEY_PUT(&dkey->iov_len, sizeof(uint32_t));
+	OC_KEY_PUT(dkey->iov_buf, dkey->iov_len);
+	OC_KEY_PUT(&iod->iod_name.iov_len, sizeof(uint32_t));
+	OC_KEY_PUT(iod->iod_name.iov_buf, iod->iod_name.iov_len);
+	OC_KEY_PUT(&recx_nr, sizeof(uint32_t));
+	if (recx_nr > 0)
+		OC_KEY_PUT(iod->iod_recxs, recx_nr * sizeof(daos_recx_t));
+#undef OC_KEY_PUT
+	D_ASSERT(ptr == key + len);
+
+	*key_p = key;
+	*len_p = len;
+	return 0;
+}
+
+/**
+ * Check whether the fetch can be served by, or be inserted into, the cache.
+ * Return the epoch that is used as part of the key via \a epoch, and whether
+ * it is a read-only container (rather than snapshot) fetch via \a ro.
+ */
+static bool
+obj_cache_fetch_eligible(struct dc_object *obj, daos_obj_fetch_t *args, daos_epoch_t *epoch,
+			 bool *ro)
+{
+	uint32_t	i;
+
+	if (!obj_cache.oc_enabled)
+		return false;
+
+	/* Conditional, special shard, EC recovery, migration and so on. */
+	if (args->flags != 0 || args->extra_flags != 0 || args->ioms != NULL ||
+	    args->csum_iov != NULL || args->dkey == NULL)
+		return false;
+
+	for (i = 0; i < args->nr; i++) {
+		if (args->iods[i].iod_type == DAOS_IOD_ARRAY && args->iods[i].iod_recxs == NULL)
+			return false;
+	}
+
+	*ro = false;
+	if (daos_handle_is_valid(args->th))
+		return dc_tx_hdl_is_snap(args->th, epoch);
+
+	/* The data may change once the container is closed, so the entry is only valid for
+	 * this open, see obj_cache_key_build().
+	 */
+	if (obj_cache.oc_ro_cont && obj->cob_co->dc_capas & DAOS_COO_RO) {
+		*epoch = DAOS_EPOCH_MAX;
+		*ro = true;
+		return true;
+	}
+
+	return false;
+}
+
+/**
+ * Create the file tier directory if needed. An existing one is only used if it is owned by the
+ * user and cannot be written by the others, as for example /dev/shm itself is shared by all.
+ */
+static int
+obj_cache_dir_check(const char *dir)
+{
+	struct stat	st;
+
+	if (mkdir(dir, 0700) != 0 && errno != EEXIST)
+		return daos_errno2der(errno);
+
+	if (lstat(dir, &st) != 0)
+		return daos_errno2der(errno);
+
+	if (!S_ISDIR(st.st_mode) || st.st_uid != geteuid() ||
+	    (st.st_mode & (S_IWGRP | S_IWOTH)) != 0)
+		return -DER_NO_PERM;
+
+	return 0;
+}
+
+static void
+obj_cache_file_path(uint64_t hash, char *path, size_t len)
+{
+	snprintf(path, len, "%s/%016"PRIx64, obj_cache.oc_dir, hash);
+}
+
+/** Load the entry from the file tier, return NULL if miss. */
+static struct obj_cache_entry *
+obj_cache_file_load(char *key, uint32_t key_len, uint64_t hash)
+{
+	struct obj_cache_file_hdr	 hdr;
+	struct obj_cache_entry		*oce = NULL;
+	char				*fkey = NULL;
+	char				 path[PATH_MAX];
+	int				 fd;
+
+	obj_cache_file_path(hash, path, sizeof(path));
+	fd = open(path, O_RDONLY | O_NOFOLLOW);
+	if (fd < 0)
+		return NULL;
+
+	if (read(fd, &hdr, sizeof(hdr)) != sizeof(hdr) || hdr.och_magic != OBJ_CACHE_FILE_MAGIC ||
+	    hdr.och_key_len != key_len)
+		goto out;
+
+	/* Populated by the process with larger DRAM tier, cannot be promoted. */
+	if (hdr.och_data_len + key_len > obj_cache.oc_capacity >> OBJ_CACHE_ENTRY_SHIFT)
+		goto out;
+
+	D_ALLOC(fkey, key_len);
+	if (fkey == NULL)
+		goto out;
+
+	/* Hash collision, let the caller overwrite it. */
+	if (read(fd, fkey, key_len) != key_len || memcmp(fkey, key, key_len) != 0)
+		goto out;
+
+	D_ALLOC_PTR(oce);
+	if (oce == NULL)
+		goto out;
+
+	if (hdr.och_data_len > 0) {
+		D_ALLOC_NZ(oce->oce_data, hdr.och_data_len);
+		if (oce->oce_data == NULL ||
+		    read(fd, oce->oce_data, hdr.och_data_len) != hdr.och_data_len) {
+			oce_free(oce);
+			oce = NULL;
+			goto out;
+		}
+	}
+	oce->oce_rsize = hdr.och_rsize;
+	oce->oce_data_len = hdr.och_data_len;
+
+out:
+	D_FREE(fkey);
+	close(fd);
+	return oce;
+}
+
+static void
+obj_cache_file_evict(daos_size_t size)
+{
+	struct obj_cache_file	*ocf;
+	char			 path[PATH_MAX];
+
+	while (obj_cache.oc_file_size + size > obj_cache.oc_file_capacity &&
+	       !d_list_empty(&obj_cache.oc_files)) {
+		ocf = d_list_entry(obj_cache.oc_files.next, struct obj_cache_file, ocf_link);
+		obj_cache_file_path(ocf->ocf_hash, path, sizeof(path));
+		(void)unlink(path);
+		obj_cache.oc_file_size -= ocf->ocf_size;
+		d_list_del(&ocf->ocf_link);
+		D_FREE(ocf);
+	}
+}
+
+/**
+ * Store the entry into the file tier. The file is created with unique temporary
+ * name then renamed, so other processes never see partial content.
+ */
+static void
+obj_cache_file_store(struct obj_cache_entry *oce)
+{
+	struct obj_cache_file_hdr	 hdr;
+	struct obj_cache_file		*ocf;
+	daos_size_t			 size;
+	char				 path[PATH_MAX];
+	char				 tmp[PATH_MAX];
+	int				 fd;
+
+	size = sizeof(hdr) + oce->oce_key_len + oce->oce_data_len;
+	if (size > obj_cache.oc_file_capacity >> OBJ_CACHE_ENTRY_SHIFT)
+		return;
+
+	D_ALLOC_PTR(ocf);
+	if (ocf == NULL)
+		return;
+
+	obj_cache_file_evict(size);
+
+	obj_cache_file_path(oce->oce_hash, path, sizeof(path));
+	snprintf(tmp, sizeof(tmp), "%s.XXXXXX", path);
+	fd = mkstemp(tmp);
+	if (fd < 0)
+		goto free;
+
+	hdr.och_magic = OBJ_CACHE_FILE_MAGIC;
+	hdr.och_key_len = oce->oce_key_len;
+	hdr.och_rsize = oce->oce_rsize;
+	hdr.och_data_len = oce->oce_data_len;
+	if (write(fd, &hdr, sizeof(hdr)) != sizeof(hdr) ||
+	    write(fd, oce->oce_key, oce->oce_key_len) != oce->oce_key_len ||
+	    (oce->oce_data_len > 0 &&
+	     write(fd, oce->oce_data, oce->oce_data_len) != oce->oce_data_len)) {
+		close(fd);
+		(void)unlink(tmp);
+		goto free;
+	}
+	close(fd);
+
+	if (rename(tmp, path) != 0) {
+		(void)unlink(tmp);
+		goto free;
+	}
+
+	ocf->ocf_hash = oce->oce_hash;
+	ocf->ocf_size = size;
+	obj_cache.oc_file_size += size;
+	d_list_add_tail(&ocf->ocf_link, &obj_cache.oc_files);
+	return;
+
+free:
+	D_FREE(ocf);
+}
+
+/** Evict the DRAM tier in LRU order until there is space for \a size bytes. */
+static void
+obj_cache_evict(daos_size_t size)
+{
+	struct obj_cache_entry	*oce;
+
+	while (obj_cache.oc_size + size > obj_cache.oc_capacity &&
+	       !d_list_empty(&obj_cache.oc_lru)) {
+		oce = d_list_entry(obj_cache.oc_lru.prev, struct obj_cache_entry, oce_lru);
+		d_hash_rec_delete_at(&obj_cache.oc_htable, &oce->oce_link);
+		obj_cache.oc_evictions++;
+	}
+}
+
+/* Insert the entry into the DRAM tier, the caller holds oc_lock. */
+static void
+obj_cache_insert_locked(struct obj_cache_entry *oce)
+{
+	daos_size_t	size = oce->oce_data_len + oce->oce_key_len;
+
+	obj_cache_evict(size);
+	(void)d_hash_rec_delete(&obj_cache.oc_htable, oce->oce_key, oce->oce_key_len);
+	d_hash_rec_insert(&obj_cache.oc_htable, oce->oce_key, oce->oce_key_len, &oce->oce_link,
+			  false);
+	d_list_add(&oce->oce_lru, &obj_cache.oc_lru);
+	obj_cache.oc_size += size;
+}
+
+/* Copy the cached data into the user sgl, the size has been verified by caller. */
+static void
+obj_cache_copy_out(struct obj_cache_entry *oce, d_sg_list_t *sgl)
+{
+	daos_size_t	off = 0;
+	daos_size_t	nob;
+	uint32_t	i;
+
+	for (i = 0; i < sgl->sg_nr && off < oce->oce_data_len; i++) {
+		nob = min(sgl->sg_iovs[i].iov_buf_len, oce->oce_data_len - off);
+		memcpy(sgl->sg_iovs[i].iov_buf, oce->oce_data + off, nob);
+		off += nob;
+	}
+	dc_sgl_out_set(sgl, oce->oce_data_len);
+}
+
+/* Whether the cached entry can satisfy the IOD and the user buffer. */
+static bool
+obj_cache_entry_fits(struct obj_cache_entry *oce, daos_iod_t *iod, d_sg_list_t *sgl)
+{
+	if (iod->iod_size != DAOS_REC_ANY && iod->iod_size != oce->oce_rsize)
+		return false;
+
+	return sgl == NULL || daos_sgl_buf_size(sgl) >= oce->oce_data_len;
+}
+
+/**
+ * Try to serve the fetch from the cache. Return true if all IODs hit, then
+ * the iod_size and the user sgls have been filled.
+ */
+bool
+obj_cache_fetch(struct dc_object *obj, daos_obj_fetch_t *args)
+{
+	struct obj_cache_entry	**oces = NULL;
+	struct obj_cache_entry	*oce;
+	d_list_t		*link;
+	daos_epoch_t		 epoch;
+	char			*key;
+	uint32_t		 key_len;
+	uint64_t		 hash;
+	uint32_t		 hits = 0;
+	uint32_t		 i;
+	bool			*loaded;
+	bool			 ro;
+
+	if (!obj_cache_fetch_eligible(obj, args, &epoch, &ro))
+		return false;
+
+	/* The entries loaded from the file tier are only inserted into the DRAM tier after the
+	 * data being copied out, so the eviction cannot release the entries in use.
+	 */
+	D_ALLOC(oces, args->nr * (sizeof(*oces) + sizeof(*loaded)));
+	if (oces == NULL)
+		return false;
+	loaded = (bool *)&oces[args->nr];
+
+	D_MUTEX_LOCK(&obj_cache.oc_lock);
+	for (i = 0; i < args->nr; i++) {
+		if (obj_cache_key_build(obj, epoch, ro, args->dkey, &args->iods[i], &key,
+					&key_len))
+			break;
+
+		hash = d_hash_murmur64((unsigned char *)key, key_len, 5731);
+		link = d_hash_rec_find(&obj_cache.oc_htable, key, key_len);
+		if (link != NULL) {
+			oce = oce_link2ptr(link);
+			D_FREE(key);
+		} else if (obj_cache.oc_dir != NULL && !ro &&
+			   (oce = obj_cache_file_load(key, key_len, hash)) != NULL) {
+			oce->oce_hash = hash;
+			oce->oce_key = key;
+			oce->oce_key_len = key_len;
+			loaded[i] = true;
+		} else {
+			D_FREE(key);
+			break;
+		}
+
+		oces[i] = oce;
+		if (!obj_cache_entry_fits(oce, &args->iods[i], args->sgls ? &args->sgls[i] : NULL))
+			break;
+		hits++;
+	}
+
+	if (hits == args->nr) {
+		for (i = 0; i < args->nr; i++) {
+			args->iods[i].iod_size = oces[i]->oce_rsize;
+			if (args->sgls != NULL)
+				obj_cache_copy_out(oces[i], &args->sgls[i]);
+			if (!loaded[i])
+				d_list_move(&oces[i]->oce_lru, &obj_cache.oc_lru);
+		}
+		obj_cache.oc_hits++;
+	} else {
+		obj_cache.oc_misses++;
+	}
+
+	/* Promote the entries loaded from the file tier. */
+	for (i = 0; i < args->nr; i++) {
+		if (!loaded[i])
+			continue;
+		obj_cache_insert_locked(oces[i]);
+		obj_cache.oc_file_hits++;
+	}
+	D_MUTEX_UNLOCK(&obj_cache.oc_lock);
+	D_FREE(oces);
+
+	D_DEBUG(DB_IO, DF_OID" read cache %s, %u/%u IODs\n", DP_OID(obj->cob_md.omd_id),
+		hits == args->nr ? "hit" : "miss", hits, args->nr);
+	return hits == args->nr;
+}
+
+/** Insert the result of a successfully completed fetch into the cache. */
+void
+obj_cache_fill(struct dc_object *obj, daos_obj_fetch_t *args)
+{
+	struct obj_cache_entry	*oce;
+	d_sg_list_t		*sgl;
+	daos_epoch_t		 epoch;
+	daos_size_t		 off;
+	uint32_t		 i;
+	uint32_t		 j;
+	bool			 ro;
+
+	/* Size query only, nothing to cache. */
+	if (args->sgls == NULL || !obj_cache_fetch_eligible(obj, args, &epoch, &ro))
+		return;
+
+	for (i = 0; i < args->nr; i++) {
+		sgl = &args->sgls[i];
+
+		D_ALLOC_PTR(oce);
+		if (oce == NULL)
+			return;
+
+		if (obj_cache_key_build(obj, epoch, ro, args->dkey, &args->iods[i], &oce->oce_key,
+					&oce->oce_key_len)) {
+			D_FREE(oce);
+			return;
+		}
+		oce->oce_hash = d_hash_murmur64((unsigned char *)oce->oce_key, oce->oce_key_len,
+						5731);
+		oce->oce_rsize = args->iods[i].iod_size;
+
+		for (j = 0; j < sgl->sg_nr_out; j++)
+			oce->oce_data_len += sgl->sg_iovs[j].iov_len;
+
+		if (oce->oce_data_len + oce->oce_key_len >
+		    obj_cache.oc_capacity >> OBJ_CACHE_ENTRY_SHIFT) {
+			oce_free(oce);
+			continue;
+		}
+
+		if (oce->oce_data_len > 0) {
+			D_ALLOC_NZ(oce->oce_data, oce->oce_data_len);
+			if (oce->oce_data == NULL) {
+				oce_free(oce);
+				return;
+			}
+			for (j = 0, off = 0; j < sgl->sg_nr_out; j++) {
+				memcpy(oce->oce_data + off, sgl->sg_iovs[j].iov_buf,
+				       sgl->sg_iovs[j].iov_len);
+				off += sgl->sg_iovs[j].iov_len;
+			}
+		}
+
+		D_MUTEX_LOCK(&obj_cache.oc_lock);
+		if (obj_cache.oc_dir != NULL && !ro)
+			obj_cache_file_store(oce);
+		obj_cache_insert_locked(oce);
+		D_MUTEX_UNLOCK(&obj_cache.oc_lock);
+	}
+}
+
+int
+obj_cache_init(void)
+{
+	unsigned int	size = 0;
+	unsigned int	dir_size = 0;
+	bool		ro_cont = false;
+	char		*dir;
+	int		rc;
+
+	memset(&obj_cache, 0, sizeof(obj_cache));
+	d_getenv_int(OBJ_CACHE_SIZE_ENV, &size);
+	if (size == 0)
+		return 0;
+
+	rc = D_MUTEX_INIT(&obj_cache.oc_lock, NULL);
+	if (rc != 0)
+		return rc;
+
+	rc = d_hash_table_create_inplace(D_HASH_FT_NOLOCK, OBJ_CACHE_HASH_BITS, NULL,
+					 &obj_cache_hops, &obj_cache.oc_htable);
+	if (rc != 0) {
+		D_MUTEX_DESTROY(&obj_cache.oc_lock);
+		return rc;
+	}
+
+	D_INIT_LIST_HEAD(&obj_cache.oc_lru);
+	D_INIT_LIST_HEAD(&obj_cache.oc_files);
+	obj_cache.oc_capacity = (daos_size_t)size << 20;
+
+	d_getenv_bool(OBJ_CACHE_RO_ENV, &ro_cont);
+	obj_cache.oc_ro_cont = ro_cont ? 1 : 0;
+
+	dir = getenv(OBJ_CACHE_DIR_ENV);
+	if (dir != NULL && *dir != '\0') {
+		rc = obj_cache_dir_check(dir);
+		if (rc != 0) {
+			D_WARN("Cannot use read cache directory %s: "DF_RC", file tier disabled\n",
+			       dir, DP_RC(rc));
+		} else {
+			D_STRNDUP(obj_cache.oc_dir, dir, PATH_MAX);
+			dir_size = size;
+			d_getenv_int(OBJ_CACHE_DIR_SIZE_ENV, &dir_size);
+			obj_cache.oc_file_capacity = (daos_size_t)dir_size << 20;
+		}
+	}
+
+	obj_cache.oc_enabled = 1;
+	D_INFO("Enable object read cache: %u MiB, file tier %s (%u MiB), RO container %s\n",
+	       size, obj_cache.oc_dir != NULL ? obj_cache.oc_dir : "none", dir_size,
+	       obj_cache.oc_ro_cont ? "yes" : "no");
+	return 0;
+}
+
+void
+obj_cache_fini(void)
+{
+	if (!obj_cache.oc_enabled)
+		return;
+
+	D_INFO("Object read cache: hits "DF_U64" (file "DF_U64"), misses "DF_U64", evictions "
+	       DF_U64"\n", obj_cache.oc_hits, obj_cache.oc_file_hits, obj_cache.oc_misses,
+	       obj_cache.oc_evictions);
+
+	obj_cache.oc_enabled = 0;
+	d_hash_table_destroy_inplace(&obj_cache.oc_htable, true);
+	/* Remove the files populated by this process. */
+	obj_cache_file_evict(obj_cache.oc_file_capacity + 1);
+	D_ASSERT(d_list_empty(&obj_cache.oc_files));
+	D_FREE(obj_cache.oc_dir);
+	D_MUTEX_DESTROY(&obj_cache.oc_lock);
+}
@@ -0,0 +1,394 @@
+/**
+ * (C) Copyright 2023 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+/**
+ * src/object/cli_enum.c
+ *
+ * Parallel dkey enumeration. Every redundancy group of the object is listed
+ * with its own anchor (DIOF_TO_SPEC_GROUP), so the per-group RPCs are in flight
+ * at the same time instead of walking the groups one after another. As soon as
+ * the caller has consumed the batch of a group, the next batch of that group is
+ * issued, so that it is (ideally) already available on the next call.
+ */
+#define D_LOGFAC	DD_FAC(object)
+
+#include <daos/object.h>
+#include <daos/task.h>
+#include <daos_task.h>
+#include <daos_event.h>
+#include "obj_internal.h"
+
+/* Number of key descriptors of the first batch per group if not specified */
+#define ENUM_PAR_NR_DEF		128
+/* Upper bound of the key descriptors per group batch */
+#define ENUM_PAR_NR_MAX		4096
+/* Key size guess used to size the initial key buffer of each group */
+#define ENUM_PAR_KEY_SIZE	32
+/* Upper bound of the key buffer per group */
+#define ENUM_PAR_BUF_MAX	(1UL << 20)
+
+struct enum_par_grp {
+	daos_event_t		 epg_ev;
+	daos_anchor_t		 epg_anchor;
+	daos_key_desc_t		*epg_kds;
+	char			*epg_buf;
+	d_iov_t			 epg_iov;
+	d_sg_list_t		 epg_sgl;
+	daos_size_t		 epg_buf_len;
+	uint32_t		 epg_kds_cap;
+	/* Number of keys returned by the last batch */
+	uint32_t		 epg_nr;
+	/* Next key to be consumed, and its offset in epg_buf */
+	uint32_t		 epg_idx;
+	daos_size_t		 epg_off;
+	uint32_t		 epg_inflight:1,
+				 epg_eof:1,
+				 epg_grow_kds:1,
+				 epg_grow_buf:1;
+};
+
+struct dc_obj_enum_par {
+	daos_handle_t		 ep_oh;
+	daos_handle_t		 ep_th;
+	uint32_t		 ep_grp_nr;
+	uint32_t		 ep_grp_size;
+	/* The group to start copying from on the next call, for fairness */
+	uint32_t		 ep_cur;
+	uint32_t		 ep_is_ec:1;
+	struct enum_par_grp	 ep_grps[0];
+};
+
+static int
+enum_par_grp_alloc(struct enum_par_grp *grp, uint32_t kds_cap, daos_size_t buf_len)
+{
+	daos_key_desc_t	*kds;
+	char		*buf;
+
+	if (kds_cap != grp->epg_kds_cap) {
+		D_ALLOC_ARRAY(kds, kds_cap);
+		if (kds == NULL)
+			return -DER_NOMEM;
+		D_FREE(grp->epg_kds);
+		grp->epg_kds = kds;
+		grp->epg_kds_cap = kds_cap;
+	}
+
+	if (buf_len != grp->epg_buf_len) {
+		D_ALLOC(buf, buf_len);
+		if (buf == NULL)
+			return -DER_NOMEM;
+		D_FREE(grp->epg_buf);
+		grp->epg_buf = buf;
+		grp->epg_buf_len = buf_len;
+	}
+
+	return 0;
+}
+
+/* Send the next list request of the group, the buffers must have been consumed */
+static int
+enum_par_grp_issue(struct dc_obj_enum_par *ep, struct enum_par_grp *grp)
+{
+	tse_task_t	*task;
+	uint32_t	 kds_cap = grp->epg_kds_cap;
+	daos_size_t	 buf_len = grp->epg_buf_len;
+	int		 rc;
+
+	D_ASSERT(!grp->epg_inflight && !grp->epg_eof);
+
+	/* Let the batch follow what the last reply was bounded by: the number of
+	 * descriptors or the key buffer, the server packs until either is full.
+	 */
+	if (grp->epg_grow_kds)
+		kds_cap = min(kds_cap * 2, ENUM_PAR_NR_MAX);
+	if (grp->epg_grow_buf)
+		buf_len = min(buf_len * 2, ENUM_PAR_BUF_MAX);
+	grp->epg_grow_kds = 0;
+	grp->epg_grow_buf = 0;
+
+	rc = enum_par_grp_alloc(grp, kds_cap, buf_len);
+	if (rc != 0)
+		return rc;
+
+	grp->epg_nr = grp->epg_kds_cap;
+	grp->epg_idx = 0;
+	grp->epg_off = 0;
+	memset(grp->epg_kds, 0, grp->epg_kds_cap * sizeof(*grp->epg_kds));
+	d_iov_set(&grp->epg_iov, grp->epg_buf, grp->epg_buf_len);
+	grp->epg_iov.iov_len = 0;
+	grp->epg_sgl.sg_nr = 1;
+	grp->epg_sgl.sg_nr_out = 0;
+	grp->epg_sgl.sg_iovs = &grp->epg_iov;
+
+	daos_anchor_set_flags(&grp->epg_anchor, DIOF_TO_SPEC_GROUP);
+	rc = dc_obj_list_dkey_task_create(ep->ep_oh, ep->ep_th, &grp->epg_nr, grp->epg_kds,
+					  &grp->epg_sgl, &grp->epg_anchor, &grp->epg_ev, NULL,
+					  &task);
+	if (rc != 0)
+		return rc;
+
+	grp->epg_inflight = 1;
+	/* Failure is reported through the event */
+	return dc_task_schedule(task, true);
+}
+
+/* Check (or wait for) the completion of the in-flight request of the group */
+static int
+enum_par_grp_poll(struct dc_obj_enum_par *ep, struct enum_par_grp *grp, bool wait, bool *done)
+{
+	daos_size_t	 size;
+	bool		 ready = false;
+	int		 rc;
+
+	D_ASSERT(grp->epg_inflight);
+
+	rc = daos_event_test(&grp->epg_ev, wait ? DAOS_EQ_WAIT : DAOS_EQ_NOWAIT, &ready);
+	if (rc != 0)
+		return rc;
+
+	*done = false;
+	if (!ready)
+		return 0;
+
+	grp->epg_inflight = 0;
+	rc = grp->epg_ev.ev_error;
+	if (rc == -DER_KEY2BIG) {
+		/* Same sizing as migration: an EC group merges the keys of all the
+		 * data shards, so the retry buffer needs to cover all of them.
+		 */
+		size = grp->epg_kds[0].kd_key_len * 2;
+		if (ep->ep_is_ec)
+			size *= ep->ep_grp_size;
+		size = roundup(size, 8);
+
+		D_DEBUG(DB_IO, "grp %u key2big, key_len "DF_U64", buf_len "DF_U64"\n",
+			(uint32_t)(grp - ep->ep_grps), grp->epg_kds[0].kd_key_len, size);
+		rc = enum_par_grp_alloc(grp, grp->epg_kds_cap, max(size, grp->epg_buf_len));
+		if (rc == 0)
+			rc = enum_par_grp_issue(ep, grp);
+		return rc;
+	} else if (rc != 0) {
+		D_ERROR("list dkey of grp %u failed: "DF_RC"\n",
+			(uint32_t)(grp - ep->ep_grps), DP_RC(rc));
+		return rc;
+	}
+
+	if (daos_anchor_is_eof(&grp->epg_anchor)) {
+		grp->epg_eof = 1;
+	} else if (grp->epg_nr == grp->epg_kds_cap) {
+		grp->epg_grow_kds = 1;
+	} else {
+		grp->epg_grow_buf = 1;
+	}
+
+	*done = true;
+	return 0;
+}
+
+/**
+ * Open a parallel dkey enumeration of object \a oh, the first batch of all of
+ * the redundancy groups is sent immediately.
+ *
+ * \param[in]	oh	Object handle.
+ * \param[in]	th	Transaction handle.
+ * \param[in]	nr	Number of keys of the first batch per group, 0 for default.
+ *			The batch is adjusted by the later replies.
+ * \param[out]	epp	Returned enumeration context.
+ */
+int
+dc_obj_list_dkey_par_open(daos_handle_t oh, daos_handle_t th, uint32_t nr,
+			  struct dc_obj_enum_par **epp)
+{
+	struct dc_obj_enum_par	*ep;
+	struct dc_object	*obj;
+	uint32_t		 grp_nr;
+	int			 i;
+	int			 rc = 0;
+
+	obj = obj_hdl2ptr(oh);
+	if (obj == NULL)
+		return -DER_NO_HDL;
+
+	grp_nr = obj->cob_grp_nr;
+	D_ALLOC(ep, sizeof(*ep) + grp_nr * sizeof(ep->ep_grps[0]));
+	if (ep == NULL) {
+		obj_decref(obj);
+		return -DER_NOMEM;
+	}
+
+	ep->ep_oh = oh;
+	ep->ep_th = th;
+	ep->ep_grp_size = obj_get_grp_size(obj);
+	ep->ep_is_ec = obj_is_ec(obj);
+	obj_decref(obj);
+
+	if (nr == 0)
+		nr = ENUM_PAR_NR_DEF;
+	nr = min(nr, ENUM_PAR_NR_MAX);
+
+	for (i = 0; i < grp_nr; i++) {
+		struct enum_par_grp *grp = &ep->ep_grps[i];
+
+		rc = daos_event_init(&grp->epg_ev, DAOS_HDL_INVAL, NULL);
+		if (rc != 0)
+			break;
+		/* Only the groups with valid event are cleaned up on close */
+		ep->ep_grp_nr++;
+
+		dc_obj_shard2anchor(&grp->epg_anchor, i * ep->ep_grp_size);
+		rc = enum_par_grp_alloc(grp, nr, (daos_size_t)nr * ENUM_PAR_KEY_SIZE);
+		if (rc != 0)
+			break;
+	}
+
+	if (rc == 0) {
+		for (i = 0; i < grp_nr; i++) {
+			rc = enum_par_grp_issue(ep, &ep->ep_grps[i]);
+			if (rc != 0)
+				break;
+		}
+	}
+
+	if (rc != 0) {
+		dc_obj_list_dkey_par_close(ep);
+		return rc;
+	}
+
+	D_DEBUG(DB_IO, "parallel dkey enumeration on %u groups, nr %u\n", grp_nr, nr);
+	*epp = ep;
+	return 0;
+}
+
+/**
+ * Return the next keys of a parallel dkey enumeration. Keys of different groups
+ * are merged in no specific order. The call only blocks if no key is available
+ * from any of the groups yet.
+ *
+ * \param[in]	ep	Enumeration context.
+ * \param[in,out]
+ *		nr	[in]: number of key descriptors in \a kds.
+ *			[out]: number of returned keys.
+ * \param[out]	kds	Key descriptors.
+ * \param[in]	sgl	Key buffer, only the first iov is used.
+ * \param[out]	eof	Set when all of the groups have been enumerated.
+ *
+ * \return	0 on success, -DER_KEY2BIG if the next key doesn't fit in the
+ *		buffer, the required size is returned in kds[0].kd_key_len.
+ */
+int
+dc_obj_list_dkey_par_next(struct dc_obj_enum_par *ep, uint32_t *nr, daos_key_desc_t *kds,
+			  d_sg_list_t *sgl, bool *eof)
+{
+	struct enum_par_grp	*grp;
+	d_iov_t			*iov;
+	uint32_t		 copied = 0;
+	uint32_t		 i;
+	bool			 done;
+	int			 rc;
+
+	if (*nr == 0 || sgl == NULL || sgl->sg_nr == 0)
+		return -DER_INVAL;
+
+	iov = &sgl->sg_iovs[0];
+	iov->iov_len = 0;
+	*eof = false;
+
+	while (1) {
+		struct enum_par_grp	*wait_grp = NULL;
+		bool			 all_eof = true;
+
+		for (i = 0; i < ep->ep_grp_nr; i++) {
+			grp = &ep->ep_grps[(ep->ep_cur + i) % ep->ep_grp_nr];
+
+			if (grp->epg_inflight) {
+				rc = enum_par_grp_poll(ep, grp, false, &done);
+				if (rc != 0)
+					return rc;
+				if (!done) {
+					all_eof = false;
+					if (wait_grp == NULL)
+						wait_grp = grp;
+					continue;
+				}
+			}
+
+			for (; grp->epg_idx < grp->epg_nr && copied < *nr; grp->epg_idx++) {
+				daos_key_desc_t	*kd = &grp->epg_kds[grp->epg_idx];
+
+				if (iov->iov_len + kd->kd_key_len > iov->iov_buf_len) {
+					if (copied == 0) {
+						kds[0].kd_key_len = kd->kd_key_len;
+						*nr = 0;
+						return -DER_KEY2BIG;
+					}
+					break;
+				}
+
+				memcpy(iov->iov_buf + iov->iov_len, grp->epg_buf + grp->epg_off,
+				       kd->kd_key_len);
+				iov->iov_len += kd->kd_key_len;
+				grp->epg_off += kd->kd_key_len;
+				kds[copied++] = *kd;
+			}
+
+			if (grp->epg_idx < grp->epg_nr) {
+				all_eof = false;
+				continue;
+			}
+
+			/* Batch consumed, prefetch the next one of this group */
+			if (!grp->epg_eof) {
+				rc = enum_par_grp_issue(ep, grp);
+				if (rc != 0)
+					return rc;
+				all_eof = false;
+				if (wait_grp == NULL)
+					wait_grp = grp;
+			}
+		}
+
+		if (copied > 0 || all_eof)
+			break;
+
+		D_ASSERT(wait_grp != NULL);
+		rc = enum_par_grp_poll(ep, wait_grp, true, &done);
+		if (rc != 0)
+			return rc;
+	}
+
+	ep->ep_cur = (ep->ep_cur + 1) % ep->ep_grp_nr;
+	sgl->sg_nr_out = 1;
+	*nr = copied;
+	*eof = (copied == 0);
+	return 0;
+}
+
+/** Close a parallel dkey enumeration, wait for the in-flight requests if any. */
+void
+dc_obj_list_dkey_par_close(struct dc_obj_enum_par *ep)
+{
+	struct enum_par_grp	*grp;
+	bool			 ready;
+	int			 i;
+	int			 rc;
+
+	for (i = 0; i < ep->ep_grp_nr; i++) {
+		grp = &ep->ep_grps[i];
+
+		if (grp->epg_inflight) {
+			rc = daos_event_test(&grp->epg_ev, DAOS_EQ_WAIT, &ready);
+			if (rc != 0)
+				D_ERROR("wait for grp %d failed: "DF_RC"\n", i, DP_RC(rc));
+		}
+
+		rc = daos_event_fini(&grp->epg_ev);
+		if (rc != 0)
+			D_ERROR("fini event of grp %d failed: "DF_RC"\n", i, DP_RC(rc));
+		D_FREE(grp->epg_kds);
+		D_FREE(grp->epg_buf);
+	}
+
+	D_FREE(ep);
+}
@@ -68,6 +68,17 @@ dc_obj_init(void)
 		D_GOTO(out_class, rc);
 	}
 
+	rc = obj_cache_init();
+	if (rc) {
+		D_ERROR("failed to obj_cache_init: "DF_RC"\n", DP_RC(rc));
+		obj_ec_codec_fini();
+		if (dc_obj_proto_version == DAOS_OBJ_VERSION - 1)
+			daos_rpc_unregister(&obj_proto_fmt_0);
+		else
+			daos_rpc_unregister(&obj_proto_fmt_1);
+		D_GOTO(out_class, rc);
+	}
+
 	tx_verify_rdg = false;
 	d_getenv_bool("DAOS_TX_VERIFY_RDG", &tx_verify_rdg);
 	D_INFO("%s TX redundancy group verification\n", tx_verify_rdg ? "Enable" : "Disable");
@@ -91,6 +102,7 @@ dc_obj_fini(void)
 		daos_rpc_unregister(&obj_proto_fmt_0);
 	else
 		daos_rpc_unregister(&obj_proto_fmt_1);
+	obj_cache_fini();
 	obj_ec_codec_fini();
 	obj_class_fini();
 	obj_utils_fini();
@@ -308,8 +308,7 @@ obj_layout_create(struct dc_object *obj, unsigned int mode, bool refresh)
 	obj->cob_md.omd_pdom_lvl = dc_obj_get_pdom(obj);
 	obj->cob_md.omd_fdom_lvl = dc_obj_get_redun_lvl(obj);
 	obj->cob_md.omd_pda = dc_obj_get_pda(obj);
-	rc = obj_pl_place(map, obj->cob_layout_version, &obj->cob_md, mode,
-			  NULL, &layout);
+	rc = pl_obj_place_cached(map, obj->cob_layout_version, &obj->cob_md, mode, &layout);
 	pl_map_decref(map);
 	if (rc != 0) {
 		D_DEBUG(DB_PL, DF_OID" Failed to generate object layout fdom_lvl %d\n",
@@ -4896,6 +4895,11 @@ obj_comp_cb(tse_task_t *task, void *data)
 			obj_ec_comp_cb(obj_auxi);
 		else
 			obj_reasb_io_fini(obj_auxi, false);
+
+		/* The user iods/sgls have been restored, cache the fetched data. */
+		if (obj_auxi->opc == DAOS_OBJ_RPC_FETCH && task->dt_result == 0 &&
+		    !obj_auxi->cache_hit)
+			obj_cache_fill(obj, dc_task_get_args(task));
 	}
 
 	obj_decref(obj);
@@ -5481,6 +5485,14 @@ dc_obj_fetch_task(tse_task_t *task)
 		D_GOTO(out_task, rc);
 	}
 
+	obj_auxi->cache_hit = 0;
+	if (!obj_auxi->io_retry && obj_cache_fetch(obj, args)) {
+		obj_auxi->cache_hit = 1;
+		D_GOTO(out_task, rc = 0);
+	}
+	if (DAOS_FAIL_CHECK(DAOS_OBJ_CACHE_ONLY))
+		D_GOTO(out_task, rc = -DER_IO);
+
 	if (obj_req_with_cond_flags(args->flags)) {
 		rc = obj_cond_fetch_prep(task, obj_auxi);
 		D_ASSERT(rc <= 1);
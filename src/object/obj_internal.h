@@ -397,7 +397,9 @@ struct obj_auxi_args {
 					 cond_fetch_split:1,
 					 reintegrating:1,
 					 tx_renew:1,
-					 rebuilding:1;
+					 rebuilding:1,
+					 /* fetch served by the client read cache */
+					 cache_hit:1;
 	/* request flags. currently only: ORF_RESEND */
 	uint32_t			 flags;
 	uint32_t			 specified_shard;
@@ -720,6 +722,25 @@ struct dc_object *obj_hdl2ptr(daos_handle_t oh);
 uint32_t dc_obj_retry_delay(tse_task_t *task, int err, uint16_t *retry_cnt,
 			    uint16_t *inprogress_cnt);
 
+/* Stages of the sampled object RPC trace, see obj_trace_add() */
+enum obj_stage {
+	/* From RPC arrival to the handler, including scheduler throttling */
+	OBJ_STAGE_QUEUE,
+	/* VOS begin and end */
+	OBJ_STAGE_VOS,
+	/* Waiting for the per-xstream DMA buffer */
+	OBJ_STAGE_DMA_WAIT,
+	/* Waiting for NVMe I/O completion */
+	OBJ_STAGE_NVME,
+	/* Other BIO prepare and post work, e.g. buffer mapping and checksum */
+	OBJ_STAGE_BIO,
+	/* Bulk transfer or data copy from/to the RPC buffer */
+	OBJ_STAGE_BULK,
+	/* Sending the reply */
+	OBJ_STAGE_REPLY,
+	OBJ_STAGE_NR,
+};
+
 /* handles, pointers for handling I/O */
 struct obj_io_context {
 	struct ds_cont_hdl	*ioc_coh;
@@ -732,10 +753,13 @@ struct obj_io_context {
 	uint32_t		 ioc_opc;
 	uint64_t		 ioc_start_time;
 	uint64_t		 ioc_io_size;
+	/* Per-stage time (nsecs) of the sampled RPC, valid if ioc_traced is set */
+	uint64_t		 ioc_stages[OBJ_STAGE_NR];
 	uint32_t		 ioc_began:1,
 				 ioc_free_sgls:1,
 				 ioc_lost_reply:1,
-				 ioc_fetch_snap:1;
+				 ioc_fetch_snap:1,
+				 ioc_traced:1;
 };
 
 static inline uint64_t
@@ -855,6 +879,9 @@ int
 dc_tx_hdl2epoch_and_pmv(daos_handle_t th, struct dtx_epoch *epoch,
 			uint32_t *pmv);
 
+bool
+dc_tx_hdl_is_snap(daos_handle_t th, daos_epoch_t *epoch);
+
 /** See dc_tx_get_epoch. */
 enum dc_tx_get_epoch_rc {
 	DC_TX_GE_CHOSEN,
@@ -882,6 +909,19 @@ dc_tx_convert(struct dc_object *obj, enum obj_rpc_opc opc, tse_task_t *task);
 int
 iov_alloc_for_csum_info(d_iov_t *iov, struct dcs_csum_info *csum_info);
 
+/* cli_cache.c */
+int
+obj_cache_init(void);
+
+void
+obj_cache_fini(void);
+
+bool
+obj_cache_fetch(struct dc_object *obj, daos_obj_fetch_t *args);
+
+void
+obj_cache_fill(struct dc_object *obj, daos_obj_fetch_t *args);
+
 /* obj_layout.c */
 int
 obj_pl_grp_idx(uint32_t layout_gl_ver, uint64_t hash, uint32_t grp_nr);
@@ -793,6 +793,32 @@ dc_tx_hdl2epoch_and_pmv(daos_handle_t th, struct dtx_epoch *epoch,
 	return rc;
 }
 
+/**
+ * Return true if \a th is a read-only TX on a fixed epoch, i.e. opened by
+ * dc_tx_open_snap(), then the data it reads are immutable. The epoch will be
+ * returned via \a epoch.
+ */
+bool
+dc_tx_hdl_is_snap(daos_handle_t th, daos_epoch_t *epoch)
+{
+	struct dc_tx	*tx;
+	bool		 snap = false;
+
+	tx = dc_tx_hdl2ptr(th);
+	if (tx == NULL)
+		return false;
+
+	D_MUTEX_LOCK(&tx->tx_lock);
+	if (tx->tx_fixed_epoch && tx->tx_flags & DAOS_TF_RDONLY && tx->tx_status == TX_OPEN) {
+		*epoch = tx->tx_epoch.oe_value;
+		snap = true;
+	}
+	D_MUTEX_UNLOCK(&tx->tx_lock);
+	dc_tx_decref(tx);
+
+	return snap;
+}
+
 static int
 complete_epoch_task(tse_task_t *task, void *arg)
 {
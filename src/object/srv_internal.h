@@ -16,7 +16,9 @@
 #include <daos_srv/daos_engine.h>
 #include <daos_srv/dtx_srv.h>
 #include <daos_srv/object.h>
+#include <daos_srv/rebuild.h>
 #include <gurt/telemetry_common.h>
+#include <gurt/telemetry_consumer.h>
 #include <gurt/telemetry_producer.h>
 
 #include "obj_internal.h"
@@ -43,9 +45,14 @@ struct migrate_pool_tls {
 	uuid_t			mpt_coh_uuid;
 	daos_handle_t		mpt_pool_hdl;
 
-	/* Container/objects to be migrated will be attached to the tree */
-	daos_handle_t		mpt_root_hdl;
-	struct btr_root		mpt_root;
+	/*
+	 * Container/objects to be migrated will be attached to the tree of
+	 * their rebuild priority, the higher priority is migrated first.
+	 */
+	daos_handle_t		mpt_root_hdls[REBUILD_PRIO_NR];
+	struct btr_root		mpt_roots[REBUILD_PRIO_NR];
+	/* Priority of the tree being migrated by migrate_ult */
+	unsigned int		mpt_prio;
 
 	/* Container/objects already migrated will be attached to the tree, to
 	 * avoid the object being migrated multiple times.
@@ -86,6 +93,8 @@ struct migrate_pool_tls {
 	 */
 	uint64_t		mpt_inflight_size;
 	uint64_t		mpt_inflight_max_size;
+	/* The number of dkeys being migrated on the xstream */
+	uint32_t		mpt_inflight_ult;
 	ABT_cond		mpt_inflight_cond;
 	ABT_mutex		mpt_inflight_mutex;
 	int			mpt_inflight_max_ult;
@@ -106,6 +115,52 @@ struct migrate_pool_tls {
 void
 migrate_pool_tls_destroy(struct migrate_pool_tls *tls);
 
+/* Return the highest priority with objects to be migrated, REBUILD_PRIO_NR if none */
+static inline unsigned int
+migrate_tree_prio_first(struct migrate_pool_tls *tls)
+{
+	unsigned int	prio;
+
+	for (prio = 0; prio < REBUILD_PRIO_NR; prio++) {
+		if (!dbtree_is_empty(tls->mpt_root_hdls[prio]))
+			break;
+	}
+	return prio;
+}
+
+/*
+ * Objects of a higher priority are inserted by ds_migrate_object() while the
+ * lower ones are being migrated, stop so that they can be migrated first.
+ */
+static inline bool
+migrate_preempted(struct migrate_pool_tls *tls)
+{
+	return migrate_tree_prio_first(tls) < tls->mpt_prio;
+}
+
+/*
+ * Migrate the containers of the to-be-migrated trees with \a cont_cb, from the
+ * highest priority. \a cont_cb stops the iteration once migrate_preempted(),
+ * then the trees are walked again from the highest priority.
+ */
+static inline int
+migrate_trees_drain(struct migrate_pool_tls *tls, dbtree_iterate_cb_t cont_cb)
+{
+	int	rc = 0;
+
+	while (!tls->mpt_fini) {
+		tls->mpt_prio = migrate_tree_prio_first(tls);
+		if (tls->mpt_prio == REBUILD_PRIO_NR)
+			break;
+
+		rc = dbtree_iterate(tls->mpt_root_hdls[tls->mpt_prio], DAOS_INTENT_PURGE, false,
+				    cont_cb, tls);
+		if (rc < 0)
+			break;
+	}
+	return rc;
+}
+
 /*
  * Report latency on a per-I/O size.
  * Buckets starts at [0; 256B[ and are increased by power of 2
@@ -116,6 +171,77 @@ migrate_pool_tls_destroy(struct migrate_pool_tls *tls);
  */
 #define NR_LATENCY_BUCKETS 16
 
+/* Number of the slowest sampled RPCs kept per target, see obj_trace_record() */
+#define OBJ_TRACE_SLOW_NR	8
+/* Period (seconds) after which the slowest sampled RPCs are forgotten */
+#define OBJ_TRACE_SLOW_WINDOW	60
+
+/* Trace 1 out of every obj_trace_intvl RPCs, 0 disables the tracing */
+extern unsigned int obj_trace_intvl;
+
+/* Foreground p99 latency (us) to keep rebuild under, 0 disables the throttle */
+extern unsigned int migrate_lat_slo;
+
+/* Lowest percent of the full speed, so that rebuild always makes progress */
+#define MIGRATE_THROTTLE_MIN	5
+/* Percent of the full speed given back per period under the latency target */
+#define MIGRATE_THROTTLE_STEP	10
+/* Foreground samples per period below which the p99 is not trusted to hold the rate */
+#define MIGRATE_THROTTLE_IDLE	32
+
+/* Default and upper bound of the value size packed inline by recursive enumeration */
+#define OBJ_ENUM_INLINE_THRES		32
+#define OBJ_ENUM_INLINE_THRES_MAX	4096
+
+/*
+ * Size the inline threshold by the \a buf_len bytes of key buffer the client provided for \a nr
+ * descriptors. The buffer is transferred by bulk once it exceeds the RPC inline limit, so a larger
+ * buffer can carry proportionally more value data per descriptor and save follow-up fetches.
+ */
+static inline uint32_t
+obj_enum_inline_thres(daos_size_t buf_len, uint32_t nr)
+{
+	daos_size_t	thres;
+
+	if (nr == 0)
+		return OBJ_ENUM_INLINE_THRES;
+
+	thres = buf_len / nr;
+	if (thres < OBJ_ENUM_INLINE_THRES)
+		return OBJ_ENUM_INLINE_THRES;
+
+	return min(thres, OBJ_ENUM_INLINE_THRES_MAX);
+}
+
+/* Enumeration buffer (KiB) of the batched migration, 0 disables the batching */
+#define MIGRATE_BATCH_SIZE_DEF		128
+extern unsigned int migrate_batch_size;
+
+/* Stage breakdown of one sampled RPC */
+struct obj_trace_rec {
+	uint64_t		otr_total;
+	uint64_t		otr_stages[OBJ_STAGE_NR];
+	uint32_t		otr_opc;
+};
+
+/*
+ * Per target state of the migration throttle, see migrate_throttle_rate().
+ * The rate is the percent of the full migration speed allowed on the target.
+ */
+struct obj_migrate_throttle {
+	/** Foreground latency samples seen so far */
+	struct d_tm_hdr_snap_t	mt_prev;
+	/** Foreground latency samples of the last interval */
+	struct d_tm_hdr_snap_t	mt_snap;
+	/** Time (seconds) of the last adjustment */
+	uint64_t		mt_last;
+	uint32_t		mt_rate;
+	/** Percent of full rebuild speed (type = gauge) */
+	struct d_tm_node_t	*mt_rate_tm;
+	/** Foreground p99 latency of the last interval in us (type = gauge) */
+	struct d_tm_node_t	*mt_p99_tm;
+};
+
 struct obj_pool_metrics {
 	/** Count number of total per-opcode requests (type = counter) */
 	struct d_tm_node_t	*opm_total[OBJ_PROTO_CLI_COUNT];
@@ -159,6 +285,37 @@ struct obj_tls {
 
 	struct d_tm_node_t	*ot_update_bio_lat[NR_LATENCY_BUCKETS];
 	struct d_tm_node_t	*ot_fetch_bio_lat[NR_LATENCY_BUCKETS];
+
+	/** Distribution of the above latencies for all I/O sizes (type = HDR histogram) */
+	struct d_tm_node_t	*ot_update_lat_hdr;
+	struct d_tm_node_t	*ot_fetch_lat_hdr;
+	struct d_tm_node_t	*ot_tgt_update_lat_hdr;
+	struct d_tm_node_t	*ot_update_bulk_lat_hdr;
+	struct d_tm_node_t	*ot_fetch_bulk_lat_hdr;
+	struct d_tm_node_t	*ot_update_vos_lat_hdr;
+	struct d_tm_node_t	*ot_fetch_vos_lat_hdr;
+	struct d_tm_node_t	*ot_update_bio_lat_hdr;
+	struct d_tm_node_t	*ot_fetch_bio_lat_hdr;
+	/** Latency of update and non-migration fetch RPCs (type = HDR histogram) */
+	struct d_tm_node_t	*ot_fg_lat_hdr;
+
+	/** Throttle of the migration by the foreground latency */
+	struct obj_migrate_throttle	ot_mig_throttle;
+
+	/** Per-stage latency of sampled update/fetch RPCs in us (type = gauge) */
+	struct d_tm_node_t	*ot_stage_lat[OBJ_PROTO_CLI_COUNT][OBJ_STAGE_NR];
+	/** Breakdown of the slowest sampled RPCs, see ot_slow (type = gauge) */
+	struct d_tm_node_t	*ot_slow_opc[OBJ_TRACE_SLOW_NR];
+	struct d_tm_node_t	*ot_slow_lat[OBJ_TRACE_SLOW_NR];
+	struct d_tm_node_t	*ot_slow_stage[OBJ_TRACE_SLOW_NR][OBJ_STAGE_NR];
+
+	/** Count of RPCs for sampling */
+	uint64_t		ot_trace_cnt;
+	/** Start of the current window (seconds) of the slowest sampled RPCs */
+	uint64_t		ot_slow_start;
+	/** The slowest sampled RPCs, sorted by total time in descending order */
+	struct obj_trace_rec	ot_slow[OBJ_TRACE_SLOW_NR];
+	uint32_t		ot_slow_nr;
 };
 
 static inline struct obj_tls *
@@ -196,6 +353,7 @@ obj_update_latency(uint32_t opc, uint32_t type, uint64_t latency, uint64_t io_si
 {
 	struct obj_tls		*tls = obj_tls_get();
 	struct d_tm_node_t	*lat;
+	struct d_tm_node_t	*hdr;
 
 	latency >>= 10; /* convert to micro seconds */
 
@@ -203,12 +361,15 @@ obj_update_latency(uint32_t opc, uint32_t type, uint64_t latency, uint64_t io_si
 		switch (type) {
 		case BULK_LATENCY:
 			lat = tls->ot_fetch_bulk_lat[lat_bucket(io_size)];
+			hdr = tls->ot_fetch_bulk_lat_hdr;
 			break;
 		case BIO_LATENCY:
 			lat = tls->ot_fetch_bio_lat[lat_bucket(io_size)];
+			hdr = tls->ot_fetch_bio_lat_hdr;
 			break;
 		case VOS_LATENCY:
 			lat = tls->ot_fetch_vos_lat[lat_bucket(io_size)];
+			hdr = tls->ot_fetch_vos_lat_hdr;
 			break;
 		default:
 			D_ASSERT(0);
@@ -217,12 +378,15 @@ obj_update_latency(uint32_t opc, uint32_t type, uint64_t latency, uint64_t io_si
 		switch (type) {
 		case BULK_LATENCY:
 			lat = tls->ot_update_bulk_lat[lat_bucket(io_size)];
+			hdr = tls->ot_update_bulk_lat_hdr;
 			break;
 		case BIO_LATENCY:
 			lat = tls->ot_update_bio_lat[lat_bucket(io_size)];
+			hdr = tls->ot_update_bio_lat_hdr;
 			break;
 		case VOS_LATENCY:
 			lat = tls->ot_update_vos_lat[lat_bucket(io_size)];
+			hdr = tls->ot_update_vos_lat_hdr;
 			break;
 		default:
 			D_ASSERT(0);
@@ -232,6 +396,100 @@ obj_update_latency(uint32_t opc, uint32_t type, uint64_t latency, uint64_t io_si
 		return;
 	}
 	d_tm_set_gauge(lat, latency);
+	d_tm_record_hdr(hdr, latency);
+}
+
+/* Current time for the stage trace, or 0 if the RPC is not sampled */
+static inline uint64_t
+obj_trace_now(struct obj_io_context *ioc)
+{
+	return ioc->ioc_traced ? daos_get_ntime() : 0;
+}
+
+static inline void
+obj_trace_add(struct obj_io_context *ioc, enum obj_stage stage, uint64_t time)
+{
+	if (ioc->ioc_traced)
+		ioc->ioc_stages[stage] += time;
+}
+
+/* Account the time since @start, which is from obj_trace_now(), to @stage */
+static inline void
+obj_trace_since(struct obj_io_context *ioc, enum obj_stage stage, uint64_t start)
+{
+	if (ioc->ioc_traced)
+		ioc->ioc_stages[stage] += daos_get_ntime() - start;
+}
+
+/* Sample 1 out of every @intvl RPCs counted by @cnt, 0 disables the sampling */
+static inline bool
+obj_trace_sampled(uint64_t *cnt, unsigned int intvl)
+{
+	return intvl != 0 && ++(*cnt) % intvl == 0;
+}
+
+/* Start the trace of the sampled RPC, which CaRT dispatched at @arrive (0 if unknown) */
+static inline void
+obj_trace_start(struct obj_io_context *ioc, uint64_t arrive)
+{
+	ioc->ioc_traced = 1;
+	if (arrive != 0 && arrive < ioc->ioc_start_time)
+		ioc->ioc_stages[OBJ_STAGE_QUEUE] = ioc->ioc_start_time - arrive;
+}
+
+/*
+ * Split the @time spent in the bio prep and post into the waits for the DMA
+ * buffer and for NVMe, reported by bio_iod_wait_time(), and the other work.
+ */
+static inline void
+obj_trace_bio(struct obj_io_context *ioc, uint64_t time, uint64_t dma_wait, uint64_t nvme_wait)
+{
+	obj_trace_add(ioc, OBJ_STAGE_DMA_WAIT, dma_wait);
+	obj_trace_add(ioc, OBJ_STAGE_NVME, nvme_wait);
+	if (time > dma_wait + nvme_wait)
+		obj_trace_add(ioc, OBJ_STAGE_BIO, time - dma_wait - nvme_wait);
+}
+
+/*
+ * Forget the slowest sampled RPCs once the window started before @now (seconds)
+ * expired. Return the number of the records cleared, which are to be published.
+ */
+static inline uint32_t
+obj_trace_slow_expire(struct obj_tls *tls, uint64_t now)
+{
+	uint32_t	nr = tls->ot_slow_nr;
+
+	if (now - tls->ot_slow_start < OBJ_TRACE_SLOW_WINDOW)
+		return 0;
+
+	memset(tls->ot_slow, 0, sizeof(tls->ot_slow[0]) * nr);
+	tls->ot_slow_nr = 0;
+	tls->ot_slow_start = now;
+	return nr;
+}
+
+/*
+ * Keep @rec if it is one of the slowest sampled RPCs, which are sorted in the
+ * descending order of the total time, the fastest one is dropped once full.
+ * Return the index of the first record moved, or -1 if @rec is not kept.
+ */
+static inline int
+obj_trace_slow_insert(struct obj_tls *tls, const struct obj_trace_rec *rec)
+{
+	struct obj_trace_rec	*slow = tls->ot_slow;
+	int			 i;
+
+	if (tls->ot_slow_nr == OBJ_TRACE_SLOW_NR &&
+	    slow[OBJ_TRACE_SLOW_NR - 1].otr_total >= rec->otr_total)
+		return -1;
+
+	if (tls->ot_slow_nr < OBJ_TRACE_SLOW_NR)
+		tls->ot_slow_nr++;
+	for (i = tls->ot_slow_nr - 1; i > 0 && slow[i - 1].otr_total < rec->otr_total; i--)
+		slow[i] = slow[i - 1];
+	slow[i] = *rec;
+
+	return i;
 }
 
 struct ds_obj_exec_arg {
@@ -524,4 +782,8 @@ fill_oid(daos_unit_oid_t oid, struct ds_obj_enum_arg *arg);
 struct obj_rw_in;
 void obj_ec_metrics_process(struct obj_iod_array *iod_array, struct obj_io_context *ioc);
 
+/* srv_mig_throttle.c */
+uint32_t
+migrate_throttle_adjust(uint32_t rate, uint64_t samples, uint64_t p99, uint32_t slo);
+
 #endif /* __DAOS_OBJ_SRV_INTENRAL_H__ */
@@ -0,0 +1,35 @@
+/**
+ * (C) Copyright 2023 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+/**
+ * Rate adjustment of the migration throttle, see migrate_throttle_rate() in
+ * srv_obj_migrate.c.
+ */
+#include <daos/common.h>
+#include "srv_internal.h"
+
+/*
+ * Additive increase, multiplicative decrease of the migration \a rate (percent
+ * of the full speed) by the p99 latency of the \a samples foreground RPCs of
+ * the last period: halved above \a slo, increased by MIGRATE_THROTTLE_STEP
+ * below 80% of it. Below MIGRATE_THROTTLE_IDLE samples the p99 is too coarse to
+ * hold the rate in the band, so it is only used to back off or to step up, and
+ * the rate is back to full speed only when there is no foreground I/O at all.
+ * \a slo is non-zero, zero disables the throttle in migrate_throttle_rate().
+ */
+uint32_t
+migrate_throttle_adjust(uint32_t rate, uint64_t samples, uint64_t p99, uint32_t slo)
+{
+	if (samples == 0)
+		return 100;
+
+	if (p99 > slo)
+		return max(rate / 2, MIGRATE_THROTTLE_MIN);
+
+	if (samples < MIGRATE_THROTTLE_IDLE || p99 < (uint64_t)slo * 4 / 5)
+		return min(rate + MIGRATE_THROTTLE_STEP, 100);
+
+	return rate;
+}
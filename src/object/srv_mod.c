@@ -15,6 +15,12 @@
 #include "obj_rpc.h"
 #include "srv_internal.h"
 
+#define OBJ_TRACE_INTVL_DEF	1024
+
+unsigned int obj_trace_intvl = OBJ_TRACE_INTVL_DEF;
+unsigned int migrate_lat_slo;
+unsigned int migrate_batch_size = MIGRATE_BATCH_SIZE_DEF;
+
 /**
  * Switch of enable DTX or not, enabled by default.
  */
@@ -23,6 +29,15 @@ obj_mod_init(void)
 {
 	int	rc;
 
+	d_getenv_int("DAOS_OBJ_TRACE_INTVL", &obj_trace_intvl);
+	D_INFO("Trace 1 out of every %u object RPCs\n", obj_trace_intvl);
+	d_getenv_int("DAOS_REBUILD_LAT_SLO", &migrate_lat_slo);
+	if (migrate_lat_slo != 0)
+		D_INFO("Throttle rebuild to keep foreground p99 latency under %u us\n",
+		       migrate_lat_slo);
+	d_getenv_int("DAOS_MIGRATE_BATCH_SIZE", &migrate_batch_size);
+	D_INFO("Batched migration enumeration buffer %u KiB\n", migrate_batch_size);
+
 	rc = obj_utils_init();
 	if (rc)
 		goto out;
@@ -74,7 +89,8 @@ static struct daos_rpc_handler obj_handlers[] = {
 #undef X
 
 static int
-obj_latency_tm_init(uint32_t opc, int tgt_id, struct d_tm_node_t **tm, char *op, char *desc)
+obj_latency_tm_init(uint32_t opc, int tgt_id, struct d_tm_node_t **tm, struct d_tm_node_t **hdr,
+		    char *op, char *desc)
 {
 	unsigned int	bucket_max = 256;
 	int		i;
@@ -105,9 +121,107 @@ obj_latency_tm_init(uint32_t opc, int tgt_id, struct d_tm_node_t **tm, char *op,
 		bucket_max <<= 1;
 	}
 
+	/** And the latency distribution of all I/O sizes for the percentiles */
+	rc = d_tm_add_metric(hdr, D_TM_HDR_HISTOGRAM, desc, "us", "io/latency/%s/all/tgt_%u",
+			     op, tgt_id);
+	if (rc)
+		D_WARN("Failed to create latency histogram: "DF_RC"\n", DP_RC(rc));
+
 	return rc;
 }
 
+static const char *
+obj_stage_to_str(enum obj_stage stage)
+{
+	switch (stage) {
+	case OBJ_STAGE_QUEUE:
+		return "queue";
+	case OBJ_STAGE_VOS:
+		return "vos";
+	case OBJ_STAGE_DMA_WAIT:
+		return "dma_wait";
+	case OBJ_STAGE_NVME:
+		return "nvme";
+	case OBJ_STAGE_BIO:
+		return "bio";
+	case OBJ_STAGE_BULK:
+		return "bulk";
+	case OBJ_STAGE_REPLY:
+		return "reply";
+	default:
+		return "unknown";
+	}
+}
+
+static void
+obj_trace_tm_init(struct obj_tls *tls, int tgt_id)
+{
+	uint32_t	opcs[] = { DAOS_OBJ_RPC_UPDATE, DAOS_OBJ_RPC_TGT_UPDATE,
+				   DAOS_OBJ_RPC_FETCH };
+	char		path[D_TM_MAX_NAME_LEN];
+	int		stage;
+	int		i;
+	int		rc;
+
+	/** Per-stage latency histograms of the sampled I/O RPCs, 1us to 32ms+ */
+	for (i = 0; i < ARRAY_SIZE(opcs); i++) {
+		for (stage = 0; stage < OBJ_STAGE_NR; stage++) {
+			snprintf(path, sizeof(path), "io/trace/%s/%s/tgt_%u",
+				 obj_opc_to_str(opcs[i]), obj_stage_to_str(stage), tgt_id);
+			rc = d_tm_add_metric(&tls->ot_stage_lat[opcs[i]][stage],
+					     D_TM_STATS_GAUGE, "sampled RPC stage latency",
+					     "us", "%s", path);
+			if (rc == 0)
+				rc = d_tm_init_histogram(tls->ot_stage_lat[opcs[i]][stage],
+							 path, 16, 1, 2);
+			if (rc)
+				D_WARN("Failed to create stage latency sensor: "DF_RC"\n",
+				       DP_RC(rc));
+		}
+	}
+
+	/** Breakdown of the slowest sampled RPCs */
+	for (i = 0; i < OBJ_TRACE_SLOW_NR; i++) {
+		rc = d_tm_add_metric(&tls->ot_slow_opc[i], D_TM_GAUGE,
+				     "opcode of the slow RPC", NULL,
+				     "io/trace/slowest/%d/opc/tgt_%u", i, tgt_id);
+		if (rc == 0)
+			rc = d_tm_add_metric(&tls->ot_slow_lat[i], D_TM_GAUGE,
+					     "total latency of the slow RPC", "us",
+					     "io/trace/slowest/%d/total/tgt_%u", i, tgt_id);
+		for (stage = 0; rc == 0 && stage < OBJ_STAGE_NR; stage++)
+			rc = d_tm_add_metric(&tls->ot_slow_stage[i][stage], D_TM_GAUGE,
+					     "stage latency of the slow RPC", "us",
+					     "io/trace/slowest/%d/%s/tgt_%u", i,
+					     obj_stage_to_str(stage), tgt_id);
+		if (rc)
+			D_WARN("Failed to create slow RPC sensor: "DF_RC"\n", DP_RC(rc));
+	}
+}
+
+static void
+obj_throttle_tm_init(struct obj_tls *tls, int tgt_id)
+{
+	struct obj_migrate_throttle	*mt = &tls->ot_mig_throttle;
+	int				 rc;
+
+	/** Foreground latency watched by the migration throttle */
+	rc = d_tm_add_metric(&tls->ot_fg_lat_hdr, D_TM_HDR_HISTOGRAM,
+			     "foreground update/fetch RPC processing time", "us",
+			     "io/latency/foreground/tgt_%u", tgt_id);
+	if (rc == 0)
+		rc = d_tm_add_metric(&mt->mt_rate_tm, D_TM_GAUGE,
+				     "percent of full rebuild speed", "%",
+				     "rebuild/throttle/rate/tgt_%u", tgt_id);
+	if (rc == 0)
+		rc = d_tm_add_metric(&mt->mt_p99_tm, D_TM_GAUGE,
+				     "foreground p99 latency seen by the rebuild throttle", "us",
+				     "rebuild/throttle/fg_lat_p99/tgt_%u", tgt_id);
+	if (rc)
+		D_WARN("Failed to create rebuild throttle sensor: "DF_RC"\n", DP_RC(rc));
+	d_tm_set_gauge(mt->mt_rate_tm, mt->mt_rate);
+}
+
 static void *
 obj_tls_init(int tags, int xs_id, int tgt_id)
 {
@@ -120,6 +234,7 @@ obj_tls_init(int tags, int xs_id, int tgt_id)
 		return NULL;
 
 	D_INIT_LIST_HEAD(&tls->ot_pool_list);
+	tls->ot_mig_throttle.mt_rate = 100;
 
 	if (tgt_id < 0)
 		/** skip sensor setup on system xstreams */
@@ -154,32 +269,47 @@ obj_tls_init(int tags, int xs_id, int tgt_id)
 
 	/**
 	 * Maintain per-I/O size latency for update & fetch RPCs
-	 * of type gauge
+	 * of type gauge, plus a HDR histogram for all I/O sizes
 	 */
 
 	obj_latency_tm_init(DAOS_OBJ_RPC_UPDATE, tgt_id, tls->ot_update_lat,
+			    &tls->ot_update_lat_hdr,
 			    obj_opc_to_str(DAOS_OBJ_RPC_UPDATE), "update RPC processing time");
 	obj_latency_tm_init(DAOS_OBJ_RPC_FETCH, tgt_id, tls->ot_fetch_lat,
+			    &tls->ot_fetch_lat_hdr,
 			    obj_opc_to_str(DAOS_OBJ_RPC_FETCH), "fetch RPC processing time");
 
 	obj_latency_tm_init(DAOS_OBJ_RPC_TGT_UPDATE, tgt_id, tls->ot_tgt_update_lat,
+			    &tls->ot_tgt_update_lat_hdr,
 			    obj_opc_to_str(DAOS_OBJ_RPC_TGT_UPDATE),
 			    "update tgt RPC processing time");
 	obj_latency_tm_init(DAOS_OBJ_RPC_UPDATE, tgt_id, tls->ot_update_bulk_lat,
+			    &tls->ot_update_bulk_lat_hdr,
 			    "bulk_update", "Bulk update processing time");
 	obj_latency_tm_init(DAOS_OBJ_RPC_FETCH, tgt_id, tls->ot_fetch_bulk_lat,
+			    &tls->ot_fetch_bulk_lat_hdr,
 			    "bulk_fetch", "Bulk fetch processing time");
 
 	obj_latency_tm_init(DAOS_OBJ_RPC_UPDATE, tgt_id, tls->ot_update_vos_lat,
+			    &tls->ot_update_vos_lat_hdr,
 			    "vos_update", "VOS update processing time");
 	obj_latency_tm_init(DAOS_OBJ_RPC_FETCH, tgt_id, tls->ot_fetch_vos_lat,
+			    &tls->ot_fetch_vos_lat_hdr,
 			    "vos_fetch", "VOS fetch processing time");
 
 	obj_latency_tm_init(DAOS_OBJ_RPC_UPDATE, tgt_id, tls->ot_update_bio_lat,
+			    &tls->ot_update_bio_lat_hdr,
 			    "bio_update", "BIO update processing time");
 	obj_latency_tm_init(DAOS_OBJ_RPC_FETCH, tgt_id, tls->ot_fetch_bio_lat,
+			    &tls->ot_fetch_bio_lat_hdr,
 			    "bio_fetch", "BIO fetch processing time");
 
+	if (obj_trace_intvl != 0)
+		obj_trace_tm_init(tls, tgt_id);
+
+	if (migrate_lat_slo != 0)
+		obj_throttle_tm_init(tls, tgt_id);
+
 	return tls;
 }
 
@@ -195,6 +325,8 @@ obj_tls_fini(int tags, void *data)
 		migrate_pool_tls_destroy(pool_tls);
 
 	d_sgl_fini(&tls->ot_echo_sgl, true);
+	d_tm_hdr_snap_fini(&tls->ot_mig_throttle.mt_prev);
+	d_tm_hdr_snap_fini(&tls->ot_mig_throttle.mt_snap);
 
 	D_FREE(tls);
 }
@@ -206,6 +338,17 @@ struct dss_module_key obj_module_key = {
 	.dmk_fini = obj_tls_fini,
 };
 
+static void
+obj_rw_req_attr(struct obj_rw_in *orw, struct sched_req_attr *attr)
+{
+	daos_size_t	size;
+
+	uuid_copy(attr->sra_cont_id, orw->orw_co_uuid);
+	/* Size of fetch could be unknown */
+	size = daos_iods_len(orw->orw_iod_array.oia_iods, orw->orw_iod_array.oia_iod_nr);
+	attr->sra_size = (size == (daos_size_t)-1) ? 0 : size;
+}
+
 static int
 obj_get_req_attr(crt_rpc_t *rpc, struct sched_req_attr *attr)
 {
@@ -214,11 +357,13 @@ obj_get_req_attr(crt_rpc_t *rpc, struct sched_req_attr *attr)
 
 		sched_req_attr_init(attr, SCHED_REQ_UPDATE,
 				    &orw->orw_pool_uuid);
+		obj_rw_req_attr(orw, attr);
 	} else if (obj_rpc_is_fetch(rpc)) {
 		struct obj_rw_in	*orw = crt_req_get(rpc);
 
 		sched_req_attr_init(attr, SCHED_REQ_FETCH,
 				    &orw->orw_pool_uuid);
+		obj_rw_req_attr(orw, attr);
 	} else if (obj_rpc_is_migrate(rpc)) {
 		struct obj_migrate_in	*omi = crt_req_get(rpc);
 
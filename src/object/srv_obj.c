@@ -134,11 +134,16 @@ obj_rw_complete(crt_rpc_t *rpc, struct obj_io_context *ioc,
 			rc = vos_update_end(ioh, ioc->ioc_map_ver,
 					    &orwi->orw_dkey, status,
 					    &ioc->ioc_io_size, dth);
+			time = daos_get_ntime() - time;
+			obj_trace_add(ioc, OBJ_STAGE_VOS, time);
 			if (rc == 0)
-				obj_update_latency(ioc->ioc_opc, VOS_LATENCY,
-						   daos_get_ntime() - time, ioc->ioc_io_size);
+				obj_update_latency(ioc->ioc_opc, VOS_LATENCY, time,
+						   ioc->ioc_io_size);
 		} else {
+			uint64_t time = obj_trace_now(ioc);
+
 			rc = vos_fetch_end(ioh, &ioc->ioc_io_size, status);
+			obj_trace_since(ioc, OBJ_STAGE_VOS, time);
 		}
 
 		if (rc != 0) {
@@ -184,9 +189,12 @@ obj_rw_reply(crt_rpc_t *rpc, int status, uint64_t epoch,
 		ioc->ioc_map_ver, orwo->orw_epoch, status);
 
 	if (!ioc->ioc_lost_reply) {
+		uint64_t time = obj_trace_now(ioc);
+
 		rc = crt_reply_send(rpc);
 		if (rc != 0)
 			D_ERROR("send reply failed: "DF_RC"\n", DP_RC(rc));
+		obj_trace_since(ioc, OBJ_STAGE_REPLY, time);
 	} else {
 		D_WARN("lost reply rpc %p\n", rpc);
 	}
@@ -1391,11 +1399,13 @@ obj_local_rw_internal(crt_rpc_t *rpc, struct obj_io_context *ioc, daos_iod_t *io
 		if (orw->orw_flags & ORF_EC)
 			cond_flags |= VOS_OF_EC;
 
+		time = obj_trace_now(ioc);
 		rc = vos_update_begin(ioc->ioc_vos_coh, orw->orw_oid,
 			      orw->orw_epoch, cond_flags, dkey,
 			      iods_nr, iods, iod_csums,
 			      ioc->ioc_coc->sc_props.dcp_dedup_size,
 			      &ioh, dth);
+		obj_trace_since(ioc, OBJ_STAGE_VOS, time);
 		if (rc) {
 			D_ERROR(DF_UOID" Update begin failed: "DF_RC"\n",
 				DP_UOID(orw->orw_oid), DP_RC(rc));
@@ -1489,6 +1499,8 @@ obj_local_rw_internal(crt_rpc_t *rpc, struct obj_io_context *ioc, daos_iod_t *io
 		rc = vos_fetch_begin(ioc->ioc_vos_coh, orw->orw_oid,
 				     orw->orw_epoch, dkey, iods_nr, iods,
 				     cond_flags | fetch_flags, shadows, &ioh, dth);
+		time = daos_get_ntime() - time;
+		obj_trace_add(ioc, OBJ_STAGE_VOS, time);
 		daos_recx_ep_list_free(shadows, iods_nr);
 		if (rc) {
 			DL_CDEBUG(rc == -DER_INPROGRESS || rc == -DER_NONEXIST ||
@@ -1498,8 +1510,7 @@ obj_local_rw_internal(crt_rpc_t *rpc, struct obj_io_context *ioc, daos_iod_t *io
 			goto out;
 		}
 
-		obj_update_latency(ioc->ioc_opc, VOS_LATENCY, daos_get_ntime() - time,
-				   vos_get_io_size(ioh));
+		obj_update_latency(ioc->ioc_opc, VOS_LATENCY, time, vos_get_io_size(ioh));
 
 		if (get_parity_list) {
 			parity_list = vos_ioh2recx_list(ioh);
@@ -1623,6 +1634,7 @@ obj_local_rw_internal(crt_rpc_t *rpc, struct obj_io_context *ioc, daos_iod_t *io
 		goto post;
 	}
 
+	time = obj_trace_now(ioc);
 	if (rma) {
 		bulk_bind = orw->orw_flags & ORF_BULK_BIND;
 		rc = obj_bulk_transfer(rpc, bulk_op, bulk_bind, orw->orw_bulks.ca_arrays, offs,
@@ -1644,6 +1656,7 @@ obj_local_rw_internal(crt_rpc_t *rpc, struct obj_io_context *ioc, daos_iod_t *io
 	} else if (orw->orw_sgls.ca_arrays != NULL) {
 		rc = bio_iod_copy(biod, orw->orw_sgls.ca_arrays, iods_nr);
 	}
+	obj_trace_since(ioc, OBJ_STAGE_BULK, time);
 
 	if (rc) {
 		if (rc == -DER_OVERFLOW)
@@ -1692,6 +1705,14 @@ post:
 	time = daos_get_ntime();
 	rc = bio_iod_post_async(biod, rc);
 	bio_post_latency = daos_get_ntime() - time;
+	if (ioc->ioc_traced) {
+		uint64_t	dma_wait;
+		uint64_t	nvme_wait;
+
+		/* NVMe completion of async post is waited on VOS update end */
+		bio_iod_wait_time(biod, &dma_wait, &nvme_wait);
+		obj_trace_bio(ioc, bio_pre_latency + bio_post_latency, dma_wait, nvme_wait);
+	}
 out:
 	/* The DTX has been aborted during long time bulk data transfer. */
 	if (unlikely(dth->dth_aborted))
@@ -2205,9 +2226,63 @@ out:
 	d_tm_inc_gauge(tls->ot_op_active[opc_get(rpc->cr_opc)], 1);
 	ioc->ioc_start_time = daos_get_ntime();
 	ioc->ioc_began = 1;
+
+	/** sample the RPC for the stage trace */
+	if (obj_trace_sampled(&tls->ot_trace_cnt, obj_trace_intvl)) {
+		uint64_t	arrive;
+
+		if (crt_req_arrive_time_get(rpc, &arrive) != 0)
+			arrive = 0;
+		obj_trace_start(ioc, arrive);
+	}
 	return rc;
 }
 
+/* Publish the stage breakdown of the slow RPC at @idx of the slowest RPCs */
+static void
+obj_trace_slow_publish(struct obj_tls *tls, int idx)
+{
+	struct obj_trace_rec	*rec = &tls->ot_slow[idx];
+	int			 stage;
+
+	d_tm_set_gauge(tls->ot_slow_opc[idx], rec->otr_opc);
+	d_tm_set_gauge(tls->ot_slow_lat[idx], rec->otr_total >> 10);
+	for (stage = 0; stage < OBJ_STAGE_NR; stage++)
+		d_tm_set_gauge(tls->ot_slow_stage[idx][stage], rec->otr_stages[stage] >> 10);
+}
+
+/*
+ * Aggregate the stages of the sampled RPC into the per-opcode stage latency,
+ * and keep it if it is one of the slowest sampled RPCs of the current window.
+ */
+static void
+obj_trace_record(struct obj_tls *tls, struct obj_io_context *ioc, uint64_t time)
+{
+	struct obj_trace_rec	 rec;
+	uint32_t		 nr;
+	int			 stage;
+	int			 i;
+
+	for (stage = 0; stage < OBJ_STAGE_NR; stage++)
+		d_tm_set_gauge(tls->ot_stage_lat[ioc->ioc_opc][stage],
+			       ioc->ioc_stages[stage] >> 10);
+
+	nr = obj_trace_slow_expire(tls, daos_gettime_coarse());
+	for (i = 0; i < nr; i++)
+		obj_trace_slow_publish(tls, i);
+
+	rec.otr_opc = ioc->ioc_opc;
+	rec.otr_total = time + ioc->ioc_stages[OBJ_STAGE_QUEUE];
+	memcpy(rec.otr_stages, ioc->ioc_stages, sizeof(rec.otr_stages));
+
+	i = obj_trace_slow_insert(tls, &rec);
+	if (i < 0)
+		return;
+
+	for (; i < tls->ot_slow_nr; i++)
+		obj_trace_slow_publish(tls, i);
+}
+
 static inline void
 obj_update_sensors(struct obj_io_context *ioc, int err)
 {
@@ -2215,6 +2290,7 @@ obj_update_sensors(struct obj_io_context *ioc, int err)
 	struct obj_pool_metrics	*opm;
 	struct obj_rw_in	*orw;
 	struct d_tm_node_t	*lat;
+	struct d_tm_node_t	*hdr = NULL;
 	uint32_t		opc = ioc->ioc_opc;
 	uint64_t		time;
 
@@ -2237,6 +2313,8 @@ obj_update_sensors(struct obj_io_context *ioc, int err)
 	case DAOS_OBJ_RPC_UPDATE:
 		d_tm_inc_counter(opm->opm_update_bytes, ioc->ioc_io_size);
 		lat = tls->ot_update_lat[lat_bucket(ioc->ioc_io_size)];
+		hdr = tls->ot_update_lat_hdr;
+		d_tm_record_hdr(tls->ot_fg_lat_hdr, time);
 		orw = crt_req_get(ioc->ioc_rpc);
 		if (orw->orw_iod_array.oia_iods != NULL)
 			obj_ec_metrics_process(&orw->orw_iod_array, ioc);
@@ -2245,15 +2323,24 @@ obj_update_sensors(struct obj_io_context *ioc, int err)
 	case DAOS_OBJ_RPC_TGT_UPDATE:
 		d_tm_inc_counter(opm->opm_update_bytes, ioc->ioc_io_size);
 		lat = tls->ot_tgt_update_lat[lat_bucket(ioc->ioc_io_size)];
+		hdr = tls->ot_tgt_update_lat_hdr;
 		break;
 	case DAOS_OBJ_RPC_FETCH:
 		d_tm_inc_counter(opm->opm_fetch_bytes, ioc->ioc_io_size);
 		lat = tls->ot_fetch_lat[lat_bucket(ioc->ioc_io_size)];
+		hdr = tls->ot_fetch_lat_hdr;
+		orw = crt_req_get(ioc->ioc_rpc);
+		if (!(orw->orw_flags & ORF_FOR_MIGRATION))
+			d_tm_record_hdr(tls->ot_fg_lat_hdr, time);
 		break;
 	default:
 		lat = tls->ot_op_lat[opc];
 	}
 	d_tm_set_gauge(lat, time);
+	d_tm_record_hdr(hdr, time);
+
+	if (ioc->ioc_traced)
+		obj_trace_record(tls, ioc, daos_get_ntime() - ioc->ioc_start_time);
 }
 
 static void
@@ -3297,6 +3384,22 @@ obj_enum_reply_bulk(crt_rpc_t *rpc)
 	return rc;
 }
 
+/* The inline threshold of the enumeration, only sized by the buffer of bulk transfer */
+static uint32_t
+obj_enum_inline_thres_get(struct obj_key_enum_in *oei)
+{
+	daos_size_t	buf_len = 0;
+	int		i;
+
+	if (oei->oei_bulk == NULL)
+		return OBJ_ENUM_INLINE_THRES;
+
+	for (i = 0; i < oei->oei_sgl.sg_nr; i++)
+		buf_len += oei->oei_sgl.sg_iovs[i].iov_buf_len;
+
+	return obj_enum_inline_thres(buf_len, oei->oei_nr);
+}
+
 void
 ds_obj_enum_handler(crt_rpc_t *rpc)
 {
@@ -3335,8 +3438,7 @@ ds_obj_enum_handler(crt_rpc_t *rpc)
 	anchors[0].ia_akey = oei->oei_akey_anchor;
 	anchors[0].ia_ev = oei->oei_anchor;
 
-	/* TODO: Transfer the inline_thres from enumerate RPC */
-	enum_arg.inline_thres = 32;
+	enum_arg.inline_thres = obj_enum_inline_thres_get(oei);
 
 	if (opc == DAOS_OBJ_RECX_RPC_ENUMERATE) {
 		oeo->oeo_eprs.ca_count = 0;
@@ -38,6 +38,9 @@
 /* Max migrate ULT number on the server */
 #define MIGRATE_MAX_ULT		512
 
+/* Period (seconds) of the adjustment of the migration throttle */
+#define MIGRATE_THROTTLE_INTVL	1
+
 struct migrate_one {
 	daos_key_t		 mo_dkey;
 	uint64_t		 mo_dkey_hash;
@@ -327,6 +330,8 @@ obj_tree_insert(daos_handle_t toh, uuid_t co_uuid, uint64_t tgt_id, daos_unit_oi
 void
 migrate_pool_tls_destroy(struct migrate_pool_tls *tls)
 {
+	int	i;
+
 	if (!tls)
 		return;
 	d_list_del(&tls->mpt_list);
@@ -346,8 +351,10 @@ migrate_pool_tls_destroy(struct migrate_pool_tls *tls)
 		ABT_cond_free(&tls->mpt_init_cond);
 	if (tls->mpt_init_mutex)
 		ABT_mutex_free(&tls->mpt_init_mutex);
-	if (daos_handle_is_valid(tls->mpt_root_hdl))
-		obj_tree_destroy(tls->mpt_root_hdl);
+	for (i = 0; i < REBUILD_PRIO_NR; i++) {
+		if (daos_handle_is_valid(tls->mpt_root_hdls[i]))
+			obj_tree_destroy(tls->mpt_root_hdls[i]);
+	}
 	if (daos_handle_is_valid(tls->mpt_migrated_root_hdl))
 		obj_tree_destroy(tls->mpt_migrated_root_hdl);
 	D_FREE(tls);
@@ -413,6 +420,7 @@ migrate_pool_tls_create_one(void *data)
 	struct migrate_pool_tls_create_arg *arg = data;
 	struct obj_tls			   *tls = obj_tls_get();
 	struct migrate_pool_tls		   *pool_tls;
+	int				    i;
 	int rc;
 
 	pool_tls = migrate_pool_tls_lookup(arg->pool_uuid, arg->version, arg->generation);
@@ -450,7 +458,8 @@ migrate_pool_tls_create_one(void *data)
 	pool_tls->mpt_size = 0;
 	pool_tls->mpt_generated_ult = 0;
 	pool_tls->mpt_executed_ult = 0;
-	pool_tls->mpt_root_hdl = DAOS_HDL_INVAL;
+	for (i = 0; i < REBUILD_PRIO_NR; i++)
+		pool_tls->mpt_root_hdls[i] = DAOS_HDL_INVAL;
 	pool_tls->mpt_max_eph = arg->max_eph;
 	pool_tls->mpt_pool = ds_pool_child_lookup(arg->pool_uuid);
 	pool_tls->mpt_new_layout_ver = arg->new_layout_ver;
@@ -706,6 +715,29 @@ migrate_csum_calc(struct daos_csummer *csummer, struct migrate_one *mrone, daos_
  * Note: the csum_iov is modified so a shallow copy should be sent instead of
  * the original.
  */
+/*
+ * Whether the enumeration already carried all the values of \a mrone, so that
+ * it can be migrated without fetching anything from the source. EC objects are
+ * always fetched, since the checksums have to be recalculated.
+ */
+static bool
+migrate_one_inline(struct migrate_one *mrone, struct daos_oclass_attr *oca)
+{
+	int	i;
+
+	if (daos_oclass_is_ec(oca) || mrone->mo_iods_num_from_parity > 0)
+		return false;
+
+	for (i = 0; i < mrone->mo_iod_num; i++) {
+		if (mrone->mo_iods[i].iod_size == 0)
+			continue;
+		if (mrone->mo_sgls == NULL || mrone->mo_sgls[i].sg_nr == 0)
+			return false;
+	}
+
+	return true;
+}
+
 static int
 migrate_fetch_update_inline(struct migrate_one *mrone, daos_handle_t oh,
 			    struct ds_cont_child *ds_cont)
@@ -1060,13 +1092,20 @@ migrate_fetch_update_single(struct migrate_one *mrone, daos_handle_t oh,
 	struct dcs_iod_csums	*iod_csums = NULL;
 	uint64_t		 update_flags = VOS_OF_REBUILD;
 	uint32_t		tgt_off = 0;
+	bool			 inline_data;
 	int			 i;
 	int			 rc;
 
 	D_ASSERT(mrone->mo_iod_num <= OBJ_ENUM_UNPACK_MAX_IODS);
+	inline_data = migrate_one_inline(mrone, &mrone->mo_oca);
 	for (i = 0; i < mrone->mo_iod_num; i++) {
 		D_ASSERT(mrone->mo_iods[i].iod_type == DAOS_IOD_SINGLE);
 
+		if (inline_data) {
+			sgls[i] = mrone->mo_sgls[i];
+			continue;
+		}
+
 		size = daos_iods_len(&mrone->mo_iods[i], 1);
 		D_ASSERT(size != -1);
 		D_ALLOC(data, size);
@@ -1084,25 +1123,30 @@ migrate_fetch_update_single(struct migrate_one *mrone, daos_handle_t oh,
 		DP_UOID(mrone->mo_oid), mrone, DP_KEY(&mrone->mo_dkey),
 		mrone->mo_iod_num, mrone->mo_epoch);
 
-	if (!daos_oclass_is_ec(&mrone->mo_oca)) {
-		rc = daos_iov_alloc(&csum_iov, CSUM_BUF_SIZE, false);
-		if (rc != 0)
-			D_GOTO(out, rc);
-		p_csum_iov = &csum_iov;
-	}
+	if (inline_data) {
+		/* The values and their checksums came with the enumeration */
+		p_csum_iov = &mrone->mo_csum_iov;
+	} else {
+		if (!daos_oclass_is_ec(&mrone->mo_oca)) {
+			rc = daos_iov_alloc(&csum_iov, CSUM_BUF_SIZE, false);
+			if (rc != 0)
+				D_GOTO(out, rc);
+			p_csum_iov = &csum_iov;
+		}
 
-	rc = mrone_obj_fetch(mrone, oh, sgls, mrone->mo_iods, mrone->mo_iod_num,
-			     mrone->mo_epoch, DIOF_FOR_MIGRATION, p_csum_iov);
-	if (rc == -DER_CSUM) {
-		D_ERROR("migrate dkey "DF_KEY" failed because of checksum "
-			"error ("DF_RC"). Don't fail whole rebuild.\n",
-			DP_KEY(&mrone->mo_dkey), DP_RC(rc));
-		D_GOTO(out, rc = 0);
-	}
-	if (rc) {
-		D_ERROR("migrate dkey "DF_KEY" failed: "DF_RC"\n",
-			DP_KEY(&mrone->mo_dkey), DP_RC(rc));
-		D_GOTO(out, rc);
+		rc = mrone_obj_fetch(mrone, oh, sgls, mrone->mo_iods, mrone->mo_iod_num,
+				     mrone->mo_epoch, DIOF_FOR_MIGRATION, p_csum_iov);
+		if (rc == -DER_CSUM) {
+			D_ERROR("migrate dkey "DF_KEY" failed because of checksum "
+				"error ("DF_RC"). Don't fail whole rebuild.\n",
+				DP_KEY(&mrone->mo_dkey), DP_RC(rc));
+			D_GOTO(out, rc = 0);
+		}
+		if (rc) {
+			D_ERROR("migrate dkey "DF_KEY" failed: "DF_RC"\n",
+				DP_KEY(&mrone->mo_dkey), DP_RC(rc));
+			D_GOTO(out, rc);
+		}
 	}
 
 	if (daos_oclass_is_ec(&mrone->mo_oca))
@@ -1612,7 +1656,8 @@ migrate_dkey(struct migrate_pool_tls *tls, struct migrate_one *mrone,
 						  mrone->mo_dkey_hash, &mrone->mo_oca,
 						  mrone->mo_oid.id_shard))
 		rc = migrate_fetch_update_parity(mrone, oh, cont);
-	else if (data_size < MAX_BUF_SIZE || data_size == (daos_size_t)(-1))
+	else if (data_size < MAX_BUF_SIZE || data_size == (daos_size_t)(-1) ||
+		 migrate_one_inline(mrone, &mrone->mo_oca))
 		rc = migrate_fetch_update_inline(mrone, oh, cont);
 	else
 		rc = migrate_fetch_update_bulk(mrone, oh, cont);
@@ -1679,6 +1724,81 @@ migrate_one_destroy(struct migrate_one *mrone)
 	D_FREE(mrone);
 }
 
+/*
+ * Percent of the full migration speed allowed on the current target. It is
+ * adjusted every MIGRATE_THROTTLE_INTVL by migrate_throttle_adjust() with the
+ * foreground update/fetch RPCs of the target during the last period.
+ */
+static uint32_t
+migrate_throttle_rate(void)
+{
+	struct obj_tls			*tls = obj_tls_get();
+	struct obj_migrate_throttle	*mt = &tls->ot_mig_throttle;
+	uint64_t			 now;
+	uint64_t			 p99;
+	bool				 first;
+	int				 rc;
+
+	if (migrate_lat_slo == 0 || tls->ot_fg_lat_hdr == NULL)
+		return 100;
+
+	now = daos_gettime_coarse();
+	if (now < mt->mt_last + MIGRATE_THROTTLE_INTVL)
+		return mt->mt_rate;
+	mt->mt_last = now;
+
+	first = mt->mt_prev.dhs_buckets == NULL;
+	rc = d_tm_snap_hdr(tls->ot_fg_lat_hdr, &mt->mt_snap);
+	if (rc == 0 && !first)
+		rc = d_tm_hdr_diff(&mt->mt_snap, &mt->mt_prev);
+	if (rc == 0)
+		rc = d_tm_hdr_merge(&mt->mt_prev, &mt->mt_snap);
+	if (rc != 0) {
+		D_WARN("Failed to sample foreground latency: "DF_RC"\n", DP_RC(rc));
+		return mt->mt_rate;
+	}
+	if (first)
+		return mt->mt_rate;
+
+	p99 = d_tm_hdr_percentile(&mt->mt_snap, 99);
+	mt->mt_rate = migrate_throttle_adjust(mt->mt_rate, mt->mt_snap.dhs_count, p99,
+					      migrate_lat_slo);
+
+	d_tm_set_gauge(mt->mt_rate_tm, mt->mt_rate);
+	d_tm_set_gauge(mt->mt_p99_tm, p99);
+	if (mt->mt_rate != 100)
+		D_DEBUG(DB_REBUILD, "foreground p99 "DF_U64" us, "DF_U64" samples, rate %u%%\n",
+			p99, mt->mt_snap.dhs_count, mt->mt_rate);
+
+	return mt->mt_rate;
+}
+
+/*
+ * Whether to wait for the in-flight migrations of the xstream before migrating
+ * \a data_size more bytes. The in-flight size and the number of in-flight dkeys
+ * are scaled down by migrate_throttle_rate(), but one dkey is always allowed so
+ * that a large dkey does not wait forever.
+ */
+static bool
+migrate_inflight_throttled(struct migrate_pool_tls *tls, daos_size_t data_size)
+{
+	uint64_t	max_size = tls->mpt_inflight_max_size;
+	uint32_t	rate;
+
+	if (max_size != 0 && tls->mpt_inflight_size + data_size >= max_size)
+		return true;
+
+	rate = migrate_throttle_rate();
+	if (rate == 100 || tls->mpt_inflight_ult == 0)
+		return false;
+
+	max_size = max_size * rate / 100;
+	if (max_size != 0 && tls->mpt_inflight_size + data_size >= max_size)
+		return true;
+
+	return tls->mpt_inflight_ult >= max(tls->mpt_inflight_max_ult * rate / 100, 1);
+}
+
 static void
 migrate_one_ult(void *arg)
 {
@@ -1709,9 +1829,7 @@ migrate_one_ult(void *arg)
 	D_DEBUG(DB_REBUILD, "mrone %p inflight_size "DF_U64" max "DF_U64"\n",
 		mrone, tls->mpt_inflight_size, tls->mpt_inflight_max_size);
 
-	while (tls->mpt_inflight_size + data_size >=
-	       tls->mpt_inflight_max_size && tls->mpt_inflight_max_size != 0
-	       && !tls->mpt_fini) {
+	while (!tls->mpt_fini && migrate_inflight_throttled(tls, data_size)) {
 		D_DEBUG(DB_REBUILD, "mrone %p wait "DF_U64"/"DF_U64"\n", mrone,
 			tls->mpt_inflight_size, tls->mpt_inflight_max_size);
 		ABT_mutex_lock(tls->mpt_inflight_mutex);
@@ -1723,7 +1841,9 @@ migrate_one_ult(void *arg)
 		D_GOTO(out, rc);
 
 	tls->mpt_inflight_size += data_size;
+	tls->mpt_inflight_ult++;
 	rc = migrate_dkey(tls, mrone, data_size);
+	tls->mpt_inflight_ult--;
 	tls->mpt_inflight_size -= data_size;
 
 	ABT_mutex_lock(tls->mpt_inflight_mutex);
@@ -2133,6 +2253,7 @@ struct enum_unpack_arg {
 	d_list_t		merge_list;
 	uint32_t		version;
 	uint32_t		new_layout_ver;	/* New layout version for upgrade */
+	uint32_t		batch_size;	/* KiB, see migrate_batch_size */
 };
 
 static int
@@ -2473,11 +2594,37 @@ put:
 	return rc;
 }
 
+/* The dkeys of one enumeration migrated by a single ULT, see migrate_start_ult() */
+struct migrate_one_batch {
+	d_list_t	mob_list;
+};
+
+static void
+migrate_batch_ult(void *arg)
+{
+	struct migrate_one_batch	*batch = arg;
+	struct migrate_one		*mrone;
+	struct migrate_one		*tmp;
+
+	d_list_for_each_entry_safe(mrone, tmp, &batch->mob_list, mo_list) {
+		d_list_del_init(&mrone->mo_list);
+		migrate_one_ult(mrone);
+	}
+	D_FREE(batch);
+}
+
+/*
+ * Start the migration of the dkeys of one enumeration. The dkeys whose values all
+ * came with the enumeration do not need any RPC, they are migrated one after the
+ * other by a single ULT instead of one ULT each, the others still get their own
+ * ULT to fetch the data in parallel.
+ */
 static int
 migrate_start_ult(struct enum_unpack_arg *unpack_arg)
 {
 	struct migrate_pool_tls *tls;
 	struct iter_obj_arg	*arg = unpack_arg->arg;
+	struct migrate_one_batch *batch = NULL;
 	struct migrate_one	*mrone;
 	struct migrate_one	*tmp;
 	int			rc = 0;
@@ -2496,6 +2643,22 @@ migrate_start_ult(struct enum_unpack_arg *unpack_arg)
 			mrone->mo_iod_num);
 
 		d_list_del_init(&mrone->mo_list);
+		if (unpack_arg->batch_size != 0 &&
+		    migrate_one_inline(mrone, &unpack_arg->oc_attr)) {
+			if (batch == NULL) {
+				D_ALLOC_PTR(batch);
+				if (batch == NULL) {
+					migrate_one_destroy(mrone);
+					rc = -DER_NOMEM;
+					break;
+				}
+				D_INIT_LIST_HEAD(&batch->mob_list);
+			}
+			d_list_add_tail(&mrone->mo_list, &batch->mob_list);
+			tls->mpt_generated_ult++;
+			continue;
+		}
+
 		rc = dss_ult_create(migrate_one_ult, mrone, DSS_XS_VOS,
 				    arg->tgt_idx, MIGRATE_STACK_SIZE, NULL);
 		if (rc) {
@@ -2505,6 +2668,20 @@ migrate_start_ult(struct enum_unpack_arg *unpack_arg)
 		tls->mpt_generated_ult++;
 	}
 
+	if (batch != NULL) {
+		if (rc == 0)
+			rc = dss_ult_create(migrate_batch_ult, batch, DSS_XS_VOS,
+					    arg->tgt_idx, MIGRATE_STACK_SIZE, NULL);
+		if (rc) {
+			d_list_for_each_entry_safe(mrone, tmp, &batch->mob_list, mo_list) {
+				d_list_del_init(&mrone->mo_list);
+				migrate_one_destroy(mrone);
+				tls->mpt_generated_ult--;
+			}
+			D_FREE(batch);
+		}
+	}
+
 put:
 	if (tls)
 		migrate_pool_tls_put(tls);
@@ -2540,6 +2717,7 @@ migrate_one_epoch_object(daos_epoch_range_t *epr, struct migrate_pool_tls *tls,
 	daos_handle_t		 oh  = DAOS_HDL_INVAL;
 	uint32_t		 minimum_nr;
 	uint32_t		 enum_flags;
+	uint32_t		 kds_nr = KDS_NUM;
 	uint32_t		 num;
 	int			 rc1;
 	int			 rc = 0;
@@ -2582,6 +2760,7 @@ migrate_one_epoch_object(daos_epoch_range_t *epr, struct migrate_pool_tls *tls,
 	unpack_arg.epr = *epr;
 	unpack_arg.oh = oh;
 	unpack_arg.version = tls->mpt_version;
+	unpack_arg.batch_size = DAOS_FAIL_CHECK(DAOS_REBUILD_NO_BATCH) ? 0 : migrate_batch_size;
 	D_INIT_LIST_HEAD(&unpack_arg.merge_list);
 	buf = stack_buf;
 	buf_len = ITER_BUF_SIZE;
@@ -2594,6 +2773,22 @@ migrate_one_epoch_object(daos_epoch_range_t *epr, struct migrate_pool_tls *tls,
 		D_GOTO(out_cont, rc);
 	}
 
+	/* Batched migration: enumerate into a buffer large enough to be transferred
+	 * by bulk, with few enough descriptors that the source packs the values up to
+	 * OBJ_ENUM_INLINE_THRES_MAX inline, see obj_enum_inline_thres(). The keys and
+	 * values of a small object then come with a single RPC and are not fetched.
+	 */
+	if (((daos_size_t)unpack_arg.batch_size << 10) > ITER_BUF_SIZE &&
+	    !daos_oclass_is_ec(&unpack_arg.oc_attr)) {
+		D_ALLOC(buf, (daos_size_t)unpack_arg.batch_size << 10);
+		if (buf != NULL) {
+			buf_len = (daos_size_t)unpack_arg.batch_size << 10;
+			kds_nr = min(max(buf_len / OBJ_ENUM_INLINE_THRES_MAX, 1), KDS_NUM);
+		} else {
+			buf = stack_buf;
+		}
+	}
+
 	memset(&anchor, 0, sizeof(anchor));
 	memset(&akey_anchor, 0, sizeof(akey_anchor));
 	memset(&dkey_anchor, 0, sizeof(dkey_anchor));
@@ -2641,7 +2836,7 @@ migrate_one_epoch_object(daos_epoch_range_t *epr, struct migrate_pool_tls *tls,
 			p_csum->iov_len = 0;
 
 		daos_anchor_set_flags(&dkey_anchor, enum_flags);
-		num = KDS_NUM;
+		num = kds_nr;
 		rc = dsc_obj_list_obj(oh, epr, NULL, NULL, NULL,
 				     &num, kds, &sgl, &anchor,
 				     &dkey_anchor, &akey_anchor, p_csum);
@@ -3087,7 +3282,7 @@ migrate_obj_iter_cb(daos_handle_t ih, d_iov_t *key_iov, d_iov_t *val_iov, void *
 	unsigned int			shard = obj_val->shard;
 	int				rc;
 
-	if (arg->pool_tls->mpt_fini)
+	if (arg->pool_tls->mpt_fini || migrate_preempted(arg->pool_tls))
 		return 1;
 
 	D_DEBUG(DB_REBUILD, "obj migrate "DF_UUID"/"DF_UOID" %"PRIx64
@@ -3202,10 +3397,17 @@ migrate_cont_iter_cb(daos_handle_t ih, d_iov_t *key_iov,
 
 		rc = dbtree_iterate(root->root_hdl, DAOS_INTENT_MIGRATION,
 				    false, migrate_obj_iter_cb, &arg);
-		if (rc || tls->mpt_fini)
+		if (rc || tls->mpt_fini || migrate_preempted(tls))
 			break;
 	}
 
+	/* Keep the rest of the container, migrate_ult() comes back to it later */
+	if (rc == 0 && !tls->mpt_fini && migrate_preempted(tls)) {
+		D_DEBUG(DB_REBUILD, "iter cont "DF_UUID" prio %u preempted\n",
+			DP_UUID(cont_uuid), tls->mpt_prio);
+		D_GOTO(free, rc = 1);
+	}
+
 	D_DEBUG(DB_REBUILD, "iter cont "DF_UUID"/%"PRIx64" finish.\n",
 		DP_UUID(cont_uuid), ih.cookie);
 
@@ -3264,16 +3466,11 @@ migrate_ult(void *arg)
 	int			rc;
 
 	D_ASSERT(pool_tls != NULL);
-	while (!dbtree_is_empty(pool_tls->mpt_root_hdl) && !pool_tls->mpt_fini) {
-		rc = dbtree_iterate(pool_tls->mpt_root_hdl,
-				    DAOS_INTENT_PURGE, false,
-				    migrate_cont_iter_cb, pool_tls);
-		if (rc < 0) {
-			D_ERROR("dbtree iterate failed: "DF_RC"\n", DP_RC(rc));
-			if (pool_tls->mpt_status == 0)
-				pool_tls->mpt_status = rc;
-			break;
-		}
+	rc = migrate_trees_drain(pool_tls, migrate_cont_iter_cb);
+	if (rc < 0) {
+		D_ERROR("dbtree iterate failed: "DF_RC"\n", DP_RC(rc));
+		if (pool_tls->mpt_status == 0)
+			pool_tls->mpt_status = rc;
 	}
 
 	pool_tls->mpt_ult_running = 0;
@@ -3282,24 +3479,28 @@ migrate_ult(void *arg)
 
 /**
  * Init migrate objects tree, so the migrating objects are added to
- * to-be-migrated tree(mpt_root/mpt_root_hdl) first, then moved to
- * migrated tree once it is being migrated. (mpt_migrated_root/
- * mpt_migrated_root_hdl). The incoming objects will check both
- * tree to see if the objects being migrated already.
+ * to-be-migrated tree of their priority (mpt_roots/mpt_root_hdls) first,
+ * then moved to migrated tree once it is being migrated. (mpt_migrated_root/
+ * mpt_migrated_root_hdl). The incoming objects will check all these
+ * trees to see if the objects being migrated already.
  */
 static int
 migrate_try_create_object_tree(struct migrate_pool_tls *tls)
 {
 	struct umem_attr uma;
+	int i;
 	int rc;
 
-	if (daos_handle_is_inval(tls->mpt_root_hdl)) {
+	for (i = 0; i < REBUILD_PRIO_NR; i++) {
+		if (daos_handle_is_valid(tls->mpt_root_hdls[i]))
+			continue;
+
 		/* migrate tree root init */
 		memset(&uma, 0, sizeof(uma));
 		uma.uma_id = UMEM_CLASS_VMEM;
 		rc = dbtree_create_inplace(DBTREE_CLASS_UV, 0, 4, &uma,
-					   &tls->mpt_root,
-					   &tls->mpt_root_hdl);
+					   &tls->mpt_roots[i],
+					   &tls->mpt_root_hdls[i]);
 		if (rc != 0) {
 			D_ERROR("failed to create tree: "DF_RC"\n", DP_RC(rc));
 			return rc;
@@ -3323,19 +3524,20 @@ migrate_try_create_object_tree(struct migrate_pool_tls *tls)
 }
 
 /**
- * Only insert objects if the objects does not exist in both
- * tobe-migrated tree and migrated tree.
+ * Only insert objects if the objects does not exist in any of the
+ * tobe-migrated trees and migrated tree.
  */
 static int
 migrate_try_obj_insert(struct migrate_pool_tls *tls, uuid_t co_uuid,
 		       daos_unit_oid_t oid, daos_epoch_t epoch,
 		       daos_epoch_t punched_epoch, unsigned int shard,
-		       unsigned int tgt_idx)
+		       unsigned int tgt_idx, unsigned int prio)
 {
 	struct migrate_obj_val	val;
-	daos_handle_t		toh = tls->mpt_root_hdl;
+	daos_handle_t		toh = tls->mpt_root_hdls[prio];
 	daos_handle_t		migrated_toh = tls->mpt_migrated_root_hdl;
 	d_iov_t			val_iov;
+	int			i;
 	int			rc;
 
 	D_ASSERT(daos_handle_is_valid(toh));
@@ -3346,15 +3548,17 @@ migrate_try_obj_insert(struct migrate_pool_tls *tls, uuid_t co_uuid,
 	val.shard = shard;
 	val.tgt_idx = tgt_idx;
 	D_DEBUG(DB_REBUILD, "Insert migrate "DF_UUID"/"DF_UOID" "DF_U64"/"DF_U64
-		"/%d/%d\n", DP_UUID(co_uuid), DP_UOID(oid), epoch, punched_epoch,
-		shard, tgt_idx);
+		"/%d/%d prio %u\n", DP_UUID(co_uuid), DP_UOID(oid), epoch, punched_epoch,
+		shard, tgt_idx, prio);
 
 	d_iov_set(&val_iov, &val, sizeof(struct migrate_obj_val));
-	rc = obj_tree_lookup(toh, co_uuid, oid, &val_iov);
-	if (rc != -DER_NONEXIST) {
-		D_DEBUG(DB_REBUILD, DF_UUID"/"DF_UOID" not need insert: "
-			DF_RC"\n", DP_UUID(co_uuid), DP_UOID(oid), DP_RC(rc));
-		return rc;
+	for (i = 0; i < REBUILD_PRIO_NR; i++) {
+		rc = obj_tree_lookup(tls->mpt_root_hdls[i], co_uuid, oid, &val_iov);
+		if (rc != -DER_NONEXIST) {
+			D_DEBUG(DB_REBUILD, DF_UUID"/"DF_UOID" not need insert: "
+				DF_RC"\n", DP_UUID(co_uuid), DP_UOID(oid), DP_RC(rc));
+			return rc;
+		}
 	}
 
 	rc = obj_tree_lookup(migrated_toh, co_uuid, oid, &val_iov);
@@ -3374,7 +3578,7 @@ ds_migrate_object(struct ds_pool *pool, uuid_t po_hdl, uuid_t co_hdl, uuid_t co_
 		  uint32_t version, unsigned int generation, uint64_t max_eph, uint32_t opc,
 		  daos_unit_oid_t *oids, daos_epoch_t *epochs, daos_epoch_t *punched_epochs,
 		  unsigned int *shards, uint32_t count, unsigned int tgt_idx,
-		  uint32_t new_layout_ver)
+		  uint32_t new_layout_ver, unsigned int prio)
 {
 	struct migrate_pool_tls	*tls;
 	int			i;
@@ -3397,7 +3601,7 @@ ds_migrate_object(struct ds_pool *pool, uuid_t po_hdl, uuid_t co_hdl, uuid_t co_
 	for (i = 0; i < count; i++) {
 		/* firstly insert/check rebuilt tree */
 		rc = migrate_try_obj_insert(tls, co_uuid, oids[i], epochs[i], punched_epochs[i],
-					    shards[i], tgt_idx);
+					    shards[i], tgt_idx, prio);
 		if (rc == -DER_EXIST) {
 			D_DEBUG(DB_TRACE, DF_UOID"/"DF_UUID"exists.\n",
 				DP_UOID(oids[i]), DP_UUID(co_uuid));
@@ -3476,6 +3680,11 @@ ds_obj_migrate_handler(crt_rpc_t *rpc)
 		D_GOTO(out, rc = -DER_INVAL);
 	}
 
+	if (migrate_in->om_prio >= REBUILD_PRIO_NR) {
+		D_ERROR("Wrong prio %u\n", migrate_in->om_prio);
+		D_GOTO(out, rc = -DER_INVAL);
+	}
+
 	uuid_copy(co_uuid, migrate_in->om_cont_uuid);
 	uuid_copy(co_hdl_uuid, migrate_in->om_coh_uuid);
 	uuid_copy(po_uuid, migrate_in->om_pool_uuid);
@@ -3505,7 +3714,8 @@ ds_obj_migrate_handler(crt_rpc_t *rpc)
 	rc = ds_migrate_object(pool, po_hdl_uuid, co_hdl_uuid, co_uuid, migrate_in->om_version,
 			       migrate_in->om_generation, migrate_in->om_max_eph,
 			       migrate_in->om_opc, oids, ephs, punched_ephs, shards, oids_count,
-			       migrate_in->om_tgt_idx, migrate_in->om_new_layout_ver);
+			       migrate_in->om_tgt_idx, migrate_in->om_new_layout_ver,
+			       migrate_in->om_prio);
 out:
 	if (pool)
 		ds_pool_put(pool);
@@ -3532,11 +3742,14 @@ migrate_check_one(void *data)
 {
 	struct migrate_query_arg	*arg = data;
 	struct migrate_pool_tls		*tls;
+	uint32_t			 rate;
 
 	tls = migrate_pool_tls_lookup(arg->pool_uuid, arg->version, arg->generation);
 	if (tls == NULL)
 		return 0;
 
+	rate = obj_tls_get()->ot_mig_throttle.mt_rate;
+
 	ABT_mutex_lock(arg->status_lock);
 	arg->dms.dm_rec_count += tls->mpt_rec_count;
 	arg->dms.dm_obj_count += tls->mpt_obj_count;
@@ -3547,6 +3760,8 @@ migrate_check_one(void *data)
 	arg->executed_ult += tls->mpt_executed_ult;
 	if (arg->dms.dm_status == 0)
 		arg->dms.dm_status = tls->mpt_status;
+	if (arg->dms.dm_throttle == 0 || rate < arg->dms.dm_throttle)
+		arg->dms.dm_throttle = rate;
 	ABT_mutex_unlock(arg->status_lock);
 
 	D_DEBUG(DB_REBUILD, "status %d/%d  rec/obj/size "
@@ -3635,6 +3850,7 @@ out:
  * param cnt [in]		count of objects.
  * param new_layout_ver [in]	new layout version during upgrade.
  * param migrate_opc [in]	operation which cause the migration.
+ * param prio [in]		rebuild priority of the objects, see enum rebuild_prio.
  *
  * return			0 if it succeeds, otherwise errno.
  */
@@ -3643,7 +3859,7 @@ ds_object_migrate_send(struct ds_pool *pool, uuid_t pool_hdl_uuid, uuid_t cont_h
 		       uuid_t cont_uuid, int tgt_id, uint32_t version, unsigned int generation,
 		       uint64_t max_eph, daos_unit_oid_t *oids, daos_epoch_t *ephs,
 		       daos_epoch_t *punched_ephs, unsigned int *shards, int cnt,
-		       uint32_t new_layout_ver, uint32_t migrate_opc)
+		       uint32_t new_layout_ver, uint32_t migrate_opc, unsigned int prio)
 {
 	struct obj_migrate_in	*migrate_in = NULL;
 	struct obj_migrate_out	*migrate_out = NULL;
@@ -3697,6 +3913,7 @@ ds_object_migrate_send(struct ds_pool *pool, uuid_t pool_hdl_uuid, uuid_t cont_h
 	migrate_in->om_tgt_idx = index;
 	migrate_in->om_new_layout_ver = new_layout_ver;
 	migrate_in->om_opc = migrate_opc;
+	migrate_in->om_prio = prio;
 
 	migrate_in->om_oids.ca_arrays = oids;
 	migrate_in->om_oids.ca_count = cnt;
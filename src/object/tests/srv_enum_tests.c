@@ -0,0 +1,74 @@
+/*
+ * (C) Copyright 2023 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+
+/*
+ * Unit tests for the inline threshold of the object enumeration
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <daos/tests_lib.h>
+#include "../srv_internal.h"
+
+/* The default threshold without descriptors or with small buffers */
+static void
+test_inline_thres_default(void **state)
+{
+	assert_int_equal(obj_enum_inline_thres(0, 0), OBJ_ENUM_INLINE_THRES);
+	assert_int_equal(obj_enum_inline_thres(1 << 20, 0), OBJ_ENUM_INLINE_THRES);
+	assert_int_equal(obj_enum_inline_thres(0, 128), OBJ_ENUM_INLINE_THRES);
+	assert_int_equal(obj_enum_inline_thres(1024, 128), OBJ_ENUM_INLINE_THRES);
+	assert_int_equal(obj_enum_inline_thres(OBJ_ENUM_INLINE_THRES * 128, 128),
+			 OBJ_ENUM_INLINE_THRES);
+}
+
+/* The threshold follows the buffer size per descriptor */
+static void
+test_inline_thres_follow(void **state)
+{
+	assert_int_equal(obj_enum_inline_thres(64 << 10, 128), 512);
+	assert_int_equal(obj_enum_inline_thres(128 << 10, 128), 1024);
+	assert_int_equal(obj_enum_inline_thres(128 << 10, 256), 512);
+	assert_int_equal(obj_enum_inline_thres(100 << 10, 1000), 102);
+}
+
+/* Capped by OBJ_ENUM_INLINE_THRES_MAX */
+static void
+test_inline_thres_max(void **state)
+{
+	assert_int_equal(obj_enum_inline_thres(OBJ_ENUM_INLINE_THRES_MAX * 128, 128),
+			 OBJ_ENUM_INLINE_THRES_MAX);
+	assert_int_equal(obj_enum_inline_thres(16 << 20, 16), OBJ_ENUM_INLINE_THRES_MAX);
+	assert_int_equal(obj_enum_inline_thres(1ULL << 40, 1), OBJ_ENUM_INLINE_THRES_MAX);
+}
+
+static int
+setup_enum_tests(void **state)
+{
+	return d_log_init();
+}
+
+static int
+teardown_enum_tests(void **state)
+{
+	d_log_fini();
+	return 0;
+}
+
+int
+main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_inline_thres_default),
+		cmocka_unit_test(test_inline_thres_follow),
+		cmocka_unit_test(test_inline_thres_max),
+	};
+
+	return cmocka_run_group_tests_name("obj_enum_inline_thres", tests, setup_enum_tests,
+					   teardown_enum_tests);
+}
@@ -0,0 +1,220 @@
+/*
+ * (C) Copyright 2023 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+
+/*
+ * Unit tests for the migration order of the rebuild priorities
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <daos/tests_lib.h>
+#include <daos/btree_class.h>
+#include "../srv_internal.h"
+
+#define MPT_BTREE_ORDER	16
+#define MPT_CONT_MAX	8
+
+struct mpt_arg {
+	struct migrate_pool_tls	ma_tls;
+	/* Priority of each migrated container, in the migration order */
+	unsigned int		ma_prios[MPT_CONT_MAX];
+	int			ma_nr;
+	/* Container inserted at the first migrated one, and its priority */
+	uuid_t			ma_late_uuid;
+	unsigned int		ma_late_prio;
+	bool			ma_late;
+};
+
+static struct mpt_arg	*mpt_arg;
+
+static void
+cont_insert(struct migrate_pool_tls *tls, unsigned int prio, uuid_t uuid)
+{
+	uint32_t	val = prio;
+	int		rc;
+
+	rc = dbtree_uv_update(tls->mpt_root_hdls[prio], uuid, &val, sizeof(val));
+	assert_rc_equal(rc, 0);
+}
+
+/* Migrate the container by deleting it, as migrate_cont_iter_cb() does */
+static int
+cont_iter_cb(daos_handle_t ih, d_iov_t *key_iov, d_iov_t *val_iov, void *data)
+{
+	struct migrate_pool_tls	*tls = data;
+	int			 rc;
+
+	assert_true(mpt_arg->ma_nr < MPT_CONT_MAX);
+	mpt_arg->ma_prios[mpt_arg->ma_nr++] = tls->mpt_prio;
+
+	rc = dbtree_iter_delete(ih, NULL);
+	assert_rc_equal(rc, 0);
+
+	if (mpt_arg->ma_late) {
+		mpt_arg->ma_late = false;
+		cont_insert(tls, mpt_arg->ma_late_prio, mpt_arg->ma_late_uuid);
+	}
+
+	/* Keep the rest of the tree, come back to it later */
+	if (migrate_preempted(tls))
+		return 1;
+
+	rc = dbtree_iter_probe(ih, BTR_PROBE_FIRST, DAOS_INTENT_MIGRATION, NULL, NULL);
+	if (rc == -DER_NONEXIST)
+		return 1;
+	assert_rc_equal(rc, 0);
+	return 0;
+}
+
+/* The higher priorities are drained first */
+static void
+test_drain_order(void **state)
+{
+	struct migrate_pool_tls	*tls = &mpt_arg->ma_tls;
+	uuid_t			 uuid;
+	int			 rc;
+	int			 i;
+
+	for (i = 0; i < 2; i++) {
+		uuid_generate(uuid);
+		cont_insert(tls, REBUILD_PRIO_NORMAL, uuid);
+	}
+	uuid_generate(uuid);
+	cont_insert(tls, REBUILD_PRIO_DEGRADED, uuid);
+	uuid_generate(uuid);
+	cont_insert(tls, REBUILD_PRIO_CRITICAL, uuid);
+
+	rc = migrate_trees_drain(tls, cont_iter_cb);
+	assert_rc_equal(rc, 0);
+
+	assert_int_equal(mpt_arg->ma_nr, 4);
+	assert_int_equal(mpt_arg->ma_prios[0], REBUILD_PRIO_CRITICAL);
+	assert_int_equal(mpt_arg->ma_prios[1], REBUILD_PRIO_DEGRADED);
+	assert_int_equal(mpt_arg->ma_prios[2], REBUILD_PRIO_NORMAL);
+	assert_int_equal(mpt_arg->ma_prios[3], REBUILD_PRIO_NORMAL);
+	assert_int_equal(migrate_tree_prio_first(tls), REBUILD_PRIO_NR);
+}
+
+/* A higher priority inserted during the migration preempts the lower one */
+static void
+test_drain_preempt(void **state)
+{
+	struct migrate_pool_tls	*tls = &mpt_arg->ma_tls;
+	uuid_t			 uuid;
+	int			 rc;
+	int			 i;
+
+	for (i = 0; i < 3; i++) {
+		uuid_generate(uuid);
+		cont_insert(tls, REBUILD_PRIO_NORMAL, uuid);
+	}
+	uuid_generate(mpt_arg->ma_late_uuid);
+	mpt_arg->ma_late_prio = REBUILD_PRIO_CRITICAL;
+	mpt_arg->ma_late = true;
+
+	rc = migrate_trees_drain(tls, cont_iter_cb);
+	assert_rc_equal(rc, 0);
+
+	assert_int_equal(mpt_arg->ma_nr, 4);
+	assert_int_equal(mpt_arg->ma_prios[0], REBUILD_PRIO_NORMAL);
+	assert_int_equal(mpt_arg->ma_prios[1], REBUILD_PRIO_CRITICAL);
+	assert_int_equal(mpt_arg->ma_prios[2], REBUILD_PRIO_NORMAL);
+	assert_int_equal(mpt_arg->ma_prios[3], REBUILD_PRIO_NORMAL);
+	assert_int_equal(migrate_tree_prio_first(tls), REBUILD_PRIO_NR);
+}
+
+/* Nothing is migrated once the pool is being finalized */
+static void
+test_drain_fini(void **state)
+{
+	struct migrate_pool_tls	*tls = &mpt_arg->ma_tls;
+	uuid_t			 uuid;
+	int			 rc;
+
+	uuid_generate(uuid);
+	cont_insert(tls, REBUILD_PRIO_CRITICAL, uuid);
+
+	tls->mpt_fini = 1;
+	rc = migrate_trees_drain(tls, cont_iter_cb);
+	assert_rc_equal(rc, 0);
+	assert_int_equal(mpt_arg->ma_nr, 0);
+	assert_int_equal(migrate_tree_prio_first(tls), REBUILD_PRIO_CRITICAL);
+}
+
+static int
+mpt_setup(void **state)
+{
+	struct umem_attr	uma = { 0 };
+	int			prio;
+	int			rc;
+
+	D_ALLOC_PTR(mpt_arg);
+	if (mpt_arg == NULL)
+		return -1;
+
+	uma.uma_id = UMEM_CLASS_VMEM;
+	for (prio = 0; prio < REBUILD_PRIO_NR; prio++) {
+		rc = dbtree_create_inplace(DBTREE_CLASS_UV, 0, MPT_BTREE_ORDER, &uma,
+					   &mpt_arg->ma_tls.mpt_roots[prio],
+					   &mpt_arg->ma_tls.mpt_root_hdls[prio]);
+		if (rc != 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+static int
+mpt_teardown(void **state)
+{
+	int	prio;
+
+	for (prio = 0; prio < REBUILD_PRIO_NR; prio++)
+		dbtree_destroy(mpt_arg->ma_tls.mpt_root_hdls[prio], NULL);
+	D_FREE(mpt_arg);
+
+	return 0;
+}
+
+static int
+mpt_init(void **state)
+{
+	int	rc;
+
+	rc = daos_debug_init(DAOS_LOG_DEFAULT);
+	if (rc != 0)
+		return rc;
+
+	rc = dbtree_class_register(DBTREE_CLASS_UV, 0, &dbtree_uv_ops);
+	if (rc != 0) {
+		daos_debug_fini();
+		return rc;
+	}
+
+	return 0;
+}
+
+static int
+mpt_fini(void **state)
+{
+	daos_debug_fini();
+	return 0;
+}
+
+static const struct CMUnitTest mig_prio_tests[] = {
+	cmocka_unit_test_setup_teardown(test_drain_order, mpt_setup, mpt_teardown),
+	cmocka_unit_test_setup_teardown(test_drain_preempt, mpt_setup, mpt_teardown),
+	cmocka_unit_test_setup_teardown(test_drain_fini, mpt_setup, mpt_teardown),
+};
+
+int
+main(int argc, char **argv)
+{
+	return cmocka_run_group_tests_name("migrate priority tests", mig_prio_tests, mpt_init,
+					   mpt_fini);
+}
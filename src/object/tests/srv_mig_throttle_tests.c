@@ -0,0 +1,111 @@
+/*
+ * (C) Copyright 2023 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+
+/*
+ * Unit tests for the rate adjustment of the migration throttle
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <daos/tests_lib.h>
+#include "../srv_internal.h"
+
+/* Foreground p99 latency target (us) */
+#define SLO		1000
+/* Enough samples for a trusted p99 */
+#define BUSY		(MIGRATE_THROTTLE_IDLE * 10)
+
+/* Multiplicative decrease above the target, down to the floor */
+static void
+test_throttle_decrease(void **state)
+{
+	uint32_t	rate = 100;
+	int		i;
+
+	rate = migrate_throttle_adjust(rate, BUSY, SLO + 1, SLO);
+	assert_int_equal(rate, 50);
+	rate = migrate_throttle_adjust(rate, BUSY, SLO * 10, SLO);
+	assert_int_equal(rate, 25);
+
+	for (i = 0; i < 10; i++)
+		rate = migrate_throttle_adjust(rate, BUSY, SLO * 10, SLO);
+	assert_int_equal(rate, MIGRATE_THROTTLE_MIN);
+}
+
+/* Additive increase below 80% of the target, capped at full speed */
+static void
+test_throttle_increase(void **state)
+{
+	uint32_t	rate = MIGRATE_THROTTLE_MIN;
+	int		i;
+
+	rate = migrate_throttle_adjust(rate, BUSY, SLO * 4 / 5 - 1, SLO);
+	assert_int_equal(rate, MIGRATE_THROTTLE_MIN + MIGRATE_THROTTLE_STEP);
+	rate = migrate_throttle_adjust(rate, BUSY, 0, SLO);
+	assert_int_equal(rate, MIGRATE_THROTTLE_MIN + 2 * MIGRATE_THROTTLE_STEP);
+
+	for (i = 0; i < 100 / MIGRATE_THROTTLE_STEP; i++)
+		rate = migrate_throttle_adjust(rate, BUSY, 0, SLO);
+	assert_int_equal(rate, 100);
+}
+
+/* The rate is held between 80% and 100% of the target */
+static void
+test_throttle_hold(void **state)
+{
+	assert_int_equal(migrate_throttle_adjust(40, BUSY, SLO * 4 / 5, SLO), 40);
+	assert_int_equal(migrate_throttle_adjust(40, BUSY, SLO, SLO), 40);
+	assert_int_equal(migrate_throttle_adjust(100, BUSY, SLO, SLO), 100);
+}
+
+/* Few foreground samples never jump to full speed unless there is no I/O at all */
+static void
+test_throttle_idle(void **state)
+{
+	/* No foreground I/O */
+	assert_int_equal(migrate_throttle_adjust(MIGRATE_THROTTLE_MIN, 0, 0, SLO), 100);
+
+	/* Few I/Os far over the target still back off */
+	assert_int_equal(migrate_throttle_adjust(40, 1, SLO * 100, SLO), 20);
+	assert_int_equal(migrate_throttle_adjust(40, MIGRATE_THROTTLE_IDLE - 1, SLO + 1, SLO),
+			 20);
+
+	/* Few I/Os under the target step up, even within the band */
+	assert_int_equal(migrate_throttle_adjust(40, 1, SLO, SLO),
+			 40 + MIGRATE_THROTTLE_STEP);
+	assert_int_equal(migrate_throttle_adjust(40, MIGRATE_THROTTLE_IDLE - 1, 0, SLO),
+			 40 + MIGRATE_THROTTLE_STEP);
+	assert_int_equal(migrate_throttle_adjust(40, MIGRATE_THROTTLE_IDLE, SLO, SLO), 40);
+}
+
+static int
+setup_throttle_tests(void **state)
+{
+	return d_log_init();
+}
+
+static int
+teardown_throttle_tests(void **state)
+{
+	d_log_fini();
+	return 0;
+}
+
+int
+main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_throttle_decrease),
+		cmocka_unit_test(test_throttle_increase),
+		cmocka_unit_test(test_throttle_hold),
+		cmocka_unit_test(test_throttle_idle),
+	};
+
+	return cmocka_run_group_tests_name("obj_migrate_throttle", tests, setup_throttle_tests,
+					   teardown_throttle_tests);
+}
@@ -0,0 +1,222 @@
+/*
+ * (C) Copyright 2023 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+
+/*
+ * Unit tests for the sampled stage trace of the object RPCs
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <daos/tests_lib.h>
+#include "../srv_internal.h"
+
+#define STT_INTVL	4
+
+static void
+stt_rec_set(struct obj_trace_rec *rec, uint64_t total)
+{
+	int	stage;
+
+	memset(rec, 0, sizeof(*rec));
+	rec->otr_opc = DAOS_OBJ_RPC_UPDATE;
+	rec->otr_total = total;
+	for (stage = 0; stage < OBJ_STAGE_NR; stage++)
+		rec->otr_stages[stage] = total / OBJ_STAGE_NR;
+}
+
+/* 1 out of every STT_INTVL RPCs is sampled, none if the interval is 0 */
+static void
+trace_sampling(void **state)
+{
+	uint64_t	cnt = 0;
+	int		sampled = 0;
+	int		i;
+
+	for (i = 0; i < STT_INTVL * 10; i++) {
+		if (obj_trace_sampled(&cnt, STT_INTVL)) {
+			assert_int_equal(i % STT_INTVL, STT_INTVL - 1);
+			sampled++;
+		}
+	}
+	assert_int_equal(sampled, 10);
+
+	for (i = 0; i < STT_INTVL * 10; i++)
+		assert_false(obj_trace_sampled(&cnt, 0));
+}
+
+/* A sampled RPC fills the stages it goes through, an unsampled one none */
+static void
+trace_stages(void **state)
+{
+	struct obj_io_context	ioc = { 0 };
+	uint64_t		time;
+	int			stage;
+
+	ioc.ioc_start_time = daos_get_ntime();
+
+	/* Not sampled */
+	time = obj_trace_now(&ioc);
+	assert_int_equal(time, 0);
+	obj_trace_add(&ioc, OBJ_STAGE_VOS, 100);
+	obj_trace_since(&ioc, OBJ_STAGE_BULK, time);
+	obj_trace_bio(&ioc, 1000, 100, 200);
+	for (stage = 0; stage < OBJ_STAGE_NR; stage++)
+		assert_int_equal(ioc.ioc_stages[stage], 0);
+
+	/* Sampled, CaRT dispatched it 5us before the handler started */
+	obj_trace_start(&ioc, ioc.ioc_start_time - 5000);
+	assert_true(ioc.ioc_traced);
+	assert_int_equal(ioc.ioc_stages[OBJ_STAGE_QUEUE], 5000);
+
+	obj_trace_add(&ioc, OBJ_STAGE_VOS, 100);
+	obj_trace_add(&ioc, OBJ_STAGE_VOS, 50);
+	assert_int_equal(ioc.ioc_stages[OBJ_STAGE_VOS], 150);
+
+	obj_trace_bio(&ioc, 1000, 100, 200);
+	assert_int_equal(ioc.ioc_stages[OBJ_STAGE_DMA_WAIT], 100);
+	assert_int_equal(ioc.ioc_stages[OBJ_STAGE_NVME], 200);
+	assert_int_equal(ioc.ioc_stages[OBJ_STAGE_BIO], 700);
+
+	/* The waits are not accounted twice to the other bio work */
+	obj_trace_bio(&ioc, 100, 100, 200);
+	assert_int_equal(ioc.ioc_stages[OBJ_STAGE_DMA_WAIT], 200);
+	assert_int_equal(ioc.ioc_stages[OBJ_STAGE_NVME], 400);
+	assert_int_equal(ioc.ioc_stages[OBJ_STAGE_BIO], 700);
+
+	time = obj_trace_now(&ioc);
+	assert_true(time >= ioc.ioc_start_time);
+	usleep(1000);
+	obj_trace_since(&ioc, OBJ_STAGE_BULK, time);
+	assert_true(ioc.ioc_stages[OBJ_STAGE_BULK] >= 1000000);
+
+	time = obj_trace_now(&ioc);
+	obj_trace_since(&ioc, OBJ_STAGE_REPLY, time);
+	assert_true(ioc.ioc_stages[OBJ_STAGE_REPLY] < ioc.ioc_stages[OBJ_STAGE_BULK]);
+}
+
+/* The queue stage is unknown without an arrival time, or if the clocks went back */
+static void
+trace_start_no_arrive(void **state)
+{
+	struct obj_io_context	ioc = { 0 };
+
+	ioc.ioc_start_time = daos_get_ntime();
+	obj_trace_start(&ioc, 0);
+	assert_true(ioc.ioc_traced);
+	assert_int_equal(ioc.ioc_stages[OBJ_STAGE_QUEUE], 0);
+
+	memset(&ioc, 0, sizeof(ioc));
+	ioc.ioc_start_time = daos_get_ntime();
+	obj_trace_start(&ioc, ioc.ioc_start_time + 1000);
+	assert_int_equal(ioc.ioc_stages[OBJ_STAGE_QUEUE], 0);
+}
+
+/* The slowest sampled RPCs are kept in the descending order of their total time */
+static void
+trace_slow_order(void **state)
+{
+	struct obj_tls		*tls;
+	struct obj_trace_rec	 rec;
+	uint64_t		 totals[] = { 30, 10, 50, 20, 40, 60, 5, 70, 15, 45 };
+	int			 i;
+
+	D_ALLOC_PTR(tls);
+	assert_non_null(tls);
+
+	/* Not full, every record is kept */
+	for (i = 0; i < OBJ_TRACE_SLOW_NR; i++) {
+		stt_rec_set(&rec, totals[i]);
+		assert_true(obj_trace_slow_insert(tls, &rec) >= 0);
+	}
+	assert_int_equal(tls->ot_slow_nr, OBJ_TRACE_SLOW_NR);
+	for (i = 1; i < tls->ot_slow_nr; i++)
+		assert_true(tls->ot_slow[i - 1].otr_total >= tls->ot_slow[i].otr_total);
+	assert_int_equal(tls->ot_slow[0].otr_total, 70);
+	assert_int_equal(tls->ot_slow[OBJ_TRACE_SLOW_NR - 1].otr_total, 5);
+
+	/* Full, a faster record than the fastest kept is dropped */
+	stt_rec_set(&rec, 5);
+	assert_int_equal(obj_trace_slow_insert(tls, &rec), -1);
+	stt_rec_set(&rec, 1);
+	assert_int_equal(obj_trace_slow_insert(tls, &rec), -1);
+
+	/* Full, a slower one evicts the fastest */
+	stt_rec_set(&rec, 15);
+	assert_int_equal(obj_trace_slow_insert(tls, &rec), OBJ_TRACE_SLOW_NR - 2);
+	assert_int_equal(tls->ot_slow_nr, OBJ_TRACE_SLOW_NR);
+	assert_int_equal(tls->ot_slow[OBJ_TRACE_SLOW_NR - 1].otr_total, 10);
+	assert_int_equal(tls->ot_slow[OBJ_TRACE_SLOW_NR - 2].otr_total, 15);
+
+	/* The slowest one goes first with its full breakdown */
+	stt_rec_set(&rec, 100);
+	rec.otr_opc = DAOS_OBJ_RPC_FETCH;
+	rec.otr_stages[OBJ_STAGE_NVME] = 99;
+	assert_int_equal(obj_trace_slow_insert(tls, &rec), 0);
+	assert_int_equal(tls->ot_slow[0].otr_opc, DAOS_OBJ_RPC_FETCH);
+	assert_int_equal(tls->ot_slow[0].otr_stages[OBJ_STAGE_NVME], 99);
+	assert_int_equal(tls->ot_slow[1].otr_total, 70);
+	for (i = 1; i < tls->ot_slow_nr; i++)
+		assert_true(tls->ot_slow[i - 1].otr_total >= tls->ot_slow[i].otr_total);
+
+	D_FREE(tls);
+}
+
+/* The slowest sampled RPCs are forgotten once the window expired */
+static void
+trace_slow_expire(void **state)
+{
+	struct obj_tls		*tls;
+	struct obj_trace_rec	 rec;
+	uint64_t		 now = 1000;
+	int			 i;
+
+	D_ALLOC_PTR(tls);
+	assert_non_null(tls);
+
+	assert_int_equal(obj_trace_slow_expire(tls, now), 0);
+	assert_int_equal(tls->ot_slow_start, now);
+
+	for (i = 0; i < 3; i++) {
+		stt_rec_set(&rec, 100 + i);
+		obj_trace_slow_insert(tls, &rec);
+	}
+
+	/* Within the window */
+	assert_int_equal(obj_trace_slow_expire(tls, now + OBJ_TRACE_SLOW_WINDOW - 1), 0);
+	assert_int_equal(tls->ot_slow_nr, 3);
+	assert_int_equal(tls->ot_slow[0].otr_total, 102);
+
+	/* Expired, the cleared records are reported to be published */
+	assert_int_equal(obj_trace_slow_expire(tls, now + OBJ_TRACE_SLOW_WINDOW), 3);
+	assert_int_equal(tls->ot_slow_nr, 0);
+	assert_int_equal(tls->ot_slow_start, now + OBJ_TRACE_SLOW_WINDOW);
+	for (i = 0; i < 3; i++)
+		assert_int_equal(tls->ot_slow[i].otr_total, 0);
+
+	/* A fast RPC of the new window is kept */
+	stt_rec_set(&rec, 1);
+	assert_int_equal(obj_trace_slow_insert(tls, &rec), 0);
+	assert_int_equal(tls->ot_slow_nr, 1);
+
+	D_FREE(tls);
+}
+
+static const struct CMUnitTest srv_trace_tests[] = {
+	cmocka_unit_test(trace_sampling),
+	cmocka_unit_test(trace_stages),
+	cmocka_unit_test(trace_start_no_arrive),
+	cmocka_unit_test(trace_slow_order),
+	cmocka_unit_test(trace_slow_expire),
+};
+
+int
+main(int argc, char **argv)
+{
+	return cmocka_run_group_tests_name("Object RPC stage trace tests", srv_trace_tests,
+					   NULL, NULL);
+}
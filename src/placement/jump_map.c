@@ -560,6 +560,60 @@ remap_gpu_alloc_one(d_list_t *remap_list, uint8_t *dom_cur_grp_used,
 	return dgu;
 }
 
+/**
+ * The bitmaps used by the layout calculation, they depend on the pool map only,
+ * so the batch placement allocates them once and reuses them for all objects
+ * of the batch.
+ */
+struct jm_layout_bufs {
+	uint32_t	 jlb_dom_size;
+	uint32_t	 jlb_tgt_size;
+	uint8_t		*jlb_dom_used;
+	uint8_t		*jlb_dom_full;
+	uint8_t		*jlb_dom_cur_grp_used;
+	uint8_t		*jlb_dom_cur_grp_real;
+	uint8_t		*jlb_tgts_used;
+};
+
+static void
+jm_layout_bufs_fini(struct jm_layout_bufs *bufs)
+{
+	D_FREE(bufs->jlb_dom_used);
+	D_FREE(bufs->jlb_dom_full);
+	D_FREE(bufs->jlb_dom_cur_grp_used);
+	D_FREE(bufs->jlb_dom_cur_grp_real);
+	D_FREE(bufs->jlb_tgts_used);
+}
+
+static int
+jm_layout_bufs_init(struct pl_jump_map *jmap, struct jm_layout_bufs *bufs)
+{
+	struct pool_domain	*root;
+	int			 rc;
+
+	memset(bufs, 0, sizeof(*bufs));
+	rc = pool_map_find_domain(jmap->jmp_map.pl_poolmap, PO_COMP_TP_ROOT,
+				  PO_COMP_ID_ALL, &root);
+	if (rc == 0)
+		return -DER_NONEXIST;
+
+	bufs->jlb_dom_size = ((struct pool_domain *)(root->do_targets) - root + 1) / NBBY + 1;
+	bufs->jlb_tgt_size = root->do_target_nr / NBBY + 1;
+	D_ALLOC_ARRAY(bufs->jlb_dom_used, bufs->jlb_dom_size);
+	D_ALLOC_ARRAY(bufs->jlb_dom_full, bufs->jlb_dom_size);
+	D_ALLOC_ARRAY(bufs->jlb_dom_cur_grp_used, bufs->jlb_dom_size);
+	D_ALLOC_ARRAY(bufs->jlb_dom_cur_grp_real, bufs->jlb_dom_size);
+	D_ALLOC_ARRAY(bufs->jlb_tgts_used, bufs->jlb_tgt_size);
+	if (bufs->jlb_dom_used == NULL || bufs->jlb_dom_full == NULL ||
+	    bufs->jlb_dom_cur_grp_used == NULL || bufs->jlb_dom_cur_grp_real == NULL ||
+	    bufs->jlb_tgts_used == NULL) {
+		jm_layout_bufs_fini(bufs);
+		return -DER_NOMEM;
+	}
+
+	return 0;
+}
+
 /**
  * This function handles getting the initial layout for the object as well as
  * determining if there are targets that are unavailable.
@@ -568,6 +622,7 @@ remap_gpu_alloc_one(d_list_t *remap_list, uint8_t *dom_cur_grp_used,
  * \param[in]   jmop            The layout group size and count.
  * \param[in]   md              Object metadata.
  * \param[in]	allow_status	target status allowed to be in the layout.
+ * \param[in]	bufs		bitmaps shared by a batch, NULL to allocate them.
  * \param[out]  layout          This will contain the layout for the object
  * \param[out]  out_list	This will contain the targets that need to
  *                              be rebuilt and in the case of rebuild, may be
@@ -584,7 +639,8 @@ remap_gpu_alloc_one(d_list_t *remap_list, uint8_t *dom_cur_grp_used,
 static int
 get_object_layout(struct pl_jump_map *jmap, uint32_t layout_ver, struct pl_obj_layout *layout,
 		  struct jm_obj_placement *jmop, d_list_t *out_list, uint32_t allow_status,
-		  uint32_t allow_version, struct daos_obj_md *md, bool *is_extending)
+		  uint32_t allow_version, struct daos_obj_md *md, struct jm_layout_bufs *bufs,
+		  bool *is_extending)
 {
 	struct pool_target      *target;
 	struct pool_domain      *domain;
@@ -600,6 +656,11 @@ get_object_layout(struct pl_jump_map *jmap, uint32_t layout_ver, struct pl_obj_l
 	uint8_t			tgts_used_array[LOCAL_TGT_ARRAY_SIZE] = { 0 };
 	uint8_t			dom_cur_grp_used_array[LOCAL_TGT_ARRAY_SIZE] = { 0 };
 	uint8_t			dom_cur_grp_real_array[LOCAL_TGT_ARRAY_SIZE] = { 0 };
+	uint8_t			*dom_used_buf = dom_used_array;
+	uint8_t			*dom_full_buf = dom_full_array;
+	uint8_t			*tgts_used_buf = tgts_used_array;
+	uint8_t			*dom_cur_grp_used_buf = dom_cur_grp_used_array;
+	uint8_t			*dom_cur_grp_real_buf = dom_cur_grp_real_array;
 	d_list_t		dgu_remap_list;
 	uint32_t                dom_size;
 	uint32_t                dom_array_size;
@@ -631,7 +692,18 @@ get_object_layout(struct pl_jump_map *jmap, uint32_t layout_ver, struct pl_obj_l
 
 	dom_size = (struct pool_domain *)(root->do_targets) - (root) + 1;
 	dom_array_size = dom_size/NBBY + 1;
-	if (dom_array_size > LOCAL_DOM_ARRAY_SIZE) {
+	if (bufs != NULL) {
+		D_ASSERT(bufs->jlb_dom_size == dom_array_size);
+		D_ASSERT(bufs->jlb_tgt_size == root->do_target_nr / NBBY + 1);
+		dom_used_buf = dom_used = bufs->jlb_dom_used;
+		dom_full_buf = dom_full = bufs->jlb_dom_full;
+		dom_cur_grp_used_buf = dom_cur_grp_used = bufs->jlb_dom_cur_grp_used;
+		dom_cur_grp_real_buf = dom_cur_grp_real = bufs->jlb_dom_cur_grp_real;
+		tgts_used_buf = tgts_used = bufs->jlb_tgts_used;
+		memset(dom_used, 0, dom_array_size);
+		memset(dom_full, 0, dom_array_size);
+		memset(tgts_used, 0, bufs->jlb_tgt_size);
+	} else if (dom_array_size > LOCAL_DOM_ARRAY_SIZE) {
 		D_ALLOC_ARRAY(dom_used, dom_array_size);
 		D_ALLOC_ARRAY(dom_full, dom_array_size);
 		D_ALLOC_ARRAY(dom_cur_grp_used, dom_array_size);
@@ -643,10 +715,12 @@ get_object_layout(struct pl_jump_map *jmap, uint32_t layout_ver, struct pl_obj_l
 		dom_cur_grp_real = dom_cur_grp_real_array;
 	}
 
-	if (root->do_target_nr / NBBY + 1 > LOCAL_TGT_ARRAY_SIZE)
-		D_ALLOC_ARRAY(tgts_used, (root->do_target_nr / NBBY) + 1);
-	else
-		tgts_used = tgts_used_array;
+	if (bufs == NULL) {
+		if (root->do_target_nr / NBBY + 1 > LOCAL_TGT_ARRAY_SIZE)
+			D_ALLOC_ARRAY(tgts_used, (root->do_target_nr / NBBY) + 1);
+		else
+			tgts_used = tgts_used_array;
+	}
 
 	if (dom_used == NULL || dom_full == NULL || tgts_used == NULL ||
 	    dom_cur_grp_used == NULL)
@@ -764,26 +838,26 @@ out:
 					dom_cur_grp_used = NULL;
 				if (dgu->dgu_real == dom_cur_grp_real)
 					dom_cur_grp_real = NULL;
-				if (dgu->dgu_used != dom_cur_grp_used_array)
+				if (dgu->dgu_used != dom_cur_grp_used_buf)
 					D_FREE(dgu->dgu_used);
-				if (dgu->dgu_real != dom_cur_grp_real_array)
+				if (dgu->dgu_real != dom_cur_grp_real_buf)
 					D_FREE(dgu->dgu_real);
 			}
 			D_FREE(dgu);
 		}
 	}
 
-	if (dom_used && dom_used != dom_used_array)
+	if (dom_used && dom_used != dom_used_buf)
 		D_FREE(dom_used);
-	if (dom_full && dom_full != dom_full_array)
+	if (dom_full && dom_full != dom_full_buf)
 		D_FREE(dom_full);
-	if (tgts_used && tgts_used != tgts_used_array)
+	if (tgts_used && tgts_used != tgts_used_buf)
 		D_FREE(tgts_used);
 
-	if (dom_cur_grp_used && dom_cur_grp_used != dom_cur_grp_used_array)
+	if (dom_cur_grp_used && dom_cur_grp_used != dom_cur_grp_used_buf)
 		D_FREE(dom_cur_grp_used);
 
-	if (dom_cur_grp_real && dom_cur_grp_real != dom_cur_grp_real_array)
+	if (dom_cur_grp_real && dom_cur_grp_real != dom_cur_grp_real_buf)
 		D_FREE(dom_cur_grp_real);
 
 
@@ -795,7 +869,7 @@ obj_layout_alloc_and_get(struct pl_jump_map *jmap, uint32_t layout_ver,
 			 struct jm_obj_placement *jmop, struct daos_obj_md *md,
 			 uint32_t allow_status, uint32_t allow_version,
 			 struct pl_obj_layout **layout_p, d_list_t *remap_list,
-			 bool *is_extending)
+			 struct jm_layout_bufs *bufs, bool *is_extending)
 {
 	int rc;
 
@@ -811,7 +885,7 @@ obj_layout_alloc_and_get(struct pl_jump_map *jmap, uint32_t layout_ver,
 	}
 
 	rc = get_object_layout(jmap, layout_ver, *layout_p, jmop, remap_list, allow_status,
-			       allow_version, md, is_extending);
+			       allow_version, md, bufs, is_extending);
 	if (rc) {
 		D_ERROR("get object layout failed, rc "DF_RC"\n",
 			DP_RC(rc));
@@ -944,7 +1018,7 @@ jump_map_query(struct pl_map *map, struct pl_map_attr *attr)
 static int
 jump_map_obj_extend_layout(struct pl_jump_map *jmap, struct jm_obj_placement *jmop,
 			   uint32_t layout_version, struct daos_obj_md *md,
-			   struct pl_obj_layout *layout)
+			   struct pl_obj_layout *layout, struct jm_layout_bufs *bufs)
 {
 	struct pl_obj_layout	*new_layout = NULL;
 	d_list_t		extend_list;
@@ -958,7 +1032,7 @@ jump_map_obj_extend_layout(struct pl_jump_map *jmap, struct jm_obj_placement *jm
 	D_INIT_LIST_HEAD(&extend_list);
 	allow_status = PO_COMP_ST_UPIN | /*PO_COMP_ST_DRAIN |*/ PO_COMP_ST_UP;
 	rc = obj_layout_alloc_and_get(jmap, layout_version, jmop, md, allow_status,
-				      md->omd_ver, &new_layout, NULL, NULL);
+				      md->omd_ver, &new_layout, NULL, bufs, NULL);
 	if (rc != 0) {
 		D_ERROR(DF_OID" get_layout_alloc failed, rc "DF_RC"\n",
 			DP_OID(md->omd_id), DP_RC(rc));
@@ -1002,11 +1076,10 @@ out:
  *                              successfully.
  */
 static int
-jump_map_obj_place(struct pl_map *map, uint32_t layout_version, struct daos_obj_md *md,
-		   unsigned int mode, struct daos_obj_shard_md *shard_md,
-		   struct pl_obj_layout **layout_pp)
+jm_obj_place(struct pl_jump_map *jmap, uint32_t layout_version, struct daos_obj_md *md,
+	     unsigned int mode, struct daos_obj_shard_md *shard_md, struct jm_layout_bufs *bufs,
+	     struct pl_obj_layout **layout_pp)
 {
-	struct pl_jump_map	*jmap;
 	struct pl_obj_layout	*layout = NULL;
 	struct jm_obj_placement	jmop;
 	bool			is_extending = false;
@@ -1016,7 +1089,6 @@ jump_map_obj_place(struct pl_map *map, uint32_t layout_version, struct daos_obj_
 	uint32_t		allow_status;
 	int			rc;
 
-	jmap = pl_map2jmap(map);
 	oid = md->omd_id;
 	D_DEBUG(DB_PL, "Determining location for object: "DF_OID", ver: %d, pda %u\n",
 		DP_OID(oid), md->omd_ver, md->omd_pda);
@@ -1034,7 +1106,7 @@ jump_map_obj_place(struct pl_map *map, uint32_t layout_version, struct daos_obj_
 		allow_status = PO_COMP_ST_UPIN | PO_COMP_ST_DRAIN;
 
 	rc = obj_layout_alloc_and_get(jmap, layout_version, &jmop, md, allow_status,
-				      md->omd_ver, &layout, NULL, &is_extending);
+				      md->omd_ver, &layout, NULL, bufs, &is_extending);
 	if (rc != 0) {
 		D_ERROR("get_layout_alloc failed, rc "DF_RC"\n", DP_RC(rc));
 		D_GOTO(out, rc);
@@ -1058,7 +1130,7 @@ jump_map_obj_place(struct pl_map *map, uint32_t layout_version, struct daos_obj_
 	if (unlikely(is_extending || is_adding_new) && !(mode & DAOS_OO_RO)) {
 		D_DEBUG(DB_PL, DF_OID"/%d is being extended: %s\n", DP_OID(oid),
 			md->omd_ver, is_extending ? "yes" : "no");
-		rc = jump_map_obj_extend_layout(jmap, &jmop, layout_version, md, layout);
+		rc = jump_map_obj_extend_layout(jmap, &jmop, layout_version, md, layout, bufs);
 		if (rc)
 			D_GOTO(out, rc);
 	}
@@ -1076,6 +1148,49 @@ out:
 	return rc;
 }
 
+static int
+jump_map_obj_place(struct pl_map *map, uint32_t layout_version, struct daos_obj_md *md,
+		   unsigned int mode, struct daos_obj_shard_md *shard_md,
+		   struct pl_obj_layout **layout_pp)
+{
+	return jm_obj_place(pl_map2jmap(map), layout_version, md, mode, shard_md, NULL,
+			    layout_pp);
+}
+
+/**
+ * Batch version of jump_map_obj_place(), the bitmaps of the layout calculation
+ * are allocated once for all objects. The layouts are freed if any object fails.
+ */
+static int
+jump_map_obj_place_batch(struct pl_map *map, uint32_t layout_version, struct daos_obj_md *mds,
+			 unsigned int nr, unsigned int mode, struct pl_obj_layout **layouts)
+{
+	struct pl_jump_map	*jmap = pl_map2jmap(map);
+	struct jm_layout_bufs	 bufs;
+	unsigned int		 i;
+	int			 rc;
+
+	rc = jm_layout_bufs_init(jmap, &bufs);
+	if (rc != 0)
+		return rc;
+
+	for (i = 0; i < nr; i++) {
+		rc = jm_obj_place(jmap, layout_version, &mds[i], mode, NULL, &bufs, &layouts[i]);
+		if (rc != 0)
+			break;
+	}
+
+	if (rc != 0) {
+		while (i-- > 0) {
+			pl_obj_layout_free(layouts[i]);
+			layouts[i] = NULL;
+		}
+	}
+
+	jm_layout_bufs_fini(&bufs);
+	return rc;
+}
+
 /**
  *
  * \param[in]   map             The placement map to be used to generate the
@@ -1099,7 +1214,7 @@ out:
 static int
 jump_map_obj_find_diff(struct pl_map *map, uint32_t layout_ver, struct daos_obj_md *md,
 		       struct daos_obj_shard_md *shard_md, uint32_t reint_ver,
-		       uint32_t old_status, uint32_t new_status,
+		       uint32_t old_status, uint32_t new_status, struct jm_layout_bufs *bufs,
 		       uint32_t *tgt_rank, uint32_t *shard_id, unsigned int array_size)
 {
 	struct pl_jump_map              *jmap;
@@ -1129,13 +1244,13 @@ jump_map_obj_find_diff(struct pl_map *map, uint32_t layout_ver, struct daos_obj_
 
 	D_INIT_LIST_HEAD(&reint_list);
 	rc = obj_layout_alloc_and_get(jmap, layout_ver, &jop, md, old_status,
-				      reint_ver, &layout, NULL, NULL);
+				      reint_ver, &layout, NULL, bufs, NULL);
 	if (rc < 0)
 		D_GOTO(out, rc);
 
 	obj_layout_dump(md->omd_id, layout);
 	rc = obj_layout_alloc_and_get(jmap, layout_ver, &jop, md, new_status,
-				      reint_ver, &reint_layout, NULL, NULL);
+				      reint_ver, &reint_layout, NULL, bufs, NULL);
 	if (rc < 0)
 		D_GOTO(out, rc);
 
@@ -1163,7 +1278,7 @@ jump_map_obj_find_reint(struct pl_map *map, uint32_t layout_ver, struct daos_obj
 	return jump_map_obj_find_diff(map, layout_ver, md, shard_md, reint_ver,
 				      PO_COMP_ST_UPIN | PO_COMP_ST_DRAIN,
 				      PO_COMP_ST_UPIN | PO_COMP_ST_DRAIN | PO_COMP_ST_UP,
-				      tgt_id, shard_id, array_size);
+				      NULL, tgt_id, shard_id, array_size);
 }
 
 static int
@@ -1173,7 +1288,48 @@ jump_map_obj_find_rebuild(struct pl_map *map, uint32_t layout_ver, struct daos_o
 {
 	return jump_map_obj_find_diff(map, layout_ver, md, shard_md, rebuild_ver,
 				      PO_COMP_ST_UPIN | PO_COMP_ST_DRAIN | PO_COMP_ST_DOWN,
-				      PO_COMP_ST_UPIN, tgt_id, shard_id, array_size);
+				      PO_COMP_ST_UPIN, NULL, tgt_id, shard_id, array_size);
+}
+
+/**
+ * Batch version of jump_map_obj_find_rebuild(), object @i uses the slice
+ * [@i * @array_size, (@i + 1) * @array_size) of @tgt_id and @shard_id, its
+ * result (count of the shards to be rebuilt or error code) is in @nrs[@i].
+ */
+static int
+jump_map_obj_find_rebuild_batch(struct pl_map *map, uint32_t layout_ver, struct daos_obj_md *mds,
+				unsigned int nr, uint32_t rebuild_ver, uint32_t *tgt_id,
+				uint32_t *shard_id, unsigned int array_size, int *nrs)
+{
+	struct jm_layout_bufs	bufs;
+	unsigned int		i;
+	int			rc;
+
+	if (pl_map_version(map) < rebuild_ver) {
+		D_ERROR("pl_map version(%u) < rebuild version(%u)\n",
+			pl_map_version(map), rebuild_ver);
+		return -DER_INVAL;
+	}
+
+	rc = jm_layout_bufs_init(pl_map2jmap(map), &bufs);
+	if (rc != 0)
+		return rc;
+
+	for (i = 0; i < nr; i++) {
+		if (daos_oclass_grp_size(daos_oclass_attr_find(mds[i].omd_id, NULL)) == 1) {
+			nrs[i] = 0;
+			continue;
+		}
+
+		nrs[i] = jump_map_obj_find_diff(map, layout_ver, &mds[i], NULL, rebuild_ver,
+						PO_COMP_ST_UPIN | PO_COMP_ST_DRAIN |
+						PO_COMP_ST_DOWN, PO_COMP_ST_UPIN, &bufs,
+						&tgt_id[i * array_size], &shard_id[i * array_size],
+						array_size);
+	}
+
+	jm_layout_bufs_fini(&bufs);
+	return 0;
 }
 
 /** API for generic placement map functionality */
@@ -1183,7 +1339,9 @@ struct pl_map_ops       jump_map_ops = {
 	.o_query		= jump_map_query,
 	.o_print                = jump_map_print,
 	.o_obj_place            = jump_map_obj_place,
+	.o_obj_place_batch	= jump_map_obj_place_batch,
 	.o_obj_find_rebuild     = jump_map_obj_find_rebuild,
+	.o_obj_find_rebuild_batch = jump_map_obj_find_rebuild_batch,
 	.o_obj_find_reint       = jump_map_obj_find_reint,
 	.o_obj_find_addition      = jump_map_obj_find_reint,
 };
@@ -0,0 +1,394 @@
+/**
+ * (C) Copyright 2023 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+/**
+ * This file is part of daos_sr
+ *
+ * src/placement/pl_cache.c
+ *
+ * Cache of the object layouts computed by pl_obj_place(). Placement is
+ * deterministic for the same placement map, so the cache hangs off the
+ * pl_map: a new pool map version creates a new pl_map with an empty cache,
+ * the layouts are computed again on demand, and the stale cache is released
+ * with the old pl_map once the last user drops it.
+ *
+ * The cache is split into shards (by object ID hash) to avoid contention of
+ * the client threads, each shard is bounded by the memory of its layouts (the
+ * size of a layout grows with the shard count of the object class) and evicts
+ * in LRU order.
+ */
+#define D_LOGFAC        DD_FAC(placement)
+
+#include "pl_map.h"
+#include <gurt/hash.h>
+#include <gurt/atomic.h>
+
+#define PL_CACHE_SIZE_ENV	"DAOS_PL_CACHE_SIZE"
+/** default size in MiB of the cached layouts per placement map */
+#define PL_CACHE_SIZE_DEF	16
+#define PL_CACHE_SHARD_NR	16
+#define PL_CACHE_HTABLE_BITS	8
+
+struct pl_cache_key {
+	daos_obj_id_t	pck_oid;
+	uint32_t	pck_ver;
+	uint32_t	pck_fdom_lvl;
+	uint32_t	pck_pdom_lvl;
+	uint32_t	pck_pda;
+	uint32_t	pck_mode;
+	uint32_t	pck_layout_ver;
+};
+
+struct pl_cache_entry {
+	/** link chain on the shard hash table */
+	d_list_t		 pce_hlink;
+	/** link chain on the shard LRU list */
+	d_list_t		 pce_lru;
+	struct pl_cache_key	 pce_key;
+	struct pl_obj_layout	*pce_layout;
+	/** memory charged to the shard, see pl_cache_entry_size() */
+	uint32_t		 pce_size;
+};
+
+struct pl_cache_shard {
+	pthread_mutex_t		 pcs_lock;
+	struct d_hash_table	 pcs_htable;
+	/** LRU list, the head is the most recently used */
+	d_list_t		 pcs_lru;
+	uint32_t		 pcs_nr;
+	uint64_t		 pcs_bytes;
+	uint64_t		 pcs_hits;
+	uint64_t		 pcs_misses;
+	uint64_t		 pcs_evictions;
+};
+
+struct pl_cache {
+	/** max bytes of the cached layouts per shard */
+	uint64_t		 pc_shard_max;
+	struct pl_cache_shard	 pc_shards[PL_CACHE_SHARD_NR];
+};
+
+/** max size in MiB of the cached layouts per placement map, 0 to disable */
+static unsigned int		pl_cache_size = PL_CACHE_SIZE_DEF;
+/** statistics of the released caches, reported by pl_cache_fini() */
+static ATOMIC uint64_t		pl_cache_hits;
+static ATOMIC uint64_t		pl_cache_misses;
+static ATOMIC uint64_t		pl_cache_evictions;
+
+static inline struct pl_cache_entry *
+pl_link2entry(d_list_t *link)
+{
+	return container_of(link, struct pl_cache_entry, pce_hlink);
+}
+
+static uint32_t
+pl_cache_key_hash(struct d_hash_table *htab, const void *key,
+		  unsigned int ksize)
+{
+	D_ASSERT(ksize == sizeof(struct pl_cache_key));
+	return (uint32_t)d_hash_murmur64(key, ksize, 2023);
+}
+
+static bool
+pl_cache_key_cmp(struct d_hash_table *htab, d_list_t *link,
+		 const void *key, unsigned int ksize)
+{
+	struct pl_cache_entry	*entry = pl_link2entry(link);
+
+	D_ASSERT(ksize == sizeof(struct pl_cache_key));
+	return memcmp(&entry->pce_key, key, ksize) == 0;
+}
+
+static d_hash_table_ops_t pl_cache_hops = {
+	.hop_key_hash		= pl_cache_key_hash,
+	.hop_key_cmp		= pl_cache_key_cmp,
+};
+
+static void
+pl_cache_key_init(struct pl_cache_key *key, uint32_t layout_ver,
+		  struct daos_obj_md *md, unsigned int mode)
+{
+	memset(key, 0, sizeof(*key));
+	key->pck_oid = md->omd_id;
+	key->pck_ver = md->omd_ver;
+	key->pck_fdom_lvl = md->omd_fdom_lvl;
+	key->pck_pdom_lvl = md->omd_pdom_lvl;
+	key->pck_pda = md->omd_pda;
+	key->pck_mode = mode;
+	key->pck_layout_ver = layout_ver;
+}
+
+static int
+pl_layout_dup(struct pl_obj_layout *src, struct pl_obj_layout **dst_pp)
+{
+	struct pl_obj_layout	*dst;
+	int			 rc;
+
+	rc = pl_obj_layout_alloc(src->ol_grp_size, src->ol_grp_nr, &dst);
+	if (rc != 0)
+		return rc;
+
+	D_ASSERT(dst->ol_nr == src->ol_nr);
+	dst->ol_ver = src->ol_ver;
+	memcpy(dst->ol_shards, src->ol_shards, sizeof(*src->ol_shards) * src->ol_nr);
+	*dst_pp = dst;
+	return 0;
+}
+
+static inline uint32_t
+pl_cache_entry_size(struct pl_obj_layout *layout)
+{
+	return sizeof(struct pl_cache_entry) + sizeof(*layout) +
+	       layout->ol_nr * sizeof(*layout->ol_shards);
+}
+
+static void
+pl_cache_entry_free(struct pl_cache_shard *shard, struct pl_cache_entry *entry)
+{
+	d_hash_rec_delete_at(&shard->pcs_htable, &entry->pce_hlink);
+	d_list_del(&entry->pce_lru);
+	shard->pcs_nr--;
+	D_ASSERT(shard->pcs_bytes >= entry->pce_size);
+	shard->pcs_bytes -= entry->pce_size;
+	pl_obj_layout_free(entry->pce_layout);
+	D_FREE(entry);
+}
+
+static void
+pl_cache_destroy(struct pl_cache *cache, int shard_nr)
+{
+	struct pl_cache_shard	*shard;
+	struct pl_cache_entry	*entry;
+	struct pl_cache_entry	*tmp;
+	int			 i;
+
+	for (i = 0; i < shard_nr; i++) {
+		shard = &cache->pc_shards[i];
+		d_list_for_each_entry_safe(entry, tmp, &shard->pcs_lru, pce_lru)
+			pl_cache_entry_free(shard, entry);
+
+		atomic_fetch_add_relaxed(&pl_cache_hits, shard->pcs_hits);
+		atomic_fetch_add_relaxed(&pl_cache_misses, shard->pcs_misses);
+		atomic_fetch_add_relaxed(&pl_cache_evictions, shard->pcs_evictions);
+		d_hash_table_destroy_inplace(&shard->pcs_htable, true);
+		D_MUTEX_DESTROY(&shard->pcs_lock);
+	}
+	D_FREE(cache);
+}
+
+static struct pl_cache *
+pl_cache_create(void)
+{
+	struct pl_cache		*cache;
+	struct pl_cache_shard	*shard;
+	int			 i;
+	int			 rc;
+
+	D_ALLOC_PTR(cache);
+	if (cache == NULL)
+		return NULL;
+
+	cache->pc_shard_max = ((uint64_t)pl_cache_size << 20) / PL_CACHE_SHARD_NR;
+	for (i = 0; i < PL_CACHE_SHARD_NR; i++) {
+		shard = &cache->pc_shards[i];
+		D_INIT_LIST_HEAD(&shard->pcs_lru);
+		rc = d_hash_table_create_inplace(D_HASH_FT_NOLOCK | D_HASH_FT_EPHEMERAL,
+						 PL_CACHE_HTABLE_BITS, NULL, &pl_cache_hops,
+						 &shard->pcs_htable);
+		if (rc != 0)
+			break;
+
+		rc = D_MUTEX_INIT(&shard->pcs_lock, NULL);
+		if (rc != 0) {
+			d_hash_table_destroy_inplace(&shard->pcs_htable, true);
+			break;
+		}
+	}
+
+	if (i < PL_CACHE_SHARD_NR) {
+		pl_cache_destroy(cache, i);
+		return NULL;
+	}
+
+	return cache;
+}
+
+/** Get the layout cache of @map, create it on the first use. */
+static struct pl_cache *
+pl_cache_get(struct pl_map *map)
+{
+	struct pl_cache	*cache;
+
+	cache = map->pl_cache;
+	if (likely(cache != NULL))
+		return cache;
+
+	cache = pl_cache_create();
+	if (cache == NULL)
+		return NULL;
+
+	D_SPIN_LOCK(&map->pl_lock);
+	if (map->pl_cache == NULL) {
+		map->pl_cache = cache;
+		cache = NULL;
+	}
+	D_SPIN_UNLOCK(&map->pl_lock);
+
+	/* Lost the race to another thread. */
+	if (cache != NULL)
+		pl_cache_destroy(cache, PL_CACHE_SHARD_NR);
+
+	return map->pl_cache;
+}
+
+/**
+ * Same as pl_obj_place() without @shard_md, but serve the layout from the
+ * cache of @map if it has been computed with the same input. The returned
+ * layout is a private copy, the caller should free it by pl_obj_layout_free().
+ */
+int
+pl_obj_place_cached(struct pl_map *map, uint16_t layout_gl_version, struct daos_obj_md *md,
+		    unsigned int mode, struct pl_obj_layout **layout_pp)
+{
+	struct pl_cache		*cache = NULL;
+	struct pl_cache_shard	*shard;
+	struct pl_cache_entry	*entry;
+	struct pl_obj_layout	*layout;
+	struct pl_cache_key	 key;
+	d_list_t		*link;
+	int			 rc;
+
+	if (pl_cache_size > 0)
+		cache = pl_cache_get(map);
+	if (cache == NULL)
+		return pl_obj_place(map, layout_gl_version, md, mode, NULL, layout_pp);
+
+	pl_cache_key_init(&key, layout_gl_version, md, mode);
+	shard = &cache->pc_shards[d_hash_murmur64((unsigned char *)&md->omd_id,
+						  sizeof(md->omd_id), 5731) % PL_CACHE_SHARD_NR];
+
+	D_MUTEX_LOCK(&shard->pcs_lock);
+	link = d_hash_rec_find(&shard->pcs_htable, &key, sizeof(key));
+	if (link != NULL) {
+		entry = pl_link2entry(link);
+		d_list_move(&entry->pce_lru, &shard->pcs_lru);
+		shard->pcs_hits++;
+		rc = pl_layout_dup(entry->pce_layout, layout_pp);
+		D_MUTEX_UNLOCK(&shard->pcs_lock);
+		return rc;
+	}
+	shard->pcs_misses++;
+	D_MUTEX_UNLOCK(&shard->pcs_lock);
+
+	rc = pl_obj_place(map, layout_gl_version, md, mode, NULL, &layout);
+	if (rc != 0)
+		return rc;
+
+	/* Don't let a huge layout flush the whole shard */
+	if (pl_cache_entry_size(layout) > cache->pc_shard_max)
+		goto out;
+
+	D_ALLOC_PTR(entry);
+	if (entry == NULL)
+		goto out;
+
+	rc = pl_layout_dup(layout, &entry->pce_layout);
+	if (rc != 0) {
+		D_FREE(entry);
+		D_GOTO(out, rc = 0);
+	}
+	entry->pce_key = key;
+	entry->pce_size = pl_cache_entry_size(layout);
+
+	D_MUTEX_LOCK(&shard->pcs_lock);
+	rc = d_hash_rec_insert(&shard->pcs_htable, &key, sizeof(key), &entry->pce_hlink, true);
+	if (rc != 0) {
+		/* Inserted by another thread, it is the same layout. */
+		D_MUTEX_UNLOCK(&shard->pcs_lock);
+		pl_obj_layout_free(entry->pce_layout);
+		D_FREE(entry);
+		D_GOTO(out, rc = 0);
+	}
+
+	d_list_add(&entry->pce_lru, &shard->pcs_lru);
+	shard->pcs_nr++;
+	shard->pcs_bytes += entry->pce_size;
+	/* The new entry is at the head and fits, it's never evicted here */
+	while (shard->pcs_bytes > cache->pc_shard_max) {
+		pl_cache_entry_free(shard, d_list_entry(shard->pcs_lru.prev,
+							struct pl_cache_entry, pce_lru));
+		shard->pcs_evictions++;
+	}
+	D_MUTEX_UNLOCK(&shard->pcs_lock);
+out:
+	*layout_pp = layout;
+	return 0;
+}
+
+/** Query the statistics of the layout cache of @map. */
+void
+pl_map_cache_query(struct pl_map *map, struct pl_cache_stats *stats)
+{
+	struct pl_cache_shard	*shard;
+	int			 i;
+
+	memset(stats, 0, sizeof(*stats));
+	if (map->pl_cache == NULL)
+		return;
+
+	for (i = 0; i < PL_CACHE_SHARD_NR; i++) {
+		shard = &map->pl_cache->pc_shards[i];
+		D_MUTEX_LOCK(&shard->pcs_lock);
+		stats->pcs_hits += shard->pcs_hits;
+		stats->pcs_misses += shard->pcs_misses;
+		stats->pcs_evictions += shard->pcs_evictions;
+		stats->pcs_entries += shard->pcs_nr;
+		stats->pcs_bytes += shard->pcs_bytes;
+		D_MUTEX_UNLOCK(&shard->pcs_lock);
+	}
+}
+
+/** Release the layout cache of @map, it is called when destroying @map. */
+void
+pl_map_cache_destroy(struct pl_map *map)
+{
+	struct pl_cache_stats	stats;
+
+	if (map->pl_cache == NULL)
+		return;
+
+	pl_map_cache_query(map, &stats);
+	D_DEBUG(DB_PL, "Layout cache of "DF_UUID" ver %u: hits "DF_U64", misses "DF_U64
+		", evictions "DF_U64", entries "DF_U64", bytes "DF_U64"\n",
+		DP_UUID(map->pl_uuid), pl_map_version(map), stats.pcs_hits, stats.pcs_misses,
+		stats.pcs_evictions, stats.pcs_entries, stats.pcs_bytes);
+
+	pl_cache_destroy(map->pl_cache, PL_CACHE_SHARD_NR);
+	map->pl_cache = NULL;
+}
+
+void
+pl_cache_init(void)
+{
+	pl_cache_size = PL_CACHE_SIZE_DEF;
+	d_getenv_int(PL_CACHE_SIZE_ENV, &pl_cache_size);
+	pl_cache_hits = 0;
+	pl_cache_misses = 0;
+	pl_cache_evictions = 0;
+}
+
+void
+pl_cache_fini(void)
+{
+	uint64_t	hits = atomic_load_relaxed(&pl_cache_hits);
+	uint64_t	misses = atomic_load_relaxed(&pl_cache_misses);
+
+	if (hits + misses == 0)
+		return;
+
+	D_INFO("Object layout cache: hits "DF_U64", misses "DF_U64" (hit rate %.1f%%), "
+	       "evictions "DF_U64"\n", hits, misses, hits * 100.0 / (hits + misses),
+	       atomic_load_relaxed(&pl_cache_evictions));
+}
@@ -81,6 +81,7 @@ pl_map_create_inited(struct pool_map *pool_map, struct pl_map_init_attr *mia,
 	map->pl_connects = 0;
 	map->pl_type = mia->ia_type;
 	map->pl_ops  = dict->pd_ops;
+	map->pl_cache = NULL;
 	D_INIT_LIST_HEAD(&map->pl_link);
 
 	*pl_mapp = map;
@@ -97,6 +98,7 @@ pl_map_destroy(struct pl_map *map)
 	D_ASSERT(map->pl_ops != NULL);
 	D_ASSERT(map->pl_ops->o_destroy != NULL);
 
+	pl_map_cache_destroy(map);
 	D_SPIN_DESTROY(&map->pl_lock);
 	map->pl_ops->o_destroy(map);
 }
@@ -126,6 +128,41 @@ pl_obj_place(struct pl_map *map, uint16_t layout_gl_version, struct daos_obj_md
 	return map->pl_ops->o_obj_place(map, layout_gl_version, md, mode, shard_md, layout_pp);
 }
 
+/**
+ * Compute the layouts of the @nr objects in @mds in one call, the result is
+ * the same as calling pl_obj_place() for each of them, but the placement map
+ * can share the per-map state and buffers among the objects. Either all the
+ * layouts are returned in @layouts, or none of them if any object fails.
+ */
+int
+pl_obj_place_batch(struct pl_map *map, uint16_t layout_gl_version, struct daos_obj_md *mds,
+		   unsigned int nr, unsigned int mode, struct pl_obj_layout **layouts)
+{
+	unsigned int	i;
+	int		rc = 0;
+
+	D_ASSERT(map->pl_ops != NULL);
+	D_ASSERT(layout_gl_version < MAX_OBJ_LAYOUT_VERSION);
+
+	if (map->pl_ops->o_obj_place_batch != NULL)
+		return map->pl_ops->o_obj_place_batch(map, layout_gl_version, mds, nr, mode,
+						      layouts);
+
+	for (i = 0; i < nr; i++) {
+		rc = pl_obj_place(map, layout_gl_version, &mds[i], mode, NULL, &layouts[i]);
+		if (rc != 0)
+			break;
+	}
+
+	if (rc != 0) {
+		while (i-- > 0) {
+			pl_obj_layout_free(layouts[i]);
+			layouts[i] = NULL;
+		}
+	}
+	return rc;
+}
+
 /**
  * Check if the provided object has any shard needs to be rebuilt for the
  * given rebuild version @rebuild_ver.
@@ -163,6 +200,36 @@ pl_obj_find_rebuild(struct pl_map *map, uint32_t layout_gl_version, struct daos_
 					       tgt_rank, shard_id, array_size);
 }
 
+/**
+ * Batch version of pl_obj_find_rebuild() for the @nr objects in @mds. The
+ * object @i uses the slice [@i * @array_size, (@i + 1) * @array_size) of
+ * @tgt_rank and @shard_id, and its result, which is the same as the return
+ * value of pl_obj_find_rebuild(), is stored in @nrs[@i].
+ *
+ * \return	0 if the results are stored in @nrs, otherwise error code.
+ */
+int
+pl_obj_find_rebuild_batch(struct pl_map *map, uint32_t layout_gl_version,
+			  struct daos_obj_md *mds, unsigned int nr, uint32_t rebuild_ver,
+			  uint32_t *tgt_rank, uint32_t *shard_id, unsigned int array_size,
+			  int *nrs)
+{
+	unsigned int	i;
+
+	D_ASSERT(map->pl_ops != NULL);
+
+	if (map->pl_ops->o_obj_find_rebuild_batch != NULL)
+		return map->pl_ops->o_obj_find_rebuild_batch(map, layout_gl_version, mds, nr,
+							     rebuild_ver, tgt_rank, shard_id,
+							     array_size, nrs);
+
+	for (i = 0; i < nr; i++)
+		nrs[i] = pl_obj_find_rebuild(map, layout_gl_version, &mds[i], NULL, rebuild_ver,
+					     &tgt_rank[i * array_size],
+					     &shard_id[i * array_size], array_size);
+	return 0;
+}
+
 int
 pl_obj_find_drain(struct pl_map *map, uint32_t layout_gl_version, struct daos_obj_md *md,
 		  struct daos_obj_shard_md *shard_md, uint32_t rebuild_ver, uint32_t *tgt_rank,
@@ -614,6 +681,7 @@ pl_map_query(uuid_t po_uuid, struct pl_map_attr *attr)
 /** Initialize the placement module. */
 int pl_init(void)
 {
+	pl_cache_init();
 	return d_hash_table_create_inplace(D_HASH_FT_NOLOCK, PL_HTABLE_BITS,
 					   NULL, &pl_hash_ops, &pl_htable);
 }
@@ -622,4 +690,5 @@ int pl_init(void)
 void pl_fini(void)
 {
 	d_hash_table_destroy_inplace(&pl_htable, true /* force */);
+	pl_cache_fini();
 }
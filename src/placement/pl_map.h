@@ -40,6 +40,13 @@ struct pl_map_ops {
 			   unsigned int	mode,
 			   struct daos_obj_shard_md *shard_md,
 			   struct pl_obj_layout **layout_pp);
+	/** see \a pl_obj_place_batch, optional */
+	int (*o_obj_place_batch)(struct pl_map *map,
+				 uint32_t layout_gl_version,
+				 struct daos_obj_md *mds,
+				 unsigned int nr,
+				 unsigned int mode,
+				 struct pl_obj_layout **layouts);
 	/** see \a pl_map_obj_rebuild */
 	int (*o_obj_find_rebuild)(struct pl_map *map,
 				  uint32_t layout_gl_version,
@@ -49,6 +56,16 @@ struct pl_map_ops {
 				  uint32_t *tgt_rank,
 				  uint32_t *shard_id,
 				  unsigned int array_size);
+	/** see \a pl_obj_find_rebuild_batch, optional */
+	int (*o_obj_find_rebuild_batch)(struct pl_map *map,
+					uint32_t layout_gl_version,
+					struct daos_obj_md *mds,
+					unsigned int nr,
+					uint32_t rebuild_ver,
+					uint32_t *tgt_rank,
+					uint32_t *shard_id,
+					unsigned int array_size,
+					int *nrs);
 	int (*o_obj_find_reint)(struct pl_map *map,
 				uint32_t layout_gl_version,
 				struct daos_obj_md *md,
@@ -150,4 +167,12 @@ pl_map_extend(struct pl_obj_layout *layout, d_list_t *extended_list);
 bool
 need_remap_comp(struct pool_component *comp, uint32_t allow_status);
 
+/** pl_cache.c */
+void
+pl_cache_init(void);
+void
+pl_cache_fini(void);
+void
+pl_map_cache_destroy(struct pl_map *map);
+
 #endif /* __PL_MAP_H__ */
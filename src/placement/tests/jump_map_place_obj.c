@@ -2291,6 +2291,185 @@ fail_multiple_ranks(void **state)
 	jtc_fini(&ctx);
 }
 
+static void
+layout_cache(void **state)
+{
+	struct jm_test_ctx	 ctx;
+	struct pl_obj_layout	*cached;
+	struct pl_cache_stats	 stats;
+	struct daos_obj_md	 md = { 0 };
+	int			 i, j;
+
+	jtc_init(&ctx, 4, 2, 4, OC_RP_3G2, g_verbose);
+
+	/* The cached layout is the same as the computed one, hit on the second lookup. */
+	for (i = 0; i < 200; i++) {
+		ctx.oid.lo = i / 2;
+		md.omd_id = ctx.oid;
+		md.omd_ver = pool_map_get_version(ctx.po_map);
+		assert_success(jtc_create_layout(&ctx));
+		assert_success(pl_obj_place_cached(ctx.pl_map, PLT_LAYOUT_VERSION, &md, 0,
+						   &cached));
+		assert_int_equal(cached->ol_nr, ctx.layout->ol_nr);
+		assert_int_equal(cached->ol_grp_size, ctx.layout->ol_grp_size);
+		for (j = 0; j < cached->ol_nr; j++)
+			assert_int_equal(cached->ol_shards[j].po_target,
+					 ctx.layout->ol_shards[j].po_target);
+		pl_obj_layout_free(cached);
+	}
+
+	pl_map_cache_query(ctx.pl_map, &stats);
+	assert_int_equal(stats.pcs_hits, 100);
+	assert_int_equal(stats.pcs_misses, 100);
+	assert_int_equal(stats.pcs_entries, 100);
+	assert_true(stats.pcs_bytes > 100 * sizeof(struct pl_obj_layout));
+
+	/* New pool map version, the layout is computed again. */
+	ctx.oid.lo = 0;
+	assert_success(jtc_create_layout(&ctx));
+	jtc_set_status_on_target(&ctx, DOWN, jtc_layout_shard_tgt(&ctx, 0));
+	assert_success(jtc_create_layout(&ctx));
+	md.omd_id = ctx.oid;
+	md.omd_ver = pool_map_get_version(ctx.po_map);
+	assert_success(pl_obj_place_cached(ctx.pl_map, PLT_LAYOUT_VERSION, &md, 0, &cached));
+	for (j = 0; j < cached->ol_nr; j++)
+		assert_int_equal(cached->ol_shards[j].po_target,
+				 ctx.layout->ol_shards[j].po_target);
+	pl_obj_layout_free(cached);
+
+	pl_map_cache_query(ctx.pl_map, &stats);
+	assert_int_equal(stats.pcs_misses, 101);
+
+	jtc_fini(&ctx);
+}
+
+/* The cached layouts are bounded by DAOS_PL_CACHE_SIZE MiB, LRU ones are evicted. */
+static void
+layout_cache_bound(void **state)
+{
+	struct jm_test_ctx	 ctx;
+	struct pl_obj_layout	*cached;
+	struct pl_cache_stats	 stats;
+	struct daos_obj_md	 md = { 0 };
+	int			 nr = 20000;
+	int			 i;
+
+	pl_fini();
+	setenv("DAOS_PL_CACHE_SIZE", "1", 1);
+	assert_success(pl_init());
+
+	jtc_init(&ctx, 4, 2, 4, OC_RP_3G2, g_verbose);
+	md.omd_ver = pool_map_get_version(ctx.po_map);
+	for (i = 0; i < nr; i++) {
+		ctx.oid.lo = i;
+		md.omd_id = ctx.oid;
+		assert_success(pl_obj_place_cached(ctx.pl_map, PLT_LAYOUT_VERSION, &md, 0,
+						   &cached));
+		pl_obj_layout_free(cached);
+	}
+
+	pl_map_cache_query(ctx.pl_map, &stats);
+	assert_int_equal(stats.pcs_misses, nr);
+	assert_true(stats.pcs_evictions > 0);
+	assert_int_equal(stats.pcs_entries + stats.pcs_evictions, nr);
+	assert_true(stats.pcs_bytes <= (1 << 20));
+	/* Each shard is filled up to the last layout */
+	assert_true(stats.pcs_bytes > (1 << 20) - 16 * (stats.pcs_bytes / stats.pcs_entries));
+
+	/* The most recently used layout is still cached, the oldest one is evicted. */
+	ctx.oid.lo = nr - 1;
+	md.omd_id = ctx.oid;
+	assert_success(pl_obj_place_cached(ctx.pl_map, PLT_LAYOUT_VERSION, &md, 0, &cached));
+	pl_obj_layout_free(cached);
+	ctx.oid.lo = 0;
+	md.omd_id = ctx.oid;
+	assert_success(pl_obj_place_cached(ctx.pl_map, PLT_LAYOUT_VERSION, &md, 0, &cached));
+	pl_obj_layout_free(cached);
+	pl_map_cache_query(ctx.pl_map, &stats);
+	assert_int_equal(stats.pcs_hits, 1);
+	assert_int_equal(stats.pcs_misses, nr + 1);
+
+	/* Disabled */
+	jtc_fini(&ctx);
+	pl_fini();
+	setenv("DAOS_PL_CACHE_SIZE", "0", 1);
+	assert_success(pl_init());
+	jtc_init(&ctx, 4, 2, 4, OC_RP_3G2, g_verbose);
+	md.omd_id = ctx.oid;
+	assert_success(pl_obj_place_cached(ctx.pl_map, PLT_LAYOUT_VERSION, &md, 0, &cached));
+	pl_obj_layout_free(cached);
+	pl_map_cache_query(ctx.pl_map, &stats);
+	assert_int_equal(stats.pcs_misses, 0);
+
+	unsetenv("DAOS_PL_CACHE_SIZE");
+	jtc_fini(&ctx);
+}
+
+/* The batch rebuild scan returns the same shards and spare targets as the scalar one. */
+static void
+find_rebuild_batch(void **state)
+{
+	struct jm_test_ctx	 ctx;
+	daos_oclass_id_t	 classes[] = { OC_RP_3G2, OC_EC_2P1G1, OC_S1, OC_RP_2G1 };
+	struct daos_obj_md	 mds[64] = { 0 };
+	uint32_t		 tgts[64 * 16], ids[64 * 16];
+	uint32_t		 batch_tgts[64 * 16], batch_ids[64 * 16];
+	int			 nrs[64];
+	int			 array_size = 16;
+	int			 nr = ARRAY_SIZE(mds);
+	int			 remapped = 0;
+	int			 i, j, rc;
+
+	jtc_init(&ctx, 4, 2, 4, OC_RP_3G2, g_verbose);
+
+	/* Failed targets, and one which has been rebuilt */
+	jtc_set_status_on_target(&ctx, DOWN, 0);
+	jtc_set_status_on_target(&ctx, DOWN, 9);
+	jtc_set_status_on_target(&ctx, DOWN, 17);
+	jtc_set_status_on_target(&ctx, DOWNOUT, 17);
+	jtc_set_status_on_target(&ctx, DOWN, 26);
+
+	for (i = 0; i < nr; i++) {
+		gen_oid(&mds[i].omd_id, i + 1, 0, classes[i % ARRAY_SIZE(classes)]);
+		mds[i].omd_ver = ctx.ver;
+	}
+
+	memset(batch_tgts, 0xff, sizeof(batch_tgts));
+	memset(batch_ids, 0xff, sizeof(batch_ids));
+	assert_success(pl_obj_find_rebuild_batch(ctx.pl_map, PLT_LAYOUT_VERSION, mds, nr,
+						 ctx.ver, batch_tgts, batch_ids, array_size,
+						 nrs));
+
+	for (i = 0; i < nr; i++) {
+		rc = pl_obj_find_rebuild(ctx.pl_map, PLT_LAYOUT_VERSION, &mds[i], NULL, ctx.ver,
+					 &tgts[i * array_size], &ids[i * array_size],
+					 array_size);
+		assert_int_equal(nrs[i], rc);
+		for (j = 0; j < rc; j++) {
+			assert_int_equal(batch_tgts[i * array_size + j], tgts[i * array_size + j]);
+			assert_int_equal(batch_ids[i * array_size + j], ids[i * array_size + j]);
+			/* Never rebuilt onto a failed target */
+			assert_true(batch_tgts[i * array_size + j] != 0 &&
+				    batch_tgts[i * array_size + j] != 9 &&
+				    batch_tgts[i * array_size + j] != 17 &&
+				    batch_tgts[i * array_size + j] != 26);
+		}
+		if (daos_oclass_grp_size(daos_oclass_attr_find(mds[i].omd_id, NULL)) == 1)
+			assert_int_equal(nrs[i], 0);
+		if (rc > 0)
+			remapped++;
+	}
+	/* Some of the objects have shards on the failed targets */
+	assert_true(remapped > 0);
+
+	/* Rebuild version newer than the pool map */
+	rc = pl_obj_find_rebuild_batch(ctx.pl_map, PLT_LAYOUT_VERSION, mds, nr, ctx.ver + 1,
+				       batch_tgts, batch_ids, array_size, nrs);
+	assert_rc_equal(rc, -DER_INVAL);
+
+	jtc_fini(&ctx);
+}
+
 /*
  * ------------------------------------------------
  * End Test Cases
@@ -2388,6 +2567,9 @@ static const struct CMUnitTest tests[] = {
 	  fail_shard_during_reintegration),
 	T("fail reintegrate ranks", fail_reintegrate_multiple_ranks),
 	T("fail multiple ranks", fail_multiple_ranks),
+	T("layout cache", layout_cache),
+	T("layout cache bound", layout_cache_bound),
+	T("find rebuild batch", find_rebuild_batch),
 };
 
 int
@@ -35,6 +35,10 @@ extern void obj_class_fini(void);
 #define DEFAULT_ADDITION_NUM_TO_ADD 32
 #define DEFAULT_ADDITION_TEST_ENTRIES 100000
 
+#define DEFAULT_BATCH_SIZE 256
+#define DEFAULT_BATCH_TEST_ENTRIES 100000
+#define BATCH_REBUILD_ARRAY_SIZE 32
+
 static void
 print_usage(const char *prog_name, const char *const ops[], uint32_t num_ops)
 {
@@ -576,6 +580,200 @@ out:
 		D_FREE(obj_table);
 }
 
+static void
+benchmark_batch_usage()
+{
+	D_PRINT(
+		"Batch placement benchmark usage: -- [optional arguments]\n"
+		"\n"
+		"Optional Arguments\n"
+		"  --batch-size <num>\n"
+		"      Short version: -b\n"
+		"      Number of objects placed by each batch call\n"
+		"      Default: %d\n"
+		"\n"
+		"  --num-test-entries <num>\n"
+		"      Short version: -t\n"
+		"      Number of objects to place\n"
+		"      Default: %d\n"
+		"\n",
+		DEFAULT_BATCH_SIZE, DEFAULT_BATCH_TEST_ENTRIES);
+}
+
+static void
+print_batch_result(const char *name, int count, struct benchmark_handle *bench_hdl)
+{
+	D_PRINT("%s,%d,%lld,%lld,%lld\n", name, count, bench_hdl->wallclock_delta_ns,
+		bench_hdl->thread_delta_ns,
+		NANOSECONDS_PER_SECOND * count / bench_hdl->thread_delta_ns);
+}
+
+/*
+ * Compare the scalar and the batch placement APIs, both the layout calculation
+ * and the rebuild scan (after failing a target), and verify that they return
+ * the same results.
+ */
+static void
+benchmark_batch(int argc, char **argv, uint32_t num_domains,
+		uint32_t nodes_per_domain, uint32_t vos_per_target)
+{
+	struct pool_map		 *pool_map;
+	struct pl_map		 *pl_map;
+	struct daos_obj_md	 *obj_table = NULL;
+	struct pl_obj_layout	**scalar_layout = NULL;
+	struct pl_obj_layout	**batch_layout = NULL;
+	struct benchmark_handle	 *bench_hdl = NULL;
+	uint32_t		 *scalar_tgts = NULL;
+	uint32_t		 *scalar_shards = NULL;
+	uint32_t		 *batch_tgts = NULL;
+	uint32_t		 *batch_shards = NULL;
+	int			 *scalar_nrs = NULL;
+	int			 *batch_nrs = NULL;
+	int			  batch_size = DEFAULT_BATCH_SIZE;
+	int			  test_entries = DEFAULT_BATCH_TEST_ENTRIES;
+	uint32_t		  ver;
+	size_t			  slice;
+	int			  i, j;
+	int			  rc;
+
+	while (1) {
+		static struct option long_options[] = {
+			{"batch-size", required_argument, 0, 'b'},
+			{"num-test-entries", required_argument, 0, 't'},
+			{0, 0, 0, 0}
+		};
+		int c;
+
+		c = getopt_long(argc, argv, "b:t:", long_options, NULL);
+		if (c == -1)
+			break;
+
+		switch (c) {
+		case 'b':
+			batch_size = atoi(optarg);
+			break;
+		case 't':
+			test_entries = atoi(optarg);
+			break;
+		case '?':
+		default:
+			D_PRINT("ERROR: Unrecognized argument '%s'\n", optarg);
+			benchmark_batch_usage();
+			return;
+		}
+	}
+	if (batch_size <= 0 || test_entries <= 0) {
+		D_PRINT("ERROR: invalid batch size or test entries\n");
+		benchmark_batch_usage();
+		return;
+	}
+
+	gen_pool_and_placement_map(1, num_domains, nodes_per_domain, vos_per_target,
+				   PL_TYPE_JUMP_MAP, PO_COMP_TP_RANK, &pool_map, &pl_map);
+	D_ASSERT(pool_map != NULL);
+	D_ASSERT(pl_map != NULL);
+
+	slice = (size_t)test_entries * BATCH_REBUILD_ARRAY_SIZE;
+	D_ALLOC_ARRAY(obj_table, test_entries);
+	D_ALLOC_ARRAY(scalar_layout, test_entries);
+	D_ALLOC_ARRAY(batch_layout, test_entries);
+	D_ALLOC_ARRAY(scalar_tgts, slice);
+	D_ALLOC_ARRAY(scalar_shards, slice);
+	D_ALLOC_ARRAY(batch_tgts, slice);
+	D_ALLOC_ARRAY(batch_shards, slice);
+	D_ALLOC_ARRAY(scalar_nrs, test_entries);
+	D_ALLOC_ARRAY(batch_nrs, test_entries);
+	bench_hdl = benchmark_alloc();
+	D_ASSERT(obj_table != NULL && scalar_layout != NULL && batch_layout != NULL &&
+		 scalar_tgts != NULL && scalar_shards != NULL && batch_tgts != NULL &&
+		 batch_shards != NULL && scalar_nrs != NULL && batch_nrs != NULL &&
+		 bench_hdl != NULL);
+
+	ver = pool_map_get_version(pool_map);
+	for (i = 0; i < test_entries; i++) {
+		obj_table[i].omd_id.lo = rand();
+		obj_table[i].omd_id.hi = 5;
+		rc = daos_obj_set_oid_by_class(&obj_table[i].omd_id, 0, OC_RP_3G2, 0);
+		D_ASSERT(rc == 0);
+		obj_table[i].omd_ver = ver;
+	}
+
+	D_PRINT("\nBatch placement benchmark results (batch size %d):\n", batch_size);
+	D_PRINT("# API, Iterations, Wallclock time (ns), thread time (ns), "
+		"objects per second per core\n");
+
+	benchmark_start(bench_hdl);
+	for (i = 0; i < test_entries; i++) {
+		rc = pl_obj_place(pl_map, 0, &obj_table[i], 0, NULL, &scalar_layout[i]);
+		D_ASSERT(rc == 0);
+	}
+	benchmark_stop(bench_hdl);
+	print_batch_result("place", test_entries, bench_hdl);
+
+	benchmark_start(bench_hdl);
+	for (i = 0; i < test_entries; i += batch_size) {
+		rc = pl_obj_place_batch(pl_map, 0, &obj_table[i], min(batch_size,
+					test_entries - i), 0, &batch_layout[i]);
+		D_ASSERT(rc == 0);
+	}
+	benchmark_stop(bench_hdl);
+	print_batch_result("place_batch", test_entries, bench_hdl);
+
+	for (i = 0; i < test_entries; i++) {
+		D_ASSERT(scalar_layout[i]->ol_nr == batch_layout[i]->ol_nr);
+		for (j = 0; j < scalar_layout[i]->ol_nr; j++)
+			D_ASSERT(scalar_layout[i]->ol_shards[j].po_target ==
+				 batch_layout[i]->ol_shards[j].po_target);
+		pl_obj_layout_free(scalar_layout[i]);
+		pl_obj_layout_free(batch_layout[i]);
+	}
+
+	/* Fail a target to have something to rebuild */
+	plt_fail_tgt(0, &ver, pool_map, false);
+
+	benchmark_start(bench_hdl);
+	for (i = 0; i < test_entries; i++)
+		scalar_nrs[i] = pl_obj_find_rebuild(pl_map, 0, &obj_table[i], NULL, ver,
+						    &scalar_tgts[i * BATCH_REBUILD_ARRAY_SIZE],
+						    &scalar_shards[i * BATCH_REBUILD_ARRAY_SIZE],
+						    BATCH_REBUILD_ARRAY_SIZE);
+	benchmark_stop(bench_hdl);
+	print_batch_result("find_rebuild", test_entries, bench_hdl);
+
+	benchmark_start(bench_hdl);
+	for (i = 0; i < test_entries; i += batch_size) {
+		rc = pl_obj_find_rebuild_batch(pl_map, 0, &obj_table[i],
+					       min(batch_size, test_entries - i), ver,
+					       &batch_tgts[i * BATCH_REBUILD_ARRAY_SIZE],
+					       &batch_shards[i * BATCH_REBUILD_ARRAY_SIZE],
+					       BATCH_REBUILD_ARRAY_SIZE, &batch_nrs[i]);
+		D_ASSERT(rc == 0);
+	}
+	benchmark_stop(bench_hdl);
+	print_batch_result("find_rebuild_batch", test_entries, bench_hdl);
+
+	for (i = 0; i < test_entries; i++) {
+		D_ASSERT(scalar_nrs[i] == batch_nrs[i]);
+		for (j = 0; j < scalar_nrs[i]; j++) {
+			D_ASSERT(scalar_tgts[i * BATCH_REBUILD_ARRAY_SIZE + j] ==
+				 batch_tgts[i * BATCH_REBUILD_ARRAY_SIZE + j]);
+			D_ASSERT(scalar_shards[i * BATCH_REBUILD_ARRAY_SIZE + j] ==
+				 batch_shards[i * BATCH_REBUILD_ARRAY_SIZE + j]);
+		}
+	}
+
+	free_pool_and_placement_map(pool_map, pl_map);
+	benchmark_free(bench_hdl);
+	D_FREE(obj_table);
+	D_FREE(scalar_layout);
+	D_FREE(batch_layout);
+	D_FREE(scalar_tgts);
+	D_FREE(scalar_shards);
+	D_FREE(batch_tgts);
+	D_FREE(batch_shards);
+	D_FREE(scalar_nrs);
+	D_FREE(batch_nrs);
+}
 
 int
 main(int argc, char **argv)
@@ -592,10 +790,12 @@ main(int argc, char **argv)
 	test_op_t op_fn[] = {
 		benchmark_placement,
 		benchmark_add_data_movement,
+		benchmark_batch,
 	};
 	const char *const op_names[] = {
 		"benchmark-placement",
 		"benchmark-add",
+		"benchmark-batch",
 	};
 	D_ASSERT(ARRAY_SIZE(op_fn) == ARRAY_SIZE(op_names));
 
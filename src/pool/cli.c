@@ -42,15 +42,15 @@ dc_pool_init(void)
 	int			rc;
 
 	dc_pool_proto_version = 0;
-	rc = daos_rpc_proto_query(pool_proto_fmt_v4.cpf_base, ver_array, 2, &dc_pool_proto_version);
+	rc = daos_rpc_proto_query(pool_proto_fmt_v5.cpf_base, ver_array, 2, &dc_pool_proto_version);
 	if (rc)
 		return rc;
 
 	if (dc_pool_proto_version == DAOS_POOL_VERSION - 1) {
-		rc = daos_rpc_register(&pool_proto_fmt_v4, POOL_PROTO_CLI_COUNT,
+		rc = daos_rpc_register(&pool_proto_fmt_v5, POOL_PROTO_CLI_COUNT,
 				       NULL, DAOS_POOL_MODULE);
 	} else if (dc_pool_proto_version == DAOS_POOL_VERSION) {
-		rc = daos_rpc_register(&pool_proto_fmt_v5, POOL_PROTO_CLI_COUNT, NULL,
+		rc = daos_rpc_register(&pool_proto_fmt_v6, POOL_PROTO_CLI_COUNT, NULL,
 				       DAOS_POOL_MODULE);
 	} else {
 		D_ERROR("%d version pool RPC not supported.\n", dc_pool_proto_version);
@@ -73,9 +73,9 @@ dc_pool_fini(void)
 	int rc;
 
 	if (dc_pool_proto_version == DAOS_POOL_VERSION - 1)
-		rc = daos_rpc_unregister(&pool_proto_fmt_v4);
-	else
 		rc = daos_rpc_unregister(&pool_proto_fmt_v5);
+	else
+		rc = daos_rpc_unregister(&pool_proto_fmt_v6);
 	if (rc != 0)
 		D_ERROR("failed to unregister pool RPCs: "DF_RC"\n", DP_RC(rc));
 }
@@ -1377,9 +1377,6 @@ pool_query_cb(tse_task_t *task, void *data)
 	d_rank_list_t		      **ranks_arg;
 	int				rc = task->dt_result;
 
-	/* NB: out_v4 and out_v5 share the same fields of v4, so it can use
-	 * v5 to refer v4 here.
-	 */
 	rc = pool_rsvc_client_complete_rpc(arg->dqa_pool, &arg->rpc->cr_ep, rc,
 					   &out_v5->pqo_op, task);
 	if (rc < 0)
@@ -1452,7 +1449,7 @@ dc_pool_query(tse_task_t *task)
 	struct dc_pool		       *pool;
 	crt_endpoint_t			ep;
 	crt_rpc_t		       *rpc;
-	struct pool_query_v4_in	       *in;
+	struct pool_query_v5_in	       *in;
 	struct pool_buf		       *map_buf;
 	struct pool_query_arg		query_args;
 	int				rc;
@@ -1575,6 +1572,8 @@ struct map_refresh_arg {
 	daos_handle_t		mra_pool_hdl;
 	bool			mra_passive;
 	bool			mra_fallen_back;
+	/* a map delta failed to apply, ask for full maps from now on */
+	bool			mra_no_delta;
 	unsigned int		mra_map_version;
 	int			mra_i;
 	int			mra_n;
@@ -1628,13 +1627,13 @@ choose_map_refresh_rank(struct map_refresh_arg *arg)
 }
 
 static int
-create_map_refresh_rpc(struct dc_pool *pool, unsigned int map_version,
+create_map_refresh_rpc(struct dc_pool *pool, unsigned int map_version, bool delta,
 		       crt_context_t ctx, crt_group_t *group, d_rank_t rank,
 		       crt_rpc_t **rpc, struct pool_buf **map_buf)
 {
 	crt_endpoint_t			ep;
 	crt_rpc_t		       *c;
-	struct pool_tgt_query_map_in   *in;
+	struct pool_tgt_query_map_v6_in	*in;
 	struct pool_buf		       *b;
 	int				rc;
 
@@ -1653,6 +1652,9 @@ create_map_refresh_rpc(struct dc_pool *pool, unsigned int map_version,
 	uuid_copy(in->tmi_op.pi_uuid, pool->dp_pool);
 	uuid_copy(in->tmi_op.pi_hdl, pool->dp_pool_hdl);
 	in->tmi_map_version = map_version;
+	/* v5 input has no tmi_flags, only full maps are sent */
+	if (delta && dc_pool_proto_version >= 6)
+		in->tmi_flags |= POOL_TGT_QUERY_MAP_DELTA;
 
 	rc = map_bulk_create(ctx, &in->tmi_map_bulk, &b, pool_buf_nr(pool->dp_map_sz));
 	if (rc != 0) {
@@ -1668,7 +1670,7 @@ create_map_refresh_rpc(struct dc_pool *pool, unsigned int map_version,
 static void
 destroy_map_refresh_rpc(crt_rpc_t *rpc, struct pool_buf *map_buf)
 {
-	struct pool_tgt_query_map_in *in = crt_req_get(rpc);
+	struct pool_tgt_query_map_v6_in *in = crt_req_get(rpc);
 
 	map_bulk_destroy(in->tmi_map_bulk, map_buf);
 	crt_req_decref(rpc);
@@ -1685,8 +1687,8 @@ map_refresh_cb(tse_task_t *task, void *varg)
 	struct map_refresh_cb_arg      *cb_arg = varg;
 	struct map_refresh_arg	       *arg = tse_task_buf_embedded(task, sizeof(*arg));
 	struct dc_pool		       *pool = arg->mra_pool;
-	struct pool_tgt_query_map_in   *in = crt_req_get(cb_arg->mrc_rpc);
-	struct pool_tgt_query_map_out  *out = crt_reply_get(cb_arg->mrc_rpc);
+	struct pool_tgt_query_map_v6_in	*in = crt_req_get(cb_arg->mrc_rpc);
+	struct pool_tgt_query_map_v6_out *out = crt_reply_get(cb_arg->mrc_rpc);
 	unsigned int			version_cached;
 	struct pool_map		       *map;
 	bool				reinit = false;
@@ -1773,11 +1775,26 @@ map_refresh_cb(tse_task_t *task, void *varg)
 		goto out;
 	}
 
-	rc = pool_map_create(cb_arg->mrc_map_buf, out->tmo_op.po_map_version, &map);
-	if (rc != 0) {
-		D_ERROR(DF_UUID": failed to create pool map: "DF_RC"\n",
-			DP_UUID(pool->dp_pool), DP_RC(rc));
-		goto out;
+	if (cb_arg->mrc_map_buf->pb_delta_base != 0) {
+		/* Only the changed components, based on the cached version. */
+		rc = pool_map_delta_apply(pool->dp_map, cb_arg->mrc_map_buf,
+					  out->tmo_op.po_map_version, &map);
+		if (rc != 0) {
+			D_DEBUG(DB_MD, DF_UUID": %p: failed to apply map delta %u->%u, "
+				"retry with the full map: "DF_RC"\n", DP_UUID(pool->dp_pool), task,
+				cb_arg->mrc_map_buf->pb_delta_base, out->tmo_op.po_map_version,
+				DP_RC(rc));
+			arg->mra_no_delta = true;
+			reinit = true;
+			goto out;
+		}
+	} else {
+		rc = pool_map_create(cb_arg->mrc_map_buf, out->tmo_op.po_map_version, &map);
+		if (rc != 0) {
+			D_ERROR(DF_UUID": failed to create pool map: "DF_RC"\n",
+				DP_UUID(pool->dp_pool), DP_RC(rc));
+			goto out;
+		}
 	}
 
 	rc = dc_pool_map_update(pool, map, false /* connect */);
@@ -1826,6 +1843,7 @@ map_refresh(tse_task_t *task)
 	struct dc_pool		       *pool = arg->mra_pool;
 	d_rank_t			rank;
 	unsigned int			version;
+	bool				delta;
 	crt_rpc_t		       *rpc;
 	struct map_refresh_cb_arg	cb_arg;
 	int				rc;
@@ -1951,11 +1969,13 @@ map_refresh(tse_task_t *task)
 	 * highest version known but also > the version cached.
 	 */
 	version = max(pool->dp_map_version_known - 1, pool_map_get_version(pool->dp_map));
+	/* A delta is only useful if it is based on the cached version. */
+	delta = !arg->mra_no_delta && version == pool_map_get_version(pool->dp_map);
 
 	D_RWLOCK_UNLOCK(&pool->dp_map_lock);
 
-	rc = create_map_refresh_rpc(pool, version, daos_task2ctx(task), pool->dp_sys->sy_group,
-				    rank, &rpc, &cb_arg.mrc_map_buf);
+	rc = create_map_refresh_rpc(pool, version, delta, daos_task2ctx(task),
+				    pool->dp_sys->sy_group, rank, &rpc, &cb_arg.mrc_map_buf);
 	if (rc != 0) {
 		D_ERROR(DF_UUID": failed to create pool refresh RPC: "DF_RC"\n",
 			DP_UUID(pool->dp_pool), DP_RC(rc));
@@ -2038,6 +2058,7 @@ dc_pool_create_map_refresh_task(daos_handle_t pool_hdl, uint32_t map_version, ts
 	a->mra_pool_hdl = pool_hdl;
 	a->mra_passive = false;
 	a->mra_fallen_back = false;
+	a->mra_no_delta = false;
 	a->mra_map_version = map_version;
 	a->mra_i = -1;
 	a->mra_n = 4;
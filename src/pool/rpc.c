@@ -81,11 +81,9 @@ crt_proc_struct_pool_op_out(crt_proc_t proc, crt_proc_op_t proc_op,
 }
 
 CRT_RPC_DEFINE(pool_create, DAOS_ISEQ_POOL_CREATE, DAOS_OSEQ_POOL_CREATE)
-CRT_RPC_DEFINE(pool_connect_v4, DAOS_ISEQ_POOL_CONNECT_V4, DAOS_OSEQ_POOL_CONNECT)
 CRT_RPC_DEFINE(pool_connect_v5, DAOS_ISEQ_POOL_CONNECT_V5, DAOS_OSEQ_POOL_CONNECT)
 CRT_RPC_DEFINE(pool_disconnect, DAOS_ISEQ_POOL_DISCONNECT,
 		DAOS_OSEQ_POOL_DISCONNECT)
-CRT_RPC_DEFINE(pool_query_v4, DAOS_ISEQ_POOL_QUERY, DAOS_OSEQ_POOL_QUERY_V4)
 CRT_RPC_DEFINE(pool_query_v5, DAOS_ISEQ_POOL_QUERY, DAOS_OSEQ_POOL_QUERY_V5)
 CRT_RPC_DEFINE(pool_attr_list, DAOS_ISEQ_POOL_ATTR_LIST,
 		DAOS_OSEQ_POOL_ATTR_LIST)
@@ -207,7 +205,10 @@ crt_proc_daos_pool_cont_filter_t(crt_proc_t proc, crt_proc_op_t proc_op,
 
 CRT_RPC_DEFINE(pool_filter_cont, DAOS_ISEQ_POOL_FILTER_CONT, DAOS_OSEQ_POOL_FILTER_CONT)
 CRT_RPC_DEFINE(pool_query_info, DAOS_ISEQ_POOL_QUERY_INFO, DAOS_OSEQ_POOL_QUERY_INFO)
-CRT_RPC_DEFINE(pool_tgt_query_map, DAOS_ISEQ_POOL_TGT_QUERY_MAP, DAOS_OSEQ_POOL_TGT_QUERY_MAP)
+CRT_RPC_DEFINE(pool_tgt_query_map_v5, DAOS_ISEQ_POOL_TGT_QUERY_MAP_V5,
+	       DAOS_OSEQ_POOL_TGT_QUERY_MAP)
+CRT_RPC_DEFINE(pool_tgt_query_map_v6, DAOS_ISEQ_POOL_TGT_QUERY_MAP_V6,
+	       DAOS_OSEQ_POOL_TGT_QUERY_MAP)
 CRT_RPC_DEFINE(pool_tgt_discard, DAOS_ISEQ_POOL_TGT_DISCARD, DAOS_OSEQ_POOL_TGT_DISCARD)
 
 /* Define for cont_rpcs[] array population below.
@@ -221,26 +222,18 @@ CRT_RPC_DEFINE(pool_tgt_discard, DAOS_ISEQ_POOL_TGT_DISCARD, DAOS_OSEQ_POOL_TGT_
 	.prf_co_ops  = NULL,	\
 },
 
-static struct crt_proto_rpc_format pool_proto_rpc_fmt_v4[] = {
-	POOL_PROTO_CLI_RPC_LIST(4)
+static struct crt_proto_rpc_format pool_proto_rpc_fmt_v5[] = {
+	POOL_PROTO_CLI_RPC_LIST(5)
 	POOL_PROTO_SRV_RPC_LIST
 };
 
-static struct crt_proto_rpc_format pool_proto_rpc_fmt_v5[] = {
-	POOL_PROTO_CLI_RPC_LIST(5)
+static struct crt_proto_rpc_format pool_proto_rpc_fmt_v6[] = {
+	POOL_PROTO_CLI_RPC_LIST(6)
 	POOL_PROTO_SRV_RPC_LIST
 };
 
 #undef X
 
-struct crt_proto_format pool_proto_fmt_v4 = {
-	.cpf_name  = "pool",
-	.cpf_ver   = 4,
-	.cpf_count = ARRAY_SIZE(pool_proto_rpc_fmt_v4),
-	.cpf_prf   = pool_proto_rpc_fmt_v4,
-	.cpf_base  = DAOS_RPC_OPCODE(0, DAOS_POOL_MODULE, 0)
-};
-
 struct crt_proto_format pool_proto_fmt_v5 = {
 	.cpf_name  = "pool",
 	.cpf_ver   = 5,
@@ -249,6 +242,14 @@ struct crt_proto_format pool_proto_fmt_v5 = {
 	.cpf_base  = DAOS_RPC_OPCODE(0, DAOS_POOL_MODULE, 0)
 };
 
+struct crt_proto_format pool_proto_fmt_v6 = {
+	.cpf_name  = "pool",
+	.cpf_ver   = 6,
+	.cpf_count = ARRAY_SIZE(pool_proto_rpc_fmt_v6),
+	.cpf_prf   = pool_proto_rpc_fmt_v6,
+	.cpf_base  = DAOS_RPC_OPCODE(0, DAOS_POOL_MODULE, 0)
+};
+
 uint64_t
 pool_query_bits(daos_pool_info_t *po_info, daos_prop_t *prop)
 {
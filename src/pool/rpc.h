@@ -28,7 +28,7 @@
  * These are for daos_rpc::dr_opc and DAOS_RPC_OPCODE(opc, ...) rather than
  * crt_req_create(..., opc, ...). See src/include/daos/rpc.h.
  */
-#define DAOS_POOL_VERSION 5
+#define DAOS_POOL_VERSION 6
 /* LIST of internal RPCS in form of:
  * OPCODE, flags, FMT, handler, corpc_hdlr,
  */
@@ -37,17 +37,14 @@
 		0, &CQF_pool_create,					\
 		ds_pool_create_handler, NULL)				\
 	X(POOL_CONNECT,							\
-	  0, ver == 4 ? &CQF_pool_connect_v4 : &CQF_pool_connect_v5,	\
-	  ver == 4 ? ds_pool_connect_handler_v4 :			\
-	  ds_pool_connect_handler_v5, NULL)				\
+		0, &CQF_pool_connect_v5,				\
+		ds_pool_connect_handler_v5, NULL)			\
 	X(POOL_DISCONNECT,						\
 		0, &CQF_pool_disconnect,				\
 		ds_pool_disconnect_handler, NULL)			\
 	X(POOL_QUERY,							\
-	  0, ver == 4 ? &CQF_pool_query_v4 : &CQF_pool_query_v5,	\
-	  ver == 4 ? ds_pool_query_handler_v4 :				\
-			ds_pool_query_handler_v5,			\
-	  NULL)								\
+		0, &CQF_pool_query_v5,					\
+		ds_pool_query_handler_v5, NULL)				\
 	X(POOL_QUERY_INFO,						\
 		0, &CQF_pool_query_info,				\
 		ds_pool_query_info_handler, NULL)			\
@@ -97,8 +94,10 @@
 		0, &CQF_pool_list_cont,					\
 		ds_pool_list_cont_handler, NULL)			\
 	X(POOL_TGT_QUERY_MAP,						\
-		0, &CQF_pool_tgt_query_map,				\
-		ds_pool_tgt_query_map_handler, NULL)			\
+	  0, ver == 5 ? &CQF_pool_tgt_query_map_v5 :			\
+	  &CQF_pool_tgt_query_map_v6,					\
+	  ver == 5 ? ds_pool_tgt_query_map_handler_v5 :		\
+	  ds_pool_tgt_query_map_handler_v6, NULL)			\
 	X(POOL_FILTER_CONT,						\
 		0, &CQF_pool_filter_cont,				\
 		ds_pool_filter_cont_handler, NULL)
@@ -162,8 +161,8 @@ enum pool_operation {
 
 char *dc_pool_op_str(enum pool_operation op);
 
-extern struct crt_proto_format pool_proto_fmt_v4;
 extern struct crt_proto_format pool_proto_fmt_v5;
+extern struct crt_proto_format pool_proto_fmt_v6;
 extern int dc_pool_proto_version;
 
 #define DAOS_ISEQ_POOL_OP	/* input fields */		 \
@@ -190,13 +189,6 @@ CRT_RPC_DECLARE(pool_op, DAOS_ISEQ_POOL_OP, DAOS_OSEQ_POOL_OP)
 
 CRT_RPC_DECLARE(pool_create, DAOS_ISEQ_POOL_CREATE, DAOS_OSEQ_POOL_CREATE)
 
-#define DAOS_ISEQ_POOL_CONNECT_V4 /* input fields */		 \
-	((struct pool_op_in)	(pci_op)		CRT_VAR) \
-	((d_iov_t)		(pci_cred)		CRT_VAR) \
-	((uint64_t)		(pci_flags)		CRT_VAR) \
-	((uint64_t)		(pci_query_bits)	CRT_VAR) \
-	((crt_bulk_t)		(pci_map_bulk)		CRT_VAR)
-
 #define DAOS_OSEQ_POOL_CONNECT	/* output fields */		 \
 	((struct pool_op_out)	(pco_op)		CRT_VAR) \
 	((struct daos_pool_space) (pco_space)		CRT_RAW) \
@@ -204,8 +196,6 @@ CRT_RPC_DECLARE(pool_create, DAOS_ISEQ_POOL_CREATE, DAOS_OSEQ_POOL_CREATE)
 	/* only set on -DER_TRUNC */				 \
 	((uint32_t)		(pco_map_buf_size)	CRT_VAR)
 
-CRT_RPC_DECLARE(pool_connect_v4, DAOS_ISEQ_POOL_CONNECT_V4, DAOS_OSEQ_POOL_CONNECT)
-
 #define DAOS_ISEQ_POOL_CONNECT_V5 /* input fields */		 \
 	((struct pool_op_in)	(pci_op)		CRT_VAR) \
 	((d_iov_t)		(pci_cred)		CRT_VAR) \
@@ -230,16 +220,6 @@ CRT_RPC_DECLARE(pool_disconnect, DAOS_ISEQ_POOL_DISCONNECT,
 	((crt_bulk_t)		(pqi_map_bulk)		CRT_VAR) \
 	((uint64_t)		(pqi_query_bits)	CRT_VAR)
 
-#define DAOS_OSEQ_POOL_QUERY_V4	/* output fields */		 \
-	((struct pool_op_out)	(pqo_op)		CRT_VAR) \
-	((daos_prop_t)		(pqo_prop)		CRT_PTR) \
-	((struct daos_pool_space) (pqo_space)		CRT_RAW) \
-	((struct daos_rebuild_status) (pqo_rebuild_st)	CRT_RAW) \
-	/* only set on -DER_TRUNC */				 \
-	((uint32_t)		(pqo_map_buf_size)	CRT_VAR) \
-
-CRT_RPC_DECLARE(pool_query_v4, DAOS_ISEQ_POOL_QUERY, DAOS_OSEQ_POOL_QUERY_V4)
-
 #define DAOS_OSEQ_POOL_QUERY_V5	/* output fields */		 \
 	((struct pool_op_out)	(pqo_op)		CRT_VAR) \
 	((daos_prop_t)		(pqo_prop)		CRT_PTR) \
@@ -484,17 +464,28 @@ CRT_RPC_DECLARE(pool_ranks_get, DAOS_ISEQ_POOL_RANKS_GET,
 
 CRT_RPC_DECLARE(pool_upgrade, DAOS_ISEQ_POOL_UPGRADE, DAOS_OSEQ_POOL_UPGRADE)
 
-#define DAOS_ISEQ_POOL_TGT_QUERY_MAP	/* input fields */	 \
+#define DAOS_ISEQ_POOL_TGT_QUERY_MAP_V5 /* input fields */	 \
 	((struct pool_op_in)	(tmi_op)		CRT_VAR) \
 	((crt_bulk_t)		(tmi_map_bulk)		CRT_VAR) \
 	((uint32_t)		(tmi_map_version)	CRT_VAR)
 
+#define DAOS_ISEQ_POOL_TGT_QUERY_MAP_V6 /* input fields */	 \
+	((struct pool_op_in)	(tmi_op)		CRT_VAR) \
+	((crt_bulk_t)		(tmi_map_bulk)		CRT_VAR) \
+	((uint32_t)		(tmi_map_version)	CRT_VAR) \
+	((uint32_t)		(tmi_flags)		CRT_VAR)
+
+/** tmi_flags: the client can apply a delta based on tmi_map_version */
+#define POOL_TGT_QUERY_MAP_DELTA	(1U << 0)
+
 #define DAOS_OSEQ_POOL_TGT_QUERY_MAP	/* output fields */	 \
 	((struct pool_op_out)	(tmo_op)		CRT_VAR) \
 	/* only set on -DER_TRUNC */				 \
 	((uint32_t)		(tmo_map_buf_size)	CRT_VAR)
 
-CRT_RPC_DECLARE(pool_tgt_query_map, DAOS_ISEQ_POOL_TGT_QUERY_MAP,
+CRT_RPC_DECLARE(pool_tgt_query_map_v5, DAOS_ISEQ_POOL_TGT_QUERY_MAP_V5,
+		DAOS_OSEQ_POOL_TGT_QUERY_MAP)
+CRT_RPC_DECLARE(pool_tgt_query_map_v6, DAOS_ISEQ_POOL_TGT_QUERY_MAP_V6,
 		DAOS_OSEQ_POOL_TGT_QUERY_MAP)
 
 #define DAOS_ISEQ_POOL_TGT_DISCARD /* input fields */		 \
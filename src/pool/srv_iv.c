@@ -1109,6 +1109,13 @@ pool_iv_pre_sync(struct ds_iv_entry *entry, struct ds_iv_key *key,
 	return rc;
 }
 
+/* Only lease the properties, the handles may be invalidated locally */
+static uint32_t
+pool_iv_ent_lease(struct ds_iv_entry *entry, struct ds_iv_key *key)
+{
+	return key->class_id == IV_POOL_PROP ? DS_IV_LEASE_DEF : 0;
+}
+
 struct ds_iv_class_ops pool_iv_ops = {
 	.ivc_ent_init		= pool_iv_ent_init,
 	.ivc_ent_get		= pool_iv_ent_get,
@@ -1118,7 +1125,8 @@ struct ds_iv_class_ops pool_iv_ops = {
 	.ivc_ent_update		= pool_iv_ent_update,
 	.ivc_ent_refresh	= pool_iv_ent_refresh,
 	.ivc_value_alloc	= pool_iv_value_alloc,
-	.ivc_pre_sync		= pool_iv_pre_sync
+	.ivc_pre_sync		= pool_iv_pre_sync,
+	.ivc_ent_lease		= pool_iv_ent_lease,
 };
 
 static int
@@ -2752,10 +2752,10 @@ bulk_cb(const struct crt_bulk_cb_info *cb_info)
 /* Currently we only maintain compatibility between 2 versions */
 #define NUM_POOL_VERSIONS	2
 
-static void
-ds_pool_connect_handler(crt_rpc_t *rpc, int handler_version)
+void
+ds_pool_connect_handler_v5(crt_rpc_t *rpc)
 {
-	struct pool_connect_v4_in      *in = crt_req_get(rpc);
+	struct pool_connect_v5_in      *in = crt_req_get(rpc);
 	struct pool_connect_v5_out     *out = crt_reply_get(rpc);
 	struct pool_svc		       *svc;
 	struct pool_buf		       *map_buf = NULL;
@@ -2781,6 +2781,7 @@ ds_pool_connect_handler(crt_rpc_t *rpc, int handler_version)
 	struct pool_metrics	       *metrics;
 	char			       *machine = NULL;
 	bool				transfer_map = false;
+	int				diff;
 
 	D_DEBUG(DB_MD, DF_UUID ": processing rpc: %p hdl=" DF_UUID "\n",
 		DP_UUID(in->pci_op.pi_uuid), rpc, DP_UUID(in->pci_op.pi_hdl));
@@ -2856,50 +2857,38 @@ ds_pool_connect_handler(crt_rpc_t *rpc, int handler_version)
 	/*
 	 * Reject pool connection if old clients try to connect new format pool.
 	 */
-	if (handler_version >= 5) {
-		struct pool_connect_v5_in *in1 = (struct pool_connect_v5_in *)in;
-		int diff = DAOS_POOL_GLOBAL_VERSION - in1->pci_pool_version;
-
-		if (in1->pci_pool_version <= DAOS_POOL_GLOBAL_VERSION) {
-			if (diff >= NUM_POOL_VERSIONS) {
-				D_ERROR(DF_UUID": cannot connect, client supported pool "
-					"layout version (%u) is more than %u versions smaller "
-					"than server supported pool layout version(%u), "
-					"try to upgrade client firstly.\n",
-					DP_UUID(in->pci_op.pi_uuid), in1->pci_pool_version,
-					NUM_POOL_VERSIONS - 1, DAOS_POOL_GLOBAL_VERSION);
-				D_GOTO(out_map_version, rc = -DER_NOTSUPPORTED);
-			}
+	diff = DAOS_POOL_GLOBAL_VERSION - in->pci_pool_version;
+	if (in->pci_pool_version <= DAOS_POOL_GLOBAL_VERSION) {
+		if (diff >= NUM_POOL_VERSIONS) {
+			D_ERROR(DF_UUID": cannot connect, client supported pool "
+				"layout version (%u) is more than %u versions smaller "
+				"than server supported pool layout version(%u), "
+				"try to upgrade client firstly.\n",
+				DP_UUID(in->pci_op.pi_uuid), in->pci_pool_version,
+				NUM_POOL_VERSIONS - 1, DAOS_POOL_GLOBAL_VERSION);
+			D_GOTO(out_map_version, rc = -DER_NOTSUPPORTED);
+		}
 
-			if (global_ver > in1->pci_pool_version) {
-				D_ERROR(DF_UUID": cannot connect, pool layout version(%u) > "
-					"max client supported pool layout version(%u), "
-					"try to upgrade client firstly.\n",
-					DP_UUID(in->pci_op.pi_uuid), global_ver,
-					in1->pci_pool_version);
-				D_GOTO(out_map_version, rc = -DER_NOTSUPPORTED);
-			}
-		} else {
-			diff = -diff;
-			if (diff >= NUM_POOL_VERSIONS) {
-				D_ERROR(DF_UUID": cannot connect, client supported pool "
-					"layout version (%u) is more than %u versions "
-					"larger than server supported pool layout version(%u), "
-					"try to upgrade server firstly.\n",
-					DP_UUID(in->pci_op.pi_uuid), in1->pci_pool_version,
-					NUM_POOL_VERSIONS - 1, DAOS_POOL_GLOBAL_VERSION);
-				D_GOTO(out_map_version, rc = -DER_NOTSUPPORTED);
-			}
-			/* New clients should be able to access old pools without problem */
+		if (global_ver > in->pci_pool_version) {
+			D_ERROR(DF_UUID": cannot connect, pool layout version(%u) > "
+				"max client supported pool layout version(%u), "
+				"try to upgrade client firstly.\n",
+				DP_UUID(in->pci_op.pi_uuid), global_ver,
+				in->pci_pool_version);
+			D_GOTO(out_map_version, rc = -DER_NOTSUPPORTED);
 		}
 	} else {
-		/* Assuming 2.0 client */
-		if (global_ver > 1) {
-			D_ERROR(DF_UUID": cannot connect, 2.0 clients unable to access pool format "
-				"version > 1, try to upgrade client firstly.\n",
-				DP_UUID(in->pci_op.pi_uuid));
+		diff = -diff;
+		if (diff >= NUM_POOL_VERSIONS) {
+			D_ERROR(DF_UUID": cannot connect, client supported pool "
+				"layout version (%u) is more than %u versions "
+				"larger than server supported pool layout version(%u), "
+				"try to upgrade server firstly.\n",
+				DP_UUID(in->pci_op.pi_uuid), in->pci_pool_version,
+				NUM_POOL_VERSIONS - 1, DAOS_POOL_GLOBAL_VERSION);
 			D_GOTO(out_map_version, rc = -DER_NOTSUPPORTED);
 		}
+		/* New clients should be able to access old pools without problem */
 	}
 
 	acl_entry = daos_prop_entry_get(prop, DAOS_PROP_PO_ACL);
@@ -3065,18 +3054,6 @@ out:
 	crt_reply_send(rpc);
 }
 
-void
-ds_pool_connect_handler_v4(crt_rpc_t *rpc)
-{
-	ds_pool_connect_handler(rpc, 4);
-}
-
-void
-ds_pool_connect_handler_v5(crt_rpc_t *rpc)
-{
-	ds_pool_connect_handler(rpc, 5);
-}
-
 static int
 pool_disconnect_bcast(crt_context_t ctx, struct pool_svc *svc,
 		      uuid_t *pool_hdls, int n_pool_hdls)
@@ -3914,12 +3891,6 @@ out:
 		daos_prop_free(prop);
 }
 
-void
-ds_pool_query_handler_v4(crt_rpc_t *rpc)
-{
-	ds_pool_query_handler(rpc, 4);
-}
-
 void
 ds_pool_query_handler_v5(crt_rpc_t *rpc)
 {
@@ -480,6 +480,7 @@ pool_alloc_ref(void *key, unsigned int ksize, void *varg,
 		D_GOTO(err_cond, rc = dss_abterr2der(rc));
 
 	D_INIT_LIST_HEAD(&pool->sp_ec_ephs_list);
+	pool_map_hist_init(&pool->sp_map_hist);
 	uuid_copy(pool->sp_uuid, key);
 	pool->sp_map_version = arg->pca_map_version;
 	pool->sp_reclaim = DAOS_RECLAIM_LAZY; /* default reclaim strategy */
@@ -563,6 +564,7 @@ pool_free_ref(struct daos_llink *llink)
 			DP_UUID(pool->sp_uuid), DP_RC(rc));
 
 	pl_map_disconnect(pool->sp_uuid);
+	pool_map_hist_fini(&pool->sp_map_hist);
 	if (pool->sp_map != NULL)
 		pool_map_decref(pool->sp_map);
 
@@ -1364,6 +1366,78 @@ ds_pool_tgt_disconnect_aggregator(crt_rpc_t *source, crt_rpc_t *result,
 	return 0;
 }
 
+static void
+pool_group_domains_fill(struct pool_domain *dom, uint32_t lvl, uint32_t levels,
+			uint32_t *path, d_rank_list_t *ranks, uint32_t *domains)
+{
+	struct pool_domain	*child;
+	uint32_t		 i;
+
+	for (i = 0; i < dom->do_child_nr; i++) {
+		child = &dom->do_children[i];
+		if (child->do_comp.co_type == PO_COMP_TP_RANK) {
+			ranks->rl_ranks[ranks->rl_nr] = child->do_comp.co_rank;
+			memcpy(&domains[ranks->rl_nr * levels], path, sizeof(*path) * levels);
+			ranks->rl_nr++;
+			continue;
+		}
+
+		D_ASSERT(lvl < levels);
+		path[lvl] = child->do_comp.co_id;
+		pool_group_domains_fill(child, lvl + 1, levels, path, ranks, domains);
+	}
+}
+
+/*
+ * Export the fault domains of the ranks in the pool map to the pool group, then
+ * the collective RPCs over the pool group (CRT_TREE_DOMAIN) can keep the inner
+ * levels of the tree within the same node and the same fault domain.
+ */
+static int
+update_pool_group_domains(struct ds_pool *pool, struct pool_map *map)
+{
+	struct pool_domain	*root;
+	struct pool_domain	*dom;
+	d_rank_list_t		*ranks = NULL;
+	uint32_t		*domains = NULL;
+	uint32_t		*path = NULL;
+	uint32_t		 levels = 0;
+	int			 nr;
+	int			 rc;
+
+	nr = pool_map_find_domain(map, PO_COMP_TP_ROOT, PO_COMP_ID_ALL, &root);
+	if (nr <= 0)
+		return 0;
+
+	for (dom = root->do_children; dom != NULL && dom->do_comp.co_type != PO_COMP_TP_RANK;
+	     dom = dom->do_children)
+		levels++;
+
+	nr = pool_map_find_domain(map, PO_COMP_TP_RANK, PO_COMP_ID_ALL, NULL);
+	if (levels == 0 || nr <= 0)
+		return crt_group_domains_set(pool->sp_group, NULL, NULL, 0,
+					     pool_map_get_version(map));
+
+	ranks = d_rank_list_alloc(nr);
+	D_ALLOC_ARRAY(domains, nr * levels);
+	D_ALLOC_ARRAY(path, levels);
+	if (ranks == NULL || domains == NULL || path == NULL)
+		D_GOTO(out, rc = -DER_NOMEM);
+
+	ranks->rl_nr = 0;
+	pool_group_domains_fill(root, 0, levels, path, ranks, domains);
+	D_ASSERT(ranks->rl_nr == nr);
+
+	rc = crt_group_domains_set(pool->sp_group, ranks, domains, levels,
+				   pool_map_get_version(map));
+
+out:
+	d_rank_list_free(ranks);
+	D_FREE(domains);
+	D_FREE(path);
+	return rc;
+}
+
 static int
 update_pool_group(struct ds_pool *pool, struct pool_map *map)
 {
@@ -1376,6 +1450,20 @@ update_pool_group(struct ds_pool *pool, struct pool_map *map)
 	D_DEBUG(DB_MD, DF_UUID": %u -> %u\n", DP_UUID(pool->sp_uuid), version,
 		pool_map_get_version(map));
 
+	/*
+	 * Stage the domains for the new version before switching the group to
+	 * it. If that fails, keep the old version, otherwise this rank would
+	 * build the k-nomial tree for the new version while the others build
+	 * the domain tree. The corpc of the new version is rejected here until
+	 * the next successful update.
+	 */
+	rc = update_pool_group_domains(pool, map);
+	if (rc != 0) {
+		D_ERROR(DF_UUID": failed to update group domains: "DF_RC"\n",
+			DP_UUID(pool->sp_uuid), DP_RC(rc));
+		return rc;
+	}
+
 	rc = map_ranks_init(map, POOL_GROUP_MAP_STATUS, &ranks);
 	if (rc != 0)
 		return rc;
@@ -1469,6 +1557,15 @@ ds_pool_tgt_map_update(struct ds_pool *pool, struct pool_buf *buf,
 			D_GOTO(out, rc);
 		}
 
+		if (tmp != NULL) {
+			rc = pool_map_hist_add(&pool->sp_map_hist, tmp, map);
+			if (rc != 0) {
+				D_WARN(DF_UUID": failed to record pool map delta: "DF_RC"\n",
+				       DP_UUID(pool->sp_uuid), DP_RC(rc));
+				rc = 0;
+			}
+		}
+
 		update_map = true;
 		/* drop the stale map */
 		pool->sp_map = map;
@@ -1586,14 +1683,17 @@ update_vos_prop_on_targets(void *in)
 		goto out;
 
 	/** If necessary, upgrade the vos pool format */
-	if (pool->sp_global_version >= 3) {
+	if (pool->sp_global_version >= 4) {
+		D_DEBUG(DB_MGMT, "Upgrading durable format to 2.8 df=%d\n", VOS_POOL_DF_2_8);
+		ret = vos_pool_upgrade(child->spc_hdl, VOS_POOL_DF_2_8);
+	} else if (pool->sp_global_version == 3) {
 		D_DEBUG(DB_MGMT, "Upgrading durable format to 2.6 df=%d\n", VOS_POOL_DF_2_6);
 		ret = vos_pool_upgrade(child->spc_hdl, VOS_POOL_DF_2_6);
 	} else if (pool->sp_global_version == 2) {
 		D_DEBUG(DB_MGMT, "Upgrading durable format to 2.4 df=%d\n", VOS_POOL_DF_2_4);
 		ret = vos_pool_upgrade(child->spc_hdl, VOS_POOL_DF_2_4);
 	} else {
-		D_ERROR("2.2 or earlier pool can't be upgraded to 2.6\n");
+		D_ERROR("2.2 or earlier pool can't be upgraded to 2.8\n");
 		D_GOTO(out, ret = -DER_NO_PERM);
 	}
 
@@ -1668,11 +1768,11 @@ ds_pool_tgt_prop_update(struct ds_pool *pool, struct pool_iv_prop *iv_prop)
  * Query the cached pool map. If the cached version is <= in->tmi_map_version,
  * the pool map will not be transferred to the client.
  */
-void
-ds_pool_tgt_query_map_handler(crt_rpc_t *rpc)
+static void
+ds_pool_tgt_query_map_handler(crt_rpc_t *rpc, int handler_version)
 {
-	struct pool_tgt_query_map_in   *in = crt_req_get(rpc);
-	struct pool_tgt_query_map_out  *out = crt_reply_get(rpc);
+	struct pool_tgt_query_map_v6_in	*in = crt_req_get(rpc);
+	struct pool_tgt_query_map_v6_out *out = crt_reply_get(rpc);
 	struct ds_pool		       *pool;
 	struct pool_buf		       *buf;
 	unsigned int			version;
@@ -1731,11 +1831,23 @@ ds_pool_tgt_query_map_handler(crt_rpc_t *rpc)
 		ABT_rwlock_unlock(pool->sp_lock);
 		goto out_version;
 	}
-	rc = pool_buf_extract(pool->sp_map, &buf);
+	/*
+	 * Only send the changed components if the client can apply them, v5
+	 * input has no tmi_flags.
+	 */
+	rc = -DER_NONEXIST;
+	if (handler_version >= 6 && (in->tmi_flags & POOL_TGT_QUERY_MAP_DELTA))
+		rc = pool_map_hist_extract(&pool->sp_map_hist, pool->sp_map,
+					   in->tmi_map_version, &buf);
+	if (rc != 0)
+		rc = pool_buf_extract(pool->sp_map, &buf);
 	ABT_rwlock_unlock(pool->sp_lock);
 	if (rc != 0)
 		goto out_version;
 
+	D_DEBUG(DB_MD, DF_UUID": sending %s map %u->%u, %u components\n",
+		DP_UUID(in->tmi_op.pi_uuid), buf->pb_delta_base != 0 ? "delta" : "full",
+		in->tmi_map_version, version, buf->pb_nr);
 	rc = ds_pool_transfer_map_buf(buf, version, rpc, in->tmi_map_bulk,
 				      &out->tmo_map_buf_size);
 
@@ -1751,6 +1863,18 @@ out:
 	crt_reply_send(rpc);
 }
 
+void
+ds_pool_tgt_query_map_handler_v5(crt_rpc_t *rpc)
+{
+	ds_pool_tgt_query_map_handler(rpc, 5);
+}
+
+void
+ds_pool_tgt_query_map_handler_v6(crt_rpc_t *rpc)
+{
+	ds_pool_tgt_query_map_handler(rpc, 6);
+}
+
 struct tgt_discard_arg {
 	uuid_t			     pool_uuid;
 	uint64_t		     epoch;
@@ -18,8 +18,8 @@
 #include "rdb_layout.h"
 
 static int rdb_open_internal(daos_handle_t pool, daos_handle_t mc, const uuid_t uuid,
-			     uint64_t caller_term, struct rdb_cbs *cbs, void *arg,
-			     struct rdb **dbp);
+			     uint32_t version, uint64_t caller_term, struct rdb_cbs *cbs,
+			     void *arg, struct rdb **dbp);
 static int
 rdb_chkptd_start(struct rdb *db);
 static void
@@ -93,7 +93,7 @@ rdb_create(const char *path, const uuid_t uuid, uint64_t caller_term, size_t siz
 	if (rc != 0)
 		goto out_mc_hdl;
 
-	rc = rdb_open_internal(pool, mc, uuid, caller_term, cbs, arg, &db);
+	rc = rdb_open_internal(pool, mc, uuid, version, caller_term, cbs, arg, &db);
 	if (rc != 0)
 		goto out_mc_hdl;
 
@@ -233,8 +233,8 @@ rdb_lookup(const uuid_t uuid)
  * the caller shall not close in this case.
  */
 static int
-rdb_open_internal(daos_handle_t pool, daos_handle_t mc, const uuid_t uuid, uint64_t caller_term,
-		  struct rdb_cbs *cbs, void *arg, struct rdb **dbp)
+rdb_open_internal(daos_handle_t pool, daos_handle_t mc, const uuid_t uuid, uint32_t version,
+		  uint64_t caller_term, struct rdb_cbs *cbs, void *arg, struct rdb **dbp)
 {
 	struct rdb	       *db;
 	int			rc;
@@ -257,6 +257,7 @@ rdb_open_internal(daos_handle_t pool, daos_handle_t mc, const uuid_t uuid, uint6
 	db->d_arg = arg;
 	db->d_pool = pool;
 	db->d_mc = mc;
+	db->d_version = version;
 
 	rc = ABT_mutex_create(&db->d_mutex);
 	if (rc != ABT_SUCCESS) {
@@ -448,11 +449,11 @@ rdb_open(const char *path, const uuid_t uuid, uint64_t caller_term, struct rdb_c
 		goto err_mc;
 	}
 
-	rc = rdb_open_internal(pool, mc, uuid, caller_term, cbs, arg, &db);
+	rc = rdb_open_internal(pool, mc, uuid, version, caller_term, cbs, arg, &db);
 	if (rc != 0)
 		goto err_mc;
 
-	D_DEBUG(DB_MD, DF_DB": opened db %s %p\n", DP_DB(db), path, db);
+	D_DEBUG(DB_MD, DF_DB": opened db %s %p: version %u\n", DP_DB(db), path, db, version);
 	*storagep = rdb_to_storage(db);
 	return 0;
 
@@ -69,7 +69,8 @@ struct rdb_chkpt_record {
  *  d_mutex: for RPC mgmt and ref count:
  *    d_requests, d_replies/cv, d_ref/cv
  *  d_raft_mutex: for raft state
- *    d_lc_record, d_applied/cv, d_events[]/cv, d_nevents, d_compact_cv
+ *    d_lc_record, d_applied/cv, d_events[]/cv, d_nevents, d_compact_cv,
+ *    d_tx_queue
  *
  * TODO: locking for d_stop
  */
@@ -122,6 +123,9 @@ struct rdb {
 	ABT_thread		d_compactd;
 	size_t			d_ae_max_size;
 	unsigned int		d_ae_max_entries;
+	uint32_t		d_version;	/* layout version (see rdb_layout.h) */
+	d_list_t		d_tx_queue;	/* TXs waiting to be appended */
+	unsigned int		d_tx_pipeline;	/* max entries not applied yet */
 };
 
 /* thresholds of free space for a leader to avoid appending new log entries (512 KiB)
@@ -191,6 +195,8 @@ int rdb_raft_add_replica(struct rdb *db, d_rank_t rank);
 int rdb_raft_remove_replica(struct rdb *db, d_rank_t rank);
 int rdb_raft_append_apply(struct rdb *db, void *entry, size_t size,
 			  void *result);
+int rdb_raft_append(struct rdb *db, void *entry, size_t size, void *result,
+		    uint64_t *index, uint64_t *term);
 int rdb_raft_wait_applied(struct rdb *db, uint64_t index, uint64_t term);
 int rdb_raft_get_ranks(struct rdb *db, d_rank_list_t **ranksp);
 void rdb_requestvote_handler(crt_rpc_t *rpc);
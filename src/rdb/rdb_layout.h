@@ -71,12 +71,22 @@
 #ifndef RDB_LAYOUT_H
 #define RDB_LAYOUT_H
 
+/*
+ * Layout versions:
+ *
+ *   1	Initial layout
+ *   2	Log entries may hold batches of TXs (RDB_TX_HDR_BATCH, see rdb_tx.c)
+ */
+
 /* Default layout version */
-#define RDB_LAYOUT_VERSION 1
+#define RDB_LAYOUT_VERSION 2
 
 /* Lowest compatible layout version */
 #define RDB_LAYOUT_VERSION_LOW 1
 
+/* Lowest layout version whose log may hold batch entries */
+#define RDB_LAYOUT_VERSION_BATCH 2
+
 /*
  * Object ID
  *
@@ -1960,12 +1960,15 @@ rdb_raft_unregister_result(struct rdb *db, uint64_t index)
 	D_FREE(result);
 }
 
-/* Append and wait for \a entry to be applied. Caller must hold d_raft_mutex. */
+/*
+ * Append \a entry without waiting for it to be applied. The entry is offered
+ * to the log, hence \a result is filled, before this function returns. Caller
+ * must hold d_raft_mutex.
+ */
 static int
-rdb_raft_append_apply_internal(struct rdb *db, msg_entry_t *mentry,
-			       void *result)
+rdb_raft_append_internal(struct rdb *db, msg_entry_t *mentry, void *result,
+			 msg_entry_response_t *mresponse)
 {
-	msg_entry_response_t	mresponse;
 	struct rdb_raft_state	state;
 	uint64_t		index;
 	int			rc;
@@ -1978,7 +1981,7 @@ rdb_raft_append_apply_internal(struct rdb *db, msg_entry_t *mentry,
 	}
 
 	rdb_raft_save_state(db, &state);
-	rc = raft_recv_entry(db->d_raft, mentry, &mresponse);
+	rc = raft_recv_entry(db->d_raft, mentry, mresponse);
 	rc = rdb_raft_check_state(db, &state, rc);
 	if (rc != 0) {
 		if (rc != -DER_NOTLEADER)
@@ -1988,10 +1991,8 @@ rdb_raft_append_apply_internal(struct rdb *db, msg_entry_t *mentry,
 	}
 
 	/* The actual index must match the expected index. */
-	D_ASSERTF(mresponse.idx == index, "%ld == "DF_U64"\n",
-		  mresponse.idx, index);
-	rc = rdb_raft_wait_applied(db, mresponse.idx, mresponse.term);
-	raft_apply_all(db->d_raft);
+	D_ASSERTF(mresponse->idx == index, "%ld == "DF_U64"\n",
+		  mresponse->idx, index);
 
 out_result:
 	if (result != NULL)
@@ -2000,6 +2001,23 @@ out:
 	return rc;
 }
 
+/* Append and wait for \a entry to be applied. Caller must hold d_raft_mutex. */
+static int
+rdb_raft_append_apply_internal(struct rdb *db, msg_entry_t *mentry,
+			       void *result)
+{
+	msg_entry_response_t	mresponse;
+	int			rc;
+
+	rc = rdb_raft_append_internal(db, mentry, result, &mresponse);
+	if (rc != 0)
+		return rc;
+
+	rc = rdb_raft_wait_applied(db, mresponse.idx, mresponse.term);
+	raft_apply_all(db->d_raft);
+	return rc;
+}
+
 int
 rdb_raft_add_replica(struct rdb *db, d_rank_t rank)
 {
@@ -2042,6 +2060,30 @@ rdb_raft_append_apply(struct rdb *db, void *entry, size_t size, void *result)
 	return rdb_raft_append_apply_internal(db, &mentry, result);
 }
 
+/*
+ * Append \a entry and return its \a index and \a term, without waiting for it
+ * to be applied. See rdb_raft_wait_applied(). Caller must hold d_raft_mutex.
+ */
+int
+rdb_raft_append(struct rdb *db, void *entry, size_t size, void *result,
+		uint64_t *index, uint64_t *term)
+{
+	msg_entry_t		mentry = {};
+	msg_entry_response_t	mresponse;
+	int			rc;
+
+	mentry.type = RAFT_LOGTYPE_NORMAL;
+	mentry.data.buf = entry;
+	mentry.data.len = size;
+	rc = rdb_raft_append_internal(db, &mentry, result, &mresponse);
+	if (rc != 0)
+		return rc;
+
+	*index = mresponse.idx;
+	*term = mresponse.term;
+	return 0;
+}
+
 /* Verify the leadership with a majority. */
 int
 rdb_raft_verify_leadership(struct rdb *db)
@@ -2495,6 +2537,29 @@ rdb_raft_get_ae_max_entries(void)
 	return value;
 }
 
+/*
+ * raft sends a follower the entries after its next index, which only advances
+ * when the follower replies, so there is one AE in flight to each follower.
+ * While it is, the entries appended are sent together in the next AE anyway.
+ * Hence, by default, allow one entry in flight and one waiting to be sent: a
+ * larger pipeline would not commit the TXs arriving meanwhile any sooner, but
+ * only split them into more entries, each persisted and applied on its own.
+ */
+static unsigned int
+rdb_raft_get_tx_pipeline(void)
+{
+	char	       *name = "RDB_TX_PIPELINE";
+	unsigned int	default_value = 2;
+	unsigned int	value = default_value;
+
+	d_getenv_int(name, &value);
+	if (value == 0) {
+		D_WARN("%s not in (0, %u] (defaulting to %u)\n", name, UINT_MAX, default_value);
+		value = default_value;
+	}
+	return value;
+}
+
 static size_t
 rdb_raft_get_ae_max_size(void)
 {
@@ -2519,9 +2584,11 @@ rdb_raft_open(struct rdb *db, uint64_t caller_term)
 
 	D_INIT_LIST_HEAD(&db->d_requests);
 	D_INIT_LIST_HEAD(&db->d_replies);
+	D_INIT_LIST_HEAD(&db->d_tx_queue);
 	db->d_compact_thres = rdb_raft_get_compact_thres();
 	db->d_ae_max_size = rdb_raft_get_ae_max_size();
 	db->d_ae_max_entries = rdb_raft_get_ae_max_entries();
+	db->d_tx_pipeline = rdb_raft_get_tx_pipeline();
 
 	rc = d_hash_table_create_inplace(D_HASH_FT_NOLOCK, 4 /* bits */,
 					 NULL /* priv */,
@@ -2738,9 +2805,9 @@ rdb_raft_start(struct rdb *db)
 	D_DEBUG(DB_MD,
 		DF_DB": raft started: election_timeout=%dms request_timeout=%dms "
 		"lease_maintenance_grace=%dms compact_thres="DF_U64" ae_max_entries=%u "
-		"ae_max_size="DF_U64"\n", DP_DB(db), election_timeout, request_timeout,
-		lease_maintenance_grace, db->d_compact_thres, db->d_ae_max_entries,
-		db->d_ae_max_size);
+		"ae_max_size="DF_U64" tx_pipeline=%u\n", DP_DB(db), election_timeout,
+		request_timeout, lease_maintenance_grace, db->d_compact_thres,
+		db->d_ae_max_entries, db->d_ae_max_size, db->d_tx_pipeline);
 	return 0;
 
 err_callbackd:
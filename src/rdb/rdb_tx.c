@@ -164,11 +164,15 @@ struct rdb_tx_op {
 	struct rdb_kvs_attr    *dto_attr;
 };
 
-/* TX header to indicate if the transaction is critical and must bypass SCM space checks.
- * If more protocol needed (e.g., to convey log compaction), could make this a bit flag.
+/* TX header flags. RDB_TX_HDR_CRITICAL indicates if the transaction is critical and must bypass
+ * SCM space checks. RDB_TX_HDR_BATCH indicates that the entry holds a batch of noncritical TXs
+ * (see rdb_tx_flush()) rather than the ops of one TX.
  */
+#define RDB_TX_HDR_CRITICAL	(1U << 0)
+#define RDB_TX_HDR_BATCH	(1U << 1)
+
 struct rdb_tx_hdr {
-	uint32_t	critical;	/* use VOS_OF_CRIT for all ops in TX? */
+	uint32_t	flags;		/* RDB_TX_HDR_* */
 };
 
 #define DF_TX_OP	"%s("DF_IOV","DF_IOV","DF_IOV",%p)"
@@ -183,7 +187,7 @@ rdb_tx_hdr_encode(struct rdb_tx_hdr *hdr, void *buf)
 	void	*p = buf;
 
 	if (buf != NULL)
-		*(uint32_t *)p = hdr->critical;
+		*(uint32_t *)p = hdr->flags;
 
 	p += sizeof(uint32_t);
 
@@ -196,12 +200,12 @@ rdb_tx_hdr_decode(const void *buf, size_t len, struct rdb_tx_hdr *hdr)
 	struct rdb_tx_hdr	out = {};
 	const void	       *p = buf;
 
-	/* critical */
+	/* flags */
 	if (p + sizeof(uint32_t) > buf + len) {
 		D_ERROR("truncated hdr: %zu < %zu\n", len, sizeof(uint32_t));
 		return -DER_IO;
 	}
-	out.critical = *(const uint32_t *)p;
+	out.flags = *(const uint32_t *)p;
 	p += sizeof(uint32_t);
 
 	*hdr = out;
@@ -220,7 +224,7 @@ rdb_tx_is_critical(struct rdb_tx *tx)
 
 		nb = rdb_tx_hdr_decode(tx->dt_entry, tx->dt_entry_len, &hdr);
 		D_ASSERT(nb == sizeof(struct rdb_tx_hdr));
-		crit = hdr.critical;
+		crit = hdr.flags & RDB_TX_HDR_CRITICAL;
 	}
 	return crit;
 }
@@ -339,7 +343,7 @@ rdb_tx_append(struct rdb_tx *tx, struct rdb_tx_op *op, bool is_critical)
 		return rc;
 
 	/* Calculate and check the additional bytes required (no encoding).
-	 * Before first op: insert one uint32_t (boolean) "critical"
+	 * Before first op: insert one uint32_t header, whose "critical" flag is
 	 * interpreted in the raft log_offer execution flow.
 	 */
 	op_len = rdb_tx_op_encode(op, NULL);
@@ -372,13 +376,13 @@ rdb_tx_append(struct rdb_tx *tx, struct rdb_tx_op *op, bool is_critical)
 	/* TX is critical if it is reasonably-sized, and any op is critical */
 	tx->dt_num_ops++;
 	if (tx->dt_entry_len == 0) {
-		hdr.critical = is_critical ? 1 : 0;
+		hdr.flags = is_critical ? RDB_TX_HDR_CRITICAL : 0;
 		tx->dt_entry_len += rdb_tx_hdr_encode(&hdr, tx->dt_entry);
 	} else if (tx->dt_num_ops > RDB_TX_CRITICAL_OPS_LIMIT) {
-		hdr.critical = 0;
+		hdr.flags = 0;
 		rdb_tx_hdr_encode(&hdr, tx->dt_entry);
 	} else if (is_critical) {
-		hdr.critical = 1;
+		hdr.flags = RDB_TX_HDR_CRITICAL;
 		rdb_tx_hdr_encode(&hdr, tx->dt_entry);
 	}
 
@@ -388,6 +392,156 @@ rdb_tx_append(struct rdb_tx *tx, struct rdb_tx_op *op, bool is_critical)
 	return 0;
 }
 
+/* TX waiting in rdb.d_tx_queue to be appended by rdb_tx_flush() */
+struct rdb_tx_commit {
+	d_list_t	 dtc_link;	/* in rdb.d_tx_queue */
+	struct rdb_tx	*dtc_tx;
+	uint64_t	 dtc_index;	/* of the entry holding the TX */
+	uint64_t	 dtc_term;	/* of the entry holding the TX */
+	int		 dtc_rc;	/* of appending the entry */
+	int		 dtc_result;	/* of applying the TX */
+	bool		 dtc_done;	/* appended or failed */
+};
+
+/*
+ * Have too many entries been appended but not applied yet? If so, the TXs
+ * being committed wait in d_tx_queue, and will be appended together.
+ */
+static inline bool
+rdb_tx_pipeline_full(struct rdb *db)
+{
+	return raft_get_current_idx(db->d_raft) - db->d_applied >= db->d_tx_pipeline;
+}
+
+/*
+ * Encode the TXs of \a batch into one entry of \a len bytes:
+ *
+ *   hdr (RDB_TX_HDR_BATCH), uint32_t n, n * (uint32_t len, TX entry)
+ *
+ * and return an array of the \a n result buffers, one for each TX, to be
+ * filled by rdb_tx_apply().
+ */
+static int
+rdb_tx_batch_encode(d_list_t *batch, uint32_t n, size_t len, void **entry, int ***results)
+{
+	struct rdb_tx_hdr	 hdr = {.flags = RDB_TX_HDR_BATCH};
+	struct rdb_tx_commit	*c;
+	void			*buf;
+	void			*p;
+	int			**r;
+	int			 i = 0;
+
+	D_ALLOC(buf, len);
+	if (buf == NULL)
+		return -DER_NOMEM;
+	D_ALLOC_ARRAY(r, n);
+	if (r == NULL) {
+		D_FREE(buf);
+		return -DER_NOMEM;
+	}
+
+	p = buf;
+	p += rdb_tx_hdr_encode(&hdr, p);
+	*(uint32_t *)p = n;
+	p += sizeof(uint32_t);
+	d_list_for_each_entry(c, batch, dtc_link) {
+		*(uint32_t *)p = c->dtc_tx->dt_entry_len;
+		p += sizeof(uint32_t);
+		memcpy(p, c->dtc_tx->dt_entry, c->dtc_tx->dt_entry_len);
+		p += c->dtc_tx->dt_entry_len;
+		r[i++] = &c->dtc_result;
+	}
+	D_ASSERTF(p - buf == len, "%td == %zu\n", p - buf, len);
+
+	*entry = buf;
+	*results = r;
+	return 0;
+}
+
+/*
+ * Append the TXs in d_tx_queue. Consecutive noncritical TXs are merged into
+ * one entry, up to d_ae_max_size bytes, so that concurrent commits share one
+ * raft entry, persisted and replicated once. A critical TX is still appended
+ * alone, as it is allowed to bypass the free space checks. So is every TX of a
+ * DB whose layout predates batch entries, as the engines of that layout could
+ * not decode them. Caller must hold d_raft_mutex.
+ */
+static void
+rdb_tx_flush(struct rdb *db)
+{
+	struct rdb_tx_hdr	hdr = {};
+	bool			can_batch = db->d_version >= RDB_LAYOUT_VERSION_BATCH;
+
+	while (!d_list_empty(&db->d_tx_queue)) {
+		struct rdb_tx_commit	*c;
+		struct rdb_tx_commit	*tmp;
+		d_list_t		 batch;
+		d_list_t		 retry;
+		void			*entry;
+		int			**results;
+		size_t			 len;
+		uint64_t		 index = 0;
+		uint64_t		 term = 0;
+		uint32_t		 n = 0;
+		int			 rc;
+
+		D_INIT_LIST_HEAD(&batch);
+		D_INIT_LIST_HEAD(&retry);
+		len = rdb_tx_hdr_encode(&hdr, NULL) + sizeof(uint32_t);
+		d_list_for_each_entry_safe(c, tmp, &db->d_tx_queue, dtc_link) {
+			size_t tx_len = sizeof(uint32_t) + c->dtc_tx->dt_entry_len;
+
+			/* The TX began in an earlier term. */
+			if (rdb_tx_leader_check(c->dtc_tx) != 0) {
+				d_list_del_init(&c->dtc_link);
+				c->dtc_rc = -DER_NOTLEADER;
+				c->dtc_done = true;
+				continue;
+			}
+			if (n > 0 && (!can_batch || rdb_tx_is_critical(c->dtc_tx) ||
+				      len + tx_len > db->d_ae_max_size))
+				break;
+			d_list_move_tail(&c->dtc_link, &batch);
+			len += tx_len;
+			n++;
+			if (rdb_tx_is_critical(c->dtc_tx))
+				break;
+		}
+		if (n == 0)
+			continue;
+
+		c = d_list_entry(batch.next, struct rdb_tx_commit, dtc_link);
+		if (n == 1) {
+			rc = rdb_raft_append(db, c->dtc_tx->dt_entry, c->dtc_tx->dt_entry_len,
+					     &c->dtc_result, &index, &term);
+		} else {
+			rc = rdb_tx_batch_encode(&batch, n, len, &entry, &results);
+			if (rc == 0) {
+				rc = rdb_raft_append(db, entry, len, results, &index, &term);
+				D_FREE(results);
+				D_FREE(entry);
+			}
+			D_DEBUG(DB_TRACE, DF_DB": appended %u TXs in entry "DF_U64": "DF_RC"\n",
+				DP_DB(db), n, index, DP_RC(rc));
+		}
+
+		d_list_for_each_entry_safe(c, tmp, &batch, dtc_link) {
+			/* Not applied due to another TX of the batch, append it again. */
+			if (rc == 0 && n > 1 && c->dtc_result == -DER_AGAIN) {
+				c->dtc_result = 0;
+				d_list_move_tail(&c->dtc_link, &retry);
+				continue;
+			}
+			d_list_del_init(&c->dtc_link);
+			c->dtc_rc = rc;
+			c->dtc_index = index;
+			c->dtc_term = term;
+			c->dtc_done = true;
+		}
+		d_list_splice_init(&retry, &db->d_tx_queue);
+	}
+}
+
 /**
  * Commit \a tx. If successful, then all updates in \a tx are revealed to
  * queries. If an error occurs, then \a tx is aborted.
@@ -399,8 +553,9 @@ rdb_tx_append(struct rdb_tx *tx, struct rdb_tx_op *op, bool is_critical)
 int
 rdb_tx_commit(struct rdb_tx *tx)
 {
-	int		result = 0;
-	int		rc;
+	struct rdb_tx_commit	c = {.dtc_tx = tx};
+	int			result = 0;
+	int			rc;
 
 	/* Don't fail query-only TXs for leader checks. */
 	if ((tx->dt_flags & RDB_TX_LOCAL) || tx->dt_entry == NULL)
@@ -470,8 +625,39 @@ check_space:
 			scm_remaining);
 	}
 
-	rc = rdb_raft_append_apply(tx->dt_db, tx->dt_entry, tx->dt_entry_len,
-				   &result);
+	/*
+	 * Group commit: while d_tx_pipeline entries are in flight, queue the TX,
+	 * so that the TXs committed meanwhile are appended together.
+	 */
+	d_list_add_tail(&c.dtc_link, &tx->dt_db->d_tx_queue);
+	while (!c.dtc_done) {
+		if (tx->dt_db->d_stop) {
+			rc = -DER_CANCELED;
+			break;
+		}
+		rc = rdb_tx_leader_check(tx);
+		if (rc != 0)
+			break;
+		if (rdb_tx_pipeline_full(tx->dt_db)) {
+			ABT_cond_wait(tx->dt_db->d_applied_cv, tx->dt_db->d_raft_mutex);
+			continue;
+		}
+		rdb_tx_flush(tx->dt_db);
+		/* Wake up the TXs appended by this flush. */
+		ABT_cond_broadcast(tx->dt_db->d_applied_cv);
+	}
+	if (!c.dtc_done) {
+		d_list_del(&c.dtc_link);
+		goto out_lock;
+	}
+	rc = c.dtc_rc;
+	if (rc != 0)
+		goto out_lock;
+
+	rc = rdb_raft_wait_applied(tx->dt_db, c.dtc_index, c.dtc_term);
+	raft_apply_all(tx->dt_db->d_raft);
+	if (rc == 0)
+		result = c.dtc_result;
 out_lock:
 	ABT_mutex_unlock(tx->dt_db->d_raft_mutex);
 	if (rc != 0)
@@ -907,10 +1093,118 @@ rdb_tx_deterministic_error(int error)
 	       error == -DER_INVAL || error == -DER_NO_PERM;
 }
 
+/* Apply the ops of a TX, in [buf, buf + len). */
+static int
+rdb_tx_apply_ops(struct rdb *db, uint64_t index, const void *buf, size_t len, bool crit)
+{
+	const void	       *p = buf;
+	ssize_t			n;
+	int			rc = 0;
+
+	while (p < buf + len) {
+		struct rdb_tx_op	op;
+
+		n = rdb_tx_op_decode(p, buf + len - p, &op);
+		if (n < 0) {
+			D_ERROR(DF_DB": invalid entry format: buf=%p len="DF_U64
+				" p=%p\n", DP_DB(db), buf, len, p);
+			rc = n;
+			break;
+		}
+		rc = rdb_tx_apply_op(db, index, &op, crit);
+		if (rc != 0) {
+			if (!rdb_tx_deterministic_error(rc))
+				D_ERROR(DF_DB ": failed to apply entry " DF_U64
+					      " op %u <%td, %zd>: " DF_RC "\n",
+					DP_DB(db), index, op.dto_opc, p - buf, n, DP_RC(rc));
+			break;
+		}
+		p += n;
+	}
+	return rc;
+}
+
+/*
+ * Apply the \a nr TXs of a batch entry, in [buf, buf + len), see
+ * rdb_tx_batch_encode(). If a TX fails, its position is returned in \a failed.
+ */
+static int
+rdb_tx_apply_batch(struct rdb *db, uint64_t index, const void *buf, size_t len,
+		   uint32_t *nr, uint32_t *failed)
+{
+	const void	       *p = buf;
+	uint32_t		i;
+	int			rc;
+
+	if (p + sizeof(uint32_t) > buf + len) {
+		D_ERROR(DF_DB": truncated batch: %zu\n", DP_DB(db), len);
+		return -DER_IO;
+	}
+	*nr = *(const uint32_t *)p;
+	p += sizeof(uint32_t);
+
+	for (i = 0; i < *nr; i++) {
+		struct rdb_tx_hdr	hdr;
+		uint32_t		tx_len;
+		ssize_t			n;
+
+		if (p + sizeof(uint32_t) > buf + len ||
+		    p + sizeof(uint32_t) + *(const uint32_t *)p > buf + len) {
+			D_ERROR(DF_DB": truncated batch: TX %u/%u, %td/%zu\n", DP_DB(db), i, *nr,
+				p - buf, len);
+			return -DER_IO;
+		}
+		tx_len = *(const uint32_t *)p;
+		p += sizeof(uint32_t);
+
+		n = rdb_tx_hdr_decode(p, tx_len, &hdr);
+		if (n < 0)
+			return n;
+		rc = rdb_tx_apply_ops(db, index, p + n, tx_len - n,
+				      hdr.flags & RDB_TX_HDR_CRITICAL);
+		if (rc != 0) {
+			*failed = i;
+			return rc;
+		}
+		p += tx_len;
+	}
+	return 0;
+}
+
+/*
+ * A batch entry has been appended by a leader whose replica is of a newer
+ * layout than this one. Upgrade the layout of this replica before applying the
+ * entry, so that older engines refuse to open it rather than misread its log.
+ */
+static int
+rdb_tx_upgrade_batch(struct rdb *db)
+{
+	uint32_t	version = RDB_LAYOUT_VERSION_BATCH;
+	d_iov_t		value;
+	int		rc;
+
+	d_iov_set(&value, &version, sizeof(version));
+	rc = rdb_mc_update(db->d_mc, RDB_MC_ATTRS, 1 /* n */, &rdb_mc_version, &value);
+	if (rc != 0) {
+		D_ERROR(DF_DB": failed to upgrade layout version from %u to %u: "DF_RC"\n",
+			DP_DB(db), db->d_version, version, DP_RC(rc));
+		return rc;
+	}
+	D_NOTE(DF_DB": upgraded layout version from %u to %u\n", DP_DB(db), db->d_version,
+	       version);
+	db->d_version = version;
+	return 0;
+}
+
 /*
  * Apply an entry and return the error only if a nondeterministic error
  * happens. This function tries to discard index if an error occurs.
  * Interpret header to know if ops in the TX are deemed "critical".
+ *
+ * For a batch entry, \a result is an array of result buffers, one for each
+ * TX. If a TX fails with a deterministic error, the whole entry is discarded:
+ * the error is reported to that TX, and -DER_AGAIN to the others, which shall
+ * be appended again.
  */
 int
 rdb_tx_apply(struct rdb *db, uint64_t index, const void *buf, size_t len,
@@ -919,6 +1213,9 @@ rdb_tx_apply(struct rdb *db, uint64_t index, const void *buf, size_t len,
 	const void	       *p = buf;
 	ssize_t			n;
 	bool			crit = true;
+	bool			batch = false;
+	uint32_t		nr = 0;
+	uint32_t		failed = 0;
 	daos_size_t		scm_remaining = 0;
 	int			rc = 0;
 
@@ -940,7 +1237,8 @@ rdb_tx_apply(struct rdb *db, uint64_t index, const void *buf, size_t len,
 			return rc;
 		}
 		p += n;
-		crit = hdr.critical;
+		crit = hdr.flags & RDB_TX_HDR_CRITICAL;
+		batch = hdr.flags & RDB_TX_HDR_BATCH;
 
 		/* scm_remaining < RDB_NOAPPEND_FREE_SPACE can happen on
 		 * on follower after leader compacts log first.
@@ -954,30 +1252,20 @@ rdb_tx_apply(struct rdb *db, uint64_t index, const void *buf, size_t len,
 	}
 
 	D_DEBUG(DB_TRACE, DF_DB": applying index "DF_U64": buf=%p len="DF_U64
-		" crit=%d, scm_left="DF_U64"\n", DP_DB(db), index, buf, len,
-		crit, scm_remaining);
+		" crit=%d batch=%d, scm_left="DF_U64"\n", DP_DB(db), index, buf, len,
+		crit, batch, scm_remaining);
 
-	while (p < buf + len) {
-		struct rdb_tx_op	op;
-
-		n = rdb_tx_op_decode(p, buf + len - p, &op);
-		if (n < 0) {
-			D_ERROR(DF_DB": invalid entry format: buf=%p len="DF_U64
-				" p=%p\n", DP_DB(db), buf, len, p);
-			rc = n;
-			break;
-		}
-		rc = rdb_tx_apply_op(db, index, &op, crit);
-		if (rc != 0) {
-			if (!rdb_tx_deterministic_error(rc))
-				D_ERROR(DF_DB ": failed to apply entry " DF_U64
-					      " op %u <%td, %zd>: " DF_RC "\n",
-					DP_DB(db), index, op.dto_opc, p - buf, n, DP_RC(rc));
-			break;
-		}
-		p += n;
+	if (batch && db->d_version < RDB_LAYOUT_VERSION_BATCH) {
+		rc = rdb_tx_upgrade_batch(db);
+		if (rc != 0)
+			return rc;
 	}
 
+	if (batch)
+		rc = rdb_tx_apply_batch(db, index, p, buf + len - p, &nr, &failed);
+	else
+		rc = rdb_tx_apply_ops(db, index, p, buf + len - p, crit);
+
 	/*
 	 * If an error occurs after we have potentially made some
 	 * modifications, empty the rdb_kvs cache (to evict any rdb_kvs
@@ -1008,8 +1296,15 @@ rdb_tx_apply(struct rdb *db, uint64_t index, const void *buf, size_t len,
 	 * Report the deterministic error to the result buffer, if there is
 	 * one, and consider this entry applied.
 	 */
-	if (result != NULL)
+	if (result != NULL && batch) {
+		int	      **results = result;
+		uint32_t	i;
+
+		for (i = 0; i < nr; i++)
+			*results[i] = (rc == 0 || i == failed) ? rc : -DER_AGAIN;
+	} else if (result != NULL) {
 		*(int *)result = rc;
+	}
 
 	*critp = crit;
 	return 0;
@@ -16,12 +16,22 @@
 
 #define DB_CAP	(1L << 25)
 
+/* First key updated by rdbt_bench(), one for each ULT */
+#define RDBT_BENCH_KEY	0xBE0C000000000000ULL
+
+/* First key updated by rdbt_test_batch(), one for each ULT */
+#define RDBT_BATCH_KEY	0xBA7C000000000000ULL
+#define RDBT_BATCH_NULTS	4
+
 static char	       *test_svc_name = "rsvc_test";
 static d_iov_t		test_svc_id;
 
 /* Root KVS layout */
 RDB_STRING_KEY(rdbt_key_, kvs1);
 
+/* Never created, for TXs failing with a deterministic error */
+RDB_STRING_KEY(rdbt_key_, nonexist);
+
 struct rdbt_svc {
 	struct ds_rsvc		rt_rsvc;
 	rdb_path_t		rt_root_kvs_path;
@@ -597,6 +607,223 @@ proceed:
 	return 0;
 }
 
+struct rdbt_batch_arg {
+	struct rdbt_svc	       *svc;
+	rdb_path_t	       *kvs;
+	uint64_t		key;
+	int			rc;
+};
+
+/* Commit one TX updating the key of this ULT in arg->kvs. */
+static void
+rdbt_batch_ult(void *varg)
+{
+	struct rdbt_batch_arg  *arg = varg;
+	struct rdb_tx		tx;
+	d_iov_t			key;
+	d_iov_t			value;
+	int			rc;
+
+	d_iov_set(&key, &arg->key, sizeof(arg->key));
+	d_iov_set(&value, &arg->key, sizeof(arg->key));
+	rc = rdb_tx_begin(arg->svc->rt_rsvc.s_db, arg->svc->rt_rsvc.s_term, &tx);
+	if (rc != 0)
+		goto out;
+	rc = rdb_tx_update(&tx, arg->kvs, &key, &value);
+	if (rc == 0)
+		rc = rdb_tx_commit(&tx);
+	rdb_tx_end(&tx);
+out:
+	arg->rc = rc;
+}
+
+/*
+ * Commit RDBT_BATCH_NULTS TXs in one batch entry, one of which updates a KVS
+ * that does not exist: that TX shall fail with -DER_NONEXIST, and the others
+ * shall be appended again, in a second entry, and succeed.
+ */
+static int
+rdbt_test_batch(struct rsvc_hint *hintp)
+{
+	struct ds_rsvc	       *rsvc;
+	struct rdbt_svc	       *svc;
+	struct rdb	       *db;
+	struct rdbt_batch_arg	args[RDBT_BATCH_NULTS];
+	ABT_thread		ults[RDBT_BATCH_NULTS];
+	d_list_t	       *link;
+	rdb_path_t		nonexist_path;
+	struct rdb_tx		tx;
+	d_iov_t			key;
+	d_iov_t			value;
+	unsigned int		pipeline;
+	uint64_t		index;
+	uint64_t		v;
+	int			nqueued;
+	int			i;
+	int			rc;
+
+	rc = ds_rsvc_lookup_leader(DS_RSVC_CLASS_TEST, &test_svc_id, &rsvc, hintp);
+	if (rc != 0) {
+		D_WARN("lookup leader: "DF_RC"\n", DP_RC(rc));
+		return rc;
+	}
+	svc = rdbt_svc_obj(rsvc);
+	db = rsvc->s_db;
+	if (db->d_version < RDB_LAYOUT_VERSION_BATCH) {
+		D_WARN("batch: layout version %u, skipped\n", db->d_version);
+		goto out;
+	}
+
+	MUST(rdb_path_clone(&svc->rt_root_kvs_path, &nonexist_path));
+	MUST(rdb_path_push(&nonexist_path, &rdbt_key_nonexist));
+
+	/* Hold the TXs in d_tx_queue, so that they are appended together. */
+	ABT_mutex_lock(db->d_raft_mutex);
+	pipeline = db->d_tx_pipeline;
+	db->d_tx_pipeline = 0;
+	ABT_mutex_unlock(db->d_raft_mutex);
+
+	D_WARN("batch: %d ULTs, ULT 1 failing\n", RDBT_BATCH_NULTS);
+	for (i = 0; i < RDBT_BATCH_NULTS; i++) {
+		args[i].svc = svc;
+		args[i].kvs = (i == 1) ? &nonexist_path : &svc->rt_kvs1_path;
+		args[i].key = RDBT_BATCH_KEY + i;
+		MUST(dss_ult_create(rdbt_batch_ult, &args[i], DSS_XS_SELF, 0, 0, &ults[i]));
+	}
+
+	do {
+		dss_sleep(10);
+		nqueued = 0;
+		ABT_mutex_lock(db->d_raft_mutex);
+		d_list_for_each(link, &db->d_tx_queue)
+			nqueued++;
+		ABT_mutex_unlock(db->d_raft_mutex);
+	} while (nqueued < RDBT_BATCH_NULTS);
+
+	ABT_mutex_lock(db->d_raft_mutex);
+	index = raft_get_current_idx(db->d_raft);
+	db->d_tx_pipeline = pipeline;
+	ABT_cond_broadcast(db->d_applied_cv);
+	ABT_mutex_unlock(db->d_raft_mutex);
+
+	for (i = 0; i < RDBT_BATCH_NULTS; i++) {
+		ABT_thread_free(&ults[i]);
+		D_WARN("batch: ULT %d: "DF_RC"\n", i, DP_RC(args[i].rc));
+		D_ASSERTF(args[i].rc == (i == 1 ? -DER_NONEXIST : 0), "ULT %d: "DF_RC"\n", i,
+			  DP_RC(args[i].rc));
+	}
+
+	/* The discarded batch entry, and the one of the TXs appended again */
+	ABT_mutex_lock(db->d_raft_mutex);
+	D_ASSERTF(raft_get_current_idx(db->d_raft) == index + 2, DF_U64" == "DF_U64"\n",
+		  raft_get_current_idx(db->d_raft), index + 2);
+	ABT_mutex_unlock(db->d_raft_mutex);
+
+	MUST(rdb_tx_begin(db, RDB_NIL_TERM, &tx));
+	for (i = 0; i < RDBT_BATCH_NULTS; i++) {
+		if (i == 1)
+			continue;
+		d_iov_set(&key, &args[i].key, sizeof(args[i].key));
+		d_iov_set(&value, &v, sizeof(v));
+		MUST(rdb_tx_lookup(&tx, &svc->rt_kvs1_path, &key, &value));
+		D_ASSERTF(v == args[i].key, DF_X64" == "DF_X64"\n", v, args[i].key);
+	}
+	rdb_tx_end(&tx);
+	rdb_path_fini(&nonexist_path);
+
+out:
+	ds_rsvc_put_leader(rsvc);
+	return 0;
+}
+
+struct rdbt_bench_arg {
+	struct rdbt_svc	       *svc;
+	uint64_t		key;
+	uint32_t		ncommits;
+	int			rc;
+};
+
+/* Commit arg->ncommits TXs, each updating the key of this ULT in "kvs1". */
+static void
+rdbt_bench_ult(void *varg)
+{
+	struct rdbt_bench_arg  *arg = varg;
+	struct rdb_tx		tx;
+	d_iov_t			key;
+	d_iov_t			value;
+	uint64_t		i;
+	int			rc = 0;
+
+	d_iov_set(&key, &arg->key, sizeof(arg->key));
+	d_iov_set(&value, &i, sizeof(i));
+	for (i = 0; i < arg->ncommits; i++) {
+		rc = rdb_tx_begin(arg->svc->rt_rsvc.s_db, arg->svc->rt_rsvc.s_term, &tx);
+		if (rc != 0)
+			break;
+		rc = rdb_tx_update(&tx, &arg->svc->rt_kvs1_path, &key, &value);
+		if (rc == 0)
+			rc = rdb_tx_commit(&tx);
+		rdb_tx_end(&tx);
+		if (rc != 0)
+			break;
+	}
+	arg->rc = rc;
+}
+
+/*
+ * Measure the commit throughput of the leader: nults ULTs commit ncommits TXs
+ * each, concurrently, so that the TXs may be appended together.
+ */
+static int
+rdbt_bench(uint32_t nults, uint32_t ncommits, uint64_t *usecsp, struct rsvc_hint *hintp)
+{
+	struct ds_rsvc	       *rsvc;
+	struct rdbt_bench_arg  *args;
+	ABT_thread	       *ults;
+	uint64_t		start;
+	int			i;
+	int			rc;
+
+	rc = ds_rsvc_lookup_leader(DS_RSVC_CLASS_TEST, &test_svc_id, &rsvc,
+				   hintp);
+	if (rc != 0) {
+		D_WARN("lookup leader: "DF_RC"\n", DP_RC(rc));
+		return rc;
+	}
+
+	D_ALLOC_ARRAY(args, nults);
+	D_ALLOC_ARRAY(ults, nults);
+	if (args == NULL || ults == NULL)
+		D_GOTO(out, rc = -DER_NOMEM);
+
+	D_WARN("bench: %u ULTs, %u commits each\n", nults, ncommits);
+	start = daos_getutime();
+	for (i = 0; i < nults; i++) {
+		args[i].svc = rdbt_svc_obj(rsvc);
+		args[i].key = RDBT_BENCH_KEY + i;
+		args[i].ncommits = ncommits;
+		ults[i] = ABT_THREAD_NULL;
+		rc = dss_ult_create(rdbt_bench_ult, &args[i], DSS_XS_SELF, 0, 0, &ults[i]);
+		if (rc != 0)
+			break;
+	}
+	for (i = 0; i < nults; i++) {
+		if (ults[i] == ABT_THREAD_NULL)
+			continue;
+		ABT_thread_free(&ults[i]);
+		if (rc == 0)
+			rc = args[i].rc;
+	}
+	*usecsp = daos_getutime() - start;
+	D_WARN("bench: "DF_U64" usecs: "DF_RC"\n", *usecsp, DP_RC(rc));
+
+out:
+	D_FREE(ults);
+	D_FREE(args);
+	ds_rsvc_put_leader(rsvc);
+	return rc;
+}
+
 static void
 get_all_ranks(d_rank_list_t **list)
 {
@@ -733,11 +960,31 @@ rdbt_test_handler(crt_rpc_t *rpc)
 	rdbt_test_rsvc();
 	rc = rdbt_test_tx(in->tti_update, in->tti_memb_op, in->tti_key,
 			  in->tti_val, &out->tto_val, &out->tto_hint);
+	if (rc == 0 && in->tti_update && in->tti_memb_op == RDBT_MEMBER_NOOP)
+		rc = rdbt_test_batch(&out->tto_hint);
 	out->tto_rc = rc;
 	D_WARN("rpc reply from rank %u: tto_rc=%d\n", rank, rc);
 	crt_reply_send(rpc);
 }
 
+static void
+rdbt_bench_handler(crt_rpc_t *rpc)
+{
+	struct rdbt_bench_in   *in = crt_req_get(rpc);
+	struct rdbt_bench_out  *out = crt_reply_get(rpc);
+	d_rank_t		rank;
+	int			rc;
+
+	MUST(crt_group_rank(NULL /* grp */, &rank));
+	D_WARN("rank %u: received bench RPC\n", rank);
+
+	rc = rdbt_bench(in->tbi_nults, in->tbi_ncommits, &out->tbo_usecs, &out->tbo_hint);
+	out->tbo_rc = rc;
+
+	D_WARN("rpc reply from rank %u: rc=%d\n", rank, rc);
+	crt_reply_send(rpc);
+}
+
 static int
 rdbt_module_init(void)
 {
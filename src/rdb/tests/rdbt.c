@@ -35,6 +35,7 @@ commands:\n\
   create	create KV stores (on discovered leader)\n\
   test		invoke tests on a specified replica rank\n\
   test-multi	invoke tests (on discovered leader)\n\
+  bench		measure commits per second (on discovered leader)\n\
   destroy	destroy KV stores (on discovered leader)\n\
   fini		finalize a replica\n\
   help		print this message and exit\n");
@@ -50,6 +51,10 @@ create, test-multi, destroy options:\n\
   --replicas=N	number of replicas (1)\n\
   --nranks=R	number of server ranks (1)\n");
 	printf("\
+bench options (in addition to the above):\n\
+  --ults=U	number of concurrent committers (16)\n\
+  --commits=C	number of commits per committer (1000)\n");
+	printf("\
 test options:\n\
   --group=GROUP	server group \n\
   --rank=RANK	rank to invoke tests on (0)\n\
@@ -1220,6 +1225,99 @@ test_multi_hdlr(int argc, char *argv[])
 	return rdbt_test_multi(sys->sy_group, g_nranks, g_nreps);
 }
 
+/**** bench command functions ****/
+
+static int
+rdbt_bench_rank(crt_group_t *grp, d_rank_t rank, uint32_t nults, uint32_t ncommits,
+		uint64_t *usecsp, struct rsvc_hint *hintp)
+{
+	crt_rpc_t		*rpc;
+	struct rdbt_bench_in	*in;
+	struct rdbt_bench_out	*out;
+	int			 rc;
+
+	rpc = create_rpc(RDBT_BENCH, grp, rank);
+	in = crt_req_get(rpc);
+	in->tbi_nults = nults;
+	in->tbi_ncommits = ncommits;
+	rc = invoke_rpc(rpc);
+	D_ASSERTF(rc == 0, "%d\n", rc);
+	out = crt_reply_get(rpc);
+	rc = out->tbo_rc;
+	*usecsp = out->tbo_usecs;
+	*hintp = out->tbo_hint;
+	destroy_rpc(rpc);
+	return rc;
+}
+
+static int
+bench_hdlr(int argc, char *argv[])
+{
+	struct option		options[] = {
+		{"group",	required_argument,	NULL,	'g'},
+		{"nranks",	required_argument,	NULL,	'n'},
+		{"replicas",	required_argument,	NULL,	'R'},
+		{"ults",	required_argument,	NULL,	'u'},
+		{"commits",	required_argument,	NULL,	'c'},
+		{NULL,		0,			NULL,	0}
+	};
+	uint32_t		nults = 16;
+	uint32_t		ncommits = 1000;
+	d_rank_t		ldr_rank = g_nranks + 1000;
+	uint64_t		term;
+	uint64_t		usecs = 0;
+	struct rsvc_hint	h;
+	int			rc;
+
+	while ((rc = getopt_long(argc, argv, "", options, NULL)) != -1) {
+		switch (rc) {
+		case 'g':
+			group_id = optarg;
+			break;
+		case 'n':
+			g_nranks = atoi(optarg);
+			break;
+		case 'R':
+			g_nreps = atoi(optarg);
+			break;
+		case 'u':
+			nults = atoi(optarg);
+			break;
+		case 'c':
+			ncommits = atoi(optarg);
+			break;
+		default:
+			return 2;
+		}
+	}
+	if (nults == 0 || ncommits == 0)
+		return 2;
+
+	rc = dc_mgmt_sys_attach(group_id, &sys);
+	if (rc != 0)
+		return rc;
+
+	rc = rdbt_find_leader(sys->sy_group, g_nranks, g_nreps, &ldr_rank, &term);
+	if (rc) {
+		fprintf(stderr, "ERR: RDB find leader failed\n");
+		return rc;
+	}
+	printf("Discovered leader %u, term="DF_U64"\n", ldr_rank, term);
+
+	printf("===== Bench %u committers x %u commits on leader %u\n", nults, ncommits,
+	       ldr_rank);
+	rc = rdbt_bench_rank(sys->sy_group, ldr_rank, nults, ncommits, &usecs, &h);
+	if (rc) {
+		fprintf(stderr, "ERR: bench failed RPC to leader %u: "DF_RC", hint:(r=%u, t="
+			DF_U64"\n", ldr_rank, DP_RC(rc), h.sh_rank, h.sh_term);
+		return rc;
+	}
+	printf("%u commits in "DF_U64" usecs: %.1f commits/sec\n", nults * ncommits, usecs,
+	       usecs == 0 ? 0.0 : (double)nults * ncommits * 1000000 / usecs);
+
+	return 0;
+}
+
 /**** destroy command functions ****/
 
 static int
@@ -1345,6 +1443,8 @@ main(int argc, char *argv[])
 		hdlr = test_hdlr;
 	else if (strcmp(argv[1], "test-multi") == 0)
 		hdlr = test_multi_hdlr;
+	else if (strcmp(argv[1], "bench") == 0)
+		hdlr = bench_hdlr;
 	else if (strcmp(argv[1], "destroy") == 0)
 		hdlr = destroy_hdlr;
 	else if (strcmp(argv[1], "fini") == 0)
@@ -42,6 +42,7 @@ CRT_RPC_DEFINE(rdbt_create, DAOS_ISEQ_RDBT_CREATE_OP, DAOS_OSEQ_RDBT_CREATE_OP)
 CRT_RPC_DEFINE(rdbt_destroy, DAOS_ISEQ_RDBT_DESTROY_OP,
 	       DAOS_OSEQ_RDBT_DESTROY_OP)
 CRT_RPC_DEFINE(rdbt_test, DAOS_ISEQ_RDBT_TEST_OP, DAOS_OSEQ_RDBT_TEST_OP)
+CRT_RPC_DEFINE(rdbt_bench, DAOS_ISEQ_RDBT_BENCH_OP, DAOS_OSEQ_RDBT_BENCH_OP)
 
 /* Define for cont_rpcs[] array population below.
  * See RDBT_PROTO_*_RPC_LIST macro definition
@@ -15,7 +15,7 @@
  * These are for daos_rpc::dr_opc and DAOS_RPC_OPCODE(opc, ...) rather than
  * crt_req_create(..., opc, ...). See src/include/daos/rpc.h.
  */
-#define DAOS_RDBT_VERSION 2
+#define DAOS_RDBT_VERSION 3
 /* LIST of internal RPCS in form of:
  * OPCODE, flags, FMT, handler, corpc_hdlr,
  */
@@ -46,7 +46,10 @@
 		rdbt_replicas_remove_handler, NULL),			\
 	X(RDBT_START_ELECTION,						\
 		0, &CQF_rdbt_start_election,				\
-		rdbt_start_election_handler, NULL)
+		rdbt_start_election_handler, NULL),			\
+	X(RDBT_BENCH,							\
+		0, &CQF_rdbt_bench,					\
+		rdbt_bench_handler, NULL)
 
 /* Define for RPC enum population below */
 #define X(a, b, c, d, e) a
@@ -167,4 +170,15 @@ CRT_RPC_DECLARE(rdbt_replicas_stop, DAOS_ISEQ_RDBT_STARTSTOP,
 CRT_RPC_DECLARE(rdbt_start_election, DAOS_ISEQ_RDBT_START_ELECTION,
 		DAOS_OSEQ_RDBT_START_ELECTION)
 
+#define DAOS_ISEQ_RDBT_BENCH_OP	/* input fields */		 \
+	((uint32_t)		(tbi_nults)		CRT_VAR) \
+	((uint32_t)		(tbi_ncommits)		CRT_VAR)
+
+#define DAOS_OSEQ_RDBT_BENCH_OP	/* output fields */		 \
+	((struct rsvc_hint)	(tbo_hint)		CRT_VAR) \
+	((uint64_t)		(tbo_usecs)		CRT_VAR) \
+	((int32_t)		(tbo_rc)		CRT_VAR)
+
+CRT_RPC_DECLARE(rdbt_bench, DAOS_ISEQ_RDBT_BENCH_OP, DAOS_OSEQ_RDBT_BENCH_OP)
+
 #endif /* RDB_TESTS_RPC_H */
@@ -0,0 +1,61 @@
+/**
+ * (C) Copyright 2023 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+/**
+ * Estimate of the rebuild progress, see struct rebuild_progress.
+ */
+#include <daos/common.h>
+#include "rebuild_internal.h"
+
+/*
+ * Estimate the bytes of the \a obj_count objects to be rebuilt by a target from
+ * the space \a used_size used by the pool on the target, scaled by the ratio to
+ * the \a scanned_count objects scanned, since VOS does not track the size of
+ * each object.
+ */
+uint64_t
+rebuild_toberb_estimate(uint64_t used_size, uint64_t obj_count, uint64_t scanned_count)
+{
+	if (scanned_count == 0)
+		return 0;
+
+	return (double)used_size * obj_count / scanned_count;
+}
+
+/*
+ * Update the estimate with the \a rebuilt bytes so far at \a now (seconds), and
+ * the estimated \a toberb_size of all ranks. The rate is a moving average to
+ * smooth the bursts of the migration.
+ */
+void
+rebuild_progress_estimate(struct rebuild_progress *rp, uint64_t toberb_size, uint64_t rebuilt,
+			  bool done, uint64_t now)
+{
+	if (rp->rp_rate_time == 0 || rebuilt < rp->rp_rate_size) {
+		rp->rp_rate_time = now;
+		rp->rp_rate_size = rebuilt;
+	} else if (now > rp->rp_rate_time) {
+		uint64_t rate;
+
+		rate = (rebuilt - rp->rp_rate_size) / (now - rp->rp_rate_time);
+		if (rp->rp_rate == 0)
+			rp->rp_rate = rate;
+		else
+			rp->rp_rate = (rp->rp_rate * 7 + rate) / 8;
+		rp->rp_rate_time = now;
+		rp->rp_rate_size = rebuilt;
+	}
+
+	/* The estimate may be too low, never report more than was estimated */
+	rp->rp_total = max(toberb_size, rebuilt);
+	if (done) {
+		rp->rp_pct = 100;
+		rp->rp_remaining = 0;
+	} else {
+		rp->rp_pct = rp->rp_total == 0 ? 0 : min(rebuilt * 100 / rp->rp_total, 99);
+		rp->rp_remaining = rp->rp_total - rebuilt;
+	}
+	rp->rp_eta = rp->rp_rate == 0 ? 0 : rp->rp_remaining / rp->rp_rate;
+}
@@ -14,6 +14,8 @@
 #include <stdint.h>
 #include <abt.h>
 #include <uuid/uuid.h>
+#include <gurt/telemetry_common.h>
+#include <gurt/telemetry_producer.h>
 #include <daos/rpc.h>
 #include <daos/btree.h>
 #include <daos/pool_map.h>
@@ -104,11 +106,38 @@ struct rebuild_tgt_pool_tracker {
 struct rebuild_server_status {
 	d_rank_t	rank;
 	uint32_t	dtx_resync_version;
+	/* percent of full rebuild speed of the slowest target, 0 if unknown */
+	uint32_t	throttle;
+	/* estimated bytes to be rebuilt from the server, 0 if unknown */
+	uint64_t	toberb_size;
 	uint32_t	scan_done:1,
 			pull_done:1;
 };
 
 /* Track the rebuild status globally */
+/*
+ * Progress estimate of the rebuild leader, see rebuild_progress_estimate().
+ * The estimated total is in VOS used space of the sources, which includes the
+ * metadata, the overwritten versions and the snapshots, while the rebuilt size
+ * only counts the record payload written to the destinations. So the percent
+ * is biased low and the ETA high, most for small records and many versions;
+ * the total never goes below the rebuilt size, and it is 100% once completed.
+ */
+struct rebuild_progress {
+	/* Rolling migration rate (bytes/s), and the rebuilt size and the
+	 * time (seconds) of its last sample
+	 */
+	uint64_t	rp_rate;
+	uint64_t	rp_rate_size;
+	uint64_t	rp_rate_time;
+	/* Estimated total and remaining bytes */
+	uint64_t	rp_total;
+	uint64_t	rp_remaining;
+	/* Estimated percent completed and seconds remaining */
+	uint32_t	rp_pct;
+	uint32_t	rp_eta;
+};
+
 struct rebuild_global_pool_tracker {
 	/* rebuild status */
 	struct daos_rebuild_status	rgt_status;
@@ -149,6 +178,10 @@ struct rebuild_global_pool_tracker {
 	 */
 	uint64_t	rgt_reclaim_epoch;
 
+	/* Estimated total bytes to be rebuilt, sum of rgt_servers */
+	uint64_t	rgt_toberb_size;
+	struct rebuild_progress	rgt_progress;
+
 	ABT_mutex	rgt_lock;
 	/* The current rebuild is done on the leader */
 	ABT_cond	rgt_done_cond;
@@ -229,15 +262,45 @@ struct rebuild_task {
 	uint32_t			dst_reclaim_ver;
 };
 
+/* Per-pool per-target rebuild metrics */
+struct rebuild_pool_metrics {
+	/* objects waiting to be sent to the remote targets */
+	struct d_tm_node_t	*rpm_queued[REBUILD_PRIO_NR];
+	/* objects sent to be migrated, or migrated locally */
+	struct d_tm_node_t	*rpm_sent[REBUILD_PRIO_NR];
+};
+
+/* Per-pool rebuild progress metrics, only updated by the rebuild leader */
+struct rebuild_progress_metrics {
+	/* estimated percent completed */
+	struct d_tm_node_t	*rgm_pct;
+	/* estimated total bytes to be rebuilt */
+	struct d_tm_node_t	*rgm_toberb_size;
+	/* estimated bytes remaining */
+	struct d_tm_node_t	*rgm_remaining;
+	/* rolling migration rate */
+	struct d_tm_node_t	*rgm_rate;
+	/* estimated seconds remaining */
+	struct d_tm_node_t	*rgm_eta;
+};
+
 /* Per pool structure in TLS to check pool rebuild status
  * per xstream.
  */
 struct rebuild_pool_tls {
 	uuid_t		rebuild_pool_uuid;
-	daos_handle_t	rebuild_tree_hdl; /*hold objects being rebuilt */
+	/* hold objects being rebuilt, one tree per rebuild priority */
+	daos_handle_t	rebuild_tree_hdls[REBUILD_PRIO_NR];
+	/* valid while the scanner is running */
+	struct rebuild_pool_metrics *rebuild_pool_metrics;
 	d_list_t	rebuild_pool_list;
 	uint64_t	rebuild_pool_obj_count;
 	uint64_t	rebuild_pool_reclaim_obj_count;
+	/* objects scanned and VOS used space when the scan started, to
+	 * estimate the bytes of rebuild_pool_obj_count objects
+	 */
+	uint64_t	rebuild_pool_scanned_count;
+	uint64_t	rebuild_pool_used_size;
 	unsigned int	rebuild_pool_ver;
 	uint32_t	rebuild_pool_gen;
 	uint64_t	rebuild_pool_leader_term;
@@ -265,10 +328,18 @@ struct rebuild_tgt_query_info {
 	uint64_t tobe_obj_count;
 	uint64_t rec_count;
 	uint64_t size;
+	uint64_t toberb_size;
+	uint32_t throttle;
 	bool rebuilding;
 	ABT_mutex lock;
 };
 
+/*
+ * The rebuild IV value is sent raw, new fields are only appended to the end and
+ * are valid if riv_tail_ver of the sender is high enough.
+ */
+#define REBUILD_IV_TAIL_VER	2
+
 struct rebuild_iv {
 	uuid_t		riv_pool_uuid;
 	uint64_t	riv_toberb_obj_count;
@@ -288,14 +359,49 @@ struct rebuild_iv {
 			riv_global_scan_done:1,
 			riv_scan_done:1,
 			riv_pull_done:1,
-			riv_sync:1;
+			riv_sync:1,
+			/* version of the fields after riv_status, 0 from older engines */
+			riv_tail_ver:4;
 	int		riv_status;
-
+	/* REBUILD_IV_TAIL_VER >= 1 */
+	uint32_t	riv_throttle;
+	/* REBUILD_IV_TAIL_VER >= 2 */
+	uint64_t	riv_toberb_size;
 };
 
 #define SCAN_YIELD_FREQ		4096
 #define SCAN_OBJ_YIELD_CNT	128
 
+/*
+ * Score the object by the redundancy left in its group under the current pool
+ * map: every shard of the group to be rebuilt for exclusion is a lost one,
+ * including the ones without a spare target, so that the most at-risk objects
+ * are sent first.
+ */
+static inline unsigned int
+rebuild_obj_prio(uint32_t rebuild_op, struct daos_oclass_attr *oc_attr, daos_unit_oid_t oid,
+		 uint32_t grp_size, unsigned int *shards, int rebuild_nr)
+{
+	int	lost = 0;
+	int	left;
+	int	i;
+
+	if (rebuild_op != RB_OP_EXCLUDE)
+		return REBUILD_PRIO_NORMAL;
+
+	for (i = 0; i < rebuild_nr; i++) {
+		if (oid.id_shard / grp_size == shards[i] / grp_size)
+			lost++;
+	}
+
+	left = (int)oc_attr->ca_resil_degree - lost;
+	if (left <= 0)
+		return REBUILD_PRIO_CRITICAL;
+	if (left == 1)
+		return REBUILD_PRIO_DEGRADED;
+	return REBUILD_PRIO_NORMAL;
+}
+
 extern struct dss_module_key rebuild_module_key;
 static inline struct rebuild_tls *
 rebuild_tls_get()
@@ -388,4 +494,11 @@ void rebuild_leader_stop(const uuid_t pool_uuid, unsigned int version,
 			 uint32_t rebuild_gen, uint64_t term);
 int
 rebuild_obj_tree_destroy(daos_handle_t btr_hdl);
+
+/* progress.c */
+uint64_t
+rebuild_toberb_estimate(uint64_t used_size, uint64_t obj_count, uint64_t scanned_count);
+void
+rebuild_progress_estimate(struct rebuild_progress *rp, uint64_t toberb_size, uint64_t rebuilt,
+			  bool done, uint64_t now);
 #endif /* __REBUILD_INTERNAL_H_ */
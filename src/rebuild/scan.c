@@ -30,6 +30,8 @@
 #define REBUILD_SEND_LIMIT	4096
 struct rebuild_send_arg {
 	struct rebuild_tgt_pool_tracker *rpt;
+	struct rebuild_pool_tls		*tls;
+	struct rebuild_pool_metrics	*metrics;
 	daos_unit_oid_t			*oids;
 	daos_epoch_t			*ephs;
 	daos_epoch_t			*punched_ephs;
@@ -37,6 +39,10 @@ struct rebuild_send_arg {
 	unsigned int			*shards;
 	int				count;
 	unsigned int			tgt_id;
+	/* the priority of the tree being sent */
+	unsigned int			prio;
+	/* stopped for the objects of a higher priority */
+	bool				preempted;
 };
 
 struct rebuild_obj_val {
@@ -65,6 +71,10 @@ rebuild_obj_fill_buf(daos_handle_t ih, d_iov_t *key_iov,
 	punched_ephs[count] = obj_val->punched_eph;
 	shards[count] = obj_val->shard;
 	arg->count++;
+	if (arg->metrics != NULL) {
+		d_tm_dec_gauge(arg->metrics->rpm_queued[arg->prio], 1);
+		d_tm_inc_counter(arg->metrics->rpm_sent[arg->prio], 1);
+	}
 
 	D_DEBUG(DB_REBUILD, "send oid/con "DF_UOID"/"DF_UUID" ephs "DF_U64
 		"shard %d cnt %d tgt_id %d\n", DP_UOID(oids[count]),
@@ -116,7 +126,8 @@ rebuild_obj_send_cb(struct tree_cache_root *root, struct rebuild_send_arg *arg)
 					    arg->tgt_id, rpt->rt_rebuild_ver,
 					    rpt->rt_rebuild_gen, rpt->rt_stable_epoch,
 					    arg->oids, arg->ephs, arg->punched_ephs, arg->shards,
-					    arg->count, rpt->rt_new_layout_ver, rpt->rt_rebuild_op);
+					    arg->count, rpt->rt_new_layout_ver, rpt->rt_rebuild_op,
+					    arg->prio);
 		/* If it does not need retry */
 		if (rc == 0 || (rc != -DER_TIMEDOUT && rc != -DER_GRPVER &&
 		    rc != -DER_AGAIN && !daos_crt_network_error(rc)))
@@ -191,6 +202,31 @@ out:
 	return rc;
 }
 
+/* Return the highest priority with objects waiting, REBUILD_PRIO_NR if none */
+static unsigned int
+rebuild_tree_prio_first(struct rebuild_pool_tls *tls)
+{
+	unsigned int	prio;
+
+	for (prio = 0; prio < REBUILD_PRIO_NR; prio++) {
+		if (!dbtree_is_empty(tls->rebuild_tree_hdls[prio]))
+			break;
+	}
+	return prio;
+}
+
+/*
+ * Objects of a higher priority are inserted by the scanner while sending the
+ * lower ones, stop sending so that they can be sent first.
+ */
+static bool
+rebuild_send_preempted(struct rebuild_send_arg *arg)
+{
+	if (rebuild_tree_prio_first(arg->tls) < arg->prio)
+		arg->preempted = true;
+	return arg->preempted;
+}
+
 static int
 rebuild_tgt_iter_cb(daos_handle_t ih, d_iov_t *key_iov, d_iov_t *val_iov, void *data)
 {
@@ -205,6 +241,9 @@ rebuild_tgt_iter_cb(daos_handle_t ih, d_iov_t *key_iov, d_iov_t *val_iov, void *
 	arg->tgt_id = (unsigned int)tgt_id;
 	root = val_iov->iov_buf;
 	while (!dbtree_is_empty(root->root_hdl)) {
+		if (rebuild_send_preempted(arg))
+			return 1;
+
 		rc = rebuild_obj_send_cb(root, arg);
 		if (rc < 0) {
 			D_ERROR("rebuild_obj_send_cb failed: "DF_RC"\n",
@@ -240,6 +279,8 @@ rebuild_cont_iter_cb(daos_handle_t ih, d_iov_t *key_iov,
 				DP_RC(rc));
 			break;
 		}
+		if (arg->preempted)
+			return 1;
 	}
 
 	d_iov_set(&save_key_iov, arg->cont_uuid, sizeof(uuid_t));
@@ -255,6 +296,7 @@ rebuild_objects_send_ult(void *data)
 	struct rebuild_send_arg		arg = { 0 };
 	struct rebuild_tgt_pool_tracker *rpt = data;
 	struct rebuild_pool_tls		*tls;
+	struct ds_pool_child		*child = NULL;
 	daos_unit_oid_t			*oids = NULL;
 	daos_epoch_t			*ephs = NULL;
 	daos_epoch_t			*punched_ephs = NULL;
@@ -265,6 +307,11 @@ rebuild_objects_send_ult(void *data)
 				      rpt->rt_rebuild_gen);
 	D_ASSERT(tls != NULL);
 
+	/* Pin the pool child for the metrics */
+	child = ds_pool_child_lookup(rpt->rt_pool_uuid);
+	if (child == NULL)
+		D_GOTO(out, rc = -DER_NONEXIST);
+
 	D_ALLOC_ARRAY(oids, REBUILD_SEND_LIMIT);
 	if (oids == NULL)
 		D_GOTO(out, rc = -DER_NOMEM);
@@ -287,19 +334,28 @@ rebuild_objects_send_ult(void *data)
 	arg.ephs = ephs;
 	arg.punched_ephs = punched_ephs;
 	arg.rpt = rpt;
-	while (!tls->rebuild_pool_scan_done || !dbtree_is_empty(tls->rebuild_tree_hdl)) {
+	arg.tls = tls;
+	arg.metrics = child->spc_metrics[DAOS_REBUILD_MODULE];
+	while (!tls->rebuild_pool_scan_done ||
+	       rebuild_tree_prio_first(tls) < REBUILD_PRIO_NR) {
 		if (rpt->rt_stable_epoch == 0) {
 			dss_sleep(0);
 			continue;
 		}
 
-		if (dbtree_is_empty(tls->rebuild_tree_hdl)) {
+		arg.prio = rebuild_tree_prio_first(tls);
+		if (arg.prio == REBUILD_PRIO_NR) {
 			dss_sleep(0);
 			continue;
 		}
 
-		/* walk through the rebuild tree and send the rebuild objects */
-		rc = dbtree_iterate(tls->rebuild_tree_hdl, DAOS_INTENT_MIGRATION,
+		/*
+		 * Walk through the rebuild tree of the highest priority and send
+		 * the rebuild objects, restart from the highest priority if it
+		 * is preempted.
+		 */
+		arg.preempted = false;
+		rc = dbtree_iterate(tls->rebuild_tree_hdls[arg.prio], DAOS_INTENT_MIGRATION,
 				    false, rebuild_cont_iter_cb, &arg);
 		if (rc < 0) {
 			D_ERROR("dbtree iterate failed: "DF_RC"\n", DP_RC(rc));
@@ -319,6 +375,8 @@ out:
 		D_FREE(ephs);
 	if (punched_ephs != NULL)
 		D_FREE(punched_ephs);
+	if (child != NULL)
+		ds_pool_child_put(child);
 	if (rc != 0 && tls->rebuild_pool_status == 0)
 		tls->rebuild_pool_status = rc;
 
@@ -346,7 +404,7 @@ rebuild_scan_done(void *data)
 static int
 rebuild_object_insert(struct rebuild_tgt_pool_tracker *rpt, uuid_t co_uuid,
 		      daos_unit_oid_t oid, unsigned int tgt_id, unsigned int shard,
-		      daos_epoch_t epoch, daos_epoch_t punched_epoch)
+		      daos_epoch_t epoch, daos_epoch_t punched_epoch, unsigned int prio)
 {
 	struct rebuild_pool_tls *tls;
 	struct rebuild_obj_val	val;
@@ -356,7 +414,7 @@ rebuild_object_insert(struct rebuild_tgt_pool_tracker *rpt, uuid_t co_uuid,
 	tls = rebuild_pool_tls_lookup(rpt->rt_pool_uuid, rpt->rt_rebuild_ver,
 				      rpt->rt_rebuild_gen);
 	D_ASSERT(tls != NULL);
-	D_ASSERT(daos_handle_is_valid(tls->rebuild_tree_hdl));
+	D_ASSERT(daos_handle_is_valid(tls->rebuild_tree_hdls[prio]));
 
 	tls->rebuild_pool_obj_count++;
 	val.eph = epoch;
@@ -364,7 +422,9 @@ rebuild_object_insert(struct rebuild_tgt_pool_tracker *rpt, uuid_t co_uuid,
 	val.shard = shard;
 	d_iov_set(&val_iov, &val, sizeof(struct rebuild_obj_val));
 	oid.id_shard = shard; /* Convert the OID to rebuilt one */
-	rc = obj_tree_insert(tls->rebuild_tree_hdl, co_uuid, tgt_id, oid, &val_iov);
+	rc = obj_tree_insert(tls->rebuild_tree_hdls[prio], co_uuid, tgt_id, oid, &val_iov);
+	if (rc == 0 && tls->rebuild_pool_metrics != NULL)
+		d_tm_inc_gauge(tls->rebuild_pool_metrics->rpm_queued[prio], 1);
 	if (rc == -DER_EXIST) {
 		/* If there is reintegrate being restarted due to the failure, then
 		 * it might put multiple shards into the same VOS target, because
@@ -380,8 +440,9 @@ rebuild_object_insert(struct rebuild_tgt_pool_tracker *rpt, uuid_t co_uuid,
 			       DP_UUID(co_uuid), DP_UOID(oid), tgt_id);
 		rc = 0;
 	}
-	D_DEBUG(DB_REBUILD, "insert "DF_UOID"/"DF_UUID" tgt %u "DF_U64"/"DF_U64": "DF_RC"\n",
-		DP_UOID(oid), DP_UUID(co_uuid), tgt_id, epoch, punched_epoch, DP_RC(rc));
+	D_DEBUG(DB_REBUILD, "insert "DF_UOID"/"DF_UUID" tgt %u prio %u "DF_U64"/"DF_U64": "DF_RC
+		"\n", DP_UOID(oid), DP_UUID(co_uuid), tgt_id, prio, epoch, punched_epoch,
+		DP_RC(rc));
 
 	return rc;
 }
@@ -389,13 +450,33 @@ rebuild_object_insert(struct rebuild_tgt_pool_tracker *rpt, uuid_t co_uuid,
 #define LOCAL_ARRAY_SIZE	128
 #define NUM_SHARDS_STEP_INCREASE	10
 /* The structure for scan per xstream */
+/* Objects per pl_obj_find_rebuild_batch() call of the scan */
+#define SCAN_BATCH_NR		64
+/* Shards to be rebuilt per object of the batch, more are found alone */
+#define SCAN_BATCH_SHARD_NR	16
+
+/* Objects buffered by rebuild_obj_scan_cb(), see rebuild_obj_batch_flush() */
+struct rebuild_scan_batch {
+	/* Placement map of the buffered objects, referenced */
+	struct pl_map		*sb_map;
+	int			 sb_nr;
+	vos_iter_entry_t	 sb_ents[SCAN_BATCH_NR];
+	struct daos_obj_md	 sb_mds[SCAN_BATCH_NR];
+	int			 sb_nrs[SCAN_BATCH_NR];
+	uint32_t		 sb_tgts[SCAN_BATCH_NR * SCAN_BATCH_SHARD_NR];
+	uint32_t		 sb_shards[SCAN_BATCH_NR * SCAN_BATCH_SHARD_NR];
+};
+
 struct rebuild_scan_arg {
 	struct rebuild_tgt_pool_tracker *rpt;
+	struct rebuild_pool_tls		*tls;
 	uuid_t				co_uuid;
 	struct cont_props		co_props;
 	int				snapshot_cnt;
 	uint32_t			yield_freq;
 	int32_t				obj_yield_cnt;
+	/* Only for the exclusion, NULL otherwise */
+	struct rebuild_scan_batch	*batch;
 };
 
 /**
@@ -584,6 +665,7 @@ struct rebuild_obj_arg {
 	daos_epoch_t			max_eph;
 	uint32_t			shard;
 	uint32_t			tgt_index;
+	uint32_t			prio;
 };
 
 static void
@@ -595,7 +677,7 @@ rebuild_obj_ult(void *data)
 	ds_migrate_object(rpt->rt_pool, rpt->rt_poh_uuid, rpt->rt_coh_uuid, arg->co_uuid,
 			  rpt->rt_rebuild_ver, rpt->rt_rebuild_gen, rpt->rt_stable_epoch,
 			  rpt->rt_rebuild_op, &arg->oid, &arg->epoch, &arg->punched_epoch,
-			  &arg->shard, 1, arg->tgt_index, rpt->rt_new_layout_ver);
+			  &arg->shard, 1, arg->tgt_index, rpt->rt_new_layout_ver, arg->prio);
 	rpt_put(rpt);
 	D_FREE(arg);
 }
@@ -603,7 +685,7 @@ rebuild_obj_ult(void *data)
 static int
 rebuild_object_local(struct rebuild_tgt_pool_tracker *rpt, uuid_t co_uuid,
 		     daos_unit_oid_t oid, unsigned int tgt_index, unsigned int shard,
-		     daos_epoch_t eph, daos_epoch_t punched_eph)
+		     daos_epoch_t eph, daos_epoch_t punched_eph, unsigned int prio)
 {
 	struct rebuild_obj_arg	*arg;
 	int			rc;
@@ -621,6 +703,7 @@ rebuild_object_local(struct rebuild_tgt_pool_tracker *rpt, uuid_t co_uuid,
 	uuid_copy(arg->co_uuid, co_uuid);
 	arg->tgt_index = tgt_index;
 	arg->shard = shard;
+	arg->prio = prio;
 
 	rc = dss_ult_create(rebuild_obj_ult, arg, DSS_XS_SYS, 0, 0, NULL);
 	if (rc) {
@@ -633,7 +716,8 @@ rebuild_object_local(struct rebuild_tgt_pool_tracker *rpt, uuid_t co_uuid,
 
 static int
 rebuild_object(struct rebuild_tgt_pool_tracker *rpt, uuid_t co_uuid, daos_unit_oid_t oid,
-	       unsigned int tgt, uint32_t shard, d_rank_t myrank, vos_iter_entry_t *ent)
+	       unsigned int tgt, uint32_t shard, d_rank_t myrank, vos_iter_entry_t *ent,
+	       unsigned int prio)
 {
 	uint32_t		mytarget = dss_get_module_info()->dmi_tgt_id;
 	struct pool_target	*target;
@@ -660,15 +744,176 @@ rebuild_object(struct rebuild_tgt_pool_tracker *rpt, uuid_t co_uuid, daos_unit_o
 		punched_eph = 0;
 	}
 
-	if (myrank == target->ta_comp.co_rank)
+	if (myrank == target->ta_comp.co_rank) {
+		struct rebuild_pool_tls *tls;
+
 		rc = rebuild_object_local(rpt, co_uuid, oid, target->ta_comp.co_index, shard,
-					  eph, punched_eph);
-	else
-		rc = rebuild_object_insert(rpt, co_uuid, oid, tgt, shard, eph, punched_eph);
+					  eph, punched_eph, prio);
+		tls = rebuild_pool_tls_lookup(rpt->rt_pool_uuid, rpt->rt_rebuild_ver,
+					      rpt->rt_rebuild_gen);
+		if (rc == 0 && tls != NULL && tls->rebuild_pool_metrics != NULL)
+			d_tm_inc_counter(tls->rebuild_pool_metrics->rpm_sent[prio], 1);
+	} else {
+		rc = rebuild_object_insert(rpt, co_uuid, oid, tgt, shard, eph, punched_eph, prio);
+	}
+
+	return rc;
+}
+
+/* Send the shards of the object to be rebuilt, found by placement */
+static int
+rebuild_obj_send(struct rebuild_scan_arg *arg, vos_iter_entry_t *ent, d_rank_t myrank,
+		 unsigned int *tgts, unsigned int *shards, int rebuild_nr)
+{
+	struct rebuild_tgt_pool_tracker *rpt = arg->rpt;
+	daos_unit_oid_t			oid = ent->ie_oid;
+	struct daos_oclass_attr		*oc_attr;
+	uint32_t			grp_size;
+	unsigned int			prio;
+	int				i;
+	int				rc;
+
+	oc_attr = daos_oclass_attr_find(oid.id_pub, NULL);
+	D_ASSERT(oc_attr != NULL);
+	grp_size = daos_oclass_grp_size(oc_attr);
+
+	prio = rebuild_obj_prio(rpt->rt_rebuild_op, oc_attr, oid, grp_size, shards, rebuild_nr);
+	D_DEBUG(DB_REBUILD, "rebuild obj "DF_UOID" rebuild_nr %d prio %u\n", DP_UOID(oid),
+		rebuild_nr, prio);
+	for (i = 0; i < rebuild_nr; i++) {
+		D_DEBUG(DB_REBUILD, "rebuild obj "DF_UOID"/"DF_UUID"/"DF_UUID
+			"on %d for shard %d eph "DF_U64" visible %s\n", DP_UOID(oid),
+			DP_UUID(rpt->rt_pool_uuid), DP_UUID(arg->co_uuid),
+			tgts[i], shards[i], ent->ie_epoch,
+			ent->ie_vis_flags & VOS_VIS_FLAG_COVERED ? "no" : "yes");
+
+		/* Ignore the shard if it is not in the same group of failure shard */
+		if ((int)tgts[i] == -1 || oid.id_shard / grp_size != shards[i] / grp_size) {
+			D_DEBUG(DB_REBUILD, "i %d stale object "DF_UOID" shards %u grp_size %u tgt %d\n",
+				i, DP_UOID(oid), shards[i], grp_size, (int)tgts[i]);
+			continue;
+		}
+
+		rc = rebuild_object(rpt, arg->co_uuid, oid, tgts[i], shards[i], myrank, ent,
+				    prio);
+		if (rc)
+			return rc;
+
+		arg->obj_yield_cnt--;
+	}
+
+	return 0;
+}
+
+static void
+rebuild_obj_batch_drop(struct rebuild_scan_batch *batch)
+{
+	pl_map_decref(batch->sb_map);
+	batch->sb_map = NULL;
+	batch->sb_nr = 0;
+}
+
+/*
+ * Find the shards to be rebuilt of the objects buffered by rebuild_obj_scan_cb()
+ * with a single placement call, then send them.
+ */
+static int
+rebuild_obj_batch_flush(struct rebuild_scan_arg *arg)
+{
+	struct rebuild_scan_batch	*batch = arg->batch;
+	struct rebuild_tgt_pool_tracker *rpt = arg->rpt;
+	unsigned int			tgt_array[LOCAL_ARRAY_SIZE];
+	unsigned int			shard_array[LOCAL_ARRAY_SIZE];
+	unsigned int			*slot_tgts;
+	unsigned int			*slot_shards;
+	unsigned int			*tgts;
+	unsigned int			*shards;
+	d_rank_t			myrank;
+	int				rebuild_nr;
+	int				i;
+	int				rc;
+
+	if (batch == NULL || batch->sb_nr == 0)
+		return 0;
+
+	rc = pl_obj_find_rebuild_batch(batch->sb_map, arg->co_props.dcp_obj_version,
+				       batch->sb_mds, batch->sb_nr, rpt->rt_rebuild_ver,
+				       batch->sb_tgts, batch->sb_shards, SCAN_BATCH_SHARD_NR,
+				       batch->sb_nrs);
+	if (rc != 0) {
+		DL_ERROR(rc, DF_UUID" find rebuild shards of %d objects",
+			 DP_UUID(rpt->rt_pool_uuid), batch->sb_nr);
+		goto out;
+	}
 
+	crt_group_rank(rpt->rt_pool->sp_group, &myrank);
+	for (i = 0; i < batch->sb_nr; i++) {
+		slot_tgts = &batch->sb_tgts[i * SCAN_BATCH_SHARD_NR];
+		slot_shards = &batch->sb_shards[i * SCAN_BATCH_SHARD_NR];
+		tgts = slot_tgts;
+		shards = slot_shards;
+		rebuild_nr = batch->sb_nrs[i];
+		/* Too many shards for the slot of the object, retry it alone */
+		if (rebuild_nr == -DER_REC2BIG) {
+			tgts = tgt_array;
+			shards = shard_array;
+			rebuild_nr = find_rebuild_shards(batch->sb_map,
+							 arg->co_props.dcp_obj_version,
+							 &batch->sb_mds[i], rpt->rt_tgts_num,
+							 rpt->rt_rebuild_op, rpt->rt_rebuild_ver,
+							 myrank, &tgts, &shards, LOCAL_ARRAY_SIZE);
+		}
+
+		if (rebuild_nr <= 0) {
+			DL_CDEBUG(rebuild_nr == 0, DB_REBUILD, DLOG_ERR, rebuild_nr,
+				  DF_UOID " rebuild shards", DP_UOID(batch->sb_ents[i].ie_oid));
+			rc = rebuild_nr;
+		} else {
+			rc = rebuild_obj_send(arg, &batch->sb_ents[i], myrank, tgts, shards,
+					      rebuild_nr);
+		}
+
+		if (tgts != tgt_array && tgts != slot_tgts && tgts != NULL)
+			D_FREE(tgts);
+		if (shards != shard_array && shards != slot_shards && shards != NULL)
+			D_FREE(shards);
+		if (rc != 0)
+			break;
+	}
+
+out:
+	rebuild_obj_batch_drop(batch);
 	return rc;
 }
 
+/* Buffer the object for rebuild_obj_batch_flush(), flush once the batch is full */
+static int
+rebuild_obj_batch_add(struct rebuild_scan_arg *arg, struct pl_map *map, vos_iter_entry_t *ent,
+		      struct daos_obj_md *md)
+{
+	struct rebuild_scan_batch	*batch = arg->batch;
+	int				rc;
+
+	/* The placement map was updated, find the shards of the buffered objects first */
+	if (batch->sb_map != NULL && batch->sb_map != map) {
+		rc = rebuild_obj_batch_flush(arg);
+		if (rc != 0)
+			return rc;
+	}
+
+	if (batch->sb_map == NULL) {
+		pl_map_addref(map);
+		batch->sb_map = map;
+	}
+
+	batch->sb_ents[batch->sb_nr] = *ent;
+	batch->sb_mds[batch->sb_nr] = *md;
+	if (++batch->sb_nr < SCAN_BATCH_NR)
+		return 0;
+
+	return rebuild_obj_batch_flush(arg);
+}
+
 static int
 rebuild_obj_scan_cb(daos_handle_t ch, vos_iter_entry_t *ent,
 		    vos_iter_type_t type, vos_iter_param_t *param,
@@ -684,16 +929,14 @@ rebuild_obj_scan_cb(daos_handle_t ch, vos_iter_entry_t *ent,
 	unsigned int			*tgts = NULL;
 	unsigned int			*shards = NULL;
 	struct daos_oclass_attr		*oc_attr;
-	uint32_t			grp_size;
-	int				rebuild_nr = 0;
 	d_rank_t			myrank;
-	int				i;
 	int				rc = 0;
 
 	if (rpt->rt_abort) {
 		D_DEBUG(DB_REBUILD, "rebuild is aborted\n");
 		return 1;
 	}
+	arg->tls->rebuild_pool_scanned_count++;
 
 	/* If the OID is invisible, then snapshots must be created on the object. */
 	D_ASSERTF(!(ent->ie_vis_flags & VOS_VIS_FLAG_COVERED) || arg->snapshot_cnt > 0,
@@ -712,8 +955,6 @@ rebuild_obj_scan_cb(daos_handle_t ch, vos_iter_entry_t *ent,
 		D_GOTO(out, rc = 0);
 	}
 
-	grp_size = daos_oclass_grp_size(oc_attr);
-
 	dc_obj_fetch_md(oid.id_pub, &md);
 	crt_group_rank(rpt->rt_pool->sp_group, &myrank);
 	md.omd_ver = rpt->rt_rebuild_ver;
@@ -724,6 +965,12 @@ rebuild_obj_scan_cb(daos_handle_t ch, vos_iter_entry_t *ent,
 	shards = shard_array;
 	switch (rpt->rt_rebuild_op) {
 	case RB_OP_EXCLUDE:
+		/* The shards to be rebuilt are found by batch, see rebuild_obj_batch_flush() */
+		if (arg->batch != NULL) {
+			rc = rebuild_obj_batch_add(arg, map, ent, &md);
+			goto out;
+		}
+		/* fall through */
 	case RB_OP_DRAIN:
 	case RB_OP_REINT:
 	case RB_OP_EXTEND:
@@ -761,30 +1008,7 @@ rebuild_obj_scan_cb(daos_handle_t ch, vos_iter_entry_t *ent,
 		D_GOTO(out, rc);
 	}
 
-	D_DEBUG(DB_REBUILD, "rebuild obj "DF_UOID" rebuild_nr %d\n", DP_UOID(oid), rc);
-	rebuild_nr = rc;
-	rc = 0;
-	for (i = 0; i < rebuild_nr; i++) {
-		D_DEBUG(DB_REBUILD, "rebuild obj "DF_UOID"/"DF_UUID"/"DF_UUID
-			"on %d for shard %d eph "DF_U64" visible %s\n", DP_UOID(oid),
-			DP_UUID(rpt->rt_pool_uuid), DP_UUID(arg->co_uuid),
-			tgts[i], shards[i], ent->ie_epoch,
-			ent->ie_vis_flags & VOS_VIS_FLAG_COVERED ? "no" : "yes");
-
-		/* Ignore the shard if it is not in the same group of failure shard */
-		if ((int)tgts[i] == -1 || oid.id_shard / grp_size != shards[i] / grp_size) {
-			D_DEBUG(DB_REBUILD, "i %d stale object "DF_UOID" shards %u grp_size %u tgt %d\n",
-				i, DP_UOID(oid), shards[i], grp_size, (int)tgts[i]);
-			continue;
-		}
-
-		rc = rebuild_object(rpt, arg->co_uuid, oid, tgts[i], shards[i], myrank, ent);
-		if (rc)
-			D_GOTO(out, rc);
-
-		arg->obj_yield_cnt--;
-	}
-
+	rc = rebuild_obj_send(arg, ent, myrank, tgts, shards, rc);
 out:
 	if (tgts != tgt_array && tgts != NULL)
 		D_FREE(tgts);
@@ -903,6 +1127,11 @@ rebuild_container_scan_cb(daos_handle_t ih, vos_iter_entry_t *entry,
 
 	rc = vos_iterate(&param, VOS_ITER_OBJ, false, &anchor,
 			 rebuild_obj_scan_cb, NULL, arg, dth);
+	/* The rest of the batch belongs to this container */
+	if (rc == 0 && !rpt->rt_abort)
+		rc = rebuild_obj_batch_flush(arg);
+	else if (arg->batch != NULL && arg->batch->sb_map != NULL)
+		rebuild_obj_batch_drop(arg->batch);
 	dtx_end(dth, NULL, rc);
 
 	*acts |= VOS_ITER_CB_YIELD;
@@ -927,10 +1156,12 @@ rebuild_scanner(void *data)
 	struct rebuild_tgt_pool_tracker *rpt = data;
 	struct ds_pool_child		*child;
 	struct rebuild_pool_tls		*tls;
+	vos_pool_info_t			pool_info;
 	vos_iter_param_t		param = { 0 };
 	struct vos_iter_anchors		anchor = { 0 };
 	ABT_thread			ult_send = ABT_THREAD_NULL;
 	struct umem_attr		uma;
+	int				i;
 	int				rc = 0;
 
 	tls = rebuild_pool_tls_lookup(rpt->rt_pool_uuid, rpt->rt_rebuild_ver,
@@ -954,15 +1185,17 @@ rebuild_scanner(void *data)
 		D_DEBUG(DB_REBUILD, "sleep 2 seconds then retry\n");
 		dss_sleep(2 * 1000);
 	}
-	D_ASSERT(daos_handle_is_inval(tls->rebuild_tree_hdl));
-	/* Create object tree root */
+	/* Create object tree roots, one per rebuild priority */
 	memset(&uma, 0, sizeof(uma));
 	uma.uma_id = UMEM_CLASS_VMEM;
-	rc = dbtree_create(DBTREE_CLASS_UV, 0, 4, &uma, NULL,
-			   &tls->rebuild_tree_hdl);
-	if (rc != 0) {
-		D_ERROR("failed to create rebuild tree: "DF_RC"\n", DP_RC(rc));
-		D_GOTO(out, rc);
+	for (i = 0; i < REBUILD_PRIO_NR; i++) {
+		D_ASSERT(daos_handle_is_inval(tls->rebuild_tree_hdls[i]));
+		rc = dbtree_create(DBTREE_CLASS_UV, 0, 4, &uma, NULL,
+				   &tls->rebuild_tree_hdls[i]);
+		if (rc != 0) {
+			D_ERROR("failed to create rebuild tree: "DF_RC"\n", DP_RC(rc));
+			D_GOTO(out, rc);
+		}
 	}
 
 	if (rpt->rt_rebuild_op != RB_OP_RECLAIM && rpt->rt_rebuild_op != RB_OP_FAIL_RECLAIM) {
@@ -979,16 +1212,48 @@ rebuild_scanner(void *data)
 	if (child == NULL)
 		D_GOTO(out, rc = -DER_NONEXIST);
 
+	tls->rebuild_pool_metrics = child->spc_metrics[DAOS_REBUILD_MODULE];
+	if (tls->rebuild_pool_metrics != NULL) {
+		for (i = 0; i < REBUILD_PRIO_NR; i++)
+			d_tm_set_gauge(tls->rebuild_pool_metrics->rpm_queued[i], 0);
+	}
+
+	/* The objects to be rebuilt are assumed to be of the average size of the
+	 * objects of the target, see dss_rebuild_check_one().
+	 */
+	rc = vos_pool_query(child->spc_hdl, &pool_info);
+	if (rc == 0) {
+		struct vos_pool_space *vps = &pool_info.pif_space;
+
+		tls->rebuild_pool_used_size = SCM_TOTAL(vps) - SCM_FREE(vps) +
+					      NVME_TOTAL(vps) - NVME_FREE(vps);
+	} else {
+		D_WARN(DF_UUID" failed to query space: "DF_RC"\n",
+		       DP_UUID(rpt->rt_pool_uuid), DP_RC(rc));
+		rc = 0;
+	}
+
 	param.ip_hdl = child->spc_hdl;
 	param.ip_flags = VOS_IT_FOR_MIGRATION;
 	arg.rpt = rpt;
+	arg.tls = tls;
 	arg.yield_freq = SCAN_YIELD_FREQ;
 	arg.obj_yield_cnt = SCAN_OBJ_YIELD_CNT;
+	/* The exclusion scans every object of the target, find their shards by batch */
+	if (rpt->rt_rebuild_op == RB_OP_EXCLUDE) {
+		D_ALLOC_PTR(arg.batch);
+		if (arg.batch == NULL) {
+			ds_pool_child_put(child);
+			D_GOTO(out, rc = -DER_NOMEM);
+		}
+	}
 	if (!rebuild_status_match(rpt, PO_COMP_ST_UP)) {
 		rc = vos_iterate(&param, VOS_ITER_COUUID, false, &anchor,
 				 rebuild_container_scan_cb, NULL, &arg, NULL);
 	}
+	D_FREE(arg.batch);
 
+	tls->rebuild_pool_metrics = NULL;
 	ds_pool_child_put(child);
 
 out:
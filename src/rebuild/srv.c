@@ -73,6 +73,7 @@ rebuild_pool_tls_create(uuid_t pool_uuid, uuid_t poh_uuid, uuid_t coh_uuid,
 {
 	struct rebuild_pool_tls *rebuild_pool_tls;
 	struct rebuild_tls *tls = rebuild_tls_get();
+	int			i;
 
 	rebuild_pool_tls = rebuild_pool_tls_lookup(pool_uuid, ver, gen);
 	D_ASSERT(rebuild_pool_tls == NULL);
@@ -88,7 +89,10 @@ rebuild_pool_tls_create(uuid_t pool_uuid, uuid_t poh_uuid, uuid_t coh_uuid,
 	rebuild_pool_tls->rebuild_pool_scan_done = 0;
 	rebuild_pool_tls->rebuild_pool_obj_count = 0;
 	rebuild_pool_tls->rebuild_pool_reclaim_obj_count = 0;
-	rebuild_pool_tls->rebuild_tree_hdl = DAOS_HDL_INVAL;
+	rebuild_pool_tls->rebuild_pool_scanned_count = 0;
+	rebuild_pool_tls->rebuild_pool_used_size = 0;
+	for (i = 0; i < REBUILD_PRIO_NR; i++)
+		rebuild_pool_tls->rebuild_tree_hdls[i] = DAOS_HDL_INVAL;
 	/* Only 1 thread will access the list, no need lock */
 	d_list_add(&rebuild_pool_tls->rebuild_pool_list,
 		   &tls->rebuild_pool_list);
@@ -101,10 +105,15 @@ rebuild_pool_tls_create(uuid_t pool_uuid, uuid_t poh_uuid, uuid_t coh_uuid,
 static void
 rebuild_pool_tls_destroy(struct rebuild_pool_tls *tls)
 {
+	int	i;
+
 	D_DEBUG(DB_REBUILD, "TLS destroy for "DF_UUID" ver %d\n",
 		DP_UUID(tls->rebuild_pool_uuid), tls->rebuild_pool_ver);
-	if (daos_handle_is_valid(tls->rebuild_tree_hdl))
-		rebuild_obj_tree_destroy(tls->rebuild_tree_hdl);
+	for (i = 0; i < REBUILD_PRIO_NR; i++) {
+		if (daos_handle_is_valid(tls->rebuild_tree_hdls[i]))
+			rebuild_obj_tree_destroy(tls->rebuild_tree_hdls[i]);
+	}
+
 	d_list_del(&tls->rebuild_pool_list);
 	D_FREE(tls);
 }
@@ -188,6 +197,37 @@ rebuild_leader_set_status(struct rebuild_global_pool_tracker *rgt,
 		status->pull_done = 1;
 }
 
+/*
+ * Track the rebuild throttle and the estimated size to be rebuilt of the
+ * rank reporting \a iv. The pool reports the lowest throttle and the sum of
+ * the estimates.
+ */
+static void
+rebuild_leader_set_progress(struct rebuild_global_pool_tracker *rgt,
+			    struct rebuild_iv *iv)
+{
+	uint64_t	toberb_size = 0;
+	uint32_t	min = 0;
+	int		i;
+
+	for (i = 0; i < rgt->rgt_servers_number; i++) {
+		struct rebuild_server_status *server = &rgt->rgt_servers[i];
+
+		if (server->rank == iv->riv_rank) {
+			if (iv->riv_tail_ver >= 1 && iv->riv_throttle != 0)
+				server->throttle = iv->riv_throttle;
+			if (iv->riv_tail_ver >= 2 && iv->riv_toberb_size != 0)
+				server->toberb_size = iv->riv_toberb_size;
+		}
+
+		if (server->throttle != 0 && (min == 0 || server->throttle < min))
+			min = server->throttle;
+		toberb_size += server->toberb_size;
+	}
+	rgt->rgt_status.rs_throttle = min;
+	rgt->rgt_toberb_size = toberb_size;
+}
+
 static uint32_t
 rebuild_get_global_dtx_resync_ver(struct rebuild_global_pool_tracker *rgt)
 {
@@ -236,6 +276,8 @@ rebuild_global_status_update(struct rebuild_global_pool_tracker *rgt,
 		iv->riv_rank, iv->riv_scan_done, iv->riv_pull_done,
 		iv->riv_dtx_resyc_version);
 
+	rebuild_leader_set_progress(rgt, iv);
+
 	if (!iv->riv_scan_done) {
 		rebuild_leader_set_status(rgt, iv->riv_rank, iv->riv_dtx_resyc_version, 0);
 		return 0;
@@ -409,6 +451,9 @@ dss_rebuild_check_one(void *data)
 
 	status->obj_count += pool_tls->rebuild_pool_reclaim_obj_count;
 	status->tobe_obj_count += pool_tls->rebuild_pool_obj_count;
+	status->toberb_size += rebuild_toberb_estimate(pool_tls->rebuild_pool_used_size,
+						       pool_tls->rebuild_pool_obj_count,
+						       pool_tls->rebuild_pool_scanned_count);
 	ABT_mutex_unlock(status->lock);
 
 	return 0;
@@ -449,6 +494,7 @@ rebuild_tgt_query(struct rebuild_tgt_pool_tracker *rpt,
 	status->obj_count += dms.dm_obj_count;
 	status->rec_count = dms.dm_rec_count;
 	status->size = dms.dm_total_size;
+	status->throttle = dms.dm_throttle;
 	if (status->scanning || dms.dm_migrating)
 		status->rebuilding = true;
 	else
@@ -609,6 +655,32 @@ enum {
 	RB_BCAST_QUERY,
 };
 
+/*
+ * Estimate the rebuild progress from the size rebuilt so far and the estimated
+ * total size reported by all ranks, see struct rebuild_progress for the bias.
+ */
+static void
+rebuild_progress_update(struct rebuild_global_pool_tracker *rgt,
+			struct ds_pool *pool)
+{
+	struct daos_rebuild_status	*rs = &rgt->rgt_status;
+	struct rebuild_progress		*rp = &rgt->rgt_progress;
+	struct rebuild_progress_metrics	*metrics;
+
+	rebuild_progress_estimate(rp, rgt->rgt_toberb_size, rs->rs_size,
+				  rs->rs_state == DRS_COMPLETED, daos_gettime_coarse());
+
+	metrics = pool->sp_metrics[DAOS_REBUILD_MODULE];
+	if (metrics == NULL)
+		return;
+
+	d_tm_set_gauge(metrics->rgm_pct, rp->rp_pct);
+	d_tm_set_gauge(metrics->rgm_toberb_size, rp->rp_total);
+	d_tm_set_gauge(metrics->rgm_remaining, rp->rp_remaining);
+	d_tm_set_gauge(metrics->rgm_rate, rp->rp_rate);
+	d_tm_set_gauge(metrics->rgm_eta, rp->rp_eta);
+}
+
 /*
  * Check rebuild status on the leader. Every other target sends
  * its own rebuild status by IV.
@@ -694,16 +766,18 @@ rebuild_leader_status_check(struct ds_pool *pool, uint32_t op,
 
 		rs->rs_seconds =
 			(d_timeus_secdiff(0) - rgt->rgt_time_start) / 1e6;
+		rebuild_progress_update(rgt, pool);
 		snprintf(sbuf, RBLD_SBUF_LEN,
 			 "%s [%s] (pool "DF_UUID" leader %u term "DF_U64" dtx gl %u ver=%u,"
 			 "gen %u toberb_obj=" DF_U64", rb_obj="DF_U64", rec="DF_U64", size="DF_U64
 			 " done %d status %d/%d  stable "DF_X64" reclaim "DF_X64
-			 " duration=%d secs)\n",
+			 " throttle %u%% progress %u%% eta %u secs duration=%d secs)\n",
 			 RB_OP_STR(op), str, DP_UUID(pool->sp_uuid), myrank,
 			 rgt->rgt_leader_term, rgt->rgt_dtx_resync_version, rgt->rgt_rebuild_ver,
 			 rgt->rgt_rebuild_gen, rs->rs_toberb_obj_nr, rs->rs_obj_nr, rs->rs_rec_nr,
 			 rs->rs_size, rs->rs_state, rs->rs_errno, rs->rs_fail_rank,
-			 rgt->rgt_stable_epoch, rgt->rgt_reclaim_epoch, rs->rs_seconds);
+			 rgt->rgt_stable_epoch, rgt->rgt_reclaim_epoch, rs->rs_throttle,
+			 rgt->rgt_progress.rp_pct, rgt->rgt_progress.rp_eta, rs->rs_seconds);
 
 		D_INFO("%s", sbuf);
 		if (rs->rs_state == DRS_COMPLETED || rebuild_gst.rg_abort ||
@@ -2227,6 +2301,9 @@ rebuild_tgt_status_check_ult(void *arg)
 					   rpt->rt_reported_size;
 		}
 		iv.riv_status = status.status;
+		iv.riv_tail_ver = REBUILD_IV_TAIL_VER;
+		iv.riv_throttle = status.throttle;
+		iv.riv_toberb_size = status.toberb_size;
 		if (status.scanning == 0 || rpt->rt_abort ||
 		    status.status != 0) {
 			iv.riv_scan_done = 1;
@@ -2572,6 +2649,109 @@ fini(void)
 	return 0;
 }
 
+static const char *rebuild_prio_names[REBUILD_PRIO_NR] = {
+	[REBUILD_PRIO_CRITICAL]	= "critical",
+	[REBUILD_PRIO_DEGRADED]	= "degraded",
+	[REBUILD_PRIO_NORMAL]	= "normal",
+};
+
+/* Per-pool progress metrics of the rebuild leader, on the system xstream */
+static void *
+rebuild_progress_metrics_alloc(const char *path)
+{
+	struct rebuild_progress_metrics	*metrics;
+	int				 rc;
+
+	D_ALLOC_PTR(metrics);
+	if (metrics == NULL)
+		return NULL;
+
+	rc = d_tm_add_metric(&metrics->rgm_pct, D_TM_GAUGE,
+			     "estimated percent of the rebuild completed, biased low", "%",
+			     "%s/rebuild/progress/percent", path);
+	if (rc)
+		D_WARN("Failed to create percent gauge: "DF_RC"\n", DP_RC(rc));
+
+	rc = d_tm_add_metric(&metrics->rgm_toberb_size, D_TM_GAUGE,
+			     "estimated size to be rebuilt, in used space of the sources", "bytes",
+			     "%s/rebuild/progress/toberb_bytes", path);
+	if (rc)
+		D_WARN("Failed to create toberb_bytes gauge: "DF_RC"\n", DP_RC(rc));
+
+	rc = d_tm_add_metric(&metrics->rgm_remaining, D_TM_GAUGE,
+			     "estimated size remaining to be rebuilt", "bytes",
+			     "%s/rebuild/progress/remaining_bytes", path);
+	if (rc)
+		D_WARN("Failed to create remaining_bytes gauge: "DF_RC"\n", DP_RC(rc));
+
+	rc = d_tm_add_metric(&metrics->rgm_rate, D_TM_GAUGE,
+			     "rolling rebuild rate", "bytes/sec",
+			     "%s/rebuild/progress/rate", path);
+	if (rc)
+		D_WARN("Failed to create rate gauge: "DF_RC"\n", DP_RC(rc));
+
+	rc = d_tm_add_metric(&metrics->rgm_eta, D_TM_GAUGE,
+			     "estimated time remaining of the rebuild", "s",
+			     "%s/rebuild/progress/eta", path);
+	if (rc)
+		D_WARN("Failed to create eta gauge: "DF_RC"\n", DP_RC(rc));
+
+	return metrics;
+}
+
+static void *
+rebuild_metrics_alloc(const char *path, int tgt_id)
+{
+	struct rebuild_pool_metrics	*metrics;
+	int				 prio;
+	int				 rc;
+
+	if (tgt_id < 0)
+		return rebuild_progress_metrics_alloc(path);
+
+	D_ALLOC_PTR(metrics);
+	if (metrics == NULL)
+		return NULL;
+
+	for (prio = 0; prio < REBUILD_PRIO_NR; prio++) {
+		rc = d_tm_add_metric(&metrics->rpm_queued[prio], D_TM_GAUGE,
+				     "number of objects waiting to be rebuilt", "objs",
+				     "%s/rebuild/%s/queued/tgt_%u", path,
+				     rebuild_prio_names[prio], tgt_id);
+		if (rc)
+			D_WARN("Failed to create queued gauge: "DF_RC"\n", DP_RC(rc));
+
+		rc = d_tm_add_metric(&metrics->rpm_sent[prio], D_TM_COUNTER,
+				     "number of objects scheduled for migration", "objs",
+				     "%s/rebuild/%s/sent/tgt_%u", path,
+				     rebuild_prio_names[prio], tgt_id);
+		if (rc)
+			D_WARN("Failed to create sent counter: "DF_RC"\n", DP_RC(rc));
+	}
+
+	return metrics;
+}
+
+static void
+rebuild_metrics_free(void *data)
+{
+	D_FREE(data);
+}
+
+static int
+rebuild_metrics_count(void)
+{
+	return (max(sizeof(struct rebuild_pool_metrics),
+		    sizeof(struct rebuild_progress_metrics)) / sizeof(struct d_tm_node_t *));
+}
+
+struct dss_module_metrics rebuild_metrics = {
+	.dmm_tags = DAOS_SYS_TAG | DAOS_TGT_TAG,
+	.dmm_init = rebuild_metrics_alloc,
+	.dmm_fini = rebuild_metrics_free,
+	.dmm_nr_metrics = rebuild_metrics_count,
+};
+
 static int
 rebuild_cleanup(void)
 {
@@ -2592,4 +2772,5 @@ struct dss_module rebuild_module = {
     .sm_cli_count   = {0},
     .sm_handlers    = {rebuild_handlers},
     .sm_key         = &rebuild_module_key,
+    .sm_metrics     = &rebuild_metrics,
 };
@@ -0,0 +1,98 @@
+/*
+ * (C) Copyright 2023 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+
+/*
+ * Unit tests for the rebuild priority of the objects
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <daos/tests_lib.h>
+#include "../rebuild_internal.h"
+
+static unsigned int
+prio_get(struct daos_oclass_attr *oc_attr, uint32_t grp_size, unsigned int *shards, int nr)
+{
+	daos_unit_oid_t	oid = { 0 };
+
+	return rebuild_obj_prio(RB_OP_EXCLUDE, oc_attr, oid, grp_size, shards, nr);
+}
+
+/*
+ * 3-way replication, i.e. 2 shards can be lost. A lost shard counts whether a
+ * spare target was found for it or not.
+ */
+static void
+test_prio_replica(void **state)
+{
+	struct daos_oclass_attr	oc_attr = { 0 };
+	unsigned int		one[] = { 1 };
+	unsigned int		two[] = { 1, 2 };
+	unsigned int		other[] = { 4, 5 };
+
+	oc_attr.ca_resil = DAOS_RES_REPL;
+	oc_attr.ca_resil_degree = 2;
+	oc_attr.u.rp.r_num = 3;
+
+	assert_int_equal(prio_get(&oc_attr, 3, one, ARRAY_SIZE(one)), REBUILD_PRIO_DEGRADED);
+	assert_int_equal(prio_get(&oc_attr, 3, two, ARRAY_SIZE(two)), REBUILD_PRIO_CRITICAL);
+
+	/* The shards of the other groups do not count */
+	assert_int_equal(prio_get(&oc_attr, 3, other, ARRAY_SIZE(other)), REBUILD_PRIO_NORMAL);
+}
+
+/* EC 4+2, i.e. RF2 */
+static void
+test_prio_ec(void **state)
+{
+	struct daos_oclass_attr	oc_attr = { 0 };
+	unsigned int		one[] = { 4 };
+	unsigned int		two[] = { 0, 5 };
+	unsigned int		three[] = { 0, 1, 5 };
+	unsigned int		other[] = { 0, 6, 7 };
+
+	oc_attr.ca_resil = DAOS_RES_EC;
+	oc_attr.ca_resil_degree = 2;
+	oc_attr.u.ec.e_k = 4;
+	oc_attr.u.ec.e_p = 2;
+
+	assert_int_equal(prio_get(&oc_attr, 6, one, ARRAY_SIZE(one)), REBUILD_PRIO_DEGRADED);
+	assert_int_equal(prio_get(&oc_attr, 6, two, ARRAY_SIZE(two)), REBUILD_PRIO_CRITICAL);
+	assert_int_equal(prio_get(&oc_attr, 6, three, ARRAY_SIZE(three)), REBUILD_PRIO_CRITICAL);
+	assert_int_equal(prio_get(&oc_attr, 6, other, ARRAY_SIZE(other)), REBUILD_PRIO_DEGRADED);
+}
+
+/* Only the exclusion loses redundancy */
+static void
+test_prio_op(void **state)
+{
+	struct daos_oclass_attr	oc_attr = { 0 };
+	daos_unit_oid_t		oid = { 0 };
+	unsigned int		two[] = { 1, 2 };
+
+	oc_attr.ca_resil = DAOS_RES_REPL;
+	oc_attr.ca_resil_degree = 2;
+	oc_attr.u.rp.r_num = 3;
+
+	assert_int_equal(rebuild_obj_prio(RB_OP_DRAIN, &oc_attr, oid, 3, two, ARRAY_SIZE(two)),
+			 REBUILD_PRIO_NORMAL);
+	assert_int_equal(rebuild_obj_prio(RB_OP_REINT, &oc_attr, oid, 3, two, ARRAY_SIZE(two)),
+			 REBUILD_PRIO_NORMAL);
+}
+
+static const struct CMUnitTest prio_tests[] = {
+	cmocka_unit_test(test_prio_replica),
+	cmocka_unit_test(test_prio_ec),
+	cmocka_unit_test(test_prio_op),
+};
+
+int
+main(int argc, char **argv)
+{
+	return cmocka_run_group_tests_name("rebuild priority tests", prio_tests, NULL, NULL);
+}
@@ -0,0 +1,140 @@
+/*
+ * (C) Copyright 2023 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+
+/*
+ * Unit tests for the rebuild progress estimate
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <daos/tests_lib.h>
+#include "../rebuild_internal.h"
+
+#define MB	(1ULL << 20)
+#define GB	(1ULL << 30)
+
+static void
+test_toberb_estimate(void **state)
+{
+	/* Nothing scanned yet */
+	assert_int_equal(rebuild_toberb_estimate(GB, 0, 0), 0);
+	assert_int_equal(rebuild_toberb_estimate(GB, 10, 0), 0);
+
+	/* Scaled by the ratio of objects to be rebuilt */
+	assert_int_equal(rebuild_toberb_estimate(GB, 0, 100), 0);
+	assert_int_equal(rebuild_toberb_estimate(GB, 25, 100), GB / 4);
+	assert_int_equal(rebuild_toberb_estimate(GB, 100, 100), GB);
+
+	/* No overflow with large pools and object counts */
+	assert_int_equal(rebuild_toberb_estimate(1ULL << 50, 1ULL << 40, 1ULL << 41),
+			 1ULL << 49);
+}
+
+/* Rolling rate and ETA */
+static void
+test_progress_rate(void **state)
+{
+	struct rebuild_progress	rp = { 0 };
+
+	/* First sample only starts the clock */
+	rebuild_progress_estimate(&rp, 100 * MB, 0, false, 1000);
+	assert_int_equal(rp.rp_rate, 0);
+	assert_int_equal(rp.rp_eta, 0);
+	assert_int_equal(rp.rp_pct, 0);
+	assert_int_equal(rp.rp_total, 100 * MB);
+	assert_int_equal(rp.rp_remaining, 100 * MB);
+
+	/* Same second, no new sample */
+	rebuild_progress_estimate(&rp, 100 * MB, 5 * MB, false, 1000);
+	assert_int_equal(rp.rp_rate, 0);
+	assert_int_equal(rp.rp_pct, 5);
+
+	rebuild_progress_estimate(&rp, 100 * MB, 20 * MB, false, 1010);
+	assert_int_equal(rp.rp_rate, 2 * MB);
+	assert_int_equal(rp.rp_pct, 20);
+	assert_int_equal(rp.rp_remaining, 80 * MB);
+	assert_int_equal(rp.rp_eta, 40);
+
+	/* Moving average of 1/8 of the new sample */
+	rebuild_progress_estimate(&rp, 100 * MB, 30 * MB, false, 1020);
+	assert_int_equal(rp.rp_rate, (2 * MB * 7 + MB) / 8);
+	assert_int_equal(rp.rp_eta, 70 * MB / rp.rp_rate);
+
+	/* Stalled */
+	rebuild_progress_estimate(&rp, 100 * MB, 30 * MB, false, 1030);
+	assert_int_equal(rp.rp_rate, ((2 * MB * 7 + MB) / 8) * 7 / 8);
+
+	/* Rebuilt size going back (restarted) restarts the clock */
+	rebuild_progress_estimate(&rp, 100 * MB, 10 * MB, false, 1040);
+	assert_int_equal(rp.rp_rate_time, 1040);
+	assert_int_equal(rp.rp_rate_size, 10 * MB);
+}
+
+/* The estimate is only a hint: bounded by the rebuilt size, 100% once done */
+static void
+test_progress_bounds(void **state)
+{
+	struct rebuild_progress	rp = { 0 };
+
+	/* No estimate yet */
+	rebuild_progress_estimate(&rp, 0, 0, false, 1000);
+	assert_int_equal(rp.rp_pct, 0);
+	assert_int_equal(rp.rp_total, 0);
+
+	/* Estimate too low, never over 99% before completion */
+	rebuild_progress_estimate(&rp, 10 * MB, 20 * MB, false, 1001);
+	assert_int_equal(rp.rp_total, 20 * MB);
+	assert_int_equal(rp.rp_remaining, 0);
+	assert_int_equal(rp.rp_pct, 99);
+	assert_int_equal(rp.rp_eta, 0);
+
+	/* Estimate too high, e.g. from metadata and old versions of the sources */
+	rebuild_progress_estimate(&rp, 100 * MB, 50 * MB, true, 1002);
+	assert_int_equal(rp.rp_total, 100 * MB);
+	assert_int_equal(rp.rp_pct, 100);
+	assert_int_equal(rp.rp_remaining, 0);
+	assert_int_equal(rp.rp_eta, 0);
+}
+
+/* The fields added to the raw IV value are after the ones of older engines */
+static void
+test_iv_layout(void **state)
+{
+	assert_true(offsetof(struct rebuild_iv, riv_throttle) >
+		    offsetof(struct rebuild_iv, riv_status));
+	assert_true(offsetof(struct rebuild_iv, riv_toberb_size) >
+		    offsetof(struct rebuild_iv, riv_throttle));
+	assert_true(REBUILD_IV_TAIL_VER >= 2);
+}
+
+static int
+setup_progress_tests(void **state)
+{
+	return d_log_init();
+}
+
+static int
+teardown_progress_tests(void **state)
+{
+	d_log_fini();
+	return 0;
+}
+
+int
+main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_toberb_estimate),
+		cmocka_unit_test(test_progress_rate),
+		cmocka_unit_test(test_progress_bounds),
+		cmocka_unit_test(test_iv_layout),
+	};
+
+	return cmocka_run_group_tests_name("rebuild_progress", tests, setup_progress_tests,
+					   teardown_progress_tests);
+}
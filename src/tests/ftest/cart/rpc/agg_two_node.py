@@ -0,0 +1,25 @@
+'''
+  (C) Copyright 2023 Intel Corporation.
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+'''
+from cart_utils import CartTest
+
+
+class CartAggTwoNodeTest(CartTest):
+    # pylint: disable=too-few-public-methods
+    """Run CaRT RPC aggregation tests.
+
+    :avocado: recursive
+    """
+
+    def test_cart_agg_two_node(self):
+        """Test CaRT RPC aggregation.
+
+        :avocado: tags=all,pr,daily_regression
+        :avocado: tags=vm
+        :avocado: tags=cart,rpc,two_node,memcheck
+        :avocado: tags=CartAggTwoNodeTest,test_cart_agg_two_node
+        """
+        cmd = self.build_cmd(self.env, "test_servers")
+        self.launch_test(cmd)
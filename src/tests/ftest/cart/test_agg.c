@@ -0,0 +1,315 @@
+/*
+ * (C) Copyright 2023 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+/**
+ * RPC aggregation test. Rank0 sends a burst of small RPCs registered with
+ * CRT_RPC_FEAT_AGGREGATE to the other ranks, some of them larger than
+ * CRT_AGG_SIZE so they are sent by their own, the rest are packed into the
+ * envelope RPCs if CRT_AGG_WINDOW is set. Each reply echoes the sequence and
+ * the checksum of the payload, rank0 verifies every reply then stops the
+ * other ranks.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <assert.h>
+#include <semaphore.h>
+#include <sys/stat.h>
+#include "crt_utils.h"
+
+#define TEST_AGG_BASE		0x010000000
+#define TEST_AGG_VER		0
+#define TEST_AGG_RPC_NR		2000
+/* every TEST_AGG_LARGE_INTV-th RPC carries TEST_AGG_LARGE_LEN bytes */
+#define TEST_AGG_LARGE_INTV	97
+#define TEST_AGG_LARGE_LEN	(128 << 10)
+#define TEST_AGG_WAIT_SEC	120
+
+#define CRT_ISEQ_AGG_ECHO	/* input fields */		 \
+	((uint64_t)		(seq)			CRT_VAR) \
+	((d_iov_t)		(data)			CRT_VAR)
+
+#define CRT_OSEQ_AGG_ECHO	/* output fields */		 \
+	((uint64_t)		(seq)			CRT_VAR) \
+	((uint64_t)		(csum)			CRT_VAR) \
+	((uint32_t)		(rank)			CRT_VAR)
+
+CRT_RPC_DECLARE(agg_echo, CRT_ISEQ_AGG_ECHO, CRT_OSEQ_AGG_ECHO)
+CRT_RPC_DEFINE(agg_echo, CRT_ISEQ_AGG_ECHO, CRT_OSEQ_AGG_ECHO)
+
+#define CRT_ISEQ_AGG_DONE	/* input fields */		 \
+	((uint32_t)		(unused)		CRT_VAR)
+
+#define CRT_OSEQ_AGG_DONE	/* output fields */		 \
+	((uint32_t)		(unused)		CRT_VAR)
+
+CRT_RPC_DECLARE(agg_done, CRT_ISEQ_AGG_DONE, CRT_OSEQ_AGG_DONE)
+CRT_RPC_DEFINE(agg_done, CRT_ISEQ_AGG_DONE, CRT_OSEQ_AGG_DONE)
+
+static d_rank_t		my_rank;
+static sem_t		test_sem;
+static ATOMIC uint32_t	test_replied;
+static ATOMIC uint32_t	test_failed;
+
+static uint64_t
+payload_csum(d_iov_t *iov)
+{
+	uint64_t	csum = 0;
+	size_t		i;
+
+	for (i = 0; i < iov->iov_len; i++)
+		csum = csum * 31 + ((uint8_t *)iov->iov_buf)[i];
+
+	return csum;
+}
+
+static void
+test_agg_echo_hdlr(crt_rpc_t *rpc)
+{
+	struct agg_echo_in	*in = crt_req_get(rpc);
+	struct agg_echo_out	*out = crt_reply_get(rpc);
+	int			 rc;
+
+	out->seq = in->seq;
+	out->csum = payload_csum(&in->data);
+	out->rank = my_rank;
+
+	rc = crt_reply_send(rpc);
+	assert(rc == 0);
+}
+
+static void
+test_agg_done_hdlr(crt_rpc_t *rpc)
+{
+	int	rc;
+
+	rc = crt_reply_send(rpc);
+	assert(rc == 0);
+
+	crtu_progress_stop();
+}
+
+static struct crt_proto_rpc_format my_proto_rpc_fmt_agg[] = {
+	{
+		.prf_flags	= CRT_RPC_FEAT_AGGREGATE,
+		.prf_req_fmt	= &CQF_agg_echo,
+		.prf_hdlr	= test_agg_echo_hdlr,
+	}, {
+		.prf_flags	= 0,
+		.prf_req_fmt	= &CQF_agg_done,
+		.prf_hdlr	= test_agg_done_hdlr,
+	}
+};
+
+static struct crt_proto_format my_proto_fmt_agg = {
+	.cpf_name = "my-proto-agg",
+	.cpf_ver = TEST_AGG_VER,
+	.cpf_count = ARRAY_SIZE(my_proto_rpc_fmt_agg),
+	.cpf_prf = &my_proto_rpc_fmt_agg[0],
+	.cpf_base = TEST_AGG_BASE,
+};
+
+struct echo_arg {
+	uint64_t	ea_seq;
+	uint64_t	ea_csum;
+	d_rank_t	ea_rank;
+	void		*ea_buf;
+};
+
+static void
+echo_response_hdlr(const struct crt_cb_info *info)
+{
+	struct echo_arg		*arg = info->cci_arg;
+	struct agg_echo_out	*out = crt_reply_get(info->cci_rpc);
+
+	if (info->cci_rc != 0) {
+		D_ERROR("RPC "DF_U64" to rank %u failed: "DF_RC"\n", arg->ea_seq,
+			arg->ea_rank, DP_RC(info->cci_rc));
+		atomic_fetch_add(&test_failed, 1);
+	} else if (out->seq != arg->ea_seq || out->csum != arg->ea_csum ||
+		   out->rank != arg->ea_rank) {
+		/* a reply matched to the wrong request */
+		D_ERROR("RPC "DF_U64" to rank %u: got seq "DF_U64" from rank %u\n",
+			arg->ea_seq, arg->ea_rank, out->seq, out->rank);
+		atomic_fetch_add(&test_failed, 1);
+	}
+
+	D_FREE(arg->ea_buf);
+	D_FREE(arg);
+	if (atomic_fetch_add(&test_replied, 1) + 1 == TEST_AGG_RPC_NR)
+		sem_post(&test_sem);
+}
+
+static void
+done_response_hdlr(const struct crt_cb_info *info)
+{
+	if (info->cci_rc != 0) {
+		D_ERROR("done RPC failed: "DF_RC"\n", DP_RC(info->cci_rc));
+		atomic_fetch_add(&test_failed, 1);
+	}
+	sem_post(&test_sem);
+}
+
+static void
+send_echo(crt_context_t ctx, crt_group_t *grp, d_rank_t rank, uint64_t seq)
+{
+	crt_endpoint_t		 ep = { .ep_grp = grp, .ep_rank = rank, .ep_tag = 0 };
+	struct agg_echo_in	*in;
+	struct echo_arg		*arg;
+	crt_rpc_t		*rpc;
+	size_t			 len;
+	size_t			 i;
+	int			 rc;
+
+	D_ALLOC_PTR(arg);
+	assert(arg != NULL);
+
+	len = (seq % TEST_AGG_LARGE_INTV == 0) ? TEST_AGG_LARGE_LEN : seq % 200;
+	if (len > 0) {
+		D_ALLOC(arg->ea_buf, len);
+		assert(arg->ea_buf != NULL);
+		for (i = 0; i < len; i++)
+			((uint8_t *)arg->ea_buf)[i] = (uint8_t)(seq + i * 7);
+	}
+
+	rc = crt_req_create(ctx, &ep, CRT_PROTO_OPC(TEST_AGG_BASE, TEST_AGG_VER, 0),
+			    &rpc);
+	assert(rc == 0);
+
+	in = crt_req_get(rpc);
+	in->seq = seq;
+	d_iov_set(&in->data, arg->ea_buf, len);
+
+	arg->ea_seq = seq;
+	arg->ea_csum = payload_csum(&in->data);
+	arg->ea_rank = rank;
+
+	rc = crt_req_send(rpc, echo_response_hdlr, arg);
+	assert(rc == 0);
+}
+
+int main(void)
+{
+	int		 rc;
+	crt_context_t	 g_main_ctx;
+	d_rank_list_t	*rank_list;
+	crt_endpoint_t	 ep = { .ep_tag = 0 };
+	crt_rpc_t	*rpc;
+	crt_group_t	*grp;
+	char		*env_self_rank;
+	char		*grp_cfg_file;
+	pthread_t	 progress_thread;
+	uint64_t	 seq;
+	uint32_t	 i;
+
+	env_self_rank = getenv("CRT_L_RANK");
+	my_rank = atoi(env_self_rank);
+
+	/* rank, num_attach_retries, is_server, assert_on_error */
+	crtu_test_init(my_rank, 20, true, true);
+
+	rc = d_log_init();
+	assert(rc == 0);
+
+	rc = sem_init(&test_sem, 0, 0);
+	assert(rc == 0);
+
+	rc = crt_init(NULL, CRT_FLAG_BIT_SERVER | CRT_FLAG_BIT_AUTO_SWIM_DISABLE);
+	assert(rc == 0);
+
+	rc = crt_proto_register(&my_proto_fmt_agg);
+	assert(rc == 0);
+
+	rc = crt_context_create(&g_main_ctx);
+	assert(rc == 0);
+
+	rc = pthread_create(&progress_thread, 0,
+			    crtu_progress_fn, &g_main_ctx);
+	if (rc != 0) {
+		D_ERROR("pthread_create() failed; rc=%d\n", rc);
+		assert(0);
+	}
+
+	grp_cfg_file = getenv("CRT_L_GRP_CFG");
+
+	rc = crt_rank_self_set(my_rank, 1 /* group_version_min */);
+	if (rc != 0) {
+		D_ERROR("crt_rank_self_set(%d) failed; rc=%d\n",
+			my_rank, rc);
+		assert(0);
+	}
+
+	grp = crt_group_lookup(NULL);
+	if (!grp) {
+		D_ERROR("Failed to lookup group\n");
+		assert(0);
+	}
+
+	/* load group info from a config file and delete file upon return */
+	rc = crtu_load_group_from_file(grp_cfg_file, g_main_ctx, grp, my_rank,
+				       true);
+	if (rc != 0) {
+		D_ERROR("crtu_load_group_from_file() failed; rc=%d\n", rc);
+		assert(0);
+	}
+
+	if (my_rank == 0) {
+		rc = crt_group_ranks_get(grp, &rank_list);
+		if (rc != 0) {
+			D_ERROR("crt_group_ranks_get() failed; rc=%d\n", rc);
+			assert(0);
+		}
+		assert(rank_list->rl_nr > 1);
+
+		rc = crtu_wait_for_ranks(g_main_ctx, grp, rank_list,
+					 0, 1, 50, 100.0);
+		if (rc != 0) {
+			D_ERROR("wait_for_ranks() failed; rc=%d\n", rc);
+			assert(0);
+		}
+
+		DBG_PRINT("Rank 0 sending %d RPCs\n", TEST_AGG_RPC_NR);
+		for (seq = 0; seq < TEST_AGG_RPC_NR; seq++)
+			send_echo(g_main_ctx, grp,
+				  rank_list->rl_ranks[1 + seq % (rank_list->rl_nr - 1)], seq);
+
+		rc = crtu_sem_timedwait(&test_sem, TEST_AGG_WAIT_SEC, __LINE__);
+		assert(rc == 0);
+		DBG_PRINT("%u RPCs replied, %u failed\n", atomic_load(&test_replied),
+			  atomic_load(&test_failed));
+
+		ep.ep_grp = grp;
+		for (i = 1; i < rank_list->rl_nr; i++) {
+			ep.ep_rank = rank_list->rl_ranks[i];
+			rc = crt_req_create(g_main_ctx, &ep,
+					    CRT_PROTO_OPC(TEST_AGG_BASE, TEST_AGG_VER, 1), &rpc);
+			assert(rc == 0);
+			rc = crt_req_send(rpc, done_response_hdlr, NULL);
+			assert(rc == 0);
+			rc = crtu_sem_timedwait(&test_sem, TEST_AGG_WAIT_SEC, __LINE__);
+			assert(rc == 0);
+		}
+
+		d_rank_list_free(rank_list);
+		crtu_progress_stop();
+	}
+
+	pthread_join(progress_thread, NULL);
+	DBG_PRINT("Test finished\n");
+
+	if (atomic_load(&test_failed) != 0) {
+		D_ERROR("%u RPCs failed\n", atomic_load(&test_failed));
+		assert(0);
+	}
+
+	rc = crt_finalize();
+	assert(rc == 0);
+
+	sem_destroy(&test_sem);
+	d_log_fini();
+
+	return 0;
+}
@@ -0,0 +1,300 @@
+/*
+ * (C) Copyright 2023 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+/**
+ * CORPC test with a large chained bulk. Rank0 sends a CORPC request with a
+ * bulk of a few MiB to other ranks over a deep tree, so the bulk is pulled in
+ * chunks and forwarded while being pulled if CRT_CORPC_BULK_CHUNK is small
+ * enough. All ranks verify the payload, the failures are aggregated back to
+ * rank0.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <assert.h>
+#include <sys/stat.h>
+#include "crt_utils.h"
+
+/* not aligned to the chunk size on purpose */
+#define TEST_CORPC_BULK_LEN	((4 << 20) + 13)
+
+#define TEST_CORPC_BULK_BASE	0x010000000
+#define TEST_CORPC_BULK_VER	0
+
+#define CRT_ISEQ_BULK_CORPC	/* input fields */		 \
+	((uint32_t)		(seed)			CRT_VAR)
+
+#define CRT_OSEQ_BULK_CORPC	/* output fields */		 \
+	((uint32_t)		(nr)			CRT_VAR) \
+	((uint32_t)		(failed)		CRT_VAR)
+
+CRT_RPC_DECLARE(bulk_corpc, CRT_ISEQ_BULK_CORPC, CRT_OSEQ_BULK_CORPC)
+CRT_RPC_DEFINE(bulk_corpc, CRT_ISEQ_BULK_CORPC, CRT_OSEQ_BULK_CORPC)
+
+static d_rank_t	my_rank;
+static int	test_rc = -DER_INPROGRESS;
+
+static inline uint8_t
+payload_byte(uint32_t seed, size_t off)
+{
+	return (uint8_t)((off * 2654435761U) >> 13 ^ seed);
+}
+
+static int
+corpc_aggregate(crt_rpc_t *src, crt_rpc_t *result, void *priv)
+{
+	struct bulk_corpc_out	*out_src = crt_reply_get(src);
+	struct bulk_corpc_out	*out_result = crt_reply_get(result);
+
+	out_result->nr += out_src->nr;
+	out_result->failed += out_src->failed;
+	return 0;
+}
+
+static int
+corpc_post_reply(crt_rpc_t *rpc, void *arg)
+{
+	/* the non-root ranks are done once the aggregated reply is sent */
+	if (my_rank != 0)
+		crtu_progress_stop();
+	return 0;
+}
+
+struct crt_corpc_ops corpc_bulk_ops = {
+	.co_aggregate	= corpc_aggregate,
+	.co_post_reply	= corpc_post_reply,
+};
+
+static int
+payload_verify(crt_bulk_t bulk_hdl, uint32_t seed)
+{
+	d_sg_list_t	sgl;
+	d_iov_t		iovs[4];
+	size_t		bulk_len;
+	size_t		off = 0;
+	size_t		i;
+	uint32_t	j;
+	int		rc;
+
+	if (bulk_hdl == CRT_BULK_NULL) {
+		D_ERROR("rank %d: no bulk\n", my_rank);
+		return -DER_INVAL;
+	}
+
+	rc = crt_bulk_get_len(bulk_hdl, &bulk_len);
+	if (rc != 0)
+		return rc;
+
+	if (bulk_len != TEST_CORPC_BULK_LEN) {
+		D_ERROR("rank %d: bulk len %zu, expected %d\n", my_rank, bulk_len,
+			TEST_CORPC_BULK_LEN);
+		return -DER_INVAL;
+	}
+
+	sgl.sg_nr = ARRAY_SIZE(iovs);
+	sgl.sg_nr_out = 0;
+	sgl.sg_iovs = iovs;
+	rc = crt_bulk_access(bulk_hdl, &sgl);
+	if (rc != 0)
+		return rc;
+
+	for (j = 0; j < sgl.sg_nr_out; j++) {
+		for (i = 0; i < iovs[j].iov_len; i++, off++) {
+			if (((uint8_t *)iovs[j].iov_buf)[i] != payload_byte(seed, off)) {
+				D_ERROR("rank %d: mismatch at %zu\n", my_rank, off);
+				return -DER_MISMATCH;
+			}
+		}
+	}
+
+	return off == bulk_len ? 0 : -DER_INVAL;
+}
+
+static void
+test_bulk_corpc_hdlr(crt_rpc_t *rpc)
+{
+	struct bulk_corpc_in	*in = crt_req_get(rpc);
+	struct bulk_corpc_out	*out = crt_reply_get(rpc);
+	int			 rc;
+
+	rc = payload_verify(rpc->cr_co_bulk_hdl, in->seed);
+	DBG_PRINT("rank %d verified the bulk: %d\n", my_rank, rc);
+
+	out->nr = 1;
+	out->failed = rc == 0 ? 0 : 1;
+	rc = crt_reply_send(rpc);
+	assert(rc == 0);
+}
+
+static void
+corpc_response_hdlr(const struct crt_cb_info *info)
+{
+	struct bulk_corpc_out	*out = crt_reply_get(info->cci_rpc);
+	uint32_t		*expected = info->cci_arg;
+
+	if (info->cci_rc != 0) {
+		D_ERROR("CORPC failed: "DF_RC"\n", DP_RC(info->cci_rc));
+		test_rc = info->cci_rc;
+	} else if (out->nr != *expected || out->failed != 0) {
+		D_ERROR("%u/%u ranks replied, %u failed\n", out->nr, *expected,
+			out->failed);
+		test_rc = -DER_MISMATCH;
+	} else {
+		DBG_PRINT("%u ranks verified the bulk\n", out->nr);
+		test_rc = 0;
+	}
+
+	crtu_progress_stop();
+}
+
+static struct crt_proto_rpc_format my_proto_rpc_fmt_bulk_corpc[] = {
+	{
+		.prf_flags	= 0,
+		.prf_req_fmt	= &CQF_bulk_corpc,
+		.prf_hdlr	= test_bulk_corpc_hdlr,
+		.prf_co_ops	= &corpc_bulk_ops,
+	}
+};
+
+static struct crt_proto_format my_proto_fmt_bulk_corpc = {
+	.cpf_name = "my-proto-bulk_corpc",
+	.cpf_ver = TEST_CORPC_BULK_VER,
+	.cpf_count = ARRAY_SIZE(my_proto_rpc_fmt_bulk_corpc),
+	.cpf_prf = &my_proto_rpc_fmt_bulk_corpc[0],
+	.cpf_base = TEST_CORPC_BULK_BASE,
+};
+
+int main(void)
+{
+	int			 rc;
+	crt_context_t		 g_main_ctx;
+	d_rank_list_t		*rank_list;
+	crt_rpc_t		*rpc;
+	struct bulk_corpc_in	*in;
+	crt_group_t		*grp;
+	crt_bulk_t		 bulk_hdl = CRT_BULK_NULL;
+	d_sg_list_t		 sgl;
+	d_iov_t			 iov;
+	uint8_t			*buf = NULL;
+	uint32_t		 grp_size = 0;
+	char			*env_self_rank;
+	char			*grp_cfg_file;
+	pthread_t		 progress_thread;
+	size_t			 i;
+
+	env_self_rank = getenv("CRT_L_RANK");
+	my_rank = atoi(env_self_rank);
+
+	/* rank, num_attach_retries, is_server, assert_on_error */
+	crtu_test_init(my_rank, 20, true, true);
+
+	rc = d_log_init();
+	assert(rc == 0);
+
+	rc = crt_init(NULL, CRT_FLAG_BIT_SERVER | CRT_FLAG_BIT_AUTO_SWIM_DISABLE);
+	assert(rc == 0);
+
+	rc = crt_proto_register(&my_proto_fmt_bulk_corpc);
+	assert(rc == 0);
+
+	rc = crt_context_create(&g_main_ctx);
+	assert(rc == 0);
+
+	rc = pthread_create(&progress_thread, 0,
+			    crtu_progress_fn, &g_main_ctx);
+	if (rc != 0) {
+		D_ERROR("pthread_create() failed; rc=%d\n", rc);
+		assert(0);
+	}
+
+	grp_cfg_file = getenv("CRT_L_GRP_CFG");
+
+	rc = crt_rank_self_set(my_rank, 1 /* group_version_min */);
+	if (rc != 0) {
+		D_ERROR("crt_rank_self_set(%d) failed; rc=%d\n",
+			my_rank, rc);
+		assert(0);
+	}
+
+	grp = crt_group_lookup(NULL);
+	if (!grp) {
+		D_ERROR("Failed to lookup group\n");
+		assert(0);
+	}
+
+	/* load group info from a config file and delete file upon return */
+	rc = crtu_load_group_from_file(grp_cfg_file, g_main_ctx, grp, my_rank,
+				       true);
+	if (rc != 0) {
+		D_ERROR("crtu_load_group_from_file() failed; rc=%d\n", rc);
+		assert(0);
+	}
+
+	if (my_rank == 0) {
+		rc = crt_group_ranks_get(grp, &rank_list);
+		if (rc != 0) {
+			D_ERROR("crt_group_ranks_get() failed; rc=%d\n", rc);
+			assert(0);
+		}
+
+		rc = crtu_wait_for_ranks(g_main_ctx, grp, rank_list,
+					 0, 1, 50, 100.0);
+		if (rc != 0) {
+			D_ERROR("wait_for_ranks() failed; rc=%d\n", rc);
+			assert(0);
+		}
+
+		grp_size = rank_list->rl_nr;
+		d_rank_list_free(rank_list);
+		rank_list = NULL;
+
+		D_ALLOC(buf, TEST_CORPC_BULK_LEN);
+		assert(buf != NULL);
+		for (i = 0; i < TEST_CORPC_BULK_LEN; i++)
+			buf[i] = payload_byte(my_rank + 7, i);
+
+		d_iov_set(&iov, buf, TEST_CORPC_BULK_LEN);
+		sgl.sg_nr = 1;
+		sgl.sg_nr_out = 0;
+		sgl.sg_iovs = &iov;
+		rc = crt_bulk_create(g_main_ctx, &sgl, CRT_BULK_RO, &bulk_hdl);
+		assert(rc == 0);
+
+		/* the binary tree is the deepest, each level pulls from its parent */
+		DBG_PRINT("Rank 0 sending CORPC call with %d bytes bulk\n",
+			  TEST_CORPC_BULK_LEN);
+		rc = crt_corpc_req_create(g_main_ctx, NULL, NULL,
+			CRT_PROTO_OPC(TEST_CORPC_BULK_BASE,
+				TEST_CORPC_BULK_VER, 0), bulk_hdl, NULL, 0,
+			crt_tree_topo(CRT_TREE_KNOMIAL, 2), &rpc);
+		assert(rc == 0);
+
+		in = crt_req_get(rpc);
+		in->seed = my_rank + 7;
+
+		rc = crt_req_send(rpc, corpc_response_hdlr, &grp_size);
+		assert(rc == 0);
+	}
+
+	pthread_join(progress_thread, NULL);
+	DBG_PRINT("Test finished\n");
+
+	if (my_rank == 0) {
+		crt_bulk_free(bulk_hdl);
+		D_FREE(buf);
+		if (test_rc != 0) {
+			D_ERROR("CORPC bulk test failed: "DF_RC"\n", DP_RC(test_rc));
+			assert(0);
+		}
+	}
+
+	rc = crt_finalize();
+	assert(rc == 0);
+
+	d_log_fini();
+
+	return 0;
+}
@@ -0,0 +1,422 @@
+/*
+ * (C) Copyright 2023 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+/**
+ * Simulation of the SWIM dissemination of a correlated failure (e.g. a rack
+ * power loss) in a large group, all the members run in one process with the
+ * real SWIM contexts. Time advances in protocol periods: in every period each
+ * live member pings its next target, the ping and the reply piggyback the
+ * updates prepared by swim_updates_prepare() and go through the packed wire
+ * format. A member that pings a failed target suspects it. The simulation
+ * reports the periods until all live members suspect all failed members and
+ * the bandwidth of the piggybacked updates, both packed and in the former
+ * fixed size format.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+
+#include <gurt/common.h>
+#include <cart/swim.h>
+
+#include "../../../cart/swim/swim_internal.h"
+
+#define MEMBERS_MIN	2
+#define MEMBERS_MAX	100000
+#define PERIODS_MAX	1000
+
+static uint32_t	members = 10000;
+static uint32_t	failures = 64;
+static uint32_t	periods = 200;
+static uint32_t	seed = 1;
+static int	verbose;
+
+struct sim_result {
+	uint32_t	sr_periods;
+	uint64_t	sr_msgs;
+	uint64_t	sr_upds;
+	uint64_t	sr_bytes;
+	uint64_t	sr_raw_bytes;
+	uint64_t	sr_false;
+};
+
+static struct sim {
+	struct swim_context	**s_ctx;
+	uint64_t		 *s_inc;
+	/* status of the failed members as seen by each member */
+	uint8_t			 *s_view;
+	/* permutation of the ping targets of each member */
+	uint32_t		 *s_perm_a;
+	uint32_t		 *s_perm_b;
+	uint32_t		  s_fail_first;
+	struct sim_result	  s_res;
+} s;
+
+static uint32_t
+sim_gcd(uint32_t a, uint32_t b)
+{
+	while (b != 0) {
+		uint32_t t = a % b;
+
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+static inline bool
+sim_failed(swim_id_t id)
+{
+	return id >= s.s_fail_first && id < s.s_fail_first + failures;
+}
+
+static inline uint8_t *
+sim_view(swim_id_t self, swim_id_t id)
+{
+	return &s.s_view[self * failures + (id - s.s_fail_first)];
+}
+
+static int
+sim_send_request(struct swim_context *ctx, swim_id_t id, swim_id_t to,
+		 struct swim_member_update *upds, size_t nupds)
+{
+	return 0;
+}
+
+static int
+sim_send_reply(struct swim_context *ctx, swim_id_t from, swim_id_t to, int ret_rc, void *args)
+{
+	return 0;
+}
+
+static swim_id_t
+sim_get_target(struct swim_context *ctx)
+{
+	return SWIM_ID_INVALID;
+}
+
+static int
+sim_get_member_state(struct swim_context *ctx, swim_id_t id, struct swim_member_state *state)
+{
+	if (id >= members)
+		return -DER_NONEXIST;
+
+	state->sms_incarnation = s.s_inc[id];
+	state->sms_status = sim_failed(id) ? *sim_view(swim_self_get(ctx), id) :
+					     SWIM_MEMBER_ALIVE;
+	/* network delays of a few milliseconds */
+	state->sms_delay = 1 + id % 7;
+	return 0;
+}
+
+static int
+sim_set_member_state(struct swim_context *ctx, swim_id_t id, struct swim_member_state *state)
+{
+	if (id >= members)
+		return -DER_NONEXIST;
+
+	if (sim_failed(id))
+		*sim_view(swim_self_get(ctx), id) = state->sms_status;
+	else if (state->sms_status != SWIM_MEMBER_ALIVE)
+		s.s_res.sr_false++;
+	return 0;
+}
+
+static void
+sim_new_incarnation(struct swim_context *ctx, swim_id_t id, struct swim_member_state *state)
+{
+	state->sms_incarnation = ++s.s_inc[id];
+}
+
+static struct swim_ops sim_ops = {
+	.send_request		= sim_send_request,
+	.send_reply		= sim_send_reply,
+	.get_dping_target	= sim_get_target,
+	.get_iping_target	= sim_get_target,
+	.get_member_state	= sim_get_member_state,
+	.set_member_state	= sim_set_member_state,
+	.new_incarnation	= sim_new_incarnation,
+};
+
+/* Pass the updates through the wire format, as the SWIM RPCs do. */
+static int
+sim_deliver(struct swim_context *ctx, swim_id_t from, struct swim_member_update *upds,
+	    size_t nupds)
+{
+	struct swim_member_update	*out = NULL;
+	void				*buf = NULL;
+	size_t				 size = nupds * SWIM_UPDATE_PACKED_MAX;
+	int				 rc;
+
+	D_ALLOC(buf, size);
+	D_ALLOC_ARRAY(out, nupds);
+	if (buf == NULL || out == NULL)
+		D_GOTO(out, rc = -DER_NOMEM);
+
+	rc = swim_updates_pack(upds, nupds, buf, &size);
+	if (rc)
+		goto out;
+
+	rc = swim_updates_unpack(buf, size, out, nupds);
+	if (rc)
+		goto out;
+
+	s.s_res.sr_msgs++;
+	s.s_res.sr_upds += nupds;
+	s.s_res.sr_bytes += size;
+	s.s_res.sr_raw_bytes += nupds * sizeof(*upds);
+
+	rc = swim_updates_parse(ctx, from, from, out, nupds);
+out:
+	D_FREE(out);
+	D_FREE(buf);
+	return rc;
+}
+
+static swim_id_t
+sim_target(swim_id_t self, uint32_t period)
+{
+	swim_id_t	id;
+	uint32_t	i;
+
+	/* skip the members known to be dead, like the SWIM target lists do */
+	for (i = 0; i < members - 1; i++) {
+		id = (s.s_perm_a[self] * (uint64_t)(period + i) + s.s_perm_b[self]) %
+		     (members - 1);
+		id = (self + 1 + id) % members;
+		if (!sim_failed(id) || *sim_view(self, id) != SWIM_MEMBER_DEAD)
+			return id;
+	}
+	return SWIM_ID_INVALID;
+}
+
+static int
+sim_ping(swim_id_t self, swim_id_t to)
+{
+	struct swim_member_update	 upd;
+	struct swim_member_update	*upds;
+	size_t				 nupds;
+	int				 rc;
+
+	if (sim_failed(to)) {
+		if (*sim_view(self, to) != SWIM_MEMBER_ALIVE)
+			return 0;
+
+		/* no reply: suspect the target */
+		upd.smu_id = to;
+		upd.smu_state.sms_incarnation = s.s_inc[to];
+		upd.smu_state.sms_status = SWIM_MEMBER_SUSPECT;
+		upd.smu_state.sms_delay = 0;
+		return swim_updates_parse(s.s_ctx[self], self, self, &upd, 1);
+	}
+
+	rc = swim_updates_prepare(s.s_ctx[self], to, to, &upds, &nupds);
+	if (rc)
+		return rc;
+	rc = sim_deliver(s.s_ctx[to], self, upds, nupds);
+	D_FREE(upds);
+	if (rc)
+		return rc;
+
+	rc = swim_updates_prepare(s.s_ctx[to], self, self, &upds, &nupds);
+	if (rc)
+		return rc;
+	rc = sim_deliver(s.s_ctx[self], to, upds, nupds);
+	D_FREE(upds);
+	return rc;
+}
+
+static uint32_t
+sim_informed(void)
+{
+	uint32_t	informed = 0;
+	uint32_t	i, j;
+
+	for (i = 0; i < members; i++) {
+		if (sim_failed(i))
+			continue;
+		for (j = 0; j < failures; j++) {
+			if (s.s_view[i * failures + j] == SWIM_MEMBER_ALIVE)
+				break;
+		}
+		if (j == failures)
+			informed++;
+	}
+	return informed;
+}
+
+static int
+sim_run(uint64_t entries_max, struct sim_result *res)
+{
+	uint64_t	base = d_hlc_get();
+	uint32_t	alive = members - failures;
+	uint32_t	informed = 0;
+	uint32_t	period;
+	uint32_t	i;
+	int		rc = 0;
+
+	memset(&s, 0, sizeof(s));
+	D_ALLOC_ARRAY(s.s_ctx, members);
+	D_ALLOC_ARRAY(s.s_inc, members);
+	D_ALLOC_ARRAY(s.s_view, (size_t)members * failures);
+	D_ALLOC_ARRAY(s.s_perm_a, members);
+	D_ALLOC_ARRAY(s.s_perm_b, members);
+	if (s.s_ctx == NULL || s.s_inc == NULL || s.s_view == NULL ||
+	    s.s_perm_a == NULL || s.s_perm_b == NULL)
+		D_GOTO(out, rc = -DER_NOMEM);
+
+	srand(seed);
+	s.s_fail_first = rand() % (members - failures + 1);
+	for (i = 0; i < members; i++) {
+		/* the engines started within a minute */
+		s.s_inc[i] = base + d_sec2hlc(rand() % 60);
+		/* a multiplier coprime to (members - 1) gives a permutation */
+		do {
+			s.s_perm_a[i] = 1 + rand() % (members - 1);
+		} while (members > 2 && sim_gcd(s.s_perm_a[i], members - 1) != 1);
+		s.s_perm_b[i] = rand() % (members - 1);
+
+		s.s_ctx[i] = swim_init(i, &sim_ops, NULL);
+		if (s.s_ctx[i] == NULL)
+			D_GOTO(out, rc = -DER_NOMEM);
+		s.s_ctx[i]->sc_piggyback_max = entries_max;
+	}
+
+	for (period = 0; period < periods; period++) {
+		for (i = 0; i < members; i++) {
+			swim_id_t	to;
+
+			if (sim_failed(i))
+				continue;
+			to = sim_target(i, period);
+			if (to == SWIM_ID_INVALID)
+				continue;
+			rc = sim_ping(i, to);
+			if (rc && rc != -DER_ALREADY)
+				D_GOTO(out, rc);
+			rc = 0;
+		}
+
+		informed = sim_informed();
+		if (verbose)
+			printf("period %4u: %u/%u members informed, %lu msgs, %lu bytes\n",
+			       period + 1, informed, alive, s.s_res.sr_msgs, s.s_res.sr_bytes);
+		if (informed == alive)
+			break;
+	}
+
+	*res = s.s_res;
+	res->sr_periods = informed == alive ? period + 1 : 0;
+out:
+	if (s.s_ctx != NULL) {
+		for (i = 0; i < members; i++)
+			swim_fini(s.s_ctx[i]);
+	}
+	D_FREE(s.s_ctx);
+	D_FREE(s.s_inc);
+	D_FREE(s.s_view);
+	D_FREE(s.s_perm_a);
+	D_FREE(s.s_perm_b);
+	return rc;
+}
+
+static void
+show_usage(const char *prog)
+{
+	printf("Usage: %s [options]\n", prog);
+	printf("Options:\n"
+	       "  -m, --members <n>   members to simulate, default 10000\n"
+	       "  -f, --failures <n>  members failing together, default 64\n"
+	       "  -p, --periods <n>   protocol periods to simulate at most, default 200\n"
+	       "  -s, --seed <n>      random seed, default 1\n"
+	       "  -v, --verbose       show the progress of every period\n"
+	       "  -h, --help\n");
+}
+
+int
+main(int argc, char **argv)
+{
+	static const uint64_t	 entries[] = { SWIM_PIGGYBACK_ENTRIES,
+					       SWIM_PIGGYBACK_ENTRIES_MAX };
+	struct option		 long_options[] = {
+		{"members",	required_argument,	NULL,	'm'},
+		{"failures",	required_argument,	NULL,	'f'},
+		{"periods",	required_argument,	NULL,	'p'},
+		{"seed",	required_argument,	NULL,	's'},
+		{"verbose",	no_argument,		NULL,	'v'},
+		{"help",	no_argument,		NULL,	'h'},
+		{NULL,		0,			NULL,	0}
+	};
+	struct sim_result	 res;
+	uint64_t		 period_ms;
+	uint64_t		 member_periods;
+	int			 opt;
+	int			 i;
+	int			 rc;
+
+	while ((opt = getopt_long(argc, argv, "m:f:p:s:vh", long_options, NULL)) != -1) {
+		switch (opt) {
+		case 'm':
+			members = atoi(optarg);
+			break;
+		case 'f':
+			failures = atoi(optarg);
+			break;
+		case 'p':
+			periods = atoi(optarg);
+			break;
+		case 's':
+			seed = atoi(optarg);
+			break;
+		case 'v':
+			verbose = 1;
+			break;
+		case 'h':
+		default:
+			show_usage(argv[0]);
+			return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+
+	if (members < MEMBERS_MIN || members > MEMBERS_MAX || failures == 0 ||
+	    failures >= members || periods == 0 || periods > PERIODS_MAX) {
+		show_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	rc = d_log_init();
+	if (rc != 0) {
+		fprintf(stderr, "d_log_init failed: "DF_RC"\n", DP_RC(rc));
+		return EXIT_FAILURE;
+	}
+
+	printf("%8s %8s %8s %8s %10s %10s %14s %14s %8s\n", "members", "failed", "entries",
+	       "periods", "time_s", "upds_msg", "bytes_mbr_per", "raw_mbr_per", "false");
+	for (i = 0; i < ARRAY_SIZE(entries); i++) {
+		rc = sim_run(entries[i], &res);
+		if (rc != 0) {
+			fprintf(stderr, "simulation failed: "DF_RC"\n", DP_RC(rc));
+			break;
+		}
+
+		/* swim_init() sets the period length from the environment */
+		period_ms = swim_period_get();
+		member_periods = (uint64_t)(members - failures) *
+				 (res.sr_periods ? res.sr_periods : periods);
+		printf("%8u %8u %8lu %8u %10.1f %10.2f %14.1f %14.1f %8lu\n", members, failures,
+		       entries[i], res.sr_periods, res.sr_periods * period_ms / 1000.0,
+		       res.sr_msgs ? (double)res.sr_upds / res.sr_msgs : 0.0,
+		       (double)res.sr_bytes / member_periods,
+		       (double)res.sr_raw_bytes / member_periods, res.sr_false);
+		if (res.sr_periods == 0) {
+			fprintf(stderr, "not converged in %u periods\n", periods);
+			rc = -DER_TIMEDOUT;
+			break;
+		}
+	}
+
+	d_log_fini();
+	return rc == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
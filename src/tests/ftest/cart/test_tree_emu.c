@@ -0,0 +1,400 @@
+/*
+ * (C) Copyright 2023 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+/**
+ * Emulation of the collective RPC trees over a simulated topology (ranks per
+ * node, nodes per rack). For each tree type it reports the tree depth (hops),
+ * the count of the edges crossing nodes and racks, and the completion latency
+ * of a broadcast with a simple cost model: forwarding to each child costs
+ * a fixed send overhead, then the link latency depends on whether the child
+ * is on the same node, the same rack or another rack.
+ *
+ * It also verifies the domain tree: for a set of roots, every rank is reached
+ * exactly once and the parent of each rank lists it as a child.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+
+#include <gurt/common.h>
+#include <cart/api.h>
+
+#include "../../../cart/crt_internal.h"
+
+#define RANKS_MIN	2
+#define RANKS_MAX	100000
+
+static uint32_t	ranks_per_node = 4;
+static uint32_t	nodes_per_rack = 16;
+static uint32_t	branch_ratio = 4;
+/* in nanoseconds */
+static uint64_t	lat_send = 2000;
+static uint64_t	lat_node = 1000;
+static uint64_t	lat_rack = 3000;
+static uint64_t	lat_cross = 12000;
+
+struct emu_result {
+	uint32_t	er_depth;
+	uint32_t	er_xnode;
+	uint32_t	er_xrack;
+	uint64_t	er_hops;
+	uint64_t	er_latency;
+};
+
+struct emu_tree {
+	int			 et_type;
+	uint32_t		 et_size;
+	struct crt_dom_tree	 et_dom;
+};
+
+/*
+ * Ranks of the same node are not adjacent in the rank space, that is the
+ * usual case when the ranks are assigned by the join order.
+ */
+static inline uint32_t
+emu_node(uint32_t size, uint32_t rank)
+{
+	return (uint32_t)(((uint64_t)rank * 7919) % size) / ranks_per_node;
+}
+
+static int
+emu_children(struct emu_tree *et, uint32_t root, uint32_t self, uint32_t *children,
+	     uint32_t *nr)
+{
+	struct crt_topo_ops	*tops;
+	int			 rc;
+
+	if (et->et_type == CRT_TREE_DOMAIN)
+		return crt_dom_tree_children(&et->et_dom, root, self, children, nr);
+
+	tops = crt_tops[et->et_type];
+	rc = tops->to_get_children_cnt(et->et_size, branch_ratio, root, self, nr);
+	if (rc != 0 || *nr == 0)
+		return rc;
+
+	return tops->to_get_children(et->et_size, branch_ratio, root, self, children);
+}
+
+static void
+emu_domains(uint32_t size, uint32_t *doms)
+{
+	uint32_t	i;
+
+	for (i = 0; i < size; i++) {
+		doms[i * 2] = emu_node(size, i) / nodes_per_rack;
+		doms[i * 2 + 1] = emu_node(size, i);
+	}
+}
+
+/*
+ * Walk the domain tree rooted at @root, check that each rank is reached once,
+ * that the count query matches the children list, and that the parent query
+ * agrees with the children queries.
+ */
+static int
+emu_verify_root(struct emu_tree *et, uint32_t root, uint32_t *parent,
+		uint32_t *queue, uint32_t *children)
+{
+	uint32_t	head = 0;
+	uint32_t	tail = 0;
+	uint32_t	self;
+	uint32_t	nr;
+	uint32_t	cnt;
+	uint32_t	i;
+	int		rc;
+
+	for (i = 0; i < et->et_size; i++)
+		parent[i] = CRT_NO_RANK;
+
+	parent[root] = root;
+	queue[tail++] = root;
+	while (head < tail) {
+		self = queue[head++];
+
+		rc = crt_dom_tree_children(&et->et_dom, root, self, NULL, &cnt);
+		if (rc != 0)
+			return rc;
+
+		rc = emu_children(et, root, self, children, &nr);
+		if (rc != 0)
+			return rc;
+
+		if (cnt != nr) {
+			fprintf(stderr, "root %u self %u: %u children, count %u\n",
+				root, self, nr, cnt);
+			return -DER_INVAL;
+		}
+
+		for (i = 0; i < nr; i++) {
+			if (children[i] >= et->et_size || parent[children[i]] != CRT_NO_RANK) {
+				fprintf(stderr, "root %u: rank %u reached twice\n", root,
+					children[i]);
+				return -DER_INVAL;
+			}
+			parent[children[i]] = self;
+			queue[tail++] = children[i];
+		}
+	}
+
+	if (tail != et->et_size) {
+		fprintf(stderr, "root %u: reached %u/%u ranks\n", root, tail, et->et_size);
+		return -DER_INVAL;
+	}
+
+	rc = crt_dom_tree_parent(&et->et_dom, root, root, &self);
+	if (rc != -DER_INVAL) {
+		fprintf(stderr, "root %u has parent: %d\n", root, rc);
+		return -DER_INVAL;
+	}
+
+	for (i = 0; i < et->et_size; i++) {
+		if (i == root)
+			continue;
+
+		rc = crt_dom_tree_parent(&et->et_dom, root, i, &self);
+		if (rc != 0)
+			return rc;
+
+		if (self != parent[i]) {
+			fprintf(stderr, "root %u rank %u: parent %u, expected %u\n",
+				root, i, self, parent[i]);
+			return -DER_INVAL;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Verify the domain tree of @size ranks with the roots in each rack, on the
+ * first and the last rank of the nodes, and a few others.
+ */
+static int
+emu_verify(uint32_t size)
+{
+	struct emu_tree	 et = { .et_type = CRT_TREE_DOMAIN, .et_size = size };
+	uint32_t	*doms = NULL;
+	uint32_t	*parent = NULL;
+	uint32_t	*queue = NULL;
+	uint32_t	*children = NULL;
+	uint32_t	 step;
+	uint32_t	 root;
+	int		 rc;
+
+	D_ALLOC_ARRAY(doms, size * 2);
+	D_ALLOC_ARRAY(parent, size);
+	D_ALLOC_ARRAY(queue, size);
+	D_ALLOC_ARRAY(children, size);
+	if (doms == NULL || parent == NULL || queue == NULL || children == NULL)
+		D_GOTO(out, rc = -DER_NOMEM);
+
+	emu_domains(size, doms);
+	rc = crt_dom_tree_init(&et.et_dom, size, 2, doms, branch_ratio);
+	if (rc != 0)
+		goto out;
+
+	step = max(size / 17, 1);
+	for (root = 0; root < size; root += step) {
+		rc = emu_verify_root(&et, root, parent, queue, children);
+		if (rc != 0)
+			goto fini;
+	}
+
+	rc = emu_verify_root(&et, size - 1, parent, queue, children);
+
+fini:
+	crt_dom_tree_fini(&et.et_dom);
+out:
+	D_FREE(doms);
+	D_FREE(parent);
+	D_FREE(queue);
+	D_FREE(children);
+	return rc;
+}
+
+static int
+emu_run(int type, uint32_t size, struct emu_result *res)
+{
+	struct emu_tree	 et = { .et_type = type, .et_size = size };
+	uint32_t	*doms = NULL;
+	uint32_t	*depth = NULL;
+	uint64_t	*arrive = NULL;
+	uint32_t	*queue = NULL;
+	uint32_t	*children = NULL;
+	uint32_t	 head = 0;
+	uint32_t	 tail = 0;
+	uint32_t	 nr;
+	uint32_t	 i;
+	int		 rc = 0;
+
+	memset(res, 0, sizeof(*res));
+
+	D_ALLOC_ARRAY(doms, size * 2);
+	D_ALLOC_ARRAY(depth, size);
+	D_ALLOC_ARRAY(arrive, size);
+	D_ALLOC_ARRAY(queue, size);
+	D_ALLOC_ARRAY(children, size);
+	if (doms == NULL || depth == NULL || arrive == NULL || queue == NULL ||
+	    children == NULL)
+		D_GOTO(out, rc = -DER_NOMEM);
+
+	emu_domains(size, doms);
+
+	if (type == CRT_TREE_DOMAIN) {
+		rc = crt_dom_tree_init(&et.et_dom, size, 2, doms, branch_ratio);
+		if (rc != 0)
+			goto out;
+	}
+
+	queue[tail++] = 0;
+	while (head < tail) {
+		uint32_t	self = queue[head++];
+		uint64_t	now = arrive[self];
+
+		rc = emu_children(&et, 0, self, children, &nr);
+		if (rc != 0)
+			goto fini;
+
+		for (i = 0; i < nr; i++) {
+			uint32_t	child = children[i];
+
+			D_ASSERT(tail < size);
+			now += lat_send;
+			if (doms[self * 2] != doms[child * 2]) {
+				res->er_xrack++;
+				arrive[child] = now + lat_cross;
+			} else if (doms[self * 2 + 1] != doms[child * 2 + 1]) {
+				res->er_xnode++;
+				arrive[child] = now + lat_rack;
+			} else {
+				arrive[child] = now + lat_node;
+			}
+
+			depth[child] = depth[self] + 1;
+			res->er_hops += depth[child];
+			res->er_depth = max(res->er_depth, depth[child]);
+			res->er_latency = max(res->er_latency, arrive[child]);
+			queue[tail++] = child;
+		}
+	}
+
+	if (tail != size) {
+		fprintf(stderr, "tree %d reached %u/%u ranks\n", type, tail, size);
+		rc = -DER_INVAL;
+	}
+
+fini:
+	if (type == CRT_TREE_DOMAIN)
+		crt_dom_tree_fini(&et.et_dom);
+out:
+	D_FREE(doms);
+	D_FREE(depth);
+	D_FREE(arrive);
+	D_FREE(queue);
+	D_FREE(children);
+	return rc;
+}
+
+static void
+show_usage(const char *prog)
+{
+	printf("Usage: %s [options]\n", prog);
+	printf("Options:\n"
+	       "  -r, --ranks <min:max:step>  ranks to emulate, default 1000:10000:1000\n"
+	       "  -n, --ranks_per_node <n>    default 4\n"
+	       "  -k, --nodes_per_rack <n>    default 16\n"
+	       "  -b, --branch_ratio <n>      default 4\n"
+	       "  -h, --help\n");
+}
+
+int
+main(int argc, char **argv)
+{
+	static const char *const names[] = {
+		[CRT_TREE_KARY]		= "kary",
+		[CRT_TREE_KNOMIAL]	= "knomial",
+		[CRT_TREE_DOMAIN]	= "domain",
+	};
+	struct option		 long_options[] = {
+		{"ranks",		required_argument,	NULL,	'r'},
+		{"ranks_per_node",	required_argument,	NULL,	'n'},
+		{"nodes_per_rack",	required_argument,	NULL,	'k'},
+		{"branch_ratio",	required_argument,	NULL,	'b'},
+		{"help",		no_argument,		NULL,	'h'},
+		{NULL,			0,			NULL,	0}
+	};
+	struct emu_result	 res;
+	uint32_t		 rmin = 1000;
+	uint32_t		 rmax = 10000;
+	uint32_t		 rstep = 1000;
+	uint32_t		 size;
+	int			 type;
+	int			 opt;
+	int			 rc;
+
+	while ((opt = getopt_long(argc, argv, "r:n:k:b:h", long_options, NULL)) != -1) {
+		switch (opt) {
+		case 'r':
+			if (sscanf(optarg, "%u:%u:%u", &rmin, &rmax, &rstep) != 3) {
+				show_usage(argv[0]);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'n':
+			ranks_per_node = atoi(optarg);
+			break;
+		case 'k':
+			nodes_per_rack = atoi(optarg);
+			break;
+		case 'b':
+			branch_ratio = atoi(optarg);
+			break;
+		case 'h':
+		default:
+			show_usage(argv[0]);
+			return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+
+	if (rmin < RANKS_MIN || rmax > RANKS_MAX || rmin > rmax || rstep == 0 ||
+	    ranks_per_node == 0 || nodes_per_rack == 0 ||
+	    branch_ratio < CRT_TREE_MIN_RATIO || branch_ratio > CRT_TREE_MAX_RATIO) {
+		show_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	rc = d_log_init();
+	if (rc != 0) {
+		fprintf(stderr, "d_log_init failed: "DF_RC"\n", DP_RC(rc));
+		return EXIT_FAILURE;
+	}
+
+	printf("%8s %8s %6s %10s %8s %8s %12s\n", "ranks", "tree", "depth",
+	       "avg_hops", "x_node", "x_rack", "latency_us");
+	for (size = rmin; size <= rmax; size += rstep) {
+		rc = emu_verify(size);
+		if (rc != 0) {
+			fprintf(stderr, "domain tree of %u ranks is broken: "DF_RC"\n", size,
+				DP_RC(rc));
+			goto out;
+		}
+
+		for (type = CRT_TREE_KARY; type <= CRT_TREE_DOMAIN; type++) {
+			rc = emu_run(type, size, &res);
+			if (rc != 0) {
+				fprintf(stderr, "emulation failed: "DF_RC"\n", DP_RC(rc));
+				goto out;
+			}
+
+			printf("%8u %8s %6u %10.2f %8u %8u %12.1f\n", size, names[type],
+			       res.er_depth, (double)res.er_hops / (size - 1),
+			       res.er_xnode, res.er_xrack, res.er_latency / 1000.0);
+		}
+	}
+
+out:
+	d_log_fini();
+	return rc == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,268 @@
+/*
+ * (C) Copyright 2023 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+/**
+ * This file is part of CaRT testing. It tests the cache of the IV values
+ * leased by the root, see crt_iv_lease.c.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+
+#include <cmocka.h>
+
+#include <cart/api.h>
+#include "../cart/crt_internal.h"
+
+#define TEST_CLASS	3
+
+static struct crt_iv_lease_cache	 test_cache;
+static struct crt_iv_ops		 test_ops;
+
+struct test_key {
+	uint32_t	tk_id;
+	/* ignored by test_keys_match(), like the buffer size of a fetch */
+	uint32_t	tk_size;
+};
+
+static void
+key_set(crt_iv_key_t *key, struct test_key *tk, uint32_t id, uint32_t size)
+{
+	tk->tk_id = id;
+	tk->tk_size = size;
+	d_iov_set(key, tk, sizeof(*tk));
+}
+
+static void
+value_set(d_sg_list_t *sgl, d_iov_t *iov, char *buf, size_t len)
+{
+	d_iov_set(iov, buf, len);
+	sgl->sg_nr = 1;
+	sgl->sg_nr_out = 0;
+	sgl->sg_iovs = iov;
+}
+
+static uint32_t
+lease_remain(struct test_key *tk)
+{
+	crt_iv_key_t	key;
+
+	d_iov_set(&key, tk, sizeof(*tk));
+	return crt_iv_lease_remain(&test_cache, NULL, &test_ops, TEST_CLASS, &key);
+}
+
+static void
+lease_install(uint32_t id, const char *str, uint32_t lease_ms)
+{
+	struct test_key	tk;
+	crt_iv_key_t	key;
+	d_sg_list_t	sgl;
+	d_iov_t		iov;
+	char		buf[32] = { 0 };
+
+	strncpy(buf, str, sizeof(buf) - 1);
+	key_set(&key, &tk, id, sizeof(buf));
+	value_set(&sgl, &iov, buf, sizeof(buf));
+	crt_iv_lease_install(&test_cache, NULL, &test_ops, TEST_CLASS, &key, &sgl,
+			     lease_ms, crt_iv_lease_ver(&test_cache));
+}
+
+static bool
+test_keys_match(crt_iv_namespace_t ivns, crt_iv_key_t *key1, crt_iv_key_t *key2)
+{
+	return ((struct test_key *)key1->iov_buf)->tk_id ==
+	       ((struct test_key *)key2->iov_buf)->tk_id;
+}
+
+/* The installed value is served until its lease expires */
+static void
+test_lease_install(void **state)
+{
+	struct test_key	tk;
+	crt_iv_key_t	key;
+	d_sg_list_t	sgl;
+	d_iov_t		iov;
+	char		buf[64];
+	uint32_t	remain;
+	int		rc;
+
+	lease_install(1, "potato", 10000);
+
+	key_set(&key, &tk, 1, 32);
+	remain = lease_remain(&tk);
+	assert_true(remain > 0 && remain <= 10000);
+
+	memset(buf, 0xff, sizeof(buf));
+	value_set(&sgl, &iov, buf, sizeof(buf));
+	rc = crt_iv_lease_copy(&test_cache, NULL, &test_ops, TEST_CLASS, &key, &sgl);
+	assert_int_equal(rc, 0);
+	assert_int_equal(iov.iov_len, 32);
+	assert_string_equal(buf, "potato");
+
+	/* not large enough to hold the leased value */
+	value_set(&sgl, &iov, buf, 16);
+	rc = crt_iv_lease_copy(&test_cache, NULL, &test_ops, TEST_CLASS, &key, &sgl);
+	assert_int_equal(rc, -DER_NONEXIST);
+
+	/* other class or key */
+	rc = crt_iv_lease_remain(&test_cache, NULL, &test_ops, TEST_CLASS + 1, &key);
+	assert_int_equal(rc, 0);
+	key_set(&key, &tk, 2, 32);
+	assert_int_equal(lease_remain(&tk), 0);
+
+	/* without ivo_keys_match all of the key is compared */
+	key_set(&key, &tk, 1, 64);
+	assert_int_equal(lease_remain(&tk), 0);
+
+	/* re-installed value replaces the old one */
+	lease_install(1, "carrot", 10000);
+	key_set(&key, &tk, 1, 32);
+	value_set(&sgl, &iov, buf, sizeof(buf));
+	rc = crt_iv_lease_copy(&test_cache, NULL, &test_ops, TEST_CLASS, &key, &sgl);
+	assert_int_equal(rc, 0);
+	assert_string_equal(buf, "carrot");
+	assert_int_equal(test_cache.ilc_nr, 1);
+}
+
+/* Update, sync and invalidation break the lease and the in-flight fetches */
+static void
+test_lease_break(void **state)
+{
+	struct test_key	tk;
+	crt_iv_key_t	key;
+	d_sg_list_t	sgl;
+	d_iov_t		iov;
+	char		buf[32] = "potato";
+	uint64_t	ver;
+
+	lease_install(1, "potato", 10000);
+	lease_install(2, "turnip", 10000);
+
+	key_set(&key, &tk, 1, 32);
+	crt_iv_lease_break(&test_cache, NULL, &test_ops, TEST_CLASS, &key);
+	assert_int_equal(lease_remain(&tk), 0);
+	key_set(&key, &tk, 2, 32);
+	assert_true(lease_remain(&tk) > 0);
+
+	/* a fetch issued before the break does not install its value */
+	ver = crt_iv_lease_ver(&test_cache);
+	key_set(&key, &tk, 3, 32);
+	crt_iv_lease_break(&test_cache, NULL, &test_ops, TEST_CLASS, &key);
+	value_set(&sgl, &iov, buf, sizeof(buf));
+	crt_iv_lease_install(&test_cache, NULL, &test_ops, TEST_CLASS, &key, &sgl,
+			     10000, ver);
+	assert_int_equal(lease_remain(&tk), 0);
+
+	crt_iv_lease_install(&test_cache, NULL, &test_ops, TEST_CLASS, &key, &sgl,
+			     10000, crt_iv_lease_ver(&test_cache));
+	assert_true(lease_remain(&tk) > 0);
+
+	/* the keys of different size match through ivo_keys_match */
+	test_ops.ivo_keys_match = test_keys_match;
+	key_set(&key, &tk, 3, 0);
+	assert_true(lease_remain(&tk) > 0);
+	crt_iv_lease_break(&test_cache, NULL, &test_ops, TEST_CLASS, &key);
+	key_set(&key, &tk, 3, 32);
+	assert_int_equal(lease_remain(&tk), 0);
+	test_ops.ivo_keys_match = NULL;
+}
+
+/* Expired lease is dropped, no value is served from it */
+static void
+test_lease_expire(void **state)
+{
+	struct test_key	tk;
+	crt_iv_key_t	key;
+	d_sg_list_t	sgl;
+	d_iov_t		iov;
+	char		buf[32];
+	int		rc;
+
+	lease_install(1, "potato", 1);
+	lease_install(2, "turnip", 10000);
+	assert_int_equal(test_cache.ilc_nr, 2);
+	usleep(5000);
+
+	key_set(&key, &tk, 1, 32);
+	value_set(&sgl, &iov, buf, sizeof(buf));
+	rc = crt_iv_lease_copy(&test_cache, NULL, &test_ops, TEST_CLASS, &key, &sgl);
+	assert_int_equal(rc, -DER_NONEXIST);
+
+	assert_int_equal(lease_remain(&tk), 0);
+	assert_int_equal(test_cache.ilc_nr, 1);
+
+	key_set(&key, &tk, 2, 32);
+	assert_true(lease_remain(&tk) > 0);
+}
+
+/* Too large values are not leased */
+static void
+test_lease_large(void **state)
+{
+	struct test_key	tk;
+	crt_iv_key_t	key;
+	d_sg_list_t	sgl;
+	d_iov_t		iov;
+	char		*buf;
+	size_t		len = 1 << 20;
+
+	D_ALLOC(buf, len);
+	assert_non_null(buf);
+
+	key_set(&key, &tk, 1, len);
+	value_set(&sgl, &iov, buf, len);
+	crt_iv_lease_install(&test_cache, NULL, &test_ops, TEST_CLASS, &key, &sgl,
+			     10000, crt_iv_lease_ver(&test_cache));
+	assert_int_equal(lease_remain(&tk), 0);
+	assert_int_equal(test_cache.ilc_nr, 0);
+
+	D_FREE(buf);
+}
+
+static int
+test_setup(void **state)
+{
+	memset(&test_ops, 0, sizeof(test_ops));
+	return crt_iv_lease_cache_init(&test_cache);
+}
+
+static int
+test_teardown(void **state)
+{
+	crt_iv_lease_cache_fini(&test_cache);
+	return 0;
+}
+
+static int
+init_tests(void **state)
+{
+	return d_log_init();
+}
+
+static int
+fini_tests(void **state)
+{
+	d_log_fini();
+	return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test_setup_teardown(test_lease_install, test_setup, test_teardown),
+		cmocka_unit_test_setup_teardown(test_lease_break, test_setup, test_teardown),
+		cmocka_unit_test_setup_teardown(test_lease_expire, test_setup, test_teardown),
+		cmocka_unit_test_setup_teardown(test_lease_large, test_setup, test_teardown),
+	};
+
+	d_register_alt_assert(mock_assert);
+
+	return cmocka_run_group_tests_name("utest_iv_lease", tests, init_tests,
+					   fini_tests);
+}
@@ -0,0 +1,220 @@
+/*
+ * (C) Copyright 2023 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+/**
+ * This file is part of CaRT testing. It tests the adaptive network progress:
+ * the moving average of the completion inter-arrival time, the mode selection
+ * and the spin loop, see crt_progress_wait().
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+
+#include <cmocka.h>
+
+#include <cart/api.h>
+#include "../cart/crt_internal.h"
+
+#define TEST_SPIN_GAP	20
+#define TEST_BLOCK_GAP	200
+#define TEST_GAP_MAX	(TEST_BLOCK_GAP * 4)
+
+struct test_prog {
+	struct crt_prog_adapt	*tp_pa;
+	/* number of calls of the progress callback */
+	int			 tp_calls;
+	/* trigger a completion on this call, never if 0 */
+	int			 tp_complete;
+	/* returned by the progress callback */
+	int			 tp_rc;
+};
+
+/* Mimic a non-blocking progress observing its completions */
+static int
+test_progress(void *arg)
+{
+	struct test_prog	*tp = arg;
+
+	tp->tp_calls++;
+	if (tp->tp_calls == tp->tp_complete)
+		crt_prog_gap_update(tp->tp_pa, tp->tp_pa->pa_completed + 1,
+				    d_timeus_secdiff(0), TEST_GAP_MAX);
+	return tp->tp_rc;
+}
+
+static void
+test_prog_ewma(void **state)
+{
+	struct crt_prog_adapt	pa = { 0 };
+	uint64_t		now = 1000000;
+	uint64_t		gap;
+	int			i;
+
+	pa.pa_last = now;
+
+	/* no completion, nothing changes */
+	crt_prog_gap_update(&pa, 0, now + 100, TEST_GAP_MAX);
+	assert_int_equal(pa.pa_gap, 0);
+	assert_int_equal(pa.pa_last, now);
+
+	/* converges to the steady inter-arrival time */
+	for (i = 1; i <= 100; i++) {
+		now += 100;
+		crt_prog_gap_update(&pa, i, now, TEST_GAP_MAX);
+	}
+	assert_int_equal(pa.pa_completed, 100);
+	assert_int_equal(pa.pa_last, now);
+	assert_true(pa.pa_gap > 90 && pa.pa_gap <= 100);
+
+	/* several completions in one observation count as many samples */
+	gap = pa.pa_gap;
+	now += 10 * 10;
+	crt_prog_gap_update(&pa, pa.pa_completed + 10, now, TEST_GAP_MAX);
+	assert_true(pa.pa_gap < gap);
+	assert_int_equal(pa.pa_gap, gap - (gap >> CRT_PROG_EWMA_SHIFT) +
+			 (10 >> CRT_PROG_EWMA_SHIFT));
+
+	/* the gap after an idle period is capped */
+	gap = pa.pa_gap;
+	now += 1000000;
+	crt_prog_gap_update(&pa, pa.pa_completed + 1, now, TEST_GAP_MAX);
+	assert_int_equal(pa.pa_gap, gap - (gap >> CRT_PROG_EWMA_SHIFT) +
+			 (TEST_GAP_MAX >> CRT_PROG_EWMA_SHIFT));
+	assert_true(pa.pa_gap <= TEST_GAP_MAX);
+}
+
+static void
+test_prog_mode(void **state)
+{
+	assert_int_equal(crt_prog_mode_select(0, TEST_SPIN_GAP, TEST_BLOCK_GAP),
+			 CRT_PROG_SPIN);
+	assert_int_equal(crt_prog_mode_select(TEST_SPIN_GAP - 1, TEST_SPIN_GAP,
+					      TEST_BLOCK_GAP), CRT_PROG_SPIN);
+	assert_int_equal(crt_prog_mode_select(TEST_SPIN_GAP, TEST_SPIN_GAP,
+					      TEST_BLOCK_GAP), CRT_PROG_SPIN_SLEEP);
+	assert_int_equal(crt_prog_mode_select(TEST_BLOCK_GAP - 1, TEST_SPIN_GAP,
+					      TEST_BLOCK_GAP), CRT_PROG_SPIN_SLEEP);
+	assert_int_equal(crt_prog_mode_select(TEST_BLOCK_GAP, TEST_SPIN_GAP,
+					      TEST_BLOCK_GAP), CRT_PROG_BLOCK);
+	assert_int_equal(crt_prog_mode_select(TEST_GAP_MAX, TEST_SPIN_GAP,
+					      TEST_BLOCK_GAP), CRT_PROG_BLOCK);
+}
+
+static void
+test_prog_spin_complete(void **state)
+{
+	struct crt_prog_adapt	pa = { 0 };
+	struct test_prog	tp = { .tp_pa = &pa, .tp_complete = 5 };
+	int64_t			timeout = 10000000;
+	int			rc;
+
+	pa.pa_last = d_timeus_secdiff(0);
+	rc = crt_prog_spin(&pa, 10000000, &timeout, test_progress, &tp);
+	assert_int_equal(rc, 0);
+	assert_int_equal(tp.tp_calls, 5);
+	assert_int_equal(pa.pa_completed, 1);
+
+	/* a progress timing out without any completion keeps spinning */
+	memset(&pa, 0, sizeof(pa));
+	tp.tp_calls = 0;
+	tp.tp_rc = -DER_TIMEDOUT;
+	pa.pa_last = d_timeus_secdiff(0);
+	rc = crt_prog_spin(&pa, 10000000, &timeout, test_progress, &tp);
+	assert_int_equal(rc, 0);
+	assert_int_equal(tp.tp_calls, 5);
+}
+
+static void
+test_prog_spin_timeout(void **state)
+{
+	struct crt_prog_adapt	pa = { 0 };
+	struct test_prog	tp = { .tp_pa = &pa };
+	int64_t			timeout = 2000;
+	uint64_t		start;
+	int			rc;
+
+	start = d_timeus_secdiff(0);
+	pa.pa_last = start;
+	rc = crt_prog_spin(&pa, 10000000, &timeout, test_progress, &tp);
+	assert_int_equal(rc, -DER_TIMEDOUT);
+	assert_true(d_timeus_secdiff(0) - start >= 2000);
+	assert_true(tp.tp_calls > 0);
+	assert_int_equal(pa.pa_completed, 0);
+}
+
+static void
+test_prog_spin_idle(void **state)
+{
+	struct crt_prog_adapt	pa = { 0 };
+	struct test_prog	tp = { .tp_pa = &pa };
+	int64_t			timeout = 10000000;
+	int64_t			infinite = -1;
+	int			rc;
+
+	/* idle for the spin period already, fall back to blocking at once */
+	pa.pa_last = d_timeus_secdiff(0) - TEST_SPIN_GAP;
+	rc = crt_prog_spin(&pa, TEST_SPIN_GAP, &timeout, test_progress, &tp);
+	assert_int_equal(rc, 1);
+	assert_int_equal(tp.tp_calls, 1);
+	assert_true(timeout <= 10000000 && timeout > 0);
+
+	/* spin for the period since the last completion */
+	tp.tp_calls = 0;
+	pa.pa_last = d_timeus_secdiff(0);
+	rc = crt_prog_spin(&pa, 1000, &infinite, test_progress, &tp);
+	assert_int_equal(rc, 1);
+	assert_true(d_timeus_secdiff(0) - pa.pa_last >= 1000);
+	assert_true(tp.tp_calls > 0);
+	assert_int_equal(infinite, -1);
+}
+
+static void
+test_prog_spin_error(void **state)
+{
+	struct crt_prog_adapt	pa = { 0 };
+	struct test_prog	tp = { .tp_pa = &pa, .tp_rc = -DER_HG };
+	int64_t			timeout = 10000000;
+	int			rc;
+
+	pa.pa_last = d_timeus_secdiff(0);
+	rc = crt_prog_spin(&pa, 10000000, &timeout, test_progress, &tp);
+	assert_int_equal(rc, -DER_HG);
+	assert_int_equal(tp.tp_calls, 1);
+	assert_int_equal(timeout, 10000000);
+}
+
+static int
+init_tests(void **state)
+{
+	return d_log_init();
+}
+
+static int
+fini_tests(void **state)
+{
+	d_log_fini();
+	return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_prog_ewma),
+		cmocka_unit_test(test_prog_mode),
+		cmocka_unit_test(test_prog_spin_complete),
+		cmocka_unit_test(test_prog_spin_timeout),
+		cmocka_unit_test(test_prog_spin_idle),
+		cmocka_unit_test(test_prog_spin_error),
+	};
+
+	d_register_alt_assert(mock_assert);
+
+	return cmocka_run_group_tests_name("utest_prog", tests, init_tests,
+					   fini_tests);
+}
@@ -50,6 +50,96 @@ test_swim(void **state)
 	assert_int_equal(rc, 0);
 }
 
+static void
+swim_pack_check(struct swim_member_update *upds, size_t nupds)
+{
+	struct swim_member_update	*out;
+	uint8_t				*buf;
+	size_t				 size = nupds * SWIM_UPDATE_PACKED_MAX;
+	size_t				 i;
+	int				 rc;
+
+	D_ALLOC(buf, size);
+	assert_non_null(buf);
+	D_ALLOC_ARRAY(out, nupds + 1);
+	assert_non_null(out);
+
+	rc = swim_updates_pack(upds, nupds, buf, &size);
+	assert_int_equal(rc, 0);
+	/* the bounds the receiver relies on to reject malformed updates */
+	assert_true(size >= nupds * SWIM_UPDATE_PACKED_MIN);
+	assert_true(size <= nupds * SWIM_UPDATE_PACKED_MAX);
+
+	rc = swim_updates_unpack(buf, size, out, nupds);
+	assert_int_equal(rc, 0);
+	for (i = 0; i < nupds; i++) {
+		assert_int_equal(out[i].smu_id, upds[i].smu_id);
+		assert_int_equal(out[i].smu_state.sms_incarnation,
+				 upds[i].smu_state.sms_incarnation);
+		assert_int_equal(out[i].smu_state.sms_status, upds[i].smu_state.sms_status);
+		assert_int_equal(out[i].smu_state.sms_delay, upds[i].smu_state.sms_delay);
+	}
+
+	/* truncated */
+	rc = swim_updates_unpack(buf, size - 1, out, nupds);
+	assert_int_equal(rc, -DER_PROTO);
+	/* more updates than packed */
+	rc = swim_updates_unpack(buf, size, out, nupds + 1);
+	assert_int_equal(rc, -DER_PROTO);
+
+	D_FREE(out);
+	D_FREE(buf);
+}
+
+static void
+test_swim_pack(void **state)
+{
+	struct swim_member_update	 upds[64];
+	uint8_t				 buf[SWIM_UPDATE_PACKED_MAX];
+	size_t				 size;
+	uint64_t			 hlc = d_hlc_get();
+	int				 i;
+	int				 rc;
+
+	/* same incarnation, adjacent IDs: the smallest packed updates */
+	for (i = 0; i < ARRAY_SIZE(upds); i++) {
+		upds[i].smu_id = i;
+		upds[i].smu_state.sms_incarnation = hlc;
+		upds[i].smu_state.sms_status = SWIM_MEMBER_ALIVE;
+		upds[i].smu_state.sms_delay = 0;
+	}
+	swim_pack_check(upds, ARRAY_SIZE(upds));
+
+	/* the extremes of every field, with negative deltas */
+	for (i = 0; i < ARRAY_SIZE(upds); i++) {
+		upds[i].smu_id = (i & 1) ? UINT64_MAX - i : i * 1000003ULL;
+		upds[i].smu_state.sms_incarnation = (i & 2) ? UINT64_MAX - i : hlc - i * 7;
+		upds[i].smu_state.sms_status = i % (SWIM_MEMBER_INACTIVE + 1);
+		upds[i].smu_state.sms_delay = (i & 4) ? UINT32_MAX : i;
+	}
+	swim_pack_check(upds, ARRAY_SIZE(upds));
+
+	/* random */
+	for (i = 0; i < ARRAY_SIZE(upds); i++) {
+		upds[i].smu_id = ((uint64_t)rand() << 32) | rand();
+		upds[i].smu_state.sms_incarnation = hlc + rand() - RAND_MAX / 2;
+		upds[i].smu_state.sms_status = rand() % (SWIM_MEMBER_INACTIVE + 1);
+		upds[i].smu_state.sms_delay = rand() % 3 == 0 ? rand() : 0;
+	}
+	swim_pack_check(upds, 1);
+	swim_pack_check(upds, ARRAY_SIZE(upds));
+
+	/* the buffer should fit the worst case */
+	size = sizeof(buf) - 1;
+	rc = swim_updates_pack(upds, 1, buf, &size);
+	assert_int_equal(rc, -DER_OVERFLOW);
+
+	/* unterminated varint */
+	memset(buf, 0xff, sizeof(buf));
+	rc = swim_updates_unpack(buf, sizeof(buf), upds, 1);
+	assert_int_equal(rc, -DER_PROTO);
+}
+
 static int
 init_tests(void **state)
 {
@@ -76,6 +166,7 @@ int main(int argc, char **argv)
 {
 	const struct CMUnitTest tests[] = {
 		cmocka_unit_test(test_swim),
+		cmocka_unit_test(test_swim_pack),
 	};
 
 	d_register_alt_assert(mock_assert);
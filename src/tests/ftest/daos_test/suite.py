@@ -157,6 +157,22 @@ class DaosCoreTest(DaosCoreBase):
         """
         self.run_subtest()
 
+    def test_daos_io_read_cache(self):
+        """Jira ID: DAOS-1568
+
+        Test Description:
+            Run daos_test -i -u 50 (IO51) with the client read cache enabled
+
+        Use cases:
+            Core tests for daos_test
+
+        :avocado: tags=all,pr,daily_regression
+        :avocado: tags=hw,medium,provider
+        :avocado: tags=daos_test,daos_core_test
+        :avocado: tags=DaosCoreTest,test_daos_io,test_daos_io_read_cache
+        """
+        self.run_subtest()
+
     def test_daos_ec_io(self):
         """Jira ID: DAOS-1568
 
@@ -128,6 +128,9 @@ class DaosCoreBase(TestWithServers):
         daos_test_env["COVFILE"] = "/tmp/test.cov"
         daos_test_env["POOL_SCM_SIZE"] = str(scm_size)
         daos_test_env["POOL_NVME_SIZE"] = str(nvme_size)
+        for item in self.get_test_param("client_env_vars", []):
+            key, value = item.split("=", 1)
+            daos_test_env[key] = value
         daos_test_cmd = cmocka_utils.get_cmocka_command(
             " ".join([self.daos_test, "-n", dmg_config_file, "".join(["-", subtest]), str(args)]))
         job = get_job_manager(self, "Orterun", daos_test_cmd, mpi_type="openmpi")
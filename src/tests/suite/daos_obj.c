@@ -5115,6 +5115,169 @@ oit_list_filter(void **state)
 	test_teardown((void **)&arg);
 }
 
+static void
+enumerate_parallel(void **state)
+{
+	test_arg_t		*arg = *state;
+	daos_handle_t		 eh;
+	daos_key_desc_t		 kds[ENUM_DESC_NR];
+	char			 buf[ENUM_DESC_BUF];
+	char			 key[ENUM_KEY_BUF];
+	d_sg_list_t		 sgl;
+	d_iov_t			 iov;
+	daos_obj_id_t		 oid;
+	struct ioreq		 req;
+	uint8_t			*seen;
+	uint32_t		 number;
+	int			 key_nr = 0;
+	bool			 eof = false;
+	char			*ptr;
+	int			 idx;
+	int			 i;
+	int			 rc;
+
+	oid = daos_test_oid_gen(arg->coh, dts_obj_class, 0, 0, arg->myrank);
+	ioreq_init(&req, arg->coh, oid, DAOS_IOD_ARRAY, arg);
+
+	print_message("Insert %d dkeys (obj:"DF_OID")\n", ENUM_KEY_REC_NR,
+		      DP_OID(oid));
+	for (i = 0; i < ENUM_KEY_REC_NR; i++) {
+		sprintf(key, "%d", i);
+		insert_single(key, "a_key", 0, "data", strlen("data") + 1,
+			      DAOS_TX_NONE, &req);
+	}
+
+	D_ALLOC(seen, ENUM_KEY_REC_NR);
+	assert_non_null(seen);
+
+	/* Small first batch, so that the batch growing and prefetch are involved */
+	print_message("Enumerate dkeys of all groups in parallel\n");
+	rc = daos_obj_list_dkey_par_open(req.oh, DAOS_TX_NONE, ENUM_DESC_NR, &eh);
+	assert_rc_equal(rc, 0);
+
+	while (!eof) {
+		number = ENUM_DESC_NR;
+		d_iov_set(&iov, buf, sizeof(buf));
+		sgl.sg_nr = 1;
+		sgl.sg_nr_out = 0;
+		sgl.sg_iovs = &iov;
+
+		rc = daos_obj_list_dkey_par_next(eh, &number, kds, &sgl, &eof);
+		assert_rc_equal(rc, 0);
+
+		for (ptr = buf, i = 0; i < number; i++) {
+			memset(key, 0, sizeof(key));
+			memcpy(key, ptr, kds[i].kd_key_len);
+			idx = atoi(key);
+			assert_true(idx >= 0 && idx < ENUM_KEY_REC_NR);
+			/* Every dkey is returned exactly once */
+			assert_int_equal(seen[idx], 0);
+			seen[idx] = 1;
+			ptr += kds[i].kd_key_len;
+		}
+		key_nr += number;
+	}
+	rc = daos_obj_list_dkey_par_close(eh);
+	assert_rc_equal(rc, 0);
+
+	print_message("Enumerated %d dkeys\n", key_nr);
+	assert_int_equal(key_nr, ENUM_KEY_REC_NR);
+
+	D_FREE(seen);
+	ioreq_fini(&req);
+}
+
+/**
+ * The fetches of snapshot and read-only container handle may be served by the
+ * client read cache (DAOS_OBJ_CACHE_SIZE and DAOS_OBJ_CACHE_RO), the data read
+ * through a new open of the container must reflect the updates made since the
+ * previous open. The repeated fetches are run with DAOS_OBJ_CACHE_ONLY, which
+ * fails the fetches sent to the engines, so that they must hit.
+ */
+static void
+read_cache(void **state)
+{
+	test_arg_t	*arg = *state;
+	daos_handle_t	 coh;
+	daos_handle_t	 th;
+	daos_obj_id_t	 oid;
+	daos_epoch_t	 snap_epoch;
+	struct ioreq	 req;
+	struct ioreq	 ro_req;
+	char		 buf[16];
+	int		 i;
+	int		 rc;
+
+	if (arg->myrank != 0)
+		return;
+
+	if (getenv("DAOS_OBJ_CACHE_SIZE") == NULL || getenv("DAOS_OBJ_CACHE_RO") == NULL) {
+		print_message("Read cache is disabled, skip\n");
+		skip();
+	}
+
+	oid = daos_test_oid_gen(arg->coh, dts_obj_class, 0, 0, arg->myrank);
+	ioreq_init(&req, arg->coh, oid, DAOS_IOD_SINGLE, arg);
+
+	insert_single("dkey", "akey", 0, "data_v1", strlen("data_v1") + 1, DAOS_TX_NONE, &req);
+	rc = daos_cont_create_snap(arg->coh, &snap_epoch, NULL, NULL);
+	assert_rc_equal(rc, 0);
+	insert_single("dkey", "akey", 0, "data_v2", strlen("data_v2") + 1, DAOS_TX_NONE, &req);
+
+	print_message("Fetch from snapshot twice\n");
+	rc = daos_tx_open_snap(arg->coh, snap_epoch, &th, NULL);
+	assert_rc_equal(rc, 0);
+	for (i = 0; i < 2; i++) {
+		if (i == 1)
+			daos_fail_loc_set(DAOS_OBJ_CACHE_ONLY | DAOS_FAIL_ALWAYS);
+		memset(buf, 0, sizeof(buf));
+		lookup_single("dkey", "akey", 0, buf, sizeof(buf), th, &req);
+		assert_string_equal(buf, "data_v1");
+	}
+	daos_fail_loc_set(0);
+	rc = daos_tx_close(th, NULL);
+	assert_rc_equal(rc, 0);
+
+	print_message("Fetch through read-only container handle twice\n");
+	rc = daos_cont_open(arg->pool.poh, arg->co_str, DAOS_COO_RO, &coh, NULL, NULL);
+	assert_rc_equal(rc, 0);
+	ioreq_init(&ro_req, coh, oid, DAOS_IOD_SINGLE, arg);
+	for (i = 0; i < 2; i++) {
+		if (i == 1)
+			daos_fail_loc_set(DAOS_OBJ_CACHE_ONLY | DAOS_FAIL_ALWAYS);
+		memset(buf, 0, sizeof(buf));
+		lookup_single("dkey", "akey", 0, buf, sizeof(buf), DAOS_TX_NONE, &ro_req);
+		assert_string_equal(buf, "data_v2");
+	}
+	daos_fail_loc_set(0);
+	ioreq_fini(&ro_req);
+	rc = daos_cont_close(coh, NULL);
+	assert_rc_equal(rc, 0);
+
+	insert_single("dkey", "akey", 0, "data_v3", strlen("data_v3") + 1, DAOS_TX_NONE, &req);
+
+	print_message("Fetch through new read-only container handle\n");
+	rc = daos_cont_open(arg->pool.poh, arg->co_str, DAOS_COO_RO, &coh, NULL, NULL);
+	assert_rc_equal(rc, 0);
+	ioreq_init(&ro_req, coh, oid, DAOS_IOD_SINGLE, arg);
+
+	/* The entries of the previous handle are not served to this one. */
+	daos_fail_loc_set(DAOS_OBJ_CACHE_ONLY | DAOS_FAIL_ALWAYS);
+	arg->expect_result = -DER_IO;
+	lookup_single("dkey", "akey", 0, buf, sizeof(buf), DAOS_TX_NONE, &ro_req);
+	arg->expect_result = 0;
+	daos_fail_loc_set(0);
+
+	memset(buf, 0, sizeof(buf));
+	lookup_single("dkey", "akey", 0, buf, sizeof(buf), DAOS_TX_NONE, &ro_req);
+	assert_string_equal(buf, "data_v3");
+	ioreq_fini(&ro_req);
+	rc = daos_cont_close(coh, NULL);
+	assert_rc_equal(rc, 0);
+
+	ioreq_fini(&req);
+}
+
 static const struct CMUnitTest io_tests[] = {
 	{ "IO1: simple update/fetch/verify",
 	  io_simple, async_disable, test_case_teardown},
@@ -5213,6 +5376,10 @@ static const struct CMUnitTest io_tests[] = {
 	{ "IO47: obj_open perf", obj_open_perf, async_disable, test_case_teardown},
 	{ "IO48: oit_list_filter", oit_list_filter, async_disable, test_case_teardown},
 	{ "IO49: oit_list_filter async", oit_list_filter, async_enable, test_case_teardown},
+	{ "IO50: parallel dkey enumeration with prefetch",
+	  enumerate_parallel, async_disable, test_case_teardown},
+	{ "IO51: read cache of snapshot and read-only container",
+	  read_cache, async_disable, test_case_teardown},
 };
 
 int
@@ -1916,6 +1916,160 @@ rebuild_with_dfs_inflight_punch_create(void **state)
 	rebuild_dfs_fini(arg, dfs_mt, dir, co_hdl, co_uuid);
 }
 
+#define SMALL_OBJ_NR	16
+#define SMALL_DKEY_NR	8
+
+/* Up to the largest value packed inline by the batched migration */
+static const daos_size_t small_sizes[] = { 1, 32, 1024, 4000 };
+
+static void
+small_value_fill(char *buf, daos_size_t size, int obj, int dkey)
+{
+	memset(buf, 'a' + (obj * SMALL_DKEY_NR + dkey + size) % 26, size);
+}
+
+static void
+small_objects_insert(test_arg_t *arg, daos_handle_t coh, daos_obj_id_t *oids, int pass)
+{
+	struct ioreq	req;
+	daos_recx_t	recx;
+	char		dkey[32];
+	char		akey[32];
+	char		buf[4000];
+	int		i, j, k;
+
+	for (i = 0; i < SMALL_OBJ_NR; i++) {
+		oids[i] = daos_test_oid_gen(coh, arg->obj_class, 0, 0, arg->myrank);
+		oids[i] = dts_oid_set_rank(oids[i], ranks_to_kill[0]);
+		oids[i] = dts_oid_set_tgt(oids[i], DEFAULT_FAIL_TGT);
+		ioreq_init(&req, coh, oids[i], DAOS_IOD_SINGLE, arg);
+		for (j = 0; j < SMALL_DKEY_NR; j++) {
+			sprintf(dkey, "dkey_%d_%d", pass, j);
+			for (k = 0; k < ARRAY_SIZE(small_sizes); k++) {
+				small_value_fill(buf, small_sizes[k], i, j);
+
+				sprintf(akey, "sv_%d", k);
+				req.iod_type = DAOS_IOD_SINGLE;
+				insert_single(dkey, akey, 0, buf, small_sizes[k], DAOS_TX_NONE,
+					      &req);
+
+				sprintf(akey, "array_%d", k);
+				recx.rx_idx = 0;
+				recx.rx_nr = small_sizes[k];
+				req.iod_type = DAOS_IOD_ARRAY;
+				insert_recxs(dkey, akey, 1, DAOS_TX_NONE, &recx, 1, buf,
+					     small_sizes[k], &req);
+			}
+		}
+		ioreq_fini(&req);
+	}
+}
+
+/* Fetch every value from every replica, the client verifies the checksums */
+static void
+small_objects_verify(test_arg_t *arg, daos_handle_t coh, daos_obj_id_t *oids, int pass)
+{
+	struct ioreq	req;
+	daos_recx_t	recx;
+	char		dkey[32];
+	char		akey[32];
+	char		buf[4000];
+	char		fetch_buf[4000];
+	int		i, j, k, r;
+	int		rc;
+
+	for (i = 0; i < SMALL_OBJ_NR; i++) {
+		ioreq_init(&req, coh, oids[i], DAOS_IOD_SINGLE, arg);
+		daos_fail_loc_set(DAOS_OBJ_SPECIAL_SHARD);
+		for (r = 0; r < OBJ_REPLICAS; r++) {
+			daos_fail_value_set(r);
+			for (j = 0; j < SMALL_DKEY_NR; j++) {
+				sprintf(dkey, "dkey_%d_%d", pass, j);
+				for (k = 0; k < ARRAY_SIZE(small_sizes); k++) {
+					small_value_fill(buf, small_sizes[k], i, j);
+
+					sprintf(akey, "sv_%d", k);
+					memset(fetch_buf, 0, sizeof(fetch_buf));
+					req.iod_type = DAOS_IOD_SINGLE;
+					lookup_single(dkey, akey, 0, fetch_buf, sizeof(fetch_buf),
+						      DAOS_TX_NONE, &req);
+					assert_int_equal(req.iod[0].iod_size, small_sizes[k]);
+					assert_memory_equal(fetch_buf, buf, small_sizes[k]);
+
+					sprintf(akey, "array_%d", k);
+					memset(fetch_buf, 0, sizeof(fetch_buf));
+					recx.rx_idx = 0;
+					recx.rx_nr = small_sizes[k];
+					req.iod_type = DAOS_IOD_ARRAY;
+					lookup_recxs(dkey, akey, 1, DAOS_TX_NONE, &recx, 1,
+						     fetch_buf, small_sizes[k], &req);
+					assert_memory_equal(fetch_buf, buf, small_sizes[k]);
+				}
+			}
+		}
+		daos_fail_loc_set(0);
+		daos_fail_value_set(0);
+		ioreq_fini(&req);
+
+		rc = daos_obj_verify(coh, oids[i], DAOS_EPOCH_MAX);
+		if (rc != 0)
+			assert_rc_equal(rc, -DER_NOSYS);
+	}
+}
+
+/*
+ * Rebuild small single value and array objects of a checksummed container, with
+ * the batched migration (DAOS_MIGRATE_BATCH_SIZE default) and without it.
+ */
+static void
+rebuild_small_objects_batch(void **state)
+{
+	test_arg_t	*arg = *state;
+	daos_obj_id_t	 oids[SMALL_OBJ_NR];
+	daos_prop_t	*props;
+	daos_handle_t	 coh;
+	uuid_t		 co_uuid;
+	char		 str[DAOS_UUID_STR_SIZE];
+	int		 pass;
+
+	if (!test_runable(arg, 4))
+		return;
+
+	props = daos_prop_alloc(3);
+	assert_non_null(props);
+	props->dpp_entries[0].dpe_type = DAOS_PROP_CO_REDUN_FAC;
+	props->dpp_entries[0].dpe_val = DAOS_PROP_CO_REDUN_RF2;
+	props->dpp_entries[1].dpe_type = DAOS_PROP_CO_CSUM;
+	props->dpp_entries[1].dpe_val = DAOS_PROP_CO_CSUM_CRC32;
+	props->dpp_entries[2].dpe_type = DAOS_PROP_CO_CSUM_SERVER_VERIFY;
+	props->dpp_entries[2].dpe_val = DAOS_PROP_CO_CSUM_SV_ON;
+	assert_success(daos_cont_create(arg->pool.poh, &co_uuid, props, NULL));
+	daos_prop_free(props);
+	uuid_unparse(co_uuid, str);
+	assert_success(daos_cont_open(arg->pool.poh, str, DAOS_COO_RW, &coh, NULL, NULL));
+
+	for (pass = 0; pass < 2; pass++) {
+		print_message("rebuild small objects %s batching\n",
+			      pass == 0 ? "with" : "without");
+		if (pass == 1 && arg->myrank == 0)
+			daos_debug_set_params(arg->group, -1, DMG_KEY_FAIL_LOC,
+					      DAOS_REBUILD_NO_BATCH | DAOS_FAIL_ALWAYS, 0, NULL);
+
+		small_objects_insert(arg, coh, oids, pass);
+		rebuild_single_pool_target(arg, ranks_to_kill[0], DEFAULT_FAIL_TGT, false);
+		small_objects_verify(arg, coh, oids, pass);
+
+		reintegrate_single_pool_target(arg, ranks_to_kill[0], DEFAULT_FAIL_TGT);
+		small_objects_verify(arg, coh, oids, pass);
+
+		if (pass == 1 && arg->myrank == 0)
+			daos_debug_set_params(arg->group, -1, DMG_KEY_FAIL_LOC, 0, 0, NULL);
+	}
+
+	assert_success(daos_cont_close(coh, NULL));
+	assert_success(daos_cont_destroy(arg->pool.poh, str, 1, NULL));
+}
+
 /** create a new pool/container for each test */
 static const struct CMUnitTest rebuild_tests[] = {
 	{"REBUILD1: rebuild small rec multiple dkeys",
@@ -1975,6 +2129,8 @@ static const struct CMUnitTest rebuild_tests[] = {
 	{"REBUILD28: rebuild sx object with reintegration mode no_data_sync",
 	 rebuild_sx_object_no_data_sync, rebuild_small_sub_rf0_setup,
 	 reintegration_no_data_sync_teardown},
+	{"REBUILD29: rebuild small objects with and without batching",
+	 rebuild_small_objects_batch, rebuild_small_sub_setup, test_teardown},
 };
 
 int
@@ -13,6 +13,8 @@
 #include "gurt/telemetry_common.h"
 #include "gurt/telemetry_consumer.h"
 
+#define MAX_PERCENTILES 16
+
 static void
 print_usage(const char *prog_name)
 {
@@ -51,6 +53,14 @@ print_usage(const char *prog_name)
 	       "\tInclude timer snapshots\n"
 	       "--gauge, -g\n"
 	       "\tInclude gauges\n"
+	       "--histogram, -H\n"
+	       "\tInclude HDR histograms\n"
+	       "--percentiles, -P\n"
+	       "\tComma separated percentiles shown for the HDR histograms\n"
+	       "\tDefault is 50,90,99,99.9\n"
+	       "--interval, -I\n"
+	       "\tShow the HDR histograms over each iteration instead of "
+	       "since the I/O Engine start\n"
 	       "--read, -r\n"
 	       "--reset, -e\n"
 	       "\tInclude timestamp of when metric was read\n",
@@ -76,6 +86,11 @@ main(int argc, char **argv)
 	int			opt;
 	int			extra_descriptors = 0;
 	uint32_t		ops = 0;
+	double			pcts[MAX_PERCENTILES];
+	int			pct_nr = 0;
+	bool			interval = false;
+	char			*token;
+	char			*rest;
 
 	sprintf(dirname, "/");
 
@@ -89,6 +104,9 @@ main(int argc, char **argv)
 			{"timestamp", no_argument, NULL, 't'},
 			{"snapshot", no_argument, NULL, 's'},
 			{"gauge", no_argument, NULL, 'g'},
+			{"histogram", no_argument, NULL, 'H'},
+			{"percentiles", required_argument, NULL, 'P'},
+			{"interval", no_argument, NULL, 'I'},
 			{"iterations", required_argument, NULL, 'i'},
 			{"path", required_argument, NULL, 'p'},
 			{"delay", required_argument, NULL, 'D'},
@@ -101,7 +119,7 @@ main(int argc, char **argv)
 			{NULL, 0, NULL, 0}
 		};
 
-		opt = getopt_long_only(argc, argv, "S:cCdtsgi:p:D:MmTrhe",
+		opt = getopt_long_only(argc, argv, "S:cCdtsgHP:Ii:p:D:MmTrhe",
 				       long_options, NULL);
 		if (opt == -1)
 			break;
@@ -128,6 +146,23 @@ main(int argc, char **argv)
 		case 'g':
 			filter |= D_TM_GAUGE | D_TM_STATS_GAUGE;
 			break;
+		case 'H':
+			filter |= D_TM_HDR_HISTOGRAM;
+			break;
+		case 'P':
+			pct_nr = 0;
+			rest = optarg;
+			while ((token = strtok_r(rest, ",", &rest)) != NULL) {
+				if (pct_nr == MAX_PERCENTILES) {
+					printf("Up to %d percentiles\n", MAX_PERCENTILES);
+					exit(1);
+				}
+				pcts[pct_nr++] = atof(token);
+			}
+			break;
+		case 'I':
+			interval = true;
+			break;
 		case 'i':
 			num_iter = atoi(optarg);
 			break;
@@ -165,7 +200,8 @@ main(int argc, char **argv)
 
 	if (filter == 0)
 		filter = D_TM_COUNTER | D_TM_DURATION | D_TM_TIMESTAMP | D_TM_MEMINFO |
-			 D_TM_TIMER_SNAPSHOT | D_TM_GAUGE | D_TM_STATS_GAUGE;
+			 D_TM_TIMER_SNAPSHOT | D_TM_GAUGE | D_TM_STATS_GAUGE |
+			 D_TM_HDR_HISTOGRAM;
 
 	ctx = d_tm_open(srv_idx);
 	if (!ctx)
@@ -175,6 +211,12 @@ main(int argc, char **argv)
 	if (!root)
 		goto failure;
 
+	if (d_tm_set_hdr_view(ctx, pct_nr > 0 ? pcts : NULL, pct_nr, interval) != 0) {
+		printf("Unable to set the HDR histogram view\n");
+		d_tm_close(&ctx);
+		return -1;
+	}
+
 	if (strncmp(dirname, "/", D_TM_MAX_NAME_LEN) != 0) {
 		node = d_tm_find_metric(ctx, dirname);
 		if (node != NULL) {
@@ -1,5 +1,5 @@
 /*
- * (C) Copyright 2016-2022 Intel Corporation.
+ * (C) Copyright 2016-2023 Intel Corporation.
  *
  * SPDX-License-Identifier: BSD-2-Clause-Patent
  */
@@ -64,6 +64,19 @@ static bool g_group_inited;
 static bool g_context_created;
 static bool g_cart_inited;
 
+/* Results in JSON, and the count of results written so far */
+static FILE *g_json;
+static int g_json_nr;
+
+/* Provider of the in-process server, and its contexts other than the first */
+static char *g_loopback;
+static crt_context_t *g_lb_ctx;
+static pthread_t *g_lb_tid;
+static uint32_t g_lb_nr;
+
+/* Bucket upper bounds are powers of 2 microseconds */
+#define ST_HIST_BUCKETS 32
+
 static void *progress_fn(void *arg)
 {
 	int		 ret;
@@ -219,6 +232,102 @@ static int self_test_init(char *dest_name, crt_context_t *crt_ctx,
 	return 0;
 }
 
+/*
+ * Start a service of a single rank within this process, with a context for
+ * each of the tags [0, num_ctx). The self-test service handlers run on these
+ * contexts, so the RPC and bulk costs can be measured without a fabric or a
+ * running group. The provider is set by the caller.
+ */
+static int self_test_loopback_init(crt_context_t *crt_ctx,
+				   crt_group_t **srv_grp, pthread_t *tid,
+				   uint32_t num_ctx)
+{
+	uint32_t	i;
+	int		ret;
+
+	/* rank, num_attach_retries, is_server, assert_on_error */
+	crtu_test_init(0, 0, true, false);
+
+	ret = crt_init(CRT_SELF_TEST_GROUP_NAME, CRT_FLAG_BIT_SERVER |
+		       CRT_FLAG_BIT_AUTO_SWIM_DISABLE);
+	if (ret != 0)
+		return ret;
+
+	g_cart_inited = true;
+	g_shutdown_flag = 0;
+
+	ret = crt_context_create(crt_ctx);
+	if (ret != 0) {
+		D_ERROR("crt_context_create failed; ret = %d\n", ret);
+		return ret;
+	}
+	g_context_created = true;
+
+	if (num_ctx > 1) {
+		D_ALLOC_ARRAY(g_lb_ctx, num_ctx - 1);
+		D_ALLOC_ARRAY(g_lb_tid, num_ctx - 1);
+		if (g_lb_ctx == NULL || g_lb_tid == NULL)
+			return -DER_NOMEM;
+	}
+
+	for (i = 0; i < num_ctx - 1; i++) {
+		ret = crt_context_create(&g_lb_ctx[i]);
+		if (ret != 0) {
+			D_ERROR("crt_context_create failed; ret = %d\n", ret);
+			return ret;
+		}
+
+		ret = pthread_create(&g_lb_tid[i], NULL, progress_fn,
+				     &g_lb_ctx[i]);
+		if (ret != 0) {
+			D_ERROR("failed to create progress thread: %s\n",
+				strerror(ret));
+			crt_context_destroy(g_lb_ctx[i], 0);
+			return -DER_MISC;
+		}
+		g_lb_nr++;
+	}
+
+	/* The URIs of all the existing contexts are added for the self rank */
+	ret = crt_rank_self_set(0, 1 /* group_version_min */);
+	if (ret != 0) {
+		D_ERROR("crt_rank_self_set failed; ret = %d\n", ret);
+		return ret;
+	}
+
+	*srv_grp = crt_group_lookup(NULL);
+	D_ASSERT(*srv_grp != NULL);
+
+	ret = pthread_create(tid, NULL, progress_fn, crt_ctx);
+	if (ret != 0) {
+		D_ERROR("failed to create progress thread: %s\n",
+			strerror(ret));
+		return -DER_MISC;
+	}
+
+	printf("Loopback service started over %s with %u contexts\n",
+	       getenv("CRT_PHY_ADDR_STR"), num_ctx);
+	return 0;
+}
+
+static void self_test_loopback_fini(void)
+{
+	uint32_t	i;
+	int		ret;
+
+	g_shutdown_flag = 1;
+	for (i = 0; i < g_lb_nr; i++) {
+		if (pthread_join(g_lb_tid[i], NULL))
+			D_ERROR("Could not join progress thread\n");
+		ret = crt_context_destroy(g_lb_ctx[i], 0);
+		if (ret != 0)
+			D_ERROR("crt_context_destroy failed; ret = %d\n", ret);
+	}
+	g_lb_nr = 0;
+	D_FREE(g_lb_ctx);
+	D_FREE(g_lb_tid);
+}
+
 static int st_compare_endpts(const void *a_in, const void *b_in)
 {
 	struct st_endpoint *a = (struct st_endpoint *)a_in;
@@ -351,8 +460,59 @@ static void print_fail_counts(struct st_latency *latencies,
 
 }
 
+/*
+ * Latency at percentile @pct of @num latencies sorted by value, all of which
+ * must be successful
+ */
+static int64_t st_percentile(struct st_latency *latencies, uint32_t num,
+			     double pct)
+{
+	uint32_t idx = ceil(num * pct / 100.0);
+
+	D_ASSERT(num > 0);
+	return latencies[idx > 0 ? idx - 1 : 0].val;
+}
+
+/* Write the distribution of @num successful latencies sorted by value */
+static void st_json_latencies(struct st_latency *latencies, uint32_t num)
+{
+	uint32_t	hist[ST_HIST_BUCKETS] = { 0 };
+	int64_t		sum = 0;
+	uint32_t	i;
+	int		b;
+	int		last = 0;
+
+	if (num == 0) {
+		fprintf(g_json, "null");
+		return;
+	}
+
+	for (i = 0; i < num; i++) {
+		int64_t us = latencies[i].val / 1000;
+
+		for (b = 0; b < ST_HIST_BUCKETS - 1 && us >= (1LL << b); b++)
+			;
+		hist[b]++;
+		last = max(last, b);
+		sum += latencies[i].val;
+	}
+
+	fprintf(g_json, "{\"min\": %.3f, \"p50\": %.3f, \"p99\": %.3f, "
+		"\"p99.9\": %.3f, \"max\": %.3f, \"avg\": %.3f, \"histogram\": [",
+		latencies[0].val / 1000.0,
+		st_percentile(latencies, num, 50) / 1000.0,
+		st_percentile(latencies, num, 99) / 1000.0,
+		st_percentile(latencies, num, 99.9) / 1000.0,
+		latencies[num - 1].val / 1000.0, sum / 1000.0 / num);
+	for (b = 0; b <= last; b++)
+		fprintf(g_json, "%s[%lld, %u]", b == 0 ? "" : ", ", 1LL << b,
+			hist[b]);
+	fprintf(g_json, "]}");
+}
+
 static void print_results(struct st_latency *latencies,
 			  struct crt_st_start_params *test_params,
+			  crt_endpoint_t *ms_endpt,
 			  int64_t test_duration_ns, int output_megabits)
 {
 	uint32_t	 local_rep;
@@ -385,6 +545,18 @@ static void print_results(struct st_latency *latencies,
 		       bandwidth / (1024.0F * 1024.0F));
 	printf("\tRPC Throughput (RPCs/sec): %.0f\n", throughput);
 
+	if (g_json != NULL)
+		fprintf(g_json, "%s  {\"send_size\": %u, \"send_type\": \"%s\", "
+			"\"reply_size\": %u, \"reply_type\": \"%s\", "
+			"\"max_inflight\": %u, \"master\": \"%u:%u\", "
+			"\"rpcs_per_sec\": %.0f, \"bytes_per_sec\": %.0f",
+			g_json_nr++ == 0 ? "" : ",\n",
+			test_params->send_size,
+			crt_st_msg_type_str[test_params->send_type],
+			test_params->reply_size,
+			crt_st_msg_type_str[test_params->reply_type],
+			test_params->max_inflight, ms_endpt->ep_rank,
+			ms_endpt->ep_tag, throughput, bandwidth);
 
 	/* Figure out how many repetitions were errors */
 	num_failed = 0;
@@ -409,6 +581,9 @@ static void print_results(struct st_latency *latencies,
 	num_passed = test_params->rep_count - num_failed;
 	if (num_passed == 0) {
 		printf("\tAll RPCs for this message size failed\n");
+		if (g_json != NULL)
+			fprintf(g_json, ", \"failures\": %u, \"latency_us\": null}",
+				num_failed);
 		return;
 	}
 
@@ -444,6 +619,8 @@ static void print_results(struct st_latency *latencies,
 	       "\t\t25th  %%: %ld\n"
 	       "\t\tMedian : %ld\n"
 	       "\t\t75th  %%: %ld\n"
+	       "\t\t99th  %%: %ld\n"
+	       "\t\t99.9th%%: %ld\n"
 	       "\t\tMax    : %ld\n"
 	       "\t\tAverage: %ld\n"
 	       "\t\tStd Dev: %.2f\n",
@@ -451,11 +628,19 @@ static void print_results(struct st_latency *latencies,
 	       latencies[num_failed + num_passed / 4].val / 1000,
 	       latencies[num_failed + num_passed / 2].val / 1000,
 	       latencies[num_failed + num_passed*3/4].val / 1000,
+	       st_percentile(&latencies[num_failed], num_passed, 99) / 1000,
+	       st_percentile(&latencies[num_failed], num_passed, 99.9) / 1000,
 	       latencies[test_params->rep_count - 1].val / 1000,
 	       latency_avg / 1000, latency_std_dev / 1000);
 
 	/* Print error summary results */
 	printf("\tRPC Failures: %u\n", num_failed);
+
+	if (g_json != NULL) {
+		fprintf(g_json, ", \"failures\": %u, \"latency_us\": ", num_failed);
+		st_json_latencies(&latencies[num_failed], num_passed);
+		fprintf(g_json, ", \"endpoints\": [");
+	}
 	/* print_fail_counts(&latencies[0], num_failed, "\t\t"); */
 
 	printf("\n");
@@ -472,7 +657,7 @@ static void print_results(struct st_latency *latencies,
 	qsort(latencies, test_params->rep_count,
 	      sizeof(latencies[0]), st_compare_latencies_by_ranks);
 
-	printf("\tEndpoint results (rank:tag - Median Latency (us)):\n");
+	printf("\tEndpoint results (rank:tag - Median/99th %%/99.9th %%/Max Latency (us)):\n");
 
 	/* Iterate over each rank / tag pair */
 	local_rep = 0;
@@ -509,8 +694,24 @@ static void print_results(struct st_latency *latencies,
 		printf("\t\t%u:%u - ", rank, tag);
 
 		/* At least some messages to this endpoint succeeded */
-		if (start_idx + num_failed <= last_idx)
-			printf("%ld", latencies[median_idx].val / 1000);
+		if (start_idx + num_failed <= last_idx) {
+			struct st_latency	*passed = &latencies[start_idx + num_failed];
+			uint32_t		 nr = last_idx - start_idx - num_failed + 1;
+
+			printf("%ld/%ld/%ld/%ld", latencies[median_idx].val / 1000,
+			       st_percentile(passed, nr, 99) / 1000,
+			       st_percentile(passed, nr, 99.9) / 1000,
+			       latencies[last_idx].val / 1000);
+		}
+
+		if (g_json != NULL) {
+			fprintf(g_json, "%s\n    {\"rank\": %u, \"tag\": %u, \"failures\": %u, "
+				"\"latency_us\": ", start_idx == 0 ? "" : ",", rank, tag,
+				num_failed);
+			st_json_latencies(&latencies[start_idx + num_failed],
+					  last_idx + 1 - start_idx - num_failed);
+			fprintf(g_json, "}");
+		}
 
 		printf("\n");
 		if (num_failed > 0)
@@ -521,6 +722,8 @@ static void print_results(struct st_latency *latencies,
 
 	printf("\n");
 
+	if (g_json != NULL)
+		fprintf(g_json, "\n  ]}");
 }
 
 static int test_msg_size(crt_context_t crt_ctx,
@@ -766,6 +969,7 @@ static int test_msg_size(crt_context_t crt_ctx,
 		printf("\n");
 
 		print_results(latencies[m_idx], test_params,
+			      &ms_endpts[m_idx].endpt,
 			      ms_endpts[m_idx].reply.test_duration_ns,
 			      output_megabits);
 	}
@@ -841,9 +1045,20 @@ static int run_self_test(struct st_size_params all_params[],
 	if (ms_endpts_in == NULL)
 		listen = true;
 	/* Initialize CART */
-	ret = self_test_init(dest_name, &crt_ctx, &srv_grp, &tid,
-			     attach_info_path, listen /* run as server */,
-			     use_daos_agent_vars);
+	if (g_loopback != NULL) {
+		uint32_t	num_ctx = 1;
+		uint32_t	i;
+
+		for (i = 0; i < num_endpts; i++)
+			num_ctx = max(num_ctx, endpts[i].tag + 1);
+		ret = self_test_loopback_init(&crt_ctx, &srv_grp, &tid,
+					      num_ctx);
+	} else {
+		ret = self_test_init(dest_name, &crt_ctx, &srv_grp, &tid,
+				     attach_info_path,
+				     listen /* run as server */,
+				     use_daos_agent_vars);
+	}
 	if (ret != 0) {
 		D_ERROR("self_test_init failed; ret = %d\n", ret);
 		D_GOTO(cleanup_nothread, ret);
@@ -1027,6 +1242,8 @@ cleanup:
 	}
 
 cleanup_nothread:
+	self_test_loopback_fini();
+
 	if (latencies_bulk_hdl != NULL) {
 		for (m_idx = 0; m_idx < num_ms_endpts; m_idx++)
 			if (latencies_bulk_hdl[m_idx] != CRT_BULK_NULL)
@@ -1250,7 +1467,24 @@ static void print_usage(const char *prog_name, const char *msg_sizes_str,
 	       "         - CRT_PHY_ADDR_STR\n"
 	       "         - CRT_CTX_SHARE_ADDR\n"
 	       "         - OFI_DOMAIN\n"
-	       "         - CRT_TIMEOUT\n",
+	       "         - CRT_TIMEOUT\n"
+	       "\n"
+	       "  --loopback <sm|tcp>\n"
+	       "      Short version: -l\n"
+	       "      Start the self-test service within this application as a group of\n"
+	       "        one rank, with a context for each tag given via --endpoint, and test\n"
+	       "        against it over the shared-memory (sm) or the TCP (tcp) provider.\n"
+	       "        No fabric nor running group is needed, so this can be used to\n"
+	       "        benchmark the CaRT RPC and bulk paths on a single node.\n"
+	       "\n"
+	       "      All the endpoints must be of rank 0, --group-name, --master-endpoint\n"
+	       "        and --use-daos-agent-env are not allowed. For tcp, OFI_INTERFACE\n"
+	       "        defaults to lo\n"
+	       "\n"
+	       "  --json <file>\n"
+	       "      Short version: -j\n"
+	       "      Also write the results to the file in JSON, including the latency\n"
+	       "        percentiles and histograms of each message size and endpoint\n",
 	       prog_name, UINT32_MAX,
 	       CRT_SELF_TEST_AUTO_BULK_THRESH, msg_sizes_str, rep_count,
 	       max_inflight, CRT_ST_BUF_ALIGN_MIN, CRT_ST_BUF_ALIGN_MIN);
@@ -1717,6 +1951,7 @@ int main(int argc, char *argv[])
 	int16_t				 buf_alignment =
 		CRT_ST_BUF_ALIGN_DEFAULT;
 	char				*attach_info_path = NULL;
+	char				*json_path = NULL;
 	bool				 use_daos_agent_vars = false;
 
 	ret = d_log_init();
@@ -1740,11 +1975,13 @@ int main(int argc, char *argv[])
 			{"path", required_argument, 0, 'p'},
 			{"nopmix", no_argument, 0, 'n'},
 			{"use-daos-agent-env", no_argument, 0, 'u'},
+			{"loopback", required_argument, 0, 'l'},
+			{"json", required_argument, 0, 'j'},
 			{"help", no_argument, 0, 'h'},
 			{0, 0, 0, 0}
 		};
 
-		c = getopt_long(argc, argv, "g:m:e:s:r:i:a:bthnqp:u",
+		c = getopt_long(argc, argv, "g:m:e:s:r:i:a:bthnqp:ul:j:",
 				long_options, NULL);
 		if (c == -1)
 			break;
@@ -1803,6 +2040,18 @@ int main(int argc, char *argv[])
 		case 'q':
 			g_randomize_endpoints = true;
 			break;
+		case 'l':
+			if (strcmp(optarg, "sm") != 0 &&
+			    strcmp(optarg, "tcp") != 0) {
+				printf("Invalid --loopback provider '%s'\n",
+				       optarg);
+				D_GOTO(cleanup, ret = -DER_INVAL);
+			}
+			g_loopback = optarg;
+			break;
+		case 'j':
+			json_path = optarg;
+			break;
 
 		/* 't' and 'n' options are deprecated */
 		case 't':
@@ -1826,7 +2075,29 @@ int main(int argc, char *argv[])
 		}
 	}
 
-	if (use_daos_agent_vars == false) {
+	if (g_loopback != NULL) {
+		if (dest_name != NULL || ms_endpts != NULL ||
+		    use_daos_agent_vars) {
+			printf("--loopback does not work with --group-name,"
+			       " --master-endpoint or --use-daos-agent-env\n");
+			D_GOTO(cleanup, ret = -DER_INVAL);
+		}
+		for (j = 0; j < num_endpts; j++) {
+			if (endpts[j].rank != 0) {
+				printf("--loopback only has rank 0, got %u\n",
+				       endpts[j].rank);
+				D_GOTO(cleanup, ret = -DER_INVAL);
+			}
+		}
+
+		dest_name = CRT_SELF_TEST_GROUP_NAME;
+		if (strcmp(g_loopback, "sm") == 0) {
+			setenv("CRT_PHY_ADDR_STR", "sm", 1);
+		} else {
+			setenv("CRT_PHY_ADDR_STR", "ofi+tcp", 1);
+			setenv("OFI_INTERFACE", "lo", 0);
+		}
+	} else if (use_daos_agent_vars == false) {
 		char *env;
 		char *attach_path;
 
@@ -1997,6 +2268,16 @@ int main(int argc, char *argv[])
 	       "  Max in-flight RPCs:          %d\n\n",
 	       rep_count, max_inflight);
 
+	if (json_path != NULL) {
+		g_json = fopen(json_path, "w");
+		if (g_json == NULL) {
+			printf("Failed to open %s: %s\n", json_path,
+			       strerror(errno));
+			D_GOTO(cleanup, ret = -DER_INVAL);
+		}
+		fprintf(g_json, "[\n");
+	}
+
 	/********************* Run the self test *********************/
 	ret = run_self_test(all_params, num_msg_sizes, rep_count,
 			    max_inflight, dest_name, ms_endpts,
@@ -2006,6 +2287,10 @@ int main(int argc, char *argv[])
 
 	/********************* Clean up *********************/
 cleanup:
+	if (g_json != NULL) {
+		fprintf(g_json, "\n]\n");
+		fclose(g_json);
+	}
 	if (ms_endpts != NULL) {
 		D_FREE(ms_endpts);
 		ms_endpts = NULL;
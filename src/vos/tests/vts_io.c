@@ -2983,6 +2983,166 @@ io_allocbuf_failure(void **state)
 	arg->ta_flags &= ~TF_ZERO_COPY;
 }
 
+#define DEDUP_TEST_SIZE	(8 << 10)
+#define DEDUP_TEST_TH	(4 << 10)
+
+struct dedup_test_update {
+	daos_handle_t		 du_ioh;
+	daos_iod_t		 du_iod;
+	daos_recx_t		 du_recx;
+	d_sg_list_t		 du_sgl;
+	struct daos_csummer	*du_csummer;
+	struct dcs_iod_csums	*du_iod_csums;
+	char			 du_akey[UPDATE_AKEY_SIZE];
+};
+
+/* Start a dedup update of the whole test buffer, return the reserved extent address. */
+static void
+dedup_update_begin(struct io_test_args *arg, struct dedup_test_update *du, daos_epoch_t epoch,
+		   daos_key_t *dkey, char *buf, bio_addr_t *addr)
+{
+	struct bio_sglist	*bsgl;
+	int			 rc;
+
+	memset(du, 0, sizeof(*du));
+	vts_key_gen(&du->du_akey[0], arg->akey_size, false, arg);
+	set_iov(&du->du_iod.iod_name, &du->du_akey[0],
+		is_daos_obj_type_set(arg->otype, DAOS_OT_AKEY_UINT64));
+	du->du_iod.iod_type = DAOS_IOD_ARRAY;
+	du->du_iod.iod_size = 1;
+	du->du_iod.iod_nr = 1;
+	du->du_iod.iod_recxs = &du->du_recx;
+	du->du_recx.rx_nr = DEDUP_TEST_SIZE;
+
+	rc = d_sgl_init(&du->du_sgl, 1);
+	assert_rc_equal(rc, 0);
+	d_iov_set(&du->du_sgl.sg_iovs[0], buf, DEDUP_TEST_SIZE);
+
+	rc = io_test_add_csums(&du->du_iod, &du->du_sgl, &du->du_csummer, &du->du_iod_csums);
+	assert_rc_equal(rc, 0);
+
+	rc = vos_update_begin(arg->ctx.tc_co_hdl, arg->oid, epoch, VOS_OF_DEDUP, dkey, 1,
+			      &du->du_iod, du->du_iod_csums, DEDUP_TEST_TH, &du->du_ioh, NULL);
+	assert_rc_equal(rc, 0);
+
+	bsgl = vos_iod_sgl_at(du->du_ioh, 0);
+	assert_non_null(bsgl);
+	assert_int_equal(bsgl->bs_nr_out, 1);
+	*addr = bsgl->bs_iovs[0].bi_addr;
+}
+
+static void
+dedup_update_end(struct dedup_test_update *du, daos_key_t *dkey, bool cancel)
+{
+	int	rc;
+
+	rc = bio_iod_prep(vos_ioh2desc(du->du_ioh), BIO_CHK_TYPE_IO, NULL, 0);
+	assert_rc_equal(rc, 0);
+	rc = bio_iod_copy(vos_ioh2desc(du->du_ioh), &du->du_sgl, 1);
+	assert_rc_equal(rc, 0);
+	rc = bio_iod_post(vos_ioh2desc(du->du_ioh), rc);
+	assert_rc_equal(rc, 0);
+
+	rc = vos_update_end(du->du_ioh, 0, dkey, cancel ? -DER_CANCELED : 0, NULL, NULL);
+	assert_rc_equal(rc, cancel ? -DER_CANCELED : 0);
+
+	daos_csummer_free_ic(du->du_csummer, &du->du_iod_csums);
+	daos_csummer_destroy(&du->du_csummer);
+	d_sgl_fini(&du->du_sgl, false);
+}
+
+static void
+dedup_fetch_verify(struct io_test_args *arg, struct dedup_test_update *du, daos_epoch_t epoch,
+		   daos_key_t *dkey, char *buf)
+{
+	d_sg_list_t	 sgl;
+	char		*fbuf;
+	int		 rc;
+
+	D_ALLOC(fbuf, DEDUP_TEST_SIZE);
+	assert_non_null(fbuf);
+	rc = d_sgl_init(&sgl, 1);
+	assert_rc_equal(rc, 0);
+	d_iov_set(&sgl.sg_iovs[0], fbuf, DEDUP_TEST_SIZE);
+
+	rc = vos_obj_fetch(arg->ctx.tc_co_hdl, arg->oid, epoch, 0, dkey, 1, &du->du_iod, &sgl);
+	assert_rc_equal(rc, 0);
+	assert_memory_equal(fbuf, buf, DEDUP_TEST_SIZE);
+
+	d_sgl_fini(&sgl, false);
+	D_FREE(fbuf);
+}
+
+static void
+dedup_discard(struct io_test_args *arg, daos_epoch_t epoch)
+{
+	daos_epoch_range_t	epr = {epoch, epoch};
+	int			rc;
+
+	rc = vos_discard(arg->ctx.tc_co_hdl, &arg->oid, &epr, NULL, NULL);
+	assert_rc_equal(rc, 0);
+}
+
+/* Dedup hit, reference counting of the shared extent and its free with the last reference */
+static void
+io_dedup_refcount(void **state)
+{
+	struct io_test_args		*arg = *state;
+	struct dedup_test_update	 du[6];
+	char				 dkey_buf[UPDATE_DKEY_SIZE] = { 0 };
+	daos_key_t			 dkey;
+	bio_addr_t			 addr[6];
+	char				*buf;
+
+	vts_key_gen(&dkey_buf[0], arg->dkey_size, true, arg);
+	set_iov(&dkey, &dkey_buf[0], is_daos_obj_type_set(arg->otype, DAOS_OT_DKEY_UINT64));
+	D_ALLOC(buf, DEDUP_TEST_SIZE);
+	assert_non_null(buf);
+	dts_buf_render(buf, DEDUP_TEST_SIZE);
+
+	/* The first write of the content is indexed */
+	dedup_update_begin(arg, &du[0], 1, &dkey, buf, &addr[0]);
+	assert_false(BIO_ADDR_IS_DEDUP(&addr[0]));
+	dedup_update_end(&du[0], &dkey, false);
+
+	/* The second one shares the extent */
+	dedup_update_begin(arg, &du[1], 2, &dkey, buf, &addr[1]);
+	assert_true(BIO_ADDR_IS_DEDUP(&addr[1]));
+	assert_int_equal(addr[1].ba_off, addr[0].ba_off);
+
+	/* The last reference dropped in between, the pinned extent is kept */
+	dedup_discard(arg, 1);
+	dedup_update_end(&du[1], &dkey, false);
+	dedup_fetch_verify(arg, &du[1], 2, &dkey, buf);
+
+	/* Canceled update doesn't take reference */
+	dedup_update_begin(arg, &du[2], 3, &dkey, buf, &addr[2]);
+	assert_true(BIO_ADDR_IS_DEDUP(&addr[2]));
+	assert_int_equal(addr[2].ba_off, addr[0].ba_off);
+	dedup_update_end(&du[2], &dkey, true);
+	dedup_fetch_verify(arg, &du[1], 2, &dkey, buf);
+
+	/* The extent is freed with the last reference, the content is indexed again */
+	dedup_discard(arg, 2);
+	dedup_update_begin(arg, &du[3], 4, &dkey, buf, &addr[3]);
+	assert_false(BIO_ADDR_IS_DEDUP(&addr[3]));
+	dedup_update_end(&du[3], &dkey, false);
+
+	/* The pinned extent is freed on cancel once it isn't referenced */
+	dedup_update_begin(arg, &du[4], 5, &dkey, buf, &addr[4]);
+	assert_true(BIO_ADDR_IS_DEDUP(&addr[4]));
+	assert_int_equal(addr[4].ba_off, addr[3].ba_off);
+	dedup_discard(arg, 4);
+	dedup_update_end(&du[4], &dkey, true);
+
+	dedup_update_begin(arg, &du[5], 6, &dkey, buf, &addr[5]);
+	assert_false(BIO_ADDR_IS_DEDUP(&addr[5]));
+	dedup_update_end(&du[5], &dkey, false);
+	dedup_fetch_verify(arg, &du[5], 6, &dkey, buf);
+
+	D_FREE(buf);
+}
+
 static const struct CMUnitTest iterator_tests[] = {
     {"VOS220: 100K update/fetch/verify test", io_multiple_dkey, NULL, NULL},
     {"VOS240.0: KV Iter tests (for dkey)", io_iter_test, NULL, NULL},
@@ -3029,6 +3189,7 @@ static const struct CMUnitTest int_tests[] = {
     {"VOS300.2: Key query test", io_query_key, NULL, NULL},
     {"VOS300.3: Key query negative test", io_query_key_negative, NULL, NULL},
     {"VOS300.4: Return error on DMA buffer allocation failure", io_allocbuf_failure, NULL, NULL},
+    {"VOS300.5: Dedup extent sharing and reference counting", io_dedup_refcount, NULL, NULL},
 };
 
 static int
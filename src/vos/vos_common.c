@@ -123,11 +123,17 @@ vos_xsctxt_get(void)
 int
 vos_bio_addr_free(struct vos_pool *pool, bio_addr_t *addr, daos_size_t nob)
 {
+	bool	shared;
 	int	rc;
 
 	if (bio_addr_is_hole(addr))
 		return 0;
 
+	/* Extent shared by deduplicated records is freed with the last reference */
+	rc = vos_dedup_decref(pool, addr, &shared);
+	if (rc != 0 || shared)
+		return rc;
+
 	if (addr->ba_type == DAOS_MEDIA_SCM) {
 		rc = umem_free(&pool->vp_umm, addr->ba_off);
 	} else {
@@ -599,6 +605,10 @@ vos_mod_init(void)
 		return rc;
 	}
 
+	rc = vos_dedup_tab_register();
+	if (rc)
+		return rc;
+
 	rc = vos_ilog_init();
 	if (rc)
 		D_ERROR("Failed to initialize incarnation log capability\n");
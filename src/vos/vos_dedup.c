@@ -0,0 +1,467 @@
+/**
+ * (C) Copyright 2023 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+/**
+ * Persistent deduplication index of VOS pool.
+ *
+ * The index maps the checksum of an extent (computed by the dedup csummer, see
+ * common/dedup.c) to the extent address and the number of evtree records that
+ * reference the extent. A reverse tree maps the extent address back to the
+ * checksum, so that freeing an extent can find and drop its reference, the
+ * physical extent is only freed when the last reference is gone.
+ *
+ * The index is stored in the pool (pd_dedup) and updated in the same transaction
+ * as the evtree records, it survives restart and stays consistent with the data.
+ * It is created with the pool, or on upgrade to VOS_POOL_DF_2_8.
+ *
+ * An update that found a shared extent pins it until the update completes, so
+ * that the extent is not freed by GC or aggregation in between. When the last
+ * reference of a pinned extent is dropped, the entry is kept with zero reference
+ * and the extent is freed on unpin, unless the update took a new reference.
+ *
+ * vos/vos_dedup.c
+ */
+#define D_LOGFAC	DD_FAC(vos)
+
+#include <daos/common.h>
+#include <daos/btree.h>
+#include <daos/btree_class.h>
+#include <daos/checksum.h>
+#include "vos_internal.h"
+
+#define VOS_DEDUP_ORDER		16
+
+/** Key of the checksum tree */
+struct vos_dedup_key {
+	uint16_t	dk_csum_type;
+	uint16_t	dk_padding;
+	uint32_t	dk_csum_len;
+	uint32_t	dk_chunksize;
+	uint32_t	dk_padding2;
+	uint64_t	dk_data_len;
+	uint8_t		dk_csum[0];
+};
+
+/** Pin of a shared extent by an in-flight update */
+struct vos_dedup_pin {
+	/* link into vos_pool::vp_dedup_pins */
+	d_list_t	dp_pool_link;
+	/* link into the pins of the update */
+	d_list_t	dp_link;
+	bio_addr_t	dp_addr;
+};
+
+/** Key of the address tree */
+struct vos_dedup_addr_key {
+	uint64_t	dak_off;
+	uint32_t	dak_type;
+	uint32_t	dak_padding;
+};
+
+static inline void
+dedup_addr_key_init(struct vos_dedup_addr_key *akey, bio_addr_t *addr)
+{
+	memset(akey, 0, sizeof(*akey));
+	akey->dak_off = addr->ba_off;
+	akey->dak_type = addr->ba_type;
+}
+
+static struct vos_dedup_key *
+dedup_key_alloc(struct dcs_csum_info *csum, daos_size_t csum_len, daos_size_t data_len,
+		d_iov_t *key_iov)
+{
+	struct vos_dedup_key	*key;
+
+	D_ALLOC(key, sizeof(*key) + csum_len);
+	if (key == NULL)
+		return NULL;
+
+	key->dk_csum_type = csum->cs_type;
+	key->dk_csum_len = csum_len;
+	key->dk_chunksize = csum->cs_chunksize;
+	key->dk_data_len = data_len;
+	memcpy(key->dk_csum, csum->cs_csum, csum_len);
+	d_iov_set(key_iov, key, sizeof(*key) + csum_len);
+
+	return key;
+}
+
+static inline bool
+dedup_enabled(struct vos_pool *pool)
+{
+	return daos_handle_is_valid(pool->vp_dedup_csum_th);
+}
+
+int
+vos_dedup_tab_register(void)
+{
+	int	rc;
+
+	rc = dbtree_class_register(VOS_BTR_DEDUP, 0, &dbtree_kv_ops);
+	if (rc)
+		D_ERROR("Failed to register dedup tree class: "DF_RC"\n", DP_RC(rc));
+	return rc;
+}
+
+static int
+dedup_open(struct vos_pool *pool, struct vos_dedup_df *dd_df)
+{
+	int	rc;
+
+	rc = dbtree_open_inplace(&dd_df->dd_csum_root, &pool->vp_uma, &pool->vp_dedup_csum_th);
+	if (rc != 0)
+		goto failed;
+
+	rc = dbtree_open_inplace(&dd_df->dd_addr_root, &pool->vp_uma, &pool->vp_dedup_addr_th);
+	if (rc != 0)
+		goto failed;
+
+	return 0;
+failed:
+	D_ERROR(DF_UUID": Failed to open dedup index: "DF_RC"\n", DP_UUID(pool->vp_id),
+		DP_RC(rc));
+	vos_dedup_fini(pool);
+	return rc;
+}
+
+/**
+ * Create the persistent dedup index, must be called in the transaction creating
+ * or upgrading the pool.
+ */
+int
+vos_dedup_create(struct umem_instance *umm, struct umem_attr *uma, struct vos_pool_df *pool_df)
+{
+	struct vos_dedup_df	*dd_df;
+	daos_handle_t		 hdl;
+	umem_off_t		 dd_off;
+	int			 rc;
+
+	D_ASSERT(UMOFF_IS_NULL(pool_df->pd_dedup));
+	dd_off = umem_zalloc(umm, sizeof(*dd_df));
+	if (UMOFF_IS_NULL(dd_off))
+		return umm->umm_nospc_rc;
+	dd_df = umem_off2ptr(umm, dd_off);
+
+	rc = dbtree_create_inplace(VOS_BTR_DEDUP, 0, VOS_DEDUP_ORDER, uma, &dd_df->dd_csum_root,
+				   &hdl);
+	if (rc != 0)
+		goto failed;
+	dbtree_close(hdl);
+
+	rc = dbtree_create_inplace(VOS_BTR_DEDUP, 0, VOS_DEDUP_ORDER, uma, &dd_df->dd_addr_root,
+				   &hdl);
+	if (rc != 0)
+		goto failed;
+	dbtree_close(hdl);
+
+	rc = umem_tx_add_ptr(umm, &pool_df->pd_dedup, sizeof(pool_df->pd_dedup));
+	if (rc != 0)
+		goto failed;
+	pool_df->pd_dedup = dd_off;
+	return 0;
+failed:
+	D_ERROR(DF_UUID": Failed to create dedup index: "DF_RC"\n", DP_UUID(pool_df->pd_id),
+		DP_RC(rc));
+	return rc;
+}
+
+/** Open the persistent dedup index if the pool has one */
+int
+vos_dedup_init(struct vos_pool *pool, struct vos_pool_df *pool_df)
+{
+	pool->vp_dedup_csum_th = DAOS_HDL_INVAL;
+	pool->vp_dedup_addr_th = DAOS_HDL_INVAL;
+
+	if (UMOFF_IS_NULL(pool_df->pd_dedup))
+		return 0;
+
+	return dedup_open(pool, umem_off2ptr(&pool->vp_umm, pool_df->pd_dedup));
+}
+
+void
+vos_dedup_fini(struct vos_pool *pool)
+{
+	D_ASSERT(d_list_empty(&pool->vp_dedup_pins));
+
+	if (daos_handle_is_valid(pool->vp_dedup_csum_th)) {
+		dbtree_close(pool->vp_dedup_csum_th);
+		pool->vp_dedup_csum_th = DAOS_HDL_INVAL;
+	}
+
+	if (daos_handle_is_valid(pool->vp_dedup_addr_th)) {
+		dbtree_close(pool->vp_dedup_addr_th);
+		pool->vp_dedup_addr_th = DAOS_HDL_INVAL;
+	}
+}
+
+static bool
+dedup_pinned(struct vos_pool *pool, bio_addr_t *addr)
+{
+	struct vos_dedup_pin	*pin;
+
+	d_list_for_each_entry(pin, &pool->vp_dedup_pins, dp_pool_link) {
+		if (pin->dp_addr.ba_off == addr->ba_off && pin->dp_addr.ba_type == addr->ba_type)
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Find an existing extent with identical checksum and data length, and pin it
+ * until vos_dedup_unpin() is called on \a pins.
+ *
+ * \return	true and the extent address in \a addr if found.
+ */
+bool
+vos_dedup_lookup(struct vos_pool *pool, struct dcs_csum_info *csum, daos_size_t csum_len,
+		 daos_size_t data_len, bio_addr_t *addr, d_list_t *pins)
+{
+	struct vos_dedup_key	*key;
+	struct vos_dedup_pin	*pin;
+	struct vos_dedup_ent_df	 ent;
+	d_iov_t			 key_iov;
+	d_iov_t			 val_iov;
+	int			 rc;
+
+	if (!dedup_enabled(pool) || !ci_is_valid(csum) || csum_len == 0)
+		return false;
+
+	key = dedup_key_alloc(csum, csum_len, data_len, &key_iov);
+	if (key == NULL)
+		return false;
+
+	d_iov_set(&val_iov, &ent, sizeof(ent));
+	rc = dbtree_lookup(pool->vp_dedup_csum_th, &key_iov, &val_iov);
+	D_FREE(key);
+	if (rc != 0)
+		return false;
+
+	D_ALLOC_PTR(pin);
+	if (pin == NULL)
+		return false;
+	pin->dp_addr = ent.de_addr;
+	d_list_add_tail(&pin->dp_pool_link, &pool->vp_dedup_pins);
+	d_list_add_tail(&pin->dp_link, pins);
+
+	*addr = ent.de_addr;
+	D_DEBUG(DB_IO, "Found dedup entry, ref "DF_U64"\n", ent.de_ref);
+	return true;
+}
+
+/* Free the pinned extent whose last reference has been dropped, see vos_dedup_decref(). */
+static void
+dedup_release(struct vos_pool *pool, bio_addr_t *addr)
+{
+	struct vos_dedup_addr_key	 akey;
+	struct vos_dedup_ent_df		*ent;
+	struct vos_dedup_key		*key;
+	d_iov_t				 akey_iov;
+	d_iov_t				 key_iov;
+	d_iov_t				 val_iov;
+	int				 rc;
+
+	dedup_addr_key_init(&akey, addr);
+	d_iov_set(&akey_iov, &akey, sizeof(akey));
+	d_iov_set(&key_iov, NULL, 0);
+	rc = dbtree_lookup(pool->vp_dedup_addr_th, &akey_iov, &key_iov);
+	if (rc != 0)
+		goto out;
+
+	d_iov_set(&val_iov, NULL, 0);
+	rc = dbtree_lookup(pool->vp_dedup_csum_th, &key_iov, &val_iov);
+	if (rc != 0)
+		goto out;
+
+	ent = val_iov.iov_buf;
+	if (ent->de_ref > 0)
+		return;
+
+	/* The key points to the tree value, which is freed by the delete */
+	D_ALLOC(key, key_iov.iov_len);
+	if (key == NULL)
+		D_GOTO(out, rc = -DER_NOMEM);
+	memcpy(key, key_iov.iov_buf, key_iov.iov_len);
+	d_iov_set(&key_iov, key, key_iov.iov_len);
+
+	rc = umem_tx_begin(&pool->vp_umm, NULL);
+	if (rc != 0) {
+		D_FREE(key);
+		goto out;
+	}
+
+	rc = dbtree_delete(pool->vp_dedup_csum_th, BTR_PROBE_EQ, &key_iov, NULL);
+	if (rc == 0)
+		rc = dbtree_delete(pool->vp_dedup_addr_th, BTR_PROBE_EQ, &akey_iov, NULL);
+	/* Not indexed anymore, it is freed as a plain extent */
+	if (rc == 0)
+		rc = vos_bio_addr_free(pool, addr, key->dk_data_len);
+
+	rc = umem_tx_end(&pool->vp_umm, rc);
+	D_FREE(key);
+out:
+	if (rc != 0)
+		D_ERROR("Failed to release dedup extent "DF_X64", leaked: "DF_RC"\n",
+			addr->ba_off, DP_RC(rc));
+}
+
+/** Release the extents pinned by vos_dedup_lookup(), must be called out of transaction. */
+void
+vos_dedup_unpin(struct vos_pool *pool, d_list_t *pins)
+{
+	struct vos_dedup_pin	*pin;
+
+	while ((pin = d_list_pop_entry(pins, struct vos_dedup_pin, dp_link)) != NULL) {
+		d_list_del(&pin->dp_pool_link);
+		if (!dedup_pinned(pool, &pin->dp_addr))
+			dedup_release(pool, &pin->dp_addr);
+		D_FREE(pin);
+	}
+}
+
+/**
+ * Take a reference on a deduplicated extent, or index a newly written extent.
+ * Must be called in the transaction inserting the evtree record of \a addr.
+ *
+ * \param[in] dedup	\a addr was returned (and pinned) by vos_dedup_lookup().
+ *
+ * \return	0 on success, negative value if error.
+ */
+int
+vos_dedup_addref(struct vos_pool *pool, struct dcs_csum_info *csum, daos_size_t csum_len,
+		 daos_size_t data_len, bio_addr_t *addr, bool dedup)
+{
+	struct vos_dedup_key		*key;
+	struct vos_dedup_ent_df		*ent;
+	struct vos_dedup_ent_df		 new_ent = { 0 };
+	struct vos_dedup_addr_key	 akey;
+	d_iov_t				 key_iov;
+	d_iov_t				 akey_iov;
+	d_iov_t				 val_iov;
+	int				 rc;
+
+	if (!ci_is_valid(csum) || csum_len == 0 || bio_addr_is_hole(addr)) {
+		D_ASSERT(!dedup);
+		return 0;
+	}
+
+	/* Not prepared, the extent is just not indexed */
+	if (!dedup_enabled(pool)) {
+		D_ASSERT(!dedup);
+		return 0;
+	}
+
+	key = dedup_key_alloc(csum, csum_len, data_len, &key_iov);
+	if (key == NULL)
+		return -DER_NOMEM;
+
+	d_iov_set(&val_iov, NULL, 0);
+	rc = dbtree_lookup(pool->vp_dedup_csum_th, &key_iov, &val_iov);
+	if (rc == 0) {
+		ent = val_iov.iov_buf;
+		D_ASSERT(val_iov.iov_len == sizeof(*ent));
+
+		/* Another extent with the same content, e.g. written again because
+		 * dedup verification failed. It is not indexed, so it is freed as
+		 * usual without touching the index.
+		 */
+		if (!dedup)
+			goto out;
+
+		/* The pinned extent cannot be freed or replaced */
+		if (ent->de_addr.ba_off != addr->ba_off || ent->de_addr.ba_type != addr->ba_type) {
+			D_ERROR("Dedup extent "DF_X64" is replaced by "DF_X64"\n", addr->ba_off,
+				ent->de_addr.ba_off);
+			D_GOTO(out, rc = -DER_IO);
+		}
+
+		rc = umem_tx_add_ptr(&pool->vp_umm, &ent->de_ref, sizeof(ent->de_ref));
+		if (rc != 0)
+			goto out;
+		ent->de_ref++;
+		D_DEBUG(DB_IO, "Dedup extent "DF_X64" ref "DF_U64"\n", addr->ba_off, ent->de_ref);
+		goto out;
+	} else if (rc != -DER_NONEXIST) {
+		goto out;
+	}
+
+	if (dedup) {
+		D_ERROR("Pinned dedup extent "DF_X64" has gone\n", addr->ba_off);
+		D_GOTO(out, rc = -DER_IO);
+	}
+
+	new_ent.de_addr = *addr;
+	BIO_ADDR_CLEAR_DEDUP(&new_ent.de_addr);
+	new_ent.de_ref = 1;
+	d_iov_set(&val_iov, &new_ent, sizeof(new_ent));
+	rc = dbtree_update(pool->vp_dedup_csum_th, &key_iov, &val_iov);
+	if (rc != 0)
+		goto out;
+
+	dedup_addr_key_init(&akey, addr);
+	d_iov_set(&akey_iov, &akey, sizeof(akey));
+	rc = dbtree_update(pool->vp_dedup_addr_th, &akey_iov, &key_iov);
+	if (rc == 0)
+		D_DEBUG(DB_IO, "Indexed extent "DF_X64"\n", addr->ba_off);
+out:
+	D_FREE(key);
+	return rc;
+}
+
+/**
+ * Drop a reference of the extent being freed. Must be called in transaction.
+ *
+ * \param[out] shared	Set when the extent is still referenced by others, or
+ *			pinned by in-flight updates, and must not be freed.
+ */
+int
+vos_dedup_decref(struct vos_pool *pool, bio_addr_t *addr, bool *shared)
+{
+	struct vos_dedup_addr_key	 akey;
+	struct vos_dedup_ent_df		*ent;
+	d_iov_t				 akey_iov;
+	d_iov_t				 key_iov;
+	d_iov_t				 val_iov;
+	int				 rc;
+
+	*shared = false;
+	if (!dedup_enabled(pool))
+		return 0;
+
+	dedup_addr_key_init(&akey, addr);
+	d_iov_set(&akey_iov, &akey, sizeof(akey));
+	d_iov_set(&key_iov, NULL, 0);
+	rc = dbtree_lookup(pool->vp_dedup_addr_th, &akey_iov, &key_iov);
+	if (rc == -DER_NONEXIST)
+		return 0;
+	if (rc != 0)
+		return rc;
+
+	d_iov_set(&val_iov, NULL, 0);
+	rc = dbtree_lookup(pool->vp_dedup_csum_th, &key_iov, &val_iov);
+	if (rc != 0) {
+		D_ERROR("Dedup index of extent "DF_X64" is inconsistent: "DF_RC"\n",
+			addr->ba_off, DP_RC(rc));
+		return rc == -DER_NONEXIST ? -DER_IO : rc;
+	}
+
+	ent = val_iov.iov_buf;
+	D_ASSERT(ent->de_ref > 0);
+	if (ent->de_ref > 1 || dedup_pinned(pool, addr)) {
+		rc = umem_tx_add_ptr(&pool->vp_umm, &ent->de_ref, sizeof(ent->de_ref));
+		if (rc != 0)
+			return rc;
+		ent->de_ref--;
+		*shared = true;
+		D_DEBUG(DB_IO, "Dedup extent "DF_X64" ref "DF_U64"\n", addr->ba_off, ent->de_ref);
+		return 0;
+	}
+
+	/* Last reference, drop the index entries, the caller frees the extent */
+	rc = dbtree_delete(pool->vp_dedup_csum_th, BTR_PROBE_EQ, &key_iov, NULL);
+	if (rc != 0)
+		return rc;
+
+	return dbtree_delete(pool->vp_dedup_addr_th, BTR_PROBE_EQ, &akey_iov, NULL);
+}
@@ -270,8 +270,11 @@ struct vos_pool {
 	daos_size_t		vp_space_sys[DAOS_MEDIA_MAX];
 	/** Held space by in-flight updates. In bytes */
 	daos_size_t		vp_space_held[DAOS_MEDIA_MAX];
-	/** Dedup hash */
-	struct d_hash_table	*vp_dedup_hash;
+	/** btr handles of the dedup index, checksum and address trees */
+	daos_handle_t		vp_dedup_csum_th;
+	daos_handle_t		vp_dedup_addr_th;
+	/** Shared extents pinned by in-flight updates, struct vos_dedup_pin */
+	d_list_t		vp_dedup_pins;
 	struct vos_pool_metrics	*vp_metrics;
 	vos_chkpt_update_cb_t    vp_update_cb;
 	vos_chkpt_wait_cb_t      vp_wait_cb;
@@ -773,6 +776,8 @@ enum vos_tree_class {
 	VOS_BTR_DTX_CMT_TABLE	= (VOS_BTR_BEGIN + 6),
 	/** The VOS incarnation log tree */
 	VOS_BTR_ILOG		= (VOS_BTR_BEGIN + 7),
+	/** Persistent dedup index */
+	VOS_BTR_DEDUP		= (VOS_BTR_BEGIN + 8),
 	/** the last reserved tree class */
 	VOS_BTR_END,
 };
@@ -1250,12 +1255,25 @@ key_tree_delete(struct vos_object *obj, daos_handle_t toh, d_iov_t *key_iov);
 daos_size_t
 vos_recx2irec_size(daos_size_t rsize, struct dcs_csum_info *csum);
 
+/* vos_dedup.c */
 int
-vos_dedup_init(struct vos_pool *pool);
+vos_dedup_tab_register(void);
+int
+vos_dedup_create(struct umem_instance *umm, struct umem_attr *uma, struct vos_pool_df *pool_df);
+int
+vos_dedup_init(struct vos_pool *pool, struct vos_pool_df *pool_df);
 void
 vos_dedup_fini(struct vos_pool *pool);
+bool
+vos_dedup_lookup(struct vos_pool *pool, struct dcs_csum_info *csum, daos_size_t csum_len,
+		 daos_size_t data_len, bio_addr_t *addr, d_list_t *pins);
 void
-vos_dedup_invalidate(struct vos_pool *pool);
+vos_dedup_unpin(struct vos_pool *pool, d_list_t *pins);
+int
+vos_dedup_addref(struct vos_pool *pool, struct dcs_csum_info *csum, daos_size_t csum_len,
+		 daos_size_t data_len, bio_addr_t *addr, bool dedup);
+int
+vos_dedup_decref(struct vos_pool *pool, bio_addr_t *addr, bool *shared);
 
 umem_off_t
 vos_reserve_scm(struct vos_container *cont, struct umem_rsrvd_act *rsrvd_scm,
@@ -58,12 +58,12 @@ struct vos_io_context {
 	unsigned int		 ic_iod_nr;
 	/** deduplication threshold size */
 	uint32_t		 ic_dedup_th;
-	/** dedup entries to be inserted after transaction done */
-	d_list_t		 ic_dedup_entries;
 	/** duped SG lists for dedup verify */
 	struct bio_sglist	*ic_dedup_bsgls;
 	/** bulk data buffers for dedup verify */
 	struct bio_desc		**ic_dedup_bufs;
+	/** shared extents pinned by dedup lookup */
+	d_list_t		 ic_dedup_pins;
 	/** the total size of the IO */
 	uint64_t		 ic_io_size;
 	/** flags */
@@ -91,229 +91,6 @@ struct vos_io_context {
 	struct daos_recx_ep_list *ic_recx_lists;
 };
 
-struct dedup_entry {
-	d_list_t	 de_link;
-	uint8_t		*de_csum_buf;
-	uint16_t	 de_csum_type;
-	int		 de_csum_len;
-	bio_addr_t	 de_addr;
-	size_t           de_data_len;
-	int		 de_ref;
-};
-
-static inline struct dedup_entry *
-dedup_rlink2entry(d_list_t *rlink)
-{
-	return container_of(rlink, struct dedup_entry, de_link);
-}
-
-static bool
-dedup_key_cmp(struct d_hash_table *htable, d_list_t *rlink,
-	      const void *key, unsigned int csum_len)
-{
-	struct dedup_entry	*entry = dedup_rlink2entry(rlink);
-	struct dcs_csum_info	*csum = (struct dcs_csum_info *)key;
-
-	D_ASSERT(entry->de_csum_len != 0);
-	D_ASSERT(csum_len != 0);
-
-	/** different containers might use different checksum algorithm */
-	if (entry->de_csum_type != csum->cs_type)
-		return false;
-
-	/** overall checksum size (for all chunks) should match */
-	if (entry->de_csum_len != csum_len)
-		return false;
-
-	D_ASSERT(csum->cs_csum != NULL);
-	D_ASSERT(entry->de_csum_buf != NULL);
-
-	return memcmp(entry->de_csum_buf, csum->cs_csum, csum_len) == 0;
-}
-
-static uint32_t
-dedup_key_hash(struct d_hash_table *htable, const void *key,
-	       unsigned int csum_len)
-{
-	struct dcs_csum_info	*csum = (struct dcs_csum_info *)key;
-
-	D_ASSERT(csum_len != 0);
-	D_ASSERT(csum->cs_csum != NULL);
-
-	return d_hash_string_u32((const char *)csum->cs_csum, csum_len);
-}
-
-static void
-dedup_rec_addref(struct d_hash_table *htable, d_list_t *rlink)
-{
-	struct dedup_entry	*entry = dedup_rlink2entry(rlink);
-
-	entry->de_ref++;
-}
-
-static bool
-dedup_rec_decref(struct d_hash_table *htable, d_list_t *rlink)
-{
-	struct dedup_entry	*entry = dedup_rlink2entry(rlink);
-
-	D_ASSERT(entry->de_ref > 0);
-	entry->de_ref--;
-
-	return entry->de_ref == 0;
-}
-
-static void
-dedup_rec_free(struct d_hash_table *htable, d_list_t *rlink)
-{
-	struct dedup_entry	*entry = dedup_rlink2entry(rlink);
-
-	D_ASSERT(entry->de_ref == 0);
-	D_ASSERT(entry->de_csum_buf != NULL);
-
-	D_FREE(entry->de_csum_buf);
-	D_FREE(entry);
-}
-
-static d_hash_table_ops_t dedup_hash_ops = {
-	.hop_key_cmp	= dedup_key_cmp,
-	.hop_key_hash	= dedup_key_hash,
-	.hop_rec_addref	= dedup_rec_addref,
-	.hop_rec_decref	= dedup_rec_decref,
-	.hop_rec_free	= dedup_rec_free,
-};
-
-int
-vos_dedup_init(struct vos_pool *pool)
-{
-	int	rc;
-
-	rc = d_hash_table_create(D_HASH_FT_NOLOCK, 13, /* 8k buckets */
-				 NULL, &dedup_hash_ops,
-				 &pool->vp_dedup_hash);
-
-	if (rc)
-		D_ERROR(DF_UUID ": Init dedup hash failed. " DF_RC "\n", DP_UUID(pool->vp_id),
-			DP_RC(rc));
-	return rc;
-}
-
-void
-vos_dedup_fini(struct vos_pool *pool)
-{
-	if (pool->vp_dedup_hash) {
-		d_hash_table_destroy(pool->vp_dedup_hash, true);
-		pool->vp_dedup_hash = NULL;
-	}
-}
-
-void
-vos_dedup_invalidate(struct vos_pool *pool)
-{
-	vos_dedup_fini(pool);
-	vos_dedup_init(pool);
-}
-
-static bool
-vos_dedup_lookup(struct vos_pool *pool, struct dcs_csum_info *csum,
-		 daos_size_t csum_len, struct bio_iov *biov)
-{
-	struct dedup_entry	*entry;
-	d_list_t		*rlink;
-
-	if (!ci_is_valid(csum))
-		return false;
-
-	rlink = d_hash_rec_find(pool->vp_dedup_hash, csum, csum_len);
-	if (rlink == NULL)
-		return false;
-
-	entry = dedup_rlink2entry(rlink);
-	if (biov) {
-		biov->bi_addr = entry->de_addr;
-		BIO_ADDR_SET_DEDUP(&biov->bi_addr);
-		biov->bi_data_len = entry->de_data_len;
-		D_DEBUG(DB_IO, "Found dedup entry\n");
-	}
-
-	D_ASSERT(entry->de_ref > 1);
-
-	d_hash_rec_decref(pool->vp_dedup_hash, rlink);
-
-	return true;
-}
-
-static void
-vos_dedup_update(struct vos_pool *pool, struct dcs_csum_info *csum,
-		 daos_size_t csum_len, struct bio_iov *biov, d_list_t *list)
-{
-	struct dedup_entry	*entry;
-
-	if (!ci_is_valid(csum) || csum_len == 0 ||
-	    BIO_ADDR_IS_DEDUP(&biov->bi_addr))
-		return;
-
-	if (bio_addr_is_hole(&biov->bi_addr))
-		return;
-
-	if (vos_dedup_lookup(pool, csum, csum_len, NULL))
-		return;
-
-	D_ALLOC_PTR(entry);
-	if (entry == NULL) {
-		return;
-	}
-	D_INIT_LIST_HEAD(&entry->de_link);
-
-	D_ASSERT(csum_len != 0);
-	D_ALLOC(entry->de_csum_buf, csum_len);
-	if (entry->de_csum_buf == NULL) {
-		D_FREE(entry);
-		return;
-	}
-	entry->de_csum_len	= csum_len;
-	entry->de_csum_type	= csum->cs_type;
-	entry->de_addr		= biov->bi_addr;
-	entry->de_data_len	= biov->bi_data_len;
-	memcpy(entry->de_csum_buf, csum->cs_csum, csum_len);
-
-	d_list_add_tail(&entry->de_link, list);
-	D_DEBUG(DB_IO, "Inserted dedup entry in list\n");
-}
-
-static void
-vos_dedup_process(struct vos_pool *pool, d_list_t *list, bool abort)
-{
-	struct dedup_entry	*entry, *tmp;
-	struct dcs_csum_info	 csum = { 0 };
-	int			 rc;
-
-	d_list_for_each_entry_safe(entry, tmp, list, de_link) {
-		d_list_del_init(&entry->de_link);
-
-		if (abort)
-			goto free_entry;
-
-		/*
-		 * No yield since vos_dedup_update() is called, so it's safe
-		 * to insert entries to hash without checking.
-		 */
-		csum.cs_csum = entry->de_csum_buf;
-		csum.cs_type = entry->de_csum_type;
-
-		rc = d_hash_rec_insert(pool->vp_dedup_hash, &csum,
-				       entry->de_csum_len, &entry->de_link,
-				       false);
-		if (rc == 0) {
-			D_DEBUG(DB_IO, "Inserted dedup entry\n");
-			continue;
-		}
-		D_ERROR("Insert dedup entry failed. "DF_RC"\n", DP_RC(rc));
-free_entry:
-		D_FREE(entry->de_csum_buf);
-		D_FREE(entry);
-	}
-}
-
 static void
 vos_dedup_free_bsgl(struct vos_io_context *ioc, unsigned int sgl_idx,
 		    unsigned int *buf_idx)
@@ -522,7 +299,6 @@ vos_ioc_reserve_fini(struct vos_io_context *ioc)
 	}
 
 	D_ASSERT(d_list_empty(&ioc->ic_blk_exts));
-	D_ASSERT(d_list_empty(&ioc->ic_dedup_entries));
 	D_FREE(ioc->ic_umoffs);
 }
 
@@ -575,6 +351,7 @@ vos_ioc_destroy(struct vos_io_context *ioc, bool evict)
 		bio_iod_free(ioc->ic_biod);
 
 	dcs_csum_info_list_fini(&ioc->ic_csum_list);
+	vos_dedup_unpin(vos_cont2pool(ioc->ic_cont), &ioc->ic_dedup_pins);
 
 	if (ioc->ic_obj)
 		vos_obj_release(vos_obj_cache_current(ioc->ic_cont->vc_pool->vp_sysdb),
@@ -644,8 +421,8 @@ vos_ioc_create(daos_handle_t coh, daos_unit_oid_t oid, bool read_only,
 	vos_ilog_fetch_init(&ioc->ic_dkey_info);
 	vos_ilog_fetch_init(&ioc->ic_akey_info);
 	D_INIT_LIST_HEAD(&ioc->ic_blk_exts);
+	D_INIT_LIST_HEAD(&ioc->ic_dedup_pins);
 	ioc->ic_shadows = shadows;
-	D_INIT_LIST_HEAD(&ioc->ic_dedup_entries);
 
 	rc = vos_ioc_reserve_init(ioc, dth);
 	if (rc != 0)
@@ -1656,11 +1433,13 @@ akey_update_recx(daos_handle_t toh, uint32_t pm_ver, daos_recx_t *recx,
 
 	rc = evt_insert(toh, &ent, NULL);
 
+	/* Reference the shared extent, or index the new one, in the same transaction */
 	if (ioc->ic_dedup && !rc && (rsize * recx->rx_nr) >= ioc->ic_dedup_th) {
 		daos_size_t csum_len = recx_csum_len(recx, csum, rsize);
 
-		vos_dedup_update(vos_cont2pool(ioc->ic_cont), csum, csum_len,
-				 biov, &ioc->ic_dedup_entries);
+		rc = vos_dedup_addref(vos_cont2pool(ioc->ic_cont), csum, csum_len,
+				      rsize * recx->rx_nr, &biov->bi_addr,
+				      BIO_ADDR_IS_DEDUP(&biov->bi_addr));
 	}
 	return rc;
 }
@@ -2137,16 +1916,17 @@ vos_reserve_recx(struct vos_io_context *ioc, uint16_t media, daos_size_t size,
 	}
 
 	if (ioc->ic_dedup && size >= ioc->ic_dedup_th &&
-	    vos_dedup_lookup(vos_cont2pool(ioc->ic_cont), csum, csum_len,
-			     &biov)) {
-		if (biov.bi_data_len == size) {
-			D_ASSERT(biov.bi_addr.ba_off != 0);
-			ioc->ic_umoffs[ioc->ic_umoffs_cnt] =
-							biov.bi_addr.ba_off;
+	    vos_dedup_lookup(vos_cont2pool(ioc->ic_cont), csum, csum_len, size,
+			     &biov.bi_addr, &ioc->ic_dedup_pins)) {
+		D_ASSERT(biov.bi_addr.ba_off != 0);
+		BIO_ADDR_SET_DEDUP(&biov.bi_addr);
+		bio_iov_set_len(&biov, size);
+		/* The shared extent isn't owned, never free it on cancel */
+		if (media == DAOS_MEDIA_SCM) {
+			ioc->ic_umoffs[ioc->ic_umoffs_cnt] = UMOFF_NULL;
 			ioc->ic_umoffs_cnt++;
-			return iod_reserve(ioc, &biov);
 		}
-		memset(&biov, 0, sizeof(biov));
+		return iod_reserve(ioc, &biov);
 	}
 
 	/*
@@ -2282,10 +2062,6 @@ update_cancel(struct vos_io_context *ioc)
 				umem_free(umem, ioc->ic_umoffs[i]);
 		}
 	}
-
-	/* Abort dedup entries */
-	vos_dedup_process(vos_cont2pool(ioc->ic_cont), &ioc->ic_dedup_entries,
-			  true /* abort */);
 }
 
 int
@@ -2387,8 +2163,6 @@ abort:
 
 	err = vos_tx_end(ioc->ic_cont, dth, &ioc->ic_rsrvd_scm,
 			 &ioc->ic_blk_exts, tx_started, ioc->ic_biod, err);
-	if (err == 0)
-		vos_dedup_process(vos_cont2pool(ioc->ic_cont), &ioc->ic_dedup_entries, false);
 
 	if (dtx_is_valid_handle(dth)) {
 		if (err == 0)
@@ -91,7 +91,7 @@ enum vos_gc_type {
  */
 
 /** Current durable format version */
-#define POOL_DF_VERSION                         VOS_POOL_DF_2_6
+#define POOL_DF_VERSION                         VOS_POOL_DF_2_8
 
 /** 2.2 features.  Until we have an upgrade path for RDB, we need to support more than one old
  *  version.
@@ -104,6 +104,9 @@ enum vos_gc_type {
 /** 2.6 features */
 #define VOS_POOL_FEAT_2_6                       (VOS_POOL_FEAT_EMB_VALUE)
 
+/** 2.8 features */
+#define VOS_POOL_FEAT_2_8                       (VOS_POOL_FEAT_DEDUP)
+
 /**
  * Durable format for VOS pool
  */
@@ -131,7 +134,7 @@ struct vos_pool_df {
 	uint64_t				pd_nvme_sz;
 	/** # of containers in this pool */
 	uint64_t				pd_cont_nr;
-	/** offset for the btree of the dedup table (placeholder) */
+	/** offset of the persistent dedup index, struct vos_dedup_df, since VOS_POOL_DF_2_8 */
 	umem_off_t				pd_dedup;
 	/** Typed PMEMoid pointer for the container index table */
 	struct btr_root				pd_cont_root;
@@ -141,6 +144,22 @@ struct vos_pool_df {
 	struct vos_gc_bin_df			pd_gc_bins[GC_MAX];
 };
 
+/** Persistent dedup index, see vos_dedup.c */
+struct vos_dedup_df {
+	/** Checksum (type, length, data length) -> struct vos_dedup_ent_df */
+	struct btr_root				dd_csum_root;
+	/** Extent address -> checksum key, to find the entry on free */
+	struct btr_root				dd_addr_root;
+};
+
+/** Value of the dedup checksum tree */
+struct vos_dedup_ent_df {
+	/** Address of the shared extent */
+	bio_addr_t				de_addr;
+	/** Number of evtree records referencing the extent */
+	uint64_t				de_ref;
+};
+
 /**
  * A DTX record is the object, {a,d}key, single-value or
  * array value that is changed in the transaction (DTX).
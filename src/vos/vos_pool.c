@@ -814,6 +814,7 @@ pool_alloc(uuid_t uuid, struct vos_pool **pool_p)
 	d_uhash_ulink_init(&pool->vp_hlink, &pool_uuid_hops);
 	D_INIT_LIST_HEAD(&pool->vp_gc_link);
 	D_INIT_LIST_HEAD(&pool->vp_gc_cont);
+	D_INIT_LIST_HEAD(&pool->vp_dedup_pins);
 	uuid_copy(pool->vp_id, uuid);
 
 	*pool_p = pool;
@@ -997,6 +998,9 @@ vos_pool_create_ex(const char *path, uuid_t uuid, daos_size_t scm_sz,
 		pool_df->pd_version = POOL_DF_VERSION;
 
 	gc_init_pool(&umem, pool_df);
+
+	if (pool_df->pd_version >= VOS_POOL_DF_2_8)
+		rc = vos_dedup_create(&umem, &uma, pool_df);
 end:
 	/**
 	 * The transaction can in reality be aborted
@@ -1273,7 +1277,7 @@ pool_open(void *ph, struct vos_pool_df *pool_df, unsigned int flags, void *metri
 		}
 	}
 
-	rc = vos_dedup_init(pool);
+	rc = vos_dedup_init(pool, pool_df);
 	if (rc)
 		goto failed;
 
@@ -1297,6 +1301,8 @@ pool_open(void *ph, struct vos_pool_df *pool_df, unsigned int flags, void *metri
 		pool->vp_feats |= VOS_POOL_FEAT_2_4;
 	if (pool_df->pd_version >= VOS_POOL_DF_2_6)
 		pool->vp_feats |= VOS_POOL_FEAT_2_6;
+	if (pool_df->pd_version >= VOS_POOL_DF_2_8)
+		pool->vp_feats |= VOS_POOL_FEAT_2_8;
 
 	vos_space_sys_init(pool);
 	/* Ensure GC is triggered after server restart */
@@ -1439,18 +1445,28 @@ vos_pool_upgrade(daos_handle_t poh, uint32_t version)
 
 	pool_df->pd_version = version;
 
+	if (version >= VOS_POOL_DF_2_8 && UMOFF_IS_NULL(pool_df->pd_dedup))
+		rc = vos_dedup_create(&pool->vp_umm, &pool->vp_uma, pool_df);
 end:
 	rc = umem_tx_end(&pool->vp_umm, rc);
 
 	if (rc != 0)
 		return rc;
 
+	if (!UMOFF_IS_NULL(pool_df->pd_dedup) && !daos_handle_is_valid(pool->vp_dedup_csum_th)) {
+		rc = vos_dedup_init(pool, pool_df);
+		if (rc != 0)
+			return rc;
+	}
+
 	if (version >= VOS_POOL_DF_2_2)
 		pool->vp_feats |= VOS_POOL_FEAT_2_2;
 	if (version >= VOS_POOL_DF_2_4)
 		pool->vp_feats |= VOS_POOL_FEAT_2_4;
 	if (version >= VOS_POOL_DF_2_6)
 		pool->vp_feats |= VOS_POOL_FEAT_2_6;
+	if (version >= VOS_POOL_DF_2_8)
+		pool->vp_feats |= VOS_POOL_FEAT_2_8;
 
 	return 0;
 }